@@ -319,6 +319,19 @@ static demoEntryFunc sDemoMap[16][50] = {
 		DEMO_ENTRY_NAME(performance, RenderSpriteTest),
 		DEMO_ENTRY_NAME(performance, RunActionTest),
 		DEMO_ENTRY_NAME(performance, RunSkeletalAnimationTest),
+		DEMO_ENTRY_NAME(performance, CommandQueueStressTest),
+		DEMO_ENTRY_NAME(performance, RunParticleTest),
+		DEMO_ENTRY_NAME(performance, SlabAllocatorTest),
+		DEMO_ENTRY_NAME(performance, TimerWheelTest),
+		DEMO_ENTRY_NAME(performance, TweenBatchTest),
+		DEMO_ENTRY_NAME(performance, AStarBenchmarkTest),
+		DEMO_ENTRY_NAME(performance, PathServiceTest),
+		DEMO_ENTRY_NAME(performance, HugeTMXTest),
+		DEMO_ENTRY_NAME(performance, RunAFCAnimationTest),
+		DEMO_ENTRY_NAME(performance, ChipmunkBroadphaseTest),
+		DEMO_ENTRY_NAME(performance, Box2DIslandTest),
+		DEMO_ENTRY_NAME(performance, FixedStepTest),
+		DEMO_ENTRY_NAME(performance, ColorFilterTest),
 	},
 	{
 		DEMO_ENTRY_NAME(persistence, CreateDatabaseTest),
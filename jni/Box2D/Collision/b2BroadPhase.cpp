@@ -17,6 +17,7 @@
 */
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Common/b2ThreadPool.h>
 #include <string.h>
 
 b2BroadPhase::b2BroadPhase()
@@ -30,10 +31,20 @@ b2BroadPhase::b2BroadPhase()
 	m_moveCapacity = 16;
 	m_moveCount = 0;
 	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+
+	memset(m_pairChunks, 0, sizeof(m_pairChunks));
 }
 
 b2BroadPhase::~b2BroadPhase()
 {
+	for (int32 i = 0; i < e_maxPairChunks; ++i)
+	{
+		if (m_pairChunks[i].pairs)
+		{
+			b2Free(m_pairChunks[i].pairs);
+		}
+	}
+
 	b2Free(m_moveBuffer);
 	b2Free(m_pairBuffer);
 }
@@ -119,3 +130,121 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 
 	return true;
 }
+
+// Collects the pairs of one moved proxy into a chunk buffer.
+struct b2ChunkQueryCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		// A proxy cannot form a pair with itself.
+		if (proxyId == queryProxyId)
+		{
+			return true;
+		}
+
+		if (chunk->count == chunk->capacity)
+		{
+			b2Pair* oldBuffer = chunk->pairs;
+			chunk->capacity = b2Max(16, 2 * chunk->capacity);
+			chunk->pairs = (b2Pair*)b2Alloc(chunk->capacity * sizeof(b2Pair));
+			if (oldBuffer)
+			{
+				memcpy(chunk->pairs, oldBuffer, chunk->count * sizeof(b2Pair));
+				b2Free(oldBuffer);
+			}
+		}
+
+		chunk->pairs[chunk->count].proxyIdA = b2Min(proxyId, queryProxyId);
+		chunk->pairs[chunk->count].proxyIdB = b2Max(proxyId, queryProxyId);
+		++chunk->count;
+
+		return true;
+	}
+
+	b2BroadPhase::b2PairChunk* chunk;
+	int32 queryProxyId;
+};
+
+class b2PairQueryTask : public b2ParallelTask
+{
+public:
+	void Execute(int32 index, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+		broadPhase->QueryChunk(index, chunkSize);
+	}
+
+	b2BroadPhase* broadPhase;
+	int32 chunkSize;
+};
+
+bool b2BroadPhase::ParallelQueryMoves(b2ThreadPool* threadPool)
+{
+	if (threadPool == NULL || threadPool->GetThreadCount() < 2 || m_moveCount < 2 * e_minChunkMoves)
+	{
+		return false;
+	}
+
+	// A few chunks per thread so a thread hitting a dense area doesn't hold up the others.
+	int32 chunkCount = b2Min(4 * threadPool->GetThreadCount(), m_moveCount / e_minChunkMoves);
+	chunkCount = b2Min(chunkCount, (int32)e_maxPairChunks);
+	int32 chunkSize = (m_moveCount + chunkCount - 1) / chunkCount;
+	chunkCount = (m_moveCount + chunkSize - 1) / chunkSize;
+
+	b2PairQueryTask task;
+	task.broadPhase = this;
+	task.chunkSize = chunkSize;
+	threadPool->Run(&task, chunkCount);
+
+	// Chunks are appended in move buffer order, which is the order of the serial queries.
+	int32 pairCount = 0;
+	for (int32 i = 0; i < chunkCount; ++i)
+	{
+		pairCount += m_pairChunks[i].count;
+	}
+
+	if (pairCount > m_pairCapacity)
+	{
+		while (m_pairCapacity < pairCount)
+		{
+			m_pairCapacity *= 2;
+		}
+
+		b2Free(m_pairBuffer);
+		m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+	}
+
+	m_pairCount = 0;
+	for (int32 i = 0; i < chunkCount; ++i)
+	{
+		b2PairChunk* chunk = m_pairChunks + i;
+		if (chunk->count == 0)
+		{
+			continue;
+		}
+
+		memcpy(m_pairBuffer + m_pairCount, chunk->pairs, chunk->count * sizeof(b2Pair));
+		m_pairCount += chunk->count;
+	}
+
+	return true;
+}
+
+void b2BroadPhase::QueryChunk(int32 chunk, int32 chunkSize)
+{
+	b2ChunkQueryCallback callback;
+	callback.chunk = m_pairChunks + chunk;
+	callback.chunk->count = 0;
+
+	int32 end = b2Min(m_moveCount, (chunk + 1) * chunkSize);
+	for (int32 i = chunk * chunkSize; i < end; ++i)
+	{
+		callback.queryProxyId = m_moveBuffer[i];
+		if (callback.queryProxyId == e_nullProxy)
+		{
+			continue;
+		}
+
+		m_tree.Query(&callback, m_tree.GetFatAABB(callback.queryProxyId));
+	}
+}
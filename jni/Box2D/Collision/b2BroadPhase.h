@@ -24,6 +24,8 @@
 #include <Box2D/Collision/b2DynamicTree.h>
 #include <stdlib.h>
 
+class b2ThreadPool;
+
 struct BOX2D_API b2Pair
 {
 	int32 proxyIdA;
@@ -73,8 +75,10 @@ public:
 	int32 GetProxyCount() const;
 
 	/// Update the pairs. This results in pair callbacks. This can only add pairs.
+	/// If a thread pool is given, the tree queries of moved proxies are spread over
+	/// its threads. The pairs are reported in the same order either way.
 	template <typename T>
-	void UpdatePairs(T* callback);
+	void UpdatePairs(T* callback, b2ThreadPool* threadPool = NULL);
 
 	/// Query an AABB for overlapping proxies. The callback class
 	/// is called for each proxy that overlaps the supplied AABB.
@@ -103,12 +107,33 @@ public:
 private:
 
 	friend class b2DynamicTree;
+	friend class b2PairQueryTask;
+	friend struct b2ChunkQueryCallback;
+
+	enum
+	{
+		e_maxPairChunks = 32,
+		e_minChunkMoves = 16
+	};
+
+	// Pairs found by the queries of one chunk of the move buffer.
+	struct b2PairChunk
+	{
+		b2Pair* pairs;
+		int32 count;
+		int32 capacity;
+	};
 
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
 
 	bool QueryCallback(int32 proxyId);
 
+	// Fill the pair buffer using the thread pool. Returns false if there are
+	// too few moved proxies to be worth it, nothing is done in that case.
+	bool ParallelQueryMoves(b2ThreadPool* threadPool);
+	void QueryChunk(int32 chunk, int32 chunkSize);
+
 	b2DynamicTree m_tree;
 
 	int32 m_proxyCount;
@@ -122,6 +147,8 @@ private:
 	int32 m_pairCount;
 
 	int32 m_queryProxyId;
+
+	b2PairChunk m_pairChunks[e_maxPairChunks];
 };
 
 /// This is used to sort pairs.
@@ -201,26 +228,29 @@ inline float32 b2BroadPhase::GetTreeQuality() const
 }
 
 template <typename T>
-void b2BroadPhase::UpdatePairs(T* callback)
+void b2BroadPhase::UpdatePairs(T* callback, b2ThreadPool* threadPool)
 {
 	// Reset pair buffer
 	m_pairCount = 0;
 
 	// Perform tree queries for all moving proxies.
-	for (int32 i = 0; i < m_moveCount; ++i)
+	if (ParallelQueryMoves(threadPool) == false)
 	{
-		m_queryProxyId = m_moveBuffer[i];
-		if (m_queryProxyId == e_nullProxy)
+		for (int32 i = 0; i < m_moveCount; ++i)
 		{
-			continue;
-		}
+			m_queryProxyId = m_moveBuffer[i];
+			if (m_queryProxyId == e_nullProxy)
+			{
+				continue;
+			}
 
-		// We have to query the tree with the fat AABB so that
-		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+			// We have to query the tree with the fat AABB so that
+			// we don't fail to create a pair that may touch later.
+			const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
 
-		// Query tree, create pairs and add them pair buffer.
-		m_tree.Query(this, fatAABB);
+			// Query tree, create pairs and add them pair buffer.
+			m_tree.Query(this, fatAABB);
+		}
 	}
 
 	// Reset move buffer
@@ -0,0 +1,167 @@
+/*
+* Copyright (c) 2011 Erin Catto http://box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2ThreadPool.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+// Add one to a counter atomically and return the old value.
+static inline int32 b2AtomicFetchIncrement(volatile int32* value)
+{
+#if defined(_WIN32)
+	return (int32)InterlockedIncrement((volatile LONG*)value) - 1;
+#else
+	return __sync_fetch_and_add(value, 1);
+#endif
+}
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	b2Assert(threadCount > 0);
+
+	m_threadCount = threadCount;
+	m_task = NULL;
+	m_count = 0;
+	m_next = 0;
+	m_generation = 0;
+	m_busyCount = 0;
+	m_quit = false;
+
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_startCondition, NULL);
+	pthread_cond_init(&m_doneCondition, NULL);
+
+	// The calling thread is thread 0, so it has no worker.
+	m_workers = (b2Worker*)b2Alloc(m_threadCount * sizeof(b2Worker));
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		b2Worker* worker = m_workers + i;
+		worker->pool = this;
+		worker->index = i;
+		pthread_create(&worker->thread, NULL, ThreadEntry, worker);
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	pthread_mutex_lock(&m_mutex);
+	m_quit = true;
+	pthread_cond_broadcast(&m_startCondition);
+	pthread_mutex_unlock(&m_mutex);
+
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		pthread_join(m_workers[i].thread, NULL);
+	}
+
+	b2Free(m_workers);
+
+	pthread_cond_destroy(&m_doneCondition);
+	pthread_cond_destroy(&m_startCondition);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+void b2ThreadPool::Run(b2ParallelTask* task, int32 count)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// Not worth waking anybody.
+	if (m_threadCount == 1 || count == 1)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			task->Execute(i, 0);
+		}
+		return;
+	}
+
+	pthread_mutex_lock(&m_mutex);
+	m_task = task;
+	m_count = count;
+	m_next = 0;
+	m_busyCount = m_threadCount - 1;
+	++m_generation;
+	pthread_cond_broadcast(&m_startCondition);
+	pthread_mutex_unlock(&m_mutex);
+
+	Work(0);
+
+	// Every worker checks in once per generation, even if it found no items left.
+	pthread_mutex_lock(&m_mutex);
+	while (m_busyCount > 0)
+	{
+		pthread_cond_wait(&m_doneCondition, &m_mutex);
+	}
+	m_task = NULL;
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void b2ThreadPool::Work(int32 threadIndex)
+{
+	for (;;)
+	{
+		int32 index = b2AtomicFetchIncrement(&m_next);
+		if (index >= m_count)
+		{
+			break;
+		}
+
+		m_task->Execute(index, threadIndex);
+	}
+}
+
+void* b2ThreadPool::ThreadEntry(void* arg)
+{
+	b2Worker* worker = (b2Worker*)arg;
+	b2ThreadPool* pool = worker->pool;
+	int32 generation = 0;
+
+	pthread_mutex_lock(&pool->m_mutex);
+	for (;;)
+	{
+		while (pool->m_generation == generation && pool->m_quit == false)
+		{
+			pthread_cond_wait(&pool->m_startCondition, &pool->m_mutex);
+		}
+
+		if (pool->m_quit)
+		{
+			break;
+		}
+
+		generation = pool->m_generation;
+		pthread_mutex_unlock(&pool->m_mutex);
+
+		pool->Work(worker->index);
+
+		pthread_mutex_lock(&pool->m_mutex);
+		--pool->m_busyCount;
+		if (pool->m_busyCount == 0)
+		{
+			pthread_cond_signal(&pool->m_doneCondition);
+		}
+	}
+	pthread_mutex_unlock(&pool->m_mutex);
+
+	return NULL;
+}
@@ -0,0 +1,89 @@
+/*
+* Copyright (c) 2011 Erin Catto http://box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2Settings.h>
+#include <pthread.h>
+
+/// Work submitted to a b2ThreadPool. Execute is called once for every index
+/// in [0, count) and may be called from several threads at the same time, so
+/// an implementation must only write data owned by that index or by that thread.
+class BOX2D_API b2ParallelTask
+{
+public:
+	virtual ~b2ParallelTask() {}
+
+	/// Run one work item.
+	/// @param index the work item, in [0, count).
+	/// @param threadIndex the thread running it, in [0, thread count). The
+	/// thread which called b2ThreadPool::Run is always 0.
+	virtual void Execute(int32 index, int32 threadIndex) = 0;
+};
+
+/// A fixed set of worker threads which run parallel loops. The calling thread
+/// takes part in every loop and Run returns when all items are done. Items are
+/// handed out dynamically, so a task must not depend on which thread runs an item.
+class BOX2D_API b2ThreadPool
+{
+public:
+	/// @param threadCount the number of threads including the calling thread.
+	b2ThreadPool(int32 threadCount);
+	~b2ThreadPool();
+
+	/// Get the number of threads including the calling thread.
+	int32 GetThreadCount() const;
+
+	/// Execute the task for every index in [0, count) and wait for completion.
+	void Run(b2ParallelTask* task, int32 count);
+
+private:
+
+	static void* ThreadEntry(void* arg);
+
+	void Work(int32 threadIndex);
+
+	struct b2Worker
+	{
+		b2ThreadPool* pool;
+		int32 index;
+		pthread_t thread;
+	};
+
+	b2Worker* m_workers;
+	int32 m_threadCount;
+
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_startCondition;
+	pthread_cond_t m_doneCondition;
+
+	b2ParallelTask* m_task;
+	int32 m_count;
+	volatile int32 m_next;
+	int32 m_generation;
+	int32 m_busyCount;
+	bool m_quit;
+};
+
+inline int32 b2ThreadPool::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+#endif
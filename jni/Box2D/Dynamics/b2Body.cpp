@@ -84,6 +84,9 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_sweep.a = bd->angle;
 	m_sweep.alpha0 = 0.0f;
 
+	m_previousCenter = m_sweep.c;
+	m_previousAngle = m_sweep.a;
+
 	m_jointList = NULL;
 	m_contactList = NULL;
 	m_controllerList = NULL;
@@ -309,6 +312,8 @@ void b2Body::ResetMassData()
 		m_sweep.c0 = m_xf.p;
 		m_sweep.c = m_xf.p;
 		m_sweep.a0 = m_sweep.a;
+		m_previousCenter = m_sweep.c;
+		m_previousAngle = m_sweep.a;
 		return;
 	}
 
@@ -361,6 +366,7 @@ void b2Body::ResetMassData()
 	b2Vec2 oldCenter = m_sweep.c;
 	m_sweep.localCenter = localCenter;
 	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	m_previousCenter += m_sweep.c - oldCenter;
 
 	// Update center of mass velocity.
 	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
@@ -402,6 +408,7 @@ void b2Body::SetMassData(const b2MassData* massData)
 	b2Vec2 oldCenter = m_sweep.c;
 	m_sweep.localCenter =  massData->center;
 	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	m_previousCenter += m_sweep.c - oldCenter;
 
 	// Update center of mass velocity.
 	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
@@ -447,6 +454,10 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 	m_sweep.c0 = m_sweep.c;
 	m_sweep.a0 = angle;
 
+	// A teleport is not interpolated.
+	m_previousCenter = m_sweep.c;
+	m_previousAngle = angle;
+
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
@@ -458,9 +469,7 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 
 void b2Body::SynchronizeFixtures()
 {
-	b2Transform xf1;
-	xf1.q.Set(m_sweep.a0);
-	xf1.p = m_sweep.c0 - b2Mul(xf1.q, m_sweep.localCenter);
+	b2Transform xf1 = GetSweepTransform0();
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
@@ -469,6 +478,36 @@ void b2Body::SynchronizeFixtures()
 	}
 }
 
+void b2Body::ComputeFixtureAABBs()
+{
+	b2Transform xf1 = GetSweepTransform0();
+
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		f->ComputeSweptAABBs(xf1, m_xf);
+	}
+}
+
+void b2Body::MoveFixtureProxies()
+{
+	b2Transform xf1 = GetSweepTransform0();
+	b2Vec2 displacement = m_xf.p - xf1.p;
+
+	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		f->MoveProxies(broadPhase, displacement);
+	}
+}
+
+b2Transform b2Body::GetSweepTransform0() const
+{
+	b2Transform xf1;
+	xf1.q.Set(m_sweep.a0);
+	xf1.p = m_sweep.c0 - b2Mul(xf1.q, m_sweep.localCenter);
+	return xf1;
+}
+
 void b2Body::SetActive(bool flag)
 {
 	b2Assert(m_world->IsLocked() == false);
@@ -411,6 +411,7 @@ private:
 
 	friend class b2World;
 	friend class b2Island;
+	friend class b2FixtureAABBTask;
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
 	friend class b2Contact;
@@ -426,6 +427,8 @@ private:
 	friend class b2FrictionJoint;
 	friend class b2RopeJoint;
 
+	friend class wyBox2D;
+
 	// m_flags
 	enum
 	{
@@ -444,6 +447,12 @@ private:
 	void SynchronizeFixtures();
 	void SynchronizeTransform();
 
+	// SynchronizeFixtures in two passes. The first one doesn't touch the broad-phase,
+	// so bodies may run it in parallel before the proxies are moved in body order.
+	void ComputeFixtureAABBs();
+	void MoveFixtureProxies();
+	b2Transform GetSweepTransform0() const;
+
 	// This is used to prevent connected bodies from colliding.
 	// It may lie, depending on the collideConnected flag.
 	bool ShouldCollide(const b2Body* other) const;
@@ -459,6 +468,11 @@ private:
 	b2Transform m_xf;		// the body origin transform
 	b2Sweep m_sweep;		// the swept motion for CCD
 
+	// Center of mass and angle before the last step. Used to interpolate
+	// rendering between fixed steps.
+	b2Vec2 m_previousCenter;
+	float32 m_previousAngle;
+
 	b2Vec2 m_linearVelocity;
 	float32 m_angularVelocity;
 
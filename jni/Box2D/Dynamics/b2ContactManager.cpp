@@ -169,9 +169,9 @@ void b2ContactManager::Collide()
 	}
 }
 
-void b2ContactManager::FindNewContacts()
+void b2ContactManager::FindNewContacts(b2ThreadPool* threadPool)
 {
-	m_broadPhase.UpdatePairs(this);
+	m_broadPhase.UpdatePairs(this, threadPool);
 }
 
 void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
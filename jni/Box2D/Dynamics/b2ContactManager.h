@@ -25,6 +25,7 @@ class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+class b2ThreadPool;
 
 // Delegate of b2World.
 class BOX2D_API b2ContactManager
@@ -35,7 +36,7 @@ public:
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
 
-	void FindNewContacts();
+	void FindNewContacts(b2ThreadPool* threadPool = NULL);
 
 	void Destroy(b2Contact* c);
 
@@ -207,6 +207,12 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 		return;
 	}
 
+	ComputeSweptAABBs(transform1, transform2);
+	MoveProxies(broadPhase, transform2.p - transform1.p);
+}
+
+void b2Fixture::ComputeSweptAABBs(const b2Transform& transform1, const b2Transform& transform2)
+{
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
@@ -217,9 +223,14 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 		m_shape->ComputeAABB(&aabb2, transform2, proxy->childIndex);
 	
 		proxy->aabb.Combine(aabb1, aabb2);
+	}
+}
 
-		b2Vec2 displacement = transform2.p - transform1.p;
-
+void b2Fixture::MoveProxies(b2BroadPhase* broadPhase, const b2Vec2& displacement)
+{
+	for (int32 i = 0; i < m_proxyCount; ++i)
+	{
+		b2FixtureProxy* proxy = m_proxies + i;
 		broadPhase->MoveProxy(proxy->proxyId, proxy->aabb, displacement);
 	}
 }
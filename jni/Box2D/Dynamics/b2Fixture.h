@@ -252,6 +252,11 @@ protected:
 
 	void Synchronize(b2BroadPhase* broadPhase, const b2Transform& xf1, const b2Transform& xf2);
 
+	// The two halves of Synchronize. Computing the swept AABBs only touches this
+	// fixture, so fixtures of different bodies may do it in parallel.
+	void ComputeSweptAABBs(const b2Transform& xf1, const b2Transform& xf2);
+	void MoveProxies(b2BroadPhase* broadPhase, const b2Vec2& displacement);
+
 	float32 m_density;
 
 	b2Fixture* m_next;
@@ -168,10 +168,56 @@ b2Island::b2Island(
 
 	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
 	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+
+	m_solverPositions = m_positions;
+	m_solverVelocities = m_velocities;
+
+	m_staticBodies = NULL;
+	m_staticCount = 0;
+
+	m_impulses = NULL;
+	m_ownsBuffers = true;
+}
+
+b2Island::b2Island(const b2IslandDef* def)
+{
+	m_bodyCapacity = def->bodyCount;
+	m_contactCapacity = def->contactCount;
+	m_jointCapacity = def->jointCount;
+	m_bodyCount = def->bodyCount;
+	m_contactCount = def->contactCount;
+	m_jointCount = def->jointCount;
+
+	m_allocator = def->allocator;
+	m_listener = def->listener;
+
+	m_bodies = def->bodies;
+	m_contacts = def->contacts;
+	m_joints = def->joints;
+
+	// The bodies own a contiguous range of the thread buffers, so the
+	// integration loops can still walk them with the local index.
+	int32 base = m_bodyCount > 0 ? m_bodies[0]->m_islandIndex : 0;
+	m_positions = def->positions + base;
+	m_velocities = def->velocities + base;
+
+	m_solverPositions = def->positions;
+	m_solverVelocities = def->velocities;
+
+	m_staticBodies = def->staticBodies;
+	m_staticCount = def->staticCount;
+
+	m_impulses = def->impulses;
+	m_ownsBuffers = false;
 }
 
 b2Island::~b2Island()
 {
+	if (m_ownsBuffers == false)
+	{
+		return;
+	}
+
 	// Warning: the order should reverse the constructor order.
 	m_allocator->Free(m_positions);
 	m_allocator->Free(m_velocities);
@@ -223,21 +269,32 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		m_velocities[i].w = w;
 	}
 
+	// Static bodies shared with other islands never move, but the solvers still read their state.
+	for (int32 i = 0; i < m_staticCount; ++i)
+	{
+		b2Body* b = m_staticBodies[i];
+		int32 index = b->m_islandIndex;
+		m_solverPositions[index].c = b->m_sweep.c;
+		m_solverPositions[index].a = b->m_sweep.a;
+		m_solverVelocities[index].v.SetZero();
+		m_solverVelocities[index].w = 0.0f;
+	}
+
 	timer.Reset();
 
 	// Solver data
 	b2SolverData solverData;
 	solverData.step = step;
-	solverData.positions = m_positions;
-	solverData.velocities = m_velocities;
+	solverData.positions = m_solverPositions;
+	solverData.velocities = m_solverVelocities;
 
 	// Initialize velocity constraints.
 	b2ContactSolverDef contactSolverDef;
 	contactSolverDef.step = step;
 	contactSolverDef.contacts = m_contacts;
 	contactSolverDef.count = m_contactCount;
-	contactSolverDef.positions = m_positions;
-	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.positions = m_solverPositions;
+	contactSolverDef.velocities = m_solverVelocities;
 	contactSolverDef.allocator = m_allocator;
 
 	b2ContactSolver contactSolver(&contactSolverDef);
@@ -534,6 +591,13 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
 		}
 
+		// Islands solved in parallel report from the calling thread later.
+		if (m_impulses)
+		{
+			m_impulses[i] = impulse;
+			continue;
+		}
+
 		m_listener->PostSolve(c, &impulse);
 	}
 }
@@ -28,14 +28,46 @@ class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
+struct b2ContactImpulse;
 struct b2Profile;
 
+/// Describes an island which the world has already built, so it can be solved
+/// on any thread. The lists are owned by the world and are not copied.
+struct BOX2D_API b2IslandDef
+{
+	/// Dynamic and kinematic bodies. Their m_islandIndex values are contiguous.
+	b2Body** bodies;
+	int32 bodyCount;
+
+	/// Static bodies touched by the contacts and joints of the island.
+	b2Body** staticBodies;
+	int32 staticCount;
+
+	b2Contact** contacts;
+	int32 contactCount;
+
+	b2Joint** joints;
+	int32 jointCount;
+
+	/// Body states of the solving thread, indexed by b2Body::m_islandIndex.
+	b2Position* positions;
+	b2Velocity* velocities;
+
+	/// If not NULL, contact impulses are stored here instead of being reported
+	/// to the listener, one per contact.
+	b2ContactImpulse* impulses;
+
+	b2StackAllocator* allocator;
+	b2ContactListener* listener;
+};
+
 /// This is an internal class.
 class BOX2D_API b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
 			b2StackAllocator* allocator, b2ContactListener* listener);
+	b2Island(const b2IslandDef* def);
 	~b2Island();
 
 	void Clear()
@@ -81,6 +113,17 @@ public:
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
 
+	// The contact and joint solvers index these with b2Body::m_islandIndex. They
+	// are m_positions and m_velocities unless the island was built by the world.
+	b2Position* m_solverPositions;
+	b2Velocity* m_solverVelocities;
+
+	b2Body** m_staticBodies;
+	int32 m_staticCount;
+
+	b2ContactImpulse* m_impulses;
+	bool m_ownsBuffers;
+
 	int32 m_bodyCount;
 	int32 m_jointCount;
 	int32 m_contactCount;
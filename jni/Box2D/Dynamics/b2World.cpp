@@ -32,6 +32,7 @@
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2ThreadPool.h>
 #include <Box2D/Controllers/b2Controller.h>
 #include <new>
 
@@ -66,6 +67,9 @@ b2World::b2World(const b2Vec2& gravity)
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+
+	m_threadPool = NULL;
+	m_islandWorkers = NULL;
 	
 	m_jclWrap = NULL;
 	m_jdlWrap = NULL;
@@ -74,6 +78,8 @@ b2World::b2World(const b2Vec2& gravity)
 
 b2World::~b2World()
 {
+	DestroyThreadPool();
+
 	// Some shapes allocate using b2Alloc.
 	b2Body* b = m_bodyList;
 	while (b)
@@ -415,6 +421,110 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+// Per thread state for solving islands in parallel. A thread writes body states
+// into its own buffers and allocates from its own stack, so islands solved at
+// the same time never share memory. Thread 0 is the calling thread and uses the
+// world's stack allocator.
+struct b2IslandWorker
+{
+	b2StackAllocator* allocator;
+	b2Position* positions;
+	b2Velocity* velocities;
+	int32 capacity;
+};
+
+// An island inside the lists built by b2World::SolveIslandsParallel.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 staticStart;
+	int32 staticCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+	int32 cost;
+	b2Profile profile;
+};
+
+// Orders islands by decreasing size so big islands are not picked up last.
+static int b2IslandCompareQSort(const void* elem1, const void* elem2)
+{
+	const b2IslandRange* range1 = *(const b2IslandRange**)elem1;
+	const b2IslandRange* range2 = *(const b2IslandRange**)elem2;
+
+	if (range1->cost != range2->cost)
+	{
+		return range1->cost > range2->cost ? -1 : 1;
+	}
+
+	return range1->bodyStart < range2->bodyStart ? -1 : 1;
+}
+
+class b2IslandTask : public b2ParallelTask
+{
+public:
+	void Execute(int32 index, int32 threadIndex)
+	{
+		b2IslandRange* range = order[index];
+		b2IslandWorker* worker = workers + threadIndex;
+
+		b2IslandDef def;
+		def.bodies = bodies + range->bodyStart;
+		def.bodyCount = range->bodyCount;
+		def.staticBodies = staticBodies + range->staticStart;
+		def.staticCount = range->staticCount;
+		def.contacts = contacts + range->contactStart;
+		def.contactCount = range->contactCount;
+		def.joints = joints + range->jointStart;
+		def.jointCount = range->jointCount;
+		def.positions = worker->positions;
+		def.velocities = worker->velocities;
+		def.impulses = impulses ? impulses + range->contactStart : NULL;
+		def.allocator = worker->allocator;
+		def.listener = listener;
+
+		b2Island island(&def);
+		island.Solve(&range->profile, *step, gravity, allowSleep);
+	}
+
+	b2IslandRange** order;
+	b2IslandWorker* workers;
+	b2Body** bodies;
+	b2Body** staticBodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+	b2ContactImpulse* impulses;
+	b2ContactListener* listener;
+	const b2TimeStep* step;
+	b2Vec2 gravity;
+	bool allowSleep;
+};
+
+class b2FixtureAABBTask : public b2ParallelTask
+{
+public:
+	enum
+	{
+		e_bodiesPerItem = 32
+	};
+
+	void Execute(int32 index, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+
+		int32 end = b2Min(count, (index + 1) * e_bodiesPerItem);
+		for (int32 i = index * e_bodiesPerItem; i < end; ++i)
+		{
+			bodies[i]->ComputeFixtureAABBs();
+		}
+	}
+
+	b2Body** bodies;
+	int32 count;
+};
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
@@ -427,13 +537,6 @@ void b2World::Solve(const b2TimeStep& step)
     {
 		controller->Step(step);
     }
-    
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
 
 	// Clear all the island flags.
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
@@ -449,123 +552,167 @@ void b2World::Solve(const b2TimeStep& step)
 		j->m_islandFlag = false;
 	}
 
-	// Build and simulate all awake islands.
-	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	// A gear joint reads bodies which may be in other islands, so such worlds
+	// can't solve islands at the same time.
+	if (m_threadPool && HasGearJoint() == false)
 	{
-		if (seed->m_flags & b2Body::e_islandFlag)
+		SolveIslandsParallel(step);
+	}
+	else
+	{
+		SolveIslands(step);
+	}
+
+	{
+		b2Timer timer;
+		// Synchronize fixtures, check for out of range bodies.
+		if (m_threadPool)
 		{
-			continue;
+			SynchronizeFixturesParallel();
 		}
-
-		if (seed->IsAwake() == false || seed->IsActive() == false)
+		else
 		{
-			continue;
+			SynchronizeFixtures();
 		}
 
-		// The seed can be dynamic or kinematic.
-		if (seed->GetType() == b2_staticBody)
+		// Look for new contacts.
+		m_contactManager.FindNewContacts(m_threadPool);
+		m_profile.broadphase = timer.GetMilliseconds();
+	}
+}
+
+// Perform a depth first search (DFS) on the constraint graph and add the
+// connected bodies, contacts and joints to the island.
+void b2World::BuildIsland(b2Body* seed, b2Island* island, b2Body** stack, int32 stackSize)
+{
+	int32 stackCount = 0;
+	stack[stackCount++] = seed;
+	seed->m_flags |= b2Body::e_islandFlag;
+
+	while (stackCount > 0)
+	{
+		// Grab the next body off the stack and add it to the island.
+		b2Body* b = stack[--stackCount];
+		b2Assert(b->IsActive() == true);
+		island->Add(b);
+
+		// Make sure the body is awake.
+		b->SetAwake(true);
+
+		// To keep islands as small as possible, we don't
+		// propagate islands across static bodies.
+		if (b->GetType() == b2_staticBody)
 		{
 			continue;
 		}
 
-		// Reset island and stack.
-		island.Clear();
-		int32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
-
-		// Perform a depth first search (DFS) on the constraint graph.
-		while (stackCount > 0)
+		// Search all contacts connected to this body.
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
 		{
-			// Grab the next body off the stack and add it to the island.
-			b2Body* b = stack[--stackCount];
-			b2Assert(b->IsActive() == true);
-			island.Add(b);
+			b2Contact* contact = ce->contact;
 
-			// Make sure the body is awake.
-			b->SetAwake(true);
+			// Has this contact already been added to an island?
+			if (contact->m_flags & b2Contact::e_islandFlag)
+			{
+				continue;
+			}
 
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
-			if (b->GetType() == b2_staticBody)
+			// Is this contact solid and touching?
+			if (contact->IsEnabled() == false ||
+				contact->IsTouching() == false)
 			{
 				continue;
 			}
 
-			// Search all contacts connected to this body.
-			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			// Skip sensors.
+			bool sensorA = contact->m_fixtureA->m_isSensor;
+			bool sensorB = contact->m_fixtureB->m_isSensor;
+			if (sensorA || sensorB)
 			{
-				b2Contact* contact = ce->contact;
+				continue;
+			}
 
-				// Has this contact already been added to an island?
-				if (contact->m_flags & b2Contact::e_islandFlag)
-				{
-					continue;
-				}
+			island->Add(contact);
+			contact->m_flags |= b2Contact::e_islandFlag;
 
-				// Is this contact solid and touching?
-				if (contact->IsEnabled() == false ||
-					contact->IsTouching() == false)
-				{
-					continue;
-				}
+			b2Body* other = ce->other;
 
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
-				{
-					continue;
-				}
+			// Was the other body already added to this island?
+			if (other->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
 
-				island.Add(contact);
-				contact->m_flags |= b2Contact::e_islandFlag;
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
+		}
 
-				b2Body* other = ce->other;
+		// Search all joints connect to this body.
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			if (je->joint->m_islandFlag == true)
+			{
+				continue;
+			}
 
-				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+			b2Body* other = je->other;
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+			// Don't simulate joints connected to inactive bodies.
+			if (other->IsActive() == false)
+			{
+				continue;
 			}
 
-			// Search all joints connect to this body.
-			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			island->Add(je->joint);
+			je->joint->m_islandFlag = true;
+
+			if (other->m_flags & b2Body::e_islandFlag)
 			{
-				if (je->joint->m_islandFlag == true)
-				{
-					continue;
-				}
+				continue;
+			}
 
-				b2Body* other = je->other;
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
+		}
+	}
+}
 
-				// Don't simulate joints connected to inactive bodies.
-				if (other->IsActive() == false)
-				{
-					continue;
-				}
+// Build and simulate all awake islands one by one.
+void b2World::SolveIslands(const b2TimeStep& step)
+{
+	// Size the island for the worst case.
+	b2Island island(m_bodyCount,
+					m_contactManager.m_contactCount,
+					m_jointCount,
+					&m_stackAllocator,
+					m_contactManager.m_contactListener);
 
-				island.Add(je->joint);
-				je->joint->m_islandFlag = true;
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
 
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
-			}
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
 		}
 
+		// Reset island and stack.
+		island.Clear();
+		BuildIsland(seed, &island, stack, stackSize);
+
 		b2Profile profile;
 		island.Solve(&profile, step, m_gravity, m_allowSleep);
 		m_profile.solveInit += profile.solveInit;
@@ -585,31 +732,310 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 
 	m_stackAllocator.Free(stack);
+}
 
+// Build all awake islands first, then solve them on the thread pool. The islands
+// see the same bodies, contacts and joints in the same order as SolveIslands, so
+// the results are identical. Listener and sleep changes of static bodies are
+// replayed afterwards on this thread in island order.
+void b2World::SolveIslandsParallel(const b2TimeStep& step)
+{
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+
+	// The islands are stored back to back. A static body touched by an island
+	// is moved to its static list, so it can be in many islands.
+	b2Island island(m_bodyCount,
+					m_contactManager.m_contactCount,
+					m_jointCount,
+					&m_stackAllocator,
+					listener);
+
+	// Every static body in a static list was reached by a distinct contact or joint.
+	int32 staticCapacity = m_contactManager.m_contactCount + m_jointCount;
+	b2Body** staticBodies = (b2Body**)m_stackAllocator.Allocate(b2Max(staticCapacity, 1) * sizeof(b2Body*));
+	b2IslandRange* ranges = (b2IslandRange*)m_stackAllocator.Allocate(b2Max(m_bodyCount, 1) * sizeof(b2IslandRange));
+	int32 staticCount = 0;
+	int32 islandCount = 0;
+
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
 	{
-		b2Timer timer;
-		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2IslandRange* range = ranges + islandCount++;
+		range->bodyStart = island.m_bodyCount;
+		range->staticStart = staticCount;
+		range->contactStart = island.m_contactCount;
+		range->jointStart = island.m_jointCount;
+
+		BuildIsland(seed, &island, stack, stackSize);
+
+		// Move static bodies out of the body list. The other bodies keep their
+		// order and get contiguous indices.
+		int32 bodyCount = range->bodyStart;
+		for (int32 i = range->bodyStart; i < island.m_bodyCount; ++i)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			b2Body* b = island.m_bodies[i];
+			if (b->GetType() == b2_staticBody)
 			{
+				// Allow static bodies to participate in other islands.
+				b->m_flags &= ~b2Body::e_islandFlag;
+				b2Assert(staticCount < staticCapacity);
+				staticBodies[staticCount++] = b;
 				continue;
 			}
 
-			if (b->GetType() == b2_staticBody)
+			b->m_islandIndex = bodyCount;
+			island.m_bodies[bodyCount++] = b;
+		}
+		island.m_bodyCount = bodyCount;
+
+		range->bodyCount = island.m_bodyCount - range->bodyStart;
+		range->staticCount = staticCount - range->staticStart;
+		range->contactCount = island.m_contactCount - range->contactStart;
+		range->jointCount = island.m_jointCount - range->jointStart;
+		range->cost = range->bodyCount + range->contactCount + range->jointCount;
+	}
+
+	m_stackAllocator.Free(stack);
+
+	// Static bodies take the slots after all other bodies. Their state is the
+	// same for every island, so each thread simply writes its own copy.
+	for (int32 i = 0; i < staticCount; ++i)
+	{
+		staticBodies[i]->m_islandIndex = -1;
+	}
+	int32 slotCount = island.m_bodyCount;
+	for (int32 i = 0; i < staticCount; ++i)
+	{
+		b2Body* b = staticBodies[i];
+		if (b->m_islandIndex < 0)
+		{
+			b->m_islandIndex = slotCount++;
+		}
+	}
+	b2Assert(slotCount <= m_bodyCount);
+
+	int32 threadCount = m_threadPool->GetThreadCount();
+	m_islandWorkers[0].allocator = &m_stackAllocator;
+	m_islandWorkers[0].positions = island.m_positions;
+	m_islandWorkers[0].velocities = island.m_velocities;
+	m_islandWorkers[0].capacity = m_bodyCount;
+	for (int32 i = 1; i < threadCount; ++i)
+	{
+		b2IslandWorker* worker = m_islandWorkers + i;
+		if (worker->capacity < slotCount)
+		{
+			if (worker->positions)
 			{
-				continue;
+				b2Free(worker->positions);
+				b2Free(worker->velocities);
 			}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+			worker->capacity = b2Max(slotCount, 2 * worker->capacity);
+			worker->positions = (b2Position*)b2Alloc(worker->capacity * sizeof(b2Position));
+			worker->velocities = (b2Velocity*)b2Alloc(worker->capacity * sizeof(b2Velocity));
 		}
+	}
 
-		// Look for new contacts.
-		m_contactManager.FindNewContacts();
-		m_profile.broadphase = timer.GetMilliseconds();
+	b2ContactImpulse* impulses = NULL;
+	if (listener)
+	{
+		impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(b2Max(island.m_contactCount, 1) * sizeof(b2ContactImpulse));
+	}
+
+	b2IslandRange** order = (b2IslandRange**)m_stackAllocator.Allocate(b2Max(islandCount, 1) * sizeof(b2IslandRange*));
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		order[i] = ranges + i;
+	}
+	qsort(order, islandCount, sizeof(b2IslandRange*), b2IslandCompareQSort);
+
+	b2IslandTask task;
+	task.order = order;
+	task.workers = m_islandWorkers;
+	task.bodies = island.m_bodies;
+	task.staticBodies = staticBodies;
+	task.contacts = island.m_contacts;
+	task.joints = island.m_joints;
+	task.impulses = impulses;
+	task.listener = listener;
+	task.step = &step;
+	task.gravity = m_gravity;
+	task.allowSleep = m_allowSleep;
+	m_threadPool->Run(&task, islandCount);
+
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		b2IslandRange* range = ranges + i;
+		m_profile.solveInit += range->profile.solveInit;
+		m_profile.solveVelocity += range->profile.solveVelocity;
+		m_profile.solvePosition += range->profile.solvePosition;
+
+		// Static bodies go to sleep with the island, and wake up again if a later island touches them.
+		bool asleep = island.m_bodies[range->bodyStart]->IsAwake() == false;
+		for (int32 j = 0; j < range->staticCount; ++j)
+		{
+			staticBodies[range->staticStart + j]->SetAwake(asleep == false);
+		}
+	}
+
+	// Contacts are stored in island order, so this is the order of SolveIslands.
+	if (listener)
+	{
+		for (int32 i = 0; i < island.m_contactCount; ++i)
+		{
+			listener->PostSolve(island.m_contacts[i], impulses + i);
+		}
+	}
+
+	m_stackAllocator.Free(order);
+	if (impulses)
+	{
+		m_stackAllocator.Free(impulses);
 	}
+	m_stackAllocator.Free(ranges);
+	m_stackAllocator.Free(staticBodies);
+}
+
+void b2World::SynchronizeFixtures()
+{
+	for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	{
+		// If a body was not in an island then it did not move.
+		if ((b->m_flags & b2Body::e_islandFlag) == 0)
+		{
+			continue;
+		}
+
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		// Update fixtures (for broad-phase).
+		b->SynchronizeFixtures();
+	}
+}
+
+// The swept AABBs are computed on the thread pool. The proxies are moved here
+// in body list order, which keeps the broad-phase tree the same as SynchronizeFixtures.
+void b2World::SynchronizeFixturesParallel()
+{
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(b2Max(m_bodyCount, 1) * sizeof(b2Body*));
+	int32 count = 0;
+	for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	{
+		// If a body was not in an island then it did not move.
+		if ((b->m_flags & b2Body::e_islandFlag) == 0)
+		{
+			continue;
+		}
+
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		bodies[count++] = b;
+	}
+
+	b2FixtureAABBTask task;
+	task.bodies = bodies;
+	task.count = count;
+	m_threadPool->Run(&task, (count + b2FixtureAABBTask::e_bodiesPerItem - 1) / b2FixtureAABBTask::e_bodiesPerItem);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		bodies[i]->MoveFixtureProxies();
+	}
+
+	m_stackAllocator.Free(bodies);
+}
+
+bool b2World::HasGearJoint() const
+{
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		if (j->GetType() == e_gearJoint)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void b2World::SetThreadCount(int32 count)
+{
+	b2Assert(IsLocked() == false);
+	b2Assert(count > 0);
+	if (IsLocked() || count == GetThreadCount())
+	{
+		return;
+	}
+
+	DestroyThreadPool();
+
+	if (count > 1)
+	{
+		m_threadPool = new (b2Alloc(sizeof(b2ThreadPool))) b2ThreadPool(count);
+
+		// Worker 0 is filled in by every solve, it uses the world's buffers.
+		m_islandWorkers = (b2IslandWorker*)b2Alloc(count * sizeof(b2IslandWorker));
+		memset(m_islandWorkers, 0, count * sizeof(b2IslandWorker));
+		for (int32 i = 1; i < count; ++i)
+		{
+			m_islandWorkers[i].allocator = new (b2Alloc(sizeof(b2StackAllocator))) b2StackAllocator;
+		}
+	}
+}
+
+int32 b2World::GetThreadCount() const
+{
+	return m_threadPool ? m_threadPool->GetThreadCount() : 1;
+}
+
+void b2World::DestroyThreadPool()
+{
+	if (m_threadPool == NULL)
+	{
+		return;
+	}
+
+	int32 count = m_threadPool->GetThreadCount();
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2IslandWorker* worker = m_islandWorkers + i;
+		worker->allocator->~b2StackAllocator();
+		b2Free(worker->allocator);
+		if (worker->positions)
+		{
+			b2Free(worker->positions);
+			b2Free(worker->velocities);
+		}
+	}
+	b2Free(m_islandWorkers);
+	m_islandWorkers = NULL;
+
+	m_threadPool->~b2ThreadPool();
+	b2Free(m_threadPool);
+	m_threadPool = NULL;
 }
 
 // Find TOI contacts and solve them.
@@ -940,7 +1366,7 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & e_newFixture)
 	{
-		m_contactManager.FindNewContacts();
+		m_contactManager.FindNewContacts(m_threadPool);
 		m_flags &= ~e_newFixture;
 	}
 
@@ -1408,4 +1834,4 @@ void b2World::DestroyController(b2Controller* controller) {
 	--m_controllerCount;
 
 	b2Controller::Destroy(controller, &m_blockAllocator);
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -38,6 +38,9 @@ class b2Fixture;
 class b2Joint;
 class wyBox2D;
 class b2Controller;
+class b2Island;
+class b2ThreadPool;
+struct b2IslandWorker;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -212,6 +215,17 @@ public:
 	/// Get the flag that controls automatic clearing of forces after each time step.
 	bool GetAutoClearForces() const;
 
+	/// Set the number of threads used to solve islands and to find new contacts.
+	/// The calling thread is one of them, so 1 (the default) does all the work on
+	/// the calling thread. The simulation is the same for any thread count, only
+	/// contact listener calls are made after all islands are solved. Worlds with
+	/// gear joints always solve islands on the calling thread.
+	/// @warning this should be called outside of a time step.
+	void SetThreadCount(int32 count);
+
+	/// Get the number of threads used by a time step.
+	int32 GetThreadCount() const;
+
 	/// Get the contact manager for testing.
 	const b2ContactManager& GetContactManager() const;
 
@@ -247,6 +261,14 @@ private:
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
+	void BuildIsland(b2Body* seed, b2Island* island, b2Body** stack, int32 stackSize);
+	void SolveIslands(const b2TimeStep& step);
+	void SolveIslandsParallel(const b2TimeStep& step);
+	void SynchronizeFixtures();
+	void SynchronizeFixturesParallel();
+	bool HasGearJoint() const;
+	void DestroyThreadPool();
+
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
@@ -284,6 +306,10 @@ private:
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+
+	// Only created for more than one thread.
+	b2ThreadPool* m_threadPool;
+	b2IslandWorker* m_islandWorkers;
 	
 	wyBox2D* m_box2d;
 
@@ -30,6 +30,7 @@
 #include "wyPrimitives.h"
 #include "wyLog.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
 
 #define LINE_COLOR 0.0f, 0.0f, 0.0f, 1.0f
 
@@ -124,6 +125,8 @@ wyBox2DDebugDraw::wyBox2DDebugDraw() {
 }
 
 void wyBox2DDebugDraw::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) {
+	wyRenderQueue::getInstance()->flush();
+
 	GLfloat* VAR = (GLfloat*)malloc(vertexCount * 2 * sizeof(GLfloat));
 
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -136,6 +139,7 @@ void wyBox2DDebugDraw::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, co
 
 	glColor4f(color.r, color.g, color.b, 1.f);
 	glDrawArrays(GL_LINE_STRIP, 0, vertexCount);
+	wyRenderQueue::getInstance()->countDrawCall();
 
 	glDisableClientState(GL_VERTEX_ARRAY);
 
@@ -143,6 +147,8 @@ void wyBox2DDebugDraw::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, co
 }
 
 void wyBox2DDebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) {
+	wyRenderQueue::getInstance()->flush();
+
 	GLfloat* VAR = (GLfloat*)malloc((vertexCount + 1) * 2 * sizeof(GLfloat));
 
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -157,9 +163,11 @@ void wyBox2DDebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCoun
 
 	glColor4f(color.r, color.g, color.b, 1.f);
 	glDrawArrays(GL_TRIANGLE_FAN, 0, vertexCount);
+	wyRenderQueue::getInstance()->countDrawCall();
 
 	glColor4f(LINE_COLOR);
 	glDrawArrays(GL_LINE_STRIP, 0, vertexCount + 1);
+	wyRenderQueue::getInstance()->countDrawCall();
 
 	glDisableClientState(GL_VERTEX_ARRAY);
 
@@ -167,6 +175,8 @@ void wyBox2DDebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCoun
 }
 
 void wyBox2DDebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color) {
+	wyRenderQueue::getInstance()->flush();
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 
 	glVertexPointer(2, GL_FLOAT, 0, circleVAR);
@@ -178,6 +188,7 @@ void wyBox2DDebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2
 
 		glColor4f(color.r, color.g, color.b, 1.f);
 		glDrawArrays(GL_LINE_STRIP, 0, circleVAR_count);
+		wyRenderQueue::getInstance()->countDrawCall();
 	}
 	glPopMatrix();
 
@@ -185,6 +196,8 @@ void wyBox2DDebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2
 }
 
 void wyBox2DDebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color) {
+	wyRenderQueue::getInstance()->flush();
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glVertexPointer(2, GL_FLOAT, 0, circleVAR);
 
@@ -201,9 +214,11 @@ void wyBox2DDebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius, con
 
 		glColor4f(color.r, color.g, color.b, 1.f);
 		glDrawArrays(GL_TRIANGLE_FAN, 0, circleVAR_count - 1);
+		wyRenderQueue::getInstance()->countDrawCall();
 
 		glColor4f(LINE_COLOR);
 		glDrawArrays(GL_LINE_STRIP, 0, circleVAR_count);
+		wyRenderQueue::getInstance()->countDrawCall();
 	}
 	glPopMatrix();
 
@@ -236,7 +251,16 @@ wyBox2D::wyBox2D() :
 		m_world(new b2World(b2Vec2(0, 0))),
 		m_ddImpl(WYNEW wyBox2DDebugDraw()),
 		m_debugDraw(false),
-		m_render(NULL) {
+		m_render(NULL),
+		m_fixedTimeStep(0),
+		m_maxSubSteps(5),
+		m_accumulator(0),
+		m_alpha(1),
+		m_velocityIterations(10),
+		m_positionIterations(10),
+		m_stepTimer(NULL),
+		m_savedTransforms(NULL),
+		m_savedTransformCapacity(0) {
 	// default meter pixels
 	setMeterPixels(MIN(wyDevice::winWidth, wyDevice::winHeight) / 20);
 
@@ -257,9 +281,17 @@ wyBox2D::~wyBox2D() {
 
 	WYDELETE(m_ddImpl);
 	m_ddImpl = NULL;
+
+	if(m_savedTransforms != NULL) {
+		wyFree(m_savedTransforms);
+		m_savedTransforms = NULL;
+	}
 }
 
 void wyBox2D::draw() {
+	// draw bodies between last two steps, and put them back after drawing
+	bool interpolated = applyInterpolatedTransforms();
+
 	if(m_debugDraw) {
 		glEnable(GL_LINE_SMOOTH);
 		glEnable(GL_POINT_SMOOTH);
@@ -273,6 +305,123 @@ void wyBox2D::draw() {
 	} else if(m_render != NULL) {
 		m_render->drawWorld(this);
 	}
+
+	if(interpolated)
+		restoreTransforms();
+}
+
+bool wyBox2D::applyInterpolatedTransforms() {
+	if(m_fixedTimeStep <= 0 || m_alpha >= 1.f)
+		return false;
+
+	// ensure buffer
+	int count = m_world->GetBodyCount();
+	if(count == 0)
+		return false;
+	if(count > m_savedTransformCapacity) {
+		m_savedTransformCapacity = count * 2;
+		m_savedTransforms = (b2Transform*)wyRealloc(m_savedTransforms, m_savedTransformCapacity * sizeof(b2Transform));
+	}
+
+	// body list order doesn't change during drawing, so restore can walk it again
+	b2Transform* saved = m_savedTransforms;
+	for(b2Body* b = m_world->GetBodyList(); b; b = b->GetNext()) {
+		*saved++ = b->m_xf;
+		if(b->GetType() != b2_staticBody)
+			b->m_xf = getInterpolatedTransform(b);
+	}
+
+	return true;
+}
+
+void wyBox2D::restoreTransforms() {
+	b2Transform* saved = m_savedTransforms;
+	for(b2Body* b = m_world->GetBodyList(); b; b = b->GetNext()) {
+		b->m_xf = *saved++;
+	}
+}
+
+void wyBox2D::setFixedTimeStep(float hz, int maxSubSteps) {
+	m_fixedTimeStep = hz > 0 ? 1.f / hz : 0;
+	m_maxSubSteps = MAX(1, maxSubSteps);
+	m_accumulator = 0;
+	m_alpha = 1;
+}
+
+void wyBox2D::setIterations(int velocityIterations, int positionIterations) {
+	m_velocityIterations = velocityIterations;
+	m_positionIterations = positionIterations;
+}
+
+void wyBox2D::step(float delta) {
+	// variable step
+	if(m_fixedTimeStep <= 0) {
+		m_world->Step(delta, m_velocityIterations, m_positionIterations);
+		m_alpha = 1;
+		return;
+	}
+
+	// forces applied for this frame must act on every sub step of this frame, so
+	// clear them after all steps instead of after the first one. They are cleared
+	// even if no step is run, otherwise a force applied in every frame is stacked
+	// and acts twice or more on next step
+	bool autoClearForces = m_world->GetAutoClearForces();
+	m_world->SetAutoClearForces(false);
+
+	m_accumulator += delta;
+	int steps = 0;
+	while(m_accumulator >= m_fixedTimeStep && steps < m_maxSubSteps) {
+		// remember state before step, it is the start point of interpolation
+		for(b2Body* b = m_world->GetBodyList(); b; b = b->GetNext()) {
+			b->m_previousCenter = b->m_sweep.c;
+			b->m_previousAngle = b->m_sweep.a;
+		}
+
+		m_world->Step(m_fixedTimeStep, m_velocityIterations, m_positionIterations);
+		m_accumulator -= m_fixedTimeStep;
+		steps++;
+	}
+
+	m_world->SetAutoClearForces(autoClearForces);
+	if(autoClearForces)
+		m_world->ClearForces();
+
+	// can't catch up, drop the time left so that later frames don't run max steps too
+	if(m_accumulator >= m_fixedTimeStep)
+		m_accumulator = fmodf(m_accumulator, m_fixedTimeStep);
+
+	m_alpha = m_accumulator / m_fixedTimeStep;
+}
+
+void wyBox2D::setAutoStep(bool flag) {
+	if(flag) {
+		if(m_stepTimer == NULL) {
+			wyTargetSelector* ts = wyTargetSelector::make(this, SEL(wyBox2D::onStepTimer));
+			m_stepTimer = wyTimer::make(ts);
+			scheduleLocked(m_stepTimer);
+		}
+	} else if(m_stepTimer != NULL) {
+		// node holds the only reference of timer
+		unscheduleLocked(m_stepTimer);
+		m_stepTimer = NULL;
+	}
+}
+
+void wyBox2D::onStepTimer(wyTargetSelector* ts) {
+	step(ts->getDelta());
+}
+
+b2Transform wyBox2D::getInterpolatedTransform(b2Body* body) {
+	if(m_fixedTimeStep <= 0 || body->GetType() == b2_staticBody)
+		return body->GetTransform();
+
+	// same as b2Body::SynchronizeTransform, but with interpolated sweep
+	float a = m_alpha;
+	b2Vec2 c = (1.f - a) * body->m_previousCenter + a * body->m_sweep.c;
+	b2Transform xf;
+	xf.q.Set((1.f - a) * body->m_previousAngle + a * body->m_sweep.a);
+	xf.p = c - b2Mul(xf.q, body->m_sweep.localCenter);
+	return xf;
 }
 
 float wyBox2D::getMeterPixels() {
@@ -32,6 +32,7 @@
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
 #include "wyBox2D.h"
 #include "wyLog.h"
+#include "wyRenderQueue.h"
 
 static const GLfloat circleVAR[] = { 0.0000f, 0.0000f,
 	0.0000f, 1.0000f, 0.2588f, 0.9659f, 0.5000f, 0.8660f, 0.7071f, 0.7071f, 0.8660f, 0.5000f, 0.9659f, 0.2588f,
@@ -175,6 +176,8 @@ void wyBox2DRender::drawShape(wyBox2D* box2d, b2Fixture* fixture, b2Body* body)
 }
 
 void wyBox2DRender::drawCircle(wyBox2D* box2d, b2Fixture* fixture, b2Body* body, wyTexture2D* tex, wyRect rect) {
+	wyRenderQueue::getInstance()->flush();
+
 	// check texture
 	if(tex == NULL)
 		return;
@@ -227,6 +230,7 @@ void wyBox2DRender::drawCircle(wyBox2D* box2d, b2Fixture* fixture, b2Body* body,
 		glScalef(box2d->meter2Pixel(radius), box2d->meter2Pixel(radius), 1.0f);
 
 		glDrawArrays(GL_TRIANGLE_FAN, 0, circleVAR_count);
+		wyRenderQueue::getInstance()->countDrawCall();
 	}
 	glPopMatrix();
 
@@ -237,6 +241,8 @@ void wyBox2DRender::drawCircle(wyBox2D* box2d, b2Fixture* fixture, b2Body* body,
 }
 
 void wyBox2DRender::drawEdge(wyBox2D* box2d, b2Fixture* fixture, b2Body* body, wyTexture2D* tex, wyRect rect) {
+	wyRenderQueue::getInstance()->flush();
+
 	// check texture
 	if(tex == NULL)
 		return;
@@ -300,6 +306,7 @@ void wyBox2DRender::drawEdge(wyBox2D* box2d, b2Fixture* fixture, b2Body* body, w
 		glTranslatef(box2d->meter2Pixel(middle.x), box2d->meter2Pixel(middle.y), 0.0f);
 		glRotatef(wyMath::r2d(angle + atan(v.y / v.x)), 0, 0, 1);
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		wyRenderQueue::getInstance()->countDrawCall();
 	}
 	glPopMatrix();
 
@@ -310,6 +317,8 @@ void wyBox2DRender::drawEdge(wyBox2D* box2d, b2Fixture* fixture, b2Body* body, w
 }
 
 void wyBox2DRender::drawChain(wyBox2D* box2d, b2Fixture* fixture, b2Body* body, wyTexture2D* tex, wyRect rect) {
+	wyRenderQueue::getInstance()->flush();
+
 	// check texture
 	if(tex == NULL)
 		return;
@@ -391,6 +400,7 @@ void wyBox2DRender::drawChain(wyBox2D* box2d, b2Fixture* fixture, b2Body* body,
 			glTranslatef(box2d->meter2Pixel(xf.p.x), box2d->meter2Pixel(xf.p.y), 0.0f);
 			glRotatef(wyMath::r2d(angle + slop), 0, 0, 1);
 			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			wyRenderQueue::getInstance()->countDrawCall();
 		}
 		glPopMatrix();
 	}
@@ -402,6 +412,8 @@ void wyBox2DRender::drawChain(wyBox2D* box2d, b2Fixture* fixture, b2Body* body,
 }
 
 void wyBox2DRender::drawPolygon(wyBox2D* box2d, b2Fixture* fixture, b2Body* body, wyTexture2D* tex, wyRect rect) {
+	wyRenderQueue::getInstance()->flush();
+
 	// check texture
 	if(tex == NULL)
 		return;
@@ -455,6 +467,7 @@ void wyBox2DRender::drawPolygon(wyBox2D* box2d, b2Fixture* fixture, b2Body* body
 		glTranslatef(box2d->meter2Pixel(xf.p.x), box2d->meter2Pixel(xf.p.y), 0.0f);
 		glRotatef(wyMath::r2d(xf.q.GetAngle()), 0, 0, 1);
 		glDrawArrays(GL_TRIANGLE_FAN, 0, count);
+		wyRenderQueue::getInstance()->countDrawCall();
 	}
 	glPopMatrix();
 
@@ -28,6 +28,7 @@
  */
 #include "wyNode.h"
 #include "wyAction.h"
+#include "wyActionManager.h"
 
 #if ANDROID
 #include "wyJNI.h"
@@ -45,7 +46,9 @@ wyAction::wyAction() :
 #if ANDROID
 		j_callback(NULL),
 #endif
-		m_data(NULL) {
+		m_data(NULL),
+		m_tweenChannel(-1),
+		m_tweenIndex(-1) {
 	memset(&m_callback, 0, sizeof(wyActionCallback));
 }
 
@@ -86,6 +89,10 @@ void wyAction::start(wyNode* target) {
 }
 
 void wyAction::stop() {
+	// stopped action must leave tween buffer
+	if(m_tweenIndex != -1)
+		wyActionManager::getInstance()->unpackAction(this);
+
 	if(m_running) {
 		// set flag
 		m_running = false;
@@ -106,7 +113,23 @@ bool wyAction::isDone() {
 	return true;
 }
 
+bool wyAction::packTween(wyTween* tween) {
+	return false;
+}
+
+bool wyAction::hasCallback() {
+#if ANDROID
+	if(j_callback != NULL)
+		return true;
+#endif
+	return m_callback.onStart != NULL || m_callback.onStop != NULL || m_callback.onUpdate != NULL;
+}
+
 void wyAction::setCallback(wyActionCallback* callback, void* data) {
+	// packed action doesn't invoke callback, so go back to normal path
+	if(m_tweenIndex != -1)
+		wyActionManager::getInstance()->unpackAction(this);
+
 	if(callback == NULL) {
 		memset(&m_callback, 0, sizeof(wyActionCallback));
 		m_data = NULL;
@@ -119,6 +142,10 @@ void wyAction::setCallback(wyActionCallback* callback, void* data) {
 #if ANDROID
 
 void wyAction::setCallback(jobject jcallback) {
+	// packed action doesn't invoke callback, so go back to normal path
+	if(m_tweenIndex != -1)
+		wyActionManager::getInstance()->unpackAction(this);
+
 	JNIEnv* env = getEnv();
 	if(j_callback != NULL) {
 		env->DeleteGlobalRef(j_callback);
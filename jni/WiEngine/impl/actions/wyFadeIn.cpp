@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyFadeIn.h"
+#include "wyTween.h"
 #include "wyFadeOut.h"
 #include "wyNode.h"
 #include "wyLog.h"
@@ -72,6 +73,17 @@ void wyFadeIn::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyFadeIn::packTween(wyTween* tween) {
+	// children are updated recursively, can't be packed
+	if(hasCallback() || m_includeChildren)
+		return false;
+
+	tween->channel = WY_TWEEN_ALPHA;
+	tween->from[0] = 0;
+	tween->delta[0] = 255.0f;
+	return true;
+}
+
 void wyFadeIn::updateAlpha(wyNode* node, int alpha) {
 	node->setAlpha(alpha);
 
@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyFadeOut.h"
+#include "wyTween.h"
 #include "wyFadeIn.h"
 #include "wyNode.h"
 
@@ -71,6 +72,17 @@ void wyFadeOut::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyFadeOut::packTween(wyTween* tween) {
+	// children are updated recursively, can't be packed
+	if(hasCallback() || m_includeChildren)
+		return false;
+
+	tween->channel = WY_TWEEN_ALPHA;
+	tween->from[0] = 255.0f;
+	tween->delta[0] = -255.0f;
+	return true;
+}
+
 void wyFadeOut::updateAlpha(wyNode* node, int alpha) {
 	node->setAlpha(alpha);
 
@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyFadeTo.h"
+#include "wyTween.h"
 #include "wyNode.h"
 
 wyAction* wyFadeTo::copy() {
@@ -56,6 +57,17 @@ void wyFadeTo::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyFadeTo::packTween(wyTween* tween) {
+	// children are updated recursively, can't be packed
+	if(hasCallback() || m_includeChildren)
+		return false;
+
+	tween->channel = WY_TWEEN_ALPHA;
+	tween->from[0] = m_fromAlpha;
+	tween->delta[0] = m_toAlpha - m_fromAlpha;
+	return true;
+}
+
 wyFadeTo::wyFadeTo(float duration, int fromAlpha, int toAlpha, bool includeChildren) :
 		wyIntervalAction(duration),
 		m_toAlpha(toAlpha),
@@ -28,6 +28,7 @@
  */
 #include "wyFiniteTimeAction.h"
 #include "wyNode.h"
+#include "wyActionManager.h"
 
 wyFiniteTimeAction::wyFiniteTimeAction(float duration) :
 		m_duration(duration),
@@ -57,3 +58,7 @@ void wyFiniteTimeAction::setDuration(float duration) {
 float wyFiniteTimeAction::getDuration() {
 	return m_duration;
 }
+
+float wyFiniteTimeAction::getPackedElapsed() {
+	return wyActionManager::getInstance()->getPackedElapsed(this);
+}
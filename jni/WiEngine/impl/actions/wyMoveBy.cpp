@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyMoveBy.h"
+#include "wyTween.h"
 #include "wyNode.h"
 
 wyMoveBy::~wyMoveBy() {
@@ -77,6 +78,19 @@ void wyMoveBy::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyMoveBy::packTween(wyTween* tween) {
+	// pin point needs world transform, can't be packed
+	if(hasCallback() || m_pinPoint.x != MAX_FLOAT || m_pinPoint.y != MAX_FLOAT)
+		return false;
+
+	tween->channel = WY_TWEEN_POSITION;
+	tween->from[0] = m_startPositionX;
+	tween->from[1] = m_startPositionY;
+	tween->delta[0] = m_deltaX;
+	tween->delta[1] = m_deltaY;
+	return true;
+}
+
 void wyMoveBy::start(wyNode* target) {
 	wyIntervalAction::start(target);
     m_startPositionX = target->getPositionX();
@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyMoveTo.h"
+#include "wyTween.h"
 #include "wyNode.h"
 
 wyMoveTo::~wyMoveTo() {
@@ -77,3 +78,16 @@ void wyMoveTo::update(float t) {
 	// super only call callback
 	wyIntervalAction::update(t);
 }
+
+bool wyMoveTo::packTween(wyTween* tween) {
+	// pin point needs world transform, can't be packed
+	if(hasCallback() || m_pinPoint.x != MAX_FLOAT || m_pinPoint.y != MAX_FLOAT)
+		return false;
+
+	tween->channel = WY_TWEEN_POSITION;
+	tween->from[0] = m_startX;
+	tween->from[1] = m_startY;
+	tween->delta[0] = m_deltaX;
+	tween->delta[1] = m_deltaY;
+	return true;
+}
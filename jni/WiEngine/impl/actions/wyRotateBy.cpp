@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyRotateBy.h"
+#include "wyTween.h"
 #include "wyNode.h"
 #include "wyLog.h"
 
@@ -45,6 +46,16 @@ void wyRotateBy::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyRotateBy::packTween(wyTween* tween) {
+	if(hasCallback())
+		return false;
+
+	tween->channel = WY_TWEEN_ROTATION;
+	tween->from[0] = m_startAngle;
+	tween->delta[0] = m_angle;
+	return true;
+}
+
 void wyRotateBy::start(wyNode* target) {
 	wyIntervalAction::start(target);
 	m_startAngle = target->getRotation();
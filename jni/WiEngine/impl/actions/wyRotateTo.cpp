@@ -1,4 +1,5 @@
 #include "wyRotateTo.h"
+#include "wyTween.h"
 #include "wyNode.h"
 
 wyAction* wyRotateTo::copy() {
@@ -16,6 +17,16 @@ void wyRotateTo::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyRotateTo::packTween(wyTween* tween) {
+	if(hasCallback())
+		return false;
+
+	tween->channel = WY_TWEEN_ROTATION;
+	tween->from[0] = m_startAngle;
+	tween->delta[0] = m_delta;
+	return true;
+}
+
 wyRotateTo::~wyRotateTo() {
 }
 
@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyScaleBy.h"
+#include "wyTween.h"
 #include "wyNode.h"
 
 wyAction* wyScaleBy::copy() {
@@ -45,6 +46,18 @@ void wyScaleBy::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyScaleBy::packTween(wyTween* tween) {
+	if(hasCallback())
+		return false;
+
+	tween->channel = WY_TWEEN_SCALE;
+	tween->from[0] = m_startScaleX;
+	tween->from[1] = m_startScaleY;
+	tween->delta[0] = m_endScaleX - m_startScaleX;
+	tween->delta[1] = m_endScaleY - m_startScaleY;
+	return true;
+}
+
 void wyScaleBy::start(wyNode* target) {
 	wyIntervalAction::start(target);
 
@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyScaleTo.h"
+#include "wyTween.h"
 #include "wyNode.h"
 
 wyAction* wyScaleTo::copy() {
@@ -45,6 +46,18 @@ void wyScaleTo::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyScaleTo::packTween(wyTween* tween) {
+	if(hasCallback())
+		return false;
+
+	tween->channel = WY_TWEEN_SCALE;
+	tween->from[0] = m_startScaleX;
+	tween->from[1] = m_startScaleY;
+	tween->delta[0] = m_deltaX;
+	tween->delta[1] = m_deltaY;
+	return true;
+}
+
 wyScaleTo::~wyScaleTo() {
 }
 
@@ -27,6 +27,7 @@
  * THE SOFTWARE.
  */
 #include "wyTintBy.h"
+#include "wyTween.h"
 #include "wyNode.h"
 
 wyAction* wyTintBy::copy() {
@@ -44,6 +45,20 @@ void wyTintBy::update(float t) {
 	wyIntervalAction::update(t);
 }
 
+bool wyTintBy::packTween(wyTween* tween) {
+	if(hasCallback())
+		return false;
+
+	tween->channel = WY_TWEEN_COLOR;
+	tween->from[0] = m_fromR;
+	tween->from[1] = m_fromG;
+	tween->from[2] = m_fromB;
+	tween->delta[0] = m_deltaR;
+	tween->delta[1] = m_deltaG;
+	tween->delta[2] = m_deltaB;
+	return true;
+}
+
 void wyTintBy::start(wyNode* target) {
 	wyIntervalAction::start(target);
 	wyColor3B c = target->getColor();
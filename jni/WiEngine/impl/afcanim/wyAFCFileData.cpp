@@ -27,11 +27,46 @@
  * THE SOFTWARE.
  */
 #include "wyAFCFileData.h"
+#include "wyAFCAnimation.h"
+#include <string.h>
 
 wyAFCFileData::wyAFCFileData() :
 		m_dataId(0),
-		m_resScale(1) {
+		m_resScale(1),
+		m_animationCache(NULL),
+		m_animationCacheSize(0) {
 }
 
 wyAFCFileData::~wyAFCFileData() {
+	if(m_animationCache) {
+		for(int i = 0; i < m_animationCacheSize; i++) {
+			wyObjectRelease(m_animationCache[i]);
+		}
+		wyFree(m_animationCache);
+		m_animationCache = NULL;
+	}
+}
+
+wyAFCAnimation* wyAFCFileData::getCachedAnimation(int index) {
+	if(index < 0 || index >= m_animationCacheSize)
+		return NULL;
+	else
+		return m_animationCache[index];
+}
+
+void wyAFCFileData::cacheAnimation(int index, wyAFCAnimation* anim) {
+	if(index < 0)
+		return;
+
+	// grow cache
+	if(index >= m_animationCacheSize) {
+		int newSize = MAX(index + 1, m_animationCacheSize * 2);
+		m_animationCache = (wyAFCAnimation**)wyRealloc(m_animationCache, newSize * sizeof(wyAFCAnimation*));
+		memset(m_animationCache + m_animationCacheSize, 0, (newSize - m_animationCacheSize) * sizeof(wyAFCAnimation*));
+		m_animationCacheSize = newSize;
+	}
+
+	wyObjectRetain(anim);
+	wyObjectRelease(m_animationCache[index]);
+	m_animationCache[index] = anim;
 }
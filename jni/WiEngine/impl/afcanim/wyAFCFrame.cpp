@@ -27,6 +27,10 @@
  * THE SOFTWARE.
  */
 #include "wyAFCFrame.h"
+#include "wySpriteBatchNode.h"
+#include "wyTexture2D.h"
+#include "wyMath.h"
+#include <string.h>
 
 bool wyAFCFrame::releaseClip(wyArray* arr, void* ptr, int index, void* data) {
 	wyAFCClip* c = (wyAFCClip*)ptr;
@@ -40,10 +44,14 @@ wyAFCFrame::wyAFCFrame() :
         m_flipX(false),
         m_flipY(false),
 		m_useTickDelay(false),
-		m_inc(wypZero) {
+		m_inc(wypZero),
+		m_bakedClips(NULL),
+		m_bakedCount(0) {
+	memset(m_bakedQuads, 0, sizeof(m_bakedQuads));
 }
 
 wyAFCFrame::~wyAFCFrame() {
+	releaseBakedQuads();
 	wyArrayEach(m_clipList, releaseClip, NULL);
 	wyArrayDestroy(m_clipList);
 }
@@ -57,7 +65,144 @@ void wyAFCFrame::addClip(wyAFCClip* clip) {
 	if(clip) {
 		wyArrayPush(m_clipList, clip);
 		clip->retain();
+
+		// baked quads are stale
+		releaseBakedQuads();
+	}
+}
+
+void wyAFCFrame::releaseBakedQuads() {
+	for(int i = 0; i < 4; i++) {
+		if(m_bakedQuads[i]) {
+			wyFree(m_bakedQuads[i]);
+			m_bakedQuads[i] = NULL;
+		}
+	}
+	if(m_bakedClips) {
+		wyFree(m_bakedClips);
+		m_bakedClips = NULL;
 	}
+	m_bakedCount = 0;
+}
+
+wyAtlasVertex* wyAFCFrame::getBakedQuads(bool flipX, bool flipY, wyArray* sheetList) {
+	int state = (flipX ? 1 : 0) | (flipY ? 2 : 0);
+	if(m_bakedQuads[state])
+		return m_bakedQuads[state];
+	else
+		return bake(flipX, flipY, sheetList);
+}
+
+wyAtlasVertex* wyAFCFrame::bake(bool flipX, bool flipY, wyArray* sheetList) {
+	// texture source doesn't depend on flip state, so it is resolved only once
+	int count = getClipCount(AFC_CLIP_IMAGE);
+	if(!m_bakedClips) {
+		m_bakedCount = count;
+		m_bakedClips = (wyAFCBakedClip*)wyCalloc(MAX(1, count), sizeof(wyAFCBakedClip));
+		int index = 0;
+		for(int i = 0; i < m_clipList->num; i++) {
+			wyAFCClip* clip = getClipAt(i);
+			if(clip->getType() != AFC_CLIP_IMAGE)
+				continue;
+
+			wyAFCClipData& clipData = clip->getData();
+			wyAFCBakedClip& bc = m_bakedClips[index++];
+			bc.sheet = clipData.i.sheet;
+			bc.imageIndex = clipData.i.imageIndex;
+
+			// get texture size, sheet in clip data has higher priority
+			wySpriteBatchNode* sheet = bc.sheet;
+			if(!sheet && sheetList && bc.imageIndex >= 0 && bc.imageIndex < sheetList->num)
+				sheet = (wySpriteBatchNode*)wyArrayGet(sheetList, bc.imageIndex);
+			wyTexture2D* tex = sheet ? sheet->getTexture() : NULL;
+			if(tex) {
+				tex->load();
+				bc.texWidth = tex->getPixelWidth();
+				bc.texHeight = tex->getPixelHeight();
+			}
+		}
+	}
+
+	// calculate quads same as a sprite which is positioned at clip center
+	int state = (flipX ? 1 : 0) | (flipY ? 2 : 0);
+	wyAtlasVertex* quads = (wyAtlasVertex*)wyCalloc(MAX(1, count) * 4, sizeof(wyAtlasVertex));
+	int index = 0;
+	for(int i = 0; i < m_clipList->num; i++) {
+		wyAFCClip* clip = getClipAt(i);
+		if(clip->getType() != AFC_CLIP_IMAGE)
+			continue;
+
+		wyAFCClipData& clipData = clip->getData();
+		wyAFCBakedClip& bc = m_bakedClips[index];
+		wyAtlasVertex* v = quads + index * 4;
+		index++;
+
+		// clip position
+		wyPoint clipPos = clipData.clipPos;
+		if(flipX)
+			clipPos.x = -clipPos.x;
+		if(flipY)
+			clipPos.y = -clipPos.y;
+
+		// flipY is a flipX with 180 degree rotation
+		bool flipTex = clipData.i.flipX;
+		float rotation = clipData.i.rotation;
+		if(flipX) {
+			flipTex = !flipTex;
+			rotation = 360 - rotation;
+		}
+		if(flipY) {
+			flipTex = !flipTex;
+			rotation = 180 - rotation;
+		}
+
+		// transform of clip, center is anchor
+		wyRect& rect = clipData.i.rect;
+		wyAffineTransform t = wyaIdentity;
+		wyaTranslate(&t, clipPos.x, clipPos.y);
+		if(rotation != 0)
+			wyaRotate(&t, -wyMath::d2r(rotation));
+		wyaTranslate(&t, -rect.width / 2, -rect.height / 2);
+
+		// vertices in order of bottom left, bottom right, top left and top right
+		wyPoint corners[4] = {
+			wyp(0, 0),
+			wyp(rect.width, 0),
+			wyp(0, rect.height),
+			wyp(rect.width, rect.height)
+		};
+		for(int j = 0; j < 4; j++) {
+			wyPoint p = wyaTransformPoint(t, corners[j]);
+			v[j].x = p.x;
+			v[j].y = p.y;
+			v[j].z = 0;
+			v[j].color = wyc4bWhite;
+		}
+
+		// texture coordinates, same as sprite in batch node
+		if(bc.texWidth > 0 && bc.texHeight > 0) {
+			float left = (2 * rect.x + 1) / (2 * bc.texWidth);
+			float right = left + (rect.width * 2 - 2) / (2 * bc.texWidth);
+			float top = (2 * rect.y + 1) / (2 * bc.texHeight);
+			float bottom = top + (rect.height * 2 - 2) / (2 * bc.texHeight);
+			if(flipTex) {
+				float tmp = left;
+				left = right;
+				right = tmp;
+			}
+			v[0].u = left;
+			v[0].v = bottom;
+			v[1].u = right;
+			v[1].v = bottom;
+			v[2].u = left;
+			v[2].v = top;
+			v[3].u = right;
+			v[3].v = top;
+		}
+	}
+
+	m_bakedQuads[state] = quads;
+	return quads;
 }
 
 int wyAFCFrame::getClipCount(wyAFCClipType type) {
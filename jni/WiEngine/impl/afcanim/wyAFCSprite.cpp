@@ -30,6 +30,9 @@
 #include "wyLog.h"
 #include "wyPrimitives.h"
 #include <stdarg.h>
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 #if ANDROID
 #include "wyUtils_android.h"
@@ -39,7 +42,10 @@ extern jmethodID g_mid_IAFCSpriteCallback_onAFCAnimationEnded;
 #endif
 
 wyAFCSprite::wyAFCSprite() :
-		m_spriteList(wyArrayNew(10)),
+		m_atlas(WYNEW wyTextureAtlas(NULL, 8)),
+		m_quadSheets(NULL),
+		m_quadSheetCapacity(0),
+		m_quadOffset(wypZero),
 		m_sheetList(wyArrayNew(5)),
 		m_mappingList(wyArrayNew(5)),
 		m_animationData(NULL),
@@ -68,6 +74,8 @@ wyAFCSprite::wyAFCSprite() :
 		m_flipX(false),
 		m_flipY(false),
 		m_data(NULL) {
+	// quads only change when frame is changed
+	m_atlas->setUseBufferObject(true);
 }
 
 wyAFCSprite::~wyAFCSprite() {
@@ -82,8 +90,9 @@ wyAFCSprite::~wyAFCSprite() {
 		m_jCallback = NULL;
 	}
 #endif
-	wyArrayEach(m_spriteList, releaseObject, NULL);
-	wyArrayDestroy(m_spriteList);
+	wyObjectRelease(m_atlas);
+	if(m_quadSheets)
+		wyFree(m_quadSheets);
 	wyArrayEach(m_sheetList, releaseObject, NULL);
 	wyArrayDestroy(m_sheetList);
 	wyArrayEach(m_mappingList, releaseObject, NULL);
@@ -128,25 +137,8 @@ void wyAFCSprite::setAnimationData(wyAFCAnimation* data) {
 	m_animationData = data;
 }
 
-void wyAFCSprite::initSpriteFromAnimationData() {
-	int maxClipNum = 0;
-	for(int i = 0; i < m_numOfFrame; i++) {
-		wyAFCFrame* fd = m_animationData->getFrameAt(i);
-		maxClipNum = MAX(fd->getClipCount(), maxClipNum);
-	}
-
-	int numDifference = maxClipNum - m_spriteList->num;
-	for(int i = 0; i < numDifference; i++) {
-		wySpriteEx* sprite = WYNEW wySpriteEx();
-		sprite->setColor(m_color);
-		wyArrayPush(m_spriteList, sprite);
-	}
-}
-
 void wyAFCSprite::replaceTextures(wyTexture2D* tex, ...) {
 	// release old batch nodes
-	wyArrayEach(m_spriteList, releaseObject, NULL);
-	wyArrayClear(m_spriteList);
 	wyArrayEach(m_sheetList, releaseObject, NULL);
 	wyArrayClear(m_sheetList);
 
@@ -187,8 +179,6 @@ void wyAFCSprite::replaceTextures(wyTexture2D** tex, int count) {
 	}
 
 	// release old batch nodes
-	wyArrayEach(m_spriteList, releaseObject, NULL);
-	wyArrayClear(m_spriteList);
 	wyArrayEach(m_sheetList, releaseObject, NULL);
 	wyArrayDestroy(m_sheetList);
 	m_sheetList = tmp;
@@ -223,13 +213,6 @@ void wyAFCSprite::adjustFrameOffset(wyAFCFrame* frameData) {
 	}
 }
 
-void wyAFCSprite::updateColor() {
-	for(int i = 0; i < m_spriteList->num; i++) {
-		wySpriteEx* sprite = (wySpriteEx*)wyArrayGet(m_spriteList, i);
-		sprite->setColor(m_color);
-	}
-}
-
 void wyAFCSprite::setBlendFunc(wyBlendFunc func) {
 	m_blendFunc = func;
 	for(int i = 0; i < m_sheetList->num; i++) {
@@ -240,7 +223,6 @@ void wyAFCSprite::setBlendFunc(wyBlendFunc func) {
 
 void wyAFCSprite::setAlpha(int alpha) {
 	m_color.a = alpha;
-	updateColor();
 }
 
 wyColor3B wyAFCSprite::getColor() {
@@ -256,7 +238,6 @@ void wyAFCSprite::setColor(wyColor3B color) {
 	m_color.r = color.r;
 	m_color.g = color.g;
 	m_color.b = color.b;
-	updateColor();
 }
 
 void wyAFCSprite::setColor(wyColor4B color) {
@@ -264,7 +245,6 @@ void wyAFCSprite::setColor(wyColor4B color) {
 	m_color.g = color.g;
 	m_color.b = color.b;
 	m_color.a = color.a;
-	updateColor();
 }
 
 void wyAFCSprite::visit() {
@@ -304,6 +284,8 @@ void wyAFCSprite::visit() {
 }
 
 void wyAFCSprite::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -315,42 +297,36 @@ void wyAFCSprite::draw() {
 	if(m_curFrame < 0 || m_curFrame >= m_animationData->getFrameCount())
 		return;
 
-	// reset marker of all sheet to zero
-	for(int i = 0; i < m_spriteList->num; i++) {
-		wySpriteEx* sprite = (wySpriteEx*)wyArrayGet(m_spriteList, i);
-		if(sprite->isVisible()) {
-			wySpriteBatchNode* sheet = (wySpriteBatchNode*)sprite->getParent();
-			sheet->setMarker(0);
-		} else {
-			break;
+	// draw based on clip order, adjacent quads with same sheet are drawn together
+	int count = m_atlas->getTotalQuads();
+	if(count > 0) {
+		// quads don't include frame offset
+		bool hasOffset = m_quadOffset.x != 0 || m_quadOffset.y != 0;
+		if(hasOffset) {
+			glPushMatrix();
+			glTranslatef(m_quadOffset.x, m_quadOffset.y, 0);
 		}
-	}
 
-	// draw based on clip order
-	int numOfQuads = 0;
-	wySpriteBatchNode* lastSheet = NULL;
-	for(int i = 0; i < m_spriteList->num; i++) {
-		wySpriteEx* sprite = (wySpriteEx*)wyArrayGet(m_spriteList, i);
-		if(sprite->isVisible()) {
-			wySpriteBatchNode* sheet = (wySpriteBatchNode*)sprite->getParent();
-			if(sheet != lastSheet) {
-				// draw last sheet
-				if(numOfQuads != 0) {
-					lastSheet->drawFromMarker(numOfQuads);
-				}
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnable(GL_TEXTURE_2D);
+		glColor4f(m_color.r / 255.0f, m_color.g / 255.0f, m_color.b / 255.0f, m_color.a / 255.0f);
 
-				// change last sheet and reset number of quads
-				lastSheet = sheet;
-				numOfQuads = 1;
-			} else {
-				numOfQuads++;
+		int start = 0;
+		for(int i = 1; i <= count; i++) {
+			if(i == count || m_quadSheets[i] != m_quadSheets[start]) {
+				drawQuads(start, i - start, m_quadSheets[start]);
+				start = i;
 			}
 		}
-	}
 
-	// draw last sheet
-	if(numOfQuads != 0) {
-		lastSheet->drawFromMarker(numOfQuads);
+		glColor4f(1, 1, 1, 1);
+		glDisable(GL_TEXTURE_2D);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+		if(hasOffset)
+			glPopMatrix();
 	}
 
 	// check debug draw flag
@@ -394,6 +370,23 @@ void wyAFCSprite::draw() {
 	}
 }
 
+void wyAFCSprite::drawQuads(int start, int count, wySpriteBatchNode* sheet) {
+	// skip clip whose sheet is not found
+	if(!sheet || !sheet->getTexture())
+		return;
+
+	wyBlendFunc blendFunc = sheet->getBlendFunc();
+	bool newBlend = blendFunc.src != DEFAULT_BLEND_SRC || blendFunc.dst != DEFAULT_BLEND_DST;
+	if(newBlend)
+		glBlendFunc(blendFunc.src, blendFunc.dst);
+
+	m_atlas->setTexture(sheet->getTexture());
+	m_atlas->drawRange(start, count);
+
+	if(newBlend)
+		glBlendFunc(DEFAULT_BLEND_SRC, DEFAULT_BLEND_DST);
+}
+
 void wyAFCSprite::addChild(wyNode* child, int z, int tag) {
     wySpriteBatchNode* bn = dynamic_cast<wySpriteBatchNode*>(child);
     if(!bn){
@@ -414,9 +407,8 @@ void wyAFCSprite::playAnimation(int index, wyAFCClipMapping* mapping) {
 	// refresh animation data
 	setAnimationData(getAnimationAt(index, mapping));
 
-	// reset frame index and ensure sprite pool is big enough
+	// reset frame index
 	m_numOfFrame = m_animationData->getFrameCount();
-	initSpriteFromAnimationData();
 
 	// reset loop count
 	m_tmpLoop = m_loop;
@@ -442,18 +434,6 @@ void wyAFCSprite::setFrameIndex(int index) {
 	bool frameChanged = m_curFrame != index;
 	m_curFrame = index;
 
-	// clear all clip sprite from batch node
-	for(int i = 0; i < m_spriteList->num; i++) {
-		wySpriteEx* sprite = (wySpriteEx*)wyArrayGet(m_spriteList, i);
-		if(sprite->isVisible()) {
-			wySpriteBatchNode* sheet = (wySpriteBatchNode*)sprite->getParent();
-			if(sheet)
-				sheet->removeAllChildren(true);
-		} else {
-			break;
-		}
-	}
-
 	// get frame data and adjust frame offset
 	wyAFCFrame* frameData = m_animationData->getFrameAt(index);
 	adjustFrameOffset(frameData);
@@ -466,60 +446,47 @@ void wyAFCSprite::setFrameIndex(int index) {
     bool flipX = m_flipX != frameFlipX;
     bool flipY = m_flipY != frameFlipY;
 
-	// since not all clip data are image clip
-	int imageClipIndex = 0;
-	for (int i = 0; i < frameData->getClipCount(); i++) {
-		wyAFCClip* clip = frameData->getClipAt(i);
-		wyAFCClipData& clipData = clip->getData();
-
-		// it is a image clip
-		wyAFCClipType clipType = clip->getType();
-		if(clipType == AFC_CLIP_IMAGE) {
-			// get clip pos with frame increment added
-			wyPoint clipPos = wypAdd(clipData.clipPos, m_ignoreFrameOffset ? wypZero : m_frameOffset);
-
-			// check flip flag
-			if(flipX)
-				clipPos.x = -clipPos.x;
-			if(flipY)
-				clipPos.y = -clipPos.y;
-
-			// get related sprite sheet, if the sheet in data is NULL, then we use original sheet
-			wySpriteBatchNode* sheet = clipData.i.sheet;
-			if(!sheet)
-				sheet = (wySpriteBatchNode*) wyArrayGet(m_sheetList, clipData.i.imageIndex);
-
-			// create sprite frame and set it to clip sprite
-			wySpriteFrame* tempSpriteFrame = wySpriteFrame::make(0, sheet->getTexture(), clipData.i.rect);
-			wySpriteEx* sprite = (wySpriteEx*) wyArrayGet(m_spriteList, imageClipIndex);
-			sprite->setDisplayFrame(tempSpriteFrame);
-			sprite->setVisible(true);
-
-			// set sprite position, because clipPos is center position so just set it
-			sprite->setPosition(clipPos.x, clipPos.y);
-
-			// set flipX flag
-			sprite->setFlipX(clipData.i.flipX);
-
-			// check wyAFCSprite flip settings
-			// no flipY needed for sprite because flipY is just a flipX with 180 degree rotation
-			float rotation = clipData.i.rotation;
-			if(flipX) {
-				sprite->setFlipX(!sprite->isFlipX());
-				rotation = 360 - rotation;
-			}
-			if(flipY) {
-				sprite->setFlipX(!sprite->isFlipX());
-				rotation = 180 - rotation;
+	// frame offset is applied when drawing, so baked quads can be shared
+	m_quadOffset = m_ignoreFrameOffset ? wypZero : m_frameOffset;
+	if(flipX)
+		m_quadOffset.x = -m_quadOffset.x;
+	if(flipY)
+		m_quadOffset.y = -m_quadOffset.y;
+
+	// quads of image clips are baked once by frame, just copy them
+	wyAtlasVertex* quads = frameData->getBakedQuads(flipX, flipY, m_sheetList);
+	wyAFCBakedClip* clips = frameData->getBakedClips();
+	int count = frameData->getBakedQuadCount();
+	m_atlas->removeAllQuads();
+	m_atlas->copyQuads(quads, 0, count);
+
+	// resolve sheet of every quad, if the sheet in data is NULL, then we use original sheet
+	if(count > m_quadSheetCapacity) {
+		m_quadSheetCapacity = count;
+		m_quadSheets = (wySpriteBatchNode**)wyRealloc(m_quadSheets, m_quadSheetCapacity * sizeof(wySpriteBatchNode*));
+	}
+	for(int i = 0; i < count; i++) {
+		wyAFCBakedClip& clip = clips[i];
+		wySpriteBatchNode* sheet = clip.sheet;
+		if(!sheet)
+			sheet = (wySpriteBatchNode*)wyArrayGet(m_sheetList, clip.imageIndex);
+		m_quadSheets[i] = sheet;
+
+		// if texture size is not same as baked one, for example, textures are replaced,
+		// texture coordinates should be scaled
+		wyTexture2D* tex = sheet ? sheet->getTexture() : NULL;
+		if(tex && clip.texWidth > 0 && clip.texHeight > 0) {
+			float w = tex->getPixelWidth();
+			float h = tex->getPixelHeight();
+			if(w > 0 && h > 0 && (w != clip.texWidth || h != clip.texHeight)) {
+				wyAtlasVertex v[4];
+				memcpy(v, quads + i * 4, sizeof(v));
+				for(int j = 0; j < 4; j++) {
+					v[j].u *= clip.texWidth / w;
+					v[j].v *= clip.texHeight / h;
+				}
+				m_atlas->copyQuads(v, i, 1);
 			}
-
-			// rotate it
-			sprite->setRotation(rotation);
-
-			// add sprite to sheet
-			sheet->addChildLocked(sprite);
-			sprite->setColor(m_color);
-			imageClipIndex++;
 		}
 	}
 
@@ -541,14 +508,6 @@ void wyAFCSprite::setFrameIndex(int index) {
 	// notify callback
 	if(frameChanged)
 		invokeOnAFCAnimationFrameChanged();
-
-	/*
-	 * cached sprite may be more than current frame clips, so hide unused sprites
-	 */
-	for (int i = imageClipIndex; i < m_spriteList->num; i++) {
-		wySpriteEx* sprite = (wySpriteEx*) wyArrayGet(m_spriteList, i);
-		sprite->setVisible(false);
-	}
 }
 
 void wyAFCSprite::setFlipX(bool flipX) {
@@ -728,20 +687,23 @@ wyRect wyAFCSprite::getCollisionRectRelativeToWorld(int index) {
 
 wyRect wyAFCSprite::getFrameRect() {
 	wyRect ret = wyrZero;
-	bool first = true;
 	wyAFCAnimation* anim = getCurrentAnimationData();
 	if(anim) {
 		wyAFCFrame* frame = anim->getFrameAt(m_curFrame);
 		if(frame) {
-			int count = frame->getClipCount(AFC_CLIP_IMAGE);
-			for (int i = 0; i < count; i++) {
-				wySpriteEx* sprite = (wySpriteEx*) wyArrayGet(m_spriteList, i);
-				if(first) {
-					ret = wyr(sprite->getOriginX(), sprite->getOriginY(), sprite->getWidth(), sprite->getHeight());
-					first = false;
-				} else {
-					ret = wyrCombine(ret, wyr(sprite->getOriginX(), sprite->getOriginY(), sprite->getWidth(), sprite->getHeight()));
+			// bound of baked quads, plus frame offset
+			wyAtlasVertex* v = frame->getBakedQuads(m_flipX != frame->isFlipX(), m_flipY != frame->isFlipY(), m_sheetList);
+			int count = frame->getBakedQuadCount() * 4;
+			if(count > 0) {
+				float minX = v[0].x, maxX = v[0].x;
+				float minY = v[0].y, maxY = v[0].y;
+				for(int i = 1; i < count; i++) {
+					minX = MIN(minX, v[i].x);
+					maxX = MAX(maxX, v[i].x);
+					minY = MIN(minY, v[i].y);
+					maxY = MAX(maxY, v[i].y);
 				}
+				ret = wyr(minX + m_quadOffset.x, minY + m_quadOffset.y, maxX - minX, maxY - minY);
 			}
 		}
 	}
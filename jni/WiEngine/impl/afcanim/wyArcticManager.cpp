@@ -284,6 +284,13 @@ void wyArcticManager::parseFrameModules(wyArcticFileData* afd, wyArcticFrame* ar
 }
 
 wyAFCAnimation* wyArcticManager::getAnimationData(wyArcticFileData* afd, int animIndex, wyAFCClipMapping* mapping) {
+	// animation without clip mapping is shared by all sprites
+	if(!mapping) {
+		wyAFCAnimation* cached = afd->getCachedAnimation(animIndex);
+		if(cached)
+			return cached;
+	}
+
 	wyAFCAnimation* afcAnim = wyAFCAnimation::make();
 
 	// save scale
@@ -329,5 +336,9 @@ wyAFCAnimation* wyArcticManager::getAnimationData(wyArcticFileData* afd, int ani
 		afcAnim->addFrame(afcFrame);
 	}
 
+	// cache it so frame geometry is baked only once
+	if(!mapping)
+		afd->cacheAnimation(animIndex, afcAnim);
+
 	return afcAnim;
 }
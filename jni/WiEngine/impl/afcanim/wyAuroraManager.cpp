@@ -294,6 +294,13 @@ void wyAuroraManager::parseFrameModules(wyAuroraFileData* afd, wyAuroraFrame* au
 }
 
 wyAFCAnimation* wyAuroraManager::getAnimationData(wyAuroraFileData* afd, int animIndex, wyAFCClipMapping* mapping) {
+	// animation without clip mapping is shared by all sprites
+	if(!mapping) {
+		wyAFCAnimation* cached = afd->getCachedAnimation(animIndex);
+		if(cached)
+			return cached;
+	}
+
 	wyAFCAnimation* afcAnim = wyAFCAnimation::make();
 
 	// save scale
@@ -361,5 +368,9 @@ wyAFCAnimation* wyAuroraManager::getAnimationData(wyAuroraFileData* afd, int ani
 		afcAnim->addFrame(afcFrame);
 	}
 
+	// cache it so frame geometry is baked only once
+	if(!mapping)
+		afd->cacheAnimation(animIndex, afcAnim);
+
 	return afcAnim;
 }
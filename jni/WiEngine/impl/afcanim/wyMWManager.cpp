@@ -254,6 +254,13 @@ bool wyMWManager::parseClip(wyMWFileData* animationFileData, int clipAdditionalD
 }
 
 wyAFCAnimation* wyMWManager::getAnimationData(wyMWFileData* animationFileData, int animIndex, wyAFCClipMapping* mapping) {
+	// animation without clip mapping is shared by all sprites
+	if(!mapping) {
+		wyAFCAnimation* cached = animationFileData->getCachedAnimation(animIndex);
+		if(cached)
+			return cached;
+	}
+
 	wyAFCAnimation* afcAnim = wyAFCAnimation::make();
 
 	unsigned short startFrame = animationFileData->m_animationTable[animIndex * 2];
@@ -303,5 +310,9 @@ wyAFCAnimation* wyMWManager::getAnimationData(wyMWFileData* animationFileData, i
 		afcAnim->addFrame(afcFrame);
 	}
 
+	// cache it so frame geometry is baked only once
+	if(!mapping)
+		animationFileData->cacheAnimation(animIndex, afcAnim);
+
 	return afcAnim;
 }
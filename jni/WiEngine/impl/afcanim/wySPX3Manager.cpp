@@ -145,6 +145,13 @@ float wySPX3Manager::resolve(short v) {
 }
 
 wyAFCAnimation* wySPX3Manager::getAnimationData(wySPX3FileData* spx, int animIndex, wyAFCClipMapping* mapping) {
+	// animation without clip mapping is shared by all sprites
+	if(!mapping) {
+		wyAFCAnimation* cached = spx->getCachedAnimation(animIndex);
+		if(cached)
+			return cached;
+	}
+
 	wyAFCAnimation* afcAnim = wyAFCAnimation::make();
 
 	// save scale
@@ -404,5 +411,9 @@ wyAFCAnimation* wySPX3Manager::getAnimationData(wySPX3FileData* spx, int animInd
 		afcAnim->addFrame(afcFrame);
 	}
 
+	// cache it so frame geometry is baked only once
+	if(!mapping)
+		spx->cacheAnimation(animIndex, afcAnim);
+
 	return afcAnim;
 }
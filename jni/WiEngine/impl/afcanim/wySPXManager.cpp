@@ -207,6 +207,13 @@ void wySPXManager::parseTile(wySPXTile* spxTile, wySPXFrameTile* spxFrameTile, w
 }
 
 wyAFCAnimation* wySPXManager::getAnimationData(wySPXFileData* spx, int animIndex, wyAFCClipMapping* mapping) {
+	// animation without clip mapping is shared by all sprites
+	if(!mapping) {
+		wyAFCAnimation* cached = spx->getCachedAnimation(animIndex);
+		if(cached)
+			return cached;
+	}
+
 	wyAFCAnimation* afcAnim = wyAFCAnimation::make();
 
 	// save scale
@@ -347,5 +354,9 @@ wyAFCAnimation* wySPXManager::getAnimationData(wySPXFileData* spx, int animIndex
 		afcAnim->addFrame(afcFrame);
 	}
 
+	// cache it so frame geometry is baked only once
+	if(!mapping)
+		spx->cacheAnimation(animIndex, afcAnim);
+
 	return afcAnim;
 }
@@ -33,6 +33,7 @@
 #include "wyArray.h"
 #include "wyObject.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 bool wyAStar::releaseNode(wyArray* arr, void* ptr, int index, void* data) {
@@ -41,9 +42,21 @@ bool wyAStar::releaseNode(wyArray* arr, void* ptr, int index, void* data) {
 }
 
 wyAStar::wyAStar(wyAStarMap* mapdata) :
-		m_steps(wyArrayNew(mapdata->getTileCount())) {
+		m_steps(wyArrayNew(mapdata->getTileCount())),
+		m_stepPool(wyArrayNew(16)),
+		m_tileCount(mapdata->getTileCount()),
+		m_currentGeneration(0),
+		m_heapSize(0) {
 	m_mapdata = mapdata;
 	m_mapdata->retain();
+
+	// search state, allocated once
+	m_g = (float*)wyMalloc(m_tileCount * sizeof(float));
+	m_f = (float*)wyMalloc(m_tileCount * sizeof(float));
+	m_parent = (int*)wyMalloc(m_tileCount * sizeof(int));
+	m_heapIndex = (int*)wyMalloc(m_tileCount * sizeof(int));
+	m_generation = (unsigned int*)wyCalloc(m_tileCount, sizeof(unsigned int));
+	m_heap = (int*)wyMalloc(m_tileCount * sizeof(int));
 }
 
 wyAStar::~wyAStar() {
@@ -53,94 +66,173 @@ wyAStar::~wyAStar() {
 		wyArrayDestroy(m_steps);
 		m_steps = NULL;
 	}
+	wyArrayConcurrentEach(m_stepPool, releaseNode, NULL);
+	wyArrayDestroy(m_stepPool);
+	wyFree(m_g);
+	wyFree(m_f);
+	wyFree(m_parent);
+	wyFree(m_heapIndex);
+	wyFree(m_generation);
+	wyFree(m_heap);
 	m_mapdata->release();
 }
 
-int wyAStar::findPath(int startx, int starty, int endx, int endy, bool ignoreBlock) {
-	wyArrayConcurrentEach(m_steps, releaseNode, NULL);
-	wyArrayClear(m_steps);
+void wyAStar::heapUp(int pos) {
+	int tile = m_heap[pos];
+	float f = m_f[tile];
+	while (pos > 0) {
+		int parent = (pos - 1) >> 1;
+		if (m_f[m_heap[parent]] <= f)
+			break;
+		m_heap[pos] = m_heap[parent];
+		m_heapIndex[m_heap[pos]] = pos;
+		pos = parent;
+	}
+	m_heap[pos] = tile;
+	m_heapIndex[tile] = pos;
+}
 
-	if ((startx == endx) && (starty == endy))
-		return 0;
+void wyAStar::heapDown(int pos) {
+	int tile = m_heap[pos];
+	float f = m_f[tile];
+	while (true) {
+		int child = (pos << 1) + 1;
+		if (child >= m_heapSize)
+			break;
+		if (child + 1 < m_heapSize && m_f[m_heap[child + 1]] < m_f[m_heap[child]])
+			child++;
+		if (f <= m_f[m_heap[child]])
+			break;
+		m_heap[pos] = m_heap[child];
+		m_heapIndex[m_heap[pos]] = pos;
+		pos = child;
+	}
+	m_heap[pos] = tile;
+	m_heapIndex[tile] = pos;
+}
 
-	if (!ignoreBlock && m_mapdata->isBlockedAt(endx, endy)) {
-		return 0;
+void wyAStar::heapPush(int tile) {
+	m_heap[m_heapSize] = tile;
+	m_heapSize++;
+	heapUp(m_heapSize - 1);
+}
+
+int wyAStar::heapPop() {
+	int top = m_heap[0];
+	m_heapSize--;
+	if (m_heapSize > 0) {
+		m_heap[0] = m_heap[m_heapSize];
+		heapDown(0);
 	}
+	m_heapIndex[top] = -1;
+	return top;
+}
 
-	wyAStarStep* current = NULL;
-	wyAStarStep* neighbor = NULL;
-	wyAStarStep* aNode = NULL;
+int wyAStar::buildPath(int start, int end) {
+	// count steps, start is not included
+	int count = 0;
+	for (int t = end; t != start; t = m_parent[t])
+		count++;
 
-	wyArray* openList = wyArrayNew(m_mapdata->getTileCount());
-	wyArray* closedList = wyArrayNew(m_mapdata->getTileCount());
+	// reuse step objects, only create new one if pool is not enough or old one is still held by others
+	while (m_stepPool->num < count) {
+		wyArrayPush(m_stepPool, WYNEW wyAStarStep(0, 0));
+	}
 
-	int gScoreIsBest;
+	// end is the first, same order as before
+	wyAStarStep* prev = NULL;
+	int i = 0;
+	for (int t = end; t != start; t = m_parent[t], i++) {
+		wyAStarStep* step = (wyAStarStep*)wyArrayGet(m_stepPool, i);
+		if (step->getRetainCount() > 1) {
+			wyObjectRelease(step);
+			step = WYNEW wyAStarStep(0, 0);
+			m_stepPool->arr[i] = step;
+		}
 
-	aNode = WYNEW wyAStarStep(startx, starty);
-	wyArrayPush(openList, aNode);
+		wyAStarTile* tile = m_mapdata->getTileByIndex(t);
+		step->setX(tile->getX());
+		step->setY(tile->getY());
+		step->setG(m_g[t]);
+		step->setF(m_f[t]);
+		step->setH(m_f[t] - m_g[t]);
+		step->setParent(NULL);
+		if (prev != NULL)
+			prev->setParent(step);
+		prev = step;
+
+		wyObjectRetain(step);
+		wyArrayPush(m_steps, step);
+	}
 
-	while (openList->num) {
-		current = findLowestCostNode(openList);
+	return m_steps->num;
+}
 
-		if ((current->getX() == endx) && (current->getY() == endy)) {
-			wyArrayInsert(m_steps, current, 0);
-			wyObjectRetain((wyObject*)current);
+int wyAStar::findPath(int startx, int starty, int endx, int endy, bool ignoreBlock) {
+	wyArrayConcurrentEach(m_steps, releaseNode, NULL);
+	wyArrayClear(m_steps);
 
-			aNode = current->getParent();
-			while (aNode->getParent() != NULL) {
-				wyArrayPush(m_steps, aNode);
-				wyObjectRetain((wyObject*)aNode);
-				aNode = aNode->getParent();
-			}
-			wyArrayConcurrentEach(openList, releaseNode, NULL);
-			wyArrayDestroy(openList);
-			openList = NULL;
-			wyArrayConcurrentEach(closedList, releaseNode, NULL);
-			wyArrayDestroy(closedList);
-			closedList = NULL;
-			return m_steps->num;
-		}
-		wyArrayPush(closedList, current);
-		wyArrayDeleteObj(openList, current, NULL, NULL);
+	if ((startx == endx) && (starty == endy))
+		return 0;
 
-		wyAStarTile* currTile = m_mapdata->getTileAt(current->getX(), current->getY());
-		wyArray * childs = currTile->getChilds();
+	if (!ignoreBlock && m_mapdata->isBlockedAt(endx, endy)) {
+		return 0;
+	}
+
+	wyAStarTile* startTile = m_mapdata->getTileAt(startx, starty);
+	wyAStarTile* endTile = m_mapdata->getTileAt(endx, endy);
+	if (startTile == NULL || endTile == NULL)
+		return 0;
 
+	// new generation, state of last search becomes invalid without clearing
+	m_currentGeneration++;
+	if (m_currentGeneration == 0) {
+		memset(m_generation, 0, m_tileCount * sizeof(unsigned int));
+		m_currentGeneration = 1;
+	}
+	unsigned int generation = m_currentGeneration;
+	m_heapSize = 0;
+
+	// add start
+	int start = startTile->getIndex();
+	int end = endTile->getIndex();
+	m_generation[start] = generation;
+	m_g[start] = 0;
+	m_f[start] = heuristic(startx, starty, endx, endy);
+	m_parent[start] = -1;
+	heapPush(start);
+
+	while (m_heapSize > 0) {
+		int current = heapPop();
+		if (current == end)
+			return buildPath(start, end);
+
+		wyAStarTile* currTile = m_mapdata->getTileByIndex(current);
+		wyArray* childs = currTile->getChilds();
 		for (int i = 0; i < childs->num; i++) {
-			wyAStarTile* tile = (wyAStarTile*)wyArrayGet(childs, i);
-			if (!tile->isBlocked()) {
-				if (!nodeInArray(closedList, tile->getX(), tile->getY())) {
-					neighbor = WYNEW wyAStarStep(tile->getX(), tile->getY());
-					float gScore = current->getG() + m_mapdata->getStepG(currTile, tile);
-					gScoreIsBest = 0;
-
-					if (!nodeInArray(openList, tile->getX(), tile->getY())) {
-						gScoreIsBest = 1;
-						neighbor->setH(neighbor->getH() +
-								heuristic(currTile->getX(), currTile->getY(), tile->getX(), tile->getY()));
-						wyArrayPush(openList, neighbor);
-						neighbor->retain();
-
-					} else if (gScore < neighbor->getG()) {
-						gScoreIsBest = 1;
-					}
-
-					if (gScoreIsBest) {
-						neighbor->setParent(current);
-						neighbor->setG(gScore);
-						neighbor->setF(neighbor->getG() + neighbor->getH());
-					}
-					neighbor->release();
-				}
+			wyAStarTile* tile = (wyAStarTile*)childs->arr[i];
+			if (tile->isBlocked())
+				continue;
+
+			int n = tile->getIndex();
+			float gScore = m_g[current] + m_mapdata->getStepG(currTile, tile);
+			if (m_generation[n] != generation) {
+				// first visit in this search
+				m_generation[n] = generation;
+				m_g[n] = gScore;
+				m_f[n] = gScore + heuristic(tile->getX(), tile->getY(), endx, endy);
+				m_parent[n] = current;
+				heapPush(n);
+			} else if (m_heapIndex[n] != -1 && gScore < m_g[n]) {
+				// better path to an open tile
+				m_f[n] -= m_g[n] - gScore;
+				m_g[n] = gScore;
+				m_parent[n] = current;
+				heapUp(m_heapIndex[n]);
 			}
 		}
 	}
-	wyArrayConcurrentEach(openList, releaseNode, NULL);
-	wyArrayDestroy(openList);
-	openList = NULL;
-	wyArrayConcurrentEach(closedList, releaseNode, NULL);
-	wyArrayDestroy(closedList);
-	closedList = NULL;
+
 	return 0;
 }
 
@@ -149,30 +241,3 @@ float wyAStar::heuristic(int startx, int starty, int endx, int endy) {
 	int d2 = abs(starty - endy);
 	return sqrt((float)(d1 * d1 + d2 * d2));
 }
-
-wyAStarStep* wyAStar::nodeInArray(wyArray* arr, int x, int y) {
-	for (int i = 0; i < arr->num; i++) {
-		wyAStarStep* node = (wyAStarStep*) wyArrayGet(arr, i);
-		if (node->getX() == x && node->getY() == y) {
-			return node;
-		}
-	}
-	return NULL;
-
-}
-
-wyAStarStep* wyAStar::findLowestCostNode(wyArray* arr) {
-	wyAStarStep* n = NULL;
-	wyAStarStep* lowest = NULL;
-	for (int i = 0; i < arr->num; i++) {
-		n = (wyAStarStep*)wyArrayGet(arr, i);
-		if (lowest == NULL) {
-			lowest = n;
-		} else {
-			if (n->getF() < lowest->getF()) {
-				lowest = n;
-			}
-		}
-	}
-	return lowest;
-}
@@ -29,29 +29,67 @@
 #include "wyAStarMap.h"
 #include "wyAStarTile.h"
 #include "wyArray.h"
+#include "wyPathService.h"
 #include <stdlib.h>
 
+// how many recent changes are remembered
+#define CHANGE_LOG_SIZE 256
+
 bool wyAStarMap::releaseTile(wyArray* arr, void* ptr, int index, void* data) {
 	wyObjectRelease((wyObject*)ptr);
 	return true;
 }
 
 wyAStarMap::wyAStarMap() :
-	m_tiles(NULL) {
+	m_tiles(NULL),
+	m_version(0),
+	m_costVersion(0),
+	m_changes(NULL) {
 }
 
 wyAStarMap::~wyAStarMap() {
+	// cached snapshot of this map is useless now
+	wyPathService* service = wyPathService::getInstanceNoCreate();
+	if (service != NULL) {
+		service->removeMap(this);
+	}
+	wyFree(m_changes);
+
 	if (m_tiles != NULL) {
 		wyArrayConcurrentEach(m_tiles, releaseTile, NULL);
 	}
 }
 
 void wyAStarMap::blockTile(int x, int y) {
-	getTileAt(x, y)->setType(TILE_BLOCKED);
+	wyAStarTile* tile = getTileAt(x, y);
+	tile->setType(TILE_BLOCKED);
+	recordChange(tile->getIndex());
 }
 
 void wyAStarMap::freeTile(int x, int y) {
-	getTileAt(x, y)->setType(TILE_FREE);
+	wyAStarTile* tile = getTileAt(x, y);
+	tile->setType(TILE_FREE);
+	recordChange(tile->getIndex());
+}
+
+void wyAStarMap::recordChange(int index) {
+	if (m_changes == NULL) {
+		m_changes = (int*)wyMalloc(CHANGE_LOG_SIZE * sizeof(int));
+	}
+	m_version++;
+	m_changes[m_version % CHANGE_LOG_SIZE] = index;
+}
+
+int wyAStarMap::getChangedTile(int version) {
+	if (m_changes == NULL || version > m_version || version <= m_version - CHANGE_LOG_SIZE) {
+		return -1;
+	}
+	return m_changes[version % CHANGE_LOG_SIZE];
+}
+
+void wyAStarMap::invalidate() {
+	recordChange(-1);
+	m_costVersion++;
 }
 
 bool wyAStarMap::isBlockedAt(int x, int y) {
@@ -68,12 +106,24 @@ wyAStarTile* wyAStarMap::getTileAt(int x, int y) {
 	if (!isValidTile(x, y)) {
 		return NULL;
 	} else {
-		for (int i = 0; i < m_tiles->num; i++) {
-			wyAStarTile* tile = (wyAStarTile*)wyArrayGet(m_tiles, i);
-			if (tile->getX() == x && tile->getY() == y) {
-				return tile;
-			}
+		int index = getTileIndex(x, y);
+		return index == -1 ? NULL : (wyAStarTile*)wyArrayGet(m_tiles, index);
+	}
+}
+
+int wyAStarMap::getTileIndex(int x, int y) {
+	for (int i = 0; i < m_tiles->num; i++) {
+		wyAStarTile* tile = (wyAStarTile*)wyArrayGet(m_tiles, i);
+		if (tile->getX() == x && tile->getY() == y) {
+			return i;
 		}
 	}
-	return NULL;
+	return -1;
+}
+
+void wyAStarMap::indexTiles() {
+	for (int i = 0; i < m_tiles->num; i++) {
+		wyAStarTile* tile = (wyAStarTile*)wyArrayGet(m_tiles, i);
+		tile->setIndex(i);
+	}
 }
@@ -29,7 +29,7 @@
 #include "wyAStarTile.h"
 
 wyAStarTile::wyAStarTile(int type, int x, int y) :
-	m_type(type), m_x(x), m_y(y), m_childs(wyArrayNew(8)) {
+	m_type(type), m_x(x), m_y(y), m_childs(wyArrayNew(8)), m_index(-1) {
 	m_gRate = 1.0f;
 }
 
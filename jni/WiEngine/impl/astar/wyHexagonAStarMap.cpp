@@ -39,6 +39,7 @@ wyHexagonAStarMap::wyHexagonAStarMap(int width, int height) :
 			wyArrayPush(m_tiles, WYNEW wyAStarTile(TILE_FREE, x, y));
 		}
 	}
+	indexTiles();
 
 	// auto clilds
 	for (int i = 0; i < m_tiles->num; i++) {
@@ -67,6 +68,11 @@ wyHexagonAStarMap::~wyHexagonAStarMap() {
 
 }
 
+int wyHexagonAStarMap::getTileIndex(int x, int y) {
+	// tiles are pushed column by column
+	return x * m_height + y;
+}
+
 bool wyHexagonAStarMap::isValidTile(int x, int y) {
 	if (x < 0 || x >= m_width || y < 0 || y >= m_height) {
 		return false;
@@ -0,0 +1,725 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: mike(mike.weib@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "wyPathFinder.h"
+#include "wyPathSnapshot.h"
+#include "wyPathHierarchy.h"
+#include "wyMemory.h"
+#include "wyMath.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// cost of unreachable tile
+#define PATH_INFINITY 1e30f
+
+// cost of a diagonal step on grid
+#define PATH_SQRT2 1.41421356f
+
+wyPathFinder::wyPathFinder() :
+		m_startDist(NULL),
+		m_goalDist(NULL),
+		m_distCapacity(0),
+		m_chain(NULL),
+		m_chainCapacity(0),
+		m_path(NULL),
+		m_length(0),
+		m_pathCapacity(0),
+		m_cost(0),
+		m_algorithm(WY_PATH_ALGORITHM_ASTAR),
+		m_snapshot(NULL),
+		m_width(0),
+		m_height(0),
+		m_blocked(NULL),
+		m_pass(-1),
+		m_end(-1),
+		m_endX(0),
+		m_endY(0) {
+	initState(m_global);
+	initState(m_local);
+}
+
+wyPathFinder::~wyPathFinder() {
+	destroyState(m_global);
+	destroyState(m_local);
+	wyFree(m_startDist);
+	wyFree(m_goalDist);
+	wyFree(m_chain);
+	wyFree(m_path);
+}
+
+void wyPathFinder::initState(wyPathState& st) {
+	memset(&st, 0, sizeof(wyPathState));
+}
+
+void wyPathFinder::destroyState(wyPathState& st) {
+	wyFree(st.g);
+	wyFree(st.f);
+	wyFree(st.parent);
+	wyFree(st.heapIndex);
+	wyFree(st.generation);
+	wyFree(st.heap);
+	initState(st);
+}
+
+void wyPathFinder::beginState(wyPathState& st, int capacity) {
+	// arrays only grow, so a finder reaches steady state after first search on biggest map
+	if(capacity > st.capacity) {
+		destroyState(st);
+		st.capacity = capacity;
+		st.g = (float*)wyMalloc(capacity * sizeof(float));
+		st.f = (float*)wyMalloc(capacity * sizeof(float));
+		st.parent = (int*)wyMalloc(capacity * sizeof(int));
+		st.heapIndex = (int*)wyMalloc(capacity * sizeof(int));
+		st.generation = (unsigned int*)wyCalloc(capacity, sizeof(unsigned int));
+		st.heap = (int*)wyMalloc(capacity * sizeof(int));
+	}
+
+	// new generation, state of last search becomes invalid without clearing
+	st.currentGeneration++;
+	if(st.currentGeneration == 0) {
+		memset(st.generation, 0, st.capacity * sizeof(unsigned int));
+		st.currentGeneration = 1;
+	}
+	st.heapSize = 0;
+}
+
+void wyPathFinder::heapUp(wyPathState& st, int pos) {
+	int n = st.heap[pos];
+	float f = st.f[n];
+	while(pos > 0) {
+		int parent = (pos - 1) >> 1;
+		if(st.f[st.heap[parent]] <= f)
+			break;
+		st.heap[pos] = st.heap[parent];
+		st.heapIndex[st.heap[pos]] = pos;
+		pos = parent;
+	}
+	st.heap[pos] = n;
+	st.heapIndex[n] = pos;
+}
+
+void wyPathFinder::heapDown(wyPathState& st, int pos) {
+	int n = st.heap[pos];
+	float f = st.f[n];
+	while(true) {
+		int child = (pos << 1) + 1;
+		if(child >= st.heapSize)
+			break;
+		if(child + 1 < st.heapSize && st.f[st.heap[child + 1]] < st.f[st.heap[child]])
+			child++;
+		if(f <= st.f[st.heap[child]])
+			break;
+		st.heap[pos] = st.heap[child];
+		st.heapIndex[st.heap[pos]] = pos;
+		pos = child;
+	}
+	st.heap[pos] = n;
+	st.heapIndex[n] = pos;
+}
+
+int wyPathFinder::heapPop(wyPathState& st) {
+	int top = st.heap[0];
+	st.heapSize--;
+	if(st.heapSize > 0) {
+		st.heap[0] = st.heap[st.heapSize];
+		heapDown(st, 0);
+	}
+	st.heapIndex[top] = -1;
+	return top;
+}
+
+void wyPathFinder::relax(wyPathState& st, int n, float g, float h, int parent) {
+	if(st.generation[n] != st.currentGeneration) {
+		// first visit in this search
+		st.generation[n] = st.currentGeneration;
+		st.g[n] = g;
+		st.f[n] = g + h;
+		st.parent[n] = parent;
+		st.heap[st.heapSize] = n;
+		st.heapSize++;
+		heapUp(st, st.heapSize - 1);
+	} else if(st.heapIndex[n] != -1 && g < st.g[n]) {
+		// better path to an open node
+		st.f[n] -= st.g[n] - g;
+		st.g[n] = g;
+		st.parent[n] = parent;
+		heapUp(st, st.heapIndex[n]);
+	}
+}
+
+void wyPathFinder::ensurePath(int length) {
+	if(length > m_pathCapacity) {
+		m_pathCapacity = MAX(length, m_pathCapacity * 2);
+		m_path = (int*)wyRealloc(m_path, m_pathCapacity * sizeof(int));
+	}
+}
+
+float wyPathFinder::gridHeuristic(int x, int y) {
+	int dx = abs(x - m_endX);
+	int dy = abs(y - m_endY);
+	if(m_snapshot->m_diagonal) {
+		// octile distance
+		return dx > dy ? (dx - dy) + dy * PATH_SQRT2 : (dy - dx) + dx * PATH_SQRT2;
+	} else {
+		return (float)(dx + dy);
+	}
+}
+
+void wyPathFinder::beginGrid(wyPathSnapshot* s, int end, int pass) {
+	m_snapshot = s;
+	m_width = s->m_width;
+	m_height = s->m_height;
+	m_blocked = s->m_blocked;
+	m_pass = pass;
+	m_end = end;
+	m_endX = end / m_height;
+	m_endY = end % m_height;
+}
+
+void wyPathFinder::buildPath(int start, int end) {
+	m_length = 0;
+	for(int t = end; t != -1; t = m_global.parent[t])
+		m_length++;
+	ensurePath(m_length);
+	int i = m_length - 1;
+	for(int t = end; t != -1; t = m_global.parent[t])
+		m_path[i--] = t;
+}
+
+bool wyPathFinder::searchGraph(wyPathSnapshot* s, int start, int end, int pass) {
+	wyPathSnapshot::wyPathGraph* graph = s->m_graph;
+	unsigned char* blocked = s->m_blocked;
+	int ex = graph->x[end];
+	int ey = graph->y[end];
+
+	// heuristic is euclidean distance, same as wyAStar
+	wyPathState& st = m_global;
+	beginState(st, s->m_tileCount);
+	int dx = graph->x[start] - ex;
+	int dy = graph->y[start] - ey;
+	relax(st, start, 0, sqrtf((float)(dx * dx + dy * dy)), -1);
+
+	while(st.heapSize > 0) {
+		int current = heapPop(st);
+		if(current == end) {
+			buildPath(start, end);
+			m_cost = st.g[end];
+			return true;
+		}
+
+		float g = st.g[current];
+		int last = graph->offsets[current + 1];
+		for(int e = graph->offsets[current]; e < last; e++) {
+			int n = graph->neighbors[e];
+			if(blocked[n] && n != pass)
+				continue;
+			if(st.generation[n] == st.currentGeneration && st.heapIndex[n] == -1)
+				continue;
+			dx = graph->x[n] - ex;
+			dy = graph->y[n] - ey;
+			relax(st, n, g + graph->costs[e], sqrtf((float)(dx * dx + dy * dy)), current);
+		}
+	}
+
+	return false;
+}
+
+int wyPathFinder::jump8(int x, int y, int dx, int dy) {
+	while(true) {
+		x += dx;
+		y += dy;
+		if(!walkable(x, y))
+			return -1;
+		int index = x * m_height + y;
+		if(index == m_end)
+			return index;
+
+		if(dx != 0 && dy != 0) {
+			// forced neighbors of diagonal move
+			if((!walkable(x - dx, y) && walkable(x - dx, y + dy)) || (!walkable(x, y - dy) && walkable(x + dx, y - dy)))
+				return index;
+
+			// diagonal move stops where a straight move finds something
+			if(jump8(x, y, dx, 0) != -1 || jump8(x, y, 0, dy) != -1)
+				return index;
+		} else if(dx != 0) {
+			if((!walkable(x, y + 1) && walkable(x + dx, y + 1)) || (!walkable(x, y - 1) && walkable(x + dx, y - 1)))
+				return index;
+		} else {
+			if((!walkable(x + 1, y) && walkable(x + 1, y + dy)) || (!walkable(x - 1, y) && walkable(x - 1, y + dy)))
+				return index;
+		}
+	}
+}
+
+int wyPathFinder::jump4(int x, int y, int dx, int dy) {
+	while(true) {
+		x += dx;
+		y += dy;
+		if(!walkable(x, y))
+			return -1;
+		int index = x * m_height + y;
+		if(index == m_end)
+			return index;
+
+		if(dx != 0) {
+			// a side opens, path may turn here
+			if((walkable(x, y - 1) && !walkable(x - dx, y - 1)) || (walkable(x, y + 1) && !walkable(x - dx, y + 1)))
+				return index;
+		} else {
+			if((walkable(x - 1, y) && !walkable(x - 1, y - dy)) || (walkable(x + 1, y) && !walkable(x + 1, y - dy)))
+				return index;
+
+			// vertical move stops where a horizontal move finds something
+			if(jump4(x, y, 1, 0) != -1 || jump4(x, y, -1, 0) != -1)
+				return index;
+		}
+	}
+}
+
+bool wyPathFinder::searchJump(wyPathSnapshot* s, int start, int end, int pass) {
+	beginGrid(s, end, pass);
+	wyPathState& st = m_global;
+	beginState(st, s->m_tileCount);
+	relax(st, start, 0, gridHeuristic(start / m_height, start % m_height), -1);
+
+	bool diagonal = s->m_diagonal;
+	int dirs[16];
+	while(st.heapSize > 0) {
+		int current = heapPop(st);
+		if(current == end) {
+			buildJumpPath(start, end);
+			m_cost = st.g[end] * s->m_rate;
+			return true;
+		}
+
+		int x = current / m_height;
+		int y = current % m_height;
+		int count = 0;
+		int parent = st.parent[current];
+		if(parent == -1) {
+			// start expands to all directions
+			for(int i = -1; i <= 1; i++) {
+				for(int j = -1; j <= 1; j++) {
+					if((i == 0 && j == 0) || (!diagonal && i != 0 && j != 0))
+						continue;
+					dirs[count++] = i;
+					dirs[count++] = j;
+				}
+			}
+		} else {
+			// prune neighbors by direction from parent
+			int px = parent / m_height;
+			int py = parent % m_height;
+			int dx = x > px ? 1 : (x < px ? -1 : 0);
+			int dy = y > py ? 1 : (y < py ? -1 : 0);
+			if(!diagonal) {
+				if(dx != 0) {
+					dirs[count++] = dx; dirs[count++] = 0;
+					dirs[count++] = 0; dirs[count++] = 1;
+					dirs[count++] = 0; dirs[count++] = -1;
+				} else {
+					dirs[count++] = 0; dirs[count++] = dy;
+					dirs[count++] = 1; dirs[count++] = 0;
+					dirs[count++] = -1; dirs[count++] = 0;
+				}
+			} else if(dx != 0 && dy != 0) {
+				dirs[count++] = dx; dirs[count++] = 0;
+				dirs[count++] = 0; dirs[count++] = dy;
+				dirs[count++] = dx; dirs[count++] = dy;
+				if(!walkable(x - dx, y)) {
+					dirs[count++] = -dx; dirs[count++] = dy;
+				}
+				if(!walkable(x, y - dy)) {
+					dirs[count++] = dx; dirs[count++] = -dy;
+				}
+			} else if(dx != 0) {
+				dirs[count++] = dx; dirs[count++] = 0;
+				if(!walkable(x, y + 1)) {
+					dirs[count++] = dx; dirs[count++] = 1;
+				}
+				if(!walkable(x, y - 1)) {
+					dirs[count++] = dx; dirs[count++] = -1;
+				}
+			} else {
+				dirs[count++] = 0; dirs[count++] = dy;
+				if(!walkable(x + 1, y)) {
+					dirs[count++] = 1; dirs[count++] = dy;
+				}
+				if(!walkable(x - 1, y)) {
+					dirs[count++] = -1; dirs[count++] = dy;
+				}
+			}
+		}
+
+		// jump to successors, segments are straight or diagonal so octile distance is exact
+		float g = st.g[current];
+		for(int i = 0; i < count; i += 2) {
+			int jp = diagonal ? jump8(x, y, dirs[i], dirs[i + 1]) : jump4(x, y, dirs[i], dirs[i + 1]);
+			if(jp == -1)
+				continue;
+			if(st.generation[jp] == st.currentGeneration && st.heapIndex[jp] == -1)
+				continue;
+			int jx = jp / m_height;
+			int jy = jp % m_height;
+			int ax = abs(jx - x);
+			int ay = abs(jy - y);
+			float d = ax > ay ? (ax - ay) + ay * PATH_SQRT2 : (ay - ax) + ax * PATH_SQRT2;
+			relax(st, jp, g + d, gridHeuristic(jx, jy), current);
+		}
+	}
+
+	return false;
+}
+
+void wyPathFinder::buildJumpPath(int start, int end) {
+	// count tiles between jump points
+	m_length = 1;
+	for(int t = end; m_global.parent[t] != -1; t = m_global.parent[t]) {
+		int p = m_global.parent[t];
+		m_length += MAX(abs(t / m_height - p / m_height), abs(t % m_height - p % m_height));
+	}
+	ensurePath(m_length);
+
+	// fill from end
+	int i = m_length - 1;
+	m_path[i--] = end;
+	for(int t = end; m_global.parent[t] != -1; t = m_global.parent[t]) {
+		int p = m_global.parent[t];
+		int px = p / m_height;
+		int py = p % m_height;
+		int x = t / m_height;
+		int y = t % m_height;
+		int dx = px > x ? 1 : (px < x ? -1 : 0);
+		int dy = py > y ? 1 : (py < y ? -1 : 0);
+		while(x != px || y != py) {
+			x += dx;
+			y += dy;
+			m_path[i--] = x * m_height + y;
+		}
+	}
+}
+
+void wyPathFinder::localDijkstra(int x0, int y0, int w, int h, int source, float* out) {
+	wyPathState& st = m_local;
+	int count = w * h;
+	beginState(st, count);
+	for(int i = 0; i < count; i++)
+		out[i] = PATH_INFINITY;
+
+	bool diagonal = m_snapshot->m_diagonal;
+	int sx = source / m_height;
+	int sy = source % m_height;
+	relax(st, (sx - x0) * h + sy - y0, 0, 0, -1);
+	while(st.heapSize > 0) {
+		int current = heapPop(st);
+		float g = st.g[current];
+		out[current] = g;
+
+		int x = x0 + current / h;
+		int y = y0 + current % h;
+		for(int i = -1; i <= 1; i++) {
+			for(int j = -1; j <= 1; j++) {
+				if((i == 0 && j == 0) || (!diagonal && i != 0 && j != 0))
+					continue;
+				int nx = x + i;
+				int ny = y + j;
+				if(nx < x0 || nx >= x0 + w || ny < y0 || ny >= y0 + h || !walkable(nx, ny))
+					continue;
+				int n = (nx - x0) * h + ny - y0;
+				if(st.generation[n] == st.currentGeneration && st.heapIndex[n] == -1)
+					continue;
+				relax(st, n, g + (i != 0 && j != 0 ? PATH_SQRT2 : 1), 0, current);
+			}
+		}
+	}
+}
+
+bool wyPathFinder::localSearch(int x0, int y0, int w, int h, int from, int to) {
+	wyPathState& st = m_local;
+	beginState(st, w * h);
+
+	bool diagonal = m_snapshot->m_diagonal;
+	int tx = to / m_height;
+	int ty = to % m_height;
+	int target = (tx - x0) * h + ty - y0;
+	int fx = from / m_height;
+	int fy = from % m_height;
+	int ax = abs(fx - tx);
+	int ay = abs(fy - ty);
+	float hv = diagonal ? (ax > ay ? (ax - ay) + ay * PATH_SQRT2 : (ay - ax) + ax * PATH_SQRT2) : (float)(ax + ay);
+	relax(st, (fx - x0) * h + fy - y0, 0, hv, -1);
+	while(st.heapSize > 0) {
+		int current = heapPop(st);
+		if(current == target) {
+			// append path, from is already in result
+			int count = 0;
+			for(int t = target; st.parent[t] != -1; t = st.parent[t])
+				count++;
+			ensurePath(m_length + count);
+			int i = m_length + count - 1;
+			for(int t = target; st.parent[t] != -1; t = st.parent[t])
+				m_path[i--] = (x0 + t / h) * m_height + y0 + t % h;
+			m_length += count;
+			return true;
+		}
+
+		float g = st.g[current];
+		int x = x0 + current / h;
+		int y = y0 + current % h;
+		for(int i = -1; i <= 1; i++) {
+			for(int j = -1; j <= 1; j++) {
+				if((i == 0 && j == 0) || (!diagonal && i != 0 && j != 0))
+					continue;
+				int nx = x + i;
+				int ny = y + j;
+				if(nx < x0 || nx >= x0 + w || ny < y0 || ny >= y0 + h || !walkable(nx, ny))
+					continue;
+				int n = (nx - x0) * h + ny - y0;
+				if(st.generation[n] == st.currentGeneration && st.heapIndex[n] == -1)
+					continue;
+				ax = abs(nx - tx);
+				ay = abs(ny - ty);
+				hv = diagonal ? (ax > ay ? (ax - ay) + ay * PATH_SQRT2 : (ay - ax) + ax * PATH_SQRT2) : (float)(ax + ay);
+				relax(st, n, g + (i != 0 && j != 0 ? PATH_SQRT2 : 1), hv, current);
+			}
+		}
+	}
+
+	return false;
+}
+
+bool wyPathFinder::appendLine(int from, int to) {
+	int x = from / m_height;
+	int y = from % m_height;
+	int tx = to / m_height;
+	int ty = to % m_height;
+	int count = m_snapshot->m_diagonal ? MAX(abs(tx - x), abs(ty - y)) : abs(tx - x) + abs(ty - y);
+	ensurePath(m_length + count);
+
+	// write after current path, length is only changed if whole line is walkable
+	bool diagonal = m_snapshot->m_diagonal;
+	for(int i = 0; i < count; i++) {
+		int dx = tx > x ? 1 : (tx < x ? -1 : 0);
+		int dy = ty > y ? 1 : (ty < y ? -1 : 0);
+		if(!diagonal && dx != 0)
+			dy = 0;
+		x += dx;
+		y += dy;
+		if(!walkable(x, y))
+			return false;
+		m_path[m_length + i] = x * m_height + y;
+	}
+	m_length += count;
+	return true;
+}
+
+bool wyPathFinder::searchHierarchy(wyPathSnapshot* s, wyPathHierarchy* hier, int start, int end, int pass) {
+	beginGrid(s, end, pass);
+	bool diagonal = s->m_diagonal;
+
+	// costs from start and to end inside their clusters
+	int size = hier->m_clusterSize;
+	if(m_distCapacity < size * size) {
+		m_distCapacity = size * size;
+		m_startDist = (float*)wyRealloc(m_startDist, m_distCapacity * sizeof(float));
+		m_goalDist = (float*)wyRealloc(m_goalDist, m_distCapacity * sizeof(float));
+	}
+	int sx = start / m_height;
+	int sy = start % m_height;
+	wyPathHierarchy::wyPathCluster* cs = hier->getCluster(sx, sy);
+	wyPathHierarchy::wyPathCluster* cg = hier->getCluster(m_endX, m_endY);
+	localDijkstra(cs->x, cs->y, cs->width, cs->height, start, m_startDist);
+	localDijkstra(cg->x, cg->y, cg->width, cg->height, end, m_goalDist);
+
+	// search abstract graph, start and end are temporary nodes
+	wyPathState& st = m_global;
+	beginState(st, s->m_tileCount);
+	relax(st, start, 0, gridHeuristic(sx, sy), -1);
+	int* slots = hier->m_nodeSlot;
+	bool found = false;
+	while(st.heapSize > 0) {
+		int current = heapPop(st);
+		if(current == end) {
+			found = true;
+			break;
+		}
+
+		float g = st.g[current];
+		int x = current / m_height;
+		int y = current % m_height;
+		wyPathHierarchy::wyPathCluster* c = hier->getCluster(x, y);
+
+		// start connects to nodes of its cluster, and to end if they are in same cluster
+		if(current == start) {
+			for(int i = 0; i < cs->nodeCount; i++) {
+				int n = cs->nodes[i];
+				float d = m_startDist[(n / m_height - cs->x) * cs->height + n % m_height - cs->y];
+				if(d < PATH_INFINITY && n != start)
+					relax(st, n, g + d, gridHeuristic(n / m_height, n % m_height), current);
+			}
+			if(cs == cg) {
+				float d = m_startDist[(m_endX - cs->x) * cs->height + m_endY - cs->y];
+				if(d < PATH_INFINITY)
+					relax(st, end, g + d, 0, current);
+			}
+		}
+
+		// edges of abstract node
+		int slot = slots[current];
+		if(slot != -1) {
+			// intra edges
+			float* row = c->dist + slot * c->nodeCount;
+			for(int i = 0; i < c->nodeCount; i++) {
+				if(i == slot || row[i] >= PATH_INFINITY)
+					continue;
+				int n = c->nodes[i];
+				if(st.generation[n] == st.currentGeneration && st.heapIndex[n] == -1)
+					continue;
+				relax(st, n, g + row[i], gridHeuristic(n / m_height, n % m_height), current);
+			}
+
+			// inter edges, node next to it in another cluster
+			for(int i = -1; i <= 1; i++) {
+				for(int j = -1; j <= 1; j++) {
+					if((i == 0 && j == 0) || (!diagonal && i != 0 && j != 0))
+						continue;
+					int nx = x + i;
+					int ny = y + j;
+					if(nx < 0 || nx >= m_width || ny < 0 || ny >= m_height)
+						continue;
+					int n = nx * m_height + ny;
+					if(slots[n] == -1 || m_blocked[n] || hier->getCluster(nx, ny) == c)
+						continue;
+					if(st.generation[n] == st.currentGeneration && st.heapIndex[n] == -1)
+						continue;
+					relax(st, n, g + (i != 0 && j != 0 ? PATH_SQRT2 : 1), gridHeuristic(nx, ny), current);
+				}
+			}
+		}
+
+		// nodes in end cluster connect to end
+		if(c == cg && current != start) {
+			float d = m_goalDist[(x - cg->x) * cg->height + y - cg->y];
+			if(d < PATH_INFINITY)
+				relax(st, end, g + d, 0, current);
+		}
+	}
+	if(!found)
+		return false;
+
+	// abstract path, from start to end
+	int count = 0;
+	for(int t = end; t != -1; t = st.parent[t])
+		count++;
+	if(count > m_chainCapacity) {
+		m_chainCapacity = MAX(count, m_chainCapacity * 2);
+		m_chain = (int*)wyRealloc(m_chain, m_chainCapacity * sizeof(int));
+	}
+	int i = count - 1;
+	for(int t = end; t != -1; t = st.parent[t])
+		m_chain[i--] = t;
+	m_cost = st.g[end] * s->m_rate;
+
+	// refine, nodes in different clusters are adjacent and others are connected inside cluster
+	m_length = 1;
+	ensurePath(1);
+	m_path[0] = start;
+	for(i = 1; i < count; i++) {
+		int from = m_chain[i - 1];
+		int to = m_chain[i];
+		wyPathHierarchy::wyPathCluster* c = hier->getCluster(from / m_height, from % m_height);
+		if(c != hier->getCluster(to / m_height, to % m_height)) {
+			ensurePath(m_length + 1);
+			m_path[m_length++] = to;
+		} else if(!appendLine(from, to) && !localSearch(c->x, c->y, c->width, c->height, from, to)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool wyPathFinder::findPath(wyPathSnapshot* s, wyPathHierarchy* h, int start, int end, bool ignoreBlock, wyPathAlgorithm algorithm, bool wait) {
+	m_length = 0;
+	m_cost = 0;
+	if(start < 0 || end < 0 || start >= s->m_tileCount || end >= s->m_tileCount || start == end)
+		return false;
+	if(s->m_blocked[end] && !ignoreBlock)
+		return false;
+	int pass = ignoreBlock ? end : -1;
+
+	// grid algorithms need uniform cost
+	if(!s->m_grid)
+		algorithm = WY_PATH_ALGORITHM_ASTAR;
+	else if(algorithm == WY_PATH_ALGORITHM_HIERARCHICAL && h == NULL)
+		algorithm = WY_PATH_ALGORITHM_JPS;
+
+	// on four way grid a vertical jump scans rows at every step, plain A* is usually faster
+	if(algorithm == WY_PATH_ALGORITHM_AUTO)
+		algorithm = s->m_diagonal ? WY_PATH_ALGORITHM_JPS : WY_PATH_ALGORITHM_ASTAR;
+
+	// a worker may be rebuilding abstract graph, caller who can't wait uses plain A* instead
+	if(algorithm == WY_PATH_ALGORITHM_HIERARCHICAL) {
+		if(wait)
+			h->lock();
+		else if(!h->tryLock())
+			algorithm = WY_PATH_ALGORITHM_ASTAR;
+	}
+
+	// hierarchical search falls back to jump point search if abstract graph can't be used or doesn't find path
+	if(algorithm == WY_PATH_ALGORITHM_HIERARCHICAL) {
+		bool found = h->update(s, this) && searchHierarchy(s, h, start, end, pass);
+		h->unlock();
+		if(found) {
+			m_algorithm = WY_PATH_ALGORITHM_HIERARCHICAL;
+			return true;
+		}
+		algorithm = WY_PATH_ALGORITHM_JPS;
+	}
+
+	m_algorithm = algorithm;
+	if(algorithm == WY_PATH_ALGORITHM_JPS) {
+		return searchJump(s, start, end, pass);
+	} else if(s->m_grid) {
+		// plain A* on grid is a local search whose area is whole grid
+		beginGrid(s, end, pass);
+		ensurePath(1);
+		m_path[0] = start;
+		m_length = 1;
+		if(!localSearch(0, 0, m_width, m_height, start, end)) {
+			m_length = 0;
+			return false;
+		}
+		m_cost = m_local.g[end] * s->m_rate;
+		return true;
+	} else {
+		return searchGraph(s, start, end, pass);
+	}
+}
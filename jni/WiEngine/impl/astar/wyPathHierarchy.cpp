@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: mike(mike.weib@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "wyPathHierarchy.h"
+#include "wyPathSnapshot.h"
+#include "wyPathFinder.h"
+#include "wyMemory.h"
+#include "wyAtomic.h"
+#include "wyMath.h"
+#include <stdlib.h>
+#include <string.h>
+
+// entrance longer than this has two transitions at both ends, otherwise one in the middle
+#define MAX_SINGLE_TRANSITION 6
+
+wyPathHierarchy::wyPathHierarchy(int clusterSize) :
+		m_refCount(1),
+		m_clusterSize(clusterSize),
+		m_clustersX(0),
+		m_clustersY(0),
+		m_clusters(NULL),
+		m_nodeSlot(NULL),
+		m_snapshot(NULL),
+		m_scratch((float*)wyMalloc(clusterSize * clusterSize * sizeof(float))) {
+	pthread_mutex_init(&m_mutex, NULL);
+}
+
+wyPathHierarchy::~wyPathHierarchy() {
+	destroyClusters();
+	wyFree(m_nodeSlot);
+	wyFree(m_scratch);
+	if(m_snapshot != NULL)
+		m_snapshot->release();
+	pthread_mutex_destroy(&m_mutex);
+}
+
+wyPathHierarchy* wyPathHierarchy::make(int clusterSize) {
+	return WYNEW wyPathHierarchy(MAX(2, clusterSize));
+}
+
+void wyPathHierarchy::retain() {
+	wyAtomicAdd(&m_refCount, 1);
+}
+
+void wyPathHierarchy::release() {
+	if(wyAtomicAdd(&m_refCount, -1) == 0)
+		WYDELETE(this);
+}
+
+void wyPathHierarchy::destroyClusters() {
+	int count = m_clustersX * m_clustersY;
+	for(int i = 0; i < count; i++) {
+		wyFree(m_clusters[i].nodes);
+		wyFree(m_clusters[i].dist);
+	}
+	wyFree(m_clusters);
+	m_clusters = NULL;
+	m_clustersX = 0;
+	m_clustersY = 0;
+}
+
+void wyPathHierarchy::createClusters(wyPathSnapshot* s) {
+	destroyClusters();
+	m_clustersX = (s->m_width + m_clusterSize - 1) / m_clusterSize;
+	m_clustersY = (s->m_height + m_clusterSize - 1) / m_clusterSize;
+	m_clusters = (wyPathCluster*)wyCalloc(MAX(1, m_clustersX * m_clustersY), sizeof(wyPathCluster));
+	for(int cx = 0; cx < m_clustersX; cx++) {
+		for(int cy = 0; cy < m_clustersY; cy++) {
+			wyPathCluster* c = m_clusters + cx * m_clustersY + cy;
+			c->x = cx * m_clusterSize;
+			c->y = cy * m_clusterSize;
+			c->width = MIN(m_clusterSize, s->m_width - c->x);
+			c->height = MIN(m_clusterSize, s->m_height - c->y);
+			c->nodes = (int*)wyMalloc(2 * (c->width + c->height) * sizeof(int));
+			c->dirty = true;
+		}
+	}
+
+	// no tile is node until clusters are rebuilt
+	m_nodeSlot = (int*)wyRealloc(m_nodeSlot, MAX(1, s->m_tileCount) * sizeof(int));
+	memset(m_nodeSlot, 0xff, s->m_tileCount * sizeof(int));
+}
+
+void wyPathHierarchy::markDirty(int x, int y) {
+	wyPathCluster* c = getCluster(x, y);
+	c->dirty = true;
+
+	// tile on border affects entrances of neighbor cluster
+	if(x == c->x && x > 0)
+		getCluster(x - 1, y)->dirty = true;
+	if(x == c->x + c->width - 1 && x + 1 < m_snapshot->m_width)
+		getCluster(x + 1, y)->dirty = true;
+	if(y == c->y && y > 0)
+		getCluster(x, y - 1)->dirty = true;
+	if(y == c->y + c->height - 1 && y + 1 < m_snapshot->m_height)
+		getCluster(x, y + 1)->dirty = true;
+}
+
+void wyPathHierarchy::addBorderNodes(wyPathCluster* c, int ax, int ay, int bx, int by, int dx, int dy, int length) {
+	int height = m_snapshot->m_height;
+	unsigned char* blocked = m_snapshot->m_blocked;
+	int runStart = -1;
+	for(int i = 0; i <= length; i++) {
+		bool open = i < length &&
+				!blocked[(ax + dx * i) * height + ay + dy * i] &&
+				!blocked[(bx + dx * i) * height + by + dy * i];
+		if(open) {
+			if(runStart == -1)
+				runStart = i;
+			continue;
+		}
+		if(runStart == -1)
+			continue;
+
+		// run ends, add its transitions
+		int runEnd = i - 1;
+		int picks[2];
+		int pickCount = 0;
+		if(runEnd - runStart + 1 < MAX_SINGLE_TRANSITION) {
+			picks[pickCount++] = (runStart + runEnd) / 2;
+		} else {
+			picks[pickCount++] = runStart;
+			picks[pickCount++] = runEnd;
+		}
+		for(int p = 0; p < pickCount; p++) {
+			int tile = (ax + dx * picks[p]) * height + ay + dy * picks[p];
+			bool exist = false;
+			for(int n = 0; n < c->nodeCount && !exist; n++)
+				exist = c->nodes[n] == tile;
+			if(!exist)
+				c->nodes[c->nodeCount++] = tile;
+		}
+		runStart = -1;
+	}
+}
+
+void wyPathHierarchy::rebuildNodes(wyPathCluster* c) {
+	for(int i = 0; i < c->nodeCount; i++)
+		m_nodeSlot[c->nodes[i]] = -1;
+	c->nodeCount = 0;
+
+	// scan four borders
+	int right = c->x + c->width;
+	int top = c->y + c->height;
+	if(c->x > 0)
+		addBorderNodes(c, c->x, c->y, c->x - 1, c->y, 0, 1, c->height);
+	if(right < m_snapshot->m_width)
+		addBorderNodes(c, right - 1, c->y, right, c->y, 0, 1, c->height);
+	if(c->y > 0)
+		addBorderNodes(c, c->x, c->y, c->x, c->y - 1, 1, 0, c->width);
+	if(top < m_snapshot->m_height)
+		addBorderNodes(c, c->x, top - 1, c->x, top, 1, 0, c->width);
+
+	for(int i = 0; i < c->nodeCount; i++)
+		m_nodeSlot[c->nodes[i]] = i;
+}
+
+void wyPathHierarchy::rebuildDist(wyPathCluster* c, wyPathFinder* finder) {
+	int k = c->nodeCount;
+	c->dist = (float*)wyRealloc(c->dist, MAX(1, k * k) * sizeof(float));
+	int height = m_snapshot->m_height;
+	for(int a = 0; a < k; a++) {
+		finder->localDijkstra(c->x, c->y, c->width, c->height, c->nodes[a], m_scratch);
+		for(int b = 0; b < k; b++) {
+			int n = c->nodes[b];
+			c->dist[a * k + b] = m_scratch[(n / height - c->x) * c->height + n % height - c->y];
+		}
+	}
+}
+
+bool wyPathHierarchy::update(wyPathSnapshot* s, wyPathFinder* finder) {
+	if(!s->isGrid())
+		return false;
+
+	bool full = m_snapshot == NULL ||
+			m_snapshot->m_width != s->m_width ||
+			m_snapshot->m_height != s->m_height ||
+			m_snapshot->m_diagonal != s->m_diagonal;
+	if(!full) {
+		// a job may carry an older snapshot than the one abstraction is built on
+		if(s->m_version < m_snapshot->m_version)
+			return false;
+		if(s->m_version == m_snapshot->m_version)
+			return true;
+
+		// only clusters whose tiles changed are rebuilt, snapshot may know changed tiles
+		int height = s->m_height;
+		if(s->m_baseVersion == m_snapshot->m_version) {
+			for(int i = 0; i < s->m_changeCount; i++)
+				markDirty(s->m_changes[i] / height, s->m_changes[i] % height);
+		} else {
+			for(int i = 0; i < s->m_tileCount; i++) {
+				if(s->m_blocked[i] != m_snapshot->m_blocked[i])
+					markDirty(i / height, i % height);
+			}
+		}
+	}
+
+	s->retain();
+	if(m_snapshot != NULL)
+		m_snapshot->release();
+	m_snapshot = s;
+	if(full)
+		createClusters(s);
+
+	// nodes of all dirty clusters first, then costs between them
+	int count = m_clustersX * m_clustersY;
+	for(int i = 0; i < count; i++) {
+		if(m_clusters[i].dirty)
+			rebuildNodes(m_clusters + i);
+	}
+	finder->beginGrid(s, 0, -1);
+	for(int i = 0; i < count; i++) {
+		if(m_clusters[i].dirty) {
+			rebuildDist(m_clusters + i, finder);
+			m_clusters[i].dirty = false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: mike(mike.weib@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "wyPathService.h"
+#include "wyPathSnapshot.h"
+#include "wyPathHierarchy.h"
+#include "wyAStarMap.h"
+#include "wyAStarTile.h"
+#include "wyThread.h"
+#include "wyTargetSelector.h"
+#include "wyLog.h"
+#include "wyMath.h"
+#include <stdlib.h>
+#include <string.h>
+
+wyPathService* gPathService = NULL;
+
+// default settings
+#define DEFAULT_WORKER_THREADS 2
+#define DEFAULT_CLUSTER_SIZE 16
+
+wyPathService::wyPathService() :
+		m_maps(WYNEW map<wyAStarMap*, wyPathMapEntry>()),
+		m_jobs(WYNEW map<int, wyPathJob*>()),
+		m_queueHead(NULL),
+		m_queueTail(NULL),
+		m_results(wyLockFreeQueueNew()),
+		m_threadCount(0),
+		m_maxThreads(DEFAULT_WORKER_THREADS),
+		m_quit(false),
+		m_nextId(1),
+		m_clusterSize(DEFAULT_CLUSTER_SIZE),
+		m_finder(WYNEW wyPathFinder()),
+		m_resultCapacity(0) {
+	memset(&m_result, 0, sizeof(wyPathResult));
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_cond, NULL);
+}
+
+wyPathService::~wyPathService() {
+	// stop worker threads and wait them exit
+	pthread_mutex_lock(&m_mutex);
+	m_quit = true;
+	pthread_cond_broadcast(&m_cond);
+	while(m_threadCount > 0)
+		pthread_cond_wait(&m_cond, &m_mutex);
+	pthread_mutex_unlock(&m_mutex);
+
+	// every job is either in queue or in result queue now, release them all
+	for(map<int, wyPathJob*>::iterator iter = m_jobs->begin(); iter != m_jobs->end(); iter++)
+		releaseJob(iter->second);
+	WYDELETE(m_jobs);
+	wyLockFreeQueueDestroy(m_results);
+	pthread_cond_destroy(&m_cond);
+	pthread_mutex_destroy(&m_mutex);
+
+	// map cache
+	for(map<wyAStarMap*, wyPathMapEntry>::iterator iter = m_maps->begin(); iter != m_maps->end(); iter++) {
+		iter->second.snapshot->release();
+		if(iter->second.hierarchy != NULL)
+			iter->second.hierarchy->release();
+	}
+	WYDELETE(m_maps);
+
+	WYDELETE(m_finder);
+	wyFree(m_result.points);
+	gPathService = NULL;
+}
+
+wyPathService* wyPathService::getInstance() {
+	if(gPathService == NULL) {
+		gPathService = WYNEW wyPathService();
+	}
+	return gPathService;
+}
+
+wyPathService* wyPathService::getInstanceNoCreate() {
+	return gPathService;
+}
+
+int wyPathService::indexOf(wyAStarMap* mapdata, int x, int y) {
+	wyAStarTile* tile = mapdata->getTileAt(x, y);
+	return tile == NULL ? -1 : tile->getIndex();
+}
+
+wyPathService::wyPathMapEntry& wyPathService::getEntry(wyAStarMap* mapdata, bool hierarchy) {
+	map<wyAStarMap*, wyPathMapEntry>::iterator iter = m_maps->find(mapdata);
+	if(iter == m_maps->end()) {
+		wyPathMapEntry entry;
+		entry.snapshot = wyPathSnapshot::make(mapdata, NULL);
+		entry.hierarchy = NULL;
+		iter = m_maps->insert(make_pair(mapdata, entry)).first;
+	} else if(iter->second.snapshot->getVersion() != mapdata->getVersion()) {
+		// map is changed, snapshots which are held by jobs are not affected
+		wyPathSnapshot* old = iter->second.snapshot;
+		iter->second.snapshot = wyPathSnapshot::make(mapdata, old);
+		old->release();
+	}
+
+	// abstract graph is created only when needed, it is built lazily by worker
+	wyPathMapEntry& entry = iter->second;
+	if(hierarchy && entry.hierarchy == NULL && entry.snapshot->isGrid())
+		entry.hierarchy = wyPathHierarchy::make(m_clusterSize);
+	return entry;
+}
+
+void wyPathService::fillResult(wyPathFinder* finder, wyPathSnapshot* s, wyPathResult* result, int* points) {
+	int* path = finder->getPath();
+	int length = finder->getLength();
+	for(int i = 0; i < length; i++) {
+		points[i * 2] = s->getTileX(path[i]);
+		points[i * 2 + 1] = s->getTileY(path[i]);
+	}
+	result->algorithm = finder->getAlgorithm();
+	result->length = length;
+	result->points = points;
+	result->cost = finder->getCost();
+}
+
+void wyPathService::runJob(wyPathFinder* finder, wyPathJob* job) {
+	if(job->cancelled)
+		return;
+
+	job->found = finder->findPath(job->snapshot, job->hierarchy, job->start, job->end, job->ignoreBlock, job->algorithm);
+	if(job->found) {
+		int* points = (int*)wyMalloc(finder->getLength() * 2 * sizeof(int));
+		fillResult(finder, job->snapshot, &job->result, points);
+	}
+}
+
+void wyPathService::releaseJob(wyPathJob* job) {
+	job->snapshot->release();
+	if(job->hierarchy != NULL)
+		job->hierarchy->release();
+	wyFree(job->result.points);
+	wyFree(job);
+}
+
+int wyPathService::requestPath(wyAStarMap* mapdata, int startx, int starty, int endx, int endy, bool ignoreBlock,
+		wyPathCallback* callback, void* data, wyPathAlgorithm algorithm) {
+	if(mapdata == NULL) {
+		LOGE("%s: map must be set", __FUNCTION__);
+		return -1;
+	}
+
+	// create job, it holds snapshot so map can be changed after this
+	wyPathMapEntry& entry = getEntry(mapdata, algorithm == WY_PATH_ALGORITHM_HIERARCHICAL);
+	wyPathJob* job = (wyPathJob*)wyCalloc(1, sizeof(wyPathJob));
+	job->id = m_nextId++;
+	job->snapshot = entry.snapshot;
+	job->snapshot->retain();
+	if(algorithm == WY_PATH_ALGORITHM_HIERARCHICAL && entry.hierarchy != NULL) {
+		job->hierarchy = entry.hierarchy;
+		job->hierarchy->retain();
+	}
+	job->start = indexOf(mapdata, startx, starty);
+	job->end = indexOf(mapdata, endx, endy);
+	job->ignoreBlock = ignoreBlock;
+	job->algorithm = algorithm;
+	job->data = data;
+	job->result.id = job->id;
+	if(callback != NULL)
+		memcpy(&job->callback, callback, sizeof(wyPathCallback));
+	(*m_jobs)[job->id] = job;
+
+	// queue it and start a worker if allowed
+	pthread_mutex_lock(&m_mutex);
+	job->next = NULL;
+	if(m_queueTail == NULL) {
+		m_queueHead = m_queueTail = job;
+	} else {
+		m_queueTail->next = job;
+		m_queueTail = job;
+	}
+	bool newThread = m_threadCount < m_maxThreads;
+	if(newThread)
+		m_threadCount++;
+	pthread_cond_signal(&m_cond);
+	pthread_mutex_unlock(&m_mutex);
+
+	// if no thread can be created, jobs will be run in gl thread
+	if(newThread) {
+		if(wyThread::runThread(wyTargetSelector::make(this, SEL(wyPathService::workerEntry))) != 0) {
+			LOGW("%s: failed to create worker thread", __FUNCTION__);
+			pthread_mutex_lock(&m_mutex);
+			m_threadCount--;
+			pthread_mutex_unlock(&m_mutex);
+		}
+	}
+
+	return job->id;
+}
+
+bool wyPathService::cancel(int id) {
+	map<int, wyPathJob*>::iterator iter = m_jobs->find(id);
+	if(iter == m_jobs->end())
+		return false;
+
+	// job will be released when it comes back from worker
+	iter->second->cancelled = true;
+	return true;
+}
+
+wyPathResult* wyPathService::findPath(wyAStarMap* mapdata, int startx, int starty, int endx, int endy, bool ignoreBlock, wyPathAlgorithm algorithm) {
+	if(mapdata == NULL)
+		return NULL;
+
+	// abstract graph is shared with workers, if a worker holds it the search falls back to plain A*
+	wyPathMapEntry& entry = getEntry(mapdata, algorithm == WY_PATH_ALGORITHM_HIERARCHICAL);
+	wyPathHierarchy* h = algorithm == WY_PATH_ALGORITHM_HIERARCHICAL ? entry.hierarchy : NULL;
+	if(!m_finder->findPath(entry.snapshot, h, indexOf(mapdata, startx, starty), indexOf(mapdata, endx, endy), ignoreBlock, algorithm, false))
+		return NULL;
+
+	// reuse point buffer
+	int length = m_finder->getLength();
+	if(length > m_resultCapacity) {
+		m_resultCapacity = MAX(length, m_resultCapacity * 2);
+		m_result.points = (int*)wyRealloc(m_result.points, m_resultCapacity * 2 * sizeof(int));
+	}
+	m_result.id = 0;
+	fillResult(m_finder, entry.snapshot, &m_result, m_result.points);
+	return &m_result;
+}
+
+void wyPathService::removeMap(wyAStarMap* mapdata) {
+	map<wyAStarMap*, wyPathMapEntry>::iterator iter = m_maps->find(mapdata);
+	if(iter != m_maps->end()) {
+		// jobs hold their own references
+		iter->second.snapshot->release();
+		if(iter->second.hierarchy != NULL)
+			iter->second.hierarchy->release();
+		m_maps->erase(iter);
+	}
+}
+
+void wyPathService::setMaxThreads(int count) {
+	pthread_mutex_lock(&m_mutex);
+	m_maxThreads = MAX(0, count);
+	pthread_cond_broadcast(&m_cond);
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void wyPathService::workerEntry(wyTargetSelector* ts) {
+	wyPathFinder* finder = WYNEW wyPathFinder();
+	pthread_mutex_lock(&m_mutex);
+	while(true) {
+		// wait a job, extra workers exit if max thread count is reduced
+		while(!m_quit && m_queueHead == NULL && m_threadCount <= m_maxThreads)
+			pthread_cond_wait(&m_cond, &m_mutex);
+		if(m_quit || m_threadCount > m_maxThreads)
+			break;
+
+		// pop job
+		wyPathJob* job = m_queueHead;
+		m_queueHead = job->next;
+		if(m_queueHead == NULL)
+			m_queueTail = NULL;
+		pthread_mutex_unlock(&m_mutex);
+
+		// search on snapshot, then hand it back to gl thread
+		runJob(finder, job);
+		wyLockFreeQueuePush(m_results, job);
+
+		pthread_mutex_lock(&m_mutex);
+	}
+
+	// notify service that we are quit
+	m_threadCount--;
+	pthread_cond_broadcast(&m_cond);
+	pthread_mutex_unlock(&m_mutex);
+	WYDELETE(finder);
+}
+
+void wyPathService::dispatchResults() {
+	if(m_jobs->empty())
+		return;
+
+	// if there is no worker, run queued jobs here
+	pthread_mutex_lock(&m_mutex);
+	if(m_threadCount == 0) {
+		while(m_queueHead != NULL) {
+			wyPathJob* job = m_queueHead;
+			m_queueHead = job->next;
+			runJob(m_finder, job);
+			wyLockFreeQueuePush(m_results, job);
+		}
+		m_queueTail = NULL;
+	}
+	pthread_mutex_unlock(&m_mutex);
+
+	// callback, a callback may request new paths
+	wyPathJob* job;
+	while((job = (wyPathJob*)wyLockFreeQueuePop(m_results)) != NULL) {
+		m_jobs->erase(job->id);
+		if(!job->cancelled) {
+			if(job->found) {
+				if(job->callback.onPathFound != NULL)
+					job->callback.onPathFound(&job->result, job->data);
+			} else {
+				if(job->callback.onPathNotFound != NULL)
+					job->callback.onPathNotFound(job->id, job->data);
+			}
+		}
+		releaseJob(job);
+	}
+}
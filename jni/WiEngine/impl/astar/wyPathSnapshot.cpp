@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: mike(mike.weib@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "wyPathSnapshot.h"
+#include "wyAStarMap.h"
+#include "wyAStarTile.h"
+#include "wyRectAStarMap.h"
+#include "wyArray.h"
+#include "wyMemory.h"
+#include "wyAtomic.h"
+#include "wyMath.h"
+#include <stdlib.h>
+#include <string.h>
+#include <typeinfo>
+
+wyPathSnapshot::wyPathSnapshot() :
+		m_refCount(1),
+		m_version(0),
+		m_costVersion(0),
+		m_tileCount(0),
+		m_grid(false),
+		m_width(0),
+		m_height(0),
+		m_diagonal(false),
+		m_rate(1),
+		m_blocked(NULL),
+		m_graph(NULL),
+		m_baseVersion(-1),
+		m_changes(NULL),
+		m_changeCount(0) {
+}
+
+wyPathSnapshot::~wyPathSnapshot() {
+	wyFree(m_blocked);
+	wyFree(m_changes);
+	if(m_graph != NULL)
+		releaseGraph(m_graph);
+}
+
+void wyPathSnapshot::retain() {
+	wyAtomicAdd(&m_refCount, 1);
+}
+
+void wyPathSnapshot::release() {
+	if(wyAtomicAdd(&m_refCount, -1) == 0)
+		WYDELETE(this);
+}
+
+wyPathSnapshot::wyPathGraph* wyPathSnapshot::buildGraph(wyAStarMap* map) {
+	int count = map->getTileCount();
+	wyPathGraph* graph = (wyPathGraph*)wyCalloc(1, sizeof(wyPathGraph));
+	graph->refCount = 1;
+	graph->x = (int*)wyMalloc(count * sizeof(int));
+	graph->y = (int*)wyMalloc(count * sizeof(int));
+	graph->offsets = (int*)wyMalloc((count + 1) * sizeof(int));
+
+	// count edges first so that arrays are allocated once
+	int edges = 0;
+	for(int i = 0; i < count; i++) {
+		wyAStarTile* tile = map->getTileByIndex(i);
+		graph->x[i] = tile->getX();
+		graph->y[i] = tile->getY();
+		graph->offsets[i] = edges;
+		edges += tile->getChilds()->num;
+	}
+	graph->offsets[count] = edges;
+	graph->neighbors = (int*)wyMalloc(MAX(1, edges) * sizeof(int));
+	graph->costs = (float*)wyMalloc(MAX(1, edges) * sizeof(float));
+
+	// step cost is read here, so custom map can still define its own cost
+	for(int i = 0; i < count; i++) {
+		wyAStarTile* tile = map->getTileByIndex(i);
+		wyArray* childs = tile->getChilds();
+		int base = graph->offsets[i];
+		for(int j = 0; j < childs->num; j++) {
+			wyAStarTile* child = (wyAStarTile*)childs->arr[j];
+			graph->neighbors[base + j] = child->getIndex();
+			graph->costs[base + j] = map->getStepG(tile, child);
+		}
+	}
+
+	return graph;
+}
+
+void wyPathSnapshot::releaseGraph(wyPathGraph* graph) {
+	if(wyAtomicAdd(&graph->refCount, -1) == 0) {
+		wyFree(graph->x);
+		wyFree(graph->y);
+		wyFree(graph->offsets);
+		wyFree(graph->neighbors);
+		wyFree(graph->costs);
+		wyFree(graph);
+	}
+}
+
+void wyPathSnapshot::readBlocked(wyAStarMap* map, wyPathSnapshot* s) {
+	for(int i = 0; i < s->m_tileCount; i++)
+		s->m_blocked[i] = map->getTileByIndex(i)->isBlocked() ? 1 : 0;
+}
+
+wyPathSnapshot* wyPathSnapshot::make(wyAStarMap* map, wyPathSnapshot* last) {
+	wyPathSnapshot* s = WYNEW wyPathSnapshot();
+	int count = map->getTileCount();
+	s->m_version = map->getVersion();
+	s->m_costVersion = map->getCostVersion();
+	s->m_tileCount = count;
+
+	s->m_blocked = (unsigned char*)wyMalloc(MAX(1, count));
+
+	// cost part doesn't change if cost version is same
+	if(last != NULL && last->m_costVersion == s->m_costVersion && last->m_tileCount == count) {
+		// blocking state, only read changed tiles if map remembers all changes since last snapshot
+		int changes = s->m_version - last->m_version;
+		bool incremental = changes >= 0;
+		for(int v = last->m_version + 1; incremental && v <= s->m_version; v++) {
+			if(map->getChangedTile(v) == -1)
+				incremental = false;
+		}
+		if(incremental) {
+			memcpy(s->m_blocked, last->m_blocked, count);
+			s->m_baseVersion = last->m_version;
+			s->m_changes = (int*)wyMalloc(MAX(1, changes) * sizeof(int));
+			for(int v = last->m_version + 1; v <= s->m_version; v++) {
+				int index = map->getChangedTile(v);
+				s->m_blocked[index] = map->getTileByIndex(index)->isBlocked() ? 1 : 0;
+				s->m_changes[s->m_changeCount++] = index;
+			}
+		} else {
+			readBlocked(map, s);
+		}
+
+		s->m_grid = last->m_grid;
+		s->m_width = last->m_width;
+		s->m_height = last->m_height;
+		s->m_diagonal = last->m_diagonal;
+		s->m_rate = last->m_rate;
+		s->m_graph = last->m_graph;
+		if(s->m_graph != NULL)
+			wyAtomicAdd(&s->m_graph->refCount, 1);
+		return s;
+	}
+
+	readBlocked(map, s);
+
+	// subclass may override step cost, so only exact rect map is treated as grid
+	bool grid = typeid(*map) == typeid(wyRectAStarMap) && count > 0;
+	float rate = count > 0 ? map->getTileByIndex(0)->getGRate() : 1;
+	for(int i = 1; grid && i < count; i++) {
+		if(map->getTileByIndex(i)->getGRate() != rate)
+			grid = false;
+	}
+
+	if(grid) {
+		wyRectAStarMap* rect = (wyRectAStarMap*)map;
+		s->m_grid = true;
+		s->m_width = rect->getWidth();
+		s->m_height = rect->getHeight();
+		s->m_diagonal = rect->isAllowDiagonal();
+		s->m_rate = rate;
+	} else {
+		s->m_graph = buildGraph(map);
+	}
+
+	return s;
+}
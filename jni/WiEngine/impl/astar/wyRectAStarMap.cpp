@@ -43,6 +43,7 @@ wyRectAStarMap::wyRectAStarMap(int width, int height, bool isAllowDiagonal) :
 			wyArrayPush(m_tiles, WYNEW wyAStarTile(TILE_FREE, x, y));
 		}
 	}
+	indexTiles();
 
 	// auto child
 	for (int i = 0; i < m_tiles->num; i++) {
@@ -67,6 +68,11 @@ wyRectAStarMap::~wyRectAStarMap() {
 
 }
 
+int wyRectAStarMap::getTileIndex(int x, int y) {
+	// tiles are pushed column by column
+	return x * m_height + y;
+}
+
 bool wyRectAStarMap::isValidTile(int x, int y) {
 	if (x < 0 || x >= m_width || y < 0 || y >= m_height) {
 		return false;
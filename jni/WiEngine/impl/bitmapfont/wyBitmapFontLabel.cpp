@@ -30,6 +30,9 @@
 #include "wyLog.h"
 #include "wyTypes.h"
 #include "wyUtils.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyBitmapFontLabel::wyBitmapFontLabel(wyBitmapFont* font, const char* text) :
         m_font(font),
@@ -359,6 +362,8 @@ void wyBitmapFontLabel::setAlignment(Alignment alignment) {
 }
 
 void wyBitmapFontLabel::draw() {
+	gRenderQueue->flush();
+
  	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -34,48 +34,85 @@
 // global event dispatcher
 extern wyEventDispatcher* gEventDispatcher;
 
-// global pools
-#define MAP map<ssize_t, wyAutoReleasePool*>
-#define ITER MAP::iterator
-static MAP* s_pools = NULL;
-
-wyAutoReleasePool::wyAutoReleasePool() {
-	// init global pool mapping
-	if(!s_pools) {
-		s_pools = WYNEW MAP();
-	}
+// object count of a page
+#define PAGE_CAPACITY 254
+
+/// a page of objects, pages are linked to make pool grow without copying
+struct wyAutoReleasePage {
+	/// next page
+	wyAutoReleasePage* next;
+
+	/// count of objects in page
+	int count;
+
+	/// objects
+	wyObject* objects[PAGE_CAPACITY];
+};
 
-	// init object list
-	m_objects = WYNEW vector<wyObject*>();
+// key of pool stack top of every thread
+static pthread_key_t sPoolKey;
+static pthread_once_t sPoolOnce = PTHREAD_ONCE_INIT;
 
-	// get current thread id
-	m_thread = currentThreadId();
+// all living pools, only used when pool is created or destroyed
+static wyAutoReleasePool* sPools = NULL;
+static pthread_mutex_t sPoolsMutex;
 
-	// put self in map
-	ITER iter = s_pools->find(m_thread);
-	if(iter == s_pools->end()) {
-		(*s_pools)[m_thread] = this;
+// pool of opengl thread which is drained every frame
+static wyAutoReleasePool* sFramePool = NULL;
+
+// max objects released by frame pool in one frame
+static int sDrainBudget = 0;
+
+void wyAutoReleasePool::initPoolKey() {
+	pthread_key_create(&sPoolKey, wyAutoReleasePool::onThreadExit);
+	pthread_mutex_init(&sPoolsMutex, NULL);
+}
+
+wyAutoReleasePool::wyAutoReleasePool(bool push) :
+		m_thread(currentThreadId()),
+		m_parent(NULL),
+		m_head(NULL),
+		m_tail(NULL),
+		m_headIndex(0),
+		m_count(0),
+		m_prevPool(NULL),
+		m_nextPool(NULL) {
+	pthread_once(&sPoolOnce, initPoolKey);
+
+	// put self in pool list
+	pthread_mutex_lock(&sPoolsMutex);
+	m_nextPool = sPools;
+	if(sPools)
+		sPools->m_prevPool = this;
+	sPools = this;
+	pthread_mutex_unlock(&sPoolsMutex);
+
+	// push to pool stack of current thread
+	if(push) {
+		m_parent = (wyAutoReleasePool*)pthread_getspecific(sPoolKey);
+		pthread_setspecific(sPoolKey, this);
 	}
 }
 
 wyAutoReleasePool::~wyAutoReleasePool() {
-	// release all objects
-	for(vector<wyObject*>::iterator iter = m_objects->begin(); iter != m_objects->end(); iter++) {
-		wyObjectRelease(*iter);
-	}
-	WYDELETE(m_objects);
+	// release all objects, destructor of object may add new object to frame pool
+	while(m_count > 0)
+		releaseObjects(m_count);
+	if(m_head)
+		wyFree(m_head);
 
-	// remove self from pool map
-	ITER iter = s_pools->find(m_thread);
-	if(iter != s_pools->end()) {
-		s_pools->erase(iter);
+	// remove self from pool list
+	pthread_mutex_lock(&sPoolsMutex);
+	if(m_prevPool)
+		m_prevPool->m_nextPool = m_nextPool;
+	else
+		sPools = m_nextPool;
+	if(m_nextPool)
+		m_nextPool->m_prevPool = m_prevPool;
+	pthread_mutex_unlock(&sPoolsMutex);
 
-		// if pool map is empty, release map also
-		if(s_pools->empty()) {
-			WYDELETE(s_pools);
-			s_pools = NULL;
-		}
-	}
+	if(sFramePool == this)
+		sFramePool = NULL;
 }
 
 wyAutoReleasePool* wyAutoReleasePool::make() {
@@ -83,53 +120,164 @@ wyAutoReleasePool* wyAutoReleasePool::make() {
 	 * This is special case for auto release pool because we don't call autorelease
 	 * in make method
 	 */
-	return WYNEW wyAutoReleasePool();
+	return WYNEW wyAutoReleasePool(true);
+}
+
+void wyAutoReleasePool::addObject(wyObject* obj) {
+	// need a new page?
+	if(m_tail == NULL || m_tail->count >= PAGE_CAPACITY) {
+		wyAutoReleasePage* page = (wyAutoReleasePage*)wyMalloc(sizeof(wyAutoReleasePage));
+		page->next = NULL;
+		page->count = 0;
+		if(m_tail)
+			m_tail->next = page;
+		else
+			m_head = page;
+		m_tail = page;
+	}
+
+	m_tail->objects[m_tail->count++] = obj;
+	m_count++;
+}
+
+int wyAutoReleasePool::releaseObjects(int max) {
+	// objects added by destructors are not released in this call
+	int n = MIN(max, m_count);
+	for(int i = 0; i < n; i++) {
+		// free drained page
+		if(m_headIndex >= m_head->count) {
+			wyAutoReleasePage* page = m_head;
+			m_head = page->next;
+			m_headIndex = 0;
+			wyFree(page);
+		}
+
+		// count is decreased before release in case release adds object
+		wyObject* obj = m_head->objects[m_headIndex++];
+		m_count--;
+		wyObjectRelease(obj);
+	}
+
+	// reset last page if it is empty
+	if(m_count == 0 && m_head != NULL) {
+		m_head->count = 0;
+		m_headIndex = 0;
+	}
+
+	return n;
 }
 
 void wyAutoReleasePool::addToPool(wyObject* obj) {
-	// get current thread id
-	ssize_t t = currentThreadId();
-
-	// if pool map is not here, create
-	if(!s_pools)
-		wyAutoReleasePool::make();
-
-	// add to object list
-	ITER iter = s_pools->find(t);
-	if(iter != s_pools->end()) {
-		wyAutoReleasePool* pool = iter->second;
-		pool->m_objects->push_back(obj);
+	pthread_once(&sPoolOnce, initPoolKey);
+
+	// top pool of current thread
+	wyAutoReleasePool* pool = (wyAutoReleasePool*)pthread_getspecific(sPoolKey);
+	if(pool == NULL) {
+		if(isGLThread()) {
+			// opengl thread uses frame pool
+			if(sFramePool == NULL)
+				sFramePool = WYNEW wyAutoReleasePool(false);
+			pool = sFramePool;
+		} else {
+			// create implicit pool, it will be drained when thread exits
+			pool = wyAutoReleasePool::make();
+		}
 	}
+
+	pool->addObject(obj);
 }
 
 void wyAutoReleasePool::flush() {
-	if(!s_pools)
-		return;
+	// release frame pool first so that its objects are released in order
+	wyObjectRelease(sFramePool);
 
-	for(ITER iter = s_pools->begin(); s_pools && iter != s_pools->end(); ) {
-		ITER cur = iter;
-		iter++;
-		wyObjectRelease(cur->second);
+	// remaining pools, pool removes itself from list when destroyed
+	while(sPools) {
+		wyAutoReleasePool* pool = sPools;
+		WYDELETE(pool);
 	}
 }
 
+void wyAutoReleasePool::popAndRelease() {
+	// pop pools above this one, and this one
+	wyAutoReleasePool* top = (wyAutoReleasePool*)pthread_getspecific(sPoolKey);
+	bool inStack = false;
+	for(wyAutoReleasePool* p = top; p != NULL; p = p->m_parent) {
+		if(p == this) {
+			inStack = true;
+			break;
+		}
+	}
+	if(inStack) {
+		while(top != this) {
+			wyAutoReleasePool* p = top;
+			top = top->m_parent;
+			p->popAndRelease();
+		}
+		pthread_setspecific(sPoolKey, m_parent);
+		m_parent = NULL;
+	}
+
+	// objects must be released in opengl thread
+	if(!isGLThread() && gEventDispatcher)
+		gEventDispatcher->queueEventLocked(ET_DRAIN_AUTO_RELEASE_POOL, this);
+	else
+		wyObjectRelease(this);
+}
+
+void wyAutoReleasePool::onThreadExit(void* top) {
+	// value is cleared by system, restore it so that stack can be popped
+	wyAutoReleasePool* pool = (wyAutoReleasePool*)top;
+	while(pool->m_parent)
+		pool = pool->m_parent;
+	pthread_setspecific(sPoolKey, top);
+	pool->popAndRelease();
+}
+
 void wyAutoReleasePool::drainCurrent() {
-	// if pool map is null, it means the auto release pool is not auto created for this thread
-	if(!s_pools)
+	pthread_once(&sPoolOnce, initPoolKey);
+
+	// if no pool, nothing to drain
+	wyAutoReleasePool* top = (wyAutoReleasePool*)pthread_getspecific(sPoolKey);
+	if(top == NULL || top->m_count == 0)
 		return;
 
-	// get current thread id
-	ssize_t t = currentThreadId();
+	// move objects to a detached pool so that top pool can still be used
+	wyAutoReleasePool* pool = WYNEW wyAutoReleasePool(false);
+	pool->m_head = top->m_head;
+	pool->m_tail = top->m_tail;
+	pool->m_headIndex = top->m_headIndex;
+	pool->m_count = top->m_count;
+	top->m_head = NULL;
+	top->m_tail = NULL;
+	top->m_headIndex = 0;
+	top->m_count = 0;
 
-	// find pool and drain it
-	ITER iter = s_pools->find(t);
-	if(iter != s_pools->end()) {
-		wyAutoReleasePool* pool = iter->second;
-		pool->drain();
-	}
+	// release in opengl thread
+	if(!isGLThread() && gEventDispatcher)
+		gEventDispatcher->queueEventLocked(ET_DRAIN_AUTO_RELEASE_POOL, pool);
+	else
+		wyObjectRelease(pool);
 }
 
 void wyAutoReleasePool::drain() {
-	if(gEventDispatcher)
-		gEventDispatcher->queueEventLocked(ET_DRAIN_AUTO_RELEASE_POOL, this);
+	popAndRelease();
+}
+
+void wyAutoReleasePool::drainFramePool(bool ignoreBudget) {
+	if(sFramePool == NULL)
+		return;
+
+	if(ignoreBudget || sDrainBudget <= 0)
+		sFramePool->releaseObjects(sFramePool->m_count);
+	else
+		sFramePool->releaseObjects(sDrainBudget);
+}
+
+void wyAutoReleasePool::setDrainBudget(int count) {
+	sDrainBudget = count;
+}
+
+int wyAutoReleasePool::getDrainBudget() {
+	return sDrainBudget;
 }
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: luma(stubma@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "wyLockFreeQueue.h"
+#include "wyAtomic.h"
+#include <stdlib.h>
+
+/*
+ * The queue always has a dummy head node. Producer links new node by swapping tail
+ * first and then setting next pointer of old tail, so there is a short window in which
+ * the chain is broken. Consumer treats it as end of queue and the node will be seen
+ * in next pop.
+ */
+
+wyLockFreeQueue* wyLockFreeQueueNew() {
+	wyLockFreeQueue* q = (wyLockFreeQueue*)calloc(1, sizeof(wyLockFreeQueue));
+	wyLockFreeQueueNode* stub = (wyLockFreeQueueNode*)calloc(1, sizeof(wyLockFreeQueueNode));
+	q->head = stub;
+	q->tail = stub;
+	return q;
+}
+
+void wyLockFreeQueueDestroy(wyLockFreeQueue* q) {
+	if(!q)
+		return;
+
+	wyLockFreeQueueNode* n = q->head;
+	while(n != NULL) {
+		wyLockFreeQueueNode* next = n->next;
+		free(n);
+		n = next;
+	}
+	free(q);
+}
+
+void wyLockFreeQueuePush(wyLockFreeQueue* q, void* value) {
+	wyLockFreeQueueNode* n = (wyLockFreeQueueNode*)malloc(sizeof(wyLockFreeQueueNode));
+	n->next = NULL;
+	n->value = value;
+
+	// count first so that it never goes below zero
+	wyAtomicAdd(&q->count, 1);
+
+	// swap is a full barrier, so node content is visible before it is linked
+	wyLockFreeQueueNode* prev = (wyLockFreeQueueNode*)wyAtomicSwapPointer((void* volatile*)&q->tail, n);
+	prev->next = n;
+}
+
+void* wyLockFreeQueuePop(wyLockFreeQueue* q) {
+	wyLockFreeQueueNode* head = q->head;
+	wyLockFreeQueueNode* next = head->next;
+	if(next == NULL)
+		return NULL;
+
+	// read value after next pointer is seen
+	wyMemoryBarrier();
+	void* value = next->value;
+
+	// next becomes new dummy head
+	q->head = next;
+	free(head);
+	wyAtomicAdd(&q->count, -1);
+	return value;
+}
+
+bool wyLockFreeQueueIsEmpty(wyLockFreeQueue* q) {
+	return q->head->next == NULL;
+}
+
+int wyLockFreeQueueCount(wyLockFreeQueue* q) {
+	return q->count;
+}
@@ -28,7 +28,9 @@
  */
 #include "wyMemory.h"
 #include "wyLog.h"
+#include "wyAtomic.h"
 #include <memory.h>
+#include <pthread.h>
 
 #ifdef WY_CFLAG_MEMORY_TRACKING
 
@@ -270,3 +272,376 @@ void _wyFree(void* ptr, const char* file, int line) {
 #endif
 
 #endif // #if WY_CFLAG_MEMORY_TRACKING
+
+#ifdef WY_CFLAG_SLAB_ALLOCATOR
+
+/*
+ * size classes, block size must be multiple of granularity
+ */
+
+#define SLAB_GRANULARITY 16
+#define SLAB_MAX_BLOCK 1024
+#define SLAB_CLASS_COUNT 20
+
+// size of chunk allocated from system, it is carved into blocks
+#define SLAB_CHUNK_SIZE 65536
+
+// max free blocks a thread cache keeps for one class
+#define SLAB_CACHE_LIMIT 128
+
+// blocks moved between thread cache and global depot in one batch
+#define SLAB_BATCH 32
+
+static const int sSlabClassSizes[SLAB_CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256, 320, 384, 448, 512,
+	640, 768, 896, 1024
+};
+
+/// free block, next pointer is stored in block itself
+typedef struct wySlabBlock {
+	struct wySlabBlock* next;
+} wySlabBlock;
+
+/// global state of a size class
+typedef struct wySlabClass {
+	/// protect all fields below
+	pthread_mutex_t mutex;
+
+	/// free blocks returned by thread caches
+	wySlabBlock* depot;
+
+	/// count of blocks in depot
+	int depotCount;
+
+	/// uncarved part of current chunk
+	char* chunk;
+
+	/// bytes left in current chunk
+	int chunkLeft;
+
+	/// count of chunks allocated
+	int chunkCount;
+
+	/// allocation count of exited threads
+	int retiredAllocCount;
+
+	/// free count of exited threads
+	int retiredFreeCount;
+} wySlabClass;
+
+/// per-thread cache, only owner thread touches free lists
+typedef struct wySlabCache {
+	/// free block list of every class
+	wySlabBlock* free[SLAB_CLASS_COUNT];
+
+	/// count of free blocks of every class
+	int freeCount[SLAB_CLASS_COUNT];
+
+	/// allocation count of every class
+	int allocCount[SLAB_CLASS_COUNT];
+
+	/// free count of every class
+	int releaseCount[SLAB_CLASS_COUNT];
+
+	/// next cache in registry
+	struct wySlabCache* next;
+} wySlabCache;
+
+static wySlabClass sSlabClasses[SLAB_CLASS_COUNT];
+static unsigned char sSlabClassIndex[SLAB_MAX_BLOCK / SLAB_GRANULARITY + 1];
+static pthread_once_t sSlabOnce = PTHREAD_ONCE_INIT;
+static volatile bool sSlabInited = false;
+static pthread_key_t sSlabCacheKey;
+
+// all living thread caches, for statistics
+static wySlabCache* sSlabCaches = NULL;
+static pthread_mutex_t sSlabCacheMutex;
+
+// allocations which are larger than max block
+static volatile int sSlabLargeAllocCount = 0;
+static volatile int sSlabLargeFreeCount = 0;
+
+static void wySlabFlush(wySlabCache* cache, int c, int count) {
+	// detach count blocks from cache
+	wySlabBlock* first = cache->free[c];
+	wySlabBlock* last = first;
+	for(int i = 1; i < count; i++)
+		last = last->next;
+	cache->free[c] = last->next;
+	cache->freeCount[c] -= count;
+
+	// push to depot
+	wySlabClass& sc = sSlabClasses[c];
+	pthread_mutex_lock(&sc.mutex);
+	last->next = sc.depot;
+	sc.depot = first;
+	sc.depotCount += count;
+	pthread_mutex_unlock(&sc.mutex);
+}
+
+static void wySlabCacheDestroy(void* p) {
+	wySlabCache* cache = (wySlabCache*)p;
+
+	// unregister
+	pthread_mutex_lock(&sSlabCacheMutex);
+	wySlabCache** link = &sSlabCaches;
+	while(*link) {
+		if(*link == cache) {
+			*link = cache->next;
+			break;
+		}
+		link = &(*link)->next;
+	}
+	pthread_mutex_unlock(&sSlabCacheMutex);
+
+	// give all blocks back to depot and keep statistics
+	for(int c = 0; c < SLAB_CLASS_COUNT; c++) {
+		if(cache->freeCount[c] > 0)
+			wySlabFlush(cache, c, cache->freeCount[c]);
+
+		wySlabClass& sc = sSlabClasses[c];
+		pthread_mutex_lock(&sc.mutex);
+		sc.retiredAllocCount += cache->allocCount[c];
+		sc.retiredFreeCount += cache->releaseCount[c];
+		pthread_mutex_unlock(&sc.mutex);
+	}
+
+	free(cache);
+}
+
+static void wySlabInit() {
+	// class lookup table, indexed by granules
+	int c = 0;
+	for(int i = 0; i <= SLAB_MAX_BLOCK / SLAB_GRANULARITY; i++) {
+		while(sSlabClassSizes[c] < i * SLAB_GRANULARITY)
+			c++;
+		sSlabClassIndex[i] = c;
+	}
+
+	for(int i = 0; i < SLAB_CLASS_COUNT; i++) {
+		memset(&sSlabClasses[i], 0, sizeof(wySlabClass));
+		pthread_mutex_init(&sSlabClasses[i].mutex, NULL);
+	}
+
+	pthread_mutex_init(&sSlabCacheMutex, NULL);
+	pthread_key_create(&sSlabCacheKey, wySlabCacheDestroy);
+
+	wyMemoryBarrier();
+	sSlabInited = true;
+}
+
+static inline wySlabCache* wySlabGetCache() {
+	// key must be created before it is used
+	if(!sSlabInited)
+		pthread_once(&sSlabOnce, wySlabInit);
+
+	wySlabCache* cache = (wySlabCache*)pthread_getspecific(sSlabCacheKey);
+	if(cache == NULL) {
+		cache = (wySlabCache*)calloc(1, sizeof(wySlabCache));
+		pthread_setspecific(sSlabCacheKey, cache);
+
+		// register
+		pthread_mutex_lock(&sSlabCacheMutex);
+		cache->next = sSlabCaches;
+		sSlabCaches = cache;
+		pthread_mutex_unlock(&sSlabCacheMutex);
+	}
+	return cache;
+}
+
+static void wySlabRefill(wySlabCache* cache, int c) {
+	wySlabClass& sc = sSlabClasses[c];
+	int blockSize = sSlabClassSizes[c];
+	wySlabBlock* head = NULL;
+	int count = 0;
+
+	pthread_mutex_lock(&sc.mutex);
+
+	// take blocks from depot first
+	while(sc.depot != NULL && count < SLAB_BATCH) {
+		wySlabBlock* b = sc.depot;
+		sc.depot = b->next;
+		b->next = head;
+		head = b;
+		count++;
+	}
+	sc.depotCount -= count;
+
+	// carve new blocks if depot is empty
+	while(count < SLAB_BATCH) {
+		if(sc.chunkLeft < blockSize) {
+			sc.chunk = (char*)malloc(SLAB_CHUNK_SIZE);
+			if(sc.chunk == NULL) {
+				sc.chunkLeft = 0;
+				break;
+			}
+			sc.chunkLeft = SLAB_CHUNK_SIZE;
+			sc.chunkCount++;
+		}
+
+		wySlabBlock* b = (wySlabBlock*)sc.chunk;
+		sc.chunk += blockSize;
+		sc.chunkLeft -= blockSize;
+		b->next = head;
+		head = b;
+		count++;
+	}
+
+	pthread_mutex_unlock(&sc.mutex);
+
+	// append to cache
+	if(head != NULL) {
+		wySlabBlock* last = head;
+		while(last->next != NULL)
+			last = last->next;
+		last->next = cache->free[c];
+		cache->free[c] = head;
+		cache->freeCount[c] += count;
+	}
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* wySlabAlloc(size_t size) {
+	// large block
+	if(size > SLAB_MAX_BLOCK) {
+		wyAtomicAdd(&sSlabLargeAllocCount, 1);
+		return malloc(size);
+	}
+
+	wySlabCache* cache = wySlabGetCache();
+	int c = sSlabClassIndex[(size + SLAB_GRANULARITY - 1) / SLAB_GRANULARITY];
+	if(cache->free[c] == NULL) {
+		wySlabRefill(cache, c);
+		if(cache->free[c] == NULL)
+			return NULL;
+	}
+
+	// pop
+	wySlabBlock* b = cache->free[c];
+	cache->free[c] = b->next;
+	cache->freeCount[c]--;
+	cache->allocCount[c]++;
+	return b;
+}
+
+void wySlabFree(void* ptr, size_t size) {
+	if(ptr == NULL)
+		return;
+
+	// large block
+	if(size > SLAB_MAX_BLOCK) {
+		wyAtomicAdd(&sSlabLargeFreeCount, 1);
+		free(ptr);
+		return;
+	}
+
+	// push
+	wySlabCache* cache = wySlabGetCache();
+	int c = sSlabClassIndex[(size + SLAB_GRANULARITY - 1) / SLAB_GRANULARITY];
+	wySlabBlock* b = (wySlabBlock*)ptr;
+	b->next = cache->free[c];
+	cache->free[c] = b;
+	cache->freeCount[c]++;
+	cache->releaseCount[c]++;
+
+	// if cache is too large, give some back to depot so that other thread can use them
+	if(cache->freeCount[c] > SLAB_CACHE_LIMIT)
+		wySlabFlush(cache, c, SLAB_BATCH);
+}
+
+int wySlabGetClassCount() {
+	return SLAB_CLASS_COUNT;
+}
+
+bool wySlabGetStats(int index, wySlabStats* stats) {
+	if(index < 0 || index >= SLAB_CLASS_COUNT || stats == NULL)
+		return false;
+
+	pthread_once(&sSlabOnce, wySlabInit);
+	memset(stats, 0, sizeof(wySlabStats));
+	stats->blockSize = sSlabClassSizes[index];
+
+	// global part
+	wySlabClass& sc = sSlabClasses[index];
+	pthread_mutex_lock(&sc.mutex);
+	stats->cachedBlocks = sc.depotCount;
+	stats->chunkCount = sc.chunkCount;
+	stats->allocCount = sc.retiredAllocCount;
+	stats->freeCount = sc.retiredFreeCount;
+	int carved = sc.chunkCount * (SLAB_CHUNK_SIZE / stats->blockSize) - sc.chunkLeft / stats->blockSize;
+	pthread_mutex_unlock(&sc.mutex);
+
+	// thread caches
+	pthread_mutex_lock(&sSlabCacheMutex);
+	for(wySlabCache* cache = sSlabCaches; cache != NULL; cache = cache->next) {
+		stats->cachedBlocks += cache->freeCount[index];
+		stats->allocCount += cache->allocCount[index];
+		stats->freeCount += cache->releaseCount[index];
+	}
+	pthread_mutex_unlock(&sSlabCacheMutex);
+
+	stats->liveBlocks = carved - stats->cachedBlocks;
+	return true;
+}
+
+void wySlabUsageReport() {
+	wySlabStats stats;
+	for(int i = 0; i < SLAB_CLASS_COUNT; i++) {
+		wySlabGetStats(i, &stats);
+		if(stats.allocCount > 0) {
+			LOGD("[SLABREPORT] %4d bytes: live %d, cached %d, chunks %d, alloc %d times, free %d times",
+					stats.blockSize, stats.liveBlocks, stats.cachedBlocks, stats.chunkCount, stats.allocCount, stats.freeCount);
+		}
+	}
+	LOGD("[SLABREPORT] large blocks: alloc %d times, free %d times", sSlabLargeAllocCount, sSlabLargeFreeCount);
+}
+
+#ifdef WY_CFLAG_MEMORY_TRACKING
+
+void* _wySlabAlloc(size_t size, const char* file, int line) {
+	void* p = wySlabAlloc(size);
+	if(p) {
+		// record it so that leak report still works
+		wyMemoryRecord* r = (wyMemoryRecord*)malloc(sizeof(wyMemoryRecord));
+		if(r) {
+			r->start = p;
+			r->size = size;
+			r->file = file;
+			r->line = line;
+			r->next = NULL;
+			addRecord(r);
+		}
+
+#if LOG_ALLOC
+		LOGD("[SLAB](%x):%d [%s:%d]", p, size, file, line);
+#endif
+	}
+
+	return p;
+}
+
+void _wySlabFree(void* ptr, size_t size) {
+	if(!ptr)
+		return;
+
+	// find record and remove it
+	wyMemoryRecord* r = findRecord(ptr);
+	if(r) {
+		removeRecord(r);
+		free(r);
+	}
+
+	wySlabFree(ptr, size);
+}
+
+#endif // #ifdef WY_CFLAG_MEMORY_TRACKING
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // #ifdef WY_CFLAG_SLAB_ALLOCATOR
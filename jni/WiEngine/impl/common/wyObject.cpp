@@ -49,7 +49,6 @@ extern pthread_mutex_t gMutex;
 #endif
 
 // release pools
-static wyArray* sAutoReleasePool = NULL;
 static wyArray* sLazyReleasePool = NULL;
 
 // only needed when memory tracking is enabled
@@ -93,6 +92,33 @@ wyObject::~wyObject() {
         wyFree((void*)m_name);
 }
 
+#ifdef WY_CFLAG_SLAB_ALLOCATOR
+
+void* wyObject::operator new(size_t size) {
+	return wySlabAlloc(size);
+}
+
+void wyObject::operator delete(void* p, size_t size) {
+#ifdef WY_CFLAG_MEMORY_TRACKING
+	_wySlabFree(p, size);
+#else
+	wySlabFree(p, size);
+#endif
+}
+
+#ifdef WY_CFLAG_MEMORY_TRACKING
+
+void* wyObject::operator new(size_t size, const char* file, int line) {
+	return _wySlabAlloc(size, file, line);
+}
+
+void wyObject::operator delete(void* p, const char* file, int line) {
+}
+
+#endif // #ifdef WY_CFLAG_MEMORY_TRACKING
+
+#endif // #ifdef WY_CFLAG_SLAB_ALLOCATOR
+
 const char* wyObject::getClassName() {
 	char* name = (char*)typeid(*this).name();
 	while('0' <= *name && *name <= '9')
@@ -145,12 +171,7 @@ wyObject* wyObject::lazyRelease() {
 }
 
 wyObject* wyObject::autoRelease() {
-	if(isGLThread()) {
-		if(sAutoReleasePool != NULL)
-			wyArrayPush(sAutoReleasePool, this);
-	} else {
-		wyAutoReleasePool::addToPool(this);
-	}
+	wyAutoReleasePool::addToPool(this);
 	return this;
 }
 
@@ -238,9 +259,6 @@ static bool outputLeak(wyArray* arr, void* ptr, int index, void* data) {
 #endif
 
 void wyInitAutoReleasePool() {
-	if(sAutoReleasePool == NULL) {
-		sAutoReleasePool = wyArrayNew(100);
-	}
 	if(sLazyReleasePool == NULL) {
 		sLazyReleasePool = wyArrayNew(100);
 	}
@@ -262,21 +280,13 @@ void wyClearLazyReleasePool() {
 }
 
 void wyClearAutoReleasePool() {
-	if(sAutoReleasePool != NULL && sAutoReleasePool->num > 0) {
-		// clear pool
-		wyArrayEach(sAutoReleasePool, releaseObject, NULL);
-		wyArrayClear(sAutoReleasePool);
-	}
+	// release objects autoreleased in last frame, limited by drain budget
+	wyAutoReleasePool::drainFramePool();
 }
 
 void wyDestroyAutoReleasePool() {
-	if(sAutoReleasePool != NULL) {
-		// clear auto release pool
-		wyArrayEach(sAutoReleasePool, releaseObject, NULL);
-		wyArrayClear(sAutoReleasePool);
-		wyArrayDestroy(sAutoReleasePool);
-		sAutoReleasePool = NULL;
-	}
+	// clear auto release pool
+	wyAutoReleasePool::drainFramePool(true);
 	wyClearLazyReleasePool();
 }
 
@@ -29,6 +29,11 @@
 #include "wyThread.h"
 #include <pthread.h>
 #include "wyAutoReleasePool.h"
+#if WINDOWS
+	#include <windows.h>
+#else
+	#include <unistd.h>
+#endif
 
 wyThread::wyThread() {
 }
@@ -36,6 +41,14 @@ wyThread::wyThread() {
 wyThread::~wyThread() {
 }
 
+void wyThread::sleep(int ms) {
+#if WINDOWS
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
 int wyThread::runThread(wyTargetSelector* sel) {
 	if(sel) {
 		sel->retain();
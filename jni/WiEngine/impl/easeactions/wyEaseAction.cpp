@@ -50,6 +50,19 @@ void wyEaseAction::stop() {
 	wyIntervalAction::stop();
 }
 
+bool wyEaseAction::packWrapped(wyTween* tween, wyTweenEaseFunc ease, float rate) {
+	if(hasCallback() || m_wrapped == NULL)
+		return false;
+
+	// nested ease action is not packed
+	if(!m_wrapped->packTween(tween) || tween->ease != NULL)
+		return false;
+
+	tween->ease = ease;
+	tween->rate = rate;
+	return true;
+}
+
 void wyEaseAction::setWrappedAction(wyIntervalAction* wrapped) {
 	if(m_running) {
 		LOGW("setWrappedAction: Ease action is already running");
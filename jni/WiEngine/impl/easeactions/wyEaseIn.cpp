@@ -30,6 +30,10 @@
 #include "wyNode.h"
 #include <math.h>
 
+static float easeIn(float t, float rate) {
+	return pow(t, rate);
+}
+
 wyEaseIn* wyEaseIn::make(float rate, wyIntervalAction* wrapped) {
 	wyEaseIn* e = WYNEW wyEaseIn(rate, wrapped);
 	return (wyEaseIn*)e->autoRelease();
@@ -54,6 +58,10 @@ void wyEaseIn::update(float t) {
 	wyEaseRateAction::update(t);
 }
 
+bool wyEaseIn::packTween(wyTween* tween) {
+	return packWrapped(tween, easeIn, m_rate);
+}
+
 wyEaseIn::wyEaseIn(float rate, wyIntervalAction* wrapped) : wyEaseRateAction(rate, wrapped) {
 }
 
@@ -30,6 +30,10 @@
 #include "wyNode.h"
 #include <math.h>
 
+static float easeOut(float t, float rate) {
+	return pow(t, 1.f / rate);
+}
+
 wyEaseOut* wyEaseOut::make(float rate, wyIntervalAction* wrapped) {
 	wyEaseOut* e = WYNEW wyEaseOut(rate, wrapped);
 	return (wyEaseOut*)e->autoRelease();
@@ -54,6 +58,10 @@ void wyEaseOut::update(float t) {
 	wyEaseRateAction::update(t);
 }
 
+bool wyEaseOut::packTween(wyTween* tween) {
+	return packWrapped(tween, easeOut, m_rate);
+}
+
 wyEaseOut::wyEaseOut(float rate, wyIntervalAction* wrapped) : wyEaseRateAction(rate, wrapped) {
 }
 
@@ -31,6 +31,10 @@
 #include "wyNode.h"
 #include <math.h>
 
+static float easeSineIn(float t, float rate) {
+	return -1 * wyMath::cos(t * M_PI / 2) + 1;
+}
+
 wyEaseSineIn* wyEaseSineIn::make(wyIntervalAction* wrapped) {
 	wyEaseSineIn* e = WYNEW wyEaseSineIn(wrapped);
 	return (wyEaseSineIn*)e->autoRelease();
@@ -55,6 +59,10 @@ void wyEaseSineIn::update(float t) {
 	wyEaseAction::update(t);
 }
 
+bool wyEaseSineIn::packTween(wyTween* tween) {
+	return packWrapped(tween, easeSineIn, 0);
+}
+
 wyEaseSineIn::wyEaseSineIn(wyIntervalAction* wrapped) : wyEaseAction(wrapped) {
 }
 
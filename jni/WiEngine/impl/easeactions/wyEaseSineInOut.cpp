@@ -30,6 +30,10 @@
 #include "wyNode.h"
 #include <math.h>
 
+static float easeSineInOut(float t, float rate) {
+	return -0.5f * (wyMath::cos(M_PI * t) - 1);
+}
+
 wyEaseSineInOut* wyEaseSineInOut::make(wyIntervalAction* wrapped) {
 	wyEaseSineInOut* e = WYNEW wyEaseSineInOut(wrapped);
 	return (wyEaseSineInOut*)e->autoRelease();
@@ -54,6 +58,10 @@ void wyEaseSineInOut::update(float t) {
 	wyEaseAction::update(t);
 }
 
+bool wyEaseSineInOut::packTween(wyTween* tween) {
+	return packWrapped(tween, easeSineInOut, 0);
+}
+
 wyEaseSineInOut::wyEaseSineInOut(wyIntervalAction* wrapped) : wyEaseAction(wrapped) {
 }
 
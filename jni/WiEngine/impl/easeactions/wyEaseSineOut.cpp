@@ -31,6 +31,10 @@
 #include "wyNode.h"
 #include <math.h>
 
+static float easeSineOut(float t, float rate) {
+	return wyMath::sin(t * M_PI / 2);
+}
+
 wyEaseSineOut* wyEaseSineOut::make(wyIntervalAction* wrapped) {
 	wyEaseSineOut* e = WYNEW wyEaseSineOut(wrapped);
 	return (wyEaseSineOut*)e->autoRelease();
@@ -55,6 +59,10 @@ void wyEaseSineOut::update(float t) {
 	wyEaseAction::update(t);
 }
 
+bool wyEaseSineOut::packTween(wyTween* tween) {
+	return packWrapped(tween, easeSineOut, 0);
+}
+
 wyEaseSineOut::wyEaseSineOut(wyIntervalAction* wrapped) : wyEaseAction(wrapped) {
 }
 
@@ -35,9 +35,35 @@
 #include "wyGLTexture2D.h"
 
 // mutex
-extern pthread_mutex_t gMutex;
 extern pthread_mutex_t gCondMutex;
 
+// max events kept in pool
+#define MAX_POOLED_EVENTS 128
+
+// operation of handler command
+enum {
+	HC_ADD,
+	HC_REMOVE,
+	HC_REMOVE_ALL
+};
+
+// kind of handler
+enum {
+	HK_ACCEL,
+	HK_KEY,
+	HK_TOUCH,
+	HK_DOUBLE_TAP,
+	HK_GESTURE
+};
+
+// a handler change queued by any thread, it is applied in OpenGL thread
+typedef struct wyHandlerCommand {
+	int op;
+	int kind;
+	int priority;
+	wyNode* node;
+} wyHandlerCommand;
+
 void wyEventDispatcher::releaseEvents(EventPtrList& list) {
 	for(EventPtrList::iterator iter = list.begin(); iter != list.end(); iter++) {
 		recycleEvent(*iter);
@@ -54,15 +80,6 @@ int wyEventDispatcher::findHandler(HandlerList& list, wyNode* node) {
 	return -1;
 }
 
-int wyEventDispatcher::findNode(NodePtrList& list, wyNode* node) {
-	for(NodePtrList::iterator iter = list.begin(); iter != list.end(); iter++) {
-		if(*iter == node)
-			return iter - list.begin();
-	}
-
-	return -1;
-}
-
 void wyEventDispatcher::processEvent(wyEvent* e) {
 	switch(e->type) {
 		case ET_ACCELEROMETER:
@@ -155,80 +172,139 @@ void wyEventDispatcher::processEvent(wyEvent* e) {
 }
 
 wyEventDispatcher::wyEventDispatcher() :
-		m_dispatchEvents(true) {
+		m_dispatchEvents(true),
+		m_pendingHandlerCommands(wyLockFreeQueueNew()),
+		m_accelHandlerCount(0),
+		m_pendingAddEvents(wyLockFreeQueueNew()) {
 }
 
 wyEventDispatcher::~wyEventDispatcher() {
-	removeAllHandlersLocked();
+	void* c = NULL;
+	while((c = wyLockFreeQueuePop(m_pendingHandlerCommands)) != NULL) {
+		wyFree(c);
+	}
+	wyLockFreeQueueDestroy(m_pendingHandlerCommands);
 	releaseEvents(m_eventQueue);
-	releaseEvents(m_pendingAddEvents);
 	releaseEvents(m_eventPool);
-}
+	wyEvent* e = NULL;
+	while((e = (wyEvent*)wyLockFreeQueuePop(m_pendingAddEvents)) != NULL) {
+		recycleEvent(e);
+		wyFree(e);
+	}
+	wyLockFreeQueueDestroy(m_pendingAddEvents);
+}
+
+void wyEventDispatcher::pushHandlerCommand(int op, int kind, wyNode* node, int priority) {
+	wyHandlerCommand* c = (wyHandlerCommand*)wyMalloc(sizeof(wyHandlerCommand));
+	c->op = op;
+	c->kind = kind;
+	c->priority = priority;
+	c->node = node;
+	wyLockFreeQueuePush(m_pendingHandlerCommands, c);
+}
+
+void wyEventDispatcher::applyPendingHandlers() {
+	/*
+	 * take commands which are queued before now, so it never waits for other threads.
+	 * Commands are applied in order, so a removal is never skipped and a node removed
+	 * before it is released doesn't get events from next frame
+	 */
+	bool accelChanged = false;
+	bool gestureChanged = false;
+	int count = wyLockFreeQueueCount(m_pendingHandlerCommands);
+	for(int i = 0; i < count; i++) {
+		wyHandlerCommand* c = (wyHandlerCommand*)wyLockFreeQueuePop(m_pendingHandlerCommands);
+		if(c == NULL)
+			break;
+
+		if(c->op == HC_REMOVE_ALL) {
+			m_accelHandlers.clear();
+			m_keyHandlers.clear();
+			m_touchHandlers.clear();
+			m_doubleTapHandlers.clear();
+			m_gestureHandlers.clear();
+			accelChanged = true;
+			gestureChanged = true;
+		} else {
+			HandlerList* list = NULL;
+			switch(c->kind) {
+				case HK_ACCEL:
+					list = &m_accelHandlers;
+					accelChanged = true;
+					break;
+				case HK_KEY:
+					list = &m_keyHandlers;
+					break;
+				case HK_TOUCH:
+					list = &m_touchHandlers;
+					break;
+				case HK_DOUBLE_TAP:
+					list = &m_doubleTapHandlers;
+					gestureChanged = true;
+					break;
+				case HK_GESTURE:
+					list = &m_gestureHandlers;
+					gestureChanged = true;
+					break;
+			}
 
-void wyEventDispatcher::processEventsLocked() {
-	pthread_mutex_lock(&gMutex);
+			int index = findHandler(*list, c->node);
+			if(c->op == HC_REMOVE) {
+				if(index != -1)
+					list->erase(list->begin() + index);
+			} else if(index == -1) {
+				PriorityHandler h;
+				h.priority = c->priority;
+				h.node = c->node;
+				switch(c->kind) {
+					case HK_ACCEL:
+						addAccelHandler(h);
+						break;
+					case HK_KEY:
+						addKeyHandler(h);
+						break;
+					case HK_TOUCH:
+						addTouchHandler(h);
+						break;
+					case HK_DOUBLE_TAP:
+						addDoubleTapHandler(h);
+						break;
+					case HK_GESTURE:
+						addGestureHandler(h);
+						break;
+				}
+			}
+		}
 
-	// add pending events to queue
-	for(EventPtrList::iterator iter = m_pendingAddEvents.begin(); iter != m_pendingAddEvents.end(); iter++) {
-		m_eventQueue.push_back(*iter);
-	}
-	m_pendingAddEvents.clear();
+		wyFree(c);
+	}
 
-	// remove pending handlers from queue
-	for(NodePtrList::iterator iter = m_pendingRemoveAccelHandlerNodes.begin(); iter != m_pendingRemoveAccelHandlerNodes.end(); iter++) {
-		int index = findHandler(m_accelHandlers, *iter);
-		if(index != -1)
-			m_accelHandlers.erase(m_accelHandlers.begin() + index);
-	}
-	for(NodePtrList::iterator iter = m_pendingRemoveTouchHandlerNodes.begin(); iter != m_pendingRemoveTouchHandlerNodes.end(); iter++) {
-		int index = findHandler(m_touchHandlers, *iter);
-		if(index != -1)
-			m_touchHandlers.erase(m_touchHandlers.begin() + index);
-	}
-	for(NodePtrList::iterator iter = m_pendingRemoveKeyHandlerNodes.begin(); iter != m_pendingRemoveKeyHandlerNodes.end(); iter++) {
-		int index = findHandler(m_keyHandlers, *iter);
-		if(index != -1)
-			m_keyHandlers.erase(m_keyHandlers.begin() + index);
-	}
-	for(NodePtrList::iterator iter = m_pendingRemoveDoubleTapHandlerNodes.begin(); iter != m_pendingRemoveDoubleTapHandlerNodes.end(); iter++) {
-		int index = findHandler(m_doubleTapHandlers, *iter);
-		if(index != -1)
-			m_doubleTapHandlers.erase(m_doubleTapHandlers.begin() + index);
-	}
-	for(NodePtrList::iterator iter = m_pendingRemoveGestureHandlerNodes.begin(); iter != m_pendingRemoveGestureHandlerNodes.end(); iter++) {
-		int index = findHandler(m_gestureHandlers, *iter);
-		if(index != -1)
-			m_gestureHandlers.erase(m_gestureHandlers.begin() + index);
-	}
-	m_pendingRemoveAccelHandlerNodes.clear();
-	m_pendingRemoveTouchHandlerNodes.clear();
-	m_pendingRemoveKeyHandlerNodes.clear();
-	m_pendingRemoveDoubleTapHandlerNodes.clear();
-	m_pendingRemoveGestureHandlerNodes.clear();
-
-	// add pending handlers to queue
-	for(HandlerList::iterator iter = m_pendingAddAccelHandlers.begin(); iter != m_pendingAddAccelHandlers.end(); iter++) {
-		addAccelHandler(*iter);
-	}
-	for(HandlerList::iterator iter = m_pendingAddTouchHandlers.begin(); iter != m_pendingAddTouchHandlers.end(); iter++) {
-		addTouchHandler(*iter);
-	}
-	for(HandlerList::iterator iter = m_pendingAddKeyHandlers.begin(); iter != m_pendingAddKeyHandlers.end(); iter++) {
-		addKeyHandler(*iter);
-	}
-	for(HandlerList::iterator iter = m_pendingAddDoubleTapHandlers.begin(); iter != m_pendingAddDoubleTapHandlers.end(); iter++) {
-		addDoubleTapHandler(*iter);
-	}
-	for(HandlerList::iterator iter = m_pendingAddGestureHandlers.begin(); iter != m_pendingAddGestureHandlers.end(); iter++) {
-		addGestureHandler(*iter);
+	// update platform listeners, they read handler lists in this thread
+	if(accelChanged) {
+		m_accelHandlerCount = m_accelHandlers.size();
+		checkAccelHandlers();
+	}
+	if(gestureChanged) {
+		checkDoubleTapHandlers();
+		checkGestureHandlers();
+	}
+}
+
+void wyEventDispatcher::processEventsLocked() {
+	/*
+	 * take events which are queued before now, events queued while processing
+	 * will be processed in next frame
+	 */
+	int count = wyLockFreeQueueCount(m_pendingAddEvents);
+	for(int i = 0; i < count; i++) {
+		wyEvent* e = (wyEvent*)wyLockFreeQueuePop(m_pendingAddEvents);
+		if(e == NULL)
+			break;
+		m_eventQueue.push_back(e);
 	}
-	m_pendingAddAccelHandlers.clear();
-	m_pendingAddTouchHandlers.clear();
-	m_pendingAddKeyHandlers.clear();
-	m_pendingAddDoubleTapHandlers.clear();
-	m_pendingAddGestureHandlers.clear();
 
-	pthread_mutex_unlock(&gMutex);
+	// apply handler changes
+	applyPendingHandlers();
 
 	// process events in queue
 	for(EventPtrList::iterator iter = m_eventQueue.begin(); iter != m_eventQueue.end(); iter++) {
@@ -238,8 +314,9 @@ void wyEventDispatcher::processEventsLocked() {
 }
 
 wyEvent* wyEventDispatcher::popEvent() {
+	// pool is not thread safe, so other thread always allocates new one
 	wyEvent* e = NULL;
-	if(m_eventPool.empty()) {
+	if(m_eventPool.empty() || !isGLThread()) {
 		e = (wyEvent*)wyCalloc(1, sizeof(wyEvent));
 	} else {
 		EventPtrList::reverse_iterator iter = m_eventPool.rbegin();
@@ -253,11 +330,18 @@ wyEvent* wyEventDispatcher::popEvent() {
 
 void wyEventDispatcher::poolEvent(wyEvent* e) {
 	recycleEvent(e);
-	m_eventPool.push_back(e);
+	if(m_eventPool.size() < MAX_POOLED_EVENTS)
+		m_eventPool.push_back(e);
+	else
+		wyFree(e);
+}
+
+void wyEventDispatcher::pushEvent(wyEvent* e) {
+	wyLockFreeQueuePush(m_pendingAddEvents, e);
 }
 
 bool wyEventDispatcher::hasAccelHandlers() {
-	return !m_accelHandlers.empty() || !m_pendingAddAccelHandlers.empty();
+	return m_accelHandlerCount > 0;
 }
 
 void wyEventDispatcher::setDispatchEvent(bool flag) {
@@ -269,80 +353,54 @@ bool wyEventDispatcher::getDispatchEvent() {
 }
 
 void wyEventDispatcher::queueKeyEventLocked(wyEventType type, wyPlatformKeyEvent pe) {
-	pthread_mutex_lock(&gMutex);
-
 	// convert key event
 	wyEvent* e = buildKeyEvent(type, pe);
 
 	// push to pending list
 	if(e) {
-		m_pendingAddEvents.push_back(e);
+		pushEvent(e);
 	}
-
-	pthread_mutex_unlock(&gMutex);
 }
 
 void wyEventDispatcher::queueEventLocked(wyEventType type, wyPlatformMotionEvent pe) {
-	pthread_mutex_lock(&gMutex);
-	
 	// push event to queue
 	queueMotionEvent(type, pe);
-	
-	pthread_mutex_unlock(&gMutex);
 }
 
 void wyEventDispatcher::queueEventLocked(wyEventType type, wyPlatformMotionEvent pe1, wyPlatformMotionEvent pe2, float vx, float vy) {
-	pthread_mutex_lock(&gMutex);
 	queueMotionEvent(type, pe1, pe2, vx, vy);
-	pthread_mutex_unlock(&gMutex);
 }
 
 void wyEventDispatcher::queueEventLocked(wyEventType type, wyGLTexture2D* tex, pthread_cond_t* cond) {
-	pthread_mutex_lock(&gMutex);
-
 	wyEvent* e = popEvent();
 	e->type = type;
 	e->lte.tex = tex;
 	e->lte.cond = cond;
-	m_pendingAddEvents.push_back(e);
-
-	pthread_mutex_unlock(&gMutex);
+	pushEvent(e);
 }
 
 void wyEventDispatcher::queueEventLocked(wyEventType type, wyObject* obj) {
-	pthread_mutex_lock(&gMutex);
-
 	wyEvent* e = popEvent();
 	e->type = type;
 	e->oe.obj = obj;
-	m_pendingAddEvents.push_back(e);
-
-	pthread_mutex_unlock(&gMutex);
+	pushEvent(e);
 }
 
 void wyEventDispatcher::queueEventLocked(float accelX, float accelY, float accelZ) {
-	pthread_mutex_lock(&gMutex);
-
 	wyEvent* e = popEvent();
 	e->type = ET_ACCELEROMETER;
 	e->ae.accelX = accelX;
 	e->ae.accelY = accelY;
 	e->ae.accelZ = accelZ;
-	m_pendingAddEvents.push_back(e);
-
-	pthread_mutex_unlock(&gMutex);
+	pushEvent(e);
 }
 
 void wyEventDispatcher::queueRunnableLocked(wyRunnable* runnable) {
-	pthread_mutex_lock(&gMutex);
-
 	wyEvent* e = popEvent();
 	e->type = ET_RUNNABLE;
 	e->r.runnable = runnable;
 	wyObjectRetain(runnable);
-	m_pendingAddEvents.push_back(e);
-
-	pthread_mutex_unlock(&gMutex);
+	pushEvent(e);
 }
 
 void wyEventDispatcher::addKeyHandler(PriorityHandler& h) {
@@ -356,16 +414,7 @@ void wyEventDispatcher::addKeyHandler(PriorityHandler& h) {
 }
 
 void wyEventDispatcher::addKeyHandlerLocked(wyNode* node, int priority) {
-	pthread_mutex_lock(&gMutex);
-
-	if(findHandler(m_pendingAddKeyHandlers, node) == -1) {
-    	PriorityHandler h;
-    	h.priority = priority;
-    	h.node = node;
-    	m_pendingAddKeyHandlers.push_back(h);
-    }
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_ADD, HK_KEY, node, priority);
 }
 
 void wyEventDispatcher::addAccelHandler(PriorityHandler& h) {
@@ -379,19 +428,7 @@ void wyEventDispatcher::addAccelHandler(PriorityHandler& h) {
 }
 
 void wyEventDispatcher::addAccelHandlerLocked(wyNode* node, int priority) {
-	pthread_mutex_lock(&gMutex);
-
-	if(findHandler(m_pendingAddAccelHandlers, node) == -1) {
-    	PriorityHandler h;
-    	h.priority = priority;
-    	h.node = node;
-    	m_pendingAddAccelHandlers.push_back(h);
-
-    	// check accelerometer listener
-    	checkAccelHandlers();
-    }
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_ADD, HK_ACCEL, node, priority);
 }
 
 void wyEventDispatcher::addTouchHandler(PriorityHandler& h) {
@@ -405,16 +442,7 @@ void wyEventDispatcher::addTouchHandler(PriorityHandler& h) {
 }
 
 void wyEventDispatcher::addTouchHandlerLocked(wyNode* node, int priority) {
-	pthread_mutex_lock(&gMutex);
-
-	if(findHandler(m_pendingAddTouchHandlers, node) == -1) {
-    	PriorityHandler h;
-    	h.priority = priority;
-    	h.node = node;
-    	m_pendingAddTouchHandlers.push_back(h);
-    }
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_ADD, HK_TOUCH, node, priority);
 }
 
 void wyEventDispatcher::addDoubleTapHandler(PriorityHandler& h) {
@@ -428,18 +456,7 @@ void wyEventDispatcher::addDoubleTapHandler(PriorityHandler& h) {
 }
 
 void wyEventDispatcher::addDoubleTapHandlerLocked(wyNode* node, int priority) {
-	pthread_mutex_lock(&gMutex);
-
-	if(findHandler(m_pendingAddDoubleTapHandlers, node) == -1) {
-    	PriorityHandler h;
-    	h.priority = priority;
-    	h.node = node;
-    	m_pendingAddDoubleTapHandlers.push_back(h);
-
-    	checkDoubleTapHandlers();
-    }
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_ADD, HK_DOUBLE_TAP, node, priority);
 }
 
 void wyEventDispatcher::addGestureHandler(PriorityHandler& h) {
@@ -453,123 +470,31 @@ void wyEventDispatcher::addGestureHandler(PriorityHandler& h) {
 }
 
 void wyEventDispatcher::addGestureHandlerLocked(wyNode* node, int priority) {
-	pthread_mutex_lock(&gMutex);
-
-	if(findHandler(m_pendingAddGestureHandlers, node) == -1) {
-    	PriorityHandler h;
-    	h.priority = priority;
-    	h.node = node;
-    	m_pendingAddGestureHandlers.push_back(h);
-
-    	checkGestureHandlers();
-    }
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_ADD, HK_GESTURE, node, priority);
 }
 
 void wyEventDispatcher::removeAllHandlersLocked() {
-	pthread_mutex_lock(&gMutex);
-
-	// clear all handlers
-	m_accelHandlers.clear();
-	m_keyHandlers.clear();
-	m_touchHandlers.clear();
-	m_doubleTapHandlers.clear();
-	m_gestureHandlers.clear();
-	m_pendingAddAccelHandlers.clear();
-	m_pendingAddTouchHandlers.clear();
-	m_pendingAddKeyHandlers.clear();
-	m_pendingAddDoubleTapHandlers.clear();
-	m_pendingAddGestureHandlers.clear();
-
-	// check accelerometer listener
-	checkAccelHandlers();
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_REMOVE_ALL, 0, NULL, 0);
 }
 
 void wyEventDispatcher::removeKeyHandlerLocked(wyNode* node) {
-	pthread_mutex_lock(&gMutex);
-
-	int index = findHandler(m_pendingAddKeyHandlers, node);
-	if(index != -1) {
-		m_pendingAddKeyHandlers.erase(m_pendingAddKeyHandlers.begin() + index);
-	} else {
-		index = findNode(m_pendingRemoveKeyHandlerNodes, node);
-		if(index == -1)
-			m_pendingRemoveKeyHandlerNodes.push_back(node);
-	}
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_REMOVE, HK_KEY, node, 0);
 }
 
 void wyEventDispatcher::removeAccelHandlerLocked(wyNode* node) {
-	pthread_mutex_lock(&gMutex);
-
-	int index = findHandler(m_pendingAddAccelHandlers, node);
-	if(index != -1) {
-		m_pendingAddAccelHandlers.erase(m_pendingAddAccelHandlers.begin() + index);
-
-		// check accelerometer listener
-		checkAccelHandlers();
-	} else {
-		index = findNode(m_pendingRemoveAccelHandlerNodes, node);
-		if(index == -1)
-			m_pendingRemoveAccelHandlerNodes.push_back(node);
-	}
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_REMOVE, HK_ACCEL, node, 0);
 }
 
 void wyEventDispatcher::removeTouchHandlerLocked(wyNode* node) {
-	pthread_mutex_lock(&gMutex);
-
-	int index = findHandler(m_pendingAddTouchHandlers, node);
-	if(index != -1) {
-		m_pendingAddTouchHandlers.erase(m_pendingAddTouchHandlers.begin() + index);
-	} else {
-		index = findNode(m_pendingRemoveTouchHandlerNodes, node);
-		if(index == -1)
-			m_pendingRemoveTouchHandlerNodes.push_back(node);
-	}
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_REMOVE, HK_TOUCH, node, 0);
 }
 
 void wyEventDispatcher::removeDoubleTapHandlerLocked(wyNode* node) {
-	pthread_mutex_lock(&gMutex);
-
-	int index = findHandler(m_pendingAddDoubleTapHandlers, node);
-	if(index != -1) {
-		m_pendingAddDoubleTapHandlers.erase(m_pendingAddDoubleTapHandlers.begin() + index);
-
-		// becuase pending add list changed, need re-check
-		checkDoubleTapHandlers();
-	} else {
-		index = findNode(m_pendingRemoveDoubleTapHandlerNodes, node);
-		if(index == -1)
-			m_pendingRemoveDoubleTapHandlerNodes.push_back(node);
-	}
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_REMOVE, HK_DOUBLE_TAP, node, 0);
 }
 
 void wyEventDispatcher::removeGestureHandlerLocked(wyNode* node) {
-	pthread_mutex_lock(&gMutex);
-
-	int index = findHandler(m_pendingAddGestureHandlers, node);
-	if(index != -1) {
-		m_pendingAddGestureHandlers.erase(m_pendingAddGestureHandlers.begin() + index);
-
-		// becuase pending add list changed, need re-check
-		checkGestureHandlers();
-	} else {
-		index = findNode(m_pendingRemoveGestureHandlerNodes, node);
-		if(index == -1)
-			m_pendingRemoveGestureHandlerNodes.push_back(node);
-	}
-
-	pthread_mutex_unlock(&gMutex);
+	pushHandlerCommand(HC_REMOVE, HK_GESTURE, node, 0);
 }
 
 void wyEventDispatcher::setKeyHandlerPriorityLocked(wyNode* node, int priority) {
@@ -28,173 +28,356 @@
  */
 #include "wyBlurColorFilter.h"
 #include "wyMath.h"
+#include <stdint.h>
+#include <string.h>
 
-wyBlurColorFilter::wyBlurColorFilter(int radius) :
-		m_radius(radius) {
+#if WY_FILTER_NEON
+	#include <arm_neon.h>
+#elif WY_FILTER_SSE2
+	#include <emmintrin.h>
+#endif
+
+// rows of a band, a vertical band sums 2 * radius rows before its first row
+#define MIN_BAND_ROWS 32
+
+// float division of a window sum stays exact below this window size, see storeAverage
+#define MAX_SIMD_WINDOW 16384
+
+// shared by band kernels
+struct BlurJob {
+	// image, holds result when vertical pass is done
+	unsigned char* data;
+
+	// rows blurred horizontally, alpha channel is not used
+	unsigned char* blurred;
+
+	int width;
+	int height;
+	int radius;
+
+	// reciprocals[n] is 1 / n, only for SIMD kernels
+	float* reciprocals;
+};
+
+#if WY_FILTER_NEON || WY_FILTER_SSE2
+
+/*
+ * A pixel is loaded to four 32 bit lanes, so sums of four channels are
+ * updated together. Averages are computed as (sum + 0.5) * (1 / n) in float,
+ * the bias keeps result same as integer division as long as n is less than
+ * MAX_SIMD_WINDOW, because error of float product is less than 0.5 / n then.
+ */
+
+#if WY_FILTER_NEON
+
+typedef uint32x4_t PixelSum;
+
+static inline PixelSum zeroSum() {
+	return vdupq_n_u32(0);
 }
 
-wyBlurColorFilter::~wyBlurColorFilter() {
+static inline PixelSum addSum(PixelSum a, PixelSum b) {
+	return vaddq_u32(a, b);
 }
 
-wyBlurColorFilter* wyBlurColorFilter::make(int radius) {
-	wyBlurColorFilter* f = WYNEW wyBlurColorFilter(radius);
-	return (wyBlurColorFilter*)f->autoRelease();
+static inline PixelSum subSum(PixelSum a, PixelSum b) {
+	return vsubq_u32(a, b);
 }
 
-void wyBlurColorFilter::apply(void* data, int width, int height) {
-	// if radius is less than 1, just do nothing
-	if(m_radius < 1)
-		return;
+static inline PixelSum loadSum(const uint32_t* p) {
+	return vld1q_u32(p);
+}
 
-	// radius can be more than width or height
-	int radius = m_radius;
-	if(m_radius >= width || m_radius >= height)
-		radius = MIN(width, MIN(height, m_radius)) - 1;
+static inline void storeSum(uint32_t* p, PixelSum sum) {
+	vst1q_u32(p, sum);
+}
+
+static inline PixelSum loadPixel(const unsigned char* p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	uint8x8_t b = vreinterpret_u8_u32(vdup_n_u32(v));
+	return vmovl_u16(vget_low_u16(vmovl_u8(b)));
+}
+
+static inline void storeAverage(unsigned char* p, PixelSum sum, float reciprocal) {
+	float32x4_t f = vmulq_n_f32(vaddq_f32(vcvtq_f32_u32(sum), vdupq_n_f32(0.5f)), reciprocal);
+	uint16x4_t h = vmovn_u32(vcvtq_u32_f32(f));
+	uint8x8_t b = vmovn_u16(vcombine_u16(h, h));
+	uint32_t v = vget_lane_u32(vreinterpret_u32_u8(b), 0);
+	memcpy(p, &v, 4);
+}
+
+#else
+
+typedef __m128i PixelSum;
+
+static inline PixelSum zeroSum() {
+	return _mm_setzero_si128();
+}
+
+static inline PixelSum addSum(PixelSum a, PixelSum b) {
+	return _mm_add_epi32(a, b);
+}
+
+static inline PixelSum subSum(PixelSum a, PixelSum b) {
+	return _mm_sub_epi32(a, b);
+}
+
+static inline PixelSum loadSum(const uint32_t* p) {
+	return _mm_loadu_si128((const __m128i*)p);
+}
 
-	// initialize cache
-	int cacheSize = MIN(radius * 2 + 1, height);
-	wyArray* rowCache = wyArrayNew(MIN(radius * 2 + 1, height));
+static inline void storeSum(uint32_t* p, PixelSum sum) {
+	_mm_storeu_si128((__m128i*)p, sum);
+}
 
-	// which row of imageData the cache begins with
-	int cacheStartIndex = 0;
-	for (int row = 0; row < cacheSize; row++) {
-		// row data is horizontally blurred before caching
-		wyArrayPush(rowCache, blurRow(data, width, row, radius));
+static inline PixelSum loadPixel(const unsigned char* p) {
+	int v;
+	memcpy(&v, p, 4);
+	__m128i zero = _mm_setzero_si128();
+	return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero);
+}
+
+static inline void storeAverage(unsigned char* p, PixelSum sum, float reciprocal) {
+	__m128 f = _mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(0.5f)), _mm_set1_ps(reciprocal));
+	__m128i v = _mm_cvttps_epi32(f);
+	v = _mm_packs_epi32(v, v);
+	v = _mm_packus_epi16(v, v);
+	int i = _mm_cvtsi128_si32(v);
+	memcpy(p, &i, 4);
+}
+
+#endif
+
+static void blurRowSIMD(const unsigned char* src, unsigned char* dst, int width, int radius, const float* reciprocals) {
+	// sum window of first pixel
+	PixelSum sum = zeroSum();
+	int right = MIN(radius, width - 1);
+	for(int i = 0; i <= right; i++)
+		sum = addSum(sum, loadPixel(src + i * 4));
+
+	for(int x = 0; x < width; x++) {
+		int count = MIN(width - 1, x + radius) - MAX(0, x - radius) + 1;
+		storeAverage(dst + x * 4, sum, reciprocals[count]);
+
+		// move window right
+		if(x + radius + 1 < width)
+			sum = addSum(sum, loadPixel(src + (x + radius + 1) * 4));
+		if(x - radius >= 0)
+			sum = subSum(sum, loadPixel(src + (x - radius) * 4));
 	}
+}
 
-	// sum red, green, and blue values separately for averaging
-	unsigned int* rowRGBSums = (unsigned int*)wyCalloc(width * 4, sizeof(int));
-	unsigned char* newData = (unsigned char*)wyMalloc(width * height * 4 * sizeof(char));
-	unsigned char* rowRGBAverages = newData;
-	
-	// follow original data
-	unsigned char* line = (unsigned char*)data;
-
-	// current top row of summed values scope
-	int topSumBoundary = 0;
-
-	// row with RGB averages to be determined
-	int targetRow = 0;
-
-	// current bottom row of summed values scope
-	int bottomSumBoundary = 0;
-
-	// number of rows included in current summing scope
-	int numRows = 0;
-
-	while (targetRow < height) {
-		if (bottomSumBoundary < height) {
-			do {
-				// sum pixel RGB values for each column in our radius scope
-				for (int col = 0; col < width; col++) {
-					unsigned char* cache = (unsigned char*)wyArrayGet(rowCache, bottomSumBoundary - cacheStartIndex);
-					rowRGBSums[col * 4] += cache[col * 4];
-					rowRGBSums[col * 4 + 1] += cache[col * 4 + 1];
-					rowRGBSums[col * 4 + 2] += cache[col * 4 + 2];
-				}
-				numRows++;
+static void blurColumnsSIMD(BlurJob* job, int startRow, int endRow) {
+	int width = job->width;
+	int height = job->height;
+	int radius = job->radius;
+	int stride = width * 4;
 
-				// move bottom scope boundary lower
-				bottomSumBoundary++;
-				if (bottomSumBoundary < height && bottomSumBoundary - cacheStartIndex > radius * 2) {
-					// grow cache
-					wyArrayPush(rowCache, blurRow(data, width, bottomSumBoundary, radius));
-				}
-			} while (bottomSumBoundary <= radius);
+	// four channel sums of every column, wyMalloc doesn't promise 16 bytes alignment
+	// so they are accessed by unaligned load and store
+	uint32_t* sums = (uint32_t*)wyMalloc(width * 4 * sizeof(uint32_t));
+
+	// sum window of first row
+	memset(sums, 0, width * 4 * sizeof(uint32_t));
+	int top = MAX(0, startRow - radius);
+	int bottom = MIN(height - 1, startRow + radius);
+	for(int y = top; y <= bottom; y++) {
+		unsigned char* src = job->blurred + y * stride;
+		for(int x = 0; x < width; x++)
+			storeSum(sums + x * 4, addSum(loadSum(sums + x * 4), loadPixel(src + x * 4)));
+	}
+
+	for(int y = startRow; y < endRow; y++) {
+		// write rgb average, keep alpha
+		float reciprocal = job->reciprocals[MIN(height - 1, y + radius) - MAX(0, y - radius) + 1];
+		unsigned char* dst = job->data + y * stride;
+		for(int x = 0; x < width; x++) {
+			unsigned char alpha = dst[x * 4 + 3];
+			storeAverage(dst + x * 4, loadSum(sums + x * 4), reciprocal);
+			dst[x * 4 + 3] = alpha;
 		}
 
-		if (targetRow - topSumBoundary > radius) {
-			// subtract values of top row from sums as scope of summed values moves down
-			for (int col = 0; col < width; col++) {
-				unsigned char* cache = (unsigned char*)wyArrayGet(rowCache, topSumBoundary - cacheStartIndex);
-				rowRGBSums[col * 4] -= cache[col * 4];
-				rowRGBSums[col * 4 + 1] -= cache[col * 4 + 1];
-				rowRGBSums[col * 4 + 2] -= cache[col * 4 + 2];
+		// move window down
+		if(y + 1 < endRow) {
+			if(y + radius + 1 < height) {
+				unsigned char* src = job->blurred + (y + radius + 1) * stride;
+				for(int x = 0; x < width; x++)
+					storeSum(sums + x * 4, addSum(loadSum(sums + x * 4), loadPixel(src + x * 4)));
 			}
-			numRows--;
+			if(y - radius >= 0) {
+				unsigned char* src = job->blurred + (y - radius) * stride;
+				for(int x = 0; x < width; x++)
+					storeSum(sums + x * 4, subSum(loadSum(sums + x * 4), loadPixel(src + x * 4)));
+			}
+		}
+	}
 
-			// move top scope boundary lower
-			topSumBoundary++;
+	wyFree(sums);
+}
 
-			// remove top row which is out of summing scope
-			wyFree(wyArrayGet(rowCache, 0));
-			wyArrayDeleteIndex(rowCache, 0);
-			cacheStartIndex++;
-		}
+#endif // #if WY_FILTER_NEON || WY_FILTER_SSE2
 
-		// calculate each column's RGB-averaged pixel
-		for (int col = 0; col < width; col++) {
-			rowRGBAverages[col * 4] = rowRGBSums[col * 4] / numRows;
-			rowRGBAverages[col * 4 + 1] = rowRGBSums[col * 4 + 1] / numRows;
-			rowRGBAverages[col * 4 + 2] = rowRGBSums[col * 4 + 2] / numRows;
-			rowRGBAverages[col * 4 + 3] = line[col * 4 + 3];
+static void blurRowScalar(const unsigned char* src, unsigned char* dst, int width, int radius) {
+	// sum window of first pixel
+	unsigned int r = 0, g = 0, b = 0;
+	int right = MIN(radius, width - 1);
+	for(int i = 0; i <= right; i++) {
+		r += src[i * 4];
+		g += src[i * 4 + 1];
+		b += src[i * 4 + 2];
+	}
+
+	for(int x = 0; x < width; x++) {
+		unsigned int count = MIN(width - 1, x + radius) - MAX(0, x - radius) + 1;
+		dst[x * 4] = r / count;
+		dst[x * 4 + 1] = g / count;
+		dst[x * 4 + 2] = b / count;
+
+		// move window right
+		if(x + radius + 1 < width) {
+			const unsigned char* p = src + (x + radius + 1) * 4;
+			r += p[0];
+			g += p[1];
+			b += p[2];
+		}
+		if(x - radius >= 0) {
+			const unsigned char* p = src + (x - radius) * 4;
+			r -= p[0];
+			g -= p[1];
+			b -= p[2];
 		}
-		rowRGBAverages += width * 4;
-		line += width * 4;
+	}
+}
 
-		targetRow++;
+static void blurColumnsScalar(BlurJob* job, int startRow, int endRow) {
+	int width = job->width;
+	int height = job->height;
+	int radius = job->radius;
+	int stride = width * 4;
+	unsigned int* sums = (unsigned int*)wyCalloc(width * 3, sizeof(unsigned int));
+
+	// sum window of first row
+	int top = MAX(0, startRow - radius);
+	int bottom = MIN(height - 1, startRow + radius);
+	for(int y = top; y <= bottom; y++) {
+		unsigned char* src = job->blurred + y * stride;
+		for(int x = 0; x < width; x++) {
+			sums[x * 3] += src[x * 4];
+			sums[x * 3 + 1] += src[x * 4 + 1];
+			sums[x * 3 + 2] += src[x * 4 + 2];
+		}
 	}
 
-	// copy new data
-	memcpy(data, newData, width * height * 4 * sizeof(char));
+	for(int y = startRow; y < endRow; y++) {
+		// write rgb average, keep alpha
+		unsigned int count = MIN(height - 1, y + radius) - MAX(0, y - radius) + 1;
+		unsigned char* dst = job->data + y * stride;
+		for(int x = 0; x < width; x++) {
+			dst[x * 4] = sums[x * 3] / count;
+			dst[x * 4 + 1] = sums[x * 3 + 1] / count;
+			dst[x * 4 + 2] = sums[x * 3 + 2] / count;
+		}
 
-	// release cache
-	for(int i = 0; i < rowCache->num; i++) {
-		wyFree(wyArrayGet(rowCache, i));
+		// move window down
+		if(y + 1 < endRow) {
+			if(y + radius + 1 < height) {
+				unsigned char* src = job->blurred + (y + radius + 1) * stride;
+				for(int x = 0; x < width; x++) {
+					sums[x * 3] += src[x * 4];
+					sums[x * 3 + 1] += src[x * 4 + 1];
+					sums[x * 3 + 2] += src[x * 4 + 2];
+				}
+			}
+			if(y - radius >= 0) {
+				unsigned char* src = job->blurred + (y - radius) * stride;
+				for(int x = 0; x < width; x++) {
+					sums[x * 3] -= src[x * 4];
+					sums[x * 3 + 1] -= src[x * 4 + 1];
+					sums[x * 3 + 2] -= src[x * 4 + 2];
+				}
+			}
+		}
 	}
-	wyArrayDestroy(rowCache);
 
-	// free others
-	wyFree(rowRGBSums);
-	wyFree(newData);
+	wyFree(sums);
 }
 
-unsigned char* wyBlurColorFilter::blurRow(void* data, int width, int row, int radius) {
-	// resulting rgb averages
-	unsigned char* rowRGBAverages = (unsigned char*)wyMalloc(width * sizeof(char) * 4);
-	unsigned char* lineData = (unsigned char*)data + row * width * 4;
+wyBlurColorFilter::wyBlurColorFilter(int radius) :
+		m_radius(radius) {
+}
 
-	// sum red, green, and blue values separately for averaging
-	unsigned int r = 0, g = 0, b = 0;
+wyBlurColorFilter::~wyBlurColorFilter() {
+}
 
-	// beginning index of summed values scope
-	int leftSumBoundary = 0;
-
-	// column of RGB average to be determined
-	int targetColumn = 0;
-
-	// ending index of summed values scope
-	int rightSumBoundary = 0;
-
-	// number of columns included in current summing scope
-	unsigned int numCols = 0;
-	while (targetColumn < width) {
-		if (rightSumBoundary < width) {
-			// sum RGB values for each pixel in our radius scope
-			do {
-				r += lineData[rightSumBoundary * 4];
-				g += lineData[rightSumBoundary * 4 + 1];
-				b += lineData[rightSumBoundary * 4 + 2];
-				numCols++;
-				rightSumBoundary++;
-			} while (rightSumBoundary <= radius);
-		}
+wyBlurColorFilter* wyBlurColorFilter::make(int radius) {
+	wyBlurColorFilter* f = WYNEW wyBlurColorFilter(radius);
+	return (wyBlurColorFilter*)f->autoRelease();
+}
 
-		// subtract sum of left pixel as summing scope moves right
-		if ((targetColumn - leftSumBoundary) > radius) {
-			r -= lineData[leftSumBoundary * 4];
-			g -= lineData[leftSumBoundary * 4 + 1];
-			b -= lineData[leftSumBoundary * 4 + 2];
-			numCols--;
-			leftSumBoundary++;
+void wyBlurColorFilter::blurRowsHorizontally(void* arg, int startRow, int endRow) {
+	BlurJob* job = (BlurJob*)arg;
+	int stride = job->width * 4;
+	for(int y = startRow; y < endRow; y++) {
+#if WY_FILTER_NEON || WY_FILTER_SSE2
+		if(job->reciprocals != NULL) {
+			blurRowSIMD(job->data + y * stride, job->blurred + y * stride, job->width, job->radius, job->reciprocals);
+			continue;
 		}
+#endif
+		blurRowScalar(job->data + y * stride, job->blurred + y * stride, job->width, job->radius);
+	}
+}
+
+void wyBlurColorFilter::blurRowsVertically(void* arg, int startRow, int endRow) {
+	BlurJob* job = (BlurJob*)arg;
+#if WY_FILTER_NEON || WY_FILTER_SSE2
+	if(job->reciprocals != NULL) {
+		blurColumnsSIMD(job, startRow, endRow);
+		return;
+	}
+#endif
+	blurColumnsScalar(job, startRow, endRow);
+}
 
-		// calculate RGB averages
-		rowRGBAverages[targetColumn * 4] = r / numCols;
-		rowRGBAverages[targetColumn * 4 + 1] = g / numCols;
-		rowRGBAverages[targetColumn * 4 + 2] = b / numCols;
-		targetColumn++;
+void wyBlurColorFilter::apply(void* data, int width, int height) {
+	// if radius is less than 1, just do nothing
+	if(m_radius < 1)
+		return;
+
+	// radius can be more than width or height
+	int radius = m_radius;
+	if(m_radius >= width || m_radius >= height)
+		radius = MIN(width, MIN(height, m_radius)) - 1;
+
+	/*
+	 * average filter is separable, so rows are blurred horizontally first and then
+	 * columns of blurred rows are blurred vertically. Every pixel is the average of
+	 * a (2 * radius + 1) square window, clipped by image border. Alpha doesn't change.
+	 */
+	BlurJob job;
+	job.data = (unsigned char*)data;
+	job.blurred = (unsigned char*)wyMalloc(width * height * 4 * sizeof(char));
+	job.width = width;
+	job.height = height;
+	job.radius = radius;
+	job.reciprocals = NULL;
+
+	// window holds at most 2 * radius + 1 pixels
+	int maxWindow = radius * 2 + 1;
+	if(isSIMDEnabled() && maxWindow < MAX_SIMD_WINDOW) {
+		job.reciprocals = (float*)wyMalloc((maxWindow + 1) * sizeof(float));
+		job.reciprocals[0] = 0;
+		for(int i = 1; i <= maxWindow; i++)
+			job.reciprocals[i] = 1.f / i;
 	}
 
-	return rowRGBAverages;
+	// vertical pass reads blurred rows of other bands, so it must wait horizontal pass done
+	runBands(blurRowsHorizontally, &job, height, MIN_BAND_ROWS);
+	runBands(blurRowsVertically, &job, height, MAX(MIN_BAND_ROWS, radius * 2));
+
+	// free
+	if(job.reciprocals != NULL)
+		wyFree(job.reciprocals);
+	wyFree(job.blurred);
 }
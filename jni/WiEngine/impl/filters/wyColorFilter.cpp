@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: luma(stubma@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "wyColorFilter.h"
+#include "wyLog.h"
+#include "wyMath.h"
+#include "wyAtomic.h"
+#include <pthread.h>
+#if WINDOWS
+	#include <windows.h>
+#else
+	#include <unistd.h>
+#endif
+
+// max thread count, including the calling thread
+#define MAX_THREADS 16
+
+// bands per thread, more bands balance load better when rows cost differently
+#define BANDS_PER_THREAD 4
+
+// band kernel, same as wyColorFilter::BandKernel
+typedef void (*BandFunc)(void* arg, int startRow, int endRow);
+
+// worker thread info
+struct Worker {
+	pthread_t thread;
+
+	// index of worker, in [0, MAX_THREADS - 1)
+	int index;
+
+	// last generation this worker ran
+	int generation;
+};
+
+// 0 means not decided yet, it will be the number of CPU cores
+static int sThreadCount = 0;
+
+// true means SIMD kernels are used if compiled in
+static bool sSIMDEnabled = true;
+
+// workers wait for start condition and check in with done condition
+static pthread_mutex_t sMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sStartCond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sDoneCond = PTHREAD_COND_INITIALIZER;
+
+// workers are shared, so only one image can be split at a time
+static pthread_mutex_t sRunMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// started workers, they never exit
+static Worker sWorkers[MAX_THREADS - 1];
+static int sWorkerCount = 0;
+
+// increased for every job, workers check in once for every generation
+static int sGeneration = 0;
+static int sBusyCount = 0;
+
+// current job, workers whose index is not less than active count skip it
+static BandFunc sKernel = NULL;
+static void* sArg = NULL;
+static int sRows = 0;
+static int sBandRows = 0;
+static int sBandCount = 0;
+static int sActiveWorkers = 0;
+static volatile int sNextBand = 0;
+
+static int getCPUCount() {
+#if WINDOWS
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+#else
+	return sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+static void runJob() {
+	for(;;) {
+		int band = wyAtomicAdd(&sNextBand, 1) - 1;
+		if(band >= sBandCount)
+			break;
+
+		int start = band * sBandRows;
+		sKernel(sArg, start, MIN(sRows, start + sBandRows));
+	}
+}
+
+static void* workerEntry(void* arg) {
+	Worker* w = (Worker*)arg;
+
+	pthread_mutex_lock(&sMutex);
+	for(;;) {
+		while(sGeneration == w->generation)
+			pthread_cond_wait(&sStartCond, &sMutex);
+		w->generation = sGeneration;
+		bool active = w->index < sActiveWorkers;
+		pthread_mutex_unlock(&sMutex);
+
+		if(active)
+			runJob();
+
+		pthread_mutex_lock(&sMutex);
+		sBusyCount--;
+		if(sBusyCount == 0)
+			pthread_cond_signal(&sDoneCond);
+	}
+	pthread_mutex_unlock(&sMutex);
+
+	return NULL;
+}
+
+void wyColorFilter::runBands(BandKernel kernel, void* arg, int rows, int minBandRows) {
+	if(rows <= 0)
+		return;
+
+	// split rows
+	int threads = getThreadCount();
+	int maxBands = threads * BANDS_PER_THREAD;
+	int bandRows = MAX(MAX(1, minBandRows), (rows + maxBands - 1) / maxBands);
+	int bandCount = (rows + bandRows - 1) / bandRows;
+
+	// not worth waking anybody, or workers are busy with another image
+	if(threads == 1 || bandCount == 1 || pthread_mutex_trylock(&sRunMutex) != 0) {
+		kernel(arg, 0, rows);
+		return;
+	}
+
+	// start workers lazily, new worker waits for next generation
+	while(sWorkerCount < threads - 1) {
+		Worker* w = sWorkers + sWorkerCount;
+		w->index = sWorkerCount;
+		w->generation = sGeneration;
+		if(pthread_create(&w->thread, NULL, workerEntry, w) != 0) {
+			LOGW("color filter: failed to start worker thread");
+			break;
+		}
+		pthread_detach(w->thread);
+		sWorkerCount++;
+	}
+
+	// publish job
+	pthread_mutex_lock(&sMutex);
+	sKernel = kernel;
+	sArg = arg;
+	sRows = rows;
+	sBandRows = bandRows;
+	sBandCount = bandCount;
+	sNextBand = 0;
+	sActiveWorkers = threads - 1;
+	sBusyCount = sWorkerCount;
+	sGeneration++;
+	pthread_cond_broadcast(&sStartCond);
+	pthread_mutex_unlock(&sMutex);
+
+	// calling thread works too
+	runJob();
+
+	// wait all workers check in
+	pthread_mutex_lock(&sMutex);
+	while(sBusyCount > 0)
+		pthread_cond_wait(&sDoneCond, &sMutex);
+	sKernel = NULL;
+	sArg = NULL;
+	pthread_mutex_unlock(&sMutex);
+
+	pthread_mutex_unlock(&sRunMutex);
+}
+
+void wyColorFilter::setThreadCount(int count) {
+	if(count <= 0)
+		count = getCPUCount();
+	sThreadCount = MAX(1, MIN(MAX_THREADS, count));
+}
+
+int wyColorFilter::getThreadCount() {
+	if(sThreadCount == 0)
+		setThreadCount(0);
+	return sThreadCount;
+}
+
+void wyColorFilter::setSIMDEnabled(bool flag) {
+	sSIMDEnabled = flag;
+}
+
+bool wyColorFilter::isSIMDEnabled() {
+	return (WY_FILTER_NEON || WY_FILTER_SSE2) && sSIMDEnabled;
+}
@@ -30,6 +30,115 @@
 #include "wyGlobal.h"
 #include "wyLog.h"
 #include "wyMath.h"
+#include <string.h>
+
+#if WY_FILTER_NEON
+	#include <arm_neon.h>
+#elif WY_FILTER_SSE2
+	#include <emmintrin.h>
+#endif
+
+// rows of a band
+#define MIN_BAND_ROWS 16
+
+// shared by band kernels
+struct ColorMatrixJob {
+	unsigned char* data;
+	int width;
+
+	// 4x5 matrix, row major
+	float* m;
+
+	// true means using SIMD kernel
+	bool simd;
+};
+
+#if WY_FILTER_NEON || WY_FILTER_SSE2
+
+/*
+ * A pixel is loaded to four float lanes and every channel is broadcasted to
+ * multiply a matrix column, so four result channels are computed together. The
+ * order of additions is same as scalar kernel.
+ */
+static void transformRowSIMD(unsigned char* p, int width, const float* m) {
+#if WY_FILTER_NEON
+	float c0[] = { m[0], m[5], m[10], m[15] };
+	float c1[] = { m[1], m[6], m[11], m[16] };
+	float c2[] = { m[2], m[7], m[12], m[17] };
+	float c3[] = { m[3], m[8], m[13], m[18] };
+	float c4[] = { m[4], m[9], m[14], m[19] };
+	float32x4_t col0 = vld1q_f32(c0);
+	float32x4_t col1 = vld1q_f32(c1);
+	float32x4_t col2 = vld1q_f32(c2);
+	float32x4_t col3 = vld1q_f32(c3);
+	float32x4_t bias = vmulq_f32(vdupq_n_f32(255), vld1q_f32(c4));
+	float32x4_t zero = vdupq_n_f32(0);
+	float32x4_t max = vdupq_n_f32(255);
+	for(int x = 0; x < width; x++, p += 4) {
+		uint32_t v;
+		memcpy(&v, p, 4);
+		uint8x8_t b = vreinterpret_u8_u32(vdup_n_u32(v));
+		float32x4_t f = vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(b))));
+		float32x2_t rg = vget_low_f32(f);
+		float32x2_t ba = vget_high_f32(f);
+
+		float32x4_t t = vmulq_lane_f32(col0, rg, 0);
+		t = vaddq_f32(t, vmulq_lane_f32(col1, rg, 1));
+		t = vaddq_f32(t, vmulq_lane_f32(col2, ba, 0));
+		t = vaddq_f32(t, vmulq_lane_f32(col3, ba, 1));
+		t = vaddq_f32(t, bias);
+		t = vmaxq_f32(zero, vminq_f32(max, t));
+
+		uint16x4_t h = vmovn_u32(vcvtq_u32_f32(t));
+		v = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(h, h))), 0);
+		memcpy(p, &v, 4);
+	}
+#else
+	__m128 col0 = _mm_setr_ps(m[0], m[5], m[10], m[15]);
+	__m128 col1 = _mm_setr_ps(m[1], m[6], m[11], m[16]);
+	__m128 col2 = _mm_setr_ps(m[2], m[7], m[12], m[17]);
+	__m128 col3 = _mm_setr_ps(m[3], m[8], m[13], m[18]);
+	__m128 bias = _mm_mul_ps(_mm_set1_ps(255), _mm_setr_ps(m[4], m[9], m[14], m[19]));
+	__m128 zero = _mm_setzero_ps();
+	__m128 max = _mm_set1_ps(255);
+	__m128i zeroi = _mm_setzero_si128();
+	for(int x = 0; x < width; x++, p += 4) {
+		int v;
+		memcpy(&v, p, 4);
+		__m128i i = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zeroi), zeroi);
+		__m128 f = _mm_cvtepi32_ps(i);
+
+		__m128 t = _mm_mul_ps(_mm_shuffle_ps(f, f, _MM_SHUFFLE(0, 0, 0, 0)), col0);
+		t = _mm_add_ps(t, _mm_mul_ps(_mm_shuffle_ps(f, f, _MM_SHUFFLE(1, 1, 1, 1)), col1));
+		t = _mm_add_ps(t, _mm_mul_ps(_mm_shuffle_ps(f, f, _MM_SHUFFLE(2, 2, 2, 2)), col2));
+		t = _mm_add_ps(t, _mm_mul_ps(_mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3)), col3));
+		t = _mm_add_ps(t, bias);
+		t = _mm_max_ps(zero, _mm_min_ps(max, t));
+
+		i = _mm_cvttps_epi32(t);
+		i = _mm_packs_epi32(i, i);
+		i = _mm_packus_epi16(i, i);
+		v = _mm_cvtsi128_si32(i);
+		memcpy(p, &v, 4);
+	}
+#endif
+}
+
+#endif // #if WY_FILTER_NEON || WY_FILTER_SSE2
+
+static void transformRowScalar(unsigned char* p, int width, const float* m) {
+	for(int x = 0; x < width; x++) {
+		int r = p[0];
+		int g = p[1];
+		int b = p[2];
+		int a = p[3];
+		p[0] = MAX(0, MIN(255, r * m[0] + g * m[1] + b * m[2] + a * m[3] + 255 * m[4]));
+		p[1] = MAX(0, MIN(255, r * m[5] + g * m[6] + b * m[7] + a * m[8] + 255 * m[9]));
+		p[2] = MAX(0, MIN(255, r * m[10] + g * m[11] + b * m[12] + a * m[13] + 255 * m[14]));
+		p[3] = MAX(0, MIN(255, r * m[15] + g * m[16] + b * m[17] + a * m[18] + 255 * m[19]));
+		p += 4;
+	}
+}
 
 wyColorMatrixColorFilter::wyColorMatrixColorFilter(wyColorMatrix* m) {
 	m_matrix = m;
@@ -45,20 +154,25 @@ wyColorMatrixColorFilter* wyColorMatrixColorFilter::make(wyColorMatrix* m) {
 	return (wyColorMatrixColorFilter*)f->autoRelease();
 }
 
-void wyColorMatrixColorFilter::apply(void* data, int width, int height) {
-	float* m = m_matrix->getMatrix();
-	char* p = (char*)data;
-	for(int y = 0; y < height; y++) {
-		for(int x = 0; x < width; x++) {
-			int r = p[0] & 0xFF;
-			int g = p[1] & 0xFF;
-			int b = p[2] & 0xFF;
-			int a = p[3] & 0xFF;
-			p[0] = MAX(0, MIN(255, r * m[0] + g * m[1] + b * m[2] + a * m[3] + 255 * m[4]));
-			p[1] = MAX(0, MIN(255, r * m[5] + g * m[6] + b * m[7] + a * m[8] + 255 * m[9]));
-			p[2] = MAX(0, MIN(255, r * m[10] + g * m[11] + b * m[12] + a * m[13] + 255 * m[14]));
-			p[3] = MAX(0, MIN(255, r * m[15] + g * m[16] + b * m[17] + a * m[18] + 255 * m[19]));
-			p += 4;
+void wyColorMatrixColorFilter::transformRows(void* arg, int startRow, int endRow) {
+	ColorMatrixJob* job = (ColorMatrixJob*)arg;
+	for(int y = startRow; y < endRow; y++) {
+		unsigned char* p = job->data + y * job->width * 4;
+#if WY_FILTER_NEON || WY_FILTER_SSE2
+		if(job->simd) {
+			transformRowSIMD(p, job->width, job->m);
+			continue;
 		}
+#endif
+		transformRowScalar(p, job->width, job->m);
 	}
 }
+
+void wyColorMatrixColorFilter::apply(void* data, int width, int height) {
+	ColorMatrixJob job;
+	job.data = (unsigned char*)data;
+	job.width = width;
+	job.m = m_matrix->getMatrix();
+	job.simd = isSIMDEnabled();
+	runBands(transformRows, &job, height, MIN_BAND_ROWS);
+}
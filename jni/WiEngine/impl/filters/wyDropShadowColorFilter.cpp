@@ -28,6 +28,7 @@
  */
 #include "wyDropShadowColorFilter.h"
 #include "wyLog.h"
+#include <string.h>
 
 wyDropShadowColorFilter::wyDropShadowColorFilter(wyColor3B color, int radius, int highlightRadius, int opacity) :
 		m_color(color),
@@ -55,6 +56,25 @@ void wyDropShadowColorFilter::apply(void* data, int width, int height) {
 	int shift = (int) (m_radius * 0.2f);
 	unsigned char* line = (unsigned char*)data;
 
+	// rows between top and bottom border only have right border, and alphas there only
+	// depend on column, so build border pixels once and copy them to every such row
+	int borderCols = MIN(m_radius, width);
+	int borderSize = borderCols * 4;
+	unsigned char* border = (unsigned char*)wyMalloc(borderSize * sizeof(char));
+	for(int col = 0; col < borderCols; col++) {
+		float intensity = (m_opacity * ((col + 1) / (float) m_radius));
+		if(col > MAX(m_radius - m_highlightRadius - 1, m_radius * 0.5f)) {
+			intensity = MIN(255, (intensity) * (1 + highlightRadiusIncrease * col / m_radius));
+		}
+
+		// border is the last borderCols pixels of a row
+		unsigned char* p = border + (borderCols - col - 1) * 4;
+		p[0] = m_color.r;
+		p[1] = m_color.g;
+		p[2] = m_color.b;
+		p[3] = (int) (intensity);
+	}
+
 	for(int row = 0; row < m_radius; row++) {
 		for(int col = 0; col < shift; col++) {
 			line[(height - row - 1) * width * 4 + (col) * 4 + 3] = 0;
@@ -102,30 +122,14 @@ void wyDropShadowColorFilter::apply(void* data, int width, int height) {
 				}
 			}
 		} else if (row <= height / 2) {
-			// deal with rows the image resides on
-
-			// calculate alpha values
-			float intensity = 0.0f;
-			for(int col = 0; col < width; col++) {
-				if(col < m_radius) {
-					intensity = (m_opacity * ((col + 1) / (float) m_radius));
-					if(col > MAX(m_radius - m_highlightRadius - 1, m_radius * 0.5f)) {
-						intensity = MIN(255, (intensity) * (1 + highlightRadiusIncrease * col / m_radius));
-					}
-					alphas = (int) (intensity);
-					if(row + shift < height) {
-						line[(row + shift) * width * 4 + (width - col - 1) * 4] = m_color.r;
-						line[(row + shift) * width * 4 + (width - col - 1) * 4 + 1] = m_color.g;
-						line[(row + shift) * width * 4 + (width - col - 1) * 4 + 2] = m_color.b;
-						line[(row + shift) * width * 4 + (width - col - 1) * 4 + 3] = alphas;
-					}
-
-					line[(height - row - 1) * width * 4 + (width - col - 1) * 4] = m_color.r;
-					line[(height - row - 1) * width * 4 + (width - col - 1) * 4 + 1] = m_color.g;
-					line[(height - row - 1) * width * 4 + (width - col - 1) * 4 + 2] = m_color.b;
-					line[(height - row - 1) * width * 4 + (width - col - 1) * 4 + 3] = alphas;
-				}
+			// deal with rows the image resides on, copy right border
+			int rightOffset = (width - borderCols) * 4;
+			if(row + shift < height) {
+				memcpy(line + (row + shift) * width * 4 + rightOffset, border, borderSize);
 			}
+			memcpy(line + (height - row - 1) * width * 4 + rightOffset, border, borderSize);
 		}
 	}
+
+	wyFree(border);
 }
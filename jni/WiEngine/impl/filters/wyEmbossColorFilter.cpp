@@ -28,6 +28,114 @@
  */
 #include "wyEmbossColorFilter.h"
 #include "wyMath.h"
+#include <string.h>
+
+#if WY_FILTER_NEON
+	#include <arm_neon.h>
+#elif WY_FILTER_SSE2
+	#include <emmintrin.h>
+#endif
+
+// rows of a band
+#define MIN_BAND_ROWS 16
+
+// shared by band kernels
+struct EmbossJob {
+	unsigned char* data;
+	int width;
+
+	// gray values of rows except last row
+	unsigned char* grays;
+
+	// gray level, clamped to 255
+	unsigned int grayLevel;
+
+	// true means using SIMD kernel
+	bool simd;
+};
+
+/*
+ * Gray of a pixel is gray level plus max channel difference between it and the pixel
+ * above, or the pixel above and two pixels left if it is not in first two columns.
+ * The pixel is in row2 and the pixel above is in row1.
+ */
+static void embossRowScalar(const unsigned char* row1, const unsigned char* row2, unsigned char* grays, int startX, int width, unsigned int grayLevel) {
+	for(int x = startX; x < width; x++) {
+		const unsigned char* p = row2 + x * 4;
+		const unsigned char* above = row1 + (x < 2 ? x : x - 2) * 4;
+		unsigned int diffR = abs(p[0] - above[0]);
+		unsigned int diffG = abs(p[1] - above[1]);
+		unsigned int diffB = abs(p[2] - above[2]);
+		unsigned int max = MAX(diffR, MAX(diffG, diffB));
+		grays[x] = MIN(255, grayLevel + max);
+	}
+}
+
+#if WY_FILTER_NEON || WY_FILTER_SSE2
+
+// four pixels a time, then scalar kernel does the tail
+static void embossRowSIMD(const unsigned char* row1, const unsigned char* row2, unsigned char* grays, int width, unsigned int grayLevel) {
+	embossRowScalar(row1, row2, grays, 0, MIN(2, width), grayLevel);
+
+	int x = 2;
+#if WY_FILTER_NEON
+	uint8x16_t level = vdupq_n_u8(grayLevel);
+	for(; x + 4 <= width; x += 4) {
+		uint8x16_t d = vabdq_u8(vld1q_u8(row2 + x * 4), vld1q_u8(row1 + (x - 2) * 4));
+
+		// max of r, g, b goes to lowest byte of every pixel
+		uint32x4_t d32 = vreinterpretq_u32_u8(d);
+		uint8x16_t m = vmaxq_u8(d, vreinterpretq_u8_u32(vshrq_n_u32(d32, 8)));
+		m = vmaxq_u8(m, vreinterpretq_u8_u32(vshrq_n_u32(d32, 16)));
+		m = vqaddq_u8(m, level);
+
+		uint32x4_t g = vandq_u32(vreinterpretq_u32_u8(m), vdupq_n_u32(0xFF));
+		uint16x4_t h = vmovn_u32(g);
+		uint32_t v = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(h, h))), 0);
+		memcpy(grays + x, &v, 4);
+	}
+#else
+	__m128i level = _mm_set1_epi8((char)grayLevel);
+	__m128i mask = _mm_set1_epi32(0xFF);
+	for(; x + 4 <= width; x += 4) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(row2 + x * 4));
+		__m128i b = _mm_loadu_si128((const __m128i*)(row1 + (x - 2) * 4));
+		__m128i d = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+
+		// max of r, g, b goes to lowest byte of every pixel
+		__m128i m = _mm_max_epu8(d, _mm_srli_epi32(d, 8));
+		m = _mm_max_epu8(m, _mm_srli_epi32(d, 16));
+		m = _mm_adds_epu8(m, level);
+
+		__m128i g = _mm_and_si128(m, mask);
+		g = _mm_packs_epi32(g, g);
+		g = _mm_packus_epi16(g, g);
+		int v = _mm_cvtsi128_si32(g);
+		memcpy(grays + x, &v, 4);
+	}
+#endif
+
+	embossRowScalar(row1, row2, grays, x, width, grayLevel);
+}
+
+#endif // #if WY_FILTER_NEON || WY_FILTER_SSE2
+
+static void computeRowGrays(EmbossJob* job, const unsigned char* row1, const unsigned char* row2, unsigned char* grays) {
+#if WY_FILTER_NEON || WY_FILTER_SSE2
+	if(job->simd) {
+		embossRowSIMD(row1, row2, grays, job->width, job->grayLevel);
+		return;
+	}
+#endif
+	embossRowScalar(row1, row2, grays, 0, job->width, job->grayLevel);
+}
+
+static void writeRowGrays(unsigned char* row, const unsigned char* grays, int width) {
+	for(int x = 0; x < width; x++) {
+		row[0] = row[1] = row[2] = grays[x];
+		row += 4;
+	}
+}
 
 wyEmbossColorFilter::wyEmbossColorFilter(unsigned int grayLevel) :
 		m_grayLevel(MAX(0, MIN(255, grayLevel))) {
@@ -41,67 +149,46 @@ wyEmbossColorFilter* wyEmbossColorFilter::make(unsigned int grayLevel) {
 	return (wyEmbossColorFilter*)f->autoRelease();
 }
 
-void wyEmbossColorFilter::apply(void* data, int width, int height) {
-	unsigned char* row1 = NULL;
-	unsigned char* row2 = (unsigned char*)data;
-	unsigned char* result = NULL;
-	for(int y = 0; y < height; y++) {
-		// set row1 and row2 and result
-		if(y < height - 1) {
-			row1 = row2;
-			row2 = row1 + width * 4;
-			result = row1;
-		} else {
-			result = row2;
-		}
-
-		int start = 0;
-		unsigned int first, second;
-		for(int x = 0; x < width; x++) {
-			unsigned int diffR, diffG, diffB;
-			if(x < 2) {
-				// for first two columns, compare the target pixel to the pixel above
-				diffR = abs(row2[start] - row1[start]);
-				diffG = abs(row2[start + 1] - row1[start + 1]);
-				diffB = abs(row2[start + 2] - row1[start + 2]);
-			} else {
-				// for all columns after the second column, compare the target pixel
-				// to the pixel two pixels to the left on the row above
-				diffR = abs(row2[start] - row1[start - 8]);
-				diffG = abs(row2[start + 1] - row1[start - 7]);
-				diffB = abs(row2[start + 2] - row1[start - 6]);
-			}
-
-			// calculate gray level
-			unsigned int max = MAX(diffR, MAX(diffG, diffB));
-			unsigned int gray = MAX(0, MIN(255, m_grayLevel + max));
-			
-			/*
-			 * we can't write gray back immediately because the color will be accessed
-			 * later. so we must wait two pixels
-			 */
-			if(x < 1) {
-				first = gray;
-			} else if(x < 2) {
-				second = gray;
-			} else {
-				result[start - 8] = first;
-				result[start - 7] = first;
-				result[start - 6] = first;
-				first = second;
-				second = gray;
-			}
-
-			// increase start
-			start += 4;
-		}
-		
-		// write last two pixels of this line
-		result[start - 8] = first;
-		result[start - 7] = first;
-		result[start - 6] = first;
-		result[start - 4] = second;
-		result[start - 3] = second;
-		result[start - 2] = second;
+void wyEmbossColorFilter::computeGrays(void* arg, int startRow, int endRow) {
+	EmbossJob* job = (EmbossJob*)arg;
+	int stride = job->width * 4;
+	for(int y = startRow; y < endRow; y++) {
+		unsigned char* row1 = job->data + y * stride;
+		computeRowGrays(job, row1, row1 + stride, job->grays + y * job->width);
 	}
 }
+
+void wyEmbossColorFilter::writeGrays(void* arg, int startRow, int endRow) {
+	EmbossJob* job = (EmbossJob*)arg;
+	for(int y = startRow; y < endRow; y++) {
+		writeRowGrays(job->data + y * job->width * 4, job->grays + y * job->width, job->width);
+	}
+}
+
+void wyEmbossColorFilter::apply(void* data, int width, int height) {
+	// need two rows and two columns at least
+	if(width < 2 || height < 2)
+		return;
+
+	EmbossJob job;
+	job.data = (unsigned char*)data;
+	job.width = width;
+	job.grays = (unsigned char*)wyMalloc(width * (height - 1) * sizeof(char));
+	job.grayLevel = MIN(255, m_grayLevel);
+	job.simd = isSIMDEnabled();
+
+	/*
+	 * every row except last one compares to the row below it and the result is written
+	 * to itself, so all grays are computed from unchanged image before any row is written
+	 */
+	runBands(computeGrays, &job, height - 1, MIN_BAND_ROWS);
+	runBands(writeGrays, &job, height - 1, MIN_BAND_ROWS);
+
+	// last row compares to the row above it, which is embossed already
+	int stride = width * 4;
+	unsigned char* last = job.data + (height - 1) * stride;
+	computeRowGrays(&job, last - stride, last, job.grays);
+	writeRowGrays(last, job.grays, width);
+
+	wyFree(job.grays);
+}
@@ -28,6 +28,7 @@
  */
 #include "wyGlowColorFilter.h"
 #include "wyLog.h"
+#include <string.h>
 
 wyGlowColorFilter::wyGlowColorFilter(wyColor3B color, int radius, int highlightRadius, int opacity) :
 	m_color(color), m_radius(radius), m_highlightRadius(highlightRadius), m_opacity(opacity) {
@@ -50,6 +51,28 @@ void wyGlowColorFilter::apply(void* data, int width, int height) {
 	m_opacity = m_opacity > 255 ? 255 : m_opacity < 0 ? 0 : m_opacity;
 	unsigned char* line = (unsigned char*) data;
 
+	// rows between top and bottom border only have left and right border, and alphas there
+	// only depend on column, so build border pixels once and copy them to every such row
+	int borderCols = MIN(m_radius, width);
+	unsigned char* border = (unsigned char*)wyMalloc(width * 4 * sizeof(char));
+	for(int col = 0; col < borderCols; col++) {
+		float intensity = (m_opacity * ((col + 1) / (float) m_radius));
+		if(col > MAX(m_radius - m_highlightRadius - 1, m_radius * 0.5f)) {
+			intensity = MIN(255, (intensity) * (1 + highlightRadiusIncrease * col / m_radius));
+		}
+		int alphas = (int) (intensity);
+
+		border[col * 4] = m_color.r;
+		border[col * 4 + 1] = m_color.g;
+		border[col * 4 + 2] = m_color.b;
+		border[col * 4 + 3] = alphas;
+
+		border[(width - col - 1) * 4] = m_color.r;
+		border[(width - col - 1) * 4 + 1] = m_color.g;
+		border[(width - col - 1) * 4 + 2] = m_color.b;
+		border[(width - col - 1) * 4 + 3] = alphas;
+	}
+
 	for(int row = 0; row < height; row++) {
 		int alphas = 0;
 		if(row < m_radius) {
@@ -93,39 +116,15 @@ void wyGlowColorFilter::apply(void* data, int width, int height) {
 				line[(height - row - 1) * width * 4 + (width - col - 1) * 4 + 3] = alphas;
 			}
 		} else if(row <= height / 2) {
-			// deal with rows the image resides on
-
-			// calculate alpha values
-			float intensity = 0.0f;
-			for(int col = 0; col < width; col++) {
-				if(col < m_radius) {
-					intensity = (m_opacity * ((col + 1) / (float) m_radius));
-					if(col > MAX(m_radius - m_highlightRadius - 1, m_radius * 0.5f)) {
-						intensity = MIN(255, (intensity) * (1 + highlightRadiusIncrease * col / m_radius));
-					}
-					alphas = (int) (intensity);
-
-					line[row * width * 4 + (col * 4)] = m_color.r;
-					line[row * width * 4 + (col * 4) + 1] = m_color.g;
-					line[row * width * 4 + (col * 4) + 2] = m_color.b;
-					line[row * width * 4 + (col * 4) + 3] = alphas;
-
-					line[(height - row - 1) * width * 4 + (col * 4)] = m_color.r;
-					line[(height - row - 1) * width * 4 + (col * 4) + 1] = m_color.g;
-					line[(height - row - 1) * width * 4 + (col * 4) + 2] = m_color.b;
-					line[(height - row - 1) * width * 4 + (col * 4) + 3] = alphas;
-
-					line[row * width * 4 + (width - col - 1) * 4] = m_color.r;
-					line[row * width * 4 + (width - col - 1) * 4 + 1] = m_color.g;
-					line[row * width * 4 + (width - col - 1) * 4 + 2] = m_color.b;
-					line[row * width * 4 + (width - col - 1) * 4 + 3] = alphas;
-
-					line[(height - row - 1) * width * 4 + (width - col - 1) * 4] = m_color.r;
-					line[(height - row - 1) * width * 4 + (width - col - 1) * 4 + 1] = m_color.g;
-					line[(height - row - 1) * width * 4 + (width - col - 1) * 4 + 2] = m_color.b;
-					line[(height - row - 1) * width * 4 + (width - col - 1) * 4 + 3] = alphas;
-				}
-			}
+			// deal with rows the image resides on, copy left and right border
+			int borderSize = borderCols * 4;
+			int rightOffset = (width - borderCols) * 4;
+			memcpy(line + row * width * 4, border, borderSize);
+			memcpy(line + row * width * 4 + rightOffset, border + rightOffset, borderSize);
+			memcpy(line + (height - row - 1) * width * 4, border, borderSize);
+			memcpy(line + (height - row - 1) * width * 4 + rightOffset, border + rightOffset, borderSize);
 		}
 	}
+
+	wyFree(border);
 }
@@ -33,6 +33,9 @@
 #include "wyUtils.h"
 #include "wyLog.h"
 #include "wyDirector.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyGrabber::~wyGrabber() {
 	releaseBuffer();
@@ -121,6 +124,9 @@ void wyGrabber::beforeRender() {
 	if(m_texture == 0)
 		grab();
 
+	// draw pending quads to old frame buffer
+	gRenderQueue->flush();
+
 	// push matrix
 	glPushMatrix();
 
@@ -145,6 +151,9 @@ void wyGrabber::beforeRender() {
 }
 
 void wyGrabber::afterRender() {
+	// draw pending quads to grabbed texture
+	gRenderQueue->flush();
+
 	glBindFramebufferOES(GL_FRAMEBUFFER_OES, m_old_fbo);
 
 	// pop matrix
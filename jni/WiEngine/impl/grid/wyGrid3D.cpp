@@ -32,8 +32,13 @@
 #include "wyLog.h"
 #include "wyGlobal.h"
 #include "wyPrimitives.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 void wyGrid3D::blit() {
+	gRenderQueue->flush();
+
 	int n = m_gridX * m_gridY;
 
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -42,6 +47,7 @@ void wyGrid3D::blit() {
 	glVertexPointer(3, GL_FLOAT, 0, m_vertices);
 	glTexCoordPointer(2, GL_FLOAT, 0, m_texCoords);
 	glDrawElements(GL_TRIANGLES, n * 6, GL_UNSIGNED_SHORT, m_indices);
+	gRenderQueue->countDrawCall();
 
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -28,7 +28,9 @@
  */
 #include "wyActionManager.h"
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
+#include "wyFiniteTimeAction.h"
 #include "wyScheduler.h"
 #include "wyLog.h"
 
@@ -36,6 +38,9 @@ wyActionManager* gActionManager;
 
 extern pthread_mutex_t gMutex;
 
+// initial capacity of a tween buffer
+#define INITIAL_TWEEN_CAPACITY 32
+
 typedef struct wyActionHash {
 	// node target
 	wyNode* target;
@@ -114,7 +119,8 @@ bool wyActionManager::execAction(wyArray* arr, void* ptr, int index, void* data)
     // The 'actions' may change while inside this loop.
 	wyAction* action = (wyAction*)ptr;
 
-	if(!action->m_paused) {
+	// packed action is updated in tween buffer
+	if(!action->m_paused && action->m_tweenIndex == -1) {
 		float delta = *(float*)data;
 		action->step(delta);
 		
@@ -198,6 +204,7 @@ bool wyActionManager::sTick(void* elt, void* data) {
 					wyArrayPush(hash->actions, action);
 					action->m_paused = false;
 					action->start(hash->target);
+					gActionManager->packAction(action);
 				}
 				wyArrayClear(hash->pendingAddList);
 			}
@@ -238,6 +245,9 @@ wyActionManager::~wyActionManager() {
 	wyArrayDestroy(m_physicsNodes);
     wyArrayDestroy(m_physicsNodesPendingAdd);
     wyArrayDestroy(m_physicsNodesPendingRemove);
+	wyArrayDestroy(m_finishedTweens);
+	for(int i = 0; i < WY_TWEEN_CHANNEL_COUNT; i++)
+		wyFree(m_tweens[i]);
 	gActionManager = NULL;
 }
 
@@ -246,7 +256,16 @@ wyActionManager::wyActionManager() :
 		m_physicsNodes(wyArrayNew(10)),
 		m_physicsNodesPendingAdd(wyArrayNew(10)),
 		m_physicsNodesPendingRemove(wyArrayNew(10)),
-		m_removingAll(false) {
+		m_removingAll(false),
+		m_tweensLocked(false),
+		m_hasDeadTweens(false),
+		m_tweenEnabled(true),
+		m_finishedTweens(wyArrayNew(16)) {
+	for(int i = 0; i < WY_TWEEN_CHANNEL_COUNT; i++) {
+		m_tweens[i] = (wyTween*)wyMalloc(INITIAL_TWEEN_CAPACITY * sizeof(wyTween));
+		m_tweenCount[i] = 0;
+		m_tweenCapacity[i] = INITIAL_TWEEN_CAPACITY;
+	}
 }
 
 wyActionManager* wyActionManager::getInstance() {
@@ -305,6 +324,7 @@ void wyActionManager::addActionLocked(wyAction* action, wyNode* target) {
 			wyArrayPush(hash->actions, action);
 			action->m_paused = false;
 			action->start(target);
+			packAction(action);
 			
 			/*
 			 * 确保pending add list里面没有这个action, 如果有, 需要释放一次, 因为它在加入到
@@ -416,7 +436,7 @@ void wyActionManager::resumeActions(wyNode* target, bool includeChildren) {
 	if(hash != NULL) {
 		for(int i = 0; i < hash->actions->num; i++) {
 			wyAction* action = (wyAction*)wyArrayGet(hash->actions, i);
-			action->m_paused = false;
+			setActionPaused(action, false);
 		}
 	}
 
@@ -430,7 +450,7 @@ void wyActionManager::pauseActions(wyNode* target, bool includeChildren) {
 	if(hash != NULL) {
 		for(int i = 0; i < hash->actions->num; i++) {
 			wyAction* action = (wyAction*)wyArrayGet(hash->actions, i);
-			action->m_paused = true;
+			setActionPaused(action, true);
 		}
 	}
 
@@ -454,7 +474,7 @@ void wyActionManager::pauseActionLocked(wyNode* target, int tag) {
 
 		// if not NULL, set pause flag
 		if(action != NULL) {
-			action->m_paused = true;
+			setActionPaused(action, true);
 		}
 	}
 
@@ -476,7 +496,7 @@ void wyActionManager::resumeActionLocked(wyNode* target, int tag) {
 
 		// if not NULL, set pause flag
 		if(action != NULL) {
-			action->m_paused = false;
+			setActionPaused(action, false);
 		}
 	}
 
@@ -506,7 +526,200 @@ wyAction* wyActionManager::getAction(wyNode* target, int tag) {
 		return (wyAction*)wyArrayGet(hash->actions, index);
 }
 
+void wyActionManager::packAction(wyAction* action) {
+	// only top level action is packed, and buffer can't grow while it is being updated
+	if(!m_tweenEnabled || m_tweensLocked || action->m_parent != NULL || action->m_tweenIndex != -1)
+		return;
+
+	wyTween tween;
+	memset(&tween, 0, sizeof(wyTween));
+	if(!action->packTween(&tween))
+		return;
+
+	pthread_mutex_lock(&gMutex);
+
+	// only interval actions can be packed, so it is safe to cast
+	wyFiniteTimeAction* a = (wyFiniteTimeAction*)action;
+	tween.action = a;
+	tween.target = a->m_target;
+	tween.elapsed = a->m_elapsed;
+	tween.duration = a->m_duration;
+	tween.firstTick = a->m_firstTick;
+	tween.paused = a->m_paused;
+
+	// grow buffer
+	int c = tween.channel;
+	if(m_tweenCount[c] >= m_tweenCapacity[c]) {
+		m_tweenCapacity[c] *= 2;
+		m_tweens[c] = (wyTween*)wyRealloc(m_tweens[c], m_tweenCapacity[c] * sizeof(wyTween));
+	}
+
+	// append
+	m_tweens[c][m_tweenCount[c]] = tween;
+	action->m_tweenChannel = c;
+	action->m_tweenIndex = m_tweenCount[c];
+	m_tweenCount[c]++;
+
+	pthread_mutex_unlock(&gMutex);
+}
+
+void wyActionManager::unpackAction(wyAction* action) {
+	pthread_mutex_lock(&gMutex);
+
+	int c = action->m_tweenChannel;
+	int i = action->m_tweenIndex;
+	if(i != -1) {
+		// write state back so that action can continue from here
+		wyTween* tw = m_tweens[c] + i;
+		tw->action->m_elapsed = tw->elapsed;
+		tw->action->m_firstTick = tw->firstTick;
+		action->m_tweenChannel = -1;
+		action->m_tweenIndex = -1;
+
+		// if buffers are being updated, just mark it
+		if(m_tweensLocked) {
+			tw->dead = true;
+			m_hasDeadTweens = true;
+		} else {
+			removeTween(c, i);
+		}
+	}
+
+	pthread_mutex_unlock(&gMutex);
+}
+
+void wyActionManager::removeTween(int channel, int index) {
+	int last = --m_tweenCount[channel];
+	if(index != last) {
+		m_tweens[channel][index] = m_tweens[channel][last];
+		m_tweens[channel][index].action->m_tweenIndex = index;
+	}
+}
+
+void wyActionManager::setActionPaused(wyAction* action, bool paused) {
+	action->m_paused = paused;
+	if(action->m_tweenIndex != -1)
+		m_tweens[action->m_tweenChannel][action->m_tweenIndex].paused = paused;
+}
+
+float wyActionManager::getPackedElapsed(wyAction* action) {
+	if(action->m_tweenIndex == -1)
+		return 0;
+	else
+		return m_tweens[action->m_tweenChannel][action->m_tweenIndex].elapsed;
+}
+
+int wyActionManager::getPackedActionCount() {
+	int count = 0;
+	for(int i = 0; i < WY_TWEEN_CHANNEL_COUNT; i++)
+		count += m_tweenCount[i];
+	return count;
+}
+
+/*
+ * advance a tween and get eased time, it does same thing as wyIntervalAction::step.
+ * returns false if tween should not be updated in this frame
+ */
+static inline bool advanceTween(wyTween* tw, float delta, float* t, wyArray* finished) {
+	if(tw->paused || tw->dead || tw->done || !tw->target->isRunning())
+		return false;
+
+	if(tw->firstTick) {
+		tw->firstTick = false;
+		tw->elapsed = 0;
+	} else {
+		tw->elapsed += delta;
+	}
+	float p = MIN(1, tw->duration <= 0 ? 1 : tw->elapsed / tw->duration);
+	*t = tw->ease == NULL ? p : tw->ease(p, tw->rate);
+
+	// finished action is stopped after all buffers are updated
+	if(tw->elapsed >= tw->duration) {
+		tw->done = true;
+		wyObjectRetain(tw->action);
+		wyArrayPush(finished, tw->action);
+	}
+	return true;
+}
+
+void wyActionManager::tickTweens(float delta) {
+	pthread_mutex_lock(&gMutex);
+	m_tweensLocked = true;
+
+	// one loop for every channel, no virtual call except node setter
+	float t;
+	wyTween* tw = m_tweens[WY_TWEEN_POSITION];
+	wyTween* end = tw + m_tweenCount[WY_TWEEN_POSITION];
+	for(; tw < end; tw++) {
+		if(advanceTween(tw, delta, &t, m_finishedTweens))
+			tw->target->setPosition(tw->from[0] + tw->delta[0] * t, tw->from[1] + tw->delta[1] * t);
+	}
+
+	tw = m_tweens[WY_TWEEN_SCALE];
+	end = tw + m_tweenCount[WY_TWEEN_SCALE];
+	for(; tw < end; tw++) {
+		if(advanceTween(tw, delta, &t, m_finishedTweens)) {
+			tw->target->setScaleX(tw->from[0] + tw->delta[0] * t);
+			tw->target->setScaleY(tw->from[1] + tw->delta[1] * t);
+		}
+	}
+
+	tw = m_tweens[WY_TWEEN_ROTATION];
+	end = tw + m_tweenCount[WY_TWEEN_ROTATION];
+	for(; tw < end; tw++) {
+		if(advanceTween(tw, delta, &t, m_finishedTweens))
+			tw->target->setRotation(tw->from[0] + tw->delta[0] * t);
+	}
+
+	tw = m_tweens[WY_TWEEN_ALPHA];
+	end = tw + m_tweenCount[WY_TWEEN_ALPHA];
+	for(; tw < end; tw++) {
+		if(advanceTween(tw, delta, &t, m_finishedTweens))
+			tw->target->setAlpha((int)(tw->from[0] + tw->delta[0] * t));
+	}
+
+	tw = m_tweens[WY_TWEEN_COLOR];
+	end = tw + m_tweenCount[WY_TWEEN_COLOR];
+	for(; tw < end; tw++) {
+		if(advanceTween(tw, delta, &t, m_finishedTweens)) {
+			wyColor3B c = {
+					(GLubyte)(tw->from[0] + tw->delta[0] * t),
+					(GLubyte)(tw->from[1] + tw->delta[1] * t),
+					(GLubyte)(tw->from[2] + tw->delta[2] * t)
+			};
+			tw->target->setColor(c);
+		}
+	}
+
+	m_tweensLocked = false;
+
+	// remove records which are unpacked in update, from end so that moved record is always alive
+	if(m_hasDeadTweens) {
+		for(int c = 0; c < WY_TWEEN_CHANNEL_COUNT; c++) {
+			for(int i = m_tweenCount[c] - 1; i >= 0; i--) {
+				if(m_tweens[c][i].dead)
+					removeTween(c, i);
+			}
+		}
+		m_hasDeadTweens = false;
+	}
+
+	// stop finished actions, skip it if it is already removed
+	for(int i = 0; i < m_finishedTweens->num; i++) {
+		wyAction* action = (wyAction*)wyArrayGet(m_finishedTweens, i);
+		if(action->m_tweenIndex != -1) {
+			action->stop();
+			removeActionLocked(action);
+		}
+		wyObjectRelease(action);
+	}
+	wyArrayClear(m_finishedTweens);
+
+	pthread_mutex_unlock(&gMutex);
+}
+
 void wyActionManager::tick(float delta) {
+	tickTweens(delta);
 	wyHashSetEach(m_targets, sTick, &delta);
     
 	wyArrayEach(m_physicsNodes, sUpdateNodePhysics, &delta);
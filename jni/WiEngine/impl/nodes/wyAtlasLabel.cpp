@@ -32,6 +32,9 @@
 #include "wyZwoptexManager.h"
 #include "wyTypes.h"
 #include "wyUtils.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 #if ANDROID
 	#include "wyJNI.h"
 #endif
@@ -489,6 +492,7 @@ wyAtlasLabel::wyAtlasLabel(const char* text, wyTexture2D* tex, wyCharMap* map) :
 		m_color(wyc4bWhite) {
 	m_atlas = wyTextureAtlas::make(tex);
 	m_atlas->retain();
+	m_atlas->setUseBufferObject(true);
 
 	m_map = map;
 	m_map->retain();
@@ -524,6 +528,8 @@ void wyAtlasLabel::setColor(wyColor4B color) {
 }
 
 void wyAtlasLabel::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
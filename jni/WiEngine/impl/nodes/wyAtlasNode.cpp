@@ -29,6 +29,9 @@
 #include "wyAtlasNode.h"
 #include "wyTextureManager.h"
 #include "wyLog.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyAtlasNode::~wyAtlasNode() {
 	wyObjectRelease(m_atlas);
@@ -66,6 +69,8 @@ wyAtlasNode* wyAtlasNode::make(wyTexture2D* tex, int itemWidth, int itemHeight,
 }
 
 void wyAtlasNode::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -122,6 +127,7 @@ void wyAtlasNode::setColor(wyColor4B color) {
 void wyAtlasNode::init(wyTexture2D* tex, int itemWidth, int itemHeight, int capacity) {
 	// create texture and atlas and set
 	m_atlas = WYNEW wyTextureAtlas(tex, capacity);
+	m_atlas->setUseBufferObject(true);
 
 	m_itemWidth = itemWidth;
 	m_itemHeight = itemHeight;
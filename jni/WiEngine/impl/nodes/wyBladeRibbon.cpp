@@ -30,6 +30,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "wyLog.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 // max distance between adjacent points
 #define MAX_POINT_DISTANCE 5
@@ -169,6 +172,7 @@ typedef struct wyBlade {
 
 		// draw
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, 2 * m_pointCount);
+		gRenderQueue->countDrawCall();
 		m_drawnPointCount = m_pointCount;
 
 		// restore color
@@ -282,6 +286,8 @@ bool wyBladeRibbon::releaseBlade(wyArray* arr, void* ptr, int index, void* data)
 }
 
 void wyBladeRibbon::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
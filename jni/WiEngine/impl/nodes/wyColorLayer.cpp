@@ -30,6 +30,9 @@
 #include "wyLog.h"
 #include <stdlib.h>
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyColorLayer* wyColorLayer::make(wyColor4B color) {
 	wyColorLayer* n = WYNEW wyColorLayer(color);
@@ -90,6 +93,8 @@ wyColorLayer::~wyColorLayer() {
 }
 
 void wyColorLayer::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -104,6 +109,7 @@ void wyColorLayer::draw() {
     glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_colors);
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    gRenderQueue->countDrawCall();
 
     // Clear the vertex and color arrays
     glDisableClientState(GL_VERTEX_ARRAY);
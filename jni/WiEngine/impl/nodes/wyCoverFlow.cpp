@@ -31,6 +31,9 @@
 #include "wyTypes.h"
 #include "wyCoverFlow.h"
 #include "wyCoverFlowAction.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyCover::wyCover(wyTexture2D* tex) :
 		m_posX(0),
@@ -750,6 +753,8 @@ wyCover* wyCoverFlow::getTouchedCover(float x, float y) {
 }
 
 void wyCoverFlow::drawMesh(float ratioX, float ratioY) {
+	gRenderQueue->flush();
+
 	int stride = sizeof(SVertex);
 
     glTranslatef(m_frontCenterX, m_frontCenterY, 0);
@@ -768,9 +773,12 @@ void wyCoverFlow::drawMesh(float ratioX, float ratioY) {
 
         if(m_bMirrorEnabled) {
             glDrawElements(GL_TRIANGLES, 108, GL_UNSIGNED_SHORT, 0);
+            gRenderQueue->countDrawCall();
         } else {
             glDrawElements(GL_TRIANGLES, 48, GL_UNSIGNED_SHORT, 0);
+            gRenderQueue->countDrawCall();
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (GLvoid*)192);
+            gRenderQueue->countDrawCall();
         }
     } else {
     	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -795,9 +803,12 @@ void wyCoverFlow::drawMesh(float ratioX, float ratioY) {
 
         if(m_bMirrorEnabled) {
             glDrawElements(GL_TRIANGLES, 108, GL_UNSIGNED_SHORT, m_indicesAll);
+            gRenderQueue->countDrawCall();
         } else {
             glDrawElements(GL_TRIANGLES, 48, GL_UNSIGNED_SHORT, m_indicesAll);
+            gRenderQueue->countDrawCall();
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (GLvoid*)((char*)m_indicesAll + 192));
+            gRenderQueue->countDrawCall();
         }
     }
 }
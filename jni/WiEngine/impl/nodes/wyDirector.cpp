@@ -53,6 +53,9 @@
 #include "wyAutoReleasePool.h"
 #include "wyMath.h"
 #include "wySkeletalAnimationCache.h"
+#include "wyRenderQueue.h"
+#include "wyPathService.h"
+#include "wyTextureAtlas.h"
 
 /// global director instance
 extern wyDirector* gDirector;
@@ -83,6 +86,8 @@ extern wySPX3Manager* gSPX3Manager;
 extern wyArcticManager* gArcticManager;
 extern wyAuroraManager* gAuroraManager;
 extern wySkeletalAnimationCache* gSkeletalAnimationCache;
+extern wyRenderQueue* gRenderQueue;
+extern wyPathService* gPathService;
 
 #ifdef __cplusplus
 extern "C" {
@@ -179,6 +184,10 @@ void wyDirector::printUnreleasedMemory(bool fullLog) {
 }
 
 void wyDirector::printMemoryUsage() {
+#ifdef WY_CFLAG_SLAB_ALLOCATOR
+	wySlabUsageReport();
+#endif
+
 #ifdef WY_CFLAG_MEMORY_TRACKING
 	wyMemoryUsageReport();
 #else
@@ -242,6 +251,7 @@ wyDirector::wyDirector() :
 	wyActionManager::getInstance();
 	wyTextureManager::getInstance();
 	wyZwoptexManager::getInstance();
+	wyRenderQueue::getInstance();
 
 	// create stack
 	m_scenesStack = wyArrayNew(10);
@@ -362,8 +372,9 @@ void wyDirector::showFPS() {
 	if(m_fpsLabel == NULL)
 		return;
 
-	char buf[20];
-	sprintf(buf, "%.1f", m_frameRate);
+	// show frame rate and draw calls of last frame
+	char buf[64];
+	sprintf(buf, "%.1f / %d", m_frameRate, gRenderQueue->getLastFrameDrawCalls());
 	m_fpsLabel->setString(buf);
 	m_fpsLabel->draw();
 }
@@ -500,9 +511,17 @@ void wyDirector::drawFrame() {
 	// need check texture?
 	if(m_needCheckTexture) {
 		gTextureManager->invalidateAllTextures();
+		wyTextureAtlas::invalidateAllBuffers();
 		m_needCheckTexture = false;
 	}
 
+	// upload textures which are decoded asynchronously
+	gTextureManager->processAsyncUploads();
+
+	// deliver results of asynchronous path requests
+	if(gPathService != NULL)
+		gPathService->dispatchResults();
+
 	// set default state
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
@@ -540,7 +559,9 @@ void wyDirector::drawFrame() {
 		// draw the scene
 		if(m_runningScene != NULL) {
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			gRenderQueue->beginFrame();
 			m_runningScene->visit();
+			gRenderQueue->endFrame();
 		}
 
 		/*
@@ -643,6 +664,8 @@ void wyDirector::commonDestroy() {
 	wyObjectRelease(gArcticManager);
 	wyObjectRelease(gAuroraManager);
 	wyObjectRelease(gSkeletalAnimationCache);
+	wyObjectRelease(gRenderQueue);
+	wyObjectRelease(gPathService);
 	wyBitmapFont::unloadAll();
     wyToast::clear();
 
@@ -945,6 +968,9 @@ void wyDirector::pushClipRect(wyRect& rect) {
 		m_clipStack = (wyRect*)wyRealloc(m_clipStack, m_clipStackCapacity * sizeof(wyRect));
 	}
 
+	// quads before clip shouldn't be clipped
+	gRenderQueue->flush();
+
 	// enable scissor if this is first clip rect
 	if(m_clipStackCount == 0) {
 		glEnable(GL_SCISSOR_TEST);
@@ -962,6 +988,9 @@ void wyDirector::popClipRect() {
 	if(m_clipStackCount <= 0)
 		return;
 
+	// draw pending quads with current clip rect
+	gRenderQueue->flush();
+
 	// decrease count
 	m_clipStackCount--;
 
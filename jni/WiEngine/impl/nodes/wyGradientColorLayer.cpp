@@ -32,6 +32,9 @@
 #include <stdlib.h>
 #include <math.h>
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyGradientColorLayer* wyGradientColorLayer::make(wyColor4B fromColor, wyColor4B toColor, int degree) {
 	wyGradientColorLayer* n = WYNEW wyGradientColorLayer(fromColor, toColor, degree);
@@ -218,6 +221,8 @@ int wyGradientColorLayer::getDegree() {
 }
 
 void wyGradientColorLayer::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if (m_noDraw) {
@@ -235,6 +240,7 @@ void wyGradientColorLayer::draw() {
 	glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_colors);
 
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	gRenderQueue->countDrawCall();
 
 	// Clear the vertex and color arrays
 	glDisableClientState(GL_VERTEX_ARRAY);
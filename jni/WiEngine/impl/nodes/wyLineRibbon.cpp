@@ -29,6 +29,9 @@
 #include "wyLineRibbon.h"
 #include "wyLog.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 /**
  * @typedef wyStraightLine
@@ -201,6 +204,7 @@ typedef struct wyStraightLine {
 		glVertexPointer(3, GL_FLOAT, 0, (GLvoid*)m_vertices);
 		glTexCoordPointer(2, GL_FLOAT, 0, (GLvoid*)m_texCoords);
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, 8);
+		gRenderQueue->countDrawCall();
 	}
 } wyStraightLine;
 
@@ -279,6 +283,7 @@ typedef struct wyLine {
 			glVertexPointer(3, GL_FLOAT, 0, (GLvoid*)m_jointVertices);
 			glTexCoordPointer(2, GL_FLOAT, 0, (GLvoid*)m_jointTexCoords);
 			glDrawArrays(GL_TRIANGLES, 0, 6 * (m_straightLines->num - 1));
+			gRenderQueue->countDrawCall();
 		}
 	}
 
@@ -474,6 +479,8 @@ void wyLineRibbon::setColor(wyColor4B color) {
 }
 
 void wyLineRibbon::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -30,6 +30,9 @@
 #include <stdlib.h>
 #include "wyLog.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyNinePatchSprite* wyNinePatchSprite::make(wyTexture2D* tex, wyRect patchRect) {
 	return make(tex, wyr(0, 0, tex->getWidth(), tex->getHeight()), patchRect);
@@ -204,6 +207,8 @@ void wyNinePatchSprite::updateAtlas() {
 }
 
 void wyNinePatchSprite::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -36,6 +36,7 @@
 #include "wyEventDispatcher.h"
 #include "wyParallaxObject.h"
 #include "wyLog.h"
+#include "wyRenderQueue.h"
 #if ANDROID
 	#include "wyJNI.h"
 #endif
@@ -46,6 +47,7 @@ extern wyScheduler* gScheduler;
 extern wyEventDispatcher* gEventDispatcher;
 extern wyActionManager* gActionManager;
 extern wyDirector* gDirector;
+extern wyRenderQueue* gRenderQueue;
 
 #if ANDROID
 
@@ -219,6 +221,7 @@ int wyNode::reorderChild(wyNode* child, int z) {
 	int index = wyArrayIndexOf(m_children, child, NULL, NULL);
 	if(index != -1) {
 		child->m_parent = NULL;
+		child->setWorldTransformDirty();
 		wyArrayDeleteIndex(m_children, index);
 	} else {
 		LOGW("wyNode::reorderChild: you want to reorder a child whose parent is not this?");
@@ -245,6 +248,7 @@ int wyNode::insertChild(wyNode* n, int z) {
 	// save z order and parent
 	n->m_zOrder = z;
 	n->m_parent = this;
+	n->setWorldTransformDirty();
 
 	return index;
 }
@@ -330,6 +334,7 @@ void wyNode::removeChild(wyNode* child, bool cleanup) {
 			child->cleanup();
 
 		child->m_parent = NULL;
+		child->setWorldTransformDirty();
 		wyArrayDeleteIndex(m_children, index);
 		wyObjectRelease(child);
 	}
@@ -342,6 +347,7 @@ void wyNode::draw() {
 #if ANDROID
 	// if java layer implemention is set, callback
 	if(m_jVirtualMethods != NULL && g_mid_INodeVirtualMethods_jDraw != 0) {
+		gRenderQueue->flush();
 		JNIEnv* env = getEnv();
 		env->CallVoidMethod(m_jVirtualMethods, g_mid_INodeVirtualMethods_jDraw);
 	}
@@ -364,6 +370,9 @@ void wyNode::visit() {
 		transform();
 	}
 
+	// mirror opengl matrix in render queue, grid, camera and vertex z can't be batched
+	gRenderQueue->pushNode(this, !hasGrid && m_camera == NULL && m_vertexZ == 0);
+
 	// check clip
 	if(m_hasClip)
 		doClip();
@@ -377,7 +386,9 @@ void wyNode::visit() {
 			break;
 	}
 
-	// draw self
+	// draw self, quads queued before must be rendered first if node draws by itself
+	if(!m_batchDraw)
+		gRenderQueue->flush();
 	draw();
 
 	// draw children whose z order is larger than zero
@@ -391,6 +402,9 @@ void wyNode::visit() {
 	if(m_hasClip && gDirector)
 		gDirector->popClipRect();
 
+	// pop render queue matrix
+	gRenderQueue->popNode();
+
 	// if grid is set, end grid
 	if(hasGrid) {
 		m_grid->afterDraw(this);
@@ -401,6 +415,14 @@ void wyNode::visit() {
 }
 
 void wyNode::transform() {
+	// if no camera and vertex z, cached matrix is equal to following steps, so
+	// use it and matrix is calculated only when node is changed
+	if(m_camera == NULL && m_vertexZ == 0) {
+		updateNodeToParentTransform();
+		glMultMatrixf(m_transformGLMatrix);
+		return;
+	}
+
 	// translate
 	if(m_relativeAnchorPoint) {
 		glTranslatef(-m_anchorPointX, -m_anchorPointY, m_vertexZ);
@@ -879,6 +901,7 @@ void wyNode::removeAllChildren(bool cleanup) {
 			child->cleanup();
 
 		child->m_parent = NULL;
+		child->setWorldTransformDirty();
 		wyObjectRelease(child);
 	}
 	wyArrayClear(m_children);
@@ -1055,6 +1078,10 @@ wyNode::wyNode() :
 		m_inverseMatrix(wyaZero),
 		m_transformDirty(true),
 		m_inverseDirty(true),
+		m_worldMatrix(wyaZero),
+		m_worldInverseMatrix(wyaZero),
+		m_worldDirty(true),
+		m_worldInverseDirty(true),
 		m_enabled(true),
 		m_selected(false),
 		m_focused(false),
@@ -1099,6 +1126,7 @@ wyNode::wyNode() :
 		m_hasClip(false),
 		m_clipRect(wyrZero),
 		m_clipRelativeToSelf(false),
+		m_batchDraw(false),
 		m_children(wyArrayNew(3)),
 		m_grid(NULL),
 		m_camera(NULL),
@@ -1160,8 +1188,7 @@ void wyNode::clearPid(int pid) {
 
 void wyNode::setRelativeAnchorPoint(bool flag) {
 	m_relativeAnchorPoint = flag;
-	m_transformDirty = true;
-	m_inverseDirty = true;
+	setTransformDirty();
 }
 
 void wyNode::updateNodeToParentTransform() {
@@ -1191,6 +1218,9 @@ void wyNode::updateNodeToParentTransform() {
 		if(m_anchorPointX != 0 || m_anchorPointY != 0)
 			wyaTranslate(&m_transformMatrix, -m_anchorPointX, -m_anchorPointY);
 
+		// opengl matrix used by transform
+		wyaToGL(m_transformMatrix, m_transformGLMatrix);
+
 		m_transformDirty = false;
 	}
 }
@@ -1204,22 +1234,47 @@ void wyNode::updateParentToNodeTransform() {
 	}
 }
 
-wyAffineTransform wyNode::getNodeToWorldTransform() {
-	updateNodeToParentTransform();
-	wyAffineTransform t = m_transformMatrix;
+void wyNode::updateNodeToWorldTransform() {
+	if(m_worldDirty) {
+		updateNodeToParentTransform();
+		m_worldMatrix = m_transformMatrix;
 
-	for(wyNode* p = m_parent; p != NULL; p = p->m_parent) {
-		p->updateNodeToParentTransform();
-		wyaConcat(&t, &(p->m_transformMatrix));
+		// parent world matrix must be clean before this node is clean
+		if(m_parent != NULL) {
+			m_parent->updateNodeToWorldTransform();
+			wyaConcat(&m_worldMatrix, &(m_parent->m_worldMatrix));
+		}
+
+		m_worldDirty = false;
 	}
+}
 
-	return t;
+void wyNode::setWorldTransformDirty() {
+	// if already dirty, all descendants are dirty too
+	if(m_worldDirty)
+		return;
+
+	m_worldDirty = true;
+	m_worldInverseDirty = true;
+	for(int i = 0; i < m_children->num; i++) {
+		wyNode* child = (wyNode*)wyArrayGet(m_children, i);
+		child->setWorldTransformDirty();
+	}
+}
+
+wyAffineTransform wyNode::getNodeToWorldTransform() {
+	updateNodeToWorldTransform();
+	return m_worldMatrix;
 }
 
 wyAffineTransform wyNode::getWorldToNodeTransform() {
-	wyAffineTransform t = getNodeToWorldTransform();
-	wyaInverse(&t);
-	return t;
+	if(m_worldInverseDirty) {
+		updateNodeToWorldTransform();
+		m_worldInverseMatrix = m_worldMatrix;
+		wyaInverse(&m_worldInverseMatrix);
+		m_worldInverseDirty = false;
+	}
+	return m_worldInverseMatrix;
 }
 
 wyAffineTransform wyNode::getNodeToAncestorTransform(wyNode* ancestor) {
@@ -1248,6 +1303,7 @@ wyAffineTransform wyNode::getTransformMatrix() {
 void wyNode::setTransformDirty() {
 	m_transformDirty = true;
 	m_inverseDirty = true;
+	setWorldTransformDirty();
 }
 
 float wyNode::getScale() {
@@ -32,6 +32,9 @@
 #include "wyLog.h"
 #include "wyTypes.h"
 #include "wyUtils.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 #define PROGRESS_TEXTURE_COORDS_COUNT 4
 #define PROGRESS_TEXTURE_COORDS 0x1e
@@ -497,6 +500,8 @@ void wyProgressTimer::updateProgress() {
 }
 
 void wyProgressTimer::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -536,8 +541,10 @@ void wyProgressTimer::draw() {
 	// draw
 	if(m_style == RADIAL_CCW || m_style == RADIAL_CW) {
 		glDrawArrays(GL_TRIANGLE_FAN, 0, m_vertexCount);
+		gRenderQueue->countDrawCall();
 	} else if(m_style == HORIZONTAL_BAR_LR || m_style == HORIZONTAL_BAR_RL || m_style == VERTICAL_BAR_BT || m_style == VERTICAL_BAR_TB) {
 		glDrawArrays(GL_TRIANGLE_STRIP, 0, m_vertexCount);
+		gRenderQueue->countDrawCall();
 	}
 
 	if(newBlend)
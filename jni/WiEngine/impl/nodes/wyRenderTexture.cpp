@@ -33,8 +33,13 @@
 #include "wyLog.h"
 #include "wyGlobal.h"
 #include "wyDirector.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 void wyRenderTexture::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -209,6 +214,11 @@ void wyRenderTexture::beginRender(float r, float g, float b, float a) {
 }
 
 void wyRenderTexture::beginRender() {
+	// draw pending quads to old frame buffer, and nodes rendered to
+	// this texture can't be batched because matrix is changed
+	gRenderQueue->flush();
+	gRenderQueue->pushNode(NULL, false);
+
 	// push matrix
 	glPushMatrix();
 
@@ -229,6 +239,10 @@ void wyRenderTexture::beginRender() {
 }
 
 void wyRenderTexture::endRender() {
+	// draw pending quads to this texture
+	gRenderQueue->flush();
+	gRenderQueue->popNode();
+
 	// bind buffer
 	glBindFramebufferOES(GL_FRAMEBUFFER_OES, m_old_fbo);
 
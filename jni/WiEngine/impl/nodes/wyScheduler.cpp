@@ -28,12 +28,171 @@
  */
 #include "wyScheduler.h"
 #include <stdlib.h>
+#include <math.h>
+#include <stdint.h>
 #include <pthread.h>
 #include "wyLog.h"
 
 wyScheduler* gScheduler;
 
-extern pthread_mutex_t gMutex;
+/*
+ * timer wheel, it has WHEEL_LEVELS levels and every level has WHEEL_SIZE slots. A slot of
+ * level n covers WHEEL_SIZE^n ticks, timers in higher level are cascaded to lower level
+ * when current tick reaches their range
+ */
+
+#define WHEEL_LEVELS 4
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+
+// max ticks a wheel can cover, later timers are put in last slot and cascaded again
+#define WHEEL_RANGE (1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+// tick length of time wheel, in seconds
+#define TIME_TICK 0.01
+
+// initial bucket count is 1 << INITIAL_BUCKET_BITS
+#define INITIAL_BUCKET_BITS 6
+
+struct wyTimerWheel {
+	/// length of one tick, in unit of wheel
+	double tickLength;
+
+	/// current tick, all slots before it are processed
+	unsigned int current;
+
+	/// slots, every slot is a list head
+	wyTimerLink slots[WHEEL_LEVELS][WHEEL_SIZE];
+};
+
+static inline void listInit(wyTimerLink* head) {
+	head->prev = head;
+	head->next = head;
+	head->timer = NULL;
+	head->deadline = 0;
+}
+
+static inline bool listEmpty(wyTimerLink* head) {
+	return head->next == head;
+}
+
+static inline void listAppend(wyTimerLink* head, wyTimerLink* link) {
+	link->prev = head->prev;
+	link->next = head;
+	head->prev->next = link;
+	head->prev = link;
+}
+
+static inline void listRemove(wyTimerLink* link) {
+	if(link->next != NULL) {
+		link->prev->next = link->next;
+		link->next->prev = link->prev;
+		link->prev = NULL;
+		link->next = NULL;
+	}
+}
+
+static wyTimerWheel* wheelNew(double tickLength) {
+	wyTimerWheel* w = (wyTimerWheel*)wyMalloc(sizeof(wyTimerWheel));
+	w->tickLength = tickLength;
+	w->current = 0;
+	for(int i = 0; i < WHEEL_LEVELS; i++) {
+		for(int j = 0; j < WHEEL_SIZE; j++) {
+			listInit(&w->slots[i][j]);
+		}
+	}
+	return w;
+}
+
+static inline unsigned int wheelTickOf(wyTimerWheel* w, double value) {
+	return (unsigned int)floor(value / w->tickLength);
+}
+
+static void wheelInsert(wyTimerWheel* w, wyTimerLink* link) {
+	unsigned int tick = wheelTickOf(w, link->deadline);
+	int diff = (int)(tick - w->current);
+
+	// expired timer goes to current slot
+	if(diff < 0) {
+		tick = w->current;
+		diff = 0;
+	} else if(diff >= WHEEL_RANGE) {
+		tick = w->current + WHEEL_RANGE - 1;
+		diff = WHEEL_RANGE - 1;
+	}
+
+	// find level
+	int level = 0;
+	while(diff >= WHEEL_SIZE) {
+		diff >>= WHEEL_BITS;
+		level++;
+	}
+
+	listAppend(&w->slots[level][(tick >> (level * WHEEL_BITS)) & WHEEL_MASK], link);
+}
+
+/*
+ * move timers in a slot to lower level, return index of the slot so caller
+ * knows whether higher level needs to be cascaded
+ */
+static int wheelCascade(wyTimerWheel* w, int level) {
+	int index = (w->current >> (level * WHEEL_BITS)) & WHEEL_MASK;
+	wyTimerLink* head = &w->slots[level][index];
+
+	// detach list first because timer may be inserted to same slot again
+	wyTimerLink list;
+	listInit(&list);
+	if(!listEmpty(head)) {
+		list.next = head->next;
+		list.prev = head->prev;
+		list.next->prev = &list;
+		list.prev->next = &list;
+		listInit(head);
+	}
+
+	while(!listEmpty(&list)) {
+		wyTimerLink* link = list.next;
+		listRemove(link);
+		wheelInsert(w, link);
+	}
+
+	return index;
+}
+
+/// move timers whose deadline is not later than now from a slot to expired list
+static void wheelCollect(wyTimerLink* head, double now, wyTimerLink* expired) {
+	wyTimerLink* link = head->next;
+	while(link != head) {
+		wyTimerLink* next = link->next;
+		if(link->deadline <= now) {
+			listRemove(link);
+			listAppend(expired, link);
+		}
+		link = next;
+	}
+}
+
+/// advance wheel to now and collect expired timers
+static void wheelAdvance(wyTimerWheel* w, double now, wyTimerLink* expired) {
+	// current slot may have timers which were not due in last advance
+	wheelCollect(&w->slots[0][w->current & WHEEL_MASK], now, expired);
+
+	unsigned int target = wheelTickOf(w, now);
+	while((int)(target - w->current) > 0) {
+		w->current++;
+
+		// cascade higher levels when lower level wraps
+		if((w->current & WHEEL_MASK) == 0) {
+			for(int level = 1; level < WHEEL_LEVELS; level++) {
+				if(wheelCascade(w, level) != 0)
+					break;
+			}
+		}
+
+		wheelCollect(&w->slots[0][w->current & WHEEL_MASK], now, expired);
+	}
+}
 
 wyTimer::~wyTimer() {
 	wyObjectRelease(m_targetSelector);
@@ -49,7 +208,18 @@ wyTimer::wyTimer(wyTargetSelector* ts) :
 		m_maxInvocation(0),
 		m_paused(false),
 		m_pendingRemove(false),
-		m_done(false) {
+		m_done(false),
+		m_scheduled(false),
+		m_parked(false),
+		m_hashNext(NULL),
+		m_lastFireTime(0),
+		m_lastFireFrame(0),
+		m_pauseTime(0),
+		m_pauseFrame(0) {
+	m_link.prev = NULL;
+	m_link.next = NULL;
+	m_link.timer = this;
+	m_link.deadline = 0;
 	wyObjectRetain(ts);
 }
 
@@ -63,7 +233,18 @@ wyTimer::wyTimer(wyTargetSelector* ts, float interval) :
 		m_maxInvocation(0),
 		m_paused(false),
 		m_pendingRemove(false),
-		m_done(false) {
+		m_done(false),
+		m_scheduled(false),
+		m_parked(false),
+		m_hashNext(NULL),
+		m_lastFireTime(0),
+		m_lastFireFrame(0),
+		m_pauseTime(0),
+		m_pauseFrame(0) {
+	m_link.prev = NULL;
+	m_link.next = NULL;
+	m_link.timer = this;
+	m_link.deadline = 0;
 	wyObjectRetain(ts);
 }
 
@@ -77,7 +258,18 @@ wyTimer::wyTimer(wyTargetSelector* ts, int frame) :
 		m_maxInvocation(0),
 		m_paused(false),
 		m_pendingRemove(false),
-		m_done(false) {
+		m_done(false),
+		m_scheduled(false),
+		m_parked(false),
+		m_hashNext(NULL),
+		m_lastFireTime(0),
+		m_lastFireFrame(0),
+		m_pauseTime(0),
+		m_pauseFrame(0) {
+	m_link.prev = NULL;
+	m_link.next = NULL;
+	m_link.timer = this;
+	m_link.deadline = 0;
 	wyObjectRetain(ts);
 }
 
@@ -107,6 +299,35 @@ void wyTimer::setInterval(float interval) {
 	m_interval = interval;
 	if(m_interval > 0.0f)
 		m_frame = 0;
+
+	// deadline must be recalculated
+	if(m_scheduled && gScheduler != NULL)
+		gScheduler->pushCommand(this, wyScheduler::TC_UPDATE);
+}
+
+void wyTimer::setFrame(int frame) {
+	m_frame = frame;
+
+	// deadline must be recalculated
+	if(m_scheduled && gScheduler != NULL)
+		gScheduler->pushCommand(this, wyScheduler::TC_UPDATE);
+}
+
+void wyTimer::setPaused(bool flag) {
+	if(m_paused != flag) {
+		m_paused = flag;
+
+		// scheduler moves it between wheel and paused list
+		if(m_scheduled && gScheduler != NULL)
+			gScheduler->pushCommand(this, wyScheduler::TC_UPDATE);
+	}
+}
+
+float wyTimer::getElapsed() {
+	if(m_scheduled && gScheduler != NULL)
+		return gScheduler->getTimerElapsed(this);
+	else
+		return m_elapsed;
 }
 
 bool wyTimerEquals(void* ptr1, void* ptr2, void* data) {
@@ -143,23 +364,44 @@ void wyTimer::reset() {
 	m_elapsedFrame = 0;
 	m_counter = 0;
 	m_done = false;
+
+	// restart from now
+	if(m_scheduled && gScheduler != NULL)
+		gScheduler->pushCommand(this, wyScheduler::TC_RESET);
 }
 
 wyScheduler::~wyScheduler() {
-	wyArrayEach(m_timersToRemove, releaseTimer, NULL);
-	wyArrayEach(m_timersToAdd, releaseTimer, NULL);
-	wyArrayEach(m_scheduledTimers, releaseTimer, NULL);
-	wyArrayDestroy(m_timersToRemove);
-	wyArrayDestroy(m_timersToAdd);
-	wyArrayDestroy(m_scheduledTimers);
+	releaseCommands(m_pendingCommands);
+	releaseCommands(m_commandsBuffer);
+
+	// release all scheduled timers
+	int bucketCount = 1 << m_bucketBits;
+	for(int i = 0; i < bucketCount; i++) {
+		while(m_buckets[i] != NULL) {
+			removeTimer(m_buckets[i]);
+		}
+	}
+
+	wyFree(m_buckets);
+	wyFree(m_timeWheel);
+	wyFree(m_frameWheel);
+	pthread_mutex_destroy(&m_pendingMutex);
 	gScheduler = NULL;
 }
 
 wyScheduler::wyScheduler() :
-		m_scheduledTimers(wyArrayNew(10)),
-		m_timersToAdd(wyArrayNew(10)),
-		m_timersToRemove(wyArrayNew(10)),
+		m_timeWheel(wheelNew(TIME_TICK)),
+		m_frameWheel(wheelNew(1)),
+		m_buckets((wyTimer**)wyCalloc(1 << INITIAL_BUCKET_BITS, sizeof(wyTimer*))),
+		m_bucketBits(INITIAL_BUCKET_BITS),
+		m_timerCount(0),
+		m_time(0),
+		m_frames(0),
 		m_timeScale(1.f) {
+	listInit(&m_pausedTimers);
+	pthread_mutex_init(&m_pendingMutex, NULL);
+	m_pendingCommands.reserve(16);
+	m_commandsBuffer.reserve(16);
 }
 
 wyScheduler* wyScheduler::getInstance() {
@@ -169,111 +411,239 @@ wyScheduler* wyScheduler::getInstance() {
 	return gScheduler;
 }
 
-bool wyScheduler::removeTimers(wyArray* arr, void* ptr, int index, void* data) {
-	wyTimer* t = (wyTimer*)ptr;
-	wyTimer* timer = (wyTimer*)wyArrayDeleteObj(gScheduler->getScheduledTimers(), t, wyTimerEquals, NULL);
-	wyObjectRelease(timer);
-	return true;
+/// hash of timer, it must be same for timers which are equal
+static inline unsigned int timerHash(wyTimer* t, int bits) {
+	return (t->getTargetSelector()->hash() * 2654435761u) >> (32 - bits);
+}
+
+wyTimer* wyScheduler::findTimer(wyTimer* t) {
+	if(t->m_scheduled)
+		return t;
+
+	for(wyTimer* c = m_buckets[timerHash(t, m_bucketBits)]; c != NULL; c = c->m_hashNext) {
+		if(wyTimerEquals(c, t, NULL))
+			return c;
+	}
+	return NULL;
+}
+
+void wyScheduler::growBuckets() {
+	int oldCount = 1 << m_bucketBits;
+	wyTimer** oldBuckets = m_buckets;
+	m_bucketBits++;
+	m_buckets = (wyTimer**)wyCalloc(1 << m_bucketBits, sizeof(wyTimer*));
+
+	// rehash
+	for(int i = 0; i < oldCount; i++) {
+		wyTimer* t = oldBuckets[i];
+		while(t != NULL) {
+			wyTimer* next = t->m_hashNext;
+			unsigned int h = timerHash(t, m_bucketBits);
+			t->m_hashNext = m_buckets[h];
+			m_buckets[h] = t;
+			t = next;
+		}
+	}
+	wyFree(oldBuckets);
 }
 
-bool wyScheduler::addTimers(wyArray* arr, void* ptr, int index, void* data) {
-	wyTimer* t = (wyTimer*)ptr;
-	wyArrayPush(gScheduler->getScheduledTimers(), t);
+void wyScheduler::addTimer(wyTimer* t) {
 	wyObjectRetain(t);
-	return true;
+
+	// add to hash table
+	if(m_timerCount >= (1 << m_bucketBits))
+		growBuckets();
+	unsigned int h = timerHash(t, m_bucketBits);
+	t->m_hashNext = m_buckets[h];
+	m_buckets[h] = t;
+	m_timerCount++;
+
+	// timer starts from now
+	t->m_scheduled = true;
+	t->m_parked = false;
+	t->m_lastFireTime = m_time;
+	t->m_lastFireFrame = m_frames;
+	relinkTimer(t, false);
 }
 
-bool wyScheduler::releaseTimer(wyArray* arr, void* ptr, int index, void* data) {
-	wyTimer* t = (wyTimer*)ptr;
+void wyScheduler::removeTimer(wyTimer* t) {
+	// remove from hash table
+	wyTimer** link = &m_buckets[timerHash(t, m_bucketBits)];
+	while(*link != NULL) {
+		if(*link == t) {
+			*link = t->m_hashNext;
+			break;
+		}
+		link = &(*link)->m_hashNext;
+	}
+	t->m_hashNext = NULL;
+	m_timerCount--;
+
+	// remove from wheel or paused list
+	listRemove(&t->m_link);
+	t->m_scheduled = false;
+	t->m_parked = false;
 	t->m_pendingRemove = false;
 	wyObjectRelease(t);
-	return true;
 }
 
-bool wyScheduler::fire(wyArray* arr, void* ptr, int index, void* data) {
-	wyTimer* t = (wyTimer*)ptr;
-	if (t->m_done || t->m_paused) {
-		return true;
+void wyScheduler::insertTimer(wyTimer* t) {
+	if(t->m_frame > 0 || t->m_interval <= 0) {
+		// frame mode, zero interval means every frame
+		int period = t->m_frame > 0 ? t->m_frame : 1;
+		t->m_link.deadline = t->m_lastFireFrame + period;
+		wheelInsert(m_frameWheel, &t->m_link);
+	} else {
+		t->m_link.deadline = t->m_lastFireTime + t->m_interval;
+		wheelInsert(m_timeWheel, &t->m_link);
+	}
+}
+
+void wyScheduler::relinkTimer(wyTimer* t, bool reset) {
+	listRemove(&t->m_link);
+
+	if(t->m_parked && !t->m_paused) {
+		// resumed, paused duration is not counted
+		t->m_lastFireTime += m_time - t->m_pauseTime;
+		t->m_lastFireFrame += m_frames - t->m_pauseFrame;
+		t->m_parked = false;
+	} else if(!t->m_parked && t->m_paused) {
+		// paused, remember when
+		t->m_pauseTime = m_time;
+		t->m_pauseFrame = m_frames;
+		t->m_parked = true;
+	}
+
+	// reset means timer starts from now
+	if(reset) {
+		t->m_lastFireTime = t->m_parked ? t->m_pauseTime : m_time;
+		t->m_lastFireFrame = t->m_parked ? t->m_pauseFrame : m_frames;
 	}
-	float delta = *(float*)data;
 
+	// paused timer is not in wheel so it costs nothing
+	if(t->m_parked)
+		listAppend(&m_pausedTimers, &t->m_link);
+	else
+		insertTimer(t);
+}
+
+void wyScheduler::fireTimer(wyTimer* t) {
 	/*
 	 * 检查pending remove的标识，如果timer已经处于pending remove队列，则不进行调度。
 	 * 这是因为有可能出现某个timer在被调度时，其已经被加入到pending remove队列。被
 	 * 加入到pending remove队列倒不是一个很严重的事，但是这有可能表明timer的callback对象
 	 * 已经被销毁，因此为了安全起见，对于这种timer不调度为好。
 	 */
-	if(!t->m_pendingRemove)
-		t->fire(delta);
+	if(t->m_pendingRemove) {
+		insertTimer(t);
+		return;
+	}
+
+	/*
+	 * timer may be paused by an earlier callback of this tick, for example its target is paused.
+	 * Its update command is applied in next tick, so park it now instead of firing it
+	 */
+	if(t->m_paused) {
+		relinkTimer(t, false);
+		return;
+	}
 
-	if(t->getMaxInvocation() > 0 && t->getCurrentInvocationCount() >= t->getMaxInvocation()) {
-		wyTimer* timer = (wyTimer*)wyArrayDeleteObj(gScheduler->getTimersToAdd(), t, wyTimerEquals, NULL);
-		wyArrayPush(gScheduler->getTimersToRemove(), t);
-		t->m_pendingRemove = true;
+	// invoke, paused time is already excluded from elapsed time
+	t->m_counter++;
+	t->m_targetSelector->setDelta(m_time - t->m_lastFireTime);
+	t->m_targetSelector->invoke();
+	t->m_lastFireTime = m_time;
+	t->m_lastFireFrame = m_frames;
+
+	// finished timer is removed at once, otherwise wait for next deadline
+	if(t->m_maxInvocation > 0 && t->m_counter >= t->m_maxInvocation) {
 		t->m_done = true;
-		wyObjectRetain(t);
-		wyObjectRelease(timer);
+		removeTimer(t);
+	} else {
+		insertTimer(t);
 	}
+}
 
-	return true;
+float wyScheduler::getTimerElapsed(wyTimer* t) {
+	return (t->m_parked ? t->m_pauseTime : m_time) - t->m_lastFireTime;
 }
 
-void wyScheduler::scheduleLocked(wyTimer* t) {
-	pthread_mutex_lock(&gMutex);
+void wyScheduler::pushCommand(wyTimer* t, wyTimerCommandType type) {
+	wyTimerCommand c;
+	c.timer = t;
+	c.type = type;
+	wyObjectRetain(t);
+
+	pthread_mutex_lock(&m_pendingMutex);
+	m_pendingCommands.push_back(c);
+	pthread_mutex_unlock(&m_pendingMutex);
+}
+
+void wyScheduler::releaseCommands(TimerCommandList& list) {
+	for(TimerCommandList::iterator iter = list.begin(); iter != list.end(); iter++) {
+		wyObjectRelease(iter->timer);
+	}
+	list.clear();
+}
 
+void wyScheduler::scheduleLocked(wyTimer* t) {
 	/*
-	 * 这里我们首先检查要添加的timer是否处于pending remove中, 如果存在的话, 要继续判断是否指针相同,
-	 * 如果完全相同, 则从pending remove中删除, 如果指针不同, 还是要添加到pending add中.
+	 * 请求按调用顺序保存, 在OpenGL线程中依次执行, 因此先删除后添加的timer不会被误判为已经调度.
 	 *
-	 * 这么做的原因是:
 	 * 假设有一个节点A, 如果A创建了一个timer叫tA, 那么如果在运行时删掉A, 再创建一个新的A示例, 假设叫
-	 * A', 那么它的timer叫tA', 代码一般不会认为tA和tA'相等, 从而tA得到删除, tA'得到调度, 这是正常结果.
-	 * 但是, 在某些情况下, 由于A事先已被删除, 内存已被释放, 后面创建的A'的地址偶尔会和A相同, 这样的情况下,
-	 * tA'和tA会被认为相同, 于是tA不会被删除, tA'也不会被调度, 但是由于A已经被释放, 导致tA在下次调度时崩溃.
-	 *
-	 * 为了解决这个问题, 多进行一次指针判断, 仅当指针完全相同时才从pending remove中删除.
+	 * A', 那么它的timer叫tA', 由于A事先已被删除, 内存已被释放, 后面创建的A'的地址偶尔会和A相同, 这样的情况下,
+	 * tA'和tA会被认为相同. 由于删除tA的请求一定在添加tA'的请求之前执行, 因此tA会被删除, tA'会被调度.
 	 */
-	int index = wyArrayIndexOf(m_timersToRemove, t, wyTimerEquals, NULL);
-	if(index >= 0) {
-		wyTimer* timer = (wyTimer*)wyArrayGet(m_timersToRemove, index);
-		bool exactlySame = t == timer;
-		if(exactlySame) {
-			wyTimer* timer = (wyTimer*)wyArrayDeleteIndex(m_timersToRemove, index);
-			timer->m_pendingRemove = false;
-			wyObjectRelease(timer);
-		} else {
-			wyArrayPush(m_timersToAdd, t);
-			wyObjectRetain(t);
-		}
-	} else if(wyArrayIndexOf(m_scheduledTimers, t, wyTimerEquals, NULL) >= 0 ||
-			wyArrayIndexOf(m_timersToAdd, t, wyTimerEquals, NULL) >= 0) {
-		LOGW("Scheduler.schedulerTimer: timer already scheduled");
-	} else {
-		wyArrayPush(m_timersToAdd, t);
-		wyObjectRetain(t);
-	}
-
-	pthread_mutex_unlock(&gMutex);
+	t->m_pendingRemove = false;
+	pushCommand(t, TC_SCHEDULE);
 }
 
 void wyScheduler::unscheduleLocked(wyTimer* t) {
-	pthread_mutex_lock(&gMutex);
-
-	// someone wants to remove it before it was added
-	int index = wyArrayIndexOf(m_timersToAdd, t, wyTimerEquals, NULL);
-	if(index >= 0) {
-		wyTimer* timer = (wyTimer*)wyArrayDeleteIndex(m_timersToAdd, index);
-		wyObjectRelease(timer);
-	} else if(wyArrayIndexOf(m_scheduledTimers, t, wyTimerEquals, NULL) == -1) {
-		if(!t->isOneShot())
-			LOGW("Scheduler.unscheduleTimer: timer not scheduled");
-	} else {
-		wyArrayPush(m_timersToRemove, t);
-		t->m_pendingRemove = true;
-		wyObjectRetain(t);
-	}
+	// mark it so that it won't be fired before it is removed
+	t->m_pendingRemove = true;
+	pushCommand(t, TC_UNSCHEDULE);
+}
 
-	pthread_mutex_unlock(&gMutex);
+void wyScheduler::applyPendingCommands() {
+	// swap command list, skip if other thread is appending
+	if(pthread_mutex_trylock(&m_pendingMutex) != 0)
+		return;
+	m_pendingCommands.swap(m_commandsBuffer);
+	pthread_mutex_unlock(&m_pendingMutex);
+
+	// apply commands in order
+	for(TimerCommandList::iterator iter = m_commandsBuffer.begin(); iter != m_commandsBuffer.end(); iter++) {
+		wyTimer* t = iter->timer;
+		switch(iter->type) {
+			case TC_SCHEDULE:
+				if(findTimer(t) != NULL) {
+					LOGW("Scheduler.schedulerTimer: timer already scheduled");
+				} else {
+					addTimer(t);
+				}
+				break;
+			case TC_UNSCHEDULE:
+			{
+				wyTimer* timer = findTimer(t);
+				if(timer == NULL) {
+					if(!t->isOneShot())
+						LOGW("Scheduler.unscheduleTimer: timer not scheduled");
+				} else {
+					removeTimer(timer);
+				}
+				break;
+			}
+			case TC_UPDATE:
+				if(t->m_scheduled)
+					relinkTimer(t, false);
+				break;
+			case TC_RESET:
+				if(t->m_scheduled)
+					relinkTimer(t, true);
+				break;
+		}
+	}
+	releaseCommands(m_commandsBuffer);
 }
 
 void wyScheduler::tickLocked(float delta) {
@@ -281,18 +651,24 @@ void wyScheduler::tickLocked(float delta) {
 		if(m_timeScale != 1.0f)
 			delta *= m_timeScale;
 
-		pthread_mutex_lock(&gMutex);
-
-		wyArrayEach(m_timersToRemove, removeTimers, NULL);
-		wyArrayEach(m_timersToRemove, releaseTimer, NULL);
-		wyArrayClear(m_timersToRemove);
+		// apply schedule requests
+		applyPendingCommands();
 
-		wyArrayEach(m_timersToAdd, addTimers, NULL);
-		wyArrayEach(m_timersToAdd, releaseTimer, NULL);
-		wyArrayClear(m_timersToAdd);
+		// advance clocks
+		m_time += delta;
+		m_frames++;
 
-		wyArrayEach(m_scheduledTimers, fire, &delta);
+		// collect expired timers, only slots which reach deadline are visited
+		wyTimerLink expired;
+		listInit(&expired);
+		wheelAdvance(m_frameWheel, m_frames, &expired);
+		wheelAdvance(m_timeWheel, m_time, &expired);
 
-		pthread_mutex_unlock(&gMutex);
+		// fire, callbacks are invoked without holding any lock
+		while(!listEmpty(&expired)) {
+			wyTimer* t = expired.next->timer;
+			listRemove(&t->m_link);
+			fireTimer(t);
+		}
 	}
 }
@@ -29,6 +29,9 @@
 #include "wySpotRibbon.h"
 #include "wyTypes.h"
 #include "wyUtils.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wySpotRibbon* wySpotRibbon::make(wyTexture2D* tex, wyColor4B color, float fade) {
 	wySpotRibbon* r = WYNEW wySpotRibbon(tex, color, fade);
@@ -50,6 +53,8 @@ wySpotRibbon::~wySpotRibbon() {
 }
 
 void wySpotRibbon::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
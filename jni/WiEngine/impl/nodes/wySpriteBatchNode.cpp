@@ -29,6 +29,9 @@
 #include "wySpriteBatchNode.h"
 #include "wyLog.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wySpriteBatchNode* wySpriteBatchNode::make(wyTexture2D* tex) {
 	wySpriteBatchNode* bn = WYNEW wySpriteBatchNode(tex);
@@ -53,6 +56,7 @@ wySpriteBatchNode::wySpriteBatchNode():
     init();
     m_atlas = wyTextureAtlas::make(NULL);
     m_atlas->retain();
+    m_atlas->setUseBufferObject(true);
 }
 
 wySpriteBatchNode::wySpriteBatchNode(wyTexture2D* tex):
@@ -68,6 +72,7 @@ wySpriteBatchNode::wySpriteBatchNode(wyTexture2D* tex):
     init();
     m_atlas = wyTextureAtlas::make(tex);
     m_atlas->retain();
+    m_atlas->setUseBufferObject(true);
 }
 
 wySpriteBatchNode::~wySpriteBatchNode() {
@@ -188,6 +193,8 @@ void wySpriteBatchNode::drawFromMarker(int count) {
 }
 
 void wySpriteBatchNode::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
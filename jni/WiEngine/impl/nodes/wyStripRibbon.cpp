@@ -27,6 +27,9 @@
  * THE SOFTWARE.
  */
 #include "wyStripRibbon.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyStripRibbon* wyStripRibbon::make(wyTexture2D* tex, wyColor4B color, float fade) {
 	wyStripRibbon* r = WYNEW wyStripRibbon(tex, color, fade);
@@ -46,6 +49,8 @@ wyStripRibbon::~wyStripRibbon() {
 }
 
 void wyStripRibbon::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -31,6 +31,9 @@
 #include <stdlib.h>
 #include "wyLog.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyTextureNode::wyTextureNode(wyTexture2D* tex) :
 		m_tex(NULL),
@@ -51,6 +54,7 @@ wyTextureNode::wyTextureNode(wyTexture2D* tex) :
 		m_pointLeftBottom(wypZero),
 		m_animations(WYNEW map<int, wyAnimation*>()),
 		m_texRect(wyrZero) {
+	m_batchDraw = true;
 	setTexture(tex);
 }
 
@@ -246,6 +250,19 @@ void wyTextureNode::draw() {
 		return;
 	}
 
+	// if no special state is needed, append quad to render queue
+	if(m_tex != NULL && !m_dither && !m_alphaTest && m_blend && gRenderQueue->canBatch(this)) {
+		wyQuad2D texCoords;
+		wyQuad3D vertices;
+		m_tex->load();
+		getQuad(&texCoords, &vertices);
+		gRenderQueue->addQuad(m_tex, m_blendFunc, texCoords, vertices, m_color);
+		return;
+	}
+
+	// draw pending quads before changing state
+	gRenderQueue->flush();
+
 	// check dither
 	if(m_dither)
 		glEnable(GL_DITHER);
@@ -300,6 +317,21 @@ void wyTextureNode::draw() {
     	glDisable(GL_DITHER);
 }
 
+void wyTextureNode::getQuad(wyQuad2D* texCoords, wyQuad3D* vertices) {
+	m_tex->getQuad(m_autoFit ? 0 : m_pointLeftBottom.x,
+			m_autoFit ? 0 : m_pointLeftBottom.y,
+			m_autoFit ? m_width : (m_rotatedZwoptex ? m_texRect.height : m_texRect.width),
+			m_autoFit ? m_height : (m_rotatedZwoptex ? m_texRect.width : m_texRect.height),
+			m_width,
+			m_height,
+			m_flipX,
+			m_flipY,
+			m_texRect,
+			m_rotatedZwoptex,
+			texCoords,
+			vertices);
+}
+
 void wyTextureNode::setAlphaFunc(GLenum func, float ref) {
 	if(func == GL_ALWAYS) {
 		m_alphaTest = false;
@@ -31,6 +31,9 @@
 #include "wyScheduler.h"
 #include "wyParallaxObject.h"
 #include "wyLog.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 /**
  * @class wyTiledSpriteParallaxObject
@@ -476,6 +479,8 @@ void wyTiledSprite::updateFling(wyTargetSelector* ts) {
 }
 
 void wyTiledSprite::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -36,17 +36,22 @@
 #include "wyLog.h"
 #include "wyDirector.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
 #include "PVRTError.h"
 #include "PVRTTextureAPI.h"
 
 extern wyDirector* gDirector;
 extern pthread_mutex_t gCondMutex;
 extern wyEventDispatcher* gEventDispatcher;
+extern wyRenderQueue* gRenderQueue;
 
 wyGLTexture2D::~wyGLTexture2D() {
 	// delete opengl texture if surface is still there
 	deleteTexture(gDirector == NULL || !gDirector->isSurfaceCreated() || gDirector->isEnding());
 
+	// release decoded data which is not uploaded
+	releaseDecodedData();
+
 	// release specific info
 	switch(m_source) {
 		case SOURCE_IMG:
@@ -159,6 +164,22 @@ wyGLTexture2D* wyGLTexture2D::makeFile(const char* fsPath, int transparentColor,
 	return tex;
 }
 
+wyGLTexture2D* wyGLTexture2D::makeLazy(const char* path, bool isFile, int transparentColor, wyTexturePixelFormat pixelFormat, float inDensity) {
+	wyGLTexture2D* tex = WYNEW wyGLTexture2D();
+	tex->autoRelease();
+	tex->m_pixelFormat = pixelFormat;
+	tex->m_transparentColor = transparentColor;
+	tex->m_source = SOURCE_IMG;
+	tex->m_path = wyUtils::copy(path);
+	tex->m_isFile = isFile;
+	if(inDensity == 0)
+		inDensity = wyDevice::defaultInDensity;
+	tex->m_inDensity = inDensity;
+
+	// size will be initialized when decoding
+	return tex;
+}
+
 wyGLTexture2D* wyGLTexture2D::makeLabel(const char* text, float fontSize, const char* fontPath, bool isFile, float width, wyTexture2D::TextAlignment alignment) {
 	wyGLTexture2D* tex = WYNEW wyGLTexture2D();
 	tex->m_source = SOURCE_LABEL;
@@ -246,7 +267,11 @@ wyGLTexture2D::wyGLTexture2D() :
 		m_mfsName(NULL),
 		m_data(NULL),
 		m_length(0),
-		m_inDensity(wyDevice::defaultInDensity) {
+		m_inDensity(wyDevice::defaultInDensity),
+		m_decodedData(NULL),
+		m_decodedLength(0),
+		m_decodedPVR(false),
+		m_decodedNeedFree(false) {
 }
 
 void wyGLTexture2D::initSize(float realWidth, float realHeight) {
@@ -327,6 +352,116 @@ char* wyGLTexture2D::loadImage(char* raw, size_t len, float scale) {
 	return rgba;
 }
 
+bool wyGLTexture2D::decode() {
+	// get raw data of image
+	size_t len;
+	float scale;
+	bool needFree;
+	char* raw = loadRaw(&len, &scale, &needFree);
+	if(raw == NULL)
+		return false;
+
+	// init size if not yet
+	if(m_pixelWidth == 0 || m_pixelHeight == 0) {
+		float w = 0, h = 0;
+		wyUtils::loadImage(raw, len, &w, &h, true, scale, scale);
+		initSize(w, h);
+	}
+
+	// PVR is uploaded directly, so just keep raw data
+	if(wyUtils::isPVR(raw, len)) {
+		m_decodedData = raw;
+		m_decodedLength = len;
+		m_decodedPVR = true;
+		m_decodedNeedFree = needFree;
+		return true;
+	}
+
+	// decompress data in RGBA8888
+	char* rgba = loadImage(raw, len, scale);
+	if(needFree)
+		wyFree(raw);
+	if(rgba == NULL)
+		return false;
+
+	// convert data format
+	const char* data = convertPixelFormat(rgba);
+	if(data != rgba) {
+		wyFree(rgba);
+	}
+
+	// save decoded data
+	int bpp;
+	switch(m_pixelFormat) {
+		case WY_TEXTURE_PIXEL_FORMAT_A8:
+			bpp = 1;
+			break;
+		case WY_TEXTURE_PIXEL_FORMAT_RGBA8888:
+			bpp = 4;
+			break;
+		default:
+			bpp = 2;
+			break;
+	}
+	m_decodedData = (char*)data;
+	m_decodedLength = (size_t)m_pixelWidth * (size_t)m_pixelHeight * bpp;
+	m_decodedPVR = false;
+	m_decodedNeedFree = true;
+	return true;
+}
+
+void wyGLTexture2D::upload() {
+	if(m_decodedData == NULL)
+		return;
+
+	if(m_decodedPVR) {
+		EPVRTError error = PVRTTextureLoadFromPointer(m_decodedData, (GLuint*)&m_texture);
+		if(error != PVR_SUCCESS) {
+			LOGW("wyGLTexture2D::upload: failed to load PVR texture");
+		}
+	} else {
+		// generate texture and set parameter
+		glGenTextures(1, (GLuint*)&m_texture);
+		glBindTexture(GL_TEXTURE_2D, m_texture);
+		applyParameters();
+
+		// generate texture
+		texImage(m_decodedData);
+	}
+
+	// free data
+	releaseDecodedData();
+}
+
+void wyGLTexture2D::texImage(const char* data) {
+	switch(m_pixelFormat) {
+		case WY_TEXTURE_PIXEL_FORMAT_RGBA8888:
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			break;
+		case WY_TEXTURE_PIXEL_FORMAT_RGB565:
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_pixelWidth, m_pixelHeight, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, data);
+			break;
+		case WY_TEXTURE_PIXEL_FORMAT_RGBA4444:
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, data);
+			break;
+		case WY_TEXTURE_PIXEL_FORMAT_RGBA5551:
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, data);
+			break;
+		case WY_TEXTURE_PIXEL_FORMAT_A8:
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_pixelWidth, m_pixelHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, data);
+			break;
+	}
+}
+
+void wyGLTexture2D::releaseDecodedData() {
+	if(m_decodedData != NULL && m_decodedNeedFree)
+		wyFree(m_decodedData);
+	m_decodedData = NULL;
+	m_decodedLength = 0;
+	m_decodedPVR = false;
+	m_decodedNeedFree = false;
+}
+
 void wyGLTexture2D::load() {
 	// if loaded and no update scheduled, return
 	if(m_texture != 0 && !(m_needUpdateLabel && m_source == SOURCE_LABEL))
@@ -381,62 +516,19 @@ void wyGLTexture2D::doLoad() {
 		}
 		case SOURCE_IMG:
 		{
-			// get raw data of image
-			size_t len;
-			float scale;
-            bool needFree;
-			char* raw = loadRaw(&len, &scale, &needFree);
-
-			// special case for PVR
-			if(wyUtils::isPVR(raw, len)) {
-				EPVRTError error = PVRTTextureLoadFromPointer(raw, (GLuint*)&m_texture);
-				if(error != PVR_SUCCESS) {
-					LOGW("wyGLTexture2D::doLoad: failed to load PVR texture");
-				}
-			} else {
-				// generate texture and set parameter
-				glGenTextures(1, (GLuint*)&m_texture);
-				glBindTexture(GL_TEXTURE_2D, m_texture);
-				applyParameters();
-
-				// decompress data in RGBA8888
-				char* rgba = loadImage(raw, len, scale);
-				if(rgba == NULL)
+			// decode now if image is not decoded in worker thread
+			if(m_decodedData == NULL) {
+				if(!decode()) {
+					// still generate an empty texture so that we won't try again
+					glGenTextures(1, (GLuint*)&m_texture);
+					glBindTexture(GL_TEXTURE_2D, m_texture);
+					applyParameters();
 					return;
-
-				// convert data format
-				const char* data = convertPixelFormat(rgba);
-				if(data != rgba) {
-					wyFree(rgba);
-				}
-
-				// generate texture
-				switch(m_pixelFormat) {
-					case WY_TEXTURE_PIXEL_FORMAT_RGBA8888:
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-						break;
-					case WY_TEXTURE_PIXEL_FORMAT_RGB565:
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_pixelWidth, m_pixelHeight, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, data);
-						break;
-					case WY_TEXTURE_PIXEL_FORMAT_RGBA4444:
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, data);
-						break;
-					case WY_TEXTURE_PIXEL_FORMAT_RGBA5551:
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, data);
-						break;
-					case WY_TEXTURE_PIXEL_FORMAT_A8:
-						glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_pixelWidth, m_pixelHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, data);
-						break;
 				}
-
-				// free data
-				wyFree((void*)data);
 			}
 
-			// free raw data
-            if(needFree)
-                wyFree(raw);
-
+			// upload
+			upload();
 			break;
 		}
 		case SOURCE_RAW8888:
@@ -450,23 +542,7 @@ void wyGLTexture2D::doLoad() {
 			char* data = (char*)convertPixelFormat((const char*)m_data);
 
 			// generate texture
-			switch(m_pixelFormat) {
-				case WY_TEXTURE_PIXEL_FORMAT_RGBA8888:
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-					break;
-				case WY_TEXTURE_PIXEL_FORMAT_RGB565:
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_pixelWidth, m_pixelHeight, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, data);
-					break;
-				case WY_TEXTURE_PIXEL_FORMAT_RGBA4444:
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, data);
-					break;
-				case WY_TEXTURE_PIXEL_FORMAT_RGBA5551:
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_pixelWidth, m_pixelHeight, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, data);
-					break;
-				case WY_TEXTURE_PIXEL_FORMAT_A8:
-					glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_pixelWidth, m_pixelHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, data);
-					break;
-			}
+			texImage(data);
 
 			// release
 			if(data != m_data) {
@@ -728,25 +804,68 @@ void wyGLTexture2D::draw(float x, float y, float width, float height, float sour
 	// ensure texture object is created
 	load();
 
+	// get vertices and texture coordination
+	wyQuad2D texCoords;
+	wyQuad3D vertices;
+	getQuad(x, y, width, height, sourceWidth, sourceHeight, flipX, flipY, texRect, rotatedZwoptex, &texCoords, &vertices);
+
+	// flush pending batched quads
+	gRenderQueue->flush();
+
+	// enable states
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnable(GL_TEXTURE_2D);
+
+	// ensure current texture is active
+	glBindTexture(GL_TEXTURE_2D, m_texture);
+
+	// apply texture parameters in both direction
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_wrapS);
+	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_wrapT);
+
+	// set vertices and texture coordination and draw
+	glVertexPointer(3, GL_FLOAT, 0, (GLfloat*)&vertices);
+	glTexCoordPointer(2, GL_FLOAT, 0, (GLfloat*)&texCoords);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	gRenderQueue->countDrawCall();
+
+	// disable states
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisable(GL_TEXTURE_2D);
+}
+
+void wyGLTexture2D::getQuad(float x, float y, float width, float height, float sourceWidth, float sourceHeight, bool flipX, bool flipY, wyRect texRect, bool rotatedZwoptex, wyQuad2D* outTexCoords, wyQuad3D* outVertices) {
 	// get vertices
-	float vertices[] = {
-		x, y, 0.0f,
-		width + x, y, 0.0f,
-		x, height + y, 0.0f,
-		width + x, height + y, 0.0f
-	};
+	float* vertices = (float*)outVertices;
+	vertices[0] = x;
+	vertices[1] = y;
+	vertices[2] = 0.0f;
+	vertices[3] = width + x;
+	vertices[4] = y;
+	vertices[5] = 0.0f;
+	vertices[6] = x;
+	vertices[7] = height + y;
+	vertices[8] = 0.0f;
+	vertices[9] = width + x;
+	vertices[10] = height + y;
+	vertices[11] = 0.0f;
 
 	// get texture coordination
     float left = (2 * texRect.x + 1) / (2 * m_pixelWidth);
     float right = left + (texRect.width * 2 - 2) / (2 * m_pixelWidth);
     float top = (2 * texRect.y + 1) / (2 * m_pixelHeight);
     float bottom = top + (texRect.height * 2 - 2) / (2 * m_pixelHeight);
-    float texCoords[] = {
-		left, bottom,
-		right, bottom,
-		left, top,
-		right, top
-    };
+    float* texCoords = (float*)outTexCoords;
+    texCoords[0] = left;
+    texCoords[1] = bottom;
+    texCoords[2] = right;
+    texCoords[3] = bottom;
+    texCoords[4] = left;
+    texCoords[5] = top;
+    texCoords[6] = right;
+    texCoords[7] = top;
 
     // is a rotated zwoptex frame?
     if(rotatedZwoptex) {
@@ -813,28 +932,6 @@ void wyGLTexture2D::draw(float x, float y, float width, float height, float sour
 		wyUtils::swap(vertices, 7, 10);
 		wyUtils::swap(vertices, 8, 11);
 	}
-
-	// enable states
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);
-
-	// ensure current texture is active
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-
-	// apply texture parameters in both direction
-	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_wrapS);
-	glTexParameterx(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_wrapT);
-
-	// set vertices and texture coordination and draw
-	glVertexPointer(3, GL_FLOAT, 0, vertices);
-	glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-	// disable states
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisable(GL_TEXTURE_2D);
 }
 
 const char* wyGLTexture2D::convertPixelFormat(const char* data) {
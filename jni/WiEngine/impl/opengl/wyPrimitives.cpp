@@ -32,34 +32,49 @@
 #include "wyUtils.h"
 #include "wyLog.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 void wyDrawPoint(float x, float y) {
+	gRenderQueue->flush();
+
 	float f[2] = { x, y };
 	glVertexPointer(2, GL_FLOAT, 0, f);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawArrays(GL_POINTS, 0, 1);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 void wyDrawPoints(float* p, size_t length) {
+	gRenderQueue->flush();
+
 	glVertexPointer(2, GL_FLOAT, 0, p);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawArrays(GL_POINTS, 0, length / 2);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 void wyDrawLine(float x1, float y1, float x2, float y2) {
+	gRenderQueue->flush();
+
 	float f[4] = { x1, y1, x2, y2 };
 	glVertexPointer(2, GL_FLOAT, 0, f);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawArrays(GL_LINES, 0, 2);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 void wyDrawPath(float* points, size_t length) {
+	gRenderQueue->flush();
+
 	glVertexPointer(2, GL_FLOAT, 0, points);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawArrays(GL_LINE_STRIP, 0, length / 2);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
@@ -70,6 +85,8 @@ void wyDrawDashPath(float* points, size_t length, float dashLength) {
 }
 
 void wyDrawDashLine(float x1, float y1, float x2, float y2, float dashLength) {
+	gRenderQueue->flush();
+
 	float dx = x2 - x1;
 	float dy = y2 - y1;
 	float dist = wyMath::sqrt(dx * dx + dy * dy);
@@ -91,17 +108,21 @@ void wyDrawDashLine(float x1, float y1, float x2, float y2, float dashLength) {
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glVertexPointer(2, GL_FLOAT, 0, vertices);
 	glDrawArrays(GL_LINES, 0, segments);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 
 	wyFree(vertices);
 }
 
 void wyDrawPoly(float* p, size_t length, bool close) {
+	gRenderQueue->flush();
+
 	glVertexPointer(2, GL_FLOAT, 0, p);
 	glEnableClientState(GL_VERTEX_ARRAY);
 
 	// GL_LINE_LOOP is very slow in desire HD, so we draw line strip and then draw last close line
 	glDrawArrays(GL_LINE_STRIP, 0, length / 2);
+	gRenderQueue->countDrawCall();
 	if(close)
 		wyDrawLine(p[length - 2], p[length - 1], p[0], p[1]);
 
@@ -123,6 +144,8 @@ void wyDrawRect2(wyRect& r) {
 }
 
 void wyDrawCircle(float centerX, float centerY, float r, float radiusLineAngle, int segments, bool drawLineToCenter) {
+	gRenderQueue->flush();
+
 	float* vertices = (float*)wyMalloc(sizeof(float) * 2 * (segments + 2));
 
 	int additionalSegment = 1;
@@ -147,6 +170,7 @@ void wyDrawCircle(float centerX, float centerY, float r, float radiusLineAngle,
 	glVertexPointer(2, GL_FLOAT, 0, vertices);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawArrays(GL_LINE_STRIP, 0, segments + additionalSegment);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 
 	wyFree(vertices);
@@ -172,6 +196,8 @@ void wyDrawSolidCircle(float centerX, float centerY, float r, int segments, wyCo
 }
 
 void wyDrawBezier(wyBezierConfig& c, int segments) {
+	gRenderQueue->flush();
+
 	float step = 1.f / segments;
 	float t = 0;
 	float* vertices = (float*)wyMalloc(sizeof(float) * 2 * (segments + 1));
@@ -185,12 +211,15 @@ void wyDrawBezier(wyBezierConfig& c, int segments) {
 	glVertexPointer(2, GL_FLOAT, 0, vertices);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawArrays(GL_LINE_STRIP, 0, segments + 1);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 
 	wyFree(vertices);
 }
 
 void wyDrawLagrange(wyLagrangeConfig& c, int segments) {
+	gRenderQueue->flush();
+
 	float step = 1.f / segments;
 	float t = 0;
 	float* vertices = (float*)wyMalloc(sizeof(float) * 2 * (segments + 1));
@@ -204,12 +233,15 @@ void wyDrawLagrange(wyLagrangeConfig& c, int segments) {
 	glVertexPointer(2, GL_FLOAT, 0, vertices);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawArrays(GL_LINE_STRIP, 0, segments + 1);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 
 	wyFree(vertices);
 }
 
 void wyDrawHypotrochoid(wyHypotrochoidConfig& c, int segments) {
+	gRenderQueue->flush();
+
 	float step = 1.f / segments;
 	float t = 0;
 	float* vertices = (float*)wyMalloc(sizeof(float) * 2 * (segments + 1));
@@ -223,6 +255,7 @@ void wyDrawHypotrochoid(wyHypotrochoidConfig& c, int segments) {
 	glVertexPointer(2, GL_FLOAT, 0, vertices);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glDrawArrays(GL_LINE_STRIP, 0, segments + 1);
+	gRenderQueue->countDrawCall();
 	glDisableClientState(GL_VERTEX_ARRAY);
 
 	wyFree(vertices);
@@ -234,6 +267,8 @@ void wyDrawTexture(int texture, float texW, float texH, float x, float y, float
 }
 
 void wyDrawTexture2(int texture, wyRect texRect, float texW, float texH, float x, float y, float w, float h, bool flipX, bool flipY) {
+	gRenderQueue->flush();
+
 	// get drawing size
 	float potWidth = wyMath::getNextPOT(texW);
 	float potHeight = wyMath::getNextPOT(texH);
@@ -284,6 +319,7 @@ void wyDrawTexture2(int texture, wyRect texRect, float texW, float texH, float x
 	glVertexPointer(3, GL_FLOAT, 0, vertices);
 	glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	gRenderQueue->countDrawCall();
 
 	// disable states
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -292,6 +328,8 @@ void wyDrawTexture2(int texture, wyRect texRect, float texW, float texH, float x
 }
 
 void wyDrawSolidPoly(float* p, size_t length, wyColor4B color) {
+	gRenderQueue->flush();
+
 	GLubyte* colors = (GLubyte*) wyMalloc(length * 2 * sizeof(GLubyte));
 	for(int i = 0; i < length / 2; i++) {
 		colors[i * 4] = color.r;
@@ -307,6 +345,7 @@ void wyDrawSolidPoly(float* p, size_t length, wyColor4B color) {
 	glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
 
 	glDrawArrays(GL_TRIANGLE_FAN, 0, length / 2);
+	gRenderQueue->countDrawCall();
 
 	// Clear the vertex and color arrays
 	glDisableClientState(GL_VERTEX_ARRAY);
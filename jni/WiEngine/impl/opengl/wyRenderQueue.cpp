@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: luma(stubma@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "wyRenderQueue.h"
+#include "wyNode.h"
+#include "wyTexture2D.h"
+#include "wyAffineTransform.h"
+#include "wyLog.h"
+#include <stdlib.h>
+#include <string.h>
+
+wyRenderQueue* gRenderQueue = NULL;
+
+// initial capacity of matrix stack and quad buffer
+#define INITIAL_STACK_CAPACITY 32
+#define INITIAL_QUAD_CAPACITY 64
+
+// max quads in one draw call, limited by unsigned short indices
+#define MAX_BATCH_QUADS 16383
+
+wyRenderQueue::wyRenderQueue() :
+		m_stack((wyMatrixEntry*)wyMalloc(INITIAL_STACK_CAPACITY * sizeof(wyMatrixEntry))),
+		m_stackSize(0),
+		m_stackCapacity(INITIAL_STACK_CAPACITY),
+		m_enabled(true),
+		m_inFrame(false),
+		m_texture(NULL),
+		m_textureName(0),
+		m_vertices(NULL),
+		m_texCoords(NULL),
+		m_colors(NULL),
+		m_indices(NULL),
+		m_quadCount(0),
+		m_capacity(0),
+		m_drawCalls(0),
+		m_lastDrawCalls(0),
+		m_batchedQuads(0),
+		m_lastBatchedQuads(0) {
+	m_blendFunc.src = DEFAULT_BLEND_SRC;
+	m_blendFunc.dst = DEFAULT_BLEND_DST;
+	ensureCapacity(INITIAL_QUAD_CAPACITY);
+}
+
+wyRenderQueue::~wyRenderQueue() {
+	wyObjectRelease(m_texture);
+	wyFree(m_stack);
+	wyFree(m_vertices);
+	wyFree(m_texCoords);
+	wyFree(m_colors);
+	wyFree(m_indices);
+	gRenderQueue = NULL;
+}
+
+wyRenderQueue* wyRenderQueue::getInstance() {
+	if(gRenderQueue == NULL) {
+		gRenderQueue = WYNEW wyRenderQueue();
+	}
+
+	return gRenderQueue;
+}
+
+wyRenderQueue* wyRenderQueue::getInstanceNoCreate() {
+	return gRenderQueue;
+}
+
+void wyRenderQueue::ensureCapacity(int quads) {
+	if(quads <= m_capacity)
+		return;
+
+	int newCapacity = MAX(quads, m_capacity * 2);
+	newCapacity = MIN(newCapacity, MAX_BATCH_QUADS);
+	m_vertices = (GLfloat*)wyRealloc(m_vertices, newCapacity * 8 * sizeof(GLfloat));
+	m_texCoords = (GLfloat*)wyRealloc(m_texCoords, newCapacity * 8 * sizeof(GLfloat));
+	m_colors = (GLubyte*)wyRealloc(m_colors, newCapacity * 16 * sizeof(GLubyte));
+	m_indices = (GLushort*)wyRealloc(m_indices, newCapacity * 6 * sizeof(GLushort));
+
+	// indices never change, so fill new part only
+	for(int i = m_capacity; i < newCapacity; i++) {
+		m_indices[i * 6 + 0] = i * 4 + 0;
+		m_indices[i * 6 + 1] = i * 4 + 1;
+		m_indices[i * 6 + 2] = i * 4 + 2;
+		m_indices[i * 6 + 3] = i * 4 + 3;
+		m_indices[i * 6 + 4] = i * 4 + 2;
+		m_indices[i * 6 + 5] = i * 4 + 1;
+	}
+
+	m_capacity = newCapacity;
+}
+
+void wyRenderQueue::setEnabled(bool flag) {
+	if(m_enabled != flag) {
+		flush();
+		m_enabled = flag;
+	}
+}
+
+void wyRenderQueue::beginFrame() {
+	m_stackSize = 0;
+	m_quadCount = 0;
+	m_drawCalls = 0;
+	m_batchedQuads = 0;
+	m_inFrame = false;
+
+	if(m_enabled) {
+		// save model view matrix, batched quads will be drawn with it
+		// if gpu doesn't support matrix query, batch is disabled in this frame
+		glGetError();
+		glGetFloatv(GL_MODELVIEW_MATRIX, m_rootMatrix);
+		if(glGetError() == GL_NO_ERROR) {
+			m_stack[0].owner = NULL;
+			m_stack[0].transform = wyaIdentity;
+			m_stack[0].valid = true;
+			m_stackSize = 1;
+			m_inFrame = true;
+		}
+	}
+}
+
+void wyRenderQueue::endFrame() {
+	flush();
+	m_inFrame = false;
+	m_stackSize = 0;
+	m_lastDrawCalls = m_drawCalls;
+	m_lastBatchedQuads = m_batchedQuads;
+}
+
+void wyRenderQueue::pushNode(wyNode* node, bool batchable) {
+	if(!m_inFrame)
+		return;
+
+	// grow stack
+	if(m_stackSize >= m_stackCapacity) {
+		m_stackCapacity *= 2;
+		m_stack = (wyMatrixEntry*)wyRealloc(m_stack, m_stackCapacity * sizeof(wyMatrixEntry));
+	}
+
+	// new entry is valid only if parent entry is valid and opengl matrix of this node
+	// is parent matrix multiplied by node to parent transform. In that case, all ancestors
+	// are valid so the frame space is world space and cached world transform can be used
+	wyMatrixEntry& top = m_stack[m_stackSize - 1];
+	wyMatrixEntry& e = m_stack[m_stackSize];
+	e.owner = node;
+	e.valid = batchable && top.valid && node != NULL && top.owner == node->getParent();
+	if(e.valid) {
+		e.transform = node->getNodeToWorldTransform();
+	}
+	m_stackSize++;
+}
+
+void wyRenderQueue::popNode() {
+	if(!m_inFrame)
+		return;
+
+	if(m_stackSize > 1)
+		m_stackSize--;
+}
+
+bool wyRenderQueue::canBatch(wyNode* node) {
+	if(!m_enabled || !m_inFrame)
+		return false;
+
+	wyMatrixEntry& top = m_stack[m_stackSize - 1];
+	return top.valid && top.owner == node;
+}
+
+void wyRenderQueue::addQuad(wyTexture2D* tex, wyBlendFunc blendFunc, wyQuad2D& texCoords, wyQuad3D& vertices, wyColor4B color) {
+	// flush if state is different
+	int name = tex->getTexture();
+	if(m_quadCount > 0) {
+		if(name != m_textureName ||
+				blendFunc.src != m_blendFunc.src ||
+				blendFunc.dst != m_blendFunc.dst ||
+				m_quadCount >= MAX_BATCH_QUADS) {
+			flush();
+		}
+	}
+
+	// save state of new batch
+	if(m_quadCount == 0) {
+		wyObjectRetain(tex);
+		wyObjectRelease(m_texture);
+		m_texture = tex;
+		m_textureName = name;
+		m_blendFunc = blendFunc;
+	}
+
+	// ensure buffer is enough
+	ensureCapacity(m_quadCount + 1);
+
+	// transform vertices to frame space
+	wyAffineTransform& t = m_stack[m_stackSize - 1].transform;
+	GLfloat* v = m_vertices + m_quadCount * 8;
+	v[0] = vertices.bl_x * t.a + vertices.bl_y * t.c + t.tx;
+	v[1] = vertices.bl_x * t.b + vertices.bl_y * t.d + t.ty;
+	v[2] = vertices.br_x * t.a + vertices.br_y * t.c + t.tx;
+	v[3] = vertices.br_x * t.b + vertices.br_y * t.d + t.ty;
+	v[4] = vertices.tl_x * t.a + vertices.tl_y * t.c + t.tx;
+	v[5] = vertices.tl_x * t.b + vertices.tl_y * t.d + t.ty;
+	v[6] = vertices.tr_x * t.a + vertices.tr_y * t.c + t.tx;
+	v[7] = vertices.tr_x * t.b + vertices.tr_y * t.d + t.ty;
+
+	// texture coordinates
+	memcpy(m_texCoords + m_quadCount * 8, &texCoords, sizeof(wyQuad2D));
+
+	// colors
+	GLubyte* c = m_colors + m_quadCount * 16;
+	for(int i = 0; i < 4; i++) {
+		c[i * 4 + 0] = color.r;
+		c[i * 4 + 1] = color.g;
+		c[i * 4 + 2] = color.b;
+		c[i * 4 + 3] = color.a;
+	}
+
+	m_quadCount++;
+	m_batchedQuads++;
+}
+
+void wyRenderQueue::flush() {
+	if(m_quadCount == 0)
+		return;
+
+	// save current color because color array will change it
+	GLfloat color[4];
+	glGetFloatv(GL_CURRENT_COLOR, color);
+
+	// quads are in frame space
+	glPushMatrix();
+	glLoadMatrixf(m_rootMatrix);
+
+	// enable states
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glEnable(GL_TEXTURE_2D);
+
+	// bind texture
+	glBindTexture(GL_TEXTURE_2D, m_textureName);
+	m_texture->applyParameters();
+
+	// set blend
+	bool newBlend = m_blendFunc.src != DEFAULT_BLEND_SRC || m_blendFunc.dst != DEFAULT_BLEND_DST;
+	if(newBlend)
+		glBlendFunc(m_blendFunc.src, m_blendFunc.dst);
+
+	// draw
+	glVertexPointer(2, GL_FLOAT, 0, m_vertices);
+	glTexCoordPointer(2, GL_FLOAT, 0, m_texCoords);
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_colors);
+	glDrawElements(GL_TRIANGLES, m_quadCount * 6, GL_UNSIGNED_SHORT, m_indices);
+	countDrawCall();
+
+	// restore blend
+	if(newBlend)
+		glBlendFunc(DEFAULT_BLEND_SRC, DEFAULT_BLEND_DST);
+
+	// disable states
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisable(GL_TEXTURE_2D);
+
+	// restore matrix and color
+	glPopMatrix();
+	glColor4f(color[0], color[1], color[2], color[3]);
+
+	// clear
+	m_quadCount = 0;
+	wyObjectRelease(m_texture);
+	m_texture = NULL;
+}
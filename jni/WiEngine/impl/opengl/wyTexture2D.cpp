@@ -38,7 +38,7 @@ extern wyTextureManager* gTextureManager;
 
 wyTexture2D::wyTexture2D() :
 		m_handle(-1),
-		m_md5(NULL),
+		m_key(0),
 		m_source(SOURCE_INVALID),
 		m_text(NULL),
 		m_fontSize(0),
@@ -303,6 +303,12 @@ void wyTexture2D::draw(float x, float y, float width, float height, float source
 		tex->draw(x, y, width, height, sourceWidth, sourceHeight, flipX, flipY, texRect, rotatedZwoptex);
 }
 
+void wyTexture2D::getQuad(float x, float y, float width, float height, float sourceWidth, float sourceHeight, bool flipX, bool flipY, wyRect texRect, bool rotatedZwoptex, wyQuad2D* texCoords, wyQuad3D* vertices) {
+	wyGLTexture2D* tex = gTextureManager->getTexture(this);
+	if(tex)
+		tex->getQuad(x, y, width, height, sourceWidth, sourceHeight, flipX, flipY, texRect, rotatedZwoptex, texCoords, vertices);
+}
+
 float wyTexture2D::getWidth() {
 	wyGLTexture2D* tex = gTextureManager->getTexture(this);
 	if(tex)
@@ -29,46 +29,210 @@
 #include "wyTexture2D.h"
 #include "wyTextureAtlas.h"
 #include <stdlib.h>
+#include <stddef.h>
 #include "wyLog.h"
+#include "wyRenderQueue.h"
+#include "wyDirector.h"
 
-void wyTextureAtlas::initIndices() {
-	for(int i = 0; i < m_capacity; i++) {
-		m_indices[i * 6] = (GLushort)(i * 4);
-		m_indices[i * 6 + 1] = (GLushort)(i * 4 + 1);
-		m_indices[i * 6 + 2] = (GLushort)(i * 4 + 2);
+extern wyRenderQueue* gRenderQueue;
+extern wyDirector* gDirector;
 
-		// inverted index.
-		m_indices[i * 6 + 5] = (GLushort)(i * 4 + 1);
-		m_indices[i * 6 + 4] = (GLushort)(i * 4 + 2);
-		m_indices[i * 6 + 3] = (GLushort)(i * 4 + 3);
+// defined by OES_element_index_uint
+#ifndef GL_UNSIGNED_INT
+	#define GL_UNSIGNED_INT 0x1405
+#endif
+
+// with unsigned short indices, one draw call can address 65536 vertices
+#define MAX_SHORT_INDEX_QUADS 16384
+
+// bytes of a quad in vertex buffer
+#define QUAD_SIZE (4 * sizeof(wyAtlasVertex))
+
+// -1 means not checked yet
+static int sBufferSupported = -1;
+static int sUintIndexSupported = -1;
+
+// increased when opengl context is lost, buffers created in old generation are invalid
+static int sBufferGeneration = 0;
+
+static bool isBufferSupported() {
+	if(sBufferSupported == -1) {
+		// buffer object is in core since OpenGL ES 1.1
+		const char* version = (const char*)glGetString(GL_VERSION);
+		if(version == NULL)
+			return false;
+		sBufferSupported = (strstr(version, "ES-CM 1.0") == NULL && strstr(version, "ES-CL 1.0") == NULL) ? 1 : 0;
+	}
+	return sBufferSupported == 1;
+}
+
+static bool isUintIndexSupported() {
+	if(sUintIndexSupported == -1) {
+		if(glGetString(GL_VERSION) == NULL)
+			return false;
+		sUintIndexSupported = gDirector->isExtensionSupported("GL_OES_element_index_uint") ? 1 : 0;
+	}
+	return sUintIndexSupported == 1;
+}
+
+void wyTextureAtlas::invalidateAllBuffers() {
+	sBufferGeneration++;
+}
+
+void wyTextureAtlas::markDirty(int start, int end) {
+	end = MIN(end, m_capacity);
+	if(end <= start)
+		return;
+
+	if(m_dirtyEnd <= m_dirtyStart) {
+		m_dirtyStart = start;
+		m_dirtyEnd = end;
+	} else {
+		m_dirtyStart = MIN(m_dirtyStart, start);
+		m_dirtyEnd = MAX(m_dirtyEnd, end);
+	}
+}
+
+int wyTextureAtlas::prepareIndices() {
+	bool uintIndex = isUintIndexSupported();
+	GLenum type = uintIndex ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+	int quads = uintIndex ? m_capacity : MIN(m_capacity, MAX_SHORT_INDEX_QUADS);
+	if(m_indexType == type && m_indexQuads >= quads)
+		return m_indexQuads;
+
+	// every draw call moves pointers to its first quad, so indices always start from zero
+	if(uintIndex) {
+		GLuint* indices = (GLuint*)wyRealloc(m_indices, quads * 6 * sizeof(GLuint));
+		for(int i = 0; i < quads; i++) {
+			indices[i * 6] = i * 4;
+			indices[i * 6 + 1] = i * 4 + 1;
+			indices[i * 6 + 2] = i * 4 + 2;
+
+			// inverted index.
+			indices[i * 6 + 5] = i * 4 + 1;
+			indices[i * 6 + 4] = i * 4 + 2;
+			indices[i * 6 + 3] = i * 4 + 3;
+		}
+		m_indices = indices;
+	} else {
+		GLushort* indices = (GLushort*)wyRealloc(m_indices, quads * 6 * sizeof(GLushort));
+		for(int i = 0; i < quads; i++) {
+			indices[i * 6] = (GLushort)(i * 4);
+			indices[i * 6 + 1] = (GLushort)(i * 4 + 1);
+			indices[i * 6 + 2] = (GLushort)(i * 4 + 2);
+
+			// inverted index.
+			indices[i * 6 + 5] = (GLushort)(i * 4 + 1);
+			indices[i * 6 + 4] = (GLushort)(i * 4 + 2);
+			indices[i * 6 + 3] = (GLushort)(i * 4 + 3);
+		}
+		m_indices = indices;
 	}
+
+	m_indexType = type;
+	m_indexQuads = quads;
+	m_bufferIndexQuads = 0;
+	return quads;
+}
+
+bool wyTextureAtlas::prepareBuffer() {
+	if(!m_useBuffer || !isBufferSupported())
+		return false;
+
+	// old buffers are released with old context, just forget them
+	if(m_bufferGeneration != sBufferGeneration) {
+		m_vbo = 0;
+		m_ibo = 0;
+		m_bufferGeneration = sBufferGeneration;
+	}
+	if(m_vbo == 0) {
+		glGenBuffers(1, &m_vbo);
+		glGenBuffers(1, &m_ibo);
+		m_bufferCapacity = 0;
+		m_bufferIndexQuads = 0;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+
+	// reallocate vertex buffer if capacity is changed, or upload dirty quads only
+	if(m_bufferCapacity != m_capacity) {
+		glBufferData(GL_ARRAY_BUFFER, m_capacity * QUAD_SIZE, m_vertices, GL_DYNAMIC_DRAW);
+		m_bufferCapacity = m_capacity;
+	} else if(m_dirtyEnd > m_dirtyStart) {
+		glBufferSubData(GL_ARRAY_BUFFER, m_dirtyStart * QUAD_SIZE, (m_dirtyEnd - m_dirtyStart) * QUAD_SIZE, m_vertices + m_dirtyStart * 4);
+	}
+	m_dirtyStart = 0;
+	m_dirtyEnd = 0;
+
+	// indices never change unless they are rebuilt
+	if(m_bufferIndexQuads != m_indexQuads) {
+		int indexSize = m_indexType == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexQuads * 6 * indexSize, m_indices, GL_STATIC_DRAW);
+		m_bufferIndexQuads = m_indexQuads;
+	}
+
+	return true;
 }
 
 void wyTextureAtlas::initColorArray() {
 	if(!m_withColorArray) {
 		int count = m_capacity * 4;
-		int size = m_capacity * 4 * sizeof(wyColor4B);
-		m_colors = (GLubyte*)wyMalloc(size);
-		GLubyte* p = m_colors;
-		for(int i = 0; i < count; i++, p += sizeof(wyColor4B)) {
-			memcpy(p, &m_color, sizeof(wyColor4B));
+		wyAtlasVertex* v = m_vertices;
+		for(int i = 0; i < count; i++, v++) {
+			v->color = m_color;
 		}
 
 		m_withColorArray = true;
+		markDirty(0, m_capacity);
 	}
 }
 
 void wyTextureAtlas::putTexCoords(wyQuad2D* quadT, int index) {
-	memcpy((GLubyte*)m_texCoords + index * sizeof(wyQuad2D), quadT, sizeof(wyQuad2D));
+	wyAtlasVertex* v = m_vertices + index * 4;
+	GLfloat* t = (GLfloat*)quadT;
+	for(int i = 0; i < 4; i++, v++, t += 2) {
+		v->u = t[0];
+		v->v = t[1];
+	}
+	markDirty(index, index + 1);
 }
 
 void wyTextureAtlas::putVertex(wyQuad3D* quadV, int index) {
-	memcpy((GLubyte*)m_vertices + index * sizeof(wyQuad3D), quadV, sizeof(wyQuad3D));
+	wyAtlasVertex* v = m_vertices + index * 4;
+	GLfloat* p = (GLfloat*)quadV;
+	for(int i = 0; i < 4; i++, v++, p += 3) {
+		v->x = p[0];
+		v->y = p[1];
+		v->z = p[2];
+	}
+	markDirty(index, index + 1);
 }
 
 void wyTextureAtlas::putColor(wyColor4B* color, int index) {
+	wyAtlasVertex* v = m_vertices + index * 4;
 	for(int j = 0; j < 4; j++) {
-		memcpy(m_colors + index * sizeof(wyColor4B) * 4 + sizeof(wyColor4B) * j, color, sizeof(wyColor4B));
+		v[j].color = *color;
+	}
+	markDirty(index, index + 1);
+}
+
+void wyTextureAtlas::getTexCoords(int index, wyQuad2D* quadT) {
+	wyAtlasVertex* v = m_vertices + index * 4;
+	GLfloat* t = (GLfloat*)quadT;
+	for(int i = 0; i < 4; i++, v++, t += 2) {
+		t[0] = v->u;
+		t[1] = v->v;
+	}
+}
+
+void wyTextureAtlas::getVertex(int index, wyQuad3D* quadV) {
+	wyAtlasVertex* v = m_vertices + index * 4;
+	GLfloat* p = (GLfloat*)quadV;
+	for(int i = 0; i < 4; i++, v++, p += 3) {
+		p[0] = v->x;
+		p[1] = v->y;
+		p[2] = v->z;
 	}
 }
 
@@ -86,19 +250,20 @@ void wyTextureAtlas::reduceAlpha(float delta) {
 	if(m_withColorArray) {
 		// reduce alpha
 		int count = m_totalQuads * 4;
-		GLubyte* p = m_colors;
-		for(int i = 0; i < count; i++, p += sizeof(wyColor4B)) {
-			int alpha = p[3] & 0xff;
+		wyAtlasVertex* v = m_vertices;
+		for(int i = 0; i < count; i++, v++) {
+			int alpha = v->color.a & 0xff;
 			alpha -= delta * 255;
 			alpha = MAX(0, alpha);
-			p[3] = alpha & 0xff;
+			v->color.a = alpha & 0xff;
 		}
+		markDirty(0, m_totalQuads);
 
 		// purge quads
 		int endPurge = 0;
-		p = m_colors;
-		for(int i = 0; i < count; i++, p += 4 * sizeof(wyColor4B)) {
-			if(p[3] <= 0 && p[7] <= 0 && p[11] <= 0 && p[15] <= 0) {
+		v = m_vertices;
+		for(int i = 0; i < m_totalQuads; i++, v += 4) {
+			if(v[0].color.a <= 0 && v[1].color.a <= 0 && v[2].color.a <= 0 && v[3].color.a <= 0) {
 				endPurge++;
 			} else {
 				break;
@@ -113,13 +278,19 @@ void wyTextureAtlas::reduceAlpha(float delta) {
 }
 
 wyTextureAtlas::~wyTextureAtlas() {
+	// buffers of old generation are already released with context
+	if(m_vbo != 0 && m_bufferGeneration == sBufferGeneration) {
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ibo);
+	}
+
 	// release members
 	wyObjectRelease(m_tex);
 	wyFree(m_vertices);
-	wyFree(m_texCoords);
-	wyFree(m_indices);
-	if(m_colors != NULL)
-		wyFree(m_colors);
+	if(m_indices != NULL)
+		wyFree(m_indices);
+	if(m_freeSlots != NULL)
+		wyFree(m_freeSlots);
 }
 
 wyTextureAtlas* wyTextureAtlas::make(wyTexture2D* tex) {
@@ -131,14 +302,25 @@ wyTextureAtlas::wyTextureAtlas(wyTexture2D* tex, int capacity) :
 		m_totalQuads(0),
 		m_capacity((capacity > 0) ? capacity : ATLAS_DEFAULT_CAPACITY),
 		m_withColorArray(false),
-		m_colors(NULL),
-		m_color(wyc4bWhite) {
-	m_vertices = (GLfloat*)wyMalloc(m_capacity * sizeof(wyQuad3D));
-	m_texCoords = (GLfloat*)wyMalloc(m_capacity * sizeof(wyQuad2D));
-	m_indices = (GLushort*)wyMalloc(m_capacity * 6 * sizeof(GLushort));
+		m_indices(NULL),
+		m_indexType(0),
+		m_indexQuads(0),
+		m_useBuffer(false),
+		m_vbo(0),
+		m_ibo(0),
+		m_bufferCapacity(0),
+		m_bufferIndexQuads(0),
+		m_bufferGeneration(sBufferGeneration),
+		m_dirtyStart(0),
+		m_dirtyEnd(0),
+		m_color(wyc4bWhite),
+		m_stableSlots(false),
+		m_freeSlots(NULL),
+		m_freeCount(0),
+		m_freeCapacity(0) {
+	m_vertices = (wyAtlasVertex*)wyMalloc(m_capacity * QUAD_SIZE);
 
 	setTexture(tex);
-	initIndices();
 }
 
 void wyTextureAtlas::setTexture(wyTexture2D* tex) {
@@ -148,36 +330,31 @@ void wyTextureAtlas::setTexture(wyTexture2D* tex) {
 	m_tex = tex;
 }
 
+void wyTextureAtlas::setUseBufferObject(bool flag) {
+	if(m_useBuffer != flag) {
+		m_useBuffer = flag;
+
+		// buffer content may be stale, upload all next time
+		m_bufferCapacity = 0;
+	}
+}
+
 void wyTextureAtlas::resizeCapacity(int newCapacity) {
 	if(newCapacity <= m_capacity)
 		return;
 
-	// set new capacity
+	// set new capacity, vertex buffer will be reallocated in next draw
 	int oldCapacity = m_capacity;
 	m_capacity = newCapacity;
+	m_vertices = (wyAtlasVertex*)wyRealloc(m_vertices, newCapacity * QUAD_SIZE);
 
-	GLfloat* newVertices = (GLfloat*)wyMalloc(newCapacity * sizeof(wyQuad3D));
-	memcpy(newVertices, m_vertices, oldCapacity * sizeof(wyQuad3D));
-	wyFree(m_vertices);
-	m_vertices = newVertices;
-
-	GLfloat* newTexCoords = (GLfloat*)wyMalloc(newCapacity * sizeof(wyQuad2D));
-	memcpy(newTexCoords, m_texCoords, oldCapacity * sizeof(wyQuad2D));
-	wyFree(m_texCoords);
-	m_texCoords = newTexCoords;
-
-	GLushort* newIndices = (GLushort*)wyMalloc(newCapacity * 6 * sizeof(GLushort));
-	memcpy(newIndices, m_indices, oldCapacity * 6 * sizeof(GLushort));
-	wyFree(m_indices);
-	m_indices = newIndices;
-
-	initIndices();
-
+	// new quads use default color
 	if(m_withColorArray) {
-		GLubyte* newColors = (GLubyte*)wyMalloc(newCapacity * 4 * sizeof(wyColor4B));
-		memcpy(newColors, m_colors, oldCapacity * 4 * sizeof(wyColor4B));
-		wyFree(m_colors);
-		m_colors = newColors;
+		int count = (newCapacity - oldCapacity) * 4;
+		wyAtlasVertex* v = m_vertices + oldCapacity * 4;
+		for(int i = 0; i < count; i++, v++) {
+			v->color = m_color;
+		}
 	}
 }
 
@@ -195,18 +372,32 @@ void wyTextureAtlas::updateQuad(wyQuad2D& quadT, wyQuad3D& quadV, int index) {
 	}
 }
 
+void wyTextureAtlas::copyQuads(const wyAtlasVertex* vertices, int index, int count) {
+	if(index < 0 || count <= 0)
+		return;
+
+	// ensure capacity is ok
+	int capacity = m_capacity;
+	while(index + count > capacity)
+		capacity *= 2;
+	resizeCapacity(capacity);
+
+	memcpy(m_vertices + index * 4, vertices, count * QUAD_SIZE);
+	m_totalQuads = MAX(index + count, m_totalQuads);
+	markDirty(index, index + count);
+}
+
 void wyTextureAtlas::updateColor(wyColor4B color) {
 	if(!m_withColorArray)
 		initColorArray();
 
 	if(m_withColorArray) {
-		wyColor4B* c = (wyColor4B*)m_colors;
-		for(int i = 0; i < m_capacity * 4; i++) {
-			c[i].r = color.r;
-			c[i].g = color.g;
-			c[i].b = color.b;
-			c[i].a = color.a;
+		int count = m_capacity * 4;
+		wyAtlasVertex* v = m_vertices;
+		for(int i = 0; i < count; i++, v++) {
+			v->color = color;
 		}
+		markDirty(0, m_capacity);
 	}
 }
 
@@ -222,7 +413,23 @@ void wyTextureAtlas::updateColor(wyColor4B color, int index) {
 	}
 }
 
+void wyTextureAtlas::setStableSlots(bool flag) {
+	m_stableSlots = flag;
+	if(!flag)
+		m_freeCount = 0;
+}
+
 int wyTextureAtlas::appendQuad(wyQuad2D& quadT, wyQuad3D& quadV) {
+	// reuse a free slot, other quads are not moved
+	if(m_stableSlots && m_freeCount > 0) {
+		int index = m_freeSlots[--m_freeCount];
+		putTexCoords(&quadT, index);
+		putVertex(&quadV, index);
+		if(m_withColorArray)
+			putColor(&m_color, index);
+		return index;
+	}
+
 	int index = getNextAvailableIndex();
 	insertQuad(quadT, quadV, index);
 	return index;
@@ -240,16 +447,8 @@ void wyTextureAtlas::insertQuad(wyQuad2D& quadT, wyQuad3D& quadV, int index) {
 
 		// last object doesn't need to be moved
 		if(remaining > 0) {
-			// tex coordinates
-			memmove((GLubyte*)m_texCoords + (index + 1) * sizeof(wyQuad2D), (GLubyte*)m_texCoords + index * sizeof(wyQuad2D), remaining * sizeof(wyQuad2D));
-
-			// vertexCoordinates
-			memmove((GLubyte*)m_vertices + (index + 1) * sizeof(wyQuad3D), (GLubyte*)m_vertices + index * sizeof(wyQuad3D), remaining * sizeof(wyQuad3D));
-
-			// colors
-			if(m_withColorArray) {
-				memmove(m_colors + (index + 1) * sizeof(wyColor4B) * 4, m_colors + index * sizeof(wyColor4B) * 4, remaining * sizeof(wyColor4B) * 4);
-			}
+			memmove(m_vertices + (index + 1) * 4, m_vertices + index * 4, remaining * QUAD_SIZE);
+			markDirty(index + 1, m_totalQuads);
 		}
 
 		putTexCoords(&quadT, index);
@@ -261,21 +460,29 @@ void wyTextureAtlas::insertQuad(wyQuad2D& quadT, wyQuad3D& quadV, int index) {
 }
 
 void wyTextureAtlas::removeQuad(int index) {
+	// in stable slot mode, quad becomes degenerate and slot is kept for next append
+	if(m_stableSlots) {
+		if(index >= 0 && index < m_totalQuads) {
+			wyQuad3D quadV;
+			memset(&quadV, 0, sizeof(wyQuad3D));
+			putVertex(&quadV, index);
+
+			if(m_freeCount >= m_freeCapacity) {
+				m_freeCapacity = MAX(16, m_freeCapacity * 2);
+				m_freeSlots = (int*)wyRealloc(m_freeSlots, m_freeCapacity * sizeof(int));
+			}
+			m_freeSlots[m_freeCount++] = index;
+		}
+		return;
+	}
+
 	if(index >= 0 && index < m_totalQuads) {
 		int remaining = (m_totalQuads - 1) - index;
 
 		// last object doesn't need to be moved
 		if(remaining > 0) {
-			// tex coordinates
-			memmove((GLubyte*)m_texCoords + index * sizeof(wyQuad2D), (GLubyte*)m_texCoords + (index + 1) * sizeof(wyQuad2D), remaining * sizeof(wyQuad2D));
-
-			// vertexCoordinates
-			memmove((GLubyte*)m_vertices + index * sizeof(wyQuad3D), (GLubyte*)m_vertices + (index + 1) * sizeof(wyQuad3D), remaining * sizeof(wyQuad3D));
-
-			// colors
-			if(m_withColorArray) {
-				memmove(m_colors + index * sizeof(wyColor4B) * 4, m_colors + (index + 1) * sizeof(wyColor4B) * 4, remaining * sizeof(wyColor4B) * 4);
-			}
+			memmove(m_vertices + index * 4, m_vertices + (index + 1) * 4, remaining * QUAD_SIZE);
+			markDirty(index, m_totalQuads - 1);
 		}
 
 		m_totalQuads--;
@@ -294,16 +501,8 @@ void wyTextureAtlas::removeQuads(int start, int count) {
 
 	int remaining = m_totalQuads - start - count;
 	if(remaining > 0) {
-		// tex coordinates
-		memmove((GLubyte*)m_texCoords + start * sizeof(wyQuad2D), (GLubyte*)m_texCoords + (start + count) * sizeof(wyQuad2D), remaining * sizeof(wyQuad2D));
-
-		// vertexCoordinates
-		memmove((GLubyte*)m_vertices + start * sizeof(wyQuad3D), (GLubyte*)m_vertices + (start + count) * sizeof(wyQuad3D), remaining * sizeof(wyQuad3D));
-
-		// colors
-		if(m_withColorArray) {
-			memmove(m_colors + start * sizeof(wyColor4B) * 4, m_colors + (start + count) * sizeof(wyColor4B) * 4, remaining * sizeof(wyColor4B) * 4);
-		}
+		memmove(m_vertices + start * 4, m_vertices + (start + count) * 4, remaining * QUAD_SIZE);
+		markDirty(start, start + remaining);
 	}
 
 	m_totalQuads -= count;
@@ -311,27 +510,26 @@ void wyTextureAtlas::removeQuads(int start, int count) {
 
 void wyTextureAtlas::copyTo(int from, wyTextureAtlas* destAtlas) {
 	if(from >= 0 && from < m_totalQuads) {
-		GLubyte* tp = (GLubyte*)m_texCoords + from * sizeof(wyQuad2D);
-		GLubyte* vp = (GLubyte*)m_vertices + from * sizeof(wyQuad3D);
-		destAtlas->appendQuad(*(wyQuad2D*)tp, *(wyQuad3D*)vp);
+		wyQuad2D quadT;
+		wyQuad3D quadV;
+		getTexCoords(from, &quadT);
+		getVertex(from, &quadV);
+		destAtlas->appendQuad(quadT, quadV);
 	}
 }
 
 void wyTextureAtlas::copyTo(int from, wyQuad2D* quadT, wyQuad3D* quadV) {
 	if(from >= 0 && from < m_totalQuads) {
 		if(quadT != NULL) {
-			memcpy((GLubyte*)quadT, (GLubyte*)m_texCoords + from * sizeof(wyQuad2D), sizeof(wyQuad2D));
+			getTexCoords(from, quadT);
 		}
 		if(quadV != NULL) {
-			memcpy((GLubyte*)quadV, (GLubyte*)m_vertices + from * sizeof(wyQuad3D), sizeof(wyQuad3D));
+			getVertex(from, quadV);
 		}
 	}
 }
 
-void wyTextureAtlas::drawOne(int index) {
-	if(index < 0 || index >= m_totalQuads || m_tex == NULL)
-		return;
-
+void wyTextureAtlas::drawQuads(int start, int count) {
 	m_tex->load();
 
 	if(m_withColorArray) {
@@ -342,74 +540,67 @@ void wyTextureAtlas::drawOne(int index) {
 
 	m_tex->applyParameters();
 
-	glVertexPointer(3, GL_FLOAT, 0, m_vertices);
-	glTexCoordPointer(2, GL_FLOAT, 0, m_texCoords);
+	// if buffer is bound, pointers are offsets in buffer
+	int maxQuads = prepareIndices();
+	bool useBuffer = prepareBuffer();
+	const GLubyte* base = useBuffer ? NULL : (const GLubyte*)m_vertices;
+	const GLvoid* indices = useBuffer ? NULL : m_indices;
 
-	if(m_withColorArray) {
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_colors);
+	// split if quads can't be addressed by indices in one draw call
+	while(count > 0) {
+		int n = MIN(count, maxQuads);
+		const GLubyte* p = base + start * QUAD_SIZE;
+		glVertexPointer(3, GL_FLOAT, sizeof(wyAtlasVertex), p + offsetof(wyAtlasVertex, x));
+		glTexCoordPointer(2, GL_FLOAT, sizeof(wyAtlasVertex), p + offsetof(wyAtlasVertex, u));
+
+		if(m_withColorArray) {
+			glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(wyAtlasVertex), p + offsetof(wyAtlasVertex, color));
+		}
+
+		glDrawElements(GL_TRIANGLES, n * 6, m_indexType, indices);
+		gRenderQueue->countDrawCall();
+
+		start += n;
+		count -= n;
 	}
 
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, m_indices + index * 6);
+	if(useBuffer) {
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
 
 	if(m_withColorArray)
 		glDisableClientState(GL_COLOR_ARRAY);
 }
 
-bool wyTextureAtlas::drawRange(int start, int numOfQuads) {
-	if(start < 0 || start >= m_totalQuads || start + numOfQuads > m_totalQuads || m_tex == NULL) {
-		return false;
-	}
-
-	m_tex->load();
-
-	if(m_withColorArray) {
-		glEnableClientState(GL_COLOR_ARRAY);
-	}
+void wyTextureAtlas::drawOne(int index) {
+	gRenderQueue->flush();
 
-	glBindTexture(GL_TEXTURE_2D, m_tex->getTexture());
+	if(index < 0 || index >= m_totalQuads || m_tex == NULL)
+		return;
 
-	m_tex->applyParameters();
+	drawQuads(index, 1);
+}
 
-	glVertexPointer(3, GL_FLOAT, 0, m_vertices);
-	glTexCoordPointer(2, GL_FLOAT, 0, m_texCoords);
+bool wyTextureAtlas::drawRange(int start, int numOfQuads) {
+	gRenderQueue->flush();
 
-	if(m_withColorArray) {
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_colors);
+	if(start < 0 || start >= m_totalQuads || start + numOfQuads > m_totalQuads || m_tex == NULL) {
+		return false;
 	}
 
-	glDrawElements(GL_TRIANGLES, numOfQuads * 6, GL_UNSIGNED_SHORT, m_indices + start * 6);
-
-	if(m_withColorArray)
-		glDisableClientState(GL_COLOR_ARRAY);
+	drawQuads(start, numOfQuads);
 
 	return true;
 }
 
 void wyTextureAtlas::draw(int numOfQuads) {
+	gRenderQueue->flush();
+
 	if(m_tex == NULL)
 		return;
 
-	m_tex->load();
-
-	if(m_withColorArray) {
-		glEnableClientState(GL_COLOR_ARRAY);
-	}
-
-	glBindTexture(GL_TEXTURE_2D, m_tex->getTexture());
-
-	m_tex->applyParameters();
-
-	glVertexPointer(3, GL_FLOAT, 0, m_vertices);
-	glTexCoordPointer(2, GL_FLOAT, 0, m_texCoords);
-
-	if(m_withColorArray) {
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_colors);
-	}
-
-	glDrawElements(GL_TRIANGLES, numOfQuads * 6, GL_UNSIGNED_SHORT, m_indices);
-
-	if(m_withColorArray)
-		glDisableClientState(GL_COLOR_ARRAY);
+	drawQuads(0, MIN(numOfQuads, m_capacity));
 }
 
 void wyTextureAtlas::drawAll() {
@@ -418,11 +609,13 @@ void wyTextureAtlas::drawAll() {
 
 void wyTextureAtlas::iterateQuad3D(iterateQuad3DFunc func, void* data) {
 	if(func != NULL) {
-		GLubyte* v = (GLubyte*)m_vertices;
+		// callback may modify quad, so it is written back
+		wyQuad3D quadV;
 		for(int i = 0; i < m_totalQuads; i++) {
-			if(func(this, (wyQuad3D*)v, data))
-				v += sizeof(wyQuad3D);
-			else
+			getVertex(i, &quadV);
+			bool goon = func(this, &quadV, data);
+			putVertex(&quadV, i);
+			if(!goon)
 				break;
 		}
 	}
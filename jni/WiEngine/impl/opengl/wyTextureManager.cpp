@@ -30,10 +30,12 @@
 #include <stdlib.h>
 #include "wyDirector.h"
 #include "wyLog.h"
-#include "wyMD5.h"
 #include "wyGLTexture2D.h"
 #include "wyTypes.h"
 #include "wyUtils.h"
+#include "wyThread.h"
+#include "wyTargetSelector.h"
+#include "wyAtomic.h"
 
 wyTextureManager* gTextureManager;
 
@@ -41,21 +43,59 @@ wyTextureManager* gTextureManager;
 #define LABEL_ID_START 0x6f000000
 #define GL_ID_START 0x5f000000
 
+// initial capacity of handle table and key table
+#define INITIAL_HANDLE_CAPACITY 256
+#define INITIAL_KEY_CAPACITY 512
+
+// special handle value in key table slot
+#define SLOT_EMPTY -1
+#define SLOT_DELETED -2
+
+// default settings of async loading
+#define DEFAULT_DECODE_THREADS 2
+#define DEFAULT_UPLOAD_BUDGET (2 * 1024 * 1024)
+
 wyTextureManager::~wyTextureManager() {
-	// free real textures
+	// stop decode threads and wait them exit, they must not touch us after that
+	pthread_mutex_lock(&m_asyncMutex);
+	m_asyncQuit = true;
+	pthread_cond_broadcast(&m_asyncCond);
+	while(m_decodeThreadCount > 0)
+		pthread_cond_wait(&m_asyncCond, &m_asyncMutex);
+	pthread_mutex_unlock(&m_asyncMutex);
+
+	// free jobs which are not finished
+	while(m_requestHead != NULL) {
+		wyAsyncTextureJob* job = m_requestHead;
+		m_requestHead = job->next;
+		releaseJob(job);
+	}
+	while(m_decodeHead != NULL) {
+		wyAsyncTextureJob* job = m_decodeHead;
+		m_decodeHead = job->next;
+		releaseJob(job);
+	}
+	while(m_uploadHead != NULL) {
+		wyAsyncTextureJob* job = m_uploadHead;
+		m_uploadHead = job->next;
+		releaseJob(job);
+	}
+	pthread_cond_destroy(&m_asyncCond);
+	pthread_mutex_destroy(&m_asyncMutex);
+
+	// free real textures and handle hashs
 	for(int i = 0; i < m_textureCount; i++) {
 		if(m_textures[i] != NULL) {
 			m_textures[i]->release();
 		}
+		if(m_hashes[i].used) {
+			releaseTexHash(m_hashes[i]);
+		}
 	}
 	wyFree(m_textures);
-
-	// free handle hashs
-	for(map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->begin(); iter != m_textureHash->end(); iter++) {
-		releaseTexHash(iter->first, iter->second);
-	}
-	WYDELETE(m_textureHash);
-	m_textureHash = NULL;
+	wyFree(m_hashes);
+	wyFree(m_keyTable.slots);
+	wyFree(m_cloneTable.slots);
 
 	// free idle handle array
 	WYDELETE(m_idleHandles);
@@ -69,10 +109,26 @@ wyTextureManager::wyTextureManager() :
 		m_nextLabelId(LABEL_ID_START),
 		m_nextGLId(GL_ID_START),
 		m_texturePixelFormat(WY_TEXTURE_PIXEL_FORMAT_RGBA8888),
-		m_textures((wyGLTexture2D**)wyCalloc(1000, sizeof(wyGLTexture2D*))),
-		m_textureHash(WYNEW map<unsigned int, wyTextureHash>()) {
+		m_textures((wyGLTexture2D**)wyCalloc(INITIAL_HANDLE_CAPACITY, sizeof(wyGLTexture2D*))),
+		m_hashes((wyTextureHash*)wyCalloc(INITIAL_HANDLE_CAPACITY, sizeof(wyTextureHash))),
+		m_handleCapacity(INITIAL_HANDLE_CAPACITY),
+		m_requestHead(NULL),
+		m_requestTail(NULL),
+		m_decodeHead(NULL),
+		m_decodeTail(NULL),
+		m_uploadHead(NULL),
+		m_uploadTail(NULL),
+		m_decodeThreadCount(0),
+		m_maxDecodeThreads(DEFAULT_DECODE_THREADS),
+		m_asyncQuit(false),
+		m_asyncJobCount(0),
+		m_uploadBudget(DEFAULT_UPLOAD_BUDGET) {
 	m_idleHandles = WYNEW vector<int>();
 	m_idleHandles->reserve(100);
+	initHandleTable(m_keyTable, INITIAL_KEY_CAPACITY);
+	initHandleTable(m_cloneTable, INITIAL_KEY_CAPACITY);
+	pthread_mutex_init(&m_asyncMutex, NULL);
+	pthread_cond_init(&m_asyncCond, NULL);
 }
 
 wyTextureManager* wyTextureManager::getInstance() {
@@ -87,7 +143,7 @@ wyTextureManager* wyTextureManager::getInstanceNoCreate() {
 	return gTextureManager;
 }
 
-void wyTextureManager::releaseTexHash(unsigned int key, wyTextureHash& hash) {
+void wyTextureManager::releaseTexHash(wyTextureHash& hash) {
 	switch(hash.type) {
 		case CT_PATH:
 			wyFree((void*)hash.pp.path);
@@ -99,80 +155,420 @@ void wyTextureManager::releaseTexHash(unsigned int key, wyTextureHash& hash) {
 			wyFree((void*)hash.dp.data);
 			break;
 	}
-	wyFree((void*)hash.md5);
+	hash.used = false;
 }
 
-void wyTextureManager::invalidateAllTextures() {
-	for(int i = 0; i < m_textureCount; i++) {
-		if(m_textures[i])
-			m_textures[i]->deleteTexture(true);
+uint64_t wyTextureManager::keyForNum(int num) {
+	return wyUtils::hash64(&num, sizeof(int));
+}
+
+uint64_t wyTextureManager::keyForStr(const char* str) {
+	return wyUtils::strHash64(str);
+}
+
+uint64_t wyTextureManager::keyForData(const void* data, size_t length) {
+	return wyUtils::hash64(data, length);
+}
+
+uint64_t wyTextureManager::keyForClone(size_t sourceHandle, int cloneId) {
+	return ((uint64_t)sourceHandle << 32) | (uint32_t)cloneId;
+}
+
+// index of a key in a table which has specified mask
+static inline int slotIndex(uint64_t key, int mask) {
+	// fibonacci hashing, so that sequential clone keys are also spread
+	return (int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+void wyTextureManager::initHandleTable(wyHandleTable& table, int capacity) {
+	table.slots = (wyHandleSlot*)wyMalloc(capacity * sizeof(wyHandleSlot));
+	table.capacity = capacity;
+	table.used = 0;
+	for(int i = 0; i < capacity; i++)
+		table.slots[i].handle = SLOT_EMPTY;
+}
+
+int wyTextureManager::findHandle(wyHandleTable& table, uint64_t key) {
+	int mask = table.capacity - 1;
+	int i = slotIndex(key, mask);
+	while(true) {
+		wyHandleSlot& slot = table.slots[i];
+		if(slot.handle == SLOT_EMPTY)
+			return -1;
+		if(slot.handle != SLOT_DELETED && slot.key == key)
+			return slot.handle;
+		i = (i + 1) & mask;
 	}
 }
 
-const char* wyTextureManager::hashForNum(int num) {
-	return wyMD5::md5((const void*)&num, sizeof(int));
+void wyTextureManager::insertHandle(wyHandleTable& table, uint64_t key, int handle) {
+	// rehash if load factor reaches 3/4, deleted slots are dropped in rehashing
+	if((table.used + 1) * 4 >= table.capacity * 3) {
+		wyHandleSlot* oldSlots = table.slots;
+		int oldCapacity = table.capacity;
+		int live = 0;
+		for(int i = 0; i < oldCapacity; i++) {
+			if(oldSlots[i].handle >= 0)
+				live++;
+		}
+		int capacity = oldCapacity;
+		while((live + 1) * 2 >= capacity)
+			capacity *= 2;
+		initHandleTable(table, capacity);
+		for(int i = 0; i < oldCapacity; i++) {
+			if(oldSlots[i].handle >= 0)
+				insertHandle(table, oldSlots[i].key, oldSlots[i].handle);
+		}
+		wyFree(oldSlots);
+	}
+
+	// find an empty slot, deleted slot can't be reused until rehash because it is counted in used
+	int mask = table.capacity - 1;
+	int i = slotIndex(key, mask);
+	while(table.slots[i].handle != SLOT_EMPTY)
+		i = (i + 1) & mask;
+	table.slots[i].key = key;
+	table.slots[i].handle = handle;
+	table.used++;
 }
 
-const char* wyTextureManager::hashForStr(const char* str) {
-	return wyMD5::md5(str);
+void wyTextureManager::removeHandle(wyHandleTable& table, uint64_t key) {
+	int mask = table.capacity - 1;
+	int i = slotIndex(key, mask);
+	while(true) {
+		wyHandleSlot& slot = table.slots[i];
+		if(slot.handle == SLOT_EMPTY)
+			return;
+		if(slot.handle != SLOT_DELETED && slot.key == key) {
+			slot.handle = SLOT_DELETED;
+			return;
+		}
+		i = (i + 1) & mask;
+	}
 }
 
-const char* wyTextureManager::hashForData(const void* data, size_t length) {
-	return wyMD5::md5(data, length);
+wyTextureManager::wyTextureHash* wyTextureManager::findHash(uint64_t key) {
+	int handle = findHandle(m_keyTable, key);
+	return handle < 0 ? NULL : &m_hashes[handle];
 }
 
-bool wyTextureManager::switchToClonedTexture(wyTexture2D* t, int cloneId) {
-	for(map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->begin(); iter != m_textureHash->end(); iter++) {
-		wyTextureHash& hash = iter->second;
-		if(hash.isClone && hash.sourceHandle == t->m_handle && hash.cloneId == cloneId) {
-			t->m_handle = hash.handle;
-			t->m_md5 = hash.md5;
-			t->m_source = hash.source;
-			return true;
+wyTextureManager::wyTextureHash* wyTextureManager::hashOf(wyTexture2D* t) {
+	size_t handle = t->m_handle;
+	if(handle >= (size_t)m_textureCount)
+		return NULL;
+	wyTextureHash* hash = &m_hashes[handle];
+	return (hash->used && hash->key == t->m_key) ? hash : NULL;
+}
+
+size_t wyTextureManager::newHash(uint64_t key, wyTextureCreationType type) {
+	size_t handle = nextHandle();
+	wyTextureHash& hash = m_hashes[handle];
+	memset(&hash, 0, sizeof(wyTextureHash));
+	hash.used = true;
+	hash.type = type;
+	hash.key = key;
+	hash.handle = handle;
+	hash.firstClone = -1;
+	hash.nextClone = -1;
+	return handle;
+}
+
+void wyTextureManager::removeHash(size_t handle) {
+	wyTextureHash& hash = m_hashes[handle];
+	if(!hash.used)
+		return;
+
+	if(hash.isClone) {
+		// unlink from clone list of source
+		removeHandle(m_cloneTable, keyForClone(hash.sourceHandle, hash.cloneId));
+		int* link = &m_hashes[hash.sourceHandle].firstClone;
+		while(*link >= 0) {
+			if(*link == (int)handle) {
+				*link = hash.nextClone;
+				break;
+			}
+			link = &m_hashes[*link].nextClone;
 		}
+	} else {
+		removeHandle(m_keyTable, hash.key);
 	}
 
-	return false;
+	releaseTexHash(hash);
+	m_idleHandles->push_back(handle);
 }
 
-bool wyTextureManager::deleteClonedTexture(wyTexture2D* t, int cloneId) {
-	for(map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->begin(); iter != m_textureHash->end(); iter++) {
-		wyTextureHash& hash = iter->second;
-		if(hash.isClone && hash.sourceHandle == t->m_handle && hash.cloneId == cloneId) {
-			// release this cloned texture
-			if(m_textures[hash.handle]) {
-				m_textures[hash.handle]->release();
-				m_textures[hash.handle] = NULL;
+wyTexture2D* wyTextureManager::makeProxy(size_t handle) {
+	wyTextureHash& hash = m_hashes[handle];
+	wyTexture2D* tex = WYNEW wyTexture2D();
+	tex->m_handle = handle;
+	tex->m_key = hash.key;
+	tex->m_source = hash.source;
+	return (wyTexture2D*)tex->autoRelease();
+}
+
+void wyTextureManager::appendJob(wyAsyncTextureJob*& head, wyAsyncTextureJob*& tail, wyAsyncTextureJob* job) {
+	job->next = NULL;
+	if(tail == NULL) {
+		head = tail = job;
+	} else {
+		tail->next = job;
+		tail = job;
+	}
+}
+
+void wyTextureManager::releaseJob(wyAsyncTextureJob* job) {
+	wyObjectRelease(job->tex);
+	wyFree((void*)job->path);
+	wyFree(job);
+}
+
+void wyTextureManager::makeAsync(const char* path, wyTexturePixelFormat format, wyTextureLoadCallback* callback, void* data, bool isFile, float inDensity) {
+	if(path == NULL) {
+		LOGE("%s: path must be set", __FUNCTION__);
+		return;
+	}
+
+	// create job
+	wyAsyncTextureJob* job = (wyAsyncTextureJob*)wyCalloc(1, sizeof(wyAsyncTextureJob));
+	job->path = wyUtils::copy(path);
+	job->isFile = isFile;
+	job->format = format;
+	job->inDensity = inDensity;
+	job->data = data;
+	if(callback != NULL)
+		memcpy(&job->callback, callback, sizeof(wyTextureLoadCallback));
+	wyAtomicAdd(&m_asyncJobCount, 1);
+
+	// caller may be a loader thread, so texture cache is looked up later in OpenGL thread
+	pthread_mutex_lock(&m_asyncMutex);
+	appendJob(m_requestHead, m_requestTail, job);
+	pthread_mutex_unlock(&m_asyncMutex);
+}
+
+void wyTextureManager::dispatchJob(wyAsyncTextureJob* job) {
+	// if texture is already cached, no need to decode it
+	const char* path = job->path;
+	if(findHash(keyForStr(path)) != NULL) {
+		pthread_mutex_lock(&m_asyncMutex);
+		appendJob(m_uploadHead, m_uploadTail, job);
+		pthread_mutex_unlock(&m_asyncMutex);
+		return;
+	}
+
+	// create texture, it doesn't read file so it is cheap
+	job->tex = wyGLTexture2D::makeLazy(path, job->isFile, 0, job->format, job->inDensity);
+	job->tex->retain();
+
+	// queue it and start a decode thread if allowed
+	pthread_mutex_lock(&m_asyncMutex);
+	appendJob(m_decodeHead, m_decodeTail, job);
+	bool newThread = m_decodeThreadCount < m_maxDecodeThreads;
+	if(newThread)
+		m_decodeThreadCount++;
+	pthread_cond_signal(&m_asyncCond);
+	pthread_mutex_unlock(&m_asyncMutex);
+
+	if(newThread) {
+		if(wyThread::runThread(wyTargetSelector::make(this, SEL(wyTextureManager::decodeThreadEntry))) != 0) {
+			LOGW("%s: failed to create decode thread", __FUNCTION__);
+			pthread_mutex_lock(&m_asyncMutex);
+			m_decodeThreadCount--;
+
+			// if we don't have any thread, jobs will be decoded in gl thread
+			if(m_decodeThreadCount == 0) {
+				while(m_decodeHead != NULL) {
+					wyAsyncTextureJob* j = m_decodeHead;
+					m_decodeHead = j->next;
+					appendJob(m_uploadHead, m_uploadTail, j);
+				}
+				m_decodeTail = NULL;
 			}
+			pthread_mutex_unlock(&m_asyncMutex);
+		}
+	}
+}
+
+void wyTextureManager::decodeThreadEntry(wyTargetSelector* ts) {
+	pthread_mutex_lock(&m_asyncMutex);
+	while(true) {
+		// wait a job
+		while(!m_asyncQuit && m_decodeHead == NULL)
+			pthread_cond_wait(&m_asyncCond, &m_asyncMutex);
+		if(m_asyncQuit)
+			break;
+
+		// pop job
+		wyAsyncTextureJob* job = m_decodeHead;
+		m_decodeHead = job->next;
+		if(m_decodeHead == NULL)
+			m_decodeTail = NULL;
+		pthread_mutex_unlock(&m_asyncMutex);
+
+		// decode, texture is not visible to others so it is safe
+		job->failed = !job->tex->decode();
+		job->uploadBytes = job->tex->getDecodedLength();
+
+		// queue it for uploading
+		pthread_mutex_lock(&m_asyncMutex);
+		appendJob(m_uploadHead, m_uploadTail, job);
+	}
+
+	// notify manager that we are quit
+	m_decodeThreadCount--;
+	pthread_cond_broadcast(&m_asyncCond);
+	pthread_mutex_unlock(&m_asyncMutex);
+}
+
+wyTexture2D* wyTextureManager::finishJob(wyAsyncTextureJob* job) {
+	// if same texture is loaded during decoding, use cached one
+	uint64_t key = keyForStr(job->path);
+	int handle = findHandle(m_keyTable, key);
+	if(handle < 0) {
+		if(job->tex == NULL) {
+			// cached texture is removed before callback, load it again in common way
+			if(job->isFile)
+				return makeFile(job->path, 0, job->format, job->inDensity);
+			else
+				return make(job->path, 0, job->format, job->inDensity);
+		}
+
+		// create hash
+		handle = newHash(key, CT_PATH);
+		wyTextureHash& texHash = m_hashes[handle];
+		texHash.pixelFormat = job->format;
+		texHash.source = SOURCE_IMG;
+		texHash.inDensity = job->inDensity;
+		texHash.pp.path = wyUtils::copy(job->path);
+		texHash.pp.isFile = job->isFile;
+
+		// take over real texture
+		m_textures[handle] = job->tex;
+		job->tex = NULL;
+
+		// insert hash
+		insertHandle(m_keyTable, key, handle);
+	}
+
+	// create texture proxy and return
+	return makeProxy(handle);
+}
+
+void wyTextureManager::processAsyncUploads() {
+	if(m_asyncJobCount == 0)
+		return;
+
+	// dispatch new requests before uploading, so cached textures are found in OpenGL thread
+	pthread_mutex_lock(&m_asyncMutex);
+	wyAsyncTextureJob* request = m_requestHead;
+	m_requestHead = m_requestTail = NULL;
+	pthread_mutex_unlock(&m_asyncMutex);
+	while(request != NULL) {
+		wyAsyncTextureJob* next = request->next;
+		dispatchJob(request);
+		request = next;
+	}
 
-			// remove this texture hash
-			m_idleHandles->push_back(hash.handle);
-			releaseTexHash(0, hash);
-			m_textureHash->erase(iter);
+	size_t uploaded = 0;
+	bool first = true;
+	while(true) {
+		// pop a job if budget allows
+		pthread_mutex_lock(&m_asyncMutex);
+		wyAsyncTextureJob* job = m_uploadHead;
+		if(job != NULL && (first || uploaded + job->uploadBytes <= m_uploadBudget)) {
+			m_uploadHead = job->next;
+			if(m_uploadHead == NULL)
+				m_uploadTail = NULL;
+		} else {
+			job = NULL;
+		}
+		pthread_mutex_unlock(&m_asyncMutex);
+		if(job == NULL)
+			break;
 
-			return true;
+		// upload, if job is not decoded by thread it will be decoded here
+		if(job->tex != NULL && !job->failed) {
+			if(job->tex->m_decodedData == NULL)
+				job->failed = !job->tex->decode();
+		}
+		if(job->tex != NULL && !job->failed) {
+			job->tex->load();
+			if(job->tex->getTexture() == 0)
+				job->failed = true;
+		}
+		uploaded += job->uploadBytes;
+		if(job->tex != NULL)
+			first = false;
+
+		// callback
+		wyAtomicAdd(&m_asyncJobCount, -1);
+		if(job->failed) {
+			if(job->callback.onTextureLoadFailed != NULL)
+				job->callback.onTextureLoadFailed(job->path, job->data);
+		} else {
+			wyTexture2D* tex = finishJob(job);
+			if(job->callback.onTextureLoaded != NULL)
+				job->callback.onTextureLoaded(tex, job->data);
 		}
+
+		releaseJob(job);
+	}
+}
+
+void wyTextureManager::invalidateAllTextures() {
+	for(int i = 0; i < m_textureCount; i++) {
+		if(m_textures[i])
+			m_textures[i]->deleteTexture(true);
 	}
+}
 
-	return false;
+bool wyTextureManager::switchToClonedTexture(wyTexture2D* t, int cloneId) {
+	int handle = findHandle(m_cloneTable, keyForClone(t->m_handle, cloneId));
+	if(handle < 0)
+		return false;
+
+	wyTextureHash& hash = m_hashes[handle];
+	t->m_handle = hash.handle;
+	t->m_key = hash.key;
+	t->m_source = hash.source;
+	return true;
 }
 
-wyTexture2D* wyTextureManager::cloneTexture(wyTexture2D* t, int sourceHandle, const char* md5, int cloneId) {
+bool wyTextureManager::deleteClonedTexture(wyTexture2D* t, int cloneId) {
+	int handle = findHandle(m_cloneTable, keyForClone(t->m_handle, cloneId));
+	if(handle < 0)
+		return false;
+
+	// release this cloned texture
+	if(m_textures[handle]) {
+		m_textures[handle]->release();
+		m_textures[handle] = NULL;
+	}
+
+	// remove this texture hash
+	removeHash(handle);
+
+	return true;
+}
+
+wyTexture2D* wyTextureManager::cloneTexture(wyTexture2D* t, size_t sourceHandle, int cloneId) {
 	// can't clone empty texture
-	if(m_textures[sourceHandle] == NULL)
+	if(m_textures[sourceHandle] == NULL || !m_hashes[sourceHandle].used)
 		return NULL;
 
-	// get hash
-	unsigned int hashInt = wyUtils::strHash(md5);
-	wyTextureHash& sourceHash = (*m_textureHash)[hashInt];
-
 	// if source is also a clone, clone source of the source
-	if(sourceHash.isClone) {
-		return cloneTexture(t, sourceHash.sourceHandle, sourceHash.sourceMd5, cloneId);
+	if(m_hashes[sourceHandle].isClone) {
+		return cloneTexture(t, m_hashes[sourceHandle].sourceHandle, cloneId);
 	}
 
-	// create clone hash and copy source hash
-	wyTextureHash cloneHash;
+	// if clone id is used, return that clone
+	int handle = findHandle(m_cloneTable, keyForClone(sourceHandle, cloneId));
+	if(handle >= 0)
+		return makeProxy(handle);
+
+	// create clone hash, copy source hash after handle is allocated because table may be reallocated
+	handle = newHash(0, CT_RESID);
+	wyTextureHash& sourceHash = m_hashes[sourceHandle];
+	wyTextureHash& cloneHash = m_hashes[handle];
 	memcpy(&cloneHash, &sourceHash, sizeof(wyTextureHash));
 	switch(sourceHash.type) {
 		case CT_PATH:
@@ -182,47 +578,41 @@ wyTexture2D* wyTextureManager::cloneTexture(wyTexture2D* t, int sourceHandle, co
 			cloneHash.mp.mfsName = wyUtils::copy(sourceHash.mp.mfsName);
 			break;
 		case CT_DATA:
-			cloneHash.dp.data = wyUtils::copy(sourceHash.dp.data);
+			cloneHash.dp.data = wyUtils::copy(sourceHash.dp.data, 0, sourceHash.dp.length);
 			break;
 	}
 
-	// handle and source handle must be set for a cloned texture
-	cloneHash.handle = nextHandle();
+	// handle and source handle must be set for a cloned texture, key must be different with source
+	cloneHash.handle = handle;
 	cloneHash.isClone = true;
-	cloneHash.sourceHandle = sourceHash.handle;
-	cloneHash.sourceMd5 = sourceHash.md5;
+	cloneHash.sourceHandle = sourceHandle;
 	cloneHash.cloneId = cloneId;
+	cloneHash.key = sourceHash.key ^ keyForClone(sourceHandle, cloneId);
+	cloneHash.firstClone = -1;
 
-	// md5 must be different
-	char buf[64];
-	sprintf(buf, "%s_%d", sourceHash.md5, cloneId);
-	cloneHash.md5 = hashForStr(buf);
-	hashInt = wyUtils::strHash(cloneHash.md5);
-
-	// insert hash
-	(*m_textureHash)[hashInt] = cloneHash;
+	// link to source and insert into clone index
+	cloneHash.nextClone = sourceHash.firstClone;
+	sourceHash.firstClone = handle;
+	insertHandle(m_cloneTable, keyForClone(sourceHandle, cloneId), handle);
 
 	// create real texture
-	wyGLTexture2D* glTex = createGLTexture(sourceHash.md5, t);
+	wyGLTexture2D* glTex = createGLTexture(sourceHandle, t);
 	wyObjectRetain(glTex);
-	m_textures[cloneHash.handle] = glTex;
+	m_textures[handle] = glTex;
 
 	// update proxy texture info so that it points to cloned texture
-	wyTexture2D* ct = WYNEW wyTexture2D();
-	ct->m_handle = cloneHash.handle;
-	ct->m_md5 = cloneHash.md5;
-	ct->m_source = cloneHash.source;
-	return (wyTexture2D*)ct->autoRelease();
+	return makeProxy(handle);
 }
 
 wyTexture2D* wyTextureManager::cloneTexture(wyTexture2D* t, int cloneId) {
-	return cloneTexture(t, t->m_handle, t->m_md5, cloneId);
+	if(hashOf(t) == NULL)
+		return NULL;
+	return cloneTexture(t, t->m_handle, cloneId);
 }
 
-wyGLTexture2D* wyTextureManager::createGLTexture(const char* md5, wyTexture2D* t) {
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(wyUtils::strHash(md5));
-	if(iter != m_textureHash->end()) {
-		wyTextureHash& texHash = iter->second;
+wyGLTexture2D* wyTextureManager::createGLTexture(size_t handle, wyTexture2D* t) {
+	if(handle < (size_t)m_textureCount && m_hashes[handle].used) {
+		wyTextureHash& texHash = m_hashes[handle];
 		switch(texHash.type) {
 			case CT_RESID:
 				return wyGLTexture2D::make(texHash.rp.resId, texHash.transparentColor, texHash.pixelFormat);
@@ -268,9 +658,13 @@ wyGLTexture2D* wyTextureManager::createGLTexture(const char* md5, wyTexture2D* t
 }
 
 wyGLTexture2D* wyTextureManager::getTexture(wyTexture2D* t) {
+	// handle may be reused by other texture if proxy is stale
+	if(hashOf(t) == NULL)
+		return NULL;
+
 	size_t handle = t->m_handle;
 	if(m_textures[handle] == NULL) {
-		m_textures[handle] = createGLTexture(t->m_md5, t);
+		m_textures[handle] = createGLTexture(handle, t);
 		wyObjectRetain(m_textures[handle]);
 	}
 	return m_textures[handle];
@@ -282,325 +676,223 @@ wyTexture2D* wyTextureManager::make(int resId, int transparentColor, wyTexturePi
 		return NULL;
 	}
 
-	wyTextureHash texHash;
-	const char* hash = hashForNum(resId);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
+	uint64_t key = keyForNum(resId);
+	int handle = findHandle(m_keyTable, key);
+	if(handle < 0) {
 		// create hash
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_RESID;
+		handle = newHash(key, CT_RESID);
+		wyTextureHash& texHash = m_hashes[handle];
 		texHash.pixelFormat = format;
 		texHash.transparentColor = transparentColor;
 		texHash.source = SOURCE_IMG;
-		texHash.md5 = hash;
-		texHash.handle = nextHandle();
 		texHash.rp.resId = resId;
 
 		// create real texture
 		wyGLTexture2D* glTex = wyGLTexture2D::make(resId, transparentColor, format);
 		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+		m_textures[handle] = glTex;
 
 		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-	} else {
-		texHash = iter->second;
-        wyFree((void*) hash);
-    }
+		insertHandle(m_keyTable, key, handle);
+	}
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = texHash.handle;
-	tex->m_md5 = texHash.md5;
-	tex->m_source = texHash.source;
-	return (wyTexture2D*)tex->autoRelease();
+	return makeProxy(handle);
 }
 
 wyTexture2D* wyTextureManager::make(const char* assetPath, int transparentColor, wyTexturePixelFormat format, float inDensity) {
-	const char* hash = hashForStr(assetPath);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	wyTextureHash texHash;
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
+	uint64_t key = keyForStr(assetPath);
+	int handle = findHandle(m_keyTable, key);
+	if(handle < 0) {
 		// create hash
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_PATH;
+		handle = newHash(key, CT_PATH);
+		wyTextureHash& texHash = m_hashes[handle];
 		texHash.pixelFormat = format;
 		texHash.transparentColor = transparentColor;
 		texHash.source = SOURCE_IMG;
-		texHash.md5 = hash;
 		texHash.inDensity = inDensity;
-		texHash.handle = nextHandle();
 		texHash.pp.path = wyUtils::copy(assetPath);
 		texHash.pp.isFile = false;
 
 		// create real texture
 		wyGLTexture2D* glTex = wyGLTexture2D::make(assetPath, transparentColor, format, inDensity);
 		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+		m_textures[handle] = glTex;
 
 		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-	} else {
-		texHash = iter->second;
-        wyFree((void*) hash);
-    }
+		insertHandle(m_keyTable, key, handle);
+	}
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = texHash.handle;
-	tex->m_md5 = texHash.md5;
-	tex->m_source = texHash.source;
-	return (wyTexture2D*)tex->autoRelease();
+	return makeProxy(handle);
 }
 
 wyTexture2D* wyTextureManager::makeRaw(const char* data, size_t length, int transparentColor, wyTexturePixelFormat format, float inDensity) {
-	const char* hash = hashForData(data, length);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	wyTextureHash texHash;
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
+	uint64_t key = keyForData(data, length);
+	int handle = findHandle(m_keyTable, key);
+	if(handle < 0) {
 		// create hash
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_DATA;
+		handle = newHash(key, CT_DATA);
+		wyTextureHash& texHash = m_hashes[handle];
 		texHash.pixelFormat = format;
 		texHash.transparentColor = transparentColor;
 		texHash.source = SOURCE_IMG;
-		texHash.md5 = hash;
 		texHash.inDensity = inDensity;
-		texHash.handle = nextHandle();
 		texHash.dp.data = wyUtils::copy(data, 0, length);
 		texHash.dp.length = length;
 
 		// create real texture
 		wyGLTexture2D* glTex = wyGLTexture2D::makeRaw(texHash.dp.data, length, transparentColor, format, inDensity);
 		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+		m_textures[handle] = glTex;
 
 		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-	} else {
-		texHash = iter->second;
-        wyFree((void*) hash);
-    }
+		insertHandle(m_keyTable, key, handle);
+	}
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = texHash.handle;
-	tex->m_md5 = texHash.md5;
-	tex->m_source = texHash.source;
-	return (wyTexture2D*)tex->autoRelease();
+	return makeProxy(handle);
 }
 
 wyTexture2D* wyTextureManager::makeMemory(const char* mfsName, int transparentColor, wyTexturePixelFormat format, float inDensity) {
-	const char* hash = hashForStr(mfsName);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	wyTextureHash texHash;
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
+	uint64_t key = keyForStr(mfsName);
+	int handle = findHandle(m_keyTable, key);
+	if(handle < 0) {
 		// create hash
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_MFS;
+		handle = newHash(key, CT_MFS);
+		wyTextureHash& texHash = m_hashes[handle];
 		texHash.pixelFormat = format;
 		texHash.transparentColor = transparentColor;
 		texHash.source = SOURCE_IMG;
-		texHash.md5 = hash;
 		texHash.inDensity = inDensity;
-		texHash.handle = nextHandle();
 		texHash.mp.mfsName = wyUtils::copy(mfsName);
 
 		// create real texture
 		wyGLTexture2D* glTex = wyGLTexture2D::makeMemory(mfsName, transparentColor, format, inDensity);
 		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+		m_textures[handle] = glTex;
 
 		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-	} else {
-		texHash = iter->second;
-        wyFree((void*) hash);
-    }
+		insertHandle(m_keyTable, key, handle);
+	}
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = texHash.handle;
-	tex->m_md5 = texHash.md5;
-	tex->m_source = texHash.source;
-	return (wyTexture2D*)tex->autoRelease();
+	return makeProxy(handle);
 }
 
 wyTexture2D* wyTextureManager::makeFile(const char* fsPath, int transparentColor, wyTexturePixelFormat format, float inDensity) {
-	const char* hash = hashForStr(fsPath);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	wyTextureHash texHash;
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
+	uint64_t key = keyForStr(fsPath);
+	int handle = findHandle(m_keyTable, key);
+	if(handle < 0) {
 		// create hash
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_PATH;
+		handle = newHash(key, CT_PATH);
+		wyTextureHash& texHash = m_hashes[handle];
 		texHash.pixelFormat = format;
 		texHash.transparentColor = transparentColor;
 		texHash.source = SOURCE_IMG;
-		texHash.md5 = hash;
 		texHash.inDensity = inDensity;
-		texHash.handle = nextHandle();
 		texHash.pp.path = wyUtils::copy(fsPath);
 		texHash.pp.isFile = true;
 
 		// create real texture
 		wyGLTexture2D* glTex = wyGLTexture2D::makeFile(fsPath, transparentColor, format, inDensity);
 		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+		m_textures[handle] = glTex;
 
 		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-	} else {
-		texHash = iter->second;
-        wyFree((void*) hash);
-    }
+		insertHandle(m_keyTable, key, handle);
+	}
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = texHash.handle;
-	tex->m_md5 = texHash.md5;
-	tex->m_source = texHash.source;
-	return (wyTexture2D*)tex->autoRelease();
+	return makeProxy(handle);
 }
 
 wyTexture2D* wyTextureManager::makeLabel(const char* text, float fontSize, const char* fontPath, bool isFile, float width, wyTexture2D::TextAlignment alignment) {
-	const char* hash = hashForNum(m_nextLabelId++);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	wyTextureHash texHash;
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
-		// create hash
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_LABEL;
-		texHash.source = SOURCE_LABEL;
-		texHash.md5 = hash;
-		texHash.handle = nextHandle();
+	// label id is never reused, so hash is always new
+	uint64_t key = keyForNum(m_nextLabelId++);
+	size_t handle = newHash(key, CT_LABEL);
+	m_hashes[handle].source = SOURCE_LABEL;
 
-		// create real texture
-		wyGLTexture2D* glTex = wyGLTexture2D::makeLabel(text, fontSize, fontPath, isFile, width, alignment);
-		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+	// create real texture
+	wyGLTexture2D* glTex = wyGLTexture2D::makeLabel(text, fontSize, fontPath, isFile, width, alignment);
+	glTex->retain();
+	m_textures[handle] = glTex;
 
-		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-	} else {
-		texHash = iter->second;
-        wyFree((void*) hash);
-    }
+	// insert hash
+	insertHandle(m_keyTable, key, handle);
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = texHash.handle;
-	tex->m_md5 = texHash.md5;
-	tex->m_source = texHash.source;
+	wyTexture2D* tex = makeProxy(handle);
 	tex->m_text = wyUtils::copy(text);
 	tex->m_fontSize = fontSize;
 	tex->m_width = width;
 	tex->m_isFile = isFile;
 	tex->m_fontPath = wyUtils::copy(fontPath);
-	return (wyTexture2D*)tex->autoRelease();
+	return tex;
 }
 
 wyTexture2D* wyTextureManager::makeLabel(const char* text, float fontSize, wyFontStyle style, const char* fontName, float width, wyTexture2D::TextAlignment alignment) {
-	const char* hash = hashForNum(m_nextLabelId++);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	wyTextureHash texHash;
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
-		// create hash
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_LABEL;
-		texHash.source = SOURCE_LABEL;
-		texHash.md5 = hash;
-		texHash.handle = nextHandle();
+	// label id is never reused, so hash is always new
+	uint64_t key = keyForNum(m_nextLabelId++);
+	size_t handle = newHash(key, CT_LABEL);
+	m_hashes[handle].source = SOURCE_LABEL;
 
-		// create real texture
-		wyGLTexture2D* glTex = wyGLTexture2D::makeLabel(text, fontSize, style, fontName, width, alignment);
-		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+	// create real texture
+	wyGLTexture2D* glTex = wyGLTexture2D::makeLabel(text, fontSize, style, fontName, width, alignment);
+	glTex->retain();
+	m_textures[handle] = glTex;
 
-		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-	} else {
-		texHash = iter->second;
-        wyFree((void*) hash);
-    }
+	// insert hash
+	insertHandle(m_keyTable, key, handle);
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = texHash.handle;
-	tex->m_md5 = texHash.md5;
-	tex->m_source = texHash.source;
+	wyTexture2D* tex = makeProxy(handle);
 	tex->m_text = wyUtils::copy(text);
 	tex->m_fontSize = fontSize;
 	tex->m_style = style;
 	tex->m_width = width;
 	tex->m_fontName = wyUtils::copy(fontName);
-	return (wyTexture2D*)tex->autoRelease();
+	return tex;
 }
 
 wyTexture2D* wyTextureManager::makeGL(int texture, int w, int h) {
-	const char* hash = hashForNum(GL_ID_START + texture);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	wyTextureHash* pHash;
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
+	uint64_t key = keyForNum(GL_ID_START + texture);
+	int handle = findHandle(m_keyTable, key);
+	if(handle < 0) {
 		// create hash
-		wyTextureHash texHash;
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_OPENGL;
+		handle = newHash(key, CT_OPENGL);
+		wyTextureHash& texHash = m_hashes[handle];
 		texHash.source = SOURCE_OPENGL;
-		texHash.md5 = hash;
-		texHash.handle = nextHandle();
 		texHash.gp.ref = 1;
-        texHash.gp.w = w;
-        texHash.gp.h = h;
+		texHash.gp.w = w;
+		texHash.gp.h = h;
 
 		// create real texture
 		wyGLTexture2D* glTex = wyGLTexture2D::makeGL(texture, w, h);
 		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+		m_textures[handle] = glTex;
 
 		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-
-		// get pointer
-		pHash = &texHash;
+		insertHandle(m_keyTable, key, handle);
 	} else {
 		// increase reference
-		pHash = &iter->second;
-		pHash->gp.ref++;
-
-        wyFree((void*)hash);
-    }
+		m_hashes[handle].gp.ref++;
+	}
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = pHash->handle;
-	tex->m_md5 = pHash->md5;
-	tex->m_source = pHash->source;
-	return (wyTexture2D*)tex->autoRelease();
+	return makeProxy(handle);
 }
 
 wyTexture2D* wyTextureManager::makeRaw8888(const char* data, int width, int height, wyTexturePixelFormat format) {
-	size_t length = width * height * 4;
-	const char* hash = hashForData(data, length);
-	unsigned int hashInt = wyUtils::strHash(hash);
-	wyTextureHash texHash;
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(hashInt);
-	if(iter == m_textureHash->end()) {
+	uint64_t key = keyForData(data, width * height * 4);
+	int handle = findHandle(m_keyTable, key);
+	if(handle < 0) {
 		// create hash
-		memset(&texHash, 0, sizeof(wyTextureHash));
-		texHash.type = CT_DATA;
+		handle = newHash(key, CT_DATA);
+		wyTextureHash& texHash = m_hashes[handle];
+		size_t length = width * height * 4;
 		texHash.pixelFormat = format;
 		texHash.source = SOURCE_RAW8888;
-		texHash.md5 = hash;
-		texHash.handle = nextHandle();
 		texHash.dp.data = wyUtils::copy(data, 0, length);
 		texHash.dp.length = length;
 		texHash.dp.width = width;
@@ -609,21 +901,14 @@ wyTexture2D* wyTextureManager::makeRaw8888(const char* data, int width, int heig
 		// create real texture
 		wyGLTexture2D* glTex = wyGLTexture2D::makeRaw8888(texHash.dp.data, width, height, format);
 		glTex->retain();
-		m_textures[texHash.handle] = glTex;
+		m_textures[handle] = glTex;
 
 		// insert hash
-		(*m_textureHash)[hashInt] = texHash;
-	} else {
-		texHash = iter->second;
-        wyFree((void*) hash);
-    }
+		insertHandle(m_keyTable, key, handle);
+	}
 
 	// create texture proxy and return
-	wyTexture2D* tex = WYNEW wyTexture2D();
-	tex->m_handle = texHash.handle;
-	tex->m_md5 = texHash.md5;
-	tex->m_source = texHash.source;
-	return (wyTexture2D*)tex->autoRelease();
+	return makeProxy(handle);
 }
 
 size_t wyTextureManager::nextHandle() {
@@ -632,6 +917,15 @@ size_t wyTextureManager::nextHandle() {
 		m_idleHandles->pop_back();
 		return handle;
 	} else {
+		// grow handle table
+		if(m_textureCount >= m_handleCapacity) {
+			int capacity = m_handleCapacity * 2;
+			m_textures = (wyGLTexture2D**)wyRealloc(m_textures, capacity * sizeof(wyGLTexture2D*));
+			m_hashes = (wyTextureHash*)wyRealloc(m_hashes, capacity * sizeof(wyTextureHash));
+			memset(m_textures + m_handleCapacity, 0, (capacity - m_handleCapacity) * sizeof(wyGLTexture2D*));
+			memset(m_hashes + m_handleCapacity, 0, (capacity - m_handleCapacity) * sizeof(wyTextureHash));
+			m_handleCapacity = capacity;
+		}
 		return m_textureCount++;
 	}
 }
@@ -648,22 +942,21 @@ int wyTextureManager::getTextureCount() {
 }
 
 void wyTextureManager::releaseClonedTexture(int sourceHandle, bool removeHandle) {
-	for(map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->begin(); iter != m_textureHash->end(); iter++) {
-		wyTextureHash& hash = iter->second;
-		if(hash.isClone && hash.sourceHandle == sourceHandle) {
-			// release this cloned texture
-			if(m_textures[hash.handle]) {
-				m_textures[hash.handle]->release();
-				m_textures[hash.handle] = NULL;
-			}
-
-			if(removeHandle) {
-				// remove this texture hash
-				m_idleHandles->push_back(hash.handle);
-				releaseTexHash(0, hash);
-				m_textureHash->erase(iter);
-			}
+	int handle = m_hashes[sourceHandle].firstClone;
+	while(handle >= 0) {
+		int next = m_hashes[handle].nextClone;
+
+		// release this cloned texture
+		if(m_textures[handle]) {
+			m_textures[handle]->release();
+			m_textures[handle] = NULL;
 		}
+
+		// remove this texture hash
+		if(removeHandle)
+			removeHash(handle);
+
+		handle = next;
 	}
 }
 
@@ -671,25 +964,23 @@ void wyTextureManager::removeTexture(wyTexture2D* tex, bool removeHandle) {
 	if(tex == NULL)
 		return;
 
+	// if handle is already removed or reused, no need process
+	wyTextureHash* texHash = hashOf(tex);
+	if(texHash == NULL)
+		return;
+
 	/*
 	 * for opengl source texture, must check reference count
 	 * in wyTexture2D deconstructor, removeTexture will be invoked when source is opengl,
 	 * so we won't miss it
 	 */
 	if(tex->m_source == SOURCE_OPENGL) {
-		map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(wyUtils::strHash(tex->m_md5));
-		if(iter != m_textureHash->end()) {
-			// decrease reference count
-			wyTextureHash& texHash = iter->second;
-			texHash.gp.ref--;
-
-			// if reference count still larger than 0, no need process
-			if(texHash.gp.ref > 0)
-				return;
-		} else {
-			// if no texture hash found, no need process
+		// decrease reference count
+		texHash->gp.ref--;
+
+		// if reference count still larger than 0, no need process
+		if(texHash->gp.ref > 0)
 			return;
-		}
 	}
 
 	// release real texture
@@ -700,57 +991,38 @@ void wyTextureManager::removeTexture(wyTexture2D* tex, bool removeHandle) {
 	}
 
 	// no need to keep handle if removeHandle flag is set, this means the texture is a label opengl texture
-	bool needReleaseClone = false;
 	if(removeHandle) {
-		const char* hash = tex->m_md5;
-		map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(wyUtils::strHash(hash));
-		if(iter != m_textureHash->end()) {
-			wyTextureHash& texHash = iter->second;
-			if(!texHash.isClone)
-				needReleaseClone = true;
-			m_idleHandles->push_back(texHash.handle);
-			releaseTexHash(0, texHash);
-			m_textureHash->erase(iter);
-		}
+		// release cloned texture
+		if(!texHash->isClone)
+			releaseClonedTexture(handle, true);
+		removeHash(handle);
 	}
-
-	// release cloned texture
-	if(needReleaseClone)
-		releaseClonedTexture(handle, removeHandle);
 }
 
 void wyTextureManager::removeTexture(int resId) {
-	const char* hash = hashForNum(resId);
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(wyUtils::strHash(hash));
-	if(iter != m_textureHash->end()) {
-		wyTextureHash& texHash = iter->second;
-		if(m_textures[texHash.handle]) {
-			m_textures[texHash.handle]->release();
-			m_textures[texHash.handle] = NULL;
+	int handle = findHandle(m_keyTable, keyForNum(resId));
+	if(handle >= 0) {
+		if(m_textures[handle]) {
+			m_textures[handle]->release();
+			m_textures[handle] = NULL;
 		}
 
-		// release cloned texture if it is not cloned texture
-		if(!texHash.isClone)
-			releaseClonedTexture(texHash.handle);
+		// release cloned texture
+		releaseClonedTexture(handle);
 	}
-	wyFree((void*)hash);
 }
 
 void wyTextureManager::removeTexture(const char* name) {
-	const char* hash = hashForStr(name);
-	map<unsigned int, wyTextureHash>::iterator iter = m_textureHash->find(wyUtils::strHash(hash));
-	if(iter != m_textureHash->end()) {
-		wyTextureHash& texHash = iter->second;
-		if(m_textures[texHash.handle]) {
-			m_textures[texHash.handle]->release();
-			m_textures[texHash.handle] = NULL;
+	int handle = findHandle(m_keyTable, keyForStr(name));
+	if(handle >= 0) {
+		if(m_textures[handle]) {
+			m_textures[handle]->release();
+			m_textures[handle] = NULL;
 		}
 
-		// release cloned texture if it is not cloned texture
-		if(!texHash.isClone)
-			releaseClonedTexture(texHash.handle);
+		// release cloned texture
+		releaseClonedTexture(handle);
 	}
-	wyFree((void*)hash);
 }
 
 void wyTextureManager::removeAllTextures() {
@@ -35,3 +35,96 @@ wyParticle* wyParticleNew() {
 	particle->deltaColor = wyc4fWhite;
 	return particle;
 }
+
+// number of float arrays in wyParticleBuffer
+#define BUFFER_FIELD_COUNT 27
+
+wyParticleBuffer* wyParticleBufferNew(int capacity) {
+	wyParticleBuffer* buffer = (wyParticleBuffer*)wyCalloc(1, sizeof(wyParticleBuffer));
+	buffer->capacity = capacity;
+
+	// round stride up to multiple of 4 so that every array starts at 16 bytes boundary of the block
+	int stride = (capacity + 3) & ~3;
+	float* block = (float*)wyCalloc(BUFFER_FIELD_COUNT * stride, sizeof(float));
+	float** fields[BUFFER_FIELD_COUNT] = {
+		&buffer->posX, &buffer->posY, &buffer->startPosX, &buffer->startPosY,
+		&buffer->r, &buffer->g, &buffer->b, &buffer->a,
+		&buffer->deltaR, &buffer->deltaG, &buffer->deltaB, &buffer->deltaA,
+		&buffer->size, &buffer->deltaSize, &buffer->rotation, &buffer->deltaRotation,
+		&buffer->timeToLive, &buffer->dirX, &buffer->dirY, &buffer->radialAccel,
+		&buffer->tangentialAccel, &buffer->radian, &buffer->radianPerSecond, &buffer->radius,
+		&buffer->deltaRadius, &buffer->drawX, &buffer->drawY
+	};
+	for(int i = 0; i < BUFFER_FIELD_COUNT; i++) {
+		*fields[i] = block + i * stride;
+	}
+
+	return buffer;
+}
+
+void wyParticleBufferDestroy(wyParticleBuffer* buffer) {
+	// posX is the start of memory block
+	wyFree(buffer->posX);
+	wyFree(buffer);
+}
+
+void wyParticleBufferMove(wyParticleBuffer* buffer, int from, int to) {
+	if(from == to)
+		return;
+
+	buffer->posX[to] = buffer->posX[from];
+	buffer->posY[to] = buffer->posY[from];
+	buffer->startPosX[to] = buffer->startPosX[from];
+	buffer->startPosY[to] = buffer->startPosY[from];
+	buffer->r[to] = buffer->r[from];
+	buffer->g[to] = buffer->g[from];
+	buffer->b[to] = buffer->b[from];
+	buffer->a[to] = buffer->a[from];
+	buffer->deltaR[to] = buffer->deltaR[from];
+	buffer->deltaG[to] = buffer->deltaG[from];
+	buffer->deltaB[to] = buffer->deltaB[from];
+	buffer->deltaA[to] = buffer->deltaA[from];
+	buffer->size[to] = buffer->size[from];
+	buffer->deltaSize[to] = buffer->deltaSize[from];
+	buffer->rotation[to] = buffer->rotation[from];
+	buffer->deltaRotation[to] = buffer->deltaRotation[from];
+	buffer->timeToLive[to] = buffer->timeToLive[from];
+	buffer->dirX[to] = buffer->dirX[from];
+	buffer->dirY[to] = buffer->dirY[from];
+	buffer->radialAccel[to] = buffer->radialAccel[from];
+	buffer->tangentialAccel[to] = buffer->tangentialAccel[from];
+	buffer->radian[to] = buffer->radian[from];
+	buffer->radianPerSecond[to] = buffer->radianPerSecond[from];
+	buffer->radius[to] = buffer->radius[from];
+	buffer->deltaRadius[to] = buffer->deltaRadius[from];
+	buffer->drawX[to] = buffer->drawX[from];
+	buffer->drawY[to] = buffer->drawY[from];
+}
+
+void wyParticleBufferGet(wyParticleBuffer* buffer, int index, wyParticle* particle) {
+	particle->pos.x = buffer->posX[index];
+	particle->pos.y = buffer->posY[index];
+	particle->startPos.x = buffer->startPosX[index];
+	particle->startPos.y = buffer->startPosY[index];
+	particle->color.r = buffer->r[index];
+	particle->color.g = buffer->g[index];
+	particle->color.b = buffer->b[index];
+	particle->color.a = buffer->a[index];
+	particle->deltaColor.r = buffer->deltaR[index];
+	particle->deltaColor.g = buffer->deltaG[index];
+	particle->deltaColor.b = buffer->deltaB[index];
+	particle->deltaColor.a = buffer->deltaA[index];
+	particle->size = buffer->size[index];
+	particle->deltaSize = buffer->deltaSize[index];
+	particle->rotation = buffer->rotation[index];
+	particle->deltaRotation = buffer->deltaRotation[index];
+	particle->timeToLive = buffer->timeToLive[index];
+	particle->direction.x = buffer->dirX[index];
+	particle->direction.y = buffer->dirY[index];
+	particle->radialAccel = buffer->radialAccel[index];
+	particle->tangentialAccel = buffer->tangentialAccel[index];
+	particle->radian = buffer->radian[index];
+	particle->radianPerSecond = buffer->radianPerSecond[index];
+	particle->radius = buffer->radius[index];
+	particle->deltaRadius = buffer->deltaRadius[index];
+}
@@ -29,99 +29,102 @@
 #include "wyParticleSystem.h"
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "wyLog.h"
 
-bool wyParticleSystem::releaseParticle(wyArray* arr, void* ptr, int index, void* data) {
-	wyFree(ptr);
-	return true;
-}
+void wyParticleSystem::initParticle(int index) {
+	wyParticleBuffer* b = m_particles;
 
-void wyParticleSystem::initParticle(wyParticle* particle) {
 	// timeToLive
 	// no negative life. prevent division by 0
-	particle->timeToLive = MAX(0, m_life + m_lifeVar * wyMath::randMinusOneToOne());
+	float life = MAX(0, m_life + m_lifeVar * randMinusOneToOne());
+	b->timeToLive[index] = life;
 
 	// position
-	particle->pos.x = m_centerOfGravity.x + m_centerOfGravityVar.x * wyMath::randMinusOneToOne();
-	particle->pos.y = m_centerOfGravity.y + m_centerOfGravityVar.y * wyMath::randMinusOneToOne();
+	b->posX[index] = m_centerOfGravity.x + m_centerOfGravityVar.x * randMinusOneToOne();
+	b->posY[index] = m_centerOfGravity.y + m_centerOfGravityVar.y * randMinusOneToOne();
 
 	// Color
 	wyColor4F start = wyc4fWhite;
-	start.r = MIN(1, MAX(0, m_startColor.r + m_startColorVar.r * wyMath::randMinusOneToOne()));
-	start.g = MIN(1, MAX(0, m_startColor.g + m_startColorVar.g * wyMath::randMinusOneToOne()));
-	start.b = MIN(1, MAX(0, m_startColor.b + m_startColorVar.b * wyMath::randMinusOneToOne()));
-	start.a = MIN(1, MAX(0, m_startColor.a + m_startColorVar.a * wyMath::randMinusOneToOne()));
+	start.r = MIN(1, MAX(0, m_startColor.r + m_startColorVar.r * randMinusOneToOne()));
+	start.g = MIN(1, MAX(0, m_startColor.g + m_startColorVar.g * randMinusOneToOne()));
+	start.b = MIN(1, MAX(0, m_startColor.b + m_startColorVar.b * randMinusOneToOne()));
+	start.a = MIN(1, MAX(0, m_startColor.a + m_startColorVar.a * randMinusOneToOne()));
 
 	wyColor4F end = wyc4fWhite;
-	end.r = MIN(1, MAX(0, m_endColor.r + m_endColorVar.r * wyMath::randMinusOneToOne()));
-	end.g = MIN(1, MAX(0, m_endColor.g + m_endColorVar.g * wyMath::randMinusOneToOne()));
-	end.b = MIN(1, MAX(0, m_endColor.b + m_endColorVar.b * wyMath::randMinusOneToOne()));
-	end.a = MIN(1, MAX(0, m_endColor.a + m_endColorVar.a * wyMath::randMinusOneToOne()));
-
-	particle->color = start;
-	particle->deltaColor.r = (end.r - start.r) / particle->timeToLive;
-	particle->deltaColor.g = (end.g - start.g) / particle->timeToLive;
-	particle->deltaColor.b = (end.b - start.b) / particle->timeToLive;
-	particle->deltaColor.a = (end.a - start.a) / particle->timeToLive;
+	end.r = MIN(1, MAX(0, m_endColor.r + m_endColorVar.r * randMinusOneToOne()));
+	end.g = MIN(1, MAX(0, m_endColor.g + m_endColorVar.g * randMinusOneToOne()));
+	end.b = MIN(1, MAX(0, m_endColor.b + m_endColorVar.b * randMinusOneToOne()));
+	end.a = MIN(1, MAX(0, m_endColor.a + m_endColorVar.a * randMinusOneToOne()));
+
+	b->r[index] = start.r;
+	b->g[index] = start.g;
+	b->b[index] = start.b;
+	b->a[index] = start.a;
+	b->deltaR[index] = (end.r - start.r) / life;
+	b->deltaG[index] = (end.g - start.g) / life;
+	b->deltaB[index] = (end.b - start.b) / life;
+	b->deltaA[index] = (end.a - start.a) / life;
 
 	// size
-	float startS = MAX(0, m_startSize + m_startSizeVar * wyMath::randMinusOneToOne()); // no negative size
+	float startS = MAX(0, m_startSize + m_startSizeVar * randMinusOneToOne()); // no negative size
 
-	particle->size = startS;
+	b->size[index] = startS;
 	if(m_endSize == PARTICLE_START_SIZE_EQUAL_TO_END_SIZE)
-		particle->deltaSize = 0;
+		b->deltaSize[index] = 0;
 	else {
-		float endS = m_endSize + m_endSizeVar * wyMath::randMinusOneToOne();
+		float endS = m_endSize + m_endSizeVar * randMinusOneToOne();
 		endS = MAX(0, endS);
-		particle->deltaSize = (endS - startS) / particle->timeToLive;
+		b->deltaSize[index] = (endS - startS) / life;
 	}
 
 	// rotation
-	float startA = m_startSpin + m_startSpinVar * wyMath::randMinusOneToOne();
-	float endA = m_endSpin + m_endSpinVar * wyMath::randMinusOneToOne();
-	particle->rotation = startA;
-	particle->deltaRotation = (endA - startA) / particle->timeToLive;
+	float startA = m_startSpin + m_startSpinVar * randMinusOneToOne();
+	float endA = m_endSpin + m_endSpinVar * randMinusOneToOne();
+	b->rotation[index] = startA;
+	b->deltaRotation[index] = (endA - startA) / life;
 
 	// position
+	wyPoint startPos = wypZero;
 	if(m_positionType == FREE)
-		particle->startPos = nodeToWorldSpace(particle->startPos);
+		startPos = nodeToWorldSpace(startPos);
 	else if(m_positionType == RELATIVE_TO_PARENT)
-		particle->startPos = nodeToParentSpace(particle->startPos);
+		startPos = nodeToParentSpace(startPos);
+	b->startPosX[index] = startPos.x;
+	b->startPosY[index] = startPos.y;
 
 	// direction
-	float a = wyMath::d2r(m_angle + m_angleVar * wyMath::randMinusOneToOne());
+	float a = wyMath::d2r(m_angle + m_angleVar * randMinusOneToOne());
 
 	// Mode Gravity: A
 	if(m_emitterMode == GRAVITY) {
-		wyPoint v = wypZero;
-		v.y = wyMath::sin(a);
-		v.x = wyMath::cos(a);
-		float s = m_speed + m_speedVar * wyMath::randMinusOneToOne();
+		float s = m_speed + m_speedVar * randMinusOneToOne();
 
 		// direction
-		particle->direction = wypMul(v, wyp(s, s));
+		b->dirX[index] = wyMath::cos(a) * s;
+		b->dirY[index] = wyMath::sin(a) * s;
 
 		// radial accel
-		particle->radialAccel = m_radialAccel + m_radialAccelVar * wyMath::randMinusOneToOne();
+		b->radialAccel[index] = m_radialAccel + m_radialAccelVar * randMinusOneToOne();
 
 		// tangential accel
-		particle->tangentialAccel = m_tangentialAccel + m_tangentialAccelVar * wyMath::randMinusOneToOne();
+		b->tangentialAccel[index] = m_tangentialAccel + m_tangentialAccelVar * randMinusOneToOne();
 	} else {
 		// Mode Radius: B
 
 		// Set the default diameter of the particle from the source position
-		float sRadius = m_startRadius + m_startRadiusVar * wyMath::randMinusOneToOne();
-		float eRadius = m_endRadius + m_endRadiusVar * wyMath::randMinusOneToOne();
+		float sRadius = m_startRadius + m_startRadiusVar * randMinusOneToOne();
+		float eRadius = m_endRadius + m_endRadiusVar * randMinusOneToOne();
 
-		particle->radius = sRadius;
+		b->radius[index] = sRadius;
 
 		if(m_endRadius == PARTICLE_START_RADIUS_EQUAL_TO_END_RADIUS)
-			particle->deltaRadius = 0;
+			b->deltaRadius[index] = 0;
 		else
-			particle->deltaRadius = (eRadius - sRadius) / particle->timeToLive;
+			b->deltaRadius[index] = (eRadius - sRadius) / life;
 
-		particle->radian = a;
-		particle->radianPerSecond = wyMath::d2r(m_rotationDegree + m_rotationDegreeVar * wyMath::randMinusOneToOne());
+		b->radian[index] = a;
+		b->radianPerSecond[index] = wyMath::d2r(m_rotationDegree + m_rotationDegreeVar * randMinusOneToOne());
 	}
 }
 
@@ -129,19 +132,14 @@ bool wyParticleSystem::addParticle() {
 	if(isFull())
 		return false;
 
-	wyParticle* particle = wyParticleNew();
-
-	initParticle(particle);
-	wyArrayPush(m_particles, particle);
+	initParticle(m_particleCount);
 	m_particleCount++;
 
 	return true;
 }
 
 wyParticleSystem::~wyParticleSystem() {
-	wyArrayEach(m_particles, releaseParticle, NULL);
-	wyArrayClear(m_particles);
-	wyArrayDestroy(m_particles);
+	wyParticleBufferDestroy(m_particles);
 	wyObjectRelease(m_tex);
 }
 
@@ -189,9 +187,9 @@ wyParticleSystem::wyParticleSystem(int numberOfParticles) :
 		m_startSpinVar(0),
 		m_endSpin(0),
 		m_endSpinVar(0),
+		m_particles(wyParticleBufferNew(numberOfParticles)),
 		m_maxParticles(numberOfParticles),
 		m_particleCount(0),
-		m_particles(wyArrayNew(numberOfParticles)),
 		m_emissionRate(0),
 		m_emitCounter(0),
 		m_tex(NULL),
@@ -216,7 +214,8 @@ wyParticleSystem::wyParticleSystem(int numberOfParticles) :
 		m_endRadius(0),
 		m_endRadiusVar(0),
 		m_rotationDegree(0),
-		m_rotationDegreeVar(0) {
+		m_rotationDegreeVar(0),
+		m_randSeed(rand() | 1) {
 	// update after action in run!
     wyTargetSelector* ts = wyTargetSelector::make(this, SEL(wyParticleSystem::update));
     m_timer = wyTimer::make(ts);
@@ -234,9 +233,8 @@ void wyParticleSystem::resetSystem() {
 	m_active = true;
 	m_pendingPosition = false;
 	m_elapsed = 0;
-	for(m_particleIdx = 0; m_particleIdx < m_particleCount; ++m_particleIdx) {
-		wyParticle* p = (wyParticle*)wyArrayGet(m_particles, m_particleIdx);
-		p->timeToLive = 0;
+	for(int i = 0; i < m_particleCount; i++) {
+		m_particles->timeToLive[i] = 0;
 	}
 }
 
@@ -275,115 +273,152 @@ void wyParticleSystem::update(wyTargetSelector* ts) {
 			stopSystem();
 	}
 
-	m_particleIdx = 0;
+	wyParticleBuffer* b = m_particles;
+	int count = m_particleCount;
 
-	wyPoint currentPosition = wypZero;
-	if(m_positionType == FREE)
-		currentPosition = nodeToWorldSpace(currentPosition);
-	else if(m_positionType == RELATIVE_TO_PARENT)
-		currentPosition = nodeToParentSpace(currentPosition);
-
-	while(m_particleIdx < m_particleCount) {
-		wyParticle* p = (wyParticle*)wyArrayGet(m_particles, m_particleIdx);
-
-		// life
-		p->timeToLive -= dt;
-
-		if(p->timeToLive > 0) {
-			// Mode A: gravity, direction, tangential accel & radial accel
-			if(m_emitterMode == GRAVITY) {
-				wyPoint tmp, radial, tangential;
-
-				// radial acceleration
-				radial = wypZero;
-				if(p->pos.x != 0 || p->pos.y != 0)
-					radial = wypNormalize(p->pos);
-				tangential = radial;
-				radial = wypMul(radial, wyp(p->radialAccel, p->radialAccel));
-
-				// tangential acceleration
-				float newy = tangential.x;
-				tangential.x = -tangential.y;
-				tangential.y = newy;
-				tangential = wypMul(tangential, wyp(p->tangentialAccel, p->tangentialAccel));
-
-				// (gravity + radial + tangential) * dt
-				tmp = radial;
-				tmp = wypAdd(tmp, tangential);
-				tmp = wypAdd(tmp, m_gravity);
-				tmp = wypMul(tmp, wyp(dt, dt));
-				p->direction = wypAdd(p->direction, tmp);
-				tmp = wypMul(p->direction, wyp(dt, dt));
-				p->pos = wypAdd(p->pos, tmp);
-			} else {
-				// Mode B: radius movement
-				// Update the angle and radius of the particle.
-				p->radian += p->radianPerSecond * dt;
-				p->radius += p->deltaRadius * dt;
-
-				p->pos.x = -wyMath::cos(p->radian) * p->radius;
-				p->pos.y = -wyMath::sin(p->radian) * p->radius;
-			}
-
-			// color
-			p->color.r += (p->deltaColor.r * dt);
-			p->color.g += (p->deltaColor.g * dt);
-			p->color.b += (p->deltaColor.b * dt);
-			p->color.a += (p->deltaColor.a * dt);
-
-			// size
-			p->size += (p->deltaSize * dt);
-			p->size = MAX(0, p->size);
-
-			// angle
-			p->rotation += (p->deltaRotation * dt);
-
-			//
-			// update values in quad
-			//
-			wyPoint newPos;
-			if(m_positionType == FREE || m_positionType == RELATIVE_TO_PARENT) {
-				wyPoint diff = wypSub(currentPosition, p->startPos);
-				newPos = wypSub(p->pos, diff);
-			} else
-				newPos = p->pos;
-
-			updateQuadWithParticle(p, newPos);
-
-			// update particle counter
-			m_particleIdx++;
+	// life
+	float* life = b->timeToLive;
+	for(int i = 0; i < count; i++) {
+		life[i] -= dt;
+	}
+
+	// remove dead particles, live particles are kept packed by moving last one to the hole
+	for(int i = 0; i < count;) {
+		if(life[i] > 0) {
+			i++;
 		} else {
-			// life < 0
-			wyParticle* particle = NULL;
-			if(m_particleIdx != m_particleCount - 1) {
-				wyParticle* lastParticle = (wyParticle*)wyArrayDeleteIndex(m_particles, m_particleCount - 1);
-				particle = (wyParticle*)wyArrayDeleteIndex(m_particles, m_particleIdx);
-				wyArrayInsert(m_particles, lastParticle, m_particleIdx);
-			} else {
-				particle = (wyParticle*)wyArrayDeleteIndex(m_particles, m_particleIdx);
-            }
-
-			// free particle
-			if(particle)
-				wyFree(particle);
-            
-			// decrease count
-			m_particleCount--;
-
-			// auto remove if flag is set and particle count is zero
-			if(m_particleCount == 0 && m_autoRemoveOnFinish) {
-				unscheduleLocked(m_timer);
-				m_parent->removeChildLocked(this, true);
-				return;
-			}
+			count--;
+			wyParticleBufferMove(b, count, i);
 		}
 	}
+	bool died = count < m_particleCount;
+	m_particleCount = count;
+
+	// auto remove if flag is set and particle count is zero
+	if(died && m_particleCount == 0 && m_autoRemoveOnFinish) {
+		m_particleIdx = 0;
+		unscheduleLocked(m_timer);
+		m_parent->removeChildLocked(this, true);
+		return;
+	}
+
+	// movement
+	if(m_emitterMode == GRAVITY)
+		updateGravityMode(dt);
+	else
+		updateRadiusMode(dt);
+
+	// color
+	float* r = b->r;
+	float* g = b->g;
+	float* bl = b->b;
+	float* a = b->a;
+	float* dr = b->deltaR;
+	float* dg = b->deltaG;
+	float* db = b->deltaB;
+	float* da = b->deltaA;
+	for(int i = 0; i < count; i++) {
+		r[i] += dr[i] * dt;
+		g[i] += dg[i] * dt;
+		bl[i] += db[i] * dt;
+		a[i] += da[i] * dt;
+	}
+
+	// size and angle
+	float* size = b->size;
+	float* deltaSize = b->deltaSize;
+	float* rotation = b->rotation;
+	float* deltaRotation = b->deltaRotation;
+	for(int i = 0; i < count; i++) {
+		float s = size[i] + deltaSize[i] * dt;
+		size[i] = s > 0 ? s : 0;
+		rotation[i] += deltaRotation[i] * dt;
+	}
+
+	// render position
+	float* posX = b->posX;
+	float* posY = b->posY;
+	float* drawX = b->drawX;
+	float* drawY = b->drawY;
+	if(m_positionType == FREE || m_positionType == RELATIVE_TO_PARENT) {
+		wyPoint currentPosition = wypZero;
+		if(m_positionType == FREE)
+			currentPosition = nodeToWorldSpace(currentPosition);
+		else
+			currentPosition = nodeToParentSpace(currentPosition);
+
+		float cx = currentPosition.x;
+		float cy = currentPosition.y;
+		float* startPosX = b->startPosX;
+		float* startPosY = b->startPosY;
+		for(int i = 0; i < count; i++) {
+			drawX[i] = posX[i] - (cx - startPosX[i]);
+			drawY[i] = posY[i] - (cy - startPosY[i]);
+		}
+	} else {
+		memcpy(drawX, posX, count * sizeof(float));
+		memcpy(drawY, posY, count * sizeof(float));
+	}
+
+	// update vertices
+	m_particleIdx = count;
+	updateParticleVertices();
 
 	postStep();
 
 	m_updating = false;
 }
 
+void wyParticleSystem::updateGravityMode(float dt) {
+	int count = m_particleCount;
+	float gx = m_gravity.x;
+	float gy = m_gravity.y;
+	float* posX = m_particles->posX;
+	float* posY = m_particles->posY;
+	float* dirX = m_particles->dirX;
+	float* dirY = m_particles->dirY;
+	float* radialAccel = m_particles->radialAccel;
+	float* tangentialAccel = m_particles->tangentialAccel;
+	for(int i = 0; i < count; i++) {
+		// radial direction, zero if particle is at origin
+		float x = posX[i];
+		float y = posY[i];
+		float lenSq = x * x + y * y;
+		float rLen = lenSq > 0 ? 1.0f / sqrtf(lenSq) : 0;
+		float rx = x * rLen;
+		float ry = y * rLen;
+
+		// (gravity + radial + tangential) * dt, tangential direction is radial rotated by 90 degrees
+		float ra = radialAccel[i];
+		float ta = tangentialAccel[i];
+		float ax = rx * ra - ry * ta + gx;
+		float ay = ry * ra + rx * ta + gy;
+		dirX[i] += ax * dt;
+		dirY[i] += ay * dt;
+		posX[i] += dirX[i] * dt;
+		posY[i] += dirY[i] * dt;
+	}
+}
+
+void wyParticleSystem::updateRadiusMode(float dt) {
+	int count = m_particleCount;
+	float* posX = m_particles->posX;
+	float* posY = m_particles->posY;
+	float* radian = m_particles->radian;
+	float* radianPerSecond = m_particles->radianPerSecond;
+	float* radius = m_particles->radius;
+	float* deltaRadius = m_particles->deltaRadius;
+	for(int i = 0; i < count; i++) {
+		// Update the angle and radius of the particle.
+		radian[i] += radianPerSecond[i] * dt;
+		radius[i] += deltaRadius[i] * dt;
+	}
+	for(int i = 0; i < count; i++) {
+		posX[i] = -wyMath::cos(radian[i]) * radius[i];
+		posY[i] = -wyMath::sin(radian[i]) * radius[i];
+	}
+}
+
 void wyParticleSystem::setBlendAdditive(bool additive) {
 	if(additive) {
 		m_blendFunc.src = GL_SRC_ALPHA;
@@ -28,19 +28,32 @@
  */
 #include "wyPointParticleSystem.h"
 #include <stdlib.h>
+#include <string.h>
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 void wyPointParticleSystem::postStep() {
 }
 
-void wyPointParticleSystem::updateQuadWithParticle(wyParticle* particle, wyPoint newPosition) {
-	int index = m_particleIdx;
-	m_vertices[index * 2] = newPosition.x;
-	m_vertices[index * 2 + 1] = newPosition.y;
-	m_colors[index * 4] = particle->color.r;
-	m_colors[index * 4 + 1] = particle->color.g;
-	m_colors[index * 4 + 2] = particle->color.b;
-	m_colors[index * 4 + 3] = particle->color.a;
-	m_sizes[index] = particle->size;
+void wyPointParticleSystem::updateParticleVertices() {
+	int count = m_particleCount;
+	wyParticleBuffer* b = m_particles;
+	const float* drawX = b->drawX;
+	const float* drawY = b->drawY;
+	const float* r = b->r;
+	const float* g = b->g;
+	const float* bl = b->b;
+	const float* a = b->a;
+	for(int i = 0; i < count; i++) {
+		m_vertices[i * 2] = drawX[i];
+		m_vertices[i * 2 + 1] = drawY[i];
+		m_colors[i * 4] = r[i];
+		m_colors[i * 4 + 1] = g[i];
+		m_colors[i * 4 + 2] = bl[i];
+		m_colors[i * 4 + 3] = a[i];
+	}
+	memcpy(m_sizes, b->size, count * sizeof(GLfloat));
 }
 
 wyPointParticleSystem::~wyPointParticleSystem() {
@@ -50,6 +63,8 @@ wyPointParticleSystem::~wyPointParticleSystem() {
 }
 
 void wyPointParticleSystem::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -82,6 +97,7 @@ void wyPointParticleSystem::draw() {
 	}
 
 	glDrawArrays(GL_POINTS, 0, m_particleIdx);
+	gRenderQueue->countDrawCall();
 
 	// restore blend state
 	if(newBlend)
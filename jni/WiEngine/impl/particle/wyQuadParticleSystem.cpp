@@ -29,6 +29,9 @@
 #include "wyQuadParticleSystem.h"
 #include <stdlib.h>
 #include "wyLog.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 void wyQuadParticleSystem::initIndices() {
 	for(int i = 0, j = 0; i < m_maxParticles; i++) {
@@ -79,83 +82,74 @@ void wyQuadParticleSystem::initTexCoordsWithRect(wyRect rect) {
 void wyQuadParticleSystem::postStep() {
 }
 
-void wyQuadParticleSystem::updateQuadWithParticle(wyParticle* particle, wyPoint newPosition) {
-	int index = m_particleIdx;
+void wyQuadParticleSystem::updateParticleVertices() {
+	int count = m_particleCount;
+	wyParticleBuffer* b = m_particles;
 
 	// put bl,br,tl,tr m_colors
-	int start = index * 4 * 4;
-	m_colors[start++] = particle->color.r;
-	m_colors[start++] = particle->color.g;
-	m_colors[start++] = particle->color.b;
-	m_colors[start++] = particle->color.a;
-	m_colors[start++] = particle->color.r;
-	m_colors[start++] = particle->color.g;
-	m_colors[start++] = particle->color.b;
-	m_colors[start++] = particle->color.a;
-	m_colors[start++] = particle->color.r;
-	m_colors[start++] = particle->color.g;
-	m_colors[start++] = particle->color.b;
-	m_colors[start++] = particle->color.a;
-	m_colors[start++] = particle->color.r;
-	m_colors[start++] = particle->color.g;
-	m_colors[start++] = particle->color.b;
-	m_colors[start++] = particle->color.a;
+	const float* r = b->r;
+	const float* g = b->g;
+	const float* bl = b->b;
+	const float* a = b->a;
+	GLfloat* c = m_colors;
+	for(int i = 0; i < count; i++, c += 16) {
+		c[0] = c[4] = c[8] = c[12] = r[i];
+		c[1] = c[5] = c[9] = c[13] = g[i];
+		c[2] = c[6] = c[10] = c[14] = bl[i];
+		c[3] = c[7] = c[11] = c[15] = a[i];
+	}
 
 	// m_vertices
-	start = index * 2 * 4;
-	float size_2 = particle->size / 2;
-	if(particle->rotation != 0) {
-		float x1 = -size_2;
-		float y1 = -size_2;
-
-		float x2 = size_2;
-		float y2 = size_2;
-		float x = newPosition.x;
-		float y = newPosition.y;
-
-		float r = -wyMath::d2r(particle->rotation);
-		float cr = wyMath::cos(r);
-		float sr = wyMath::sin(r);
-		float ax = x1 * cr - y1 * sr + x;
-		float ay = x1 * sr + y1 * cr + y;
-		float bx = x2 * cr - y1 * sr + x;
-		float by = x2 * sr + y1 * cr + y;
-		float cx = x2 * cr - y2 * sr + x;
-		float cy = x2 * sr + y2 * cr + y;
-		float dx = x1 * cr - y2 * sr + x;
-		float dy = x1 * sr + y2 * cr + y;
-
-		// bottom-left
-		m_vertices[start++] = ax;
-		m_vertices[start++] = ay;
-
-		// bottom-right vertex:
-		m_vertices[start++] = bx;
-		m_vertices[start++] = by;
-
-		// top-left vertex:
-		m_vertices[start++] = dx;
-		m_vertices[start++] = dy;
-
-		// top-right vertex:
-		m_vertices[start++] = cx;
-		m_vertices[start++] = cy;
-	} else {
-		// bottom-left vertex:
-		m_vertices[start++] = newPosition.x - size_2;
-		m_vertices[start++] = newPosition.y - size_2;
-
-		// bottom-right vertex:
-		m_vertices[start++] = newPosition.x + size_2;
-		m_vertices[start++] = newPosition.y - size_2;
-
-		// top-left vertex:
-		m_vertices[start++] = newPosition.x - size_2;
-		m_vertices[start++] = newPosition.y + size_2;
-
-		// top-right vertex:
-		m_vertices[start++] = newPosition.x + size_2;
-		m_vertices[start++] = newPosition.y + size_2;
+	const float* drawX = b->drawX;
+	const float* drawY = b->drawY;
+	const float* size = b->size;
+	const float* rotation = b->rotation;
+	GLfloat* v = m_vertices;
+	for(int i = 0; i < count; i++, v += 8) {
+		float x = drawX[i];
+		float y = drawY[i];
+		float size_2 = size[i] / 2;
+		if(rotation[i] != 0) {
+			float r = -wyMath::d2r(rotation[i]);
+			float cr = wyMath::cos(r);
+			float sr = wyMath::sin(r);
+
+			// corners relative to center are (-s,-s), (s,-s), (-s,s), (s,s)
+			float scr = size_2 * cr;
+			float ssr = size_2 * sr;
+
+			// bottom-left
+			v[0] = -scr + ssr + x;
+			v[1] = -ssr - scr + y;
+
+			// bottom-right vertex:
+			v[2] = scr + ssr + x;
+			v[3] = ssr - scr + y;
+
+			// top-left vertex:
+			v[4] = -scr - ssr + x;
+			v[5] = -ssr + scr + y;
+
+			// top-right vertex:
+			v[6] = scr - ssr + x;
+			v[7] = ssr + scr + y;
+		} else {
+			// bottom-left vertex:
+			v[0] = x - size_2;
+			v[1] = y - size_2;
+
+			// bottom-right vertex:
+			v[2] = x + size_2;
+			v[3] = y - size_2;
+
+			// top-left vertex:
+			v[4] = x - size_2;
+			v[5] = y + size_2;
+
+			// top-right vertex:
+			v[6] = x + size_2;
+			v[7] = y + size_2;
+		}
 	}
 }
 
@@ -167,6 +161,8 @@ wyQuadParticleSystem::~wyQuadParticleSystem() {
 }
 
 void wyQuadParticleSystem::draw() {
+	gRenderQueue->flush();
+
 	// if no draw flag is set, call wyNode::draw and it
 	// will decide forward drawing to java layer or not
 	if(m_noDraw) {
@@ -200,6 +196,7 @@ void wyQuadParticleSystem::draw() {
 
 	// draw
 	glDrawElements(GL_TRIANGLES, m_particleIdx * 6, GL_UNSIGNED_SHORT, m_indices);
+	gRenderQueue->countDrawCall();
 
 	// restore blend state
 	if(newBlend)
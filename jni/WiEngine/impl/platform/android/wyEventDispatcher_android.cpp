@@ -36,9 +36,6 @@
 // shared instance
 wyEventDispatcher_android* gEventDispatcher;
 
-// mutex
-extern pthread_mutex_t gMutex;
-
 // preload class
 extern jclass gClass_Accelerometer;
 
@@ -150,15 +147,11 @@ void wyEventDispatcher_android::queueRunnableLocked(jobject runnable) {
 		JNIEnv* env = getEnv();
 		env->CallVoidMethod(runnable, g_mid_Runnable_run);
 	} else {
-		pthread_mutex_lock(&gMutex);
-
 		JNIEnv* env = getEnv();
 		wyEvent* e = popEvent();
 		e->type = ET_JAVA_RUNNABLE;
 		e->jr.runnable = env->NewGlobalRef(runnable);
-		m_pendingAddEvents.push_back(e);
-
-		pthread_mutex_unlock(&gMutex);
+		pushEvent(e);
 	}
 }
 
@@ -192,7 +185,7 @@ void wyEventDispatcher_android::queueMotionEvent(wyEventType type, wyPlatformMot
 	wyEvent* e = popEvent();
 	e->type = type;
 	e->me.pe = env->NewGlobalRef(pe);
-	m_pendingAddEvents.push_back(e);
+	pushEvent(e);
 }
 
 void wyEventDispatcher_android::queueMotionEvent(wyEventType type, wyPlatformMotionEvent pe1, wyPlatformMotionEvent pe2, float vx, float vy) {
@@ -204,7 +197,7 @@ void wyEventDispatcher_android::queueMotionEvent(wyEventType type, wyPlatformMot
 	e->ge.pe1 = pe1 == NULL ? NULL : env->NewGlobalRef(pe1);
 	e->ge.pe2 = pe2 == NULL ? NULL : env->NewGlobalRef(pe2);
 
-	m_pendingAddEvents.push_back(e);
+	pushEvent(e);
 }
 
 void wyEventDispatcher_android::processUncommonEvent(wyEvent* e) {
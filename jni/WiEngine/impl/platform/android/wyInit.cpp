@@ -42,6 +42,7 @@ jclass gClass_PrefUtil;
 jclass gClass_AudioManager;
 jclass gClass_TextBox;
 jclass gClass_Utilities;
+jclass gClass_System;
 
 // BaseObject
 jfieldID g_fid_BaseObject_mPointer;
@@ -185,6 +186,9 @@ jmethodID g_mid_Action_Callback_onUpdate;
 jmethodID g_mid_TargetSelector_setDelta;
 jmethodID g_mid_TargetSelector_invoke;
 
+// System
+jmethodID g_mid_System_identityHashCode;
+
 // WYSize class fields
 jfieldID g_fid_WYSize_width;
 jfieldID g_fid_WYSize_height;
@@ -395,6 +399,8 @@ void globalInit(JNIEnv* env) {
 	gClass_TextBox = (jclass)env->NewGlobalRef(c);
 	c = env->FindClass(CLASS_UTILITIES);
 	gClass_Utilities = (jclass)env->NewGlobalRef(c);
+	c = env->FindClass(CLASS_SYSTEM);
+	gClass_System = (jclass)env->NewGlobalRef(c);
 
 	jclass clazz = env->FindClass(CLASS_VERSION);
 	jfieldID sdkInt = env->GetStaticFieldID(clazz, "SDK_INT", "I");
@@ -854,6 +860,8 @@ void globalInit(JNIEnv* env) {
 	g_mid_TargetSelector_invoke = env->GetMethodID(clazz, "invoke", "()V");
 	env->DeleteLocalRef(clazz);
 
+	g_mid_System_identityHashCode = env->GetStaticMethodID(gClass_System, "identityHashCode", "(Ljava/lang/Object;)I");
+
 	g_mid_PrefUtil_getIntPref = env->GetStaticMethodID(gClass_PrefUtil, "getIntPref", "(Ljava/lang/String;I)I");
 	g_mid_PrefUtil_setIntPref = env->GetStaticMethodID(gClass_PrefUtil, "setIntPref", "(Ljava/lang/String;I)V");
 	g_mid_PrefUtil_getStringPref = env->GetStaticMethodID(gClass_PrefUtil, "getStringPref", "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;");
@@ -935,6 +943,8 @@ void globalDeInit(JNIEnv* env) {
 	gClass_AudioManager = NULL;
 	env->DeleteGlobalRef(gClass_TextBox);
 	gClass_TextBox = NULL;
+	env->DeleteGlobalRef(gClass_System);
+	gClass_System = NULL;
 }
 
 #ifdef __cplusplus
@@ -65,6 +65,7 @@
 #define CLASS_ONDOUBLETAPLISTENER "android/view/GestureDetector$OnDoubleTapListener"
 #define CLASS_ONGESTURELISTENER "android/view/GestureDetector$OnGestureListener"
 #define CLASS_FILEDESCRIPTOR "java/io/FileDescriptor"
+#define CLASS_SYSTEM "java/lang/System"
 #define CLASS_CONTEXT "android/content/Context"
 #define CLASS_RESOURCES "android/content/res/Resources"
 #define CLASS_KEYEVENT "android/view/KeyEvent"
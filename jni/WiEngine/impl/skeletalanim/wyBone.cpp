@@ -33,7 +33,8 @@
 wyBone::wyBone() :
 		m_parent(NULL),
 		m_length(0),
-        m_flags(0) {
+        m_flags(0),
+		m_index(-1) {
 	m_originalState.x = 0;
 	m_originalState.y = 0;
 	m_originalState.rotation = 0;
@@ -58,20 +59,3 @@ void wyBone::addChild(wyBone* bone) {
 	wyObjectRetain(bone);
 	bone->setParent(this);
 }
-
-wyBone::State& wyBone::getState(wySkeletalSprite* owner) {
-	StateMap::iterator iter = m_stateMap.find(owner);
-	if(iter != m_stateMap.end()) {
-		return iter->second;
-	} else {
-		m_stateMap[owner] = m_originalState;
-		iter = m_stateMap.find(owner);
-		return iter->second;
-	}
-}
-
-void wyBone::clearState(wySkeletalSprite* owner) {
-	StateMap::iterator iter = m_stateMap.find(owner);
-	if(iter != m_stateMap.end())
-		m_stateMap.erase(iter);
-}
\ No newline at end of file
@@ -33,6 +33,7 @@
 
 wyBoneTransform::wyBoneTransform() :
 		m_boneName(NULL) {
+	memset(m_cursors, 0, sizeof(m_cursors));
 }
 
 wyBoneTransform::~wyBoneTransform() {
@@ -53,6 +54,9 @@ void wyBoneTransform::setBoneName(const char* name) {
 		m_boneName = NULL;
 	}
 	m_boneName = wyUtils::copy(name);
+
+	// target should be resolved again
+	m_skeletonId = 0;
 }
 
 void wyBoneTransform::addRotationKeyFrame(RotationKeyFrame kf) {
@@ -67,165 +71,175 @@ void wyBoneTransform::addScaleKeyFrame(ScaleKeyFrame kf) {
 	m_skfList.push_back(kf);
 }
 
-void wyBoneTransform::populateFrame(float time) {
-	// process rotation frame
-	{
-		// set time to current time
-		m_currentRotation.time = time;
-		m_currentRotation.valid = true;
-		
-		// if empty, just set to zero
-		// if not, found key frame, do interpolation if needed
-		if(m_rkfList.empty()) {
-			m_currentRotation.valid = false;
-		} else {
-			RotationKeyFrameList::iterator iter = m_rkfList.begin();
-			for(; iter != m_rkfList.end(); iter++) {
-				RotationKeyFrame& kf = *iter;
-				if(time < kf.time) {
-					if(iter == m_rkfList.begin()) {
-						m_currentRotation.angle = kf.angle;
-					} else {
-						RotationKeyFrame& prevKf = *(iter - 1);
-						wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
-						
-						// simplifies rotation by rotating the shorter distance
-						float prevAngle = prevKf.angle;
-						float angle = kf.angle;
-						while (prevAngle > 180)
-							prevAngle -= 360;
-						while (prevAngle < -180)
-							prevAngle += 360;
-						while (angle > 180)
-							angle -= 360;
-						while (angle < -180)
-							angle += 360;
-						
-						// interpolate
-						m_currentRotation.angle = t.x * (angle - prevAngle) + prevAngle;
-					}
-					break;
-				} else if(time == kf.time) {
-					m_currentRotation = kf;
-					break;
-				}
-			}
-			
-			// if exceed last one
-			if(iter == m_rkfList.end()) {
-				m_currentRotation.angle = m_rkfList.rbegin()->angle;
-			}
-		}
+int wyBoneTransform::findTarget(wySkeleton* s) {
+	return s->getBoneIndex(m_boneName);
+}
+
+bool wyBoneTransform::getRotationAt(float time, int& cursor, float& angle) {
+	if(m_rkfList.empty())
+		return false;
+
+	// before first key frame, or at or after last one, no interpolation
+	int count = m_rkfList.size();
+	int i = seekKeyFrame(&m_rkfList[0].time, sizeof(RotationKeyFrame), count, time, cursor);
+	if(i < 0) {
+		angle = m_rkfList[0].angle;
+	} else if(i == count - 1 || time == m_rkfList[i].time) {
+		angle = m_rkfList[i].angle;
+	} else {
+		RotationKeyFrame& prevKf = m_rkfList[i];
+		RotationKeyFrame& kf = m_rkfList[i + 1];
+		wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
+
+		// simplifies rotation by rotating the shorter distance
+		float prevAngle = prevKf.angle;
+		float nextAngle = kf.angle;
+		while (prevAngle > 180)
+			prevAngle -= 360;
+		while (prevAngle < -180)
+			prevAngle += 360;
+		while (nextAngle > 180)
+			nextAngle -= 360;
+		while (nextAngle < -180)
+			nextAngle += 360;
+
+		// interpolate
+		angle = t.x * (nextAngle - prevAngle) + prevAngle;
 	}
-	
-	// process translation
-	{
-		// set time to current time
-		m_currentTranslation.time = time;
-		m_currentTranslation.valid = true;
-		
-		// if empty, just set to zero
-		// if not, found key frame, do interpolation if needed
-		if(m_tkfList.empty()) {
-			m_currentTranslation.valid = false;
-		} else {
-			TranslationKeyFrameList::iterator iter = m_tkfList.begin();
-			for(; iter != m_tkfList.end(); iter++) {
-				TranslationKeyFrame& kf = *iter;
-				if(time < kf.time) {
-					if(iter == m_tkfList.begin()) {
-						m_currentTranslation.x = kf.x;
-						m_currentTranslation.y = kf.y;
-					} else {
-						TranslationKeyFrame& prevKf = *(iter - 1);
-						wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
-						m_currentTranslation.x = t.x * (kf.x - prevKf.x) + prevKf.x;
-						m_currentTranslation.y = t.y * (kf.y - prevKf.y) + prevKf.y;
-					}
-					break;
-				} else if(time == kf.time) {
-					m_currentTranslation = kf;
-					break;
-				}
-			}
-			
-			// if exceed last one
-			if(iter == m_tkfList.end()) {
-				TranslationKeyFrame& kf = *m_tkfList.rbegin();
-				m_currentTranslation.x = kf.x;
-				m_currentTranslation.y = kf.y;
-			}
-		}
+	return true;
+}
+
+bool wyBoneTransform::getTranslationAt(float time, int& cursor, float& x, float& y) {
+	if(m_tkfList.empty())
+		return false;
+
+	int count = m_tkfList.size();
+	int i = seekKeyFrame(&m_tkfList[0].time, sizeof(TranslationKeyFrame), count, time, cursor);
+	if(i < 0) {
+		x = m_tkfList[0].x;
+		y = m_tkfList[0].y;
+	} else if(i == count - 1 || time == m_tkfList[i].time) {
+		x = m_tkfList[i].x;
+		y = m_tkfList[i].y;
+	} else {
+		TranslationKeyFrame& prevKf = m_tkfList[i];
+		TranslationKeyFrame& kf = m_tkfList[i + 1];
+		wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
+		x = t.x * (kf.x - prevKf.x) + prevKf.x;
+		y = t.y * (kf.y - prevKf.y) + prevKf.y;
 	}
-	
-	// process scale
-	{
-		// set time to current time
-		m_currentScale.time = time;
-		m_currentScale.valid = true;
-		
-		// if empty, just set to zero
-		// if not, found key frame, do interpolation if needed
-		if(m_skfList.empty()) {
-			m_currentScale.valid = false;
-		} else {
-			ScaleKeyFrameList::iterator iter = m_skfList.begin();
-			for(; iter != m_skfList.end(); iter++) {
-				ScaleKeyFrame& kf = *iter;
-				if(time < kf.time) {
-					if(iter == m_skfList.begin()) {
-						m_currentScale.scaleX = kf.scaleX;
-						m_currentScale.scaleY = kf.scaleY;
-					} else {
-						ScaleKeyFrame& prevKf = *(iter - 1);
-						wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
-						m_currentScale.scaleX = t.x * (kf.scaleX - prevKf.scaleX) + prevKf.scaleX;
-						m_currentScale.scaleY = t.y * (kf.scaleY - prevKf.scaleY) + prevKf.scaleY;
-					}
-					break;
-				} else if(time == kf.time) {
-					m_currentScale = kf;
-					break;
-				}
-			}
-			
-			// if exceed last one
-			if(iter == m_skfList.end()) {
-				ScaleKeyFrame& kf = *m_skfList.rbegin();
-				m_currentScale.scaleX = kf.scaleX;
-				m_currentScale.scaleY = kf.scaleY;
-			}
-		}
+	return true;
+}
+
+bool wyBoneTransform::getScaleAt(float time, int& cursor, float& scaleX, float& scaleY) {
+	if(m_skfList.empty())
+		return false;
+
+	int count = m_skfList.size();
+	int i = seekKeyFrame(&m_skfList[0].time, sizeof(ScaleKeyFrame), count, time, cursor);
+	if(i < 0) {
+		scaleX = m_skfList[0].scaleX;
+		scaleY = m_skfList[0].scaleY;
+	} else if(i == count - 1 || time == m_skfList[i].time) {
+		scaleX = m_skfList[i].scaleX;
+		scaleY = m_skfList[i].scaleY;
+	} else {
+		ScaleKeyFrame& prevKf = m_skfList[i];
+		ScaleKeyFrame& kf = m_skfList[i + 1];
+		wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
+		scaleX = t.x * (kf.scaleX - prevKf.scaleX) + prevKf.scaleX;
+		scaleY = t.y * (kf.scaleY - prevKf.scaleY) + prevKf.scaleY;
 	}
+	return true;
+}
+
+void wyBoneTransform::populateFrame(float time) {
+	m_currentRotation.time = time;
+	m_currentRotation.valid = getRotationAt(time, m_cursors[0], m_currentRotation.angle);
+	m_currentTranslation.time = time;
+	m_currentTranslation.valid = getTranslationAt(time, m_cursors[1], m_currentTranslation.x, m_currentTranslation.y);
+	m_currentScale.time = time;
+	m_currentScale.valid = getScaleAt(time, m_cursors[2], m_currentScale.scaleX, m_currentScale.scaleY);
 }
 
 bool wyBoneTransform::applyTo(wySkeletalSprite* owner) {
-	wySkeleton* s = owner->getSkeleton();
-	wyBone* bone = s->getBone(m_boneName);
-	if(!bone)
+	return applyFrame(owner, m_currentRotation, m_currentTranslation, m_currentScale, 1, false);
+}
+
+bool wyBoneTransform::applyTo(wySkeletalSprite* owner, float time, int* cursors, float weight, bool additive) {
+	RotationKeyFrame r;
+	TranslationKeyFrame t;
+	ScaleKeyFrame s;
+	r.valid = getRotationAt(time, cursors[0], r.angle);
+	t.valid = getTranslationAt(time, cursors[1], t.x, t.y);
+	s.valid = getScaleAt(time, cursors[2], s.scaleX, s.scaleY);
+	return applyFrame(owner, r, t, s, weight, additive);
+}
+
+bool wyBoneTransform::applyFrame(wySkeletalSprite* owner, RotationKeyFrame& r, TranslationKeyFrame& t, ScaleKeyFrame& s, float weight, bool additive) {
+	wySkeleton* skeleton = owner->getSkeleton();
+	int index = resolveTarget(skeleton);
+	if(index < 0)
 		return false;
-	
-	// get state of this owner, and original state
-	wyBone::State& ownerState = bone->getState(owner);
+
+	// original state is shared, pose of owner is indexed by bone index
+	wyBone* bone = skeleton->getBoneList()[index];
 	wyBone::State& originalState = bone->getOriginalState();
-	
+
+	// key frame values are offsets from original state. for additive mixing, offset is
+	// added to current pose directly, otherwise current pose moves to frame value by weight
+	bool replace = !additive && weight >= 1;
+
 	// set rotation
-	if(m_currentRotation.valid && !bone->hasFlag(wyBone::FIXED_ROTATION)) {
-		ownerState.rotation = originalState.rotation + m_currentRotation.angle;
+	if(r.valid && !bone->hasFlag(wyBone::FIXED_ROTATION)) {
+		float& rotation = owner->m_boneRotation[index];
+		if(additive) {
+			rotation += r.angle * weight;
+		} else if(replace) {
+			rotation = originalState.rotation + r.angle;
+		} else {
+			// rotate by the shorter distance
+			float delta = originalState.rotation + r.angle - rotation;
+			while(delta > 180)
+				delta -= 360;
+			while(delta < -180)
+				delta += 360;
+			rotation += delta * weight;
+		}
 	}
-	
+
 	// set translation
-	if(m_currentTranslation.valid && !bone->hasFlag(wyBone::FIXED_POSITION)) {
-		ownerState.x = originalState.x + m_currentTranslation.x;
-		ownerState.y = originalState.y + m_currentTranslation.y;
+	if(t.valid && !bone->hasFlag(wyBone::FIXED_POSITION)) {
+		float& x = owner->m_boneX[index];
+		float& y = owner->m_boneY[index];
+		if(additive) {
+			x += t.x * weight;
+			y += t.y * weight;
+		} else if(replace) {
+			x = originalState.x + t.x;
+			y = originalState.y + t.y;
+		} else {
+			x += (originalState.x + t.x - x) * weight;
+			y += (originalState.y + t.y - y) * weight;
+		}
 	}
-	
+
 	// set scale
-	if(m_currentScale.valid && !bone->hasFlag(wyBone::FIXED_SCALE)) {
-		ownerState.scaleX = originalState.scaleX * m_currentScale.scaleX;
-		ownerState.scaleY = originalState.scaleY * m_currentScale.scaleY;
+	if(s.valid && !bone->hasFlag(wyBone::FIXED_SCALE)) {
+		float& scaleX = owner->m_boneScaleX[index];
+		float& scaleY = owner->m_boneScaleY[index];
+		if(additive) {
+			scaleX *= 1 + (s.scaleX - 1) * weight;
+			scaleY *= 1 + (s.scaleY - 1) * weight;
+		} else if(replace) {
+			scaleX = originalState.scaleX * s.scaleX;
+			scaleY = originalState.scaleY * s.scaleY;
+		} else {
+			scaleX += (originalState.scaleX * s.scaleX - scaleX) * weight;
+			scaleY += (originalState.scaleY * s.scaleY - scaleY) * weight;
+		}
 	}
-	
+
 	return true;
 }
 
@@ -31,9 +31,11 @@
 #include "wyDirector.h"
 #include "wyAttachment.h"
 #include "wyUtils.h"
+#include "wyRenderQueue.h"
 #include "wyLog.h"
 
 extern wyDirector* gDirector;
+extern wyRenderQueue* gRenderQueue;
 
 wySkeletalSprite::wySkeletalSprite() :
 		m_skeleton(NULL),
@@ -42,13 +44,46 @@ wySkeletalSprite::wySkeletalSprite() :
 		m_paused(false),
 		m_rootBone(NULL),
 		m_fillAfter(false),
-		m_listener(NULL) {
+		m_listener(NULL),
+		m_boneCount(0),
+		m_boneX(NULL),
+		m_boneY(NULL),
+		m_boneRotation(NULL),
+		m_boneScaleX(NULL),
+		m_boneScaleY(NULL),
+		m_boneTransforms(NULL),
+		m_slotCount(0),
+		m_slotColors(NULL),
+		m_slotAttachmentNames(NULL),
+		m_slotSprites(NULL),
+		m_atlas(NULL),
+		m_cursors(NULL),
+		m_cursorCapacity(0),
+		m_fadeAnimation(NULL),
+		m_fadeTime(0),
+		m_fadeLoop(0),
+		m_fadeDuration(0),
+		m_fadeElapsed(0),
+		m_fadeCursors(NULL),
+		m_fadeCursorCapacity(0),
+		m_mixedLastFrame(false) {
+	m_batchDraw = true;
+	memset(m_layers, 0, sizeof(m_layers));
 }
 
 wySkeletalSprite::~wySkeletalSprite() {
-	if(m_rootBone)
-		clearBoneStates(m_rootBone);
-	cleanSlotStates();
+	releaseStates();
+	if(m_cursors)
+		wyFree(m_cursors);
+	if(m_fadeCursors)
+		wyFree(m_fadeCursors);
+	for(int i = 0; i < SKELETAL_MAX_LAYERS; i++) {
+		wyObjectRelease(m_layers[i].animation);
+		if(m_layers[i].cursors)
+			wyFree(m_layers[i].cursors);
+	}
+	wyObjectRelease(m_fadeAnimation);
+	wyObjectRelease(m_atlas);
 	wyObjectRelease(m_skeleton);
 	wyObjectRelease(m_animation);
 }
@@ -63,9 +98,8 @@ void wySkeletalSprite::visit() {
 	if(!m_visible)
 		return;
 	
-	// sync bone state
-	if(m_rootBone)
-		syncBoneStates(m_rootBone);
+	// bone transforms are calculated once, slots only need to look them up
+	updateBoneTransforms();
 	
 	// should push matrix to avoid disturb current matrix
 	glPushMatrix();
@@ -78,36 +112,23 @@ void wySkeletalSprite::visit() {
 	} else {
 		transform();
 	}
+
+	// mirror opengl matrix in render queue, grid, camera and vertex z can't be batched
+	gRenderQueue->pushNode(this, !hasGrid && m_camera == NULL && m_vertexZ == 0);
 	
 	// check clip
 	if(m_hasClip)
 		doClip();
 	
-	// visit slot sprites by display list sequence
-	wySkeleton::SlotPtrList& slotDisplayList = m_skeleton->getSlotDisplayList();
-	for(wySkeleton::SlotPtrList::iterator iter = slotDisplayList.begin(); iter != slotDisplayList.end(); iter++) {
-		wySlot* slot = *iter;
-		wySlot::State& state = slot->getState(this);
-		wySpriteEx* sprite = state.sprite;
-		if(sprite) {
-			// should push matrix for every slot sprite
-			glPushMatrix();
-			
-			// transform until to this node
-			sprite->transformAncestorsUntil(this);
-			sprite->transform();
-			
-			// draw this sprite
-			sprite->draw();
-			
-			// pop matrix
-			glPopMatrix();
-		}
-	}
+	// draw slots by display list sequence
+	drawSlots();
 	
 	// restore
 	if(m_hasClip && gDirector)
 		gDirector->popClipRect();
+
+	// pop render queue matrix
+	gRenderQueue->popNode();
 	
 	// if grid is set, end grid
 	if(hasGrid) {
@@ -118,20 +139,136 @@ void wySkeletalSprite::visit() {
 	glPopMatrix();
 }
 
+void wySkeletalSprite::updateBoneTransforms() {
+	if(m_boneCount <= 0)
+		return;
+
+	// parent is always updated before child, so one pass is enough
+	int* order = m_skeleton->getBoneUpdateOrder();
+	int* parents = m_skeleton->getBoneParents();
+	for(int i = 0; i < m_boneCount; i++) {
+		// same as node transform with position, rotation and scale
+		int index = order[i];
+		wyAffineTransform& t = m_boneTransforms[index];
+		t = wyaIdentity;
+		wyaTranslate(&t, m_boneX[index], m_boneY[index]);
+		if(m_boneRotation[index] != 0)
+			wyaRotate(&t, wyMath::d2r(m_boneRotation[index]));
+		if(m_boneScaleX[index] != 1.f || m_boneScaleY[index] != 1.f)
+			wyaScale(&t, m_boneScaleX[index], m_boneScaleY[index]);
+
+		// concat parent
+		if(parents[index] >= 0)
+			wyaConcat(&t, &m_boneTransforms[parents[index]]);
+	}
+}
+
+void wySkeletalSprite::drawSlots() {
+	if(m_slotCount <= 0)
+		return;
+
+	// if render queue can batch, quads are appended to queue and adjacent quads
+	// with same texture are merged, even they belong to different sprites
+	bool batch = gRenderQueue->canBatch(this);
+	if(!batch) {
+		if(m_atlas == NULL)
+			m_atlas = WYNEW wyTextureAtlas(NULL, MAX(1, m_slotCount));
+		m_atlas->removeAllQuads();
+	}
+
+	int* slotBones = m_skeleton->getSlotBones();
+	int runStart = 0;
+	wyTexture2D* runTex = NULL;
+	wyBlendFunc runBlend = wybfDefault;
+	for(int i = 0; i < m_slotCount; i++) {
+		wySpriteEx* sprite = m_slotSprites[i];
+		if(!sprite || !sprite->isVisible() || slotBones[i] < 0)
+			continue;
+		wyTexture2D* tex = sprite->getTexture();
+		if(!tex)
+			continue;
+
+		// quad in sprite space
+		wyQuad2D texCoords;
+		wyQuad3D quad;
+		tex->load();
+		sprite->getQuad(&texCoords, &quad);
+
+		// transform quad to this node space
+		wyAffineTransform t = sprite->getTransformMatrix();
+		wyaConcat(&t, &m_boneTransforms[slotBones[i]]);
+		float* v = (float*)&quad;
+		for(int j = 0; j < 4; j++, v += 3) {
+			float x = v[0];
+			float y = v[1];
+			v[0] = x * t.a + y * t.c + t.tx;
+			v[1] = x * t.b + y * t.d + t.ty;
+		}
+
+		// color with alpha
+		wyColor3B c = sprite->getColor();
+		wyColor4B color = wyc4b(c.r, c.g, c.b, sprite->getAlpha());
+		wyBlendFunc blendFunc = sprite->getBlendFunc();
+
+		if(batch) {
+			gRenderQueue->addQuad(tex, blendFunc, texCoords, quad, color);
+		} else {
+			// draw previous run if state is changed
+			int count = m_atlas->getTotalQuads();
+			if(count > runStart && (tex != runTex || blendFunc.src != runBlend.src || blendFunc.dst != runBlend.dst)) {
+				drawAtlasRun(runStart, count - runStart, runTex, runBlend);
+				runStart = count;
+			}
+			runTex = tex;
+			runBlend = blendFunc;
+
+			int index = m_atlas->appendQuad(texCoords, quad);
+			m_atlas->updateColor(color, index);
+		}
+	}
+
+	// last run
+	if(!batch && m_atlas->getTotalQuads() > runStart)
+		drawAtlasRun(runStart, m_atlas->getTotalQuads() - runStart, runTex, runBlend);
+}
+
+void wySkeletalSprite::drawAtlasRun(int start, int count, wyTexture2D* tex, wyBlendFunc blendFunc) {
+	// atlas draws directly, so pending quads must be rendered first
+	gRenderQueue->flush();
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnable(GL_TEXTURE_2D);
+
+	bool newBlend = blendFunc.src != DEFAULT_BLEND_SRC || blendFunc.dst != DEFAULT_BLEND_DST;
+	if(newBlend)
+		glBlendFunc(blendFunc.src, blendFunc.dst);
+
+	m_atlas->setTexture(tex);
+	m_atlas->drawRange(start, count);
+
+	if(newBlend)
+		glBlendFunc(DEFAULT_BLEND_SRC, DEFAULT_BLEND_DST);
+
+	glDisable(GL_TEXTURE_2D);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
 wyPoint wySkeletalSprite::getBonePosition(const char* boneName) {
     // basic check
     if(!m_skeleton)
         return wypZero;
     
     // get bone
-    wyBone* bone = m_skeleton->getBone(boneName);
-    if(!bone)
+    int index = m_skeleton->getBoneIndex(boneName);
+    if(index < 0)
         return wypZero;
     
-    // get bone node
-    wyBone::State& state = bone->getState(this);
-    wyAffineTransform t = state.node->getNodeToAncestorTransform(this);
-    wyPoint pos = wyp(state.x, state.y);
+    // get bone transform
+    updateBoneTransforms();
+    wyAffineTransform t = m_boneTransforms[index];
+    wyPoint pos = wyp(m_boneX[index], m_boneY[index]);
     return wyaTransformPoint(t, pos);
 }
 
@@ -141,18 +278,24 @@ wyPoint wySkeletalSprite::getBonePositionRelativeToWorld(const char* boneName) {
         return wypZero;
     
     // get bone
-    wyBone* bone = m_skeleton->getBone(boneName);
-    if(!bone)
+    int index = m_skeleton->getBoneIndex(boneName);
+    if(index < 0)
         return wypZero;
     
-    // get bone node
-    wyBone::State& state = bone->getState(this);
-    wyAffineTransform t = state.node->getNodeToWorldTransform();
-    wyPoint pos = wyp(state.x, state.y);
+    // get bone transform
+    updateBoneTransforms();
+    wyAffineTransform t = m_boneTransforms[index];
+    wyAffineTransform world = getNodeToWorldTransform();
+    wyaConcat(&t, &world);
+    wyPoint pos = wyp(m_boneX[index], m_boneY[index]);
     return wyaTransformPoint(t, pos);
 }
 
 void wySkeletalSprite::stopAnimation(bool restore) {
+	// stop cross fading
+	wyObjectRelease(m_fadeAnimation);
+	m_fadeAnimation = NULL;
+
 	// no animation? return
 	if(!m_animation)
 		return;
@@ -162,8 +305,8 @@ void wySkeletalSprite::stopAnimation(bool restore) {
 	m_animation = NULL;
 	
 	// restore original state
-	if(m_rootBone && restore) {
-		syncOriginalBoneStates(m_rootBone);
+	if(restore) {
+		syncOriginalBoneStates();
 	}
 	
 	// notify
@@ -174,12 +317,59 @@ void wySkeletalSprite::stopAnimation(bool restore) {
 void wySkeletalSprite::playAnimation(wySkeletalAnimation* anim) {
 	// stop current
 	stopAnimation(false);
-	
+
+	// start new
+	startAnimation(anim);
+}
+
+void wySkeletalSprite::playAnimation(wySkeletalAnimation* anim, float fadeDuration) {
+	// nothing to fade from
+	if(fadeDuration <= 0 || !m_animation || !anim) {
+		playAnimation(anim);
+		return;
+	}
+
+	// current animation becomes fading out animation, cursor arrays are swapped
+	// so it continues from where it is and no memory is allocated
+	wyObjectRelease(m_fadeAnimation);
+	m_fadeAnimation = m_animation;
+	m_fadeTime = m_frameTime;
+	m_fadeLoop = m_loop;
+	m_fadeDuration = fadeDuration;
+	m_fadeElapsed = 0;
+	int* cursors = m_cursors;
+	int capacity = m_cursorCapacity;
+	m_cursors = m_fadeCursors;
+	m_cursorCapacity = m_fadeCursorCapacity;
+	m_fadeCursors = cursors;
+	m_fadeCursorCapacity = capacity;
+	m_animation = NULL;
+
+	// current animation is stopped from the view of listener
+	if(m_listener)
+		m_listener->onSkeletalAnimationStopped(this);
+
+	// start new
+	startAnimation(anim);
+}
+
+void wySkeletalSprite::playAnimation(const char* animName, float fadeDuration) {
+	wySkeletalAnimation* anim = wySkeletalAnimationCache::getInstance()->getAnimation(animName);
+	if(anim) {
+		playAnimation(anim, fadeDuration);
+	}
+}
+
+void wySkeletalSprite::startAnimation(wySkeletalAnimation* anim) {
 	// hold this animation
 	wyObjectRetain(anim);
 	wyObjectRelease(m_animation);
 	m_animation = anim;
 	
+	// reset key frame cursors
+	if(m_animation)
+		prepareCursors(m_animation, m_cursors, m_cursorCapacity);
+	
 	// init for first frame
 	setupFirstFrameState();
 	
@@ -206,14 +396,132 @@ void wySkeletalSprite::setupFirstFrameState() {
 	setFrame(m_frameTime);
 }
 
+void wySkeletalSprite::prepareCursors(wySkeletalAnimation* anim, int*& cursors, int& capacity) {
+	int count = 0;
+	wySkeletalAnimation::TransformPtrList& tList = anim->getTransformList();
+	for(wySkeletalAnimation::TransformPtrList::iterator iter = tList.begin(); iter != tList.end(); iter++) {
+		count += (*iter)->getCursorCount();
+	}
+	if(count > capacity) {
+		capacity = count;
+		cursors = (int*)wyRealloc(cursors, capacity * sizeof(int));
+	}
+	if(count > 0)
+		memset(cursors, 0, count * sizeof(int));
+}
+
+void wySkeletalSprite::setLayerAnimation(int layer, wySkeletalAnimation* anim, float weight, bool additive) {
+	if(layer < 0 || layer >= SKELETAL_MAX_LAYERS)
+		return;
+
+	Layer& l = m_layers[layer];
+	wyObjectRetain(anim);
+	wyObjectRelease(l.animation);
+	l.animation = anim;
+	l.time = 0;
+	l.weight = MAX(0, MIN(1, weight));
+	l.targetWeight = l.weight;
+	l.fadeSpeed = 0;
+	l.additive = additive;
+	if(anim)
+		prepareCursors(anim, l.cursors, l.cursorCapacity);
+}
+
+void wySkeletalSprite::setLayerAnimation(int layer, const char* animName, float weight, bool additive) {
+	wySkeletalAnimation* anim = wySkeletalAnimationCache::getInstance()->getAnimation(animName);
+	if(anim) {
+		setLayerAnimation(layer, anim, weight, additive);
+	}
+}
+
+void wySkeletalSprite::clearLayer(int layer) {
+	if(layer < 0 || layer >= SKELETAL_MAX_LAYERS)
+		return;
+
+	// cursor array is kept for next animation
+	Layer& l = m_layers[layer];
+	wyObjectRelease(l.animation);
+	l.animation = NULL;
+	l.weight = 0;
+	l.targetWeight = 0;
+}
+
+void wySkeletalSprite::setLayerWeight(int layer, float weight, float fadeDuration) {
+	if(layer < 0 || layer >= SKELETAL_MAX_LAYERS)
+		return;
+
+	Layer& l = m_layers[layer];
+	l.targetWeight = MAX(0, MIN(1, weight));
+	if(fadeDuration <= 0) {
+		l.weight = l.targetWeight;
+		l.fadeSpeed = 0;
+	} else {
+		l.fadeSpeed = fabs(l.targetWeight - l.weight) / fadeDuration;
+	}
+}
+
+bool wySkeletalSprite::isMixing() {
+	if(m_fadeAnimation)
+		return true;
+	for(int i = 0; i < SKELETAL_MAX_LAYERS; i++) {
+		if(m_layers[i].animation && m_layers[i].weight > 0)
+			return true;
+	}
+	return false;
+}
+
+bool wySkeletalSprite::updateMix(float delta) {
+	// advance fading out animation
+	if(m_fadeAnimation) {
+		m_fadeElapsed += delta;
+		if(m_fadeElapsed >= m_fadeDuration) {
+			wyObjectRelease(m_fadeAnimation);
+			m_fadeAnimation = NULL;
+		} else {
+			m_fadeTime += delta;
+			float duration = m_fadeAnimation->getDuration();
+			if(m_fadeTime > duration)
+				m_fadeTime = (m_fadeLoop != 0 && duration > 0) ? fmod(m_fadeTime, duration) : duration;
+		}
+	}
+
+	// advance layers
+	for(int i = 0; i < SKELETAL_MAX_LAYERS; i++) {
+		Layer& l = m_layers[i];
+		if(!l.animation)
+			continue;
+
+		l.time += delta;
+		float duration = l.animation->getDuration();
+		if(l.time > duration)
+			l.time = duration > 0 ? fmod(l.time, duration) : 0;
+
+		// fade weight
+		if(l.weight < l.targetWeight)
+			l.weight = MIN(l.targetWeight, l.weight + l.fadeSpeed * delta);
+		else if(l.weight > l.targetWeight)
+			l.weight = MAX(l.targetWeight, l.weight - l.fadeSpeed * delta);
+	}
+
+	return isMixing();
+}
+
 void wySkeletalSprite::tick(float delta) {
 	// is paused?
 	if(m_paused)
 		return;
 	
 	// basic checking
-	if(!m_animation || !m_skeleton)
+	if(!m_skeleton)
+		return;
+
+	// advance cross fading and layers, layers can play without current animation
+	bool mixing = updateMix(delta);
+	if(!m_animation) {
+		if(mixing || m_mixedLastFrame)
+			setFrame(m_frameTime);
 		return;
+	}
 	
 	// update frame time
 	m_frameTime += delta;
@@ -259,14 +567,37 @@ void wySkeletalSprite::tick(float delta) {
 }
 
 void wySkeletalSprite::setFrame(float time) {
-	wySkeletalAnimation::TransformPtrList& tList = m_animation->getTransformList();
+	// when mixing, pose is rebuilt from original state so that partial weights and
+	// additive offsets don't accumulate. one more rebuild is needed after mixing ends
+	bool mixing = isMixing();
+	if(mixing || m_mixedLastFrame)
+		syncOriginalBoneStates();
+	m_mixedLastFrame = mixing;
+
+	// current animation
+	if(m_animation)
+		applyAnimation(m_animation, time, m_cursors, 1, false);
+
+	// fading out animation is mixed over current one with decreasing weight, so bones
+	// which are not in current animation also move back smoothly
+	if(m_fadeAnimation)
+		applyAnimation(m_fadeAnimation, m_fadeTime, m_fadeCursors, 1 - m_fadeElapsed / m_fadeDuration, false);
+
+	// layers
+	for(int i = 0; i < SKELETAL_MAX_LAYERS; i++) {
+		Layer& l = m_layers[i];
+		if(l.animation && l.weight > 0)
+			applyAnimation(l.animation, l.time, l.cursors, l.weight, l.additive);
+	}
+}
+
+void wySkeletalSprite::applyAnimation(wySkeletalAnimation* anim, float time, int* cursors, float weight, bool additive) {
+	// every transform evaluates key frames with its own cursors and mixes into state arrays
+	wySkeletalAnimation::TransformPtrList& tList = anim->getTransformList();
 	for(wySkeletalAnimation::TransformPtrList::iterator iter = tList.begin(); iter != tList.end(); iter++) {
-		// calculate info
 		wyTransform* t = *iter;
-		t->populateFrame(time);
-		
-		// apply frame
-		t->applyTo(this);
+		t->applyTo(this, time, cursors, weight, additive);
+		cursors += t->getCursorCount();
 	}
 }
 
@@ -281,75 +612,120 @@ void wySkeletalSprite::setSkeleton(wySkeleton* s) {
 	
 	// clear all children node and references
 	removeAllChildren(true);
+	releaseStates();
+	
+	// re-create states
+	createStates();
 	
-	// re-create bone nodes
 	m_rootBone = m_skeleton->getRootBone();
-	createBoneNodes(m_rootBone);
 	
 	// re-create slot sprite
 	createSlotSprites();
 	
 	// sync states
-	syncOriginalBoneStates(m_rootBone);
+	syncOriginalBoneStates();
 	syncAttachmentStates();
 }
 
-void wySkeletalSprite::clearBoneStates(wyBone* bone) {
-	bone->clearState(this);
-	
-	wyBone::BonePtrList& children = bone->getChildren();
-	for(wyBone::BonePtrList::iterator iter = children.begin(); iter != children.end(); iter++) {
-		clearBoneStates(*iter);
-	}
-}
+void wySkeletalSprite::createStates() {
+	// bone states
+	m_boneCount = m_skeleton->getBoneCount();
+	if(m_boneCount > 0) {
+		float* pose = (float*)wyMalloc(m_boneCount * 5 * sizeof(float));
+		m_boneX = pose;
+		m_boneY = pose + m_boneCount;
+		m_boneRotation = pose + m_boneCount * 2;
+		m_boneScaleX = pose + m_boneCount * 3;
+		m_boneScaleY = pose + m_boneCount * 4;
+		m_boneTransforms = (wyAffineTransform*)wyMalloc(m_boneCount * sizeof(wyAffineTransform));
 
-void wySkeletalSprite::syncOriginalBoneStates(wyBone* bone) {
-	wyBone::State& originalState = bone->getOriginalState();
-	wyBone::State& state = bone->getState(this);
-	wyNode* boneNode = state.node;
-	if(boneNode) {
-		boneNode->setPosition(originalState.x, originalState.y);
-		boneNode->setRotation(-originalState.rotation);
-		boneNode->setScaleX(originalState.scaleX);
-		boneNode->setScaleY(originalState.scaleY);
+		wySkeleton::BonePtrList& boneList = m_skeleton->getBoneList();
+		for(int i = 0; i < m_boneCount; i++) {
+			wyBone::State& originalState = boneList[i]->getOriginalState();
+			m_boneX[i] = originalState.x;
+			m_boneY[i] = originalState.y;
+			m_boneRotation[i] = originalState.rotation;
+			m_boneScaleX[i] = originalState.scaleX;
+			m_boneScaleY[i] = originalState.scaleY;
+		}
 	}
-	
-	wyBone::BonePtrList& children = bone->getChildren();
-	for(wyBone::BonePtrList::iterator iter = children.begin(); iter != children.end(); iter++) {
-		syncOriginalBoneStates(*iter);
+
+	// slot states
+	m_slotCount = m_skeleton->getSlotCount();
+	if(m_slotCount > 0) {
+		m_slotColors = (int*)wyMalloc(m_slotCount * sizeof(int));
+		m_slotAttachmentNames = (const char**)wyMalloc(m_slotCount * sizeof(const char*));
+		m_slotSprites = (wySpriteEx**)wyCalloc(m_slotCount, sizeof(wySpriteEx*));
+
+		wySkeleton::SlotPtrList& slotList = m_skeleton->getSlotDisplayList();
+		for(int i = 0; i < m_slotCount; i++) {
+			wySlot::State& originalState = slotList[i]->getOriginalState();
+			m_slotColors[i] = originalState.color;
+			m_slotAttachmentNames[i] = originalState.activeAttachmentName;
+		}
 	}
 }
 
-void wySkeletalSprite::syncBoneStates(wyBone* bone) {
-	wyBone::State& state = bone->getState(this);
-	wyNode* boneNode = state.node;
-	if(boneNode) {
-		boneNode->setPosition(state.x, state.y);
-		boneNode->setRotation(-state.rotation);
-		boneNode->setScaleX(state.scaleX);
-		boneNode->setScaleY(state.scaleY);
+void wySkeletalSprite::releaseStates() {
+	// pose arrays are in one block which starts from x array
+	if(m_boneX) {
+		wyFree(m_boneX);
+		m_boneX = NULL;
+		m_boneY = NULL;
+		m_boneRotation = NULL;
+		m_boneScaleX = NULL;
+		m_boneScaleY = NULL;
 	}
-	
-	wyBone::BonePtrList& children = bone->getChildren();
-	for(wyBone::BonePtrList::iterator iter = children.begin(); iter != children.end(); iter++) {
-		syncBoneStates(*iter);
+	if(m_boneTransforms) {
+		wyFree(m_boneTransforms);
+		m_boneTransforms = NULL;
+	}
+	if(m_slotColors) {
+		wyFree(m_slotColors);
+		m_slotColors = NULL;
+	}
+	if(m_slotAttachmentNames) {
+		wyFree(m_slotAttachmentNames);
+		m_slotAttachmentNames = NULL;
+	}
+	if(m_slotSprites) {
+		for(int i = 0; i < m_slotCount; i++) {
+			wyObjectRelease(m_slotSprites[i]);
+		}
+		wyFree(m_slotSprites);
+		m_slotSprites = NULL;
 	}
+	m_boneCount = 0;
+	m_slotCount = 0;
 }
 
-void wySkeletalSprite::cleanSlotStates() {
-	wySkeleton::SlotPtrList& slotDisplayList = m_skeleton->getSlotDisplayList();
-	for(wySkeleton::SlotPtrList::iterator iter = slotDisplayList.begin(); iter != slotDisplayList.end(); iter++) {
-		(*iter)->clearState(this);
+void wySkeletalSprite::syncOriginalBoneStates() {
+	if(!m_skeleton)
+		return;
+
+	wySkeleton::BonePtrList& boneList = m_skeleton->getBoneList();
+	for(int i = 0; i < m_boneCount; i++) {
+		// fixed part is set by user, keep it
+		wyBone* bone = boneList[i];
+		wyBone::State& originalState = bone->getOriginalState();
+		if(!bone->hasFlag(wyBone::FIXED_POSITION)) {
+			m_boneX[i] = originalState.x;
+			m_boneY[i] = originalState.y;
+		}
+		if(!bone->hasFlag(wyBone::FIXED_ROTATION))
+			m_boneRotation[i] = originalState.rotation;
+		if(!bone->hasFlag(wyBone::FIXED_SCALE)) {
+			m_boneScaleX[i] = originalState.scaleX;
+			m_boneScaleY[i] = originalState.scaleY;
+		}
 	}
 }
 
 void wySkeletalSprite::syncAttachmentStates() {
 	wySkeleton::SlotPtrList& slotDisplayList = m_skeleton->getSlotDisplayList();
-	for(wySkeleton::SlotPtrList::iterator iter = slotDisplayList.begin(); iter != slotDisplayList.end(); iter++) {
-		wySlot* slot = *iter;
-		wySlot::State& state = slot->getState(this);
-		wySpriteEx* sprite = state.sprite;
-		wyAttachment* skin = slot->getActiveAttachment(this);
+	for(int i = 0; i < m_slotCount; i++) {
+		wySpriteEx* sprite = m_slotSprites[i];
+		wyAttachment* skin = slotDisplayList[i]->getAttachment(m_slotAttachmentNames[i]);
 		if(skin && sprite) {
 			sprite->setPosition(skin->getX(), skin->getY());
 			sprite->setRotation(-skin->getRotation());
@@ -361,58 +737,37 @@ void wySkeletalSprite::syncAttachmentStates() {
 
 void wySkeletalSprite::createSlotSprites() {
 	wySkeleton::SlotPtrList& slotDisplayList = m_skeleton->getSlotDisplayList();
-	for(wySkeleton::SlotPtrList::iterator iter = slotDisplayList.begin(); iter != slotDisplayList.end(); iter++) {
+	for(int i = 0; i < m_slotCount; i++) {
 		// get slot active attachment image file name
-		wySlot* slot = *iter;
+		wySlot* slot = slotDisplayList[i];
 		
 		// create slot sprite
-		wySlot::State& state = slot->getState(this);
-        wyAttachment* attachment = slot->getAttachment(state.activeAttachmentName);
+        wyAttachment* attachment = slot->getAttachment(m_slotAttachmentNames[i]);
 		if(attachment) {
             wyTexture2D* tex = wySkeleton::createRelatedTexture(m_skeleton, attachment->getPath());
 			wySpriteEx* sprite = wySpriteEx::make(tex);
 			if(sprite) {
-				state.sprite = sprite;
-				wyBone::State& state = slot->getBone()->getState(this);
-				if(state.node)
-					state.node->addChildLocked(sprite);
+				sprite->retain();
+				m_slotSprites[i] = sprite;
 			} 
 		}
 	}
 }
 
-void wySkeletalSprite::createBoneNodes(wyBone* bone) {
-	// this node is root bone node, so need skip root bone
-	wyBone::State& state = bone->getState(this);
-	wyNode* boneNode = wyNode::make();
-	state.node = boneNode;
-	if(bone->getParent()) {
-		wyBone::State& parentState = bone->getParent()->getState(this);
-		parentState.node->addChildLocked(boneNode);
-	} else {
-		addChildLocked(boneNode);
-	}
-	
-	wyBone::BonePtrList& children = bone->getChildren();
-	for(wyBone::BonePtrList::iterator iter = children.begin(); iter != children.end(); iter++) {
-		createBoneNodes(*iter);
-	}
-}
-
 void wySkeletalSprite::setBonePosition(const char* boneName, float x, float y, bool fixed) {
     // basic check
     if(!m_skeleton)
         return;
     
     // get bone
-    wyBone* bone = m_skeleton->getBone(boneName);
-    if(!bone)
+    int index = m_skeleton->getBoneIndex(boneName);
+    if(index < 0)
         return;
     
     // set
-    wyBone::State& state = bone->getState(this);
-    state.x = x;
-    state.y = y;
+    wyBone* bone = m_skeleton->getBoneList()[index];
+    m_boneX[index] = x;
+    m_boneY[index] = y;
     if(fixed)
         bone->addFlag(wyBone::FIXED_POSITION);
     else
@@ -425,13 +780,13 @@ void wySkeletalSprite::setBoneRotation(const char* boneName, float angle, bool f
         return;
     
     // get bone
-    wyBone* bone = m_skeleton->getBone(boneName);
-    if(!bone)
+    int index = m_skeleton->getBoneIndex(boneName);
+    if(index < 0)
         return;
     
     // set
-    wyBone::State& state = bone->getState(this);
-    state.rotation = angle;
+    wyBone* bone = m_skeleton->getBoneList()[index];
+    m_boneRotation[index] = angle;
     if(fixed)
         bone->addFlag(wyBone::FIXED_ROTATION);
     else
@@ -444,14 +799,14 @@ void wySkeletalSprite::setBoneScale(const char* boneName, float scaleX, float sc
         return;
     
     // get bone
-    wyBone* bone = m_skeleton->getBone(boneName);
-    if(!bone)
+    int index = m_skeleton->getBoneIndex(boneName);
+    if(index < 0)
         return;
     
     // set
-    wyBone::State& state = bone->getState(this);
-    state.scaleX = scaleX;
-    state.scaleY = scaleY;
+    wyBone* bone = m_skeleton->getBoneList()[index];
+    m_boneScaleX[index] = scaleX;
+    m_boneScaleY[index] = scaleY;
     if(fixed)
         bone->addFlag(wyBone::FIXED_SCALE);
     else
@@ -464,14 +819,15 @@ void wySkeletalSprite::setSlotColor(const char* slotName, int color, bool fixed)
         return;
     
     // get slot
-    wySlot* slot = m_skeleton->getSlot(slotName);
-    if(!slot)
+    int index = m_skeleton->getSlotIndex(slotName);
+    if(index < 0)
         return;
     
     // set
-    wySlot::State& state = slot->getState(this);
-    state.color = color;
-    state.sprite->setColor(wyc4bFromInteger(color));
+    wySlot* slot = m_skeleton->getSlotDisplayList()[index];
+    m_slotColors[index] = color;
+    if(m_slotSprites[index])
+        m_slotSprites[index]->setColor(wyc4bFromInteger(color));
     if(fixed)
         slot->addFlag(wySlot::FIXED_COLOR);
     else
@@ -484,17 +840,18 @@ void wySkeletalSprite::setSlotAttachment(const char* slotName, const char* attac
         return;
     
     // get slot
-    wySlot* slot = m_skeleton->getSlot(slotName);
-    if(!slot)
+    int index = m_skeleton->getSlotIndex(slotName);
+    if(index < 0)
         return;
     
     // set
-    wySlot::State& state = slot->getState(this);
-    state.activeAttachmentName = attachmentName;
+    wySlot* slot = m_skeleton->getSlotDisplayList()[index];
+    m_slotAttachmentNames[index] = attachmentName;
     wyAttachment* attachment = slot->getAttachment(attachmentName);
     if(attachment) {
         wyTexture2D* tex = wySkeleton::createRelatedTexture(m_skeleton, attachment->getPath());
-        state.sprite->setTexture(tex);
+        if(m_slotSprites[index])
+            m_slotSprites[index]->setTexture(tex);
         if(fixed)
             slot->addFlag(wySlot::FIXED_ATTACHMENT);
         else
@@ -518,11 +875,13 @@ void wySkeletalSprite::applySkin(const char* skinName) {
     wySkin::SlotPtrList& slotList = skin->getSlotList();
     for(wySkin::SlotPtrList::iterator iter = slotList.begin(); iter != slotList.end(); iter++) {
         wySlot* slot = *iter;
-        wySlot::State& state = slot->getState(this);
+        int index = slot->getIndex();
         wyAttachment* first = slot->getFirstAttachment();
-        if(first) {
+        if(first && index >= 0 && index < m_slotCount) {
+            m_slotAttachmentNames[index] = first->getName();
             wyTexture2D* tex = wySkeleton::createRelatedTexture(m_skeleton, first->getPath());
-            state.sprite->setTexture(tex);
+            if(m_slotSprites[index])
+                m_slotSprites[index]->setTexture(tex);
         }
     }
 }
\ No newline at end of file
@@ -32,7 +32,15 @@
 
 const char* wySkeleton::DEFALT_SKIN_NAME = "default";
 
+// id of next created skeleton, zero is never used
+static int sNextSkeletonId = 1;
+
 wySkeleton::wySkeleton() :
+		m_id(sNextSkeletonId++),
+		m_boneParents(NULL),
+		m_boneUpdateOrder(NULL),
+		m_slotBones(NULL),
+		m_setupDirty(true),
 		m_source(RESOURCE),
 		m_path(NULL) {
 }
@@ -41,6 +49,12 @@ wySkeleton::~wySkeleton() {
 	if(m_path) {
 		wyFree((void*)m_path);
 	}
+	if(m_boneParents)
+		wyFree(m_boneParents);
+	if(m_boneUpdateOrder)
+		wyFree(m_boneUpdateOrder);
+	if(m_slotBones)
+		wyFree(m_slotBones);
 	for(BoneMap::iterator iter = m_boneMap.begin(); iter != m_boneMap.end(); iter++) {
 		wyObjectRelease(iter->second);
 	}
@@ -61,6 +75,9 @@ void wySkeleton::addBone(wyBone* bone) {
 	BoneMap::iterator iter = m_boneMap.find(bone->getName());
 	if(iter == m_boneMap.end()) {
 		m_boneMap[bone->getName()] = bone;
+		bone->setIndex(m_boneList.size());
+		m_boneList.push_back(bone);
+		m_setupDirty = true;
 		wyObjectRetain(bone);
 	}
 }
@@ -69,7 +86,9 @@ void wySkeleton::addSlot(wySlot* slot) {
 	SlotMap::iterator iter = m_slotMap.find(slot->getName());
 	if(iter == m_slotMap.end()) {
 		m_slotMap[slot->getName()] = slot;
+		slot->setIndex(m_slotDisplayList.size());
 		m_slotDisplayList.push_back(slot);
+		m_setupDirty = true;
 		wyObjectRetain(slot);
 	}
 }
@@ -114,6 +133,55 @@ wySlot* wySkeleton::getSlot(const char* name) {
 	}
 }
 
+void wySkeleton::buildSetupData() {
+	if(!m_setupDirty)
+		return;
+
+	// parent of bones
+	int boneCount = m_boneList.size();
+	m_boneParents = (int*)wyRealloc(m_boneParents, MAX(1, boneCount) * sizeof(int));
+	for(int i = 0; i < boneCount; i++) {
+		wyBone* parent = m_boneList[i]->getParent();
+		m_boneParents[i] = parent ? parent->getIndex() : -1;
+	}
+
+	// bones are usually added from root to leaf, but it is not guaranteed, so sort them
+	// breadth first. head walks the queue and every bone appends its children
+	m_boneUpdateOrder = (int*)wyRealloc(m_boneUpdateOrder, MAX(1, boneCount) * sizeof(int));
+	int tail = 0;
+	for(int i = 0; i < boneCount; i++) {
+		if(m_boneParents[i] == -1)
+			m_boneUpdateOrder[tail++] = i;
+	}
+	for(int head = 0; head < tail; head++) {
+		wyBone::BonePtrList& children = m_boneList[m_boneUpdateOrder[head]]->getChildren();
+		for(wyBone::BonePtrList::iterator iter = children.begin(); iter != children.end(); iter++) {
+			if((*iter)->getIndex() >= 0 && tail < boneCount)
+				m_boneUpdateOrder[tail++] = (*iter)->getIndex();
+		}
+	}
+
+	// bone of slots
+	int slotCount = m_slotDisplayList.size();
+	m_slotBones = (int*)wyRealloc(m_slotBones, MAX(1, slotCount) * sizeof(int));
+	for(int i = 0; i < slotCount; i++) {
+		wyBone* bone = m_slotDisplayList[i]->getBone();
+		m_slotBones[i] = bone ? bone->getIndex() : -1;
+	}
+
+	m_setupDirty = false;
+}
+
+int wySkeleton::getBoneIndex(const char* name) {
+	wyBone* bone = getBone(name);
+	return bone ? bone->getIndex() : -1;
+}
+
+int wySkeleton::getSlotIndex(const char* name) {
+	wySlot* slot = getSlot(name);
+	return slot ? slot->getIndex() : -1;
+}
+
 wySkin* wySkeleton::getSkin(const char* name) {
     if(!name)
 		return NULL;
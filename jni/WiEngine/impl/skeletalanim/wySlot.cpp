@@ -30,10 +30,12 @@
 #include "wyBone.h"
 #include "wyUtils.h"
 #include "wySpriteEx.h"
+#include "wySkeletalSprite.h"
 
 wySlot::wySlot(wyBone* bone) :
 		m_bone(bone),
-        m_flags(0) {
+        m_flags(0),
+		m_index(-1) {
 	wyObjectRetain(m_bone);
 			
 	m_originalState.color = 0xffffffff;
@@ -65,38 +67,8 @@ void wySlot::addAttachment(wyAttachment* a) {
     }
 }
 
-void wySlot::clearState(wySkeletalSprite* owner) {
-	StateMap::iterator iter = m_stateMap.find(owner);
-	if(iter != m_stateMap.end()) {
-		m_stateMap.erase(iter);
-	}
-}
-
-wySlot::State& wySlot::getState(wySkeletalSprite* owner) {
-	StateMap::iterator iter = m_stateMap.find(owner);
-	if(iter != m_stateMap.end()) {
-		return iter->second;
-	} else {
-		m_stateMap[owner] = m_originalState;
-		iter = m_stateMap.find(owner);
-		return iter->second;
-	}
-}
-
 wyAttachment* wySlot::getActiveAttachment(wySkeletalSprite* owner) {
-	State& state = getState(owner);
-	
-	// if skin name is NULL, return
-	if(!state.activeAttachmentName)
-		return NULL;
-
-	// find attachment
-	for(AttachmentPtrList::iterator iter = m_attachments.begin(); iter != m_attachments.end(); iter++) {
-		if(!strcmp((*iter)->getName(), state.activeAttachmentName))
-			return (wyAttachment*)*iter;
-	}
-
-	return NULL;
+	return getAttachment(owner->getSlotAttachmentName(m_index));
 }
 
 wyAttachment* wySlot::getAttachment(const char* name) {
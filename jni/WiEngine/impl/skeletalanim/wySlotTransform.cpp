@@ -35,6 +35,7 @@
 
 wySlotTransform::wySlotTransform() :
 		m_slotName(NULL) {
+	memset(m_cursors, 0, sizeof(m_cursors));
 }
 
 wySlotTransform::~wySlotTransform() {
@@ -59,6 +60,9 @@ void wySlotTransform::setSlotName(const char* name) {
 		m_slotName = NULL;
 	}
 	m_slotName = wyUtils::copy(name);
+
+	// target should be resolved again
+	m_skeletonId = 0;
 }
 
 void wySlotTransform::addSkinKeyFrame(SkinKeyFrame kf) {
@@ -69,113 +73,116 @@ void wySlotTransform::addColorKeyFrame(ColorKeyFrame kf) {
 	m_ckfList.push_back(kf);
 }
 
-void wySlotTransform::populateFrame(float time) {
-	// process skin frame
-	{
-		// set time to current time
-		m_currentSkin.time = time;
-		m_currentSkin.valid = true;
-		
-		// if empty, just set to zero
-		// if not, found key frame, do interpolation if needed
-		if(m_skfList.empty()) {
-			m_currentSkin.valid = false;
-		} else {
-			SkinKeyFrameList::iterator iter = m_skfList.begin();
-			for(; iter != m_skfList.end(); iter++) {
-				SkinKeyFrame& kf = *iter;
-				if(time < kf.time) {
-					if(iter == m_skfList.begin()) {
-						m_currentSkin.skinName = kf.skinName;
-					} else {
-						SkinKeyFrame& prevKf = *(iter - 1);
-						wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
-						if(t.x >= 1)
-							m_currentSkin.skinName = kf.skinName;
-						else
-							m_currentSkin.skinName = prevKf.skinName;
-					}
-					break;
-				} else if(time == kf.time) {
-					m_currentSkin = kf;
-					break;
-				}
-			}
-			
-			// if exceed last one
-			if(iter == m_skfList.end()) {
-				m_currentSkin.skinName = m_skfList.rbegin()->skinName;
-			}
-		}
+int wySlotTransform::findTarget(wySkeleton* s) {
+	return s->getSlotIndex(m_slotName);
+}
+
+bool wySlotTransform::getSkinAt(float time, int& cursor, const char*& skinName) {
+	if(m_skfList.empty())
+		return false;
+
+	// skin is never interpolated, it changes when next key frame is reached
+	int count = m_skfList.size();
+	int i = seekKeyFrame(&m_skfList[0].time, sizeof(SkinKeyFrame), count, time, cursor);
+	if(i < 0) {
+		skinName = m_skfList[0].skinName;
+	} else if(i == count - 1 || time == m_skfList[i].time) {
+		skinName = m_skfList[i].skinName;
+	} else {
+		SkinKeyFrame& prevKf = m_skfList[i];
+		SkinKeyFrame& kf = m_skfList[i + 1];
+		wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
+		skinName = t.x >= 1 ? kf.skinName : prevKf.skinName;
 	}
-	
-	// process color frame
-	{
-		// set time to current time
-		m_currentColor.time = time;
-		m_currentColor.valid = true;
-		
-		// if empty, just set to zero
-		// if not, found key frame, do interpolation if needed
-		if(m_ckfList.empty()) {
-			m_currentColor.valid = false;
-		} else {
-			ColorKeyFrameList::iterator iter = m_ckfList.begin();
-			for(; iter != m_ckfList.end(); iter++) {
-				ColorKeyFrame& kf = *iter;
-				if(time < kf.time) {
-					if(iter == m_ckfList.begin()) {
-						m_currentColor.color = kf.color;
-					} else {
-						ColorKeyFrame& prevKf = *(iter - 1);
-						wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
-						m_currentColor.color = t.x * (kf.color - prevKf.color) + prevKf.color;
-					}
-					break;
-				} else if(time == kf.time) {
-					m_currentColor = kf;
-					break;
-				}
-			}
-			
-			// if exceed last one
-			if(iter == m_ckfList.end()) {
-				m_currentColor.color = m_ckfList.rbegin()->color;
-			}
-		}
+	return true;
+}
+
+bool wySlotTransform::getColorAt(float time, int& cursor, int& color) {
+	if(m_ckfList.empty())
+		return false;
+
+	int count = m_ckfList.size();
+	int i = seekKeyFrame(&m_ckfList[0].time, sizeof(ColorKeyFrame), count, time, cursor);
+	if(i < 0) {
+		color = m_ckfList[0].color;
+	} else if(i == count - 1 || time == m_ckfList[i].time) {
+		color = m_ckfList[i].color;
+	} else {
+		ColorKeyFrame& prevKf = m_ckfList[i];
+		ColorKeyFrame& kf = m_ckfList[i + 1];
+		wyPoint t = getInterpolationTime(prevKf.time, kf.time, time, prevKf.interpolator);
+		color = t.x * (kf.color - prevKf.color) + prevKf.color;
 	}
+	return true;
+}
+
+void wySlotTransform::populateFrame(float time) {
+	m_currentSkin.time = time;
+	m_currentSkin.valid = getSkinAt(time, m_cursors[0], m_currentSkin.skinName);
+	m_currentColor.time = time;
+	m_currentColor.valid = getColorAt(time, m_cursors[1], m_currentColor.color);
 }
 
 bool wySlotTransform::applyTo(wySkeletalSprite* owner) {
+	return applyFrame(owner, m_currentSkin, m_currentColor, 1, false);
+}
+
+bool wySlotTransform::applyTo(wySkeletalSprite* owner, float time, int* cursors, float weight, bool additive) {
+	SkinKeyFrame skin;
+	ColorKeyFrame color;
+	skin.valid = getSkinAt(time, cursors[0], skin.skinName);
+	color.valid = getColorAt(time, cursors[1], color.color);
+	return applyFrame(owner, skin, color, weight, additive);
+}
+
+bool wySlotTransform::applyFrame(wySkeletalSprite* owner, SkinKeyFrame& skin, ColorKeyFrame& color, float weight, bool additive) {
+	// attachment and color are not offsets, additive layer doesn't change them
+	if(additive)
+		return true;
+
 	wySkeleton* s = owner->getSkeleton();
-	wySlot* slot = s->getSlot(m_slotName);
-	if(!slot)
+	int index = resolveTarget(s);
+	if(index < 0)
 		return false;
-	
-	// get state of this owner
-	wySlot::State& state = slot->getState(owner);
-	wySpriteEx* sprite = state.sprite;
-	
+
 	// check sprite
+	wySpriteEx* sprite = owner->m_slotSprites[index];
 	if(!sprite)
 		return false;
-	
-	// set skin texture
-	if(m_currentSkin.valid && !slot->hasFlag(wySlot::FIXED_ATTACHMENT)) {
-		state.activeAttachmentName = m_currentSkin.skinName;
-        wyAttachment* attachment = slot->getAttachment(m_currentSkin.skinName);
-        if(attachment) {
-            wyTexture2D* tex = wySkeleton::createRelatedTexture(s, attachment->getPath());
-            sprite->setTexture(tex);
-        }
+
+	// set skin texture, only when attachment is changed because texture lookup is slow
+	// attachment can't be interpolated, it switches when weight reaches half
+	wySlot* slot = s->getSlotDisplayList()[index];
+	if(skin.valid && weight >= 0.5f && !slot->hasFlag(wySlot::FIXED_ATTACHMENT)) {
+		const char* current = owner->m_slotAttachmentNames[index];
+		if(current != skin.skinName && (current == NULL || skin.skinName == NULL || strcmp(current, skin.skinName))) {
+			owner->m_slotAttachmentNames[index] = skin.skinName;
+			wyAttachment* attachment = slot->getAttachment(skin.skinName);
+			if(attachment) {
+				wyTexture2D* tex = wySkeleton::createRelatedTexture(s, attachment->getPath());
+				sprite->setTexture(tex);
+			}
+		}
 	}
-	
-	// set color
-	if(m_currentColor.valid && !slot->hasFlag(wySlot::FIXED_COLOR)) {
-		state.color = m_currentColor.color;
-		sprite->setColor(wyc4bFromInteger(m_currentColor.color));
+
+	// set color, interpolate every channel if weight is less than 1
+	if(color.valid && !slot->hasFlag(wySlot::FIXED_COLOR)) {
+		int c = color.color;
+		if(weight < 1) {
+			int from = owner->m_slotColors[index];
+			c = 0;
+			for(int shift = 0; shift < 32; shift += 8) {
+				int a = (from >> shift) & 0xff;
+				int b = (color.color >> shift) & 0xff;
+				c |= ((int)(a + (b - a) * weight) & 0xff) << shift;
+			}
+		}
+		if(owner->m_slotColors[index] != c) {
+			owner->m_slotColors[index] = c;
+			sprite->setColor(wyc4bFromInteger(c));
+		}
 	}
-	
+
 	return true;
 }
 
@@ -27,8 +27,11 @@
  * THE SOFTWARE.
  */
 #include "wyTransform.h"
+#include "wySkeleton.h"
 
-wyTransform::wyTransform() {
+wyTransform::wyTransform() :
+		m_skeletonId(0),
+		m_targetIndex(-1) {
 }
 
 wyTransform::~wyTransform() {
@@ -52,4 +55,39 @@ wyPoint wyTransform::getInterpolationTime(float startTime, float endTime, float
 		default:
 			return wypZero;
 	}
+}
+
+int wyTransform::resolveTarget(wySkeleton* s) {
+	if(m_skeletonId != s->getId()) {
+		m_targetIndex = findTarget(s);
+		m_skeletonId = s->getId();
+	}
+	return m_targetIndex;
+}
+
+int wyTransform::seekKeyFrame(const float* times, size_t stride, int count, float time, int& cursor) {
+#define TIME_AT(i) (*(const float*)((const char*)times + (i) * stride))
+
+	// check cached cursor and next one, it is hit in sequential playback
+	if(cursor >= 0 && cursor < count && TIME_AT(cursor) <= time) {
+		if(cursor + 1 >= count || time < TIME_AT(cursor + 1))
+			return cursor;
+		if(cursor + 2 >= count || time < TIME_AT(cursor + 2))
+			return ++cursor;
+	}
+
+	// binary search last key frame whose time is not greater than time
+	int low = 0;
+	int high = count;
+	while(low < high) {
+		int mid = (low + high) >> 1;
+		if(TIME_AT(mid) <= time)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	cursor = low - 1;
+	return cursor;
+
+#undef TIME_AT
 }
\ No newline at end of file
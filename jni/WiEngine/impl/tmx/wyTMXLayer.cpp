@@ -33,18 +33,47 @@
 #include "wyTextureManager.h"
 #include "wyTypes.h"
 #include "wyUtils.h"
+#include "wyRenderQueue.h"
+#include "wyDevice.h"
+
+extern wyRenderQueue* gRenderQueue;
+
+// side of a chunk, in tiles
+#define CHUNK_SIZE 32
+
+// a chunk is released if it is not visible in these frames
+#define CHUNK_EXPIRE_FRAMES 60
 
 typedef struct wyTileSetAtlasInfo {
     int atlasIndex;
     int tilesetIndex;
 } wyTileSetAtlasInfo;
 
+typedef struct wyTMXChunk {
+	// atlas of every tileset, element is NULL if chunk has no tile of that tileset
+	wyTextureAtlas** atlases;
+
+	// atlas info of every tile in chunk, NULL means chunk is not built
+	wyTileSetAtlasInfo* infos;
+
+	// frame when chunk is visible last time
+	int lastVisibleFrame;
+} wyTMXChunk;
+
 wyTMXLayer::wyTMXLayer(int layerIndex, wyMapInfo* mapInfo) :
         m_mapInfo(mapInfo),
         m_layerInfo(NULL),
         m_color(wyc4bWhite),
 		m_tileWidth(mapInfo->tileWidth),
 		m_tileHeight(mapInfo->tileHeight),
+		m_chunks(NULL),
+		m_chunkCountX(0),
+		m_chunkCountY(0),
+		m_builtChunks(NULL),
+		m_builtCount(0),
+		m_frame(0),
+		m_maxTileImageWidth(0),
+		m_maxTileImageHeight(0),
         m_batchNodes((wySpriteBatchNode**)wyCalloc(mapInfo->tilesets->num, sizeof(wySpriteBatchNode*))),   
 		m_useAutomaticVertexZ(false),
 		m_vertexZAt(0),
@@ -64,10 +93,18 @@ wyTMXLayer::wyTMXLayer(int layerIndex, wyMapInfo* mapInfo) :
     m_minGid = layerInfo->minGid;
     m_maxGid = layerInfo->maxGid;
     
-    // allocate memory for atlas indices
-    size_t size = layerInfo->layerWidth * layerInfo->layerHeight * sizeof(wyTileSetAtlasInfo);
-    m_atlasInfos = (wyTileSetAtlasInfo*)wyMalloc(size);
-    memset(m_atlasInfos, 0xff, size);
+	// allocate chunks, their atlases are built when they are visible
+	m_chunkCountX = (m_layerWidth + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	m_chunkCountY = (m_layerHeight + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	m_chunks = (wyTMXChunk*)wyCalloc(m_chunkCountX * m_chunkCountY, sizeof(wyTMXChunk));
+	m_builtChunks = (int*)wyMalloc(m_chunkCountX * m_chunkCountY * sizeof(int));
+
+	// max tile image size, it is used to decide visible chunks
+	for(int i = 0; i < mapInfo->tilesets->num; i++) {
+		wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(mapInfo->tilesets, i);
+		m_maxTileImageWidth = MAX(m_maxTileImageWidth, tileset->tileWidth);
+		m_maxTileImageHeight = MAX(m_maxTileImageHeight, tileset->tileHeight);
+	}
 
 	// set anchor percent
 	setAnchor(0.f, 0.f);
@@ -96,8 +133,11 @@ wyTMXLayer::wyTMXLayer(int layerIndex, wyMapInfo* mapInfo) :
 }
 
 wyTMXLayer::~wyTMXLayer() {
+	while(m_builtCount > 0)
+		releaseChunk(m_builtChunks[m_builtCount - 1]);
     wyFree(m_batchNodes);
-	wyFree(m_atlasInfos);
+	wyFree(m_chunks);
+	wyFree(m_builtChunks);
 }
 
 wyTMXLayer* wyTMXLayer::make(int layerIndex, wyMapInfo* mapInfo) {
@@ -253,22 +293,20 @@ float wyTMXLayer::getVertexZAt(int x, int y) {
 	return ret;
 }
 
-void wyTMXLayer::appendTileForGid(int tilesetIndex, int gid, int x, int y) {
-	// get next index
-    wyTextureAtlas* atlas = m_batchNodes[tilesetIndex]->getTexAtlas();
-	int index = atlas->getNextAvailableIndex();
+int wyTMXLayer::getChunkIndex(int x, int y) {
+	return y / CHUNK_SIZE * m_chunkCountX + x / CHUNK_SIZE;
+}
 
-	// save atlas index
-	int z = x + y * m_layerWidth;
-	m_atlasInfos[z].atlasIndex = index;
-    m_atlasInfos[z].tilesetIndex = tilesetIndex;
+int wyTMXLayer::getIndexInChunk(int x, int y) {
+	return y % CHUNK_SIZE * CHUNK_SIZE + x % CHUNK_SIZE;
+}
 
+void wyTMXLayer::makeQuad(wyTextureAtlas* atlas, wyTileSetInfo* tileset, int gid, int x, int y, wyQuad2D* texCoords, wyQuad3D* vertices) {
 	// get atlas size
 	float atlasWidth = atlas->getTexture()->getPixelWidth();
 	float atlasHeight = atlas->getTexture()->getPixelHeight();
 
 	// get tile vertex
-    wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, tilesetIndex);
 	wyRect rect = wyTileSetInfoGetRect(tileset, gid);
 	wyPoint pos = getPositionAt(x, y);
 	float left = pos.x;
@@ -278,26 +316,284 @@ void wyTMXLayer::appendTileForGid(int tilesetIndex, int gid, int x, int y) {
 
 	// get tex coords
 	float left2 = (2 * rect.x + 1) / (2 * atlasWidth);
-    float right2 = left2 + (2 * rect.width - 2) / (2 * atlasWidth);
+	float right2 = left2 + (2 * rect.width - 2) / (2 * atlasWidth);
 	float top2 = (2 * rect.y + 1) / (2 * atlasHeight);
 	float bottom2 = top2 + (2 * rect.height - 2) / (2 * atlasHeight);
 
-	// update atlas arrays
+	// fill quads
 	float vertexZ = getVertexZAt(x, y);
-	wyQuad2D texCoords = {
+	wyQuad2D t = {
 		left2, bottom2,
 		right2, bottom2,
 		left2, top2,
 		right2, top2
 	};
-	wyQuad3D vertex = {
+	wyQuad3D v = {
 		left, bottom, vertexZ,
 		right, bottom, vertexZ,
 		left, top, vertexZ,
 		right, top, vertexZ
 	};
-	atlas->insertQuad(texCoords, vertex, index);
-	atlas->updateColor(m_color, index);
+	*texCoords = t;
+	*vertices = v;
+}
+
+wyTextureAtlas* wyTMXLayer::getChunkAtlas(wyTMXChunk* chunk, int tilesetIndex) {
+	if(chunk->atlases[tilesetIndex] == NULL) {
+		wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, tilesetIndex);
+		chunk->atlases[tilesetIndex] = WYNEW wyTextureAtlas(tileset->texture);
+		chunk->atlases[tilesetIndex]->setStableSlots(true);
+		chunk->atlases[tilesetIndex]->setUseBufferObject(true);
+	}
+	return chunk->atlases[tilesetIndex];
+}
+
+void wyTMXLayer::appendTileForGid(int tilesetIndex, int gid, int x, int y) {
+	// get quad
+	wyTMXChunk* chunk = m_chunks + getChunkIndex(x, y);
+	wyTextureAtlas* atlas = getChunkAtlas(chunk, tilesetIndex);
+	wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, tilesetIndex);
+	wyQuad2D texCoords;
+	wyQuad3D vertex;
+	makeQuad(atlas, tileset, gid, x, y, &texCoords, &vertex);
+
+	// atlas is in stable slot mode, it reuses a free slot if has
+	int z = getIndexInChunk(x, y);
+	chunk->infos[z].atlasIndex = atlas->appendQuad(texCoords, vertex);
+	chunk->infos[z].tilesetIndex = tilesetIndex;
+}
+
+void wyTMXLayer::hideTileInChunk(int x, int y) {
+	wyTMXChunk* chunk = m_chunks + getChunkIndex(x, y);
+	if(chunk->infos == NULL)
+		return;
+
+	// degenerate quad draws nothing
+	wyTileSetAtlasInfo& info = chunk->infos[getIndexInChunk(x, y)];
+	if(info.atlasIndex >= 0) {
+		wyQuad2D texCoords;
+		wyQuad3D vertex;
+		memset(&texCoords, 0, sizeof(wyQuad2D));
+		memset(&vertex, 0, sizeof(wyQuad3D));
+		chunk->atlases[info.tilesetIndex]->updateQuad(texCoords, vertex, info.atlasIndex);
+	}
+}
+
+void wyTMXLayer::buildChunk(int index) {
+	wyTMXChunk* chunk = m_chunks + index;
+	if(chunk->infos != NULL)
+		return;
+
+	// tile range of chunk
+	int startX = index % m_chunkCountX * CHUNK_SIZE;
+	int startY = index / m_chunkCountX * CHUNK_SIZE;
+	int endX = MIN(startX + CHUNK_SIZE, m_layerWidth);
+	int endY = MIN(startY + CHUNK_SIZE, m_layerHeight);
+
+	// count tiles of every tileset so that atlas won't be resized when appending
+	int tilesetCount = m_mapInfo->tilesets->num;
+	int* counts = (int*)wyCalloc(tilesetCount, sizeof(int));
+	for(int y = startY; y < endY; y++) {
+		for(int x = startX; x < endX; x++) {
+			int gid = m_tiles[x + m_layerWidth * y];
+			if(gid != 0)
+				counts[wyMapInfoGetTileSetIndex(m_mapInfo, gid)]++;
+		}
+	}
+
+	// create atlases
+	chunk->atlases = (wyTextureAtlas**)wyCalloc(tilesetCount, sizeof(wyTextureAtlas*));
+	for(int i = 0; i < tilesetCount; i++) {
+		if(counts[i] > 0) {
+			wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, i);
+			chunk->atlases[i] = WYNEW wyTextureAtlas(tileset->texture, counts[i]);
+			chunk->atlases[i]->setStableSlots(true);
+			chunk->atlases[i]->setUseBufferObject(true);
+		}
+	}
+	wyFree(counts);
+
+	// allocate atlas infos
+	size_t size = CHUNK_SIZE * CHUNK_SIZE * sizeof(wyTileSetAtlasInfo);
+	chunk->infos = (wyTileSetAtlasInfo*)wyMalloc(size);
+	memset(chunk->infos, 0xff, size);
+	m_builtChunks[m_builtCount++] = index;
+
+	// add tiles
+	for(int y = startY; y < endY; y++) {
+		for(int x = startX; x < endX; x++) {
+			int gid = m_tiles[x + m_layerWidth * y];
+
+			// gid == 0 -> empty tile
+			if(gid != 0)
+				appendTileForGid(wyMapInfoGetTileSetIndex(m_mapInfo, gid), gid, x, y);
+		}
+	}
+
+	// tiles which have sprite are drawn by sprite
+	for(int i = 0; i < tilesetCount; i++) {
+		if(m_batchNodes[i] == NULL)
+			continue;
+
+		wyArray* children = m_batchNodes[i]->getChildren();
+		for(int j = 0; j < children->num; j++) {
+			wyNode* sprite = (wyNode*)wyArrayGet(children, j);
+			int x = sprite->getTag() % m_layerWidth;
+			int y = sprite->getTag() / m_layerWidth;
+			if(getChunkIndex(x, y) == index)
+				hideTileInChunk(x, y);
+		}
+	}
+}
+
+void wyTMXLayer::releaseChunk(int index) {
+	wyTMXChunk* chunk = m_chunks + index;
+	if(chunk->infos == NULL)
+		return;
+
+	// release atlases
+	for(int i = 0; i < m_mapInfo->tilesets->num; i++)
+		wyObjectRelease(chunk->atlases[i]);
+	wyFree(chunk->atlases);
+	wyFree(chunk->infos);
+	chunk->atlases = NULL;
+	chunk->infos = NULL;
+
+	// remove from built list, order is not important
+	for(int i = 0; i < m_builtCount; i++) {
+		if(m_builtChunks[i] == index) {
+			m_builtChunks[i] = m_builtChunks[--m_builtCount];
+			break;
+		}
+	}
+}
+
+void wyTMXLayer::releaseExpiredChunks() {
+	// iterate from end because released one is replaced by last one
+	for(int i = m_builtCount - 1; i >= 0; i--) {
+		int index = m_builtChunks[i];
+		if(m_frame - m_chunks[index].lastVisibleFrame > CHUNK_EXPIRE_FRAMES)
+			releaseChunk(index);
+	}
+}
+
+wyPoint wyTMXLayer::getTileCoordinateUnclamped(float x, float y) {
+	switch(m_mapInfo->orientation) {
+		case ORIENTATION_ISOMETRIC:
+		{
+			// reverse of getPositionForIsoAt
+			float diff = x * 2 / m_tileWidth - m_layerWidth + 1;
+			float sum = m_layerHeight * 2 - 2 - y * 2 / m_tileHeight;
+			return wyp((sum + diff) / 2, (sum - diff) / 2);
+		}
+		case ORIENTATION_HEXAGONAL:
+			return wyp(x / (m_tileWidth * 3 / 4), m_layerHeight - 1 - y / m_tileHeight);
+		default:
+			return wyp(x / m_tileWidth, m_layerHeight - 1 - y / m_tileHeight);
+	}
+}
+
+void wyTMXLayer::getVisibleChunks(int* minX, int* minY, int* maxX, int* maxY) {
+	// all chunks by default
+	*minX = 0;
+	*minY = 0;
+	*maxX = m_chunkCountX - 1;
+	*maxY = m_chunkCountY - 1;
+
+	// if camera, grid or vertex z is used, world transform doesn't match screen
+	for(wyNode* n = this; n != NULL; n = n->getParent()) {
+		if(n->hasCamera() || n->getVertexZ() != 0 || (n->getGrid() != NULL && n->getGrid()->isActive()))
+			return;
+	}
+
+	// screen rect in layer space, a tile is drawn from its position to right top
+	// so tile whose position is at left or bottom of screen may be visible too
+	wyAffineTransform t = getWorldToNodeTransform();
+	wyRect r = wyaTransformRect(t, wyr(0, 0, wyDevice::winWidth, wyDevice::winHeight));
+	r.x -= m_maxTileImageWidth;
+	r.y -= m_maxTileImageHeight;
+	r.width += m_maxTileImageWidth;
+	r.height += m_maxTileImageHeight;
+
+	// tile coordinate range of four corners
+	wyPoint p[4] = {
+		getTileCoordinateUnclamped(r.x, r.y),
+		getTileCoordinateUnclamped(r.x + r.width, r.y),
+		getTileCoordinateUnclamped(r.x, r.y + r.height),
+		getTileCoordinateUnclamped(r.x + r.width, r.y + r.height)
+	};
+	wyPoint min = p[0];
+	wyPoint max = p[0];
+	for(int i = 1; i < 4; i++) {
+		min.x = MIN(min.x, p[i].x);
+		min.y = MIN(min.y, p[i].y);
+		max.x = MAX(max.x, p[i].x);
+		max.y = MAX(max.y, p[i].y);
+	}
+
+	// one more tile at every side for rounding error, clamp before converting to int
+	float x0 = MAX(0, floor(min.x) - 1);
+	float y0 = MAX(0, floor(min.y) - 1);
+	float x1 = MIN(m_layerWidth - 1, floor(max.x) + 1);
+	float y1 = MIN(m_layerHeight - 1, floor(max.y) + 1);
+	if(x0 > x1 || y0 > y1) {
+		*maxX = -1;
+		*maxY = -1;
+	} else {
+		*minX = (int)x0 / CHUNK_SIZE;
+		*minY = (int)y0 / CHUNK_SIZE;
+		*maxX = (int)x1 / CHUNK_SIZE;
+		*maxY = (int)y1 / CHUNK_SIZE;
+	}
+}
+
+void wyTMXLayer::draw() {
+	gRenderQueue->flush();
+
+	// if no draw flag is set, call wyNode::draw and it
+	// will decide forward drawing to java layer or not
+	if(m_noDraw) {
+		wyNode::draw();
+		return;
+	}
+
+	// build visible chunks
+	int minX, minY, maxX, maxY;
+	getVisibleChunks(&minX, &minY, &maxX, &maxY);
+	m_frame++;
+	for(int y = minY; y <= maxY; y++) {
+		for(int x = minX; x <= maxX; x++) {
+			int index = y * m_chunkCountX + x;
+			buildChunk(index);
+			m_chunks[index].lastVisibleFrame = m_frame;
+		}
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnable(GL_TEXTURE_2D);
+
+	glColor4f(m_color.r / 255.0f, m_color.g / 255.0f, m_color.b / 255.0f, m_color.a / 255.0f);
+
+	// draw tileset by tileset, so tiles of later tileset still cover earlier ones
+	for(int i = 0; i < m_mapInfo->tilesets->num; i++) {
+		for(int y = minY; y <= maxY; y++) {
+			for(int x = minX; x <= maxX; x++) {
+				wyTextureAtlas* atlas = m_chunks[y * m_chunkCountX + x].atlases[i];
+				if(atlas != NULL && atlas->getTotalQuads() > atlas->getFreeSlotCount())
+					atlas->drawAll();
+			}
+		}
+	}
+
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+	glDisable(GL_TEXTURE_2D);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	// free memory of chunks which are not visible for a while
+	releaseExpiredChunks();
 }
 
 void wyTMXLayer::parseInternalProperties() {
@@ -336,30 +632,15 @@ void wyTMXLayer::setupTiles() {
 	// Parse cocos2d properties
 	parseInternalProperties();
 
-	// add tiles coordinates
-	for(int y = 0; y < m_layerHeight; y++) {
-		for(int x = 0; x < m_layerWidth; x++) {
-			int pos = x + m_layerWidth * y;
-			int gid = m_tiles[pos];
+	// find gid range, atlases are built when chunks become visible
+	int count = m_layerWidth * m_layerHeight;
+	for(int i = 0; i < count; i++) {
+		int gid = m_tiles[i];
 
-			// gid == 0 -> empty tile
-			if(gid != 0) {
-                // find tileset index
-                int tilesetIndex = wyMapInfoGetTileSetIndex(m_mapInfo, gid);
-                
-                // if corresponded batch not is not created, create it and add it
-                if(m_batchNodes[tilesetIndex] == NULL) {
-                    wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, tilesetIndex);
-                    wySpriteBatchNode* bn = wySpriteBatchNode::make(tileset->texture);
-                    m_batchNodes[tilesetIndex] = bn;
-                    addChildLocked(bn, tilesetIndex);
-                }
-                
-                // append tile
-				appendTileForGid(tilesetIndex, gid, x, y);
-				m_minGid = MIN(m_minGid, gid);
-				m_maxGid = MAX(m_maxGid, gid);
-			}
+		// gid == 0 -> empty tile
+		if(gid != 0) {
+			m_minGid = MIN(m_minGid, gid);
+			m_maxGid = MAX(m_maxGid, gid);
 		}
 	}
 }
@@ -387,28 +668,6 @@ int* wyTMXLayer::getGids(bool copy) {
 	}
 }
 
-void wyTMXLayer::decreaseIndexIfMoreThan(int tilesetIndex, int index) {
-	for(int x = 0; x < m_layerWidth; x++) {
-		for(int y = 0; y < m_layerHeight; y++) {
-			int z = x + y * m_layerWidth;
-			if(m_atlasInfos[z].tilesetIndex == tilesetIndex && m_atlasInfos[z].atlasIndex > index) {
-				m_atlasInfos[z].atlasIndex--;
-			}
-		}
-	}
-}
-
-void wyTMXLayer::increaseIndexIfEqualOrMoreThan(int tilesetIndex, int index) {
-	for(int x = 0; x < m_layerWidth; x++) {
-		for(int y = 0; y < m_layerHeight; y++) {
-			int z = x + y * m_layerWidth;
-			if(m_atlasInfos[z].tilesetIndex == tilesetIndex && m_atlasInfos[z].atlasIndex >= index) {
-				m_atlasInfos[z].atlasIndex++;
-			}
-		}
-	}
-}
-
 void wyTMXLayer::removeTile(wySpriteEx* sprite) {
 	// basic validation
 	if(!sprite)
@@ -416,205 +675,120 @@ void wyTMXLayer::removeTile(wySpriteEx* sprite) {
 
 	// get z
 	int z = sprite->getTag();
-	if(z < 0 || z >= m_layerWidth * m_layerHeight)
+	if(z < 0 || z >= m_layerWidth * m_layerHeight || m_tiles[z] == 0)
 		return;
 
-    // get batch node atlas
-    wySpriteBatchNode* bn = m_batchNodes[m_atlasInfos[z].tilesetIndex];
-
-    // remove this sprite from batch node
-    bn->removeChild(sprite, true);
-
-    // adjust atlas indices
-    decreaseIndexIfMoreThan(m_atlasInfos[z].tilesetIndex, m_atlasInfos[z].atlasIndex);
-    m_atlasInfos[z].tilesetIndex = -1;
-    m_atlasInfos[z].atlasIndex = -1;
+	// sprite must be got from tileAt
+	wySpriteBatchNode* bn = m_batchNodes[wyMapInfoGetTileSetIndex(m_mapInfo, m_tiles[z])];
+	if(bn == NULL || sprite->getParent() != bn)
+		return;
 
-    // remove gid
-    m_tiles[z] = 0;
+	removeTileAt(z % m_layerWidth, z / m_layerWidth);
 }
 
 void wyTMXLayer::removeTileAt(int x, int y) {
-	// find index
-	int z = x + y * m_layerWidth;
-	int index = m_atlasInfos[z].atlasIndex;
-	if(index < 0)
+	// has tile?
+	int gid = getGidAt(x, y);
+	if(gid == 0)
 		return;
-    
-    // get batch node atlas
-    wySpriteBatchNode* bn = m_batchNodes[m_atlasInfos[z].tilesetIndex];
-    wyTextureAtlas* atlas = bn->getTexAtlas();
 
 	// has sprite?
-	wySpriteEx* sprite = (wySpriteEx*)bn->getChildByTag(z);
-	if(sprite == NULL) {
-		// remove quadratic
-		atlas->removeQuad(index);
-	} else {
-        // remove this sprite from batch node
-        bn->removeChild(sprite, true);
+	int z = x + y * m_layerWidth;
+	wySpriteBatchNode* bn = m_batchNodes[wyMapInfoGetTileSetIndex(m_mapInfo, gid)];
+	if(bn != NULL) {
+		wyNode* sprite = bn->getChildByTag(z);
+		if(sprite != NULL)
+			bn->removeChild(sprite, true);
 	}
-    
-    // adjust atlas indices
-    decreaseIndexIfMoreThan(m_atlasInfos[z].tilesetIndex, index);
-    m_atlasInfos[z].tilesetIndex = -1;
-    m_atlasInfos[z].atlasIndex = -1;
-    
-    // remove gid
-    m_tiles[z] = 0;
+
+	// remove quad if chunk is built
+	wyTMXChunk* chunk = m_chunks + getChunkIndex(x, y);
+	if(chunk->infos != NULL) {
+		wyTileSetAtlasInfo& info = chunk->infos[getIndexInChunk(x, y)];
+		if(info.atlasIndex >= 0) {
+			// quad becomes degenerate, other quads are not moved
+			chunk->atlases[info.tilesetIndex]->removeQuad(info.atlasIndex);
+			info.tilesetIndex = -1;
+			info.atlasIndex = -1;
+		}
+	}
+
+	// remove gid
+	m_tiles[z] = 0;
 }
 
 void wyTMXLayer::setTileAt(int tilesetIndex, int gid, int x, int y, int z) {
-    // get tileset
-    wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, tilesetIndex);
-    
-    // if coorespond batch not is not created, create it and add it
-    if(m_batchNodes[tilesetIndex] == NULL) {
-        wySpriteBatchNode* bn = wySpriteBatchNode::make(tileset->texture);
-        m_batchNodes[tilesetIndex] = bn;
-        addChildLocked(bn, tilesetIndex);
-    }
-    
-    // get atlas and tileset
-    wyTextureAtlas* atlas = m_batchNodes[tilesetIndex]->getTexAtlas();
-    
-    // get atlas size
-    float atlasWidth = atlas->getTexture()->getPixelWidth();
-    float atlasHeight = atlas->getTexture()->getPixelHeight();
-    
-    // get tile vertex
-    wyRect rect = wyTileSetInfoGetRect(tileset, gid);
-    wyPoint pos = getPositionAt(x, y);
-    float left = pos.x;
-    float bottom = pos.y;
-    float right = left + rect.width;
-    float top = bottom + rect.height;
-    
-    // get tex coords
-    float left2 = (2 * rect.x + 1) / (2 * atlasWidth);
-    float right2 = left2 + (2 * rect.width - 2) / (2 * atlasWidth);
-    float top2 = (2 * rect.y + 1) / (2 * atlasHeight);
-    float bottom2 = top2 + (2 * rect.height - 2) / (2 * atlasHeight);
-    
-    // update atlas arrays
-    float vertexZ = getVertexZAt(x, y);
-    wyQuad2D texCoords = {
-        left2, bottom2,
-        right2, bottom2,
-        left2, top2,
-        right2, top2
-    };
-    wyQuad3D vertex = {
-        left, bottom, vertexZ,
-        right, bottom, vertexZ,
-        left, top, vertexZ,
-        right, top, vertexZ
-    };
-    int index = atlas->appendQuad(texCoords, vertex);
-    atlas->updateColor(m_color, index);
-    
-    // save atlas indices
-    m_atlasInfos[z].atlasIndex = index;
-    m_atlasInfos[z].tilesetIndex = tilesetIndex;
-    
-    // insert gid
-    m_tiles[z] = gid;
+	// insert gid
+	m_tiles[z] = gid;
+
+	// if chunk is not built, tile will be added when it is built
+	if(m_chunks[getChunkIndex(x, y)].infos != NULL)
+		appendTileForGid(tilesetIndex, gid, x, y);
 }
 
 void wyTMXLayer::setTileAt(int gid, int x, int y) {
-    // decide tileset index
-    int tilesetIndex = wyMapInfoGetTileSetIndex(m_mapInfo, gid);
-    
-    // if same tileset, and index is not zero, just update it
-    // if same tileset, but index is zero, set it
-    // if not same tileset, first remove it and then set it
-    int z = x + y * m_layerWidth;
-    int index = m_atlasInfos[z].atlasIndex;
-    if(m_atlasInfos[z].tilesetIndex == tilesetIndex) {
-        if(index >= 0) {
-            updateTileAt(gid, x, y);
-        } else {
-            setTileAt(tilesetIndex, gid, x, y, z);
-        }
-    } else {
-        // first remove it
-        if(index >= 0)
-            removeTileAt(x, y);
-        
-        // then set it
-        setTileAt(tilesetIndex, gid, x, y, z);
-    }
+	if(x < 0 || x >= m_layerWidth || y < 0 || y >= m_layerHeight)
+		return;
+
+	// zero gid means empty tile
+	if(gid == 0) {
+		removeTileAt(x, y);
+		return;
+	}
+
+	// if there is a tile, update it
+	int z = x + y * m_layerWidth;
+	if(m_tiles[z] != 0)
+		updateTileAt(gid, x, y);
+	else
+		setTileAt(wyMapInfoGetTileSetIndex(m_mapInfo, gid), gid, x, y, z);
 }
 
 void wyTMXLayer::updateTileAt(int gid, int x, int y) {
-    // decide tileset index
-    int tilesetIndex = wyMapInfoGetTileSetIndex(m_mapInfo, gid);
-    
-    // if same tileset, but index less than zero, just set it
-    // if same tileset, but index >= 0, just update
-    // if not same tileset, remove it and then set it
-    int z = x + y * m_layerWidth;
-	int index = m_atlasInfos[z].atlasIndex;
-    if(m_atlasInfos[z].tilesetIndex == tilesetIndex) {
-        if(index < 0) {
-            setTileAt(tilesetIndex, gid, x, y, z);
-        } else {
-            // get atlas and tileset
-            wyTextureAtlas* atlas = m_batchNodes[tilesetIndex]->getTexAtlas();
-            wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, tilesetIndex);
-            
-            // get tile sprite if has
-            wySpriteEx* sprite = (wySpriteEx*)m_batchNodes[tilesetIndex]->getChildByTag(z);
-            if(sprite) {
-                wyRect rect = wyTileSetInfoGetRect(tileset, gid);
-                sprite->setTextureRect(rect);
-            } else {
-                // get atlas size
-                float atlasWidth = atlas->getTexture()->getPixelWidth();
-                float atlasHeight = atlas->getTexture()->getPixelHeight();
-                
-                // get tile vertex
-                wyRect rect = wyTileSetInfoGetRect(tileset, gid);
-                wyPoint pos = getPositionAt(x, y);
-                float left = pos.x;
-                float bottom = pos.y;
-                float right = left + rect.width;
-                float top = bottom + rect.height;
-                
-                // get tex coords
-                float left2 = (2 * rect.x + 1) / (2 * atlasWidth);
-                float right2 = left2 + (2 * rect.width - 2) / (2 * atlasWidth);
-                float top2 = (2 * rect.y + 1) / (2 * atlasHeight);
-                float bottom2 = top2 + (2 * rect.height - 2) / (2 * atlasHeight);
-                
-                // update atlas arrays
-                float vertexZ = getVertexZAt(x, y);
-                wyQuad2D texCoords = {
-                    left2, bottom2,
-                    right2, bottom2,
-                    left2, top2,
-                    right2, top2
-                };
-                wyQuad3D vertex = {
-                    left, bottom, vertexZ,
-                    right, bottom, vertexZ,
-                    left, top, vertexZ,
-                    right, top, vertexZ
-                };
-                atlas->updateQuad(texCoords, vertex, index);
-            }
-
-            // save gid
-            m_tiles[z] = gid;
-        }
-    } else {
-        // first remove it
-        if(index >= 0)
-            removeTileAt(x, y);
-        
-        // then set it
-        setTileAt(tilesetIndex, gid, x, y, z);
-    }
+	if(x < 0 || x >= m_layerWidth || y < 0 || y >= m_layerHeight)
+		return;
+
+	// zero gid means empty tile
+	if(gid == 0) {
+		removeTileAt(x, y);
+		return;
+	}
+
+	// if no tile, just set it
+	// if not same tileset, remove it and then set it
+	int tilesetIndex = wyMapInfoGetTileSetIndex(m_mapInfo, gid);
+	int z = x + y * m_layerWidth;
+	int oldGid = m_tiles[z];
+	if(oldGid == 0) {
+		setTileAt(tilesetIndex, gid, x, y, z);
+		return;
+	} else if(wyMapInfoGetTileSetIndex(m_mapInfo, oldGid) != tilesetIndex) {
+		removeTileAt(x, y);
+		setTileAt(tilesetIndex, gid, x, y, z);
+		return;
+	}
+
+	// get tile sprite if has
+	wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, tilesetIndex);
+	wySpriteBatchNode* bn = m_batchNodes[tilesetIndex];
+	wySpriteEx* sprite = bn == NULL ? NULL : (wySpriteEx*)bn->getChildByTag(z);
+	if(sprite) {
+		wyRect rect = wyTileSetInfoGetRect(tileset, gid);
+		sprite->setTextureRect(rect);
+	} else {
+		// update quad if chunk is built
+		wyTMXChunk* chunk = m_chunks + getChunkIndex(x, y);
+		if(chunk->infos != NULL) {
+			wyTextureAtlas* atlas = chunk->atlases[tilesetIndex];
+			wyQuad2D texCoords;
+			wyQuad3D vertex;
+			makeQuad(atlas, tileset, gid, x, y, &texCoords, &vertex);
+			atlas->updateQuad(texCoords, vertex, chunk->infos[getIndexInChunk(x, y)].atlasIndex);
+		}
+	}
+
+	// save gid
+	m_tiles[z] = gid;
 }
 
 wySpriteEx* wyTMXLayer::tileAt(int x, int y) {
@@ -626,11 +800,17 @@ wySpriteEx* wyTMXLayer::tileAt(int x, int y) {
 	if(gid != 0) {
         // decide tileset index
         int tilesetIndex = wyMapInfoGetTileSetIndex(m_mapInfo, gid);
-        
-        // get batch node and tileset
-        wySpriteBatchNode* bn = m_batchNodes[tilesetIndex];
         wyTileSetInfo* tileset = (wyTileSetInfo*)wyArrayGet(m_mapInfo->tilesets, tilesetIndex);
-        
+
+        // batch node only holds tile sprites, create it when first sprite is needed
+        wySpriteBatchNode* bn = m_batchNodes[tilesetIndex];
+        if(bn == NULL) {
+            bn = wySpriteBatchNode::make(tileset->texture);
+            bn->setColor(m_color);
+            m_batchNodes[tilesetIndex] = bn;
+            addChildLocked(bn, tilesetIndex);
+        }
+
 		// first check this child exist or not
 		int z = x + y * m_layerWidth;
 		sprite = (wySpriteEx*)bn->getChildByTag(z);
@@ -640,9 +820,6 @@ wySpriteEx* wyTMXLayer::tileAt(int x, int y) {
 			wyRect texRect = wyTileSetInfoGetRect(tileset, gid);
 			wyPoint pos = getPositionAt(x, y);
 			sprite = wySpriteEx::make(bn->getTexture(), texRect);
-            sprite->setBatchNode(bn);
-            sprite->useBatchNode(true);
-			sprite->setAtlasIndex(m_atlasInfos[z].atlasIndex);
 
 			/*
 			 * the tile image size may not same as tile size, so anchor percent may
@@ -656,10 +833,12 @@ wySpriteEx* wyTMXLayer::tileAt(int x, int y) {
 			sprite->setPosition(pos.x + m_tileWidth / 2, pos.y + m_tileHeight / 2);
 			sprite->setVertexZ(getVertexZAt(x, y));
 			sprite->setColor(m_color);
-			sprite->setTag(z);
+
+			// sprite draws this tile now, hide the quad in chunk
+			hideTileInChunk(x, y);
 
 			// add sprite to batch node
-            bn->wyNode::addChild(sprite, m_atlasInfos[z].atlasIndex, z);
+			bn->addChild(sprite, 0, z);
 		}
 	}
 
@@ -28,6 +28,9 @@
  */
 #include "wyTMXObjectLayer.h"
 #include "wyLog.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyTMXObjectLayer::wyTMXObjectLayer(wyTMXTileMap* m) :
 		m_map(m) {
@@ -42,6 +45,8 @@ wyTMXObjectLayer* wyTMXObjectLayer::make(wyTMXTileMap* m) {
 }
 
 void wyTMXObjectLayer::draw() {
+	gRenderQueue->flush();
+
 	wyMapInfo* mapInfo = m_map->getMapInfo();
 	for(int i = 0; i < mapInfo->objectGroups->num; i++) {
 		wyTMXObjectGroup* group = (wyTMXObjectGroup*)wyArrayGet(mapInfo->objectGroups, i);
@@ -88,6 +93,7 @@ void wyTMXObjectLayer::draw() {
 			glEnableClientState(GL_VERTEX_ARRAY);
 			glVertexPointer(2, GL_FLOAT, 0, buffer);
 			glDrawArrays(GL_LINE_STRIP, 0, m_vertices.getCount());
+			gRenderQueue->countDrawCall();
 			glDisableClientState(GL_VERTEX_ARRAY);
 			glColor4f(1, 1, 1, 1);
 		}
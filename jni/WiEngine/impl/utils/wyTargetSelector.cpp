@@ -33,6 +33,8 @@
 #include "wyJNI.h"
 extern jmethodID g_mid_TargetSelector_setDelta;
 extern jmethodID g_mid_TargetSelector_invoke;
+extern jclass gClass_System;
+extern jmethodID g_mid_System_identityHashCode;
 #endif
 
 #ifdef __cplusplus
@@ -62,6 +64,7 @@ wyTargetSelector::wyTargetSelector(wyObject* callback, int id, ArgValue data) :
 		m_target(callback),
 #if ANDROID
 		m_jTarget(NULL),
+		m_jHash(0),
 #endif
 		m_id(id) {
 	memcpy(&m_data, &data, sizeof(ArgValue));
@@ -72,6 +75,7 @@ wyTargetSelector::wyTargetSelector(wyObject* target, wySEL sel) :
 		m_target(target),
 #if ANDROID
 		m_jTarget(NULL),
+		m_jHash(0),
 #endif
 		m_id(0) {
 	m_prototype = NONE;
@@ -84,6 +88,7 @@ wyTargetSelector::wyTargetSelector(wyObject* target, wySEL_i sel, int data) :
 		m_target(target),
 #if ANDROID
 		m_jTarget(NULL),
+		m_jHash(0),
 #endif
 		m_id(0) {
 	m_prototype = INT;
@@ -97,6 +102,7 @@ wyTargetSelector::wyTargetSelector(wyObject* target, wySEL_f sel, float data) :
 		m_target(target),
 	#if ANDROID
 		m_jTarget(NULL),
+		m_jHash(0),
 	#endif
 		m_id(0) {
 	m_prototype = FLOAT;
@@ -110,6 +116,7 @@ wyTargetSelector::wyTargetSelector(wyObject* target, wySEL_p sel, void* data) :
 		m_target(target),
 	#if ANDROID
 		m_jTarget(NULL),
+		m_jHash(0),
 	#endif
 		m_id(0) {
 	m_prototype = PVOID;
@@ -183,6 +190,7 @@ wyTargetSelector::wyTargetSelector(jobject callback) :
 		m_jTarget(NULL) {
 	JNIEnv* env = getEnv();
 	this->m_jTarget = env->NewGlobalRef(callback);
+	this->m_jHash = env->CallStaticIntMethod(gClass_System, g_mid_System_identityHashCode, callback);
 
 	m_prototype = NONE;
 	memset(&m_data, 0, sizeof(ArgValue));
@@ -210,6 +218,15 @@ bool wyTargetSelector::operator==(wyTargetSelector& ts) {
 	return false;
 }
 
+unsigned int wyTargetSelector::hash() {
+#if ANDROID
+	// java targets are equal if they are same object, but their global references are not
+	if(m_jTarget != NULL)
+		return (unsigned int)m_jHash;
+#endif
+	return (unsigned int)((uintptr_t)m_target >> 3);
+}
+
 void wyTargetSelector::setDelta(float delta) {
 #if ANDROID
 	if(m_jTarget != NULL) {
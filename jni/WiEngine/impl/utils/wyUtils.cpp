@@ -578,6 +578,31 @@ unsigned int wyUtils::strHash(const char* str) {
 	return hash & 0x7FFFFFFF;
 }
 
+// FNV-1a 64 bits constants
+#define FNV64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+uint64_t wyUtils::hash64(const void* data, size_t length) {
+	const unsigned char* p = (const unsigned char*)data;
+	uint64_t hash = FNV64_OFFSET_BASIS;
+	for(size_t i = 0; i < length; i++) {
+		hash ^= p[i];
+		hash *= FNV64_PRIME;
+	}
+
+	return hash;
+}
+
+uint64_t wyUtils::strHash64(const char* str) {
+	uint64_t hash = FNV64_OFFSET_BASIS;
+	while(*str) {
+		hash ^= (unsigned char)*str++;
+		hash *= FNV64_PRIME;
+	}
+
+	return hash;
+}
+
 static const char* smartTrim(const char* chars, int start, int end, bool startsParagraph) {
 	int s = start;
 	int e = end;
@@ -29,6 +29,9 @@
 #include "wyVerletRope.h"
 #include "wyLog.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
+
+extern wyRenderQueue* gRenderQueue;
 
 wyVerletRope::wyVerletRope(wyPoint a, wyPoint b, wyTexture2D* tex, size_t length) :
 		m_points(wyArrayNew(16)),
@@ -313,6 +316,8 @@ bool wyVerletRope::isStretched() {
 }
 
 void wyVerletRope::draw() {
+	gRenderQueue->flush();
+
 	// update quads
 	updateQuads();
 
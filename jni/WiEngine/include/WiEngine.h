@@ -37,6 +37,8 @@
 #include "wyBuildConfig.h"
 #include "wyGlobal.h"
 #include "wyArray.h"
+#include "wyAtomic.h"
+#include "wyLockFreeQueue.h"
 #include "wyHashSet.h"
 #include "wyTypes.h"
 #include "wyMemory.h"
@@ -87,6 +89,7 @@
 #include "wyTintBy.h"
 #include "wyTintTo.h"
 #include "wyToggleVisibility.h"
+#include "wyTween.h"
 #include "wyCoverFlowAction.h"
 
 // astar
@@ -95,6 +98,10 @@
 #include "wyAStarStep.h"
 #include "wyAStarTile.h"
 #include "wyHexagonAStarMap.h"
+#include "wyPathFinder.h"
+#include "wyPathHierarchy.h"
+#include "wyPathService.h"
+#include "wyPathSnapshot.h"
 #include "wyRectAStarMap.h"
 
 // ease actions
@@ -281,6 +288,7 @@
 #include "wyTexture2D.h"
 #include "wyTextureAtlas.h"
 #include "wyTextureManager.h"
+#include "wyRenderQueue.h"
 
 // particle
 #include "wyPointParticleSystem.h"
@@ -38,6 +38,7 @@
 #define WY_ACTION_INVALID_TAG -1
 
 class wyActionManager;
+struct wyTween;
 class wyAction;
 
 /**
@@ -187,9 +188,37 @@ protected:
 	jobject j_callback;
 #endif
 
+	/**
+	 * \if English
+	 * channel of packed tween, or -1 if action is not packed
+	 * \else
+	 * 打包补间的通道, 如果动作没有被打包则为-1
+	 * \endif
+	 */
+	int m_tweenChannel;
+
+	/**
+	 * \if English
+	 * index of packed tween in buffer of action manager, or -1 if action is not packed
+	 * \else
+	 * 打包补间在动作管理器缓冲区中的索引, 如果动作没有被打包则为-1
+	 * \endif
+	 */
+	int m_tweenIndex;
+
 protected:
 	wyAction();
 
+	/**
+	 * \if English
+	 * Check whether action has any callback, action with callback can't be packed
+	 * because callback must be invoked in every update
+	 * \else
+	 * 检查动作是否设置了回调, 有回调的动作不能被打包, 因为每次update都需要调用回调
+	 * \endif
+	 */
+	bool hasCallback();
+
 	/**
 	 * \if English
 	 * Invoke start callback
@@ -313,6 +342,28 @@ public:
 	 */
 	virtual bool isDone();
 
+	/**
+	 * \if English
+	 * Pack this action into a tween record, it is called by \link wyActionManager wyActionManager\endlink
+	 * after action is started. If returns true, action manager updates the record in a batched loop
+	 * and \c step and \c update won't be called any more. Default implementation returns false.
+	 *
+	 * Subclass which overrides \c update of a packable action must override this method and return false.
+	 *
+	 * @param tween record to be filled, it is zeroed by caller
+	 * @return true means action is packed
+	 * \else
+	 * 把动作打包成一个补间记录, 由\link wyActionManager wyActionManager\endlink 在动作开始后调用. 如果返回
+	 * true, 动作管理器会在批量循环中更新这个记录, 不再调用\c step 和\c update. 缺省实现返回false.
+	 *
+	 * 如果子类覆盖了一个可打包动作的\c update 方法, 那么必须覆盖这个方法并返回false.
+	 *
+	 * @param tween 要填充的记录, 调用者已经把它清零
+	 * @return true表示动作已被打包
+	 * \endif
+	 */
+	virtual bool packTween(wyTween* tween);
+
 	/**
 	 * \if English
 	 * Set callback
@@ -456,6 +507,19 @@ public:
 	 * \endif
 	 */
 	bool isPaused() { return m_paused; }
+
+	/**
+	 * \if English
+	 * Is action updated by packed tween buffer of action manager?
+	 *
+	 * @return true means action is packed
+	 * \else
+	 * 动作是否由动作管理器的打包补间缓冲区更新
+	 *
+	 * @return true表示动作已被打包
+	 * \endif
+	 */
+	bool isPacked() { return m_tweenIndex != -1; }
 };
 
 #endif // __wyAction_h__
@@ -112,6 +112,9 @@ public:
 	/// @see wyAction::update
 	virtual void update(float t);
 
+	/// @see wyAction::packTween
+	virtual bool packTween(wyTween* tween);
+
 	/// @see wyAction::start
 	virtual void start(wyNode* target);
 };
@@ -131,6 +131,9 @@ public:
 
 	/// @see wyAction::update
 	virtual void update(float t);
+
+	/// @see wyAction::packTween
+	virtual bool packTween(wyTween* tween);
 };
 
 #endif // __wyFadeTo_h__
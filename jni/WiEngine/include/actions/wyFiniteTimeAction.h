@@ -41,6 +41,7 @@
  * \endif
  */
 class WIENGINE_API wyFiniteTimeAction : public wyAction {
+	friend class wyActionManager;
 	friend class wyRepeat;
 	friend class wyRepeatForever;
 
@@ -80,6 +81,9 @@ protected:
 	 */
 	wyFiniteTimeAction(float duration);
 
+	/// get elapsed time from tween buffer of action manager when action is packed
+	float getPackedElapsed();
+
 public:
 	virtual ~wyFiniteTimeAction();
 
@@ -123,7 +127,7 @@ public:
 	 * @return 动作已经持续的时间
 	 * \endif
 	 */
-	float getElapsed() { return m_elapsed; }
+	float getElapsed() { return m_tweenIndex == -1 ? m_elapsed : getPackedElapsed(); }
 
 	/**
 	 * \if English
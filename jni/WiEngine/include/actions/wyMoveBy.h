@@ -144,6 +144,9 @@ public:
 	/// @see wyAction::update
 	virtual void update(float t);
 
+	/// @see wyAction::packTween
+	virtual bool packTween(wyTween* tween);
+
 	/**
 	 * \if English
 	 * set pin point
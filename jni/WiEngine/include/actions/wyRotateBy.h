@@ -98,6 +98,9 @@ public:
 
 	/// @see wyAction::update
 	virtual void update(float t);
+
+	/// @see wyAction::packTween
+	virtual bool packTween(wyTween* tween);
 };
 
 #endif // __wyRotateBy_h__
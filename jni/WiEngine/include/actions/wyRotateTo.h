@@ -108,6 +108,9 @@ public:
 
 	/// @see wyAction::update
 	virtual void update(float t);
+
+	/// @see wyAction::packTween
+	virtual bool packTween(wyTween* tween);
 };
 
 #endif // __wyRotateTo_h__
@@ -179,6 +179,9 @@ public:
 
 	/// @see wyAction::update
 	virtual void update(float t);
+
+	/// @see wyAction::packTween
+	virtual bool packTween(wyTween* tween);
 };
 
 #endif // __wyScaleBy_h__
@@ -186,6 +186,9 @@ public:
 
 	/// @see wyAction::update
 	virtual void update(float t);
+
+	/// @see wyAction::packTween
+	virtual bool packTween(wyTween* tween);
 };
 
 #endif // __wyScaleTo_h__
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: luma(stubma@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __wyTween_h__
+#define __wyTween_h__
+
+#include <stdbool.h>
+
+class wyNode;
+class wyAction;
+class wyFiniteTimeAction;
+
+/**
+ * \if English
+ * Channel of a packed tween, it decides which property of node is written
+ * \else
+ * 打包补间的通道, 决定写入节点的哪个属性
+ * \endif
+ */
+enum wyTweenChannel {
+	/// position, from and delta are x and y
+	WY_TWEEN_POSITION,
+
+	/// scale, from and delta are scale x and scale y
+	WY_TWEEN_SCALE,
+
+	/// rotation, from and delta are angle
+	WY_TWEEN_ROTATION,
+
+	/// alpha, from and delta are alpha
+	WY_TWEEN_ALPHA,
+
+	/// color, from and delta are r, g and b
+	WY_TWEEN_COLOR,
+
+	/// count of channels
+	WY_TWEEN_CHANNEL_COUNT
+};
+
+/**
+ * \if English
+ * Ease function of a packed tween
+ *
+ * @param t linear time, from 0 to 1
+ * @param rate rate of ease action, it is ignored if ease action has no rate
+ * @return eased time
+ * \else
+ * 打包补间的缓冲函数
+ *
+ * @param t 线性时间, 从0到1
+ * @param rate 缓冲动作的rate参数, 如果缓冲动作没有rate则忽略
+ * @return 缓冲后的时间
+ * \endif
+ */
+typedef float (*wyTweenEaseFunc)(float t, float rate);
+
+/**
+ * @struct wyTween
+ *
+ * \if English
+ * Packed record of a simple interval action. \link wyActionManager wyActionManager\endlink
+ * stores records of same channel in a contiguous buffer and updates them in one loop, so
+ * common move, scale, rotate, fade and tint actions don't go through virtual step and update
+ * calls every frame. An action fills a record in \link wyAction::packTween packTween\endlink
+ * after it is started.
+ * \else
+ * 简单间隔动作的打包记录. \link wyActionManager wyActionManager\endlink 把同一通道的记录保存在连续的
+ * 缓冲区中, 并在一个循环中更新它们, 因此常用的移动, 缩放, 旋转, 渐变和变色动作每帧不再需要经过虚函数step
+ * 和update. 动作在开始后通过\link wyAction::packTween packTween\endlink 填充记录.
+ * \endif
+ */
+struct wyTween {
+	/// owner action, it is not retained
+	wyFiniteTimeAction* action;
+
+	/// target node, it is retained by action
+	wyNode* target;
+
+	/// channel
+	wyTweenChannel channel;
+
+	/// ease function, NULL means linear
+	wyTweenEaseFunc ease;
+
+	/// rate of ease function
+	float rate;
+
+	/// elapsed time
+	float elapsed;
+
+	/// duration
+	float duration;
+
+	/// start value
+	float from[3];
+
+	/// value change in whole duration
+	float delta[3];
+
+	/// true means first step is not performed
+	bool firstTick;
+
+	/// true means action is paused
+	bool paused;
+
+	/// true means tween reaches its end
+	bool done;
+
+	/// true means action is unpacked while buffer is being updated, record will be removed later
+	bool dead;
+};
+
+#endif // __wyTween_h__
@@ -32,6 +32,8 @@
 #include "wyObject.h"
 #include "wyAFCClip.h"
 
+class wyAFCAnimation;
+
 /**
  * @class wyAFCFileData
  *
@@ -62,11 +64,62 @@ public:
 	 */
 	float m_resScale;
 
+private:
+	/**
+	 * \if English
+	 * Animations created without clip mapping, indexed by animation index. They are
+	 * shared by all sprites using this file data so frame geometry is baked only once
+	 * \else
+	 * 没有分片映射的动画对象缓冲, 以动画索引为下标. 它们被所有使用这个文件数据的精灵共享,
+	 * 因此帧的几何数据只需要计算一次
+	 * \endif
+	 */
+	wyAFCAnimation** m_animationCache;
+
+	/**
+	 * \if English
+	 * Size of animation cache
+	 * \else
+	 * 动画缓冲的大小
+	 * \endif
+	 */
+	int m_animationCacheSize;
+
 protected:
 	wyAFCFileData();
 
 public:
 	virtual ~wyAFCFileData();
+
+	/**
+	 * \if English
+	 * Get cached animation
+	 *
+	 * @param index animation index
+	 * @return cached \link wyAFCAnimation wyAFCAnimation\endlink, or NULL if not cached
+	 * \else
+	 * 得到缓冲的动画对象
+	 *
+	 * @param index 动画索引
+	 * @return 缓冲的\link wyAFCAnimation wyAFCAnimation\endlink, 如果没有缓冲则返回NULL
+	 * \endif
+	 */
+	wyAFCAnimation* getCachedAnimation(int index);
+
+	/**
+	 * \if English
+	 * Cache an animation, it is retained by file data
+	 *
+	 * @param index animation index
+	 * @param anim \link wyAFCAnimation wyAFCAnimation\endlink created without clip mapping
+	 * \else
+	 * 缓冲一个动画对象, 它会被文件数据持有
+	 *
+	 * @param index 动画索引
+	 * @param anim 没有使用分片映射创建的\link wyAFCAnimation wyAFCAnimation\endlink
+	 * \endif
+	 */
+	void cacheAnimation(int index, wyAFCAnimation* anim);
 };
 
 #endif // __wyAFCFileData_h__
@@ -33,6 +33,47 @@
 #include "wyArray.h"
 #include "wyTypes.h"
 #include "wyAFCClip.h"
+#include "wyTexture2D.h"
+#include "wyTextureAtlas.h"
+
+/**
+ * @struct wyAFCBakedClip
+ *
+ * \if English
+ * Texture source of a baked quad of \link wyAFCFrame wyAFCFrame\endlink
+ * \else
+ * \link wyAFCFrame wyAFCFrame\endlink 中预先计算好的矩形的贴图来源
+ * \endif
+ */
+typedef struct WIENGINE_API wyAFCBakedClip {
+	/**
+	 * \if English
+	 * Sheet of clip, if NULL, sheet at \c imageIndex of sprite is used
+	 * \else
+	 * 分片的图片集, 如果是NULL, 则使用精灵中\c imageIndex 位置的图片集
+	 * \endif
+	 */
+	wySpriteBatchNode* sheet;
+
+	/**
+	 * \if English
+	 * Image index of clip
+	 * \else
+	 * 分片的图片索引
+	 * \endif
+	 */
+	int imageIndex;
+
+	/**
+	 * \if English
+	 * Pixel size of the texture which texture coordinates are calculated with. If sprite uses
+	 * a texture of different size, texture coordinates should be scaled
+	 * \else
+	 * 计算贴图坐标时使用的贴图像素大小. 如果精灵使用的贴图大小不同, 则贴图坐标需要缩放
+	 * \endif
+	 */
+	float texWidth, texHeight;
+} wyAFCBakedClip;
 
 /**
  * @class wyAFCFrame
@@ -101,9 +142,56 @@ private:
      */
     bool m_flipY;
 
+	/**
+	 * \if English
+	 * Baked quads of image clips, four vertices for every clip. There are four arrays
+	 * for four combinations of x and y flip, they are created when first used
+	 * \else
+	 * 预先计算好的图片分片矩形, 每个分片4个顶点. 有4个数组分别对应x和y翻转的4种组合, 它们在
+	 * 第一次使用时创建
+	 * \endif
+	 */
+	wyAtlasVertex* m_bakedQuads[4];
+
+	/**
+	 * \if English
+	 * Texture source of baked quads
+	 * \else
+	 * 预先计算好的矩形的贴图来源
+	 * \endif
+	 */
+	wyAFCBakedClip* m_bakedClips;
+
+	/**
+	 * \if English
+	 * Count of baked quads, it is image clip count
+	 * \else
+	 * 预先计算好的矩形个数, 也就是图片分片个数
+	 * \endif
+	 */
+	int m_bakedCount;
+
 private:
 	static bool releaseClip(wyArray* arr, void* ptr, int index, void* data);
 
+	/**
+	 * \if English
+	 * Bake image clips to quads for a flip state
+	 * \else
+	 * 把图片分片计算成某种翻转状态下的矩形
+	 * \endif
+	 */
+	wyAtlasVertex* bake(bool flipX, bool flipY, wyArray* sheetList);
+
+	/**
+	 * \if English
+	 * Release baked quads, called when clips are changed
+	 * \else
+	 * 释放预先计算好的矩形, 在分片改变时调用
+	 * \endif
+	 */
+	void releaseBakedQuads();
+
 protected:
 	wyAFCFrame();
 
@@ -152,6 +240,53 @@ public:
 	 */
 	void addClip(wyAFCClip* clip);
 
+	/**
+	 * \if English
+	 * Get quads of all image clips, relative to sprite node and without frame offset. Quads are
+	 * calculated only once for every flip state and shared by all sprites which use this frame, so
+	 * sprite only needs to copy them when frame is changed.
+	 *
+	 * @param flipX true means frame is flipped in x axis, it is final flag which combines flag of
+	 * 		sprite and frame
+	 * @param flipY true means frame is flipped in y axis
+	 * @param sheetList \link wySpriteBatchNode wySpriteBatchNode\endlink list of sprite, texture
+	 * 		coordinates are calculated with textures in it when quads are baked first time
+	 * @return quads, four vertices for every image clip. count is \c getBakedQuadCount
+	 * \else
+	 * 得到所有图片分片的矩形, 坐标相对于精灵节点, 不包含帧偏移. 每种翻转状态的矩形只计算一次, 并被所有
+	 * 使用这一帧的精灵共享, 因此切换帧时精灵只需要拷贝它们.
+	 *
+	 * @param flipX true表示帧在x轴上翻转, 它是精灵和帧的翻转标志合并之后的结果
+	 * @param flipY true表示帧在y轴上翻转
+	 * @param sheetList 精灵的\link wySpriteBatchNode wySpriteBatchNode\endlink 列表, 第一次计算矩形时用
+	 * 		其中的贴图计算贴图坐标
+	 * @return 矩形数组, 每个图片分片4个顶点, 个数是\c getBakedQuadCount
+	 * \endif
+	 */
+	wyAtlasVertex* getBakedQuads(bool flipX, bool flipY, wyArray* sheetList);
+
+	/**
+	 * \if English
+	 * Get texture source of baked quads, it is valid after \c getBakedQuads is called
+	 *
+	 * @return \link wyAFCBakedClip wyAFCBakedClip\endlink array
+	 * \else
+	 * 得到预先计算好的矩形的贴图来源, 在调用\c getBakedQuads 之后有效
+	 *
+	 * @return \link wyAFCBakedClip wyAFCBakedClip\endlink 数组
+	 * \endif
+	 */
+	wyAFCBakedClip* getBakedClips() { return m_bakedClips; }
+
+	/**
+	 * \if English
+	 * Get count of baked quads, it is valid after \c getBakedQuads is called
+	 * \else
+	 * 得到预先计算好的矩形个数, 在调用\c getBakedQuads 之后有效
+	 * \endif
+	 */
+	int getBakedQuadCount() { return m_bakedCount; }
+
 	/**
 	 * \if English
 	 * Get clip at specified index
@@ -147,12 +147,40 @@ class WIENGINE_API wyAFCSprite : public wyNode {
 protected:
 	/**
 	 * \if English
-	 * \link wySpriteEx wySpriteEx\endlink list for every clip
+	 * Quads of current frame, they are copied from baked quads of \link wyAFCFrame wyAFCFrame\endlink
+	 * when frame is changed
 	 * \else
-	 * 给分片使用的\link wySpriteEx wySpriteEx\endlink列表
+	 * 当前帧的矩形, 在切换帧时从\link wyAFCFrame wyAFCFrame\endlink 预先计算好的矩形中拷贝过来
 	 * \endif
 	 */
-	wyArray* m_spriteList;
+	wyTextureAtlas* m_atlas;
+
+	/**
+	 * \if English
+	 * Sheet of every quad in current frame, adjacent quads with same sheet are drawn together
+	 * \else
+	 * 当前帧中每个矩形对应的图片集, 相邻的使用相同图片集的矩形一起绘制
+	 * \endif
+	 */
+	wySpriteBatchNode** m_quadSheets;
+
+	/**
+	 * \if English
+	 * Capacity of \c m_quadSheets
+	 * \else
+	 * \c m_quadSheets 的容量
+	 * \endif
+	 */
+	int m_quadSheetCapacity;
+
+	/**
+	 * \if English
+	 * Offset of quads in current frame, it is the frame offset after flipped
+	 * \else
+	 * 当前帧矩形的偏移, 也就是翻转后的帧偏移
+	 * \endif
+	 */
+	wyPoint m_quadOffset;
 
 	/**
 	 * \if English
@@ -392,6 +420,9 @@ private:
 	void invokeOnAFCAnimationFrameChanged();
 	void invokeOnAFCAnimationEnded();
 
+	/// draw quads which use same sheet
+	void drawQuads(int start, int count, wySpriteBatchNode* sheet);
+
 protected:
 	wyAFCSprite();
 
@@ -408,15 +439,6 @@ protected:
 	 */
 	void setAnimationData(wyAFCAnimation* data);
 
-	/**
-	 * \if English
-	 * Create sprite pool for current animation
-	 * \else
-	 * 根据当前动画数据创建必要的\link wySpriteEx wySpriteEx\endlink 对象
-	 * \endif
-	 */
-	void initSpriteFromAnimationData();
-
 	/**
 	 * \if English
 	 * Initialize frame offset at start of animation
@@ -439,15 +461,6 @@ protected:
 	 */
 	void adjustFrameOffset(wyAFCFrame* frameData);
 
-	/**
-	 * \if English
-	 * update color of sprites
-	 * \else
-	 * 批量更新颜色
-	 * \endif
-	 */
-	void updateColor();
-
 public:
 	virtual ~wyAFCSprite();
 
@@ -48,14 +48,56 @@ private:
 	/// A* 地图状况封装
 	wyAStarMap* m_mapdata;
 
+	/// 路径, 保存\link wyAStarStep wyAStarStep\endlink对象, 终点在最前面, 不包含起点
 	wyArray* m_steps;
 
-	wyAStarStep* nodeInArray(wyArray* arr, int x, int y);
+	/// 复用的\link wyAStarStep wyAStarStep\endlink对象, 搜索时不再创建对象
+	wyArray* m_stepPool;
 
-	wyAStarStep* findLowestCostNode(wyArray* arr);
+	/// tile数量, 下面的数组都以tile索引为下标
+	int m_tileCount;
+
+	/// 每个tile的g值
+	float* m_g;
+
+	/// 每个tile的f值
+	float* m_f;
+
+	/// 每个tile的父tile索引, -1表示起点
+	int* m_parent;
+
+	/// 每个tile在开放列表堆中的位置, -1表示已经关闭
+	int* m_heapIndex;
+
+	/// 每个tile最后一次被访问时的搜索代数, 和当前代数不同表示本次搜索还没有访问, 因此两次搜索之间不需要清空状态
+	unsigned int* m_generation;
+
+	/// 当前搜索代数
+	unsigned int m_currentGeneration;
+
+	/// 开放列表, 按f值排序的二叉堆, 保存tile索引
+	int* m_heap;
+
+	/// 开放列表中的tile数量
+	int m_heapSize;
 
 	static bool releaseNode(wyArray* arr, void* ptr, int index, void* data);
 
+	/// 把tile放入开放列表
+	void heapPush(int tile);
+
+	/// 取出开放列表中f值最小的tile, 并标记为关闭
+	int heapPop();
+
+	/// 堆中某位置的f值变小后上移
+	void heapUp(int pos);
+
+	/// 堆中某位置的f值变大后下移
+	void heapDown(int pos);
+
+	/// 根据父tile索引生成路径, 返回路径步骤数
+	int buildPath(int start, int end);
+
 public:
 	/**
 	 * 构造函数
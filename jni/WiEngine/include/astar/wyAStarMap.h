@@ -43,10 +43,38 @@ class WIENGINE_API wyAStarMap : public wyObject {
 private:
 	static bool releaseTile(wyArray* arr, void* ptr, int index, void* data);
 
+	/// 增加版本并记录改变的tile索引
+	void recordChange(int index);
+
 protected:
 	/// 保存所有tile对象的\link wyArray wyArray\endlink对象指针,封装\link wyAStarTile wyAStarTile\endlink
 	wyArray* m_tiles;
 
+	/// 地图版本, tile阻挡状态改变时增加
+	int m_version;
+
+	/// 代价版本, 调用\link wyAStarMap::invalidate invalidate\endlink时增加
+	int m_costVersion;
+
+	/// 最近的阻挡状态改变, 以版本号对容量取模为下标, 保存改变的tile索引, -1表示不是单个tile的改变
+	int* m_changes;
+
+protected:
+	/**
+	 * 返回tile在tile数组中的索引, 缺省实现是线性查找, 子类如果知道tile的排列方式应该重载此方法.
+	 * 调用时坐标已经验证有效
+	 *
+	 * @param x tile　x值
+	 * @param y tile　y值
+	 * @return tile索引, -1表示没有找到
+	 */
+	virtual int getTileIndex(int x, int y);
+
+	/**
+	 * 设置所有tile的索引, 子类在创建完tile之后调用
+	 */
+	void indexTiles();
+
 public:
 	/**
 	 * 构造函数
@@ -90,6 +118,37 @@ public:
 	 */
 	bool isBlockedAt(int x, int y);
 
+	/**
+	 * 返回地图版本, 每次\link wyAStarMap::blockTile blockTile\endlink, \link wyAStarMap::freeTile freeTile\endlink
+	 * 或\link wyAStarMap::invalidate invalidate\endlink都会使版本增加. \link wyPathService wyPathService\endlink
+	 * 根据版本判断是否需要重新生成地图快照
+	 *
+	 * @return 地图版本
+	 */
+	int getVersion() { return m_version; }
+
+	/**
+	 * 返回代价版本, 只有\link wyAStarMap::invalidate invalidate\endlink会使它增加
+	 *
+	 * @return 代价版本
+	 */
+	int getCostVersion() { return m_costVersion; }
+
+	/**
+	 * 返回使地图变为指定版本的那次改变涉及的tile索引, 只保存最近的若干次改变. 快照可以据此只更新
+	 * 改变的tile, 而不用重新读取整个地图
+	 *
+	 * @param version 地图版本
+	 * @return tile索引, -1表示那次改变不是单个tile的改变或者已经没有记录
+	 */
+	int getChangedTile(int version);
+
+	/**
+	 * 如果直接修改了\link wyAStarTile wyAStarTile\endlink的类型或者g值比率, 需要调用此方法通知
+	 * \link wyPathService wyPathService\endlink重新读取地图
+	 */
+	void invalidate();
+
 	/**
 	 * 返回\link wyAStarTile wyAStarTile\endlink对象指针
 	 *
@@ -99,6 +158,14 @@ public:
 	 */
 	wyAStarTile* getTileAt(int x, int y);
 
+	/**
+	 * 根据索引返回\link wyAStarTile wyAStarTile\endlink对象指针
+	 *
+	 * @param index tile索引
+	 * @return　\link wyAStarTile wyAStarTile\endlink对象指针
+	 */
+	wyAStarTile* getTileByIndex(int index) { return (wyAStarTile*)wyArrayGet(m_tiles, index); }
+
 	/**
 	 * 验证tile是否有效,子类需要实现
 	 *
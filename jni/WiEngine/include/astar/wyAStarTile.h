@@ -57,6 +57,9 @@ private:
 	/// 子节点\link wyArray wyArray\endlink对象指针, 封装\link wyAStarTile wyAStarTile\endlink对象指针
 	wyArray* m_childs;
 
+	/// tile在地图tile数组中的索引, \link wyAStar wyAStar\endlink用它索引搜索状态
+	int m_index;
+
 public:
 	/**
 	 * 构造函数
@@ -128,6 +131,20 @@ public:
 	 */
 	bool isFree() { return m_type == TILE_FREE; }
 
+	/**
+	 * 返回tile在地图tile数组中的索引
+	 *
+	 * @return tile索引
+	 */
+	int getIndex() { return m_index; }
+
+	/**
+	 * 设置tile在地图tile数组中的索引, 由地图调用
+	 *
+	 * @param index tile索引
+	 */
+	void setIndex(int index) { m_index = index; }
+
 	/**
 	 * 增加子节点\link wyAStarTile wyAStarTile\endlink对象指针
 	 *
@@ -45,6 +45,10 @@ private:
 	/// 纵向tile数量
 	int m_height;
 
+protected:
+	/// @see wyAStarMap::getTileIndex
+	virtual int getTileIndex(int x, int y);
+
 public:
 	/**
 	 * 构造函数
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: mike(mike.weib@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __wyPathFinder_h__
+#define __wyPathFinder_h__
+
+#include "wyGlobal.h"
+
+class wyPathSnapshot;
+class wyPathHierarchy;
+
+/**
+ * @typedef wyPathAlgorithm
+ *
+ * 路径搜索算法
+ */
+typedef enum {
+	/// 自动选择, 允许斜线的均匀代价网格使用跳点搜索, 其它地图使用A*
+	WY_PATH_ALGORITHM_AUTO,
+
+	/// 普通A*, 适用于所有地图
+	WY_PATH_ALGORITHM_ASTAR,
+
+	/// 跳点搜索(JPS), 只用于均匀代价的网格, 其它地图使用A*. 结果和A*一样是最短路径
+	WY_PATH_ALGORITHM_JPS,
+
+	/**
+	 * 分层搜索(HPA*), 只用于均匀代价的网格, 其它地图使用A*. 网格被划分成多个区块, 先在区块入口组成的
+	 * 抽象图上搜索, 再在区块内细化. 抽象图被缓存并且只在区块阻挡状态改变时局部更新, 因此适合大地图上的
+	 * 长路径, 但是结果可能比最短路径稍长. 如果抽象图上找不到路径, 会退回到跳点搜索
+	 */
+	WY_PATH_ALGORITHM_HIERARCHICAL
+} wyPathAlgorithm;
+
+/**
+ * @class wyPathFinder
+ *
+ * 在\link wyPathSnapshot wyPathSnapshot\endlink上搜索路径的上下文, 保存搜索需要的全部临时状态, 多次搜索之间
+ * 复用, 搜索时不分配内存. 一个对象同一时间只能在一个线程中使用, \link wyPathService wyPathService\endlink
+ * 的每个工作线程各有一个.
+ */
+class WIENGINE_API wyPathFinder {
+	friend class wyPathHierarchy;
+
+private:
+	/// 搜索状态, 数组以tile索引或者区块内的局部索引为下标
+	struct wyPathState {
+		/// 数组容量
+		int capacity;
+
+		/// g值
+		float* g;
+
+		/// f值
+		float* f;
+
+		/// 父节点索引, -1表示起点
+		int* parent;
+
+		/// 在堆中的位置, -1表示已经关闭
+		int* heapIndex;
+
+		/// 最后一次访问时的搜索代数
+		unsigned int* generation;
+
+		/// 当前搜索代数
+		unsigned int currentGeneration;
+
+		/// 开放列表, 按f值排序的二叉堆
+		int* heap;
+
+		/// 开放列表大小
+		int heapSize;
+	};
+
+	/// 整个地图的搜索状态
+	wyPathState m_global;
+
+	/// 区块内的搜索状态, 分层搜索使用
+	wyPathState m_local;
+
+	/// 起点到起点所在区块内每个tile的代价
+	float* m_startDist;
+
+	/// 终点到终点所在区块内每个tile的代价
+	float* m_goalDist;
+
+	/// 区块代价数组的容量
+	int m_distCapacity;
+
+	/// 分层搜索得到的抽象路径
+	int* m_chain;
+
+	/// 抽象路径数组的容量
+	int m_chainCapacity;
+
+	/// 结果路径, tile索引, 从起点到终点
+	int* m_path;
+
+	/// 结果路径长度
+	int m_length;
+
+	/// 结果路径数组的容量
+	int m_pathCapacity;
+
+	/// 结果路径代价
+	float m_cost;
+
+	/// 实际使用的算法
+	wyPathAlgorithm m_algorithm;
+
+	/// 当前搜索的快照
+	wyPathSnapshot* m_snapshot;
+
+	/// 网格宽度
+	int m_width;
+
+	/// 网格高度
+	int m_height;
+
+	/// 阻挡状态
+	unsigned char* m_blocked;
+
+	/// 可以通过的阻挡tile索引, 没有则为-1
+	int m_pass;
+
+	/// 终点索引
+	int m_end;
+
+	/// 终点x坐标
+	int m_endX;
+
+	/// 终点y坐标
+	int m_endY;
+
+private:
+	static void initState(wyPathState& st);
+	static void destroyState(wyPathState& st);
+
+	/// 开始一次新搜索, 必要时扩大数组
+	static void beginState(wyPathState& st, int capacity);
+
+	static void heapUp(wyPathState& st, int pos);
+	static void heapDown(wyPathState& st, int pos);
+	static int heapPop(wyPathState& st);
+
+	/// 用新的g值更新节点, 第一次访问则加入开放列表
+	static void relax(wyPathState& st, int n, float g, float h, int parent);
+
+	/// 确保结果数组可以保存指定长度
+	void ensurePath(int length);
+
+	/// 网格上的tile是否可以通过
+	bool walkable(int x, int y) {
+		if(x < 0 || x >= m_width || y < 0 || y >= m_height)
+			return false;
+		int index = x * m_height + y;
+		return !m_blocked[index] || index == m_pass;
+	}
+
+	/// 网格上的估价, 以直线一步为1
+	float gridHeuristic(int x, int y);
+
+	/// 设置网格搜索用到的成员
+	void beginGrid(wyPathSnapshot* s, int end, int pass);
+
+	/// 普通A*
+	bool searchGraph(wyPathSnapshot* s, int start, int end, int pass);
+
+	/// 跳点搜索
+	bool searchJump(wyPathSnapshot* s, int start, int end, int pass);
+
+	/// 允许斜线的网格上从某点沿一个方向跳跃, 返回跳点索引, -1表示没有
+	int jump8(int x, int y, int dx, int dy);
+
+	/// 不允许斜线的网格上从某点沿一个方向跳跃, 返回跳点索引, -1表示没有
+	int jump4(int x, int y, int dx, int dy);
+
+	/// 分层搜索, 调用前已经锁定并更新了抽象图
+	bool searchHierarchy(wyPathSnapshot* s, wyPathHierarchy* h, int start, int end, int pass);
+
+	/**
+	 * 在网格的一个矩形区域内计算source到每个tile的代价, 结果保存在out中, 下标为区域内的局部索引,
+	 * 不可到达的tile为无穷大. 调用前需要调用beginGrid
+	 */
+	void localDijkstra(int x0, int y0, int w, int h, int source, float* out);
+
+	/// 在网格的一个矩形区域内搜索from到to的路径, 追加到结果路径中, 不包含from
+	bool localSearch(int x0, int y0, int w, int h, int from, int to);
+
+	/// 如果from到to之间先斜线再直线的路径可以通过, 则追加到结果路径中, 这样的路径一定是最短的
+	bool appendLine(int from, int to);
+
+	/// 根据父节点把global状态中的跳点路径展开为连续的tile
+	void buildJumpPath(int start, int end);
+
+	/// 根据父节点把global状态中的路径保存为结果
+	void buildPath(int start, int end);
+
+public:
+	wyPathFinder();
+	~wyPathFinder();
+
+	/**
+	 * 搜索路径
+	 *
+	 * @param s 地图快照
+	 * @param h 分层搜索的抽象图, 可以为NULL, 为NULL时不使用分层搜索
+	 * @param start 起点tile索引
+	 * @param end 终点tile索引
+	 * @param ignoreBlock true表示终点即使是阻挡的也可以到达
+	 * @param algorithm 搜索算法
+	 * @param wait true表示等待其它线程释放抽象图, false表示抽象图正被其它线程使用时改用普通A*搜索
+	 * @return true表示找到路径
+	 */
+	bool findPath(wyPathSnapshot* s, wyPathHierarchy* h, int start, int end, bool ignoreBlock, wyPathAlgorithm algorithm, bool wait = true);
+
+	/**
+	 * 返回最后一次找到的路径, 保存tile索引, 从起点到终点, 包含起点和终点
+	 *
+	 * @return tile索引数组
+	 */
+	int* getPath() { return m_path; }
+
+	/**
+	 * 返回最后一次找到的路径长度
+	 *
+	 * @return 路径包含的tile数量
+	 */
+	int getLength() { return m_length; }
+
+	/**
+	 * 返回最后一次找到的路径的代价
+	 *
+	 * @return 路径代价
+	 */
+	float getCost() { return m_cost; }
+
+	/**
+	 * 返回最后一次搜索实际使用的算法
+	 *
+	 * @return \link wyPathAlgorithm wyPathAlgorithm\endlink
+	 */
+	wyPathAlgorithm getAlgorithm() { return m_algorithm; }
+};
+
+#endif // __wyPathFinder_h__
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: mike(mike.weib@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __wyPathHierarchy_h__
+#define __wyPathHierarchy_h__
+
+#include "wyGlobal.h"
+#include <pthread.h>
+
+class wyPathSnapshot;
+class wyPathFinder;
+
+/**
+ * @class wyPathHierarchy
+ *
+ * 分层搜索(HPA*)使用的抽象图. 网格被划分成边长固定的区块, 相邻区块边界上连续可通过的一段形成一个入口,
+ * 入口两侧的tile是抽象图的节点. 同一区块内节点之间的代价通过区块内的搜索预先算好, 相邻区块的节点之间
+ * 直接相连.
+ *
+ * 抽象图属于一个地图, 被多个工作线程共享, 使用前需要锁定. 当搜索使用的快照比抽象图新时, 只重新计算阻挡
+ * 状态有变化的区块, 以及变化的tile位于边界时边界另一侧的区块.
+ */
+class WIENGINE_API wyPathHierarchy {
+	friend class wyPathFinder;
+
+private:
+	/// 区块
+	struct wyPathCluster {
+		/// 区块左下角x坐标
+		int x;
+
+		/// 区块左下角y坐标
+		int y;
+
+		/// 区块宽度
+		int width;
+
+		/// 区块高度
+		int height;
+
+		/// 节点数量
+		int nodeCount;
+
+		/// 节点tile索引, 容量为区块周长
+		int* nodes;
+
+		/// 节点之间的代价, nodeCount * nodeCount, 不可到达为无穷大
+		float* dist;
+
+		/// true表示需要重新计算
+		bool dirty;
+	};
+
+	/// 引用计数
+	volatile int m_refCount;
+
+	/// 锁
+	pthread_mutex_t m_mutex;
+
+	/// 区块边长
+	int m_clusterSize;
+
+	/// 横向区块数
+	int m_clustersX;
+
+	/// 纵向区块数
+	int m_clustersY;
+
+	/// 区块数组, 下标为区块x * 纵向区块数 + 区块y
+	wyPathCluster* m_clusters;
+
+	/// 每个tile在所属区块节点中的位置, -1表示不是节点
+	int* m_nodeSlot;
+
+	/// 抽象图对应的快照
+	wyPathSnapshot* m_snapshot;
+
+	/// 计算区块内代价时使用的临时数组, 大小为区块面积
+	float* m_scratch;
+
+private:
+	wyPathHierarchy(int clusterSize);
+	~wyPathHierarchy();
+
+	/// 释放所有区块
+	void destroyClusters();
+
+	/// 根据快照重新创建所有区块
+	void createClusters(wyPathSnapshot* s);
+
+	/// 标记包含某tile的区块需要更新, 如果tile在边界上, 边界另一侧的区块也需要更新
+	void markDirty(int x, int y);
+
+	/**
+	 * 添加一条边界上的入口节点, 只添加属于本区块的一侧. 边界两侧的区块以相同的顺序扫描同一条边界,
+	 * 因此得到的入口位置是一致的
+	 */
+	void addBorderNodes(wyPathCluster* c, int ax, int ay, int bx, int by, int dx, int dy, int length);
+
+	/// 重新计算区块的节点
+	void rebuildNodes(wyPathCluster* c);
+
+	/// 重新计算区块内节点之间的代价
+	void rebuildDist(wyPathCluster* c, wyPathFinder* finder);
+
+	/// 返回包含tile的区块
+	wyPathCluster* getCluster(int x, int y) {
+		return m_clusters + (x / m_clusterSize) * m_clustersY + y / m_clusterSize;
+	}
+
+public:
+	/**
+	 * 创建抽象图, 在第一次更新时才会真正计算
+	 *
+	 * @param clusterSize 区块边长
+	 * @return 抽象图, 引用计数为1
+	 */
+	static wyPathHierarchy* make(int clusterSize);
+
+	/**
+	 * 增加引用计数, 可以在任何线程中调用
+	 */
+	void retain();
+
+	/**
+	 * 减少引用计数, 为0时释放, 可以在任何线程中调用
+	 */
+	void release();
+
+	/**
+	 * 锁定抽象图, 更新和搜索之前必须锁定
+	 */
+	void lock() { pthread_mutex_lock(&m_mutex); }
+
+	/**
+	 * 尝试锁定抽象图, 不等待
+	 *
+	 * @return true表示已经锁定, false表示其它线程正在使用抽象图
+	 */
+	bool tryLock() { return pthread_mutex_trylock(&m_mutex) == 0; }
+
+	/**
+	 * 解锁抽象图
+	 */
+	void unlock() { pthread_mutex_unlock(&m_mutex); }
+
+	/**
+	 * 把抽象图更新到指定的快照, 调用前必须锁定
+	 *
+	 * @param s 网格快照
+	 * @param finder 用来计算区块内代价的\link wyPathFinder wyPathFinder\endlink
+	 * @return false表示快照比抽象图旧, 无法使用抽象图
+	 */
+	bool update(wyPathSnapshot* s, wyPathFinder* finder);
+
+	/**
+	 * 返回区块边长
+	 *
+	 * @return 区块边长
+	 */
+	int getClusterSize() { return m_clusterSize; }
+};
+
+#endif // __wyPathHierarchy_h__
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: mike(mike.weib@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __wyPathService_h__
+#define __wyPathService_h__
+
+#include "wyObject.h"
+#include "wyGlobal.h"
+#include "wyPathFinder.h"
+#include "wyLockFreeQueue.h"
+#include <pthread.h>
+
+class wyAStarMap;
+class wyPathSnapshot;
+class wyPathHierarchy;
+class wyTargetSelector;
+
+/**
+ * @typedef wyPathResult
+ *
+ * \link wyPathService wyPathService\endlink找到的路径
+ */
+typedef struct WIENGINE_API wyPathResult {
+	/// 请求id, 同步搜索为0
+	int id;
+
+	/// 实际使用的算法
+	wyPathAlgorithm algorithm;
+
+	/// 路径包含的tile数量, 包含起点和终点
+	int length;
+
+	/// tile坐标, 依次是每个tile的x和y, 从起点到终点
+	int* points;
+
+	/// 路径代价, 和\link wyAStarMap::getStepG wyAStarMap::getStepG\endlink的单位相同
+	float cost;
+} wyPathResult;
+
+/**
+ * @typedef wyPathCallback
+ *
+ * 异步路径请求的回调, 参见\link wyPathService::requestPath requestPath\endlink. 所有方法都在OpenGL线程中调用.
+ */
+typedef struct WIENGINE_API wyPathCallback {
+	/**
+	 * 找到路径时调用
+	 *
+	 * @param result 路径, 回调返回后就会被释放, 如果需要保留请复制
+	 * @param data 额外数据指针
+	 */
+	void (*onPathFound)(wyPathResult* result, void* data);
+
+	/**
+	 * 没有找到路径时调用
+	 *
+	 * @param id 请求id
+	 * @param data 额外数据指针
+	 */
+	void (*onPathNotFound)(int id, void* data);
+} wyPathCallback;
+
+/**
+ * @class wyPathService
+ *
+ * 批量异步路径搜索服务. 每帧可以提交任意多个请求, 请求在工作线程中执行, 结果在下一帧开始时由导演类
+ * 在OpenGL线程中通过回调返回.
+ *
+ * 工作线程不访问\link wyAStarMap wyAStarMap\endlink, 而是使用提交请求时创建的只读快照\link wyPathSnapshot wyPathSnapshot\endlink,
+ * 因此提交之后修改地图是安全的, 已经提交的请求仍然使用修改前的状态. 地图版本不变时快照被多个请求共享.
+ *
+ * 对于所有tile的g值比率都相同的\link wyRectAStarMap wyRectAStarMap\endlink, 允许斜线时缺省使用跳点搜索, 也可以使用分层搜索,
+ * 分层搜索的抽象图为每个地图缓存, 地图阻挡状态改变后只更新受影响的区块. 其它地图使用A*.
+ *
+ * 所有方法都必须在OpenGL线程中调用.
+ */
+class WIENGINE_API wyPathService : public wyObject {
+	friend class wyDirector;
+
+private:
+	/// 每个地图缓存的数据
+	struct wyPathMapEntry {
+		/// 最新快照
+		wyPathSnapshot* snapshot;
+
+		/// 分层搜索的抽象图, 第一次分层搜索时创建
+		wyPathHierarchy* hierarchy;
+	};
+
+	/// 路径请求
+	struct wyPathJob {
+		/// 请求id
+		int id;
+
+		/// 地图快照
+		wyPathSnapshot* snapshot;
+
+		/// 抽象图, 可能为NULL
+		wyPathHierarchy* hierarchy;
+
+		/// 起点tile索引, -1表示无效
+		int start;
+
+		/// 终点tile索引, -1表示无效
+		int end;
+
+		/// true表示终点即使是阻挡的也可以到达
+		bool ignoreBlock;
+
+		/// 请求的算法
+		wyPathAlgorithm algorithm;
+
+		/// 回调
+		wyPathCallback callback;
+
+		/// 回调的额外数据
+		void* data;
+
+		/// 被取消的请求不执行搜索也不回调
+		volatile bool cancelled;
+
+		/// 是否找到路径
+		bool found;
+
+		/// 结果, 找到路径时有效
+		wyPathResult result;
+
+		/// 下一个排队的请求
+		wyPathJob* next;
+	};
+
+	/// 地图缓存
+	map<wyAStarMap*, wyPathMapEntry>* m_maps;
+
+	/// 还没有回调的请求, 只在OpenGL线程中访问
+	map<int, wyPathJob*>* m_jobs;
+
+	/// 保护等待队列和线程数
+	pthread_mutex_t m_mutex;
+
+	/// 通知工作线程有新请求或者需要退出
+	pthread_cond_t m_cond;
+
+	/// 等待执行的请求队列头
+	wyPathJob* m_queueHead;
+
+	/// 等待执行的请求队列尾
+	wyPathJob* m_queueTail;
+
+	/// 执行完的请求, 工作线程放入, OpenGL线程取出
+	wyLockFreeQueue* m_results;
+
+	/// 工作线程数
+	int m_threadCount;
+
+	/// 最大工作线程数
+	int m_maxThreads;
+
+	/// true表示工作线程需要退出
+	bool m_quit;
+
+	/// 下一个请求id
+	int m_nextId;
+
+	/// 新建抽象图的区块边长
+	int m_clusterSize;
+
+	/// OpenGL线程使用的搜索上下文
+	wyPathFinder* m_finder;
+
+	/// 同步搜索的结果
+	wyPathResult m_result;
+
+	/// 同步搜索结果的坐标数组容量
+	int m_resultCapacity;
+
+private:
+	wyPathService();
+
+	/// 得到地图的缓存, 如果地图改变了则更新快照
+	wyPathMapEntry& getEntry(wyAStarMap* mapdata, bool hierarchy);
+
+	/// 返回tile索引, 坐标无效返回-1
+	static int indexOf(wyAStarMap* mapdata, int x, int y);
+
+	/// 把搜索结果复制到结果结构中
+	static void fillResult(wyPathFinder* finder, wyPathSnapshot* s, wyPathResult* result, int* points);
+
+	/// 执行一个请求
+	static void runJob(wyPathFinder* finder, wyPathJob* job);
+
+	/// 释放请求
+	static void releaseJob(wyPathJob* job);
+
+	/// 工作线程入口
+	void workerEntry(wyTargetSelector* ts);
+
+	/// 由导演类在每帧开始时调用, 执行回调
+	void dispatchResults();
+
+public:
+	static wyPathService* getInstance();
+	static wyPathService* getInstanceNoCreate();
+	virtual ~wyPathService();
+
+	/**
+	 * 提交一个异步路径请求, 结果在之后某一帧开始时通过回调返回. 坐标无效或者没有路径时调用
+	 * onPathNotFound.
+	 *
+	 * @param mapdata \link wyAStarMap wyAStarMap\endlink对象指针
+	 * @param startx 起始tile x值
+	 * @param starty 起始tile y值
+	 * @param endx 目标tile x值
+	 * @param endy 目标tile y值
+	 * @param ignoreBlock true表示终点即使是阻挡的也可以到达
+	 * @param callback 回调, 结构会被复制
+	 * @param data 回调的额外数据指针
+	 * @param algorithm 搜索算法, 缺省自动选择
+	 * @return 请求id, 可以用来取消请求
+	 */
+	int requestPath(wyAStarMap* mapdata, int startx, int starty, int endx, int endy, bool ignoreBlock,
+			wyPathCallback* callback, void* data, wyPathAlgorithm algorithm = WY_PATH_ALGORITHM_AUTO);
+
+	/**
+	 * 取消一个请求, 被取消的请求不会回调
+	 *
+	 * @param id 请求id
+	 * @return true表示请求还没有回调, 已经被取消
+	 */
+	bool cancel(int id);
+
+	/**
+	 * 在当前线程中立即搜索路径, 和异步请求使用相同的快照和算法
+	 *
+	 * @param mapdata \link wyAStarMap wyAStarMap\endlink对象指针
+	 * @param startx 起始tile x值
+	 * @param starty 起始tile y值
+	 * @param endx 目标tile x值
+	 * @param endy 目标tile y值
+	 * @param ignoreBlock true表示终点即使是阻挡的也可以到达
+	 * @param algorithm 搜索算法, 缺省自动选择
+	 * @return 路径, 在下一次调用之前有效. NULL表示没有路径
+	 */
+	wyPathResult* findPath(wyAStarMap* mapdata, int startx, int starty, int endx, int endy, bool ignoreBlock,
+			wyPathAlgorithm algorithm = WY_PATH_ALGORITHM_AUTO);
+
+	/**
+	 * 删除地图的缓存, \link wyAStarMap wyAStarMap\endlink析构时会自动调用
+	 *
+	 * @param mapdata \link wyAStarMap wyAStarMap\endlink对象指针
+	 */
+	void removeMap(wyAStarMap* mapdata);
+
+	/**
+	 * 设置最大工作线程数, 缺省是2. 如果为0, 请求在每帧开始时在OpenGL线程中执行
+	 *
+	 * @param count 最大工作线程数
+	 */
+	void setMaxThreads(int count);
+
+	/**
+	 * 返回最大工作线程数
+	 *
+	 * @return 最大工作线程数
+	 */
+	int getMaxThreads() { return m_maxThreads; }
+
+	/**
+	 * 设置分层搜索的区块边长, 缺省是16. 只影响之后第一次使用分层搜索的地图
+	 *
+	 * @param size 区块边长
+	 */
+	void setClusterSize(int size) { m_clusterSize = size; }
+
+	/**
+	 * 返回分层搜索的区块边长
+	 *
+	 * @return 区块边长
+	 */
+	int getClusterSize() { return m_clusterSize; }
+
+	/**
+	 * 返回还没有回调的请求数
+	 *
+	 * @return 请求数
+	 */
+	int getPendingCount() { return m_jobs->size(); }
+};
+
+#endif // __wyPathService_h__
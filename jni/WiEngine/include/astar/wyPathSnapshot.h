@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: mike(mike.weib@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __wyPathSnapshot_h__
+#define __wyPathSnapshot_h__
+
+#include "wyGlobal.h"
+
+class wyAStarMap;
+
+/**
+ * @class wyPathSnapshot
+ *
+ * \link wyAStarMap wyAStarMap\endlink的只读快照, 由\link wyPathService wyPathService\endlink在OpenGL线程中创建,
+ * 然后交给工作线程搜索, 因此工作线程不会访问地图对象本身. 快照创建后不再修改, 引用计数是原子的,
+ * 可以在多个线程中保留和释放.
+ *
+ * 对于所有tile的g值比率都相同的\link wyRectAStarMap wyRectAStarMap\endlink, 快照是一个网格, tile索引为x * 高度 + y,
+ * 代价以直线一步为1计算. 其它地图的快照保存邻接表和每条边的代价, 邻接表在地图代价版本不变时被多个快照共享.
+ */
+class WIENGINE_API wyPathSnapshot {
+	friend class wyPathFinder;
+	friend class wyPathHierarchy;
+
+private:
+	/// 邻接表, 只有非网格快照使用
+	struct wyPathGraph {
+		/// 引用计数
+		volatile int refCount;
+
+		/// 每个tile的x坐标
+		int* x;
+
+		/// 每个tile的y坐标
+		int* y;
+
+		/// 每个tile的邻居在neighbors中的起始位置, 长度为tile数量加1
+		int* offsets;
+
+		/// 邻居tile索引
+		int* neighbors;
+
+		/// 到每个邻居的代价
+		float* costs;
+	};
+
+	/// 引用计数
+	volatile int m_refCount;
+
+	/// 快照对应的地图版本
+	int m_version;
+
+	/// 快照对应的地图代价版本
+	int m_costVersion;
+
+	/// tile数量
+	int m_tileCount;
+
+	/// true表示是均匀代价的网格
+	bool m_grid;
+
+	/// 网格宽度
+	int m_width;
+
+	/// 网格高度
+	int m_height;
+
+	/// 网格是否允许斜线移动
+	bool m_diagonal;
+
+	/// 网格直线一步的代价
+	float m_rate;
+
+	/// 每个tile是否阻挡
+	unsigned char* m_blocked;
+
+	/// 邻接表, 网格快照为NULL
+	wyPathGraph* m_graph;
+
+	/// 如果快照是在上一个快照基础上只更新改变的tile得到的, 则为上一个快照的版本, 否则为-1
+	int m_baseVersion;
+
+	/// 相对上一个快照改变了阻挡状态的tile索引, 可能有重复
+	int* m_changes;
+
+	/// 改变的tile数量
+	int m_changeCount;
+
+private:
+	wyPathSnapshot();
+	~wyPathSnapshot();
+
+	/// 创建地图的邻接表
+	static wyPathGraph* buildGraph(wyAStarMap* map);
+
+	/// 释放邻接表
+	static void releaseGraph(wyPathGraph* graph);
+
+	/// 读取所有tile的阻挡状态
+	static void readBlocked(wyAStarMap* map, wyPathSnapshot* s);
+
+public:
+	/**
+	 * 创建地图快照, 必须在OpenGL线程中调用. 如果上一个快照的代价版本和地图相同, 则共享上一个快照的
+	 * 邻接表, 并且如果地图还记得之后的所有改变, 只更新改变了的tile, 否则重新读取所有阻挡状态.
+	 *
+	 * @param map \link wyAStarMap wyAStarMap\endlink对象指针
+	 * @param last 这个地图的上一个快照, 可以为NULL
+	 * @return 新快照, 引用计数为1
+	 */
+	static wyPathSnapshot* make(wyAStarMap* map, wyPathSnapshot* last);
+
+	/**
+	 * 增加引用计数, 可以在任何线程中调用
+	 */
+	void retain();
+
+	/**
+	 * 减少引用计数, 为0时释放快照, 可以在任何线程中调用
+	 */
+	void release();
+
+	/**
+	 * 返回快照对应的地图版本
+	 *
+	 * @return 地图版本
+	 */
+	int getVersion() { return m_version; }
+
+	/**
+	 * 返回快照对应的地图代价版本
+	 *
+	 * @return 代价版本
+	 */
+	int getCostVersion() { return m_costVersion; }
+
+	/**
+	 * 返回tile数量
+	 *
+	 * @return tile数量
+	 */
+	int getTileCount() { return m_tileCount; }
+
+	/**
+	 * 是否是均匀代价的网格, 只有网格可以使用跳点搜索和分层搜索
+	 *
+	 * @return true表示是网格
+	 */
+	bool isGrid() { return m_grid; }
+
+	/**
+	 * 返回tile的x坐标
+	 *
+	 * @param index tile索引
+	 * @return x坐标
+	 */
+	int getTileX(int index) { return m_grid ? index / m_height : m_graph->x[index]; }
+
+	/**
+	 * 返回tile的y坐标
+	 *
+	 * @param index tile索引
+	 * @return y坐标
+	 */
+	int getTileY(int index) { return m_grid ? index % m_height : m_graph->y[index]; }
+
+	/**
+	 * tile是否阻挡
+	 *
+	 * @param index tile索引
+	 * @return true表示阻挡
+	 */
+	bool isBlocked(int index) { return m_blocked[index] != 0; }
+};
+
+#endif // __wyPathSnapshot_h__
@@ -48,6 +48,10 @@ private:
 	/// true indicating diagonal path will be searched
 	bool m_isAllowDiagonal;
 
+protected:
+	/// @see wyAStarMap::getTileIndex
+	virtual int getTileIndex(int x, int y);
+
 public:
 	/**
 	 * 构造函数
@@ -63,6 +67,27 @@ public:
 	 */
 	virtual ~wyRectAStarMap();
 
+	/**
+	 * 返回横向tile数量
+	 *
+	 * @return 横向tile数量
+	 */
+	int getWidth() { return m_width; }
+
+	/**
+	 * 返回纵向tile数量
+	 *
+	 * @return 纵向tile数量
+	 */
+	int getHeight() { return m_height; }
+
+	/**
+	 * 是否允许斜线查找
+	 *
+	 * @return true为允许
+	 */
+	bool isAllowDiagonal() { return m_isAllowDiagonal; }
+
 	/// @see wyAStarMap::validTile
 	virtual bool isValidTile(int x, int y);
 
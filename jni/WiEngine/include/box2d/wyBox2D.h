@@ -87,6 +87,79 @@ private:
 	 */
 	wyBox2DRender* m_render;
 
+	/**
+	 * \if English
+	 * length of a fixed step in seconds, 0 means step() advances world by frame delta
+	 * \else
+	 * 固定步长的秒数, 0表示step()直接用帧间隔推进世界
+	 * \endif
+	 */
+	float m_fixedTimeStep;
+
+	/**
+	 * \if English
+	 * max fixed steps run in one step() call
+	 * \else
+	 * 一次step()调用最多执行的固定步数
+	 * \endif
+	 */
+	int m_maxSubSteps;
+
+	/**
+	 * \if English
+	 * frame time not consumed by fixed steps yet
+	 * \else
+	 * 还没有被固定步消耗掉的帧时间
+	 * \endif
+	 */
+	float m_accumulator;
+
+	/**
+	 * \if English
+	 * interpolation factor between previous and current body state, in [0, 1)
+	 * \else
+	 * 上一个物体状态和当前状态之间的插值系数, 范围[0, 1)
+	 * \endif
+	 */
+	float m_alpha;
+
+	/// velocity iterations passed to b2World::Step
+	int m_velocityIterations;
+
+	/// position iterations passed to b2World::Step
+	int m_positionIterations;
+
+	/**
+	 * \if English
+	 * timer which calls step() every frame, NULL if auto step is off
+	 * \else
+	 * 每帧调用step()的定时器, 如果没有打开自动步进则为NULL
+	 * \endif
+	 */
+	wyTimer* m_stepTimer;
+
+	/**
+	 * \if English
+	 * body transforms saved while interpolated transforms are drawn
+	 * \else
+	 * 渲染插值变换时保存的物体原始变换
+	 * \endif
+	 */
+	b2Transform* m_savedTransforms;
+
+	/// capacity of \c m_savedTransforms
+	int m_savedTransformCapacity;
+
+private:
+	/// callback of \c m_stepTimer
+	void onStepTimer(wyTargetSelector* ts);
+
+	/// replace body transforms with interpolated ones, return false if nothing is replaced
+	bool applyInterpolatedTransforms();
+
+	/// restore body transforms replaced by \c applyInterpolatedTransforms
+	void restoreTransforms();
+
 public:
 	static wyBox2D* make();
 	wyBox2D();
@@ -222,6 +295,134 @@ public:
 	 * \endif
 	 */
 	wyBox2DRender* getBox2DRender() { return m_render; }
+
+	/**
+	 * \if English
+	 * Set a fixed physics rate. When it is set, \c step accumulates frame time and
+	 * advances world in steps of 1/hz seconds, so simulation doesn't depend on frame
+	 * rate. Bodies are drawn at a state interpolated between the last two steps, so
+	 * motion keeps smooth even if physics rate is lower than frame rate.
+	 *
+	 * @param hz steps per second, 0 or negative means \c step advances world by frame
+	 * 		delta directly, which is the default
+	 * @param maxSubSteps max steps run in one \c step call. If a frame is too long, the
+	 * 		time left is dropped and simulation slows down instead of spiraling
+	 * \else
+	 * 设置固定的物理频率. 设置后, \c step 会累积帧时间并以1/hz秒为步长推进世界, 使模拟
+	 * 结果不依赖帧率. 物体会按照最后两步之间的插值状态渲染, 因此即使物理频率低于帧率,
+	 * 运动也是平滑的.
+	 *
+	 * @param hz 每秒的步数, 0或负数表示 \c step 直接用帧间隔推进世界, 这是缺省行为
+	 * @param maxSubSteps 一次 \c step 调用最多执行的步数. 如果某帧太长, 多余的时间会被丢弃,
+	 * 		模拟变慢而不是越积越多
+	 * \endif
+	 */
+	void setFixedTimeStep(float hz, int maxSubSteps = 5);
+
+	/**
+	 * \if English
+	 * get fixed step length in seconds, or 0 if fixed step is not used
+	 *
+	 * @return fixed step length in seconds
+	 * \else
+	 * 得到固定步长的秒数, 如果没有使用固定步长, 返回0
+	 *
+	 * @return 固定步长的秒数
+	 * \endif
+	 */
+	float getFixedTimeStep() { return m_fixedTimeStep; }
+
+	/**
+	 * \if English
+	 * set iterations used by each world step, default is 10 and 10
+	 *
+	 * @param velocityIterations velocity iterations
+	 * @param positionIterations position iterations
+	 * \else
+	 * 设置每次世界步进使用的迭代次数, 缺省都是10
+	 *
+	 * @param velocityIterations 速度迭代次数
+	 * @param positionIterations 位置迭代次数
+	 * \endif
+	 */
+	void setIterations(int velocityIterations, int positionIterations);
+
+	/**
+	 * \if English
+	 * Advance world by a frame. If fixed step is set, world is stepped zero or more times
+	 * with fixed step, otherwise it is stepped once with \c delta. Forces applied before
+	 * calling it act on every step of this frame and are cleared when it returns, even if
+	 * no step is run, so a force applied in every frame acts the same at any physics rate.
+	 *
+	 * @param delta frame time in seconds
+	 * \else
+	 * 推进世界一帧. 如果设置了固定步长, 世界会以固定步长步进零次或多次, 否则以
+	 * \c delta 步进一次. 调用前施加的力作用于这一帧的每一步, 并且在返回时被清除, 即使
+	 * 没有执行任何一步也是如此, 因此每帧施加的力在任何物理频率下效果都相同.
+	 *
+	 * @param delta 帧时间, 单位秒
+	 * \endif
+	 */
+	void step(float delta);
+
+	/**
+	 * \if English
+	 * Set wyBox2D calls \c step every frame by itself or not. It is off by default and
+	 * you should step world in your own timer.
+	 *
+	 * @param flag true means stepping world every frame automatically
+	 * \else
+	 * 设置是否由wyBox2D自己在每帧调用 \c step. 缺省是关闭的, 需要在自己的定时器中
+	 * 推进世界.
+	 *
+	 * @param flag true表示每帧自动推进世界
+	 * \endif
+	 */
+	void setAutoStep(bool flag);
+
+	/**
+	 * \if English
+	 * is world stepped every frame automatically?
+	 *
+	 * @return true means world is stepped automatically
+	 * \else
+	 * 是否每帧自动推进世界
+	 *
+	 * @return true表示自动推进世界
+	 * \endif
+	 */
+	bool isAutoStep() { return m_stepTimer != NULL; }
+
+	/**
+	 * \if English
+	 * get interpolation factor between state before last step and current state
+	 *
+	 * @return interpolation factor in [0, 1], it is always 1 if fixed step is not used
+	 * \else
+	 * 得到最后一步之前的状态和当前状态之间的插值系数
+	 *
+	 * @return 插值系数, 范围[0, 1], 如果没有使用固定步长, 总是1
+	 * \endif
+	 */
+	float getInterpolationAlpha() { return m_alpha; }
+
+	/**
+	 * \if English
+	 * Get transform of a body which should be used for rendering. Use it to place nodes
+	 * which follow a body, so that they move as smoothly as the world drawn by wyBox2D.
+	 *
+	 * @param body b2Body
+	 * @return transform interpolated between last two steps, it is the body transform
+	 * 		if fixed step is not used
+	 * \else
+	 * 得到用于渲染的物体变换. 跟随物体的节点应该用它来设置位置, 这样它们的运动和wyBox2D
+	 * 渲染的世界一样平滑.
+	 *
+	 * @param body b2Body
+	 * @return 最后两步之间的插值变换, 如果没有使用固定步长, 就是物体的变换
+	 * \endif
+	 */
+	b2Transform getInterpolatedTransform(b2Body* body);
 };
 
 #endif // __wyBox2D_h__
@@ -66,6 +66,89 @@ private:
 	 */
 	drawSpaceOptions m_options;
 
+	/**
+	 * \if English
+	 * body state replaced while interpolated state is drawn
+	 * \else
+	 * 渲染插值状态时被替换的物体状态
+	 * \endif
+	 */
+	struct SavedBodyState {
+		cpVect p;
+		cpFloat a;
+		cpVect rot;
+	};
+
+	/**
+	 * \if English
+	 * length of a fixed step in seconds, 0 means step() advances space by frame delta
+	 * \else
+	 * 固定步长的秒数, 0表示step()直接用帧间隔推进space
+	 * \endif
+	 */
+	float m_fixedTimeStep;
+
+	/**
+	 * \if English
+	 * max fixed steps run in one step() call
+	 * \else
+	 * 一次step()调用最多执行的固定步数
+	 * \endif
+	 */
+	int m_maxSubSteps;
+
+	/**
+	 * \if English
+	 * frame time not consumed by fixed steps yet
+	 * \else
+	 * 还没有被固定步消耗掉的帧时间
+	 * \endif
+	 */
+	float m_accumulator;
+
+	/**
+	 * \if English
+	 * interpolation factor between previous and current body state, in [0, 1)
+	 * \else
+	 * 上一个物体状态和当前状态之间的插值系数, 范围[0, 1)
+	 * \endif
+	 */
+	float m_alpha;
+
+	/**
+	 * \if English
+	 * timer which calls step() every frame, NULL if auto step is off
+	 * \else
+	 * 每帧调用step()的定时器, 如果没有打开自动步进则为NULL
+	 * \endif
+	 */
+	wyTimer* m_stepTimer;
+
+	/**
+	 * \if English
+	 * body states saved while interpolated states are drawn
+	 * \else
+	 * 渲染插值状态时保存的物体原始状态
+	 * \endif
+	 */
+	SavedBodyState* m_savedStates;
+
+	/// capacity of \c m_savedStates
+	int m_savedStateCapacity;
+
+private:
+	/// callback of \c m_stepTimer
+	void onStepTimer(wyTargetSelector* ts);
+
+	/// true if body has a saved state from before the last step
+	bool hasPreviousState(cpBody* body);
+
+	/// replace body states with interpolated ones, return false if nothing is replaced
+	bool applyInterpolatedStates();
+
+	/// restore body states replaced by \c applyInterpolatedStates
+	void restoreStates();
+
 public:
 	static wyChipmunk* make();
 	wyChipmunk();
@@ -114,6 +197,155 @@ public:
 	 * \endif
 	 */
 	cpSpace* getSpace() { return m_space; }
+
+	/**
+	 * \if English
+	 * Set a fixed physics rate. When it is set, \c step accumulates frame time and
+	 * advances space in steps of 1/hz seconds, so simulation doesn't depend on frame
+	 * rate. Bodies are drawn at a state interpolated between the last two steps, so
+	 * motion keeps smooth even if physics rate is lower than frame rate.
+	 *
+	 * @param hz steps per second, 0 or negative means \c step advances space by frame
+	 * 		delta directly, which is the default
+	 * @param maxSubSteps max steps run in one \c step call. If a frame is too long, the
+	 * 		time left is dropped and simulation slows down instead of spiraling
+	 * \else
+	 * 设置固定的物理频率. 设置后, \c step 会累积帧时间并以1/hz秒为步长推进space, 使模拟
+	 * 结果不依赖帧率. 物体会按照最后两步之间的插值状态渲染, 因此即使物理频率低于帧率,
+	 * 运动也是平滑的.
+	 *
+	 * @param hz 每秒的步数, 0或负数表示 \c step 直接用帧间隔推进space, 这是缺省行为
+	 * @param maxSubSteps 一次 \c step 调用最多执行的步数. 如果某帧太长, 多余的时间会被丢弃,
+	 * 		模拟变慢而不是越积越多
+	 * \endif
+	 */
+	void setFixedTimeStep(float hz, int maxSubSteps = 5);
+
+	/**
+	 * \if English
+	 * get fixed step length in seconds, or 0 if fixed step is not used
+	 *
+	 * @return fixed step length in seconds
+	 * \else
+	 * 得到固定步长的秒数, 如果没有使用固定步长, 返回0
+	 *
+	 * @return 固定步长的秒数
+	 * \endif
+	 */
+	float getFixedTimeStep() { return m_fixedTimeStep; }
+
+	/**
+	 * \if English
+	 * Advance space by a frame. If fixed step is set, space is stepped zero or more times
+	 * with fixed step, otherwise it is stepped once with \c delta. Chipmunk never clears
+	 * body forces, so a force set on a body acts on every step until it is reset, and a
+	 * frame which runs no step doesn't change it.
+	 *
+	 * @param delta frame time in seconds
+	 * \else
+	 * 推进space一帧. 如果设置了固定步长, space会以固定步长步进零次或多次, 否则以
+	 * \c delta 步进一次. Chipmunk从不清除物体上的力, 所以设置的力在被重置之前作用于每一步,
+	 * 没有执行任何一步的帧也不会改变它.
+	 *
+	 * @param delta 帧时间, 单位秒
+	 * \endif
+	 */
+	void step(float delta);
+
+	/**
+	 * \if English
+	 * Set wyChipmunk calls \c step every frame by itself or not. It is off by default and
+	 * you should step space in your own timer.
+	 *
+	 * @param flag true means stepping space every frame automatically
+	 * \else
+	 * 设置是否由wyChipmunk自己在每帧调用 \c step. 缺省是关闭的, 需要在自己的定时器中
+	 * 推进space.
+	 *
+	 * @param flag true表示每帧自动推进space
+	 * \endif
+	 */
+	void setAutoStep(bool flag);
+
+	/**
+	 * \if English
+	 * is space stepped every frame automatically?
+	 *
+	 * @return true means space is stepped automatically
+	 * \else
+	 * 是否每帧自动推进space
+	 *
+	 * @return true表示自动推进space
+	 * \endif
+	 */
+	bool isAutoStep() { return m_stepTimer != NULL; }
+
+	/**
+	 * \if English
+	 * get interpolation factor between state before last step and current state
+	 *
+	 * @return interpolation factor in [0, 1], it is always 1 if fixed step is not used
+	 * \else
+	 * 得到最后一步之前的状态和当前状态之间的插值系数
+	 *
+	 * @return 插值系数, 范围[0, 1], 如果没有使用固定步长, 总是1
+	 * \endif
+	 */
+	float getInterpolationAlpha() { return m_alpha; }
+
+	/**
+	 * \if English
+	 * Move a dynamic body to a new place immediately. If fixed step is used, setting body
+	 * position or angle directly makes it slide from old place during interpolation, so
+	 * always use this method to teleport a body between steps.
+	 *
+	 * @param body cpBody, it must be added to space
+	 * @param pos new position
+	 * @param angle new angle in radians
+	 * \else
+	 * 立即把一个动态物体移动到新的位置. 如果使用了固定步长, 直接设置物体的位置或角度会导致插值时
+	 * 物体从原来的位置滑过去, 所以在两步之间瞬移物体时总是应该使用这个方法.
+	 *
+	 * @param body cpBody, 必须已经添加到space中
+	 * @param pos 新的位置
+	 * @param angle 新的角度, 单位是弧度
+	 * \endif
+	 */
+	void teleportBody(cpBody* body, wyPoint pos, float angle);
+
+	/**
+	 * \if English
+	 * Get position of a body which should be used for rendering. Use it to place nodes
+	 * which follow a body, so that they move as smoothly as the space drawn by wyChipmunk.
+	 *
+	 * @param body cpBody
+	 * @return position interpolated between last two steps, it is body position if
+	 * 		fixed step is not used or body didn't take part in last step
+	 * \else
+	 * 得到用于渲染的物体位置. 跟随物体的节点应该用它来设置位置, 这样它们的运动和wyChipmunk
+	 * 渲染的space一样平滑.
+	 *
+	 * @param body cpBody
+	 * @return 最后两步之间的插值位置, 如果没有使用固定步长或者物体没有参与最后一步, 就是物体的位置
+	 * \endif
+	 */
+	wyPoint getInterpolatedPosition(cpBody* body);
+
+	/**
+	 * \if English
+	 * Get angle of a body which should be used for rendering
+	 *
+	 * @param body cpBody
+	 * @return angle in radians interpolated between last two steps, it is body angle if
+	 * 		fixed step is not used or body didn't take part in last step
+	 * \else
+	 * 得到用于渲染的物体角度
+	 *
+	 * @param body cpBody
+	 * @return 最后两步之间的插值角度, 单位是弧度, 如果没有使用固定步长或者物体没有参与最后一步, 就是物体的角度
+	 * \endif
+	 */
+	float getInterpolatedAngle(cpBody* body);
 };
 
 #endif // __wyChipmunk_h__
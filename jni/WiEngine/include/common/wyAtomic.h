@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: luma(stubma@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __wyAtomic_h__
+#define __wyAtomic_h__
+
+#include "wyGlobal.h"
+#if WINDOWS
+	#include <windows.h>
+#endif
+
+/*
+ * Atomic helpers used by lock free code. GCC and clang have __sync builtins, Visual C++
+ * has Interlocked functions, every helper here is a full memory barrier.
+ */
+
+/**
+ * \if English
+ * Add a value to an integer atomically
+ *
+ * @param p pointer of integer
+ * @param value value to be added, can be negative
+ * @return new value of integer
+ * \else
+ * 原子地给一个整数加上一个值
+ *
+ * @param p 整数的指针
+ * @param value 要加上的值, 可以是负数
+ * @return 整数的新值
+ * \endif
+ */
+static inline int wyAtomicAdd(volatile int* p, int value) {
+#if WINDOWS
+	return (int)InterlockedExchangeAdd((volatile LONG*)p, (LONG)value) + value;
+#else
+	return __sync_add_and_fetch(p, value);
+#endif
+}
+
+/**
+ * \if English
+ * Set a pointer atomically
+ *
+ * @param p address of pointer
+ * @param value new pointer value
+ * @return old pointer value
+ * \else
+ * 原子地设置一个指针
+ *
+ * @param p 指针的地址
+ * @param value 新的指针值
+ * @return 旧的指针值
+ * \endif
+ */
+static inline void* wyAtomicSwapPointer(void* volatile* p, void* value) {
+#if WINDOWS
+	return InterlockedExchangePointer((PVOID volatile*)p, value);
+#else
+	__sync_synchronize();
+	return __sync_lock_test_and_set(p, value);
+#endif
+}
+
+/**
+ * \if English
+ * Full memory barrier, memory accesses before it won't be reordered after it and vice versa
+ * \else
+ * 完全内存屏障, 它之前的内存访问不会被重排到它之后, 反之亦然
+ * \endif
+ */
+static inline void wyMemoryBarrier() {
+#if WINDOWS
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+#endif // __wyAtomic_h__
@@ -33,15 +33,31 @@
 
 class wyDirector;
 
+struct wyAutoReleasePage;
+
 /**
  * @class wyAutoReleasePool
  *
  * \if English
- * pool of objects which need to be auto released. Maintained for
- * every thread so that objects got released when thread exits
+ * pool of objects which need to be auto released. Every thread has a stack of pools, an
+ * autoreleased object goes to the top pool of current thread. \link wyAutoReleasePool::make make\endlink
+ * pushes a new pool so pools can be nested, and \link wyAutoReleasePool::drain drain\endlink pops it.
+ * Pool of a non-OpenGL thread is handed to OpenGL thread when drained, so objects are always
+ * released in OpenGL thread. If a thread has no pool when an object is autoreleased, an implicit
+ * pool is created and it is drained when thread exits.
+ *
+ * Objects autoreleased in OpenGL thread without a pool go to frame pool, which is drained
+ * when a frame begins. Drain budget can limit how many objects are released in one frame, so
+ * that a huge release burst, for example after a scene change, is spread over several frames.
  * \else
- * 自动释放对象池. 每个创建的线程都需要一个这样的池用来保存需要释放的对象, 在
- * 线程结束时释放它们
+ * 自动释放对象池. 每个线程都有一个池栈, 被自动释放的对象会进入当前线程栈顶的池中.
+ * \link wyAutoReleasePool::make make\endlink 会压入一个新池, 因此池可以嵌套,
+ * \link wyAutoReleasePool::drain drain\endlink 则弹出它. 非OpenGL线程的池在抽干时会被交给
+ * OpenGL线程, 因此对象总是在OpenGL线程中释放. 如果一个线程在自动释放对象时没有池, 则会自动
+ * 创建一个隐含的池, 在线程结束时抽干.
+ *
+ * OpenGL线程中没有池时自动释放的对象会进入帧池, 帧池在每帧开始时被抽干. 抽干预算可以限制每帧释放
+ * 的对象数目, 这样大量对象的集中释放, 比如切换场景之后, 可以被分摊到多帧中.
  * \endif
  */
 class WIENGINE_API wyAutoReleasePool : public wyObject {
@@ -52,11 +68,34 @@ private:
 	/// thread id of this autorelease pool
 	ssize_t m_thread;
 
-	/// objects need to be released
-	vector<wyObject*>* m_objects;
+	/// parent pool in pool stack of owner thread
+	wyAutoReleasePool* m_parent;
+
+	/// first page, objects are released from it
+	wyAutoReleasePage* m_head;
+
+	/// last page, objects are added to it
+	wyAutoReleasePage* m_tail;
+
+	/// index of next object to be released in first page
+	int m_headIndex;
+
+	/// count of objects in pool
+	int m_count;
+
+	/// previous pool in global pool list
+	wyAutoReleasePool* m_prevPool;
+
+	/// next pool in global pool list
+	wyAutoReleasePool* m_nextPool;
 
 protected:
-	wyAutoReleasePool();
+	/**
+	 * 构造函数
+	 *
+	 * @param push true表示压入当前线程的池栈
+	 */
+	wyAutoReleasePool(bool push);
 
 	/// add an object to autorelease pool of current thread
 	static void addToPool(wyObject* obj);
@@ -64,27 +103,97 @@ protected:
 	/// flush all pending object, release them now
 	static void flush();
 
+	/// add an object to this pool
+	void addObject(wyObject* obj);
+
+	/// release at most max objects which are added before this call, return released count
+	int releaseObjects(int max);
+
+	/// pop this pool and pools above it from pool stack, then release them in opengl thread
+	void popAndRelease();
+
+	/// create key of pool stack
+	static void initPoolKey();
+
+	/// called when a thread exits, drain all pools of thread
+	static void onThreadExit(void* top);
+
 public:
 	virtual ~wyAutoReleasePool();
+
+	/**
+	 * \if English
+	 * Create a pool and push it to pool stack of current thread
+	 * \else
+	 * 创建一个池并压入当前线程的池栈
+	 * \endif
+	 */
 	static wyAutoReleasePool* make();
 
 	/**
 	 * \if English
-	 * Drain autorelease pool of current thread
+	 * Drain autorelease pool of current thread. Objects in top pool of current thread are handed
+	 * to OpenGL thread and pool is still usable.
 	 * \else
-	 * 抽干当前线程的自动释放池
+	 * 抽干当前线程的自动释放池. 当前线程栈顶池中的对象会交给OpenGL线程释放, 池本身仍然可以继续使用.
 	 * \endif
 	 */
 	static void drainCurrent();
 
 	/**
 	 * \if English
-	 * Drain pool to release all objects in it
+	 * Drain pool to release all objects in it. Pool and pools nested in it are popped from pool
+	 * stack and can't be used any more.
 	 * \else
-	 * 抽干自动释放池, 从而里面的所有对象都得到释放
+	 * 抽干自动释放池, 从而里面的所有对象都得到释放. 池和嵌套在它里面的池都会从池栈中弹出, 之后不能再使用.
 	 * \endif
 	 */
 	void drain();
+
+	/**
+	 * \if English
+	 * Drain frame pool of OpenGL thread, it is called by engine when a frame begins
+	 *
+	 * @param ignoreBudget true means release all objects regardless of drain budget
+	 * \else
+	 * 抽干OpenGL线程的帧池, 引擎会在每帧开始时调用
+	 *
+	 * @param ignoreBudget true表示忽略抽干预算, 释放所有对象
+	 * \endif
+	 */
+	static void drainFramePool(bool ignoreBudget = false);
+
+	/**
+	 * \if English
+	 * Set max count of objects released by frame pool in one frame. Objects which exceed budget
+	 * are released in following frames.
+	 *
+	 * @param count max object count, zero or negative means no limit. Default is zero
+	 * \else
+	 * 设置帧池在一帧中释放的最大对象数. 超出预算的对象会在之后的帧中释放.
+	 *
+	 * @param count 最大对象数, 0或负数表示没有限制. 缺省是0
+	 * \endif
+	 */
+	static void setDrainBudget(int count);
+
+	/**
+	 * \if English
+	 * Get drain budget of frame pool
+	 * \else
+	 * 得到帧池的抽干预算
+	 * \endif
+	 */
+	static int getDrainBudget();
+
+	/**
+	 * \if English
+	 * Get count of objects in this pool
+	 * \else
+	 * 得到池中对象的数目
+	 * \endif
+	 */
+	int getObjectCount() { return m_count; }
 };
 
 #endif // __wyAutoReleasePool_h__
@@ -35,6 +35,13 @@
  */
 #define WY_CFLAG_MEMORY_TRACKING
 
+/**
+ * define this macro to allocate wyObject subclasses from a size-class slab allocator
+ * which has per-thread caches. It is much faster than malloc when objects, such as
+ * actions, are created and destroyed frequently. when not needed, comment it
+ */
+#define WY_CFLAG_SLAB_ALLOCATOR
+
 /**
  * uncomment it to print log in every wyObject.retain invocation
  */
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: luma(stubma@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __wyLockFreeQueue_h__
+#define __wyLockFreeQueue_h__
+
+#include <stdbool.h>
+#include "wyGlobal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct wyLockFreeQueueNode
+ *
+ * node of \link wyLockFreeQueue wyLockFreeQueue\endlink
+ */
+typedef struct wyLockFreeQueueNode {
+	/// next node, written by producer and read by consumer
+	struct wyLockFreeQueueNode* volatile next;
+
+	/// element pointer
+	void* value;
+} wyLockFreeQueueNode;
+
+/**
+ * @struct wyLockFreeQueue
+ *
+ * \if English
+ * Multiple producer single consumer FIFO queue which doesn't use any lock. Any thread can push
+ * element and a push never waits other threads. Only one thread, usually OpenGL thread, can pop
+ * element. If a producer is pushing when consumer pops, the element may be seen in next pop, but
+ * it is never lost.
+ * \else
+ * 多生产者单消费者的无锁先进先出队列. 任何线程都可以压入元素, 压入操作不会等待其它线程. 只能有一个线程, 一般是
+ * OpenGL线程, 弹出元素. 如果消费者弹出时有生产者正在压入, 则该元素可能要到下次弹出时才能得到, 但是不会丢失.
+ * \endif
+ */
+typedef struct WIENGINE_API wyLockFreeQueue {
+	/// head node, it is a dummy node and only accessed by consumer
+	wyLockFreeQueueNode* head;
+
+	/// tail node, producers swap it atomically
+	wyLockFreeQueueNode* volatile tail;
+
+	/// approximate element count
+	volatile int count;
+} wyLockFreeQueue;
+
+/**
+ * \if English
+ * Create a new queue
+ * \else
+ * 创建一个新的队列
+ * \endif
+ */
+WIENGINE_API wyLockFreeQueue* wyLockFreeQueueNew();
+
+/**
+ * \if English
+ * Destroy a queue, remaining elements are not released. It must be called when no
+ * producer is pushing
+ *
+ * @param q queue
+ * \else
+ * 销毁队列, 队列中剩余的元素不会被释放. 调用时必须确保没有生产者在压入元素
+ *
+ * @param q 队列
+ * \endif
+ */
+WIENGINE_API void wyLockFreeQueueDestroy(wyLockFreeQueue* q);
+
+/**
+ * \if English
+ * Push an element to tail of queue, it can be called in any thread
+ *
+ * @param q queue
+ * @param value element pointer
+ * \else
+ * 在队列尾部压入一个元素, 可以在任何线程调用
+ *
+ * @param q 队列
+ * @param value 元素指针
+ * \endif
+ */
+WIENGINE_API void wyLockFreeQueuePush(wyLockFreeQueue* q, void* value);
+
+/**
+ * \if English
+ * Pop an element from head of queue, it can only be called in consumer thread
+ *
+ * @param q queue
+ * @return element pointer, or NULL if queue is empty
+ * \else
+ * 从队列头部弹出一个元素, 只能在消费者线程调用
+ *
+ * @param q 队列
+ * @return 元素指针, 如果队列为空则返回NULL
+ * \endif
+ */
+WIENGINE_API void* wyLockFreeQueuePop(wyLockFreeQueue* q);
+
+/**
+ * \if English
+ * Check whether queue is empty, it can only be called in consumer thread
+ *
+ * @param q queue
+ * @return true means no element can be popped now
+ * \else
+ * 检查队列是否为空, 只能在消费者线程调用
+ *
+ * @param q 队列
+ * @return true表示当前没有元素可以弹出
+ * \endif
+ */
+WIENGINE_API bool wyLockFreeQueueIsEmpty(wyLockFreeQueue* q);
+
+/**
+ * \if English
+ * Get approximate element count, it can be called in any thread
+ *
+ * @param q queue
+ * @return element count
+ * \else
+ * 得到队列中大致的元素个数, 可以在任何线程调用
+ *
+ * @param q 队列
+ * @return 元素个数
+ * \endif
+ */
+WIENGINE_API int wyLockFreeQueueCount(wyLockFreeQueue* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __wyLockFreeQueue_h__
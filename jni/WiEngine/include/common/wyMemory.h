@@ -80,4 +80,118 @@ inline void operator delete[](void* p) throw() {
 
 #endif // #if WY_CFLAG_MEMORY_TRACKING
 
+#ifdef WY_CFLAG_SLAB_ALLOCATOR
+
+/**
+ * @struct wySlabStats
+ *
+ * \if English
+ * Statistics of one size class of slab allocator. Counters are read without stopping
+ * other threads so they are approximate if other threads are allocating
+ * \else
+ * slab分配器中一个尺寸级别的统计信息. 读取计数时不会暂停其它线程, 因此如果其它线程
+ * 正在分配内存, 则计数是近似值
+ * \endif
+ */
+typedef struct wySlabStats {
+	/// block size of this class, in bytes
+	int blockSize;
+
+	/// blocks which are allocated and not freed yet
+	int liveBlocks;
+
+	/// free blocks kept in thread caches and global depot
+	int cachedBlocks;
+
+	/// count of chunks allocated from system for this class
+	int chunkCount;
+
+	/// total allocation count
+	int allocCount;
+
+	/// total free count
+	int freeCount;
+} wySlabStats;
+
+/**
+ * \if English
+ * Allocate a block from slab allocator. Size is rounded up to a size class and the block
+ * is taken from a per-thread cache, so in most cases no lock is needed. If size is larger
+ * than largest size class, it falls back to malloc. Freed blocks are reused by same size
+ * class and never returned to system.
+ *
+ * @param size size in bytes
+ * @return memory block, or NULL if out of memory
+ * \else
+ * 从slab分配器分配一块内存. 大小会向上取整到一个尺寸级别, 内存块从线程本地缓存中获得, 因此大多数
+ * 情况下不需要加锁. 如果大小超过最大的尺寸级别, 则使用malloc分配. 释放的内存块会被同尺寸级别重用,
+ * 不会归还给系统.
+ *
+ * @param size 字节数
+ * @return 内存块, 如果内存不足返回NULL
+ * \endif
+ */
+extern "C" WIENGINE_API void* wySlabAlloc(size_t size);
+
+/**
+ * \if English
+ * Free a block allocated by \link wySlabAlloc wySlabAlloc\endlink. It can be called in any thread,
+ * the block goes to cache of calling thread.
+ *
+ * @param ptr memory block, can be NULL
+ * @param size size passed to \link wySlabAlloc wySlabAlloc\endlink
+ * \else
+ * 释放由\link wySlabAlloc wySlabAlloc\endlink 分配的内存块. 可以在任何线程调用, 内存块会进入
+ * 调用线程的缓存.
+ *
+ * @param ptr 内存块, 可以是NULL
+ * @param size 分配时传给\link wySlabAlloc wySlabAlloc\endlink 的大小
+ * \endif
+ */
+extern "C" WIENGINE_API void wySlabFree(void* ptr, size_t size);
+
+/**
+ * \if English
+ * Get count of size classes
+ * \else
+ * 得到尺寸级别的个数
+ * \endif
+ */
+extern "C" WIENGINE_API int wySlabGetClassCount();
+
+/**
+ * \if English
+ * Get statistics of a size class
+ *
+ * @param index index of size class, from 0 to \link wySlabGetClassCount wySlabGetClassCount\endlink - 1
+ * @param stats \link wySlabStats wySlabStats\endlink to be filled
+ * @return false if index is invalid
+ * \else
+ * 得到一个尺寸级别的统计信息
+ *
+ * @param index 尺寸级别的索引, 从0到\link wySlabGetClassCount wySlabGetClassCount\endlink - 1
+ * @param stats 用来保存结果的\link wySlabStats wySlabStats\endlink
+ * @return 如果索引无效则返回false
+ * \endif
+ */
+extern "C" WIENGINE_API bool wySlabGetStats(int index, wySlabStats* stats);
+
+/**
+ * \if English
+ * Print statistics of all used size classes to console
+ * \else
+ * 在控制台打印所有用到的尺寸级别的统计信息
+ * \endif
+ */
+extern "C" WIENGINE_API void wySlabUsageReport();
+
+#ifdef WY_CFLAG_MEMORY_TRACKING
+
+extern "C" WIENGINE_API void* _wySlabAlloc(size_t size, const char* file, int line);
+extern "C" WIENGINE_API void _wySlabFree(void* ptr, size_t size);
+
+#endif // #ifdef WY_CFLAG_MEMORY_TRACKING
+
+#endif // #ifdef WY_CFLAG_SLAB_ALLOCATOR
+
 #endif // __wyMemory_h__
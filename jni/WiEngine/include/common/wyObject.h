@@ -75,6 +75,30 @@ public:
 	 */
 	virtual ~wyObject();
 
+#ifdef WY_CFLAG_SLAB_ALLOCATOR
+	/**
+	 * 从slab分配器分配对象内存, 频繁创建和销毁的对象, 比如动作, 可以避免malloc的开销
+	 */
+	static void* operator new(size_t size);
+
+	/**
+	 * 把对象内存归还给slab分配器. 因为析构函数是虚函数, size是实际对象的大小
+	 */
+	static void operator delete(void* p, size_t size);
+
+#ifdef WY_CFLAG_MEMORY_TRACKING
+	/**
+	 * WYNEW使用的版本, 会记录分配位置
+	 */
+	static void* operator new(size_t size, const char* file, int line);
+
+	/**
+	 * 仅在构造函数抛出异常时被调用, 引擎不使用异常, 所以不做任何事
+	 */
+	static void operator delete(void* p, const char* file, int line);
+#endif // #ifdef WY_CFLAG_MEMORY_TRACKING
+#endif // #ifdef WY_CFLAG_SLAB_ALLOCATOR
+
 	/**
 	 * 得到类名的字符串表示
 	 *
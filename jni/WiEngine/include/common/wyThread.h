@@ -101,6 +101,19 @@ public:
 	 * \endif
 	 */
 	static int runThread(wyTargetSelector* sel);
+
+	/**
+	 * \if English
+	 * Suspend current thread for a while, it doesn't spin so it can be used in background threads
+	 *
+	 * @param ms milliseconds to sleep
+	 * \else
+	 * 让当前线程休眠一段时间, 不会空转, 因此可以在后台线程中使用
+	 *
+	 * @param ms 休眠的毫秒数
+	 * \endif
+	 */
+	static void sleep(int ms);
 };
 
 #endif // __wyThread_h__
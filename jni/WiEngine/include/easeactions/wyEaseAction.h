@@ -30,6 +30,7 @@
 #define __wyEaseAction_h__
 
 #include "wyIntervalAction.h"
+#include "wyTween.h"
 
 /**
  * @class wyEaseAction
@@ -45,6 +46,28 @@ protected:
 	/// 线性动作的\link wyIntervalAction wyIntervalAction对象 \endlink 的指针
 	wyIntervalAction* m_wrapped;
 
+protected:
+	/**
+	 * \if English
+	 * Pack wrapped action and apply an ease function to the tween, subclass calls it in
+	 * \link wyAction::packTween packTween\endlink if its ease curve can be expressed by a function
+	 *
+	 * @param tween record to be filled
+	 * @param ease ease function
+	 * @param rate rate passed to ease function
+	 * @return true means packed
+	 * \else
+	 * 打包被包含的动作并为补间设置缓冲函数, 如果子类的缓冲曲线可以用一个函数表达, 则在\link wyAction::packTween packTween\endlink
+	 * 中调用此方法
+	 *
+	 * @param tween 要填充的记录
+	 * @param ease 缓冲函数
+	 * @param rate 传给缓冲函数的参数
+	 * @return true表示打包成功
+	 * \endif
+	 */
+	bool packWrapped(wyTween* tween, wyTweenEaseFunc ease, float rate);
+
 public:
 	/**
 	 * \if English
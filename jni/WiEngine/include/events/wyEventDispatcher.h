@@ -33,6 +33,7 @@
 #include "wyNode.h"
 #include <pthread.h>
 #include "wyEvents.h"
+#include "wyLockFreeQueue.h"
 #if ANDROID
 	#include <jni.h>
 #endif
@@ -68,59 +69,35 @@ protected:
 	/// true means event should be delivered
 	bool m_dispatchEvents;
 
-	/// pending accelerator handlers
-	HandlerList m_pendingAddAccelHandlers;
+	/// handler changes, any thread can push to it without lock and they are applied in OpenGL thread
+	wyLockFreeQueue* m_pendingHandlerCommands;
 
-	/// pending touch handlers
-	HandlerList m_pendingAddTouchHandlers;
+	/// count of accelerometer handlers, updated in OpenGL thread so other threads can read it
+	volatile int m_accelHandlerCount;
 
-	/// pending key handlers
-	HandlerList m_pendingAddKeyHandlers;
-
-	/// pending double tap handlers
-	HandlerList m_pendingAddDoubleTapHandlers;
-
-	/// pending gesture handlers
-	HandlerList m_pendingAddGestureHandlers;
-
-	/// pending remove accelerator handlers
-	NodePtrList m_pendingRemoveAccelHandlerNodes;
-
-	/// pending remove touch handlers
-	NodePtrList m_pendingRemoveTouchHandlerNodes;
-
-	/// pending remove key handlers
-	NodePtrList m_pendingRemoveKeyHandlerNodes;
-
-	/// pending remove double tap handlers
-	NodePtrList m_pendingRemoveDoubleTapHandlerNodes;
-
-	/// pending remove gesture handlers
-	NodePtrList m_pendingRemoveGestureHandlerNodes;
-
-	/// handlers of accelerometer event
+	/// handlers of accelerometer event, only accessed in OpenGL thread
 	HandlerList m_accelHandlers;
 
-	/// handlers of key event
+	/// handlers of key event, only accessed in OpenGL thread
 	HandlerList m_keyHandlers;
 
-	/// handlers of touch event
+	/// handlers of touch event, only accessed in OpenGL thread
 	HandlerList m_touchHandlers;
 
-	/// handlers of double tap event
+	/// handlers of double tap event, only accessed in OpenGL thread
 	HandlerList m_doubleTapHandlers;
 
-	/// handlers of gesture event
+	/// handlers of gesture event, only accessed in OpenGL thread
 	HandlerList m_gestureHandlers;
 
 	/// event queue
 	EventPtrList m_eventQueue;
 
-	/// event reuse pool
+	/// event reuse pool, only accessed in OpenGL thread
 	EventPtrList m_eventPool;
 
-	/// events need to be added to queue
-	EventPtrList m_pendingAddEvents;
+	/// events need to be added to queue, any thread can push event to it without lock
+	wyLockFreeQueue* m_pendingAddEvents;
 
 protected:
 	/**
@@ -131,9 +108,11 @@ protected:
 	/**
 	 * \if English
 	 * Check if any accelerometer handler installed, and enable accelerometer event
-	 * dispatching based on the result
+	 * dispatching based on the result. It is called in OpenGL thread after handler
+	 * changes are applied
 	 * \else
-	 * 检查当前是否有加速器事件监听器, 根据结果来打开或关闭加速器事件派发
+	 * 检查当前是否有加速器事件监听器, 根据结果来打开或关闭加速器事件派发. 在OpenGL线程中
+	 * 应用监听器变化后调用
 	 * \endif
 	 */
 	virtual void checkAccelHandlers() {}
@@ -141,9 +120,10 @@ protected:
 	/**
 	 * \if English
 	 * Check if any double tap handler installed, and enable double tap event dispatching
-	 * based on the result
+	 * based on the result. It is called in OpenGL thread after handler changes are applied
 	 * \else
-	 * 检查当前是否有双击事件监听器, 根据结果来打开或关闭双击事件派发
+	 * 检查当前是否有双击事件监听器, 根据结果来打开或关闭双击事件派发. 在OpenGL线程中应用
+	 * 监听器变化后调用
 	 * \endif
 	 */
 	virtual void checkDoubleTapHandlers() {}
@@ -151,9 +131,10 @@ protected:
 	/**
 	 * \if English
 	 * Check if any gesture handler installed, and enable gesture event dispatching
-	 * based on the result
+	 * based on the result. It is called in OpenGL thread after handler changes are applied
 	 * \else
-	 * 检查当前是否有手势事件监听器, 根据结果来打开或关闭手势事件派发
+	 * 检查当前是否有手势事件监听器, 根据结果来打开或关闭手势事件派发. 在OpenGL线程中应用
+	 * 监听器变化后调用
 	 * \endif
 	 */
 	virtual void checkGestureHandlers() {}
@@ -232,10 +213,6 @@ protected:
 	 */
 	int findHandler(HandlerList& list, wyNode* node);
 
-	/**
-	 * find nodes in a node pointer list
-	 */
-	int findNode(NodePtrList& list, wyNode* node);
 
 	/// process one event
 	void processEvent(wyEvent* e);
@@ -244,12 +221,35 @@ protected:
 	void releaseEvents(EventPtrList& list);
 
 	/**
-	 * 获得wyEvent指针，从事件池中，如果事件池没有中创建一个新的返回
+	 * 获得wyEvent指针，从事件池中，如果事件池没有中创建一个新的返回. 事件池只在OpenGL线程
+	 * 中使用, 其它线程总是创建新的事件
 	 *
 	 * @return wyEvent指针
 	 */
 	wyEvent* popEvent();
 
+	/**
+	 * Push an event to pending queue, it is lock free and can be called in any thread
+	 *
+	 * @param e event
+	 */
+	void pushEvent(wyEvent* e);
+
+	/**
+	 * Queue a handler change, it is lock free and can be called in any thread
+	 *
+	 * @param op operation of change
+	 * @param kind kind of handler
+	 * @param node node, NULL if op is removing all handlers
+	 * @param priority priority of added handler
+	 */
+	void pushHandlerCommand(int op, int kind, wyNode* node, int priority);
+
+	/**
+	 * Apply queued handler changes in OpenGL thread, it never waits for other threads
+	 */
+	void applyPendingHandlers();
+
 	/**
 	 * wyEvent指针保存到事件池
 	 *
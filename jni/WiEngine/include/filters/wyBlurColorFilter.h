@@ -67,24 +67,38 @@ protected:
 
 	/**
 	 * \if English
-	 * Blur a row
+	 * Band kernel which blurs rows horizontally into a buffer
 	 *
-	 * @param data image data
-	 * @param width image width
-	 * @param row row number to be blurred
-	 * @param radius blur radius
-	 * @return blurred row data
+	 * @param arg blur job
+	 * @param startRow first row
+	 * @param endRow row after last row
 	 * \else
-	 * 模糊一行
+	 * 水平模糊若干行到缓冲区的条带处理函数
 	 *
-	 * @param data 图片数据
-	 * @param width 图片宽度
-	 * @param row 需要模糊的行号
-	 * @param radius 模糊半径
-	 * @return 被模糊的行数据
+	 * @param arg 模糊任务
+	 * @param startRow 起始行
+	 * @param endRow 结束行的下一行
+	 * \endif
+	 */
+	static void blurRowsHorizontally(void* arg, int startRow, int endRow);
+
+	/**
+	 * \if English
+	 * Band kernel which blurs horizontally blurred rows vertically and writes result
+	 * back to image
+	 *
+	 * @param arg blur job
+	 * @param startRow first row
+	 * @param endRow row after last row
+	 * \else
+	 * 对水平模糊后的行做垂直模糊并把结果写回图像的条带处理函数
+	 *
+	 * @param arg 模糊任务
+	 * @param startRow 起始行
+	 * @param endRow 结束行的下一行
 	 * \endif
 	 */
-	unsigned char* blurRow(void* data, int width, int row, int radius);
+	static void blurRowsVertically(void* arg, int startRow, int endRow);
 
 public:
 	virtual ~wyBlurColorFilter();
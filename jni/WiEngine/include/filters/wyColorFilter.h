@@ -31,6 +31,18 @@
 
 #include "wyObject.h"
 
+// SIMD instruction set used by color filter kernels, none if both are 0
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#define WY_FILTER_NEON 1
+	#define WY_FILTER_SSE2 0
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define WY_FILTER_NEON 0
+	#define WY_FILTER_SSE2 1
+#else
+	#define WY_FILTER_NEON 0
+	#define WY_FILTER_SSE2 0
+#endif
+
 /**
  * @class wyColorFilter
  *
@@ -41,9 +53,41 @@
  * \endif
  */
 class WIENGINE_API wyColorFilter : public wyObject {
+protected:
+	/**
+	 * \if English
+	 * kernel which processes rows in [startRow, endRow) of an image
+	 * \else
+	 * 处理图像中[startRow, endRow)行的函数
+	 * \endif
+	 */
+	typedef void (*BandKernel)(void* arg, int startRow, int endRow);
+
 protected:
 	wyColorFilter() {}
 
+	/**
+	 * \if English
+	 * Split rows into bands and run kernel on them with filter worker threads. The calling
+	 * thread works too and method returns when all bands are done. Kernel must only write
+	 * rows of its band. If workers are busy with another image, all bands run in calling thread.
+	 *
+	 * @param kernel band kernel
+	 * @param arg argument passed to kernel
+	 * @param rows row count
+	 * @param minBandRows a band has at least so many rows, except the last one
+	 * \else
+	 * 把所有行分成若干条带, 用过滤器工作线程处理. 调用线程也会参与处理, 所有条带完成后方法
+	 * 返回. kernel只能写自己条带中的行. 如果工作线程正在处理其它图像, 所有条带都在调用线程中执行.
+	 *
+	 * @param kernel 条带处理函数
+	 * @param arg 传给kernel的参数
+	 * @param rows 行数
+	 * @param minBandRows 每个条带最少包含的行数, 最后一个条带除外
+	 * \endif
+	 */
+	static void runBands(BandKernel kernel, void* arg, int rows, int minBandRows);
+
 public:
 	virtual ~wyColorFilter() {}
 
@@ -63,6 +107,61 @@ public:
 	 * \endif
 	 */
 	virtual void apply(void* data, int width, int height) = 0;
+
+	/**
+	 * \if English
+	 * Set how many threads color filters can use, including the thread which calls \c apply.
+	 * By default it is the number of CPU cores.
+	 *
+	 * @param count thread count, 0 means the number of CPU cores, 1 means filters run in
+	 * 		calling thread only
+	 * \else
+	 * 设置颜色过滤器可以使用的线程数, 包括调用 \c apply 的线程. 缺省是CPU核数.
+	 *
+	 * @param count 线程数, 0表示CPU核数, 1表示只在调用线程中执行
+	 * \endif
+	 */
+	static void setThreadCount(int count);
+
+	/**
+	 * \if English
+	 * get how many threads color filters can use
+	 *
+	 * @return thread count including the calling thread
+	 * \else
+	 * 得到颜色过滤器可以使用的线程数
+	 *
+	 * @return 线程数, 包括调用线程
+	 * \endif
+	 */
+	static int getThreadCount();
+
+	/**
+	 * \if English
+	 * Enable SIMD kernels or not, it is enabled by default. Disabling it makes filters use
+	 * scalar kernels, which give reference result.
+	 *
+	 * @param flag true means using NEON or SSE2 kernels if they are compiled in
+	 * \else
+	 * 设置是否使用SIMD实现, 缺省是使用的. 关闭后过滤器使用标量实现, 其结果可作为参考.
+	 *
+	 * @param flag true表示使用NEON或SSE2实现, 如果编译时支持的话
+	 * \endif
+	 */
+	static void setSIMDEnabled(bool flag);
+
+	/**
+	 * \if English
+	 * are SIMD kernels used?
+	 *
+	 * @return true if SIMD kernels are compiled in and enabled
+	 * \else
+	 * 是否使用SIMD实现
+	 *
+	 * @return true表示编译时支持SIMD并且已经打开
+	 * \endif
+	 */
+	static bool isSIMDEnabled();
 };
 
 #endif // __wyColorFilter_h__
@@ -66,6 +66,23 @@ protected:
 	 */
 	wyColorMatrixColorFilter(wyColorMatrix* m);
 
+	/**
+	 * \if English
+	 * Band kernel which transforms colors of rows
+	 *
+	 * @param arg color matrix job
+	 * @param startRow first row
+	 * @param endRow row after last row
+	 * \else
+	 * 转换若干行颜色的条带处理函数
+	 *
+	 * @param arg 颜色矩阵任务
+	 * @param startRow 起始行
+	 * @param endRow 结束行的下一行
+	 * \endif
+	 */
+	static void transformRows(void* arg, int startRow, int endRow);
+
 public:
 	virtual ~wyColorMatrixColorFilter();
 
@@ -65,6 +65,40 @@ protected:
 	 */
 	wyEmbossColorFilter(unsigned int grayLevel);
 
+	/**
+	 * \if English
+	 * Band kernel which computes gray values of rows, it only reads image
+	 *
+	 * @param arg emboss job
+	 * @param startRow first row
+	 * @param endRow row after last row
+	 * \else
+	 * 计算若干行灰度值的条带处理函数, 它只读取图像
+	 *
+	 * @param arg 浮雕任务
+	 * @param startRow 起始行
+	 * @param endRow 结束行的下一行
+	 * \endif
+	 */
+	static void computeGrays(void* arg, int startRow, int endRow);
+
+	/**
+	 * \if English
+	 * Band kernel which writes gray values to rows
+	 *
+	 * @param arg emboss job
+	 * @param startRow first row
+	 * @param endRow row after last row
+	 * \else
+	 * 把灰度值写入若干行的条带处理函数
+	 *
+	 * @param arg 浮雕任务
+	 * @param startRow 起始行
+	 * @param endRow 结束行的下一行
+	 * \endif
+	 */
+	static void writeGrays(void* arg, int startRow, int endRow);
+
 public:
 	virtual ~wyEmbossColorFilter();
 
@@ -32,6 +32,7 @@
 #include "wyNode.h"
 #include "wyAction.h"
 #include "wyHashSet.h"
+#include "wyTween.h"
 #include <stdbool.h>
 
 /**
@@ -92,6 +93,70 @@ private:
 	 */
 	wyArray* m_physicsNodesPendingRemove;
 
+	/**
+	 * \if English
+	 * packed tween buffers, one for each channel
+	 * \else
+	 * 打包补间的缓冲区, 每个通道一个
+	 * \endif
+	 */
+	wyTween* m_tweens[WY_TWEEN_CHANNEL_COUNT];
+
+	/**
+	 * \if English
+	 * record count of tween buffers
+	 * \else
+	 * 补间缓冲区中的记录数
+	 * \endif
+	 */
+	int m_tweenCount[WY_TWEEN_CHANNEL_COUNT];
+
+	/**
+	 * \if English
+	 * capacity of tween buffers
+	 * \else
+	 * 补间缓冲区的容量
+	 * \endif
+	 */
+	int m_tweenCapacity[WY_TWEEN_CHANNEL_COUNT];
+
+	/**
+	 * \if English
+	 * true means tween buffers are being updated, removed records are marked dead
+	 * and cleaned after update
+	 * \else
+	 * true表示补间缓冲区正在更新, 被删除的记录只做标记, 在更新结束后清除
+	 * \endif
+	 */
+	bool m_tweensLocked;
+
+	/**
+	 * \if English
+	 * true means some records are marked dead
+	 * \else
+	 * true表示有记录被标记为删除
+	 * \endif
+	 */
+	bool m_hasDeadTweens;
+
+	/**
+	 * \if English
+	 * true means simple actions are packed into tween buffers
+	 * \else
+	 * true表示简单动作会被打包到补间缓冲区中
+	 * \endif
+	 */
+	bool m_tweenEnabled;
+
+	/**
+	 * \if English
+	 * actions which reach their end in tween update, they are retained and stopped after update
+	 * \else
+	 * 在补间更新中结束的动作, 它们被retain并在更新结束后停止
+	 * \endif
+	 */
+	wyArray* m_finishedTweens;
+
 private:
 	/**
 	 * \if English
@@ -114,6 +179,18 @@ private:
 	static bool findActionByTag(void* elementPtr, void* ptr2, void* data);
 	static bool releaseHash(void* elt, void* data);
 
+	/// pack action into tween buffer if action supports it
+	void packAction(wyAction* action);
+
+	/// set paused flag of action and its packed record
+	void setActionPaused(wyAction* action, bool paused);
+
+	/// remove record from tween buffer, last record is moved to its place
+	void removeTween(int channel, int index);
+
+	/// update all packed tweens
+	void tickTweens(float delta);
+
 public:
 	/**
 	 * \if English
@@ -335,6 +412,74 @@ public:
 	 * \endif
 	 */
 	void removePhysicsNode(wyNode* node);
+
+	/**
+	 * \if English
+	 * Remove an action from tween buffer and write its state back, so that it continues in normal
+	 * path. It is called when action is stopped or callback is set, developers shouldn't call it.
+	 *
+	 * @param action packed action
+	 * \else
+	 * 把一个动作从补间缓冲区中移除并写回它的状态, 这样它可以按普通方式继续执行. 在动作停止或设置回调时
+	 * 被调用, 开发者不需要直接调用.
+	 *
+	 * @param action 被打包的动作
+	 * \endif
+	 */
+	void unpackAction(wyAction* action);
+
+	/**
+	 * \if English
+	 * Get elapsed time of a packed action
+	 *
+	 * @param action packed action
+	 * @return elapsed time in seconds
+	 * \else
+	 * 得到一个被打包的动作已经持续的时间
+	 *
+	 * @param action 被打包的动作
+	 * @return 已经持续的时间, 单位秒
+	 * \endif
+	 */
+	float getPackedElapsed(wyAction* action);
+
+	/**
+	 * \if English
+	 * Enable or disable tween packing. If enabled, top level move, scale, rotate, fade and tint
+	 * actions without callback, optionally wrapped by a simple ease action, are updated in batched
+	 * loops. It only affects actions started later. Default is enabled.
+	 *
+	 * @param flag true means enable
+	 * \else
+	 * 打开或关闭补间打包. 如果打开, 没有回调的顶层移动, 缩放, 旋转, 渐变和变色动作, 包括被简单缓冲动作包装的,
+	 * 都会在批量循环中更新. 只影响之后开始的动作. 缺省是打开的.
+	 *
+	 * @param flag true表示打开
+	 * \endif
+	 */
+	void setTweenEnabled(bool flag) { m_tweenEnabled = flag; }
+
+	/**
+	 * \if English
+	 * Is tween packing enabled?
+	 * \else
+	 * 补间打包是否打开
+	 * \endif
+	 */
+	bool isTweenEnabled() { return m_tweenEnabled; }
+
+	/**
+	 * \if English
+	 * Get count of actions which are packed in tween buffers
+	 *
+	 * @return count of packed actions
+	 * \else
+	 * 得到被打包到补间缓冲区中的动作数目
+	 *
+	 * @return 被打包的动作数目
+	 * \endif
+	 */
+	int getPackedActionCount();
 };
 
 #endif // __wyActionManager_h__
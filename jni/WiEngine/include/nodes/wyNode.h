@@ -100,6 +100,21 @@ protected:
 	/// 翻转脏标记，标识需要重新计算
 	bool m_inverseDirty;
 
+	/// OpenGL格式的转换矩阵, 和m_transformMatrix一起更新, 在transform中直接使用
+	GLfloat m_transformGLMatrix[16];
+
+	/// 世界转换矩阵，用来转换到屏幕坐标系, 缓存起来避免每次都遍历所有父节点
+	wyAffineTransform m_worldMatrix;
+
+	/// 世界转换矩阵的逆矩阵，用来从屏幕坐标系转换到节点坐标系
+	wyAffineTransform m_worldInverseMatrix;
+
+	/// 世界转换矩阵脏标记，如果一个节点是脏的，则它所有的子节点也是脏的
+	bool m_worldDirty;
+
+	/// 世界逆矩阵脏标记
+	bool m_worldInverseDirty;
+
 	/// 标识当前对象是否可用状态,true可用状态
 	bool m_enabled;
 
@@ -260,6 +275,13 @@ protected:
 	 */
 	bool m_clipRelativeToSelf;
 
+	/**
+	 * true means draw method only appends quads to \link wyRenderQueue wyRenderQueue\endlink, so
+	 * pending quads don't need to be flushed before it. Texture node and skeletal sprite set it, a
+	 * subclass which overrides draw and calls OpenGL directly must set it back to false. Default is false.
+	 */
+	bool m_batchDraw;
+
 	/// 父节点\link wyNode wyNode对象指针\endlink
 	wyNode* m_parent;
 
@@ -1144,6 +1166,26 @@ public:
 	 */
 	void updateParentToNodeTransform();
 
+	/**
+	 * \if English
+	 * Update cached transform matrix from node to world. Parent matrix will be updated first
+	 * if it is dirty. If nothing changed, it does nothing.
+	 * \else
+	 * 更新缓存的节点到屏幕坐标系的转换矩阵. 如果父节点的矩阵是脏的, 会先更新父节点. 如果什么都没变化, 则不做任何事
+	 * \endif
+	 */
+	void updateNodeToWorldTransform();
+
+	/**
+	 * \if English
+	 * Mark cached world transform of this node and all descendants dirty. It stops at a node
+	 * which is already dirty because its descendants must be dirty too.
+	 * \else
+	 * 设置本节点和所有子孙节点的世界转换矩阵为脏. 遇到已经是脏的节点就停止, 因为它的子孙节点一定也是脏的
+	 * \endif
+	 */
+	void setWorldTransformDirty();
+
 	/**
 	 * \if English
 	 * Get transform matrix from node to global
@@ -2522,7 +2564,7 @@ public:
 	 * 设置父节点\link wyNode wyNode对象指针\endlink
 	 * \endif
 	 */
-	void setParent(wyNode* p) { m_parent = p; }
+	void setParent(wyNode* p) { m_parent = p; setWorldTransformDirty(); }
 
 	/**
 	 * \if English
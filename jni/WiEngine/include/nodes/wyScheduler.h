@@ -33,6 +33,7 @@
 #include "wyArray.h"
 #include "wyObject.h"
 #include "wyTargetSelector.h"
+#include <pthread.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,6 +47,23 @@ WIENGINE_API bool wyTimerEquals(void* ptr1, void* ptr2, void* data);
 #endif
 
 class wyScheduler;
+class wyTimer;
+struct wyTimerWheel;
+
+/// 双向链表节点, 调度器用它把定时器放到时间轮的槽或者暂停列表中
+struct wyTimerLink {
+	/// previous node
+	wyTimerLink* prev;
+
+	/// next node
+	wyTimerLink* next;
+
+	/// owner timer, NULL for list head
+	wyTimer* timer;
+
+	/// deadline, in seconds for time wheel, or in frames for frame wheel
+	double deadline;
+};
 
 /**
  * @class wyTimer
@@ -87,6 +105,30 @@ private:
 	/// true means this timer is finished
 	bool m_done;
 
+	/// true means timer is in scheduler, only accessed in OpenGL thread except reading
+	bool m_scheduled;
+
+	/// true means timer is paused and parked in paused list of scheduler
+	bool m_parked;
+
+	/// link in wheel slot or paused list
+	wyTimerLink m_link;
+
+	/// next timer in same hash bucket of scheduler
+	wyTimer* m_hashNext;
+
+	/// scheduler time when timer is fired last time
+	double m_lastFireTime;
+
+	/// scheduler frame when timer is fired last time
+	int m_lastFireFrame;
+
+	/// scheduler time when timer is paused
+	double m_pauseTime;
+
+	/// scheduler frame when timer is paused
+	int m_pauseFrame;
+
 public:
 	/**
 	 * 静态构造函数
@@ -158,7 +200,7 @@ public:
 	 *
 	 * @param frame 帧刷新，如果是0，表示通过时间调用. 如果m_interval也是0，表示尽可能快的调用，也就是相当于每帧都调用
 	 */
-	void setFrame(int frame) { m_frame = frame; }
+	void setFrame(int frame);
 
 	/**
 	 * 获得帧刷新数字，如果是0，标识时间调用
@@ -233,7 +275,7 @@ public:
 	 * 设置timer的暂停标志
 	 * \endif
 	 */
-	void setPaused(bool flag) { m_paused = flag; }
+	void setPaused(bool flag);
 
 	/**
 	 * \if English
@@ -249,7 +291,7 @@ public:
 	 *
 	 * @return 已经持续执行的时间，直到上次运行为止
 	 */
-	float getElapsed() { return m_elapsed; }
+	float getElapsed();
 
 	/**
 	 * 获得定时回调\link wyTargetSelector wyTargetSelector对象指针\endlink
@@ -277,17 +319,70 @@ public:
  * 调度器的封装
  */
 class WIENGINE_API wyScheduler : public wyObject {
-	friend bool removeTimers(wyArray* arr, void* ptr, int index, void* data);
+	friend class wyTimer;
 
 private:
-	/// 正在运行的定时器队列
-	wyArray* m_scheduledTimers;
+	/// type of timer command
+	enum wyTimerCommandType {
+		/// schedule timer
+		TC_SCHEDULE,
+
+		/// unschedule timer
+		TC_UNSCHEDULE,
+
+		/// paused flag, interval or frame of timer is changed
+		TC_UPDATE,
+
+		/// timer is reset
+		TC_RESET
+	};
+
+	/// a schedule or unschedule request
+	struct wyTimerCommand {
+		/// timer, retained by command
+		wyTimer* timer;
+
+		/// command type
+		wyTimerCommandType type;
+	};
+
+	typedef vector<wyTimerCommand> TimerCommandList;
+
+	/**
+	 * 时间模式定时器的时间轮, 单位是秒. 定时器按到期时间放在分层的槽中, 每帧只处理到期的槽,
+	 * 因此开销只和真正触发的定时器数目有关
+	 */
+	wyTimerWheel* m_timeWheel;
 
-	/// 准备添加的定时器队列
-	wyArray* m_timersToAdd;
+	/// 帧模式定时器的时间轮, 单位是帧
+	wyTimerWheel* m_frameWheel;
 
-	/// 准备删除的定时器队列
-	wyArray* m_timersToRemove;
+	/// 暂停的定时器列表, 它们不在时间轮中
+	wyTimerLink m_pausedTimers;
+
+	/// 已调度定时器的哈希表, 以回调目标为键, 用来检查重复调度和查找要删除的定时器
+	wyTimer** m_buckets;
+
+	/// bit count of bucket count
+	int m_bucketBits;
+
+	/// count of scheduled timers
+	int m_timerCount;
+
+	/// scaled time since scheduler is created
+	double m_time;
+
+	/// frames ticked since scheduler is created
+	int m_frames;
+
+	/// mutex to protect pending command list
+	pthread_mutex_t m_pendingMutex;
+
+	/// schedule and unschedule requests in calling order, any thread can append to it
+	TimerCommandList m_pendingCommands;
+
+	/// back buffer of pending commands, it is swapped with pending list and applied without lock
+	TimerCommandList m_commandsBuffer;
 
 	/// 快慢动作的执行，大于1为快动作，小于1为慢动作
 	float m_timeScale;
@@ -295,33 +390,41 @@ private:
 private:
 	wyScheduler();
 
-	// array callback
-	static bool removeTimers(wyArray* arr, void* ptr, int index, void* data);
-	static bool addTimers(wyArray* arr, void* ptr, int index, void* data);
-	static bool releaseTimer(wyArray* arr, void* ptr, int index, void* data);
-	static bool fire(wyArray* arr, void* ptr, int index, void* data);
+	/// append a command to pending list
+	void pushCommand(wyTimer* t, wyTimerCommandType type);
 
-protected:
-	/**
-	 * 获得正在运行的定时器队列\link wyArray wyArray对象指针\endlink
-	 *
-	 * @return 正在运行的定时器队列\link wyArray wyArray对象指针\endlink
-	 */
-	wyArray* getScheduledTimers() { return m_scheduledTimers; }
+	/// release timers in a command list and clear it
+	static void releaseCommands(TimerCommandList& list);
 
 	/**
-	 * 获得准备添加的定时器队列\link wyArray wyArray对象指针\endlink
-	 *
-	 * @return 正在运行的定时器队列\link wyArray wyArray对象指针\endlink
+	 * Apply pending commands in OpenGL thread. If other thread is appending command,
+	 * it doesn't wait and commands will be applied in next tick.
 	 */
-	wyArray* getTimersToAdd() { return m_timersToAdd; }
+	void applyPendingCommands();
 
-	/**
-	 * 获得准备删除的定时器队列\link wyArray wyArray对象指针\endlink
-	 *
-	 * @return 正在运行的定时器队列\link wyArray wyArray对象指针\endlink
-	 */
-	wyArray* getTimersToRemove() { return m_timersToRemove; }
+	/// find scheduled timer which equals to t, return NULL if not found
+	wyTimer* findTimer(wyTimer* t);
+
+	/// add timer to hash table and wheel
+	void addTimer(wyTimer* t);
+
+	/// remove timer from hash table and wheel, then release it
+	void removeTimer(wyTimer* t);
+
+	/// put timer in a wheel by its deadline
+	void insertTimer(wyTimer* t);
+
+	/// move timer between wheel and paused list after its state is changed
+	void relinkTimer(wyTimer* t, bool reset);
+
+	/// fire an expired timer and put it back to wheel
+	void fireTimer(wyTimer* t);
+
+	/// double bucket count when there are too many timers
+	void growBuckets();
+
+	/// get time passed since last firing of a scheduled timer
+	float getTimerElapsed(wyTimer* t);
 
 public:
 	/**
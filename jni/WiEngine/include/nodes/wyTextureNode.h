@@ -169,6 +169,22 @@ public:
 	/// @see wyNode::draw
 	virtual void draw();
 
+	/**
+	 * \if English
+	 * Get quad which is rendered by \c draw, vertices are in node space. Texture
+	 * must be loaded before calling it
+	 *
+	 * @param texCoords texture coordinates of quad
+	 * @param vertices vertices of quad
+	 * \else
+	 * 得到\c draw 渲染的矩形, 顶点是节点坐标系中的. 调用之前贴图必须已经载入
+	 *
+	 * @param texCoords 矩形的贴图坐标
+	 * @param vertices 矩形的顶点
+	 * \endif
+	 */
+	void getQuad(wyQuad2D* texCoords, wyQuad3D* vertices);
+
 	/// @see wyNode::getAlpha
 	virtual int getAlpha() { return m_color.a; }
 
@@ -140,6 +140,21 @@ private:
 	/// 源图片的density，对于通过资源id载入的图片没有意义
 	float m_inDensity;
 
+	/**
+	 * decoded data which is waiting for uploading. For normal image it is pixel data
+	 * in destination format, for PVR it is raw file data
+	 */
+	char* m_decodedData;
+
+	/// byte size of decoded data
+	size_t m_decodedLength;
+
+	/// true means decoded data is raw PVR data
+	bool m_decodedPVR;
+
+	/// true means decoded data should be freed after uploading
+	bool m_decodedNeedFree;
+
 private:
 	/**
 	 * Create texture from image file which is specified by resource id.
@@ -211,6 +226,21 @@ private:
 	 */
 	static wyGLTexture2D* makeFile(const char* fsPath, int transparentColor = 0, wyTexturePixelFormat pixelFormat = WY_TEXTURE_PIXEL_FORMAT_RGBA8888, float inDensity = 0);
 
+	/**
+	 * Create texture from an image file but don't touch the file. Texture size is unknown
+	 * until \link wyGLTexture2D::decode decode\endlink is called, so it is used by asynchronous
+	 * loading which decodes image in worker thread.
+	 *
+	 * @param path image file path
+	 * @param isFile true means \c path is an absolute path in file system, false means it is
+	 * 		a relative path in assets
+	 * @param transparentColor transparent color
+	 * @param pixelFormat destination opengl texture format
+	 * @param inDensity density of image file, zero means uses system default setting.
+	 * @return \link wyGLTexture2D wyGLTexture2D\endlink
+	 */
+	static wyGLTexture2D* makeLazy(const char* path, bool isFile, int transparentColor = 0, wyTexturePixelFormat pixelFormat = WY_TEXTURE_PIXEL_FORMAT_RGBA8888, float inDensity = 0);
+
 	/**
 	 * 通过一个字符串生成一个贴图
 	 *
@@ -324,6 +354,40 @@ private:
 	 */
 	char* loadImage(char* raw, size_t len, float scale);
 
+	/**
+	 * Do cpu part of image loading: read file, decode, scale and convert pixel format. It doesn't
+	 * call any opengl function so it can be called in any thread, but caller must ensure
+	 * no other thread is using this texture. The result is kept until \link wyGLTexture2D::doLoad doLoad\endlink
+	 * uploads it. If texture size is not initialized, it will be initialized here.
+	 *
+	 * @return true means decoding is successful
+	 */
+	bool decode();
+
+	/**
+	 * Upload decoded data to opengl, it must be called in OpenGL thread
+	 */
+	void upload();
+
+	/**
+	 * Upload pixel data in current pixel format to bound texture
+	 *
+	 * @param data pixel data whose format is \c m_pixelFormat
+	 */
+	void texImage(const char* data);
+
+	/**
+	 * Free decoded data if it is not uploaded
+	 */
+	void releaseDecodedData();
+
+	/**
+	 * Get byte size of decoded data, it is used to control upload budget
+	 *
+	 * @return byte size of decoded data, or zero if no decoded data
+	 */
+	size_t getDecodedLength() { return m_decodedLength; }
+
 	/**
 	 * 设置显示的字符串内容
 	 *
@@ -477,6 +541,23 @@ private:
 	 */
 	void draw(float x, float y, float width, float height, float sourceWidth, float sourceHeight, bool flipX, bool flipY, wyRect texRect, bool rotatedZwoptex);
 
+	/**
+	 * \if English
+	 * Compute the vertices and texture coordinates which will be used if texture is drawn
+	 * with same arguments, but don't draw anything. It is used by render queue to batch
+	 * quads of same texture.
+	 *
+	 * @param texCoords returns texture coordinates of quad
+	 * @param vertices returns vertices of quad
+	 * \else
+	 * 计算以相同参数绘制贴图时所用的顶点和贴图坐标, 但是不进行绘制. 渲染队列用它来合并相同贴图的矩形
+	 *
+	 * @param texCoords 返回矩形的贴图坐标
+	 * @param vertices 返回矩形的顶点
+	 * \endif
+	 */
+	void getQuad(float x, float y, float width, float height, float sourceWidth, float sourceHeight, bool flipX, bool flipY, wyRect texRect, bool rotatedZwoptex, wyQuad2D* texCoords, wyQuad3D* vertices);
+
 	/**
 	 * 得到原始图片的宽度
 	 *
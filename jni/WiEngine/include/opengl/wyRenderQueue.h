@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2010 WiYun Inc.
+ * Author: luma(stubma@gmail.com)
+ *
+ * For all entities this program is free software; you can redistribute
+ * it and/or modify it under the terms of the 'WiEngine' license with
+ * the additional provision that 'WiEngine' must be credited in a manner
+ * that can be be observed by end users, for example, in the credits or during
+ * start up. (please find WiEngine logo in sdk's logo folder)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __wyRenderQueue_h__
+#define __wyRenderQueue_h__
+
+#include "wyObject.h"
+#include "wyGlobal.h"
+#include "wyTypes.h"
+
+class wyNode;
+class wyTexture2D;
+
+/**
+ * @class wyRenderQueue
+ *
+ * \if English
+ * Render queue which batches sprite quads automatically. When a scene is visited, \link wyNode wyNode\endlink
+ * pushes its transform to a CPU matrix stack kept by queue. If a texture node doesn't need special
+ * OpenGL state, it doesn't draw immediately but transforms its quad into world space and appends
+ * it to queue. Adjacent quads which use same texture and blend function are merged and rendered by
+ * one draw call. Queue is flushed when texture or blend function changes, or before any other drawing
+ * code changes OpenGL state, so the visual result is same as drawing quads one by one.
+ *
+ * Queue also counts draw calls in every frame, it will be shown in FPS label if FPS display is enabled.
+ * \else
+ * 自动合并精灵矩形的渲染队列. 在场景被遍历时, \link wyNode wyNode\endlink 会把自己的变换矩阵压入
+ * 队列维护的CPU矩阵栈中. 如果一个贴图节点不需要特殊的OpenGL状态, 则它不立刻绘制, 而是把自己的矩形
+ * 变换到世界坐标后添加到队列中. 相邻的且使用相同贴图和混合模式的矩形会被合并, 用一次绘制调用渲染. 当贴图
+ * 或混合模式改变时, 或者其它绘制代码修改OpenGL状态之前, 队列会被提交, 因此显示效果和逐个绘制是一样的.
+ *
+ * 队列还会统计每帧的绘制调用次数, 如果打开了FPS显示, 这个次数会显示在FPS标签中.
+ * \endif
+ */
+class WIENGINE_API wyRenderQueue : public wyObject {
+private:
+	/// entry of cpu matrix stack
+	struct wyMatrixEntry {
+		/// node who pushes this entry
+		wyNode* owner;
+
+		/// world transform, it is relative to the matrix when frame begins
+		wyAffineTransform transform;
+
+		/// true means transform can be used to batch quads
+		bool valid;
+	};
+
+	/// cpu matrix stack
+	wyMatrixEntry* m_stack;
+
+	/// size of matrix stack
+	int m_stackSize;
+
+	/// capacity of matrix stack
+	int m_stackCapacity;
+
+	/// model view matrix when frame begins
+	GLfloat m_rootMatrix[16];
+
+	/// true means batching is enabled
+	bool m_enabled;
+
+	/// true means a frame is being rendered
+	bool m_inFrame;
+
+	/// texture of pending quads
+	wyTexture2D* m_texture;
+
+	/// opengl texture name of pending quads
+	int m_textureName;
+
+	/// blend function of pending quads
+	wyBlendFunc m_blendFunc;
+
+	/// vertices of pending quads
+	GLfloat* m_vertices;
+
+	/// texture coordinates of pending quads
+	GLfloat* m_texCoords;
+
+	/// colors of pending quads
+	GLubyte* m_colors;
+
+	/// indices of pending quads
+	GLushort* m_indices;
+
+	/// count of pending quads
+	int m_quadCount;
+
+	/// capacity of quad buffers
+	int m_capacity;
+
+	/// draw calls of current frame
+	int m_drawCalls;
+
+	/// draw calls of last frame
+	int m_lastDrawCalls;
+
+	/// quads batched in current frame
+	int m_batchedQuads;
+
+	/// quads batched in last frame
+	int m_lastBatchedQuads;
+
+private:
+	wyRenderQueue();
+
+	/// ensure quad buffers can hold specified quads
+	void ensureCapacity(int quads);
+
+public:
+	static wyRenderQueue* getInstance();
+	static wyRenderQueue* getInstanceNoCreate();
+	virtual ~wyRenderQueue();
+
+	/**
+	 * \if English
+	 * Enable or disable automatic batching. If disabled, every node draws itself immediately
+	 * but draw calls are still counted. Default is enabled.
+	 * \else
+	 * 打开或关闭自动合并. 如果关闭, 每个节点都立刻绘制自己, 但是绘制调用次数仍然会被统计. 缺省是打开的.
+	 * \endif
+	 */
+	void setEnabled(bool flag);
+
+	/**
+	 * \if English
+	 * Is automatic batching enabled?
+	 * \else
+	 * 自动合并是否打开
+	 * \endif
+	 */
+	bool isEnabled() { return m_enabled; }
+
+	/**
+	 * \if English
+	 * Called by director before visiting running scene. It saves current model view
+	 * matrix and resets matrix stack and counters.
+	 * \else
+	 * 由导演类在遍历当前场景之前调用, 它会保存当前的模型视图矩阵, 并重置矩阵栈和计数器
+	 * \endif
+	 */
+	void beginFrame();
+
+	/**
+	 * \if English
+	 * Called by director after running scene is visited. It flushes pending quads and
+	 * saves counters of this frame.
+	 * \else
+	 * 由导演类在遍历当前场景之后调用, 它会提交剩余的矩形并保存本帧的计数
+	 * \endif
+	 */
+	void endFrame();
+
+	/**
+	 * \if English
+	 * Push transform of a node to cpu matrix stack, it is called by \link wyNode::visit wyNode::visit\endlink
+	 * after node pushes opengl matrix.
+	 *
+	 * @param node node which is visited
+	 * @param batchable false means node does something can't be expressed by an affine transform, such as
+	 * 		a grid effect or a camera, so children of this node won't be batched
+	 * \else
+	 * 把一个节点的变换压入CPU矩阵栈, 由\link wyNode::visit wyNode::visit\endlink 在压入OpenGL矩阵后调用
+	 *
+	 * @param node 被遍历的节点
+	 * @param batchable false表示节点做了仿射变换无法表达的事情, 比如网格效果或者摄像机, 则节点的子节点都不会被合并
+	 * \endif
+	 */
+	void pushNode(wyNode* node, bool batchable);
+
+	/**
+	 * \if English
+	 * Pop the transform pushed by \link wyRenderQueue::pushNode pushNode\endlink
+	 * \else
+	 * 弹出由\link wyRenderQueue::pushNode pushNode\endlink 压入的变换
+	 * \endif
+	 */
+	void popNode();
+
+	/**
+	 * \if English
+	 * Check whether a node can append its quad to queue in its draw method
+	 *
+	 * @param node node which is drawing
+	 * @return true means node can call \link wyRenderQueue::addQuad addQuad\endlink
+	 * \else
+	 * 检查一个节点在绘制时是否可以把它的矩形添加到队列中
+	 *
+	 * @param node 正在绘制的节点
+	 * @return true表示节点可以调用\link wyRenderQueue::addQuad addQuad\endlink
+	 * \endif
+	 */
+	bool canBatch(wyNode* node);
+
+	/**
+	 * \if English
+	 * Append a quad to queue, the quad is in node space and will be transformed by current
+	 * matrix on stack. If texture or blend function is different with pending quads, queue
+	 * will be flushed first.
+	 *
+	 * @param tex texture of quad
+	 * @param blendFunc blend function of quad
+	 * @param texCoords texture coordinates of quad
+	 * @param vertices vertices of quad in node space
+	 * @param color color of quad
+	 * \else
+	 * 添加一个矩形到队列中, 矩形是节点坐标系中的, 会被栈顶的矩阵变换. 如果贴图或混合模式和队列中已有的
+	 * 矩形不同, 则队列会先被提交.
+	 *
+	 * @param tex 矩形的贴图
+	 * @param blendFunc 矩形的混合模式
+	 * @param texCoords 矩形的贴图坐标
+	 * @param vertices 矩形在节点坐标系中的顶点
+	 * @param color 矩形的颜色
+	 * \endif
+	 */
+	void addQuad(wyTexture2D* tex, wyBlendFunc blendFunc, wyQuad2D& texCoords, wyQuad3D& vertices, wyColor4B color);
+
+	/**
+	 * \if English
+	 * Render all pending quads with one draw call. Any code which draws or changes opengl
+	 * state during scene visiting must call it first.
+	 * \else
+	 * 用一次绘制调用渲染所有队列中的矩形. 任何在场景遍历时绘制或修改OpenGL状态的代码都要先调用它.
+	 * \endif
+	 */
+	void flush();
+
+	/**
+	 * \if English
+	 * Count draw calls, it should be called after every glDrawArrays or glDrawElements
+	 *
+	 * @param count draw call count
+	 * \else
+	 * 统计绘制调用次数, 每次调用glDrawArrays或glDrawElements之后都应该调用它
+	 *
+	 * @param count 绘制调用次数
+	 * \endif
+	 */
+	void countDrawCall(int count = 1) { m_drawCalls += count; }
+
+	/**
+	 * \if English
+	 * Get draw call count of last frame
+	 * \else
+	 * 得到上一帧的绘制调用次数
+	 * \endif
+	 */
+	int getLastFrameDrawCalls() { return m_lastDrawCalls; }
+
+	/**
+	 * \if English
+	 * Get count of quads which are batched in last frame
+	 * \else
+	 * 得到上一帧被合并绘制的矩形数目
+	 * \endif
+	 */
+	int getLastFrameBatchedQuads() { return m_lastBatchedQuads; }
+};
+
+#endif // __wyRenderQueue_h__
@@ -133,8 +133,8 @@ private:
 	/// 贴图句柄, 唯一的对应着一个真实的贴图对象. 小于0表示无效句柄.
 	size_t m_handle;
 
-	/// 贴图md5键值, \link wyTexture2D wyTexture2D\endlink不需要负责释放
-	const char* m_md5;
+	/// 贴图键值, 用来检查句柄是否已经被重用
+	uint64_t m_key;
 
 	/// 贴图来源
 	wyTextureSource m_source;
@@ -637,6 +637,23 @@ public:
 	 */
 	void draw(float x, float y, float width, float height, float sourceWidth, float sourceHeight, bool flipX, bool flipY, wyRect texRect, bool rotatedZwoptex);
 
+	/**
+	 * \if English
+	 * Compute the vertices and texture coordinates which will be used if texture is drawn
+	 * with same arguments, but don't draw anything. It is used by render queue to batch
+	 * quads of same texture.
+	 *
+	 * @param texCoords returns texture coordinates of quad
+	 * @param vertices returns vertices of quad
+	 * \else
+	 * 计算以相同参数绘制贴图时所用的顶点和贴图坐标, 但是不进行绘制. 渲染队列用它来合并相同贴图的矩形
+	 *
+	 * @param texCoords 返回矩形的贴图坐标
+	 * @param vertices 返回矩形的顶点
+	 * \endif
+	 */
+	void getQuad(float x, float y, float width, float height, float sourceWidth, float sourceHeight, bool flipX, bool flipY, wyRect texRect, bool rotatedZwoptex, wyQuad2D* texCoords, wyQuad3D* vertices);
+
 	/**
 	 * 得到原始图片的宽度
 	 *
@@ -37,6 +37,28 @@
 
 #define ATLAS_DEFAULT_CAPACITY 29
 
+/**
+ * @struct wyAtlasVertex
+ *
+ * \if English
+ * Interleaved vertex of \link wyTextureAtlas wyTextureAtlas\endlink, every quad has four
+ * vertices in the order of bottom left, bottom right, top left and top right
+ * \else
+ * \link wyTextureAtlas wyTextureAtlas\endlink 使用的交错顶点格式, 每个矩形有四个顶点,
+ * 顺序是左下, 右下, 左上, 右上
+ * \endif
+ */
+typedef struct wyAtlasVertex {
+	/// 顶点坐标
+	GLfloat x, y, z;
+
+	/// 贴图坐标
+	GLfloat u, v;
+
+	/// 顶点颜色, 只有打开颜色数组时才有效
+	wyColor4B color;
+} wyAtlasVertex;
+
 class wyTexture2D;
 class wyTextureAtlas;
 
@@ -69,21 +91,57 @@ protected:
 	bool m_withColorArray;
 
 	// buffers
-	/// 缓存openGL顶点
-	GLfloat* m_vertices;
+	/// 缓存openGL顶点, 顶点坐标, 贴图坐标和颜色交错存放, 每个矩形4个顶点
+	wyAtlasVertex* m_vertices;
+
+	/// 缓存openGL索引, 类型由m_indexType决定, 在第一次绘制时创建
+	void* m_indices;
+
+	/// 索引类型, GL_UNSIGNED_SHORT或GL_UNSIGNED_INT, 0表示还没有创建索引
+	GLenum m_indexType;
+
+	/// 索引覆盖的矩形个数, 也是一次绘制调用最多能画的矩形个数
+	int m_indexQuads;
+
+	/// true表示使用buffer object绘制
+	bool m_useBuffer;
+
+	/// 顶点buffer object
+	GLuint m_vbo;
+
+	/// 索引buffer object
+	GLuint m_ibo;
 
-	/// 缓存openGL纹理
-	GLfloat* m_texCoords;
+	/// 顶点buffer object中分配的矩形个数
+	int m_bufferCapacity;
 
-	/// 缓存openGL颜色
-	GLubyte* m_colors;
+	/// 索引buffer object中的矩形个数
+	int m_bufferIndexQuads;
 
-	/// 缓存openGL索引
-	GLushort* m_indices;
+	/// 创建buffer object时的世代, 和当前世代不同表示buffer object已经随着OpenGL环境丢失
+	int m_bufferGeneration;
+
+	/// 需要上传的矩形范围起点
+	int m_dirtyStart;
+
+	/// 需要上传的矩形范围终点, 不包括它, 小于等于起点表示没有需要上传的矩形
+	int m_dirtyEnd;
 
 	/// texture atlas渲染时用的颜色, 如果不设置, 则不打开颜色数组, 而由外部的glColor决定
 	wyColor4B m_color;
 
+	/// true表示删除的矩形变成退化矩形, 位置留给后面添加的矩形, 其它矩形的索引不会改变
+	bool m_stableSlots;
+
+	/// 固定位置模式下空闲的矩形位置
+	int* m_freeSlots;
+
+	/// 空闲位置的个数
+	int m_freeCount;
+
+	/// 空闲位置数组的容量
+	int m_freeCapacity;
+
 private:
 	/**
 	 * 更新缓存中的颜色
@@ -115,9 +173,50 @@ private:
 	void initColorArray();
 
 	/**
-	 * 初始化索引
+	 * 从缓存中读出顶点
+	 *
+	 * @param index 缓存中的位置
+	 * @param quadV 保存顶点的\link wyQuad3D wyQuad3D结构\endlink
 	 */
-	void initIndices();
+	void getVertex(int index, wyQuad3D* quadV);
+
+	/**
+	 * 从缓存中读出纹理
+	 *
+	 * @param index 缓存中的位置
+	 * @param quadT 保存纹理的\link wyQuad2D wyQuad2D结构\endlink
+	 */
+	void getTexCoords(int index, wyQuad2D* quadT);
+
+	/**
+	 * 标记一个范围的矩形需要重新上传到buffer object
+	 *
+	 * @param start 起始矩形
+	 * @param end 结束矩形, 不包括它
+	 */
+	void markDirty(int start, int end);
+
+	/**
+	 * 检查索引是否需要重新创建, 如果需要则重新创建
+	 *
+	 * @return 一次绘制调用最多能画的矩形个数
+	 */
+	int prepareIndices();
+
+	/**
+	 * 绑定buffer object并上传需要上传的矩形
+	 *
+	 * @return true表示绑定了buffer object, false表示使用客户端数组绘制
+	 */
+	bool prepareBuffer();
+
+	/**
+	 * 绘制一个范围的矩形, 如果矩形个数超过索引的范围, 会分成多次绘制调用
+	 *
+	 * @param start 起始矩形
+	 * @param count 矩形个数
+	 */
+	void drawQuads(int start, int count);
 
 public:
 	/**
@@ -166,7 +265,82 @@ public:
 	/**
 	 * 删除所有矩形
 	 */
-	void removeAllQuads() { m_totalQuads = 0; }
+	void removeAllQuads() { m_totalQuads = 0; m_freeCount = 0; }
+
+	/**
+	 * \if English
+	 * Enable or disable stable slot mode. In this mode, \link wyTextureAtlas::removeQuad removeQuad\endlink
+	 * doesn't move following quads, it turns the quad into a degenerate one and records the slot, and
+	 * \link wyTextureAtlas::appendQuad appendQuad\endlink reuses recorded slots first. So index of a quad
+	 * never changes and both methods cost O(1). Other methods which insert or remove quads still move quads,
+	 * so don't mix them with stable slot mode. It should be set before any quad is added.
+	 *
+	 * @param flag true means enable stable slot mode
+	 * \else
+	 * 打开或关闭固定位置模式. 在这个模式下, \link wyTextureAtlas::removeQuad removeQuad\endlink 不会移动后面的
+	 * 矩形, 而是把被删除的矩形变成退化矩形并记录它的位置, \link wyTextureAtlas::appendQuad appendQuad\endlink
+	 * 优先使用记录的位置. 因此矩形的索引不会改变, 两个方法的开销都是O(1). 其它插入或删除矩形的方法仍然会移动矩形,
+	 * 因此不要和固定位置模式混用. 应该在添加矩形之前设置.
+	 *
+	 * @param flag true表示打开固定位置模式
+	 * \endif
+	 */
+	void setStableSlots(bool flag);
+
+	/**
+	 * \if English
+	 * Is stable slot mode enabled?
+	 * \else
+	 * 是否打开了固定位置模式
+	 * \endif
+	 */
+	bool isStableSlots() { return m_stableSlots; }
+
+	/**
+	 * \if English
+	 * Get count of free slots in stable slot mode, they are degenerate quads
+	 * \else
+	 * 得到固定位置模式下空闲位置的个数, 它们都是退化矩形
+	 * \endif
+	 */
+	int getFreeSlotCount() { return m_freeCount; }
+
+	/**
+	 * \if English
+	 * Enable or disable buffer object mode. In this mode, quads are kept in a vertex buffer object
+	 * and only the range modified since last draw is uploaded, so a mostly static atlas doesn't
+	 * submit all its vertices every frame. If buffer object is not supported by OpenGL, atlas
+	 * still draws with client arrays. Default is disabled.
+	 *
+	 * @param flag true means enable buffer object mode
+	 * \else
+	 * 打开或关闭buffer object模式. 在这个模式下, 矩形保存在顶点buffer object中, 每次绘制只上传
+	 * 上次绘制之后被修改的范围, 因此基本不变的atlas不需要每帧提交全部顶点. 如果OpenGL不支持buffer
+	 * object, 则仍然用客户端数组绘制. 缺省是关闭的.
+	 *
+	 * @param flag true表示打开buffer object模式
+	 * \endif
+	 */
+	void setUseBufferObject(bool flag);
+
+	/**
+	 * \if English
+	 * Is buffer object mode enabled?
+	 * \else
+	 * 是否打开了buffer object模式
+	 * \endif
+	 */
+	bool isUseBufferObject() { return m_useBuffer; }
+
+	/**
+	 * \if English
+	 * Mark buffer objects of all atlases as lost, they will be recreated in next draw. It is called
+	 * by director when OpenGL context is recreated.
+	 * \else
+	 * 标记所有atlas的buffer object已经丢失, 它们会在下次绘制时重新创建. 在OpenGL环境重建时由导演类调用.
+	 * \endif
+	 */
+	static void invalidateAllBuffers();
 
 	/**
 	 * 获得下一个可用的矩形索引
@@ -184,6 +358,25 @@ public:
 	 */
 	void updateQuad(wyQuad2D& quadT, wyQuad3D& quadV, int index);
 
+	/**
+	 * \if English
+	 * Copy prepared vertices into atlas, they replace quads starting from index. Capacity
+	 * is enlarged if needed. Vertex color is used only when color array is enabled.
+	 *
+	 * @param vertices vertices to be copied, four for every quad
+	 * @param index index of first quad
+	 * @param count quad count
+	 * \else
+	 * 把准备好的顶点直接拷贝到缓存中, 替换从index开始的矩形. 如果容量不够会自动扩大. 顶点颜色
+	 * 只有在打开颜色数组时才有效.
+	 *
+	 * @param vertices 要拷贝的顶点, 每个矩形4个
+	 * @param index 第一个矩形的索引
+	 * @param count 矩形个数
+	 * \endif
+	 */
+	void copyQuads(const wyAtlasVertex* vertices, int index, int count);
+
 	/**
 	 * 更新缓存中的颜色
 	 *
@@ -206,7 +399,7 @@ public:
 	void updateColor(wyColor4B color);
 
 	/**
-	 * 在缓存中添加顶点和纹理,放到队列中最后
+	 * 在缓存中添加顶点和纹理,放到队列中最后. 如果打开了固定位置模式, 则优先使用空闲的位置
 	 *
 	 * @param quadT 纹理\link wyQuad2D wyQuad2D结构\endlink
 	 * @param quadV 顶点\link wyQuad3D wyQuad3D结构\endlink
@@ -226,7 +419,8 @@ public:
 
 	/**
 	 * 删除指定位置的Quad, 如果删除的是最后一个，则不需要额外操作，
-	 * 如果删除的是中间的，则最后一个Quad会被移动到被删除的位置
+	 * 如果删除的是中间的，则最后一个Quad会被移动到被删除的位置. 如果打开了固定位置模式,
+	 * 则Quad变成退化矩形, 位置被记录下来, 不要重复删除同一个位置
 	 *
 	 * @param index 缓存索引
 	 */
@@ -34,9 +34,52 @@
 #include "wyTexture2D.h"
 #include "wyTextureAtlas.h"
 #include "wyDirector.h"
+#include <pthread.h>
 
 class wyGLTexture2D;
 
+/**
+ * @typedef wyTextureLoadCallback
+ *
+ * \if English
+ * Callback of asynchronous texture loading, see \link wyTextureManager::makeAsync makeAsync\endlink.
+ * All methods are invoked in OpenGL thread.
+ * \else
+ * 异步载入贴图的回调, 参见\link wyTextureManager::makeAsync makeAsync\endlink. 所有方法都在OpenGL线程中调用.
+ * \endif
+ */
+typedef struct WIENGINE_API wyTextureLoadCallback {
+	/**
+	 * \if English
+	 * Invoked when texture is decoded and uploaded to OpenGL
+	 *
+	 * @param tex texture object, it is auto released so retain it if you want to keep it
+	 * @param data extra data pointer
+	 * \else
+	 * 当贴图解码完成并且已经上传到OpenGL时调用
+	 *
+	 * @param tex 贴图对象, 它是自动释放的, 如果需要保留请retain它
+	 * @param data 额外数据指针
+	 * \endif
+	 */
+	void (*onTextureLoaded)(wyTexture2D* tex, void* data);
+
+	/**
+	 * \if English
+	 * Invoked when image file can't be read or decoded
+	 *
+	 * @param path image path passed to \link wyTextureManager::makeAsync makeAsync\endlink
+	 * @param data extra data pointer
+	 * \else
+	 * 当图片文件无法读取或解码时调用
+	 *
+	 * @param path 传给\link wyTextureManager::makeAsync makeAsync\endlink的图片路径
+	 * @param data 额外数据指针
+	 * \endif
+	 */
+	void (*onTextureLoadFailed)(const char* path, void* data);
+} wyTextureLoadCallback;
+
 /**
  * @class wyTextureManager
  *
@@ -114,23 +157,50 @@ private:
 		/// 资源的inDensity
 		float inDensity;
 
-		/// 资源的md5字符串, 用来唯一标识贴图
-		const char* md5;
+		/// 64位键值, 由创建参数哈希得到, 用来唯一标识贴图
+		uint64_t key;
 
 		/// 贴图句柄
 		size_t handle;
 
+		/// true means this slot of handle table is used
+		bool used;
+
 		/// true means this texture is a cloned texture of other
 		bool isClone;
 
 		/// source handle, only used for cloned texture
 		size_t sourceHandle;
 
-		/// source md5, just a reference, don't release
-		const char* sourceMd5;
-
 		/// clone id, only used for cloned texture
 		int cloneId;
+
+		/// handle of first clone, -1 means no clone. Only used for source texture
+		int firstClone;
+
+		/// handle of next clone which has same source, -1 means end. Only used for cloned texture
+		int nextClone;
+	};
+
+	/// slot of key to handle table
+	struct wyHandleSlot {
+		/// key
+		uint64_t key;
+
+		/// handle, or SLOT_EMPTY, or SLOT_DELETED
+		int handle;
+	};
+
+	/// open addressing hash table which maps a 64 bits key to a handle
+	struct wyHandleTable {
+		/// slots, capacity is power of 2
+		wyHandleSlot* slots;
+
+		/// slot count
+		int capacity;
+
+		/// count of slots which are not empty, including deleted slots
+		int used;
 	};
 
 private:
@@ -140,8 +210,17 @@ private:
 	/// 当前贴图数量
 	int m_textureCount;
 
-	/// 所有可以通过某个键值查找的贴图对象哈希表
-	map<unsigned int, wyTextureHash>* m_textureHash;
+	/// 所有贴图的创建参数, 以句柄为访问索引
+	wyTextureHash* m_hashes;
+
+	/// 句柄表的容量
+	int m_handleCapacity;
+
+	/// 键值到句柄的哈希表
+	wyHandleTable m_keyTable;
+
+	/// (源句柄, 克隆id)到克隆贴图句柄的哈希表
+	wyHandleTable m_cloneTable;
 
 	/// idle gl texture handle list
 	vector<int>* m_idleHandles;
@@ -155,14 +234,151 @@ private:
 	/// 缺省贴图格式, 设置合适的贴图格式可以提高渲染速度, 缺省格式是RGBA8888
 	wyTexturePixelFormat m_texturePixelFormat;
 
+	/// job of asynchronous loading
+	struct wyAsyncTextureJob {
+		/// image path
+		const char* path;
+
+		/// true means path is a file system path
+		bool isFile;
+
+		/// pixel format
+		wyTexturePixelFormat format;
+
+		/// in density of image
+		float inDensity;
+
+		/// texture which is decoded in worker thread, NULL means texture is already cached
+		wyGLTexture2D* tex;
+
+		/// true means decoding failed
+		bool failed;
+
+		/// byte size which will be uploaded
+		size_t uploadBytes;
+
+		/// callback
+		wyTextureLoadCallback callback;
+
+		/// extra data of callback
+		void* data;
+
+		/// next job in queue
+		wyAsyncTextureJob* next;
+	};
+
+	/// mutex to protect async job queues
+	pthread_mutex_t m_asyncMutex;
+
+	/// head of jobs requested by makeAsync, waiting for OpenGL thread to dispatch them
+	wyAsyncTextureJob* m_requestHead;
+
+	/// tail of jobs requested by makeAsync
+	wyAsyncTextureJob* m_requestTail;
+
+	/// condition to wake up decode threads or wait them exit
+	pthread_cond_t m_asyncCond;
+
+	/// head of jobs waiting for decoding
+	wyAsyncTextureJob* m_decodeHead;
+
+	/// tail of jobs waiting for decoding
+	wyAsyncTextureJob* m_decodeTail;
+
+	/// head of jobs waiting for uploading
+	wyAsyncTextureJob* m_uploadHead;
+
+	/// tail of jobs waiting for uploading
+	wyAsyncTextureJob* m_uploadTail;
+
+	/// running decode thread count
+	int m_decodeThreadCount;
+
+	/// max decode thread count
+	int m_maxDecodeThreads;
+
+	/// true means decode threads should exit
+	bool m_asyncQuit;
+
+	/// pending async job count, changed atomically because makeAsync can be called in any thread
+	volatile int m_asyncJobCount;
+
+	/// max bytes uploaded in one frame
+	size_t m_uploadBudget;
+
 private:
 	wyTextureManager();
 
-	static void releaseTexHash(unsigned int key, wyTextureHash& hash);
+	/// entry of decode thread
+	void decodeThreadEntry(wyTargetSelector* ts);
+
+	/// append a job to a queue, caller must hold async mutex
+	static void appendJob(wyAsyncTextureJob*& head, wyAsyncTextureJob*& tail, wyAsyncTextureJob* job);
+
+	/// free a job
+	static void releaseJob(wyAsyncTextureJob* job);
+
+	/// look up cache for a requested job and queue it for decoding or uploading, called in OpenGL thread
+	void dispatchJob(wyAsyncTextureJob* job);
+
+	/// register decoded texture of a finished job and create texture proxy
+	wyTexture2D* finishJob(wyAsyncTextureJob* job);
+
+	static void releaseTexHash(wyTextureHash& hash);
+
+	static uint64_t keyForNum(int num);
+	static uint64_t keyForStr(const char* str);
+	static uint64_t keyForData(const void* data, size_t length);
+
+	/// key of clone table
+	static uint64_t keyForClone(size_t sourceHandle, int cloneId);
+
+	/// init a handle table
+	static void initHandleTable(wyHandleTable& table, int capacity);
 
-	const char* hashForNum(int num);
-	const char* hashForStr(const char* str);
-	const char* hashForData(const void* data, size_t length);
+	/// find handle of a key, return -1 if not found
+	static int findHandle(wyHandleTable& table, uint64_t key);
+
+	/// add a key to table, key must not exist in table
+	static void insertHandle(wyHandleTable& table, uint64_t key, int handle);
+
+	/// remove a key from table
+	static void removeHandle(wyHandleTable& table, uint64_t key);
+
+	/**
+	 * 根据键值查找贴图的创建参数
+	 *
+	 * @param key 键值
+	 * @return 贴图的创建参数, 如果没有找到返回NULL. 在分配新句柄后指针可能失效
+	 */
+	wyTextureHash* findHash(uint64_t key);
+
+	/**
+	 * 得到代理贴图对应的创建参数
+	 *
+	 * @param t \link wyTexture2D wyTexture2D\endlink
+	 * @return 贴图的创建参数, 如果句柄已经被删除或被重用, 返回NULL
+	 */
+	wyTextureHash* hashOf(wyTexture2D* t);
+
+	/**
+	 * 分配一个新句柄并初始化它的创建参数, 但是不加入键值表
+	 *
+	 * @param key 键值
+	 * @param type 创建类型
+	 * @return 新句柄
+	 */
+	size_t newHash(uint64_t key, wyTextureCreationType type);
+
+	/**
+	 * 删除一个句柄的创建参数, 把它从键值表中删除并回收句柄
+	 *
+	 * @param handle 句柄
+	 */
+	void removeHash(size_t handle);
+
+	/// create a texture proxy for a handle
+	wyTexture2D* makeProxy(size_t handle);
 
 	/**
 	 * 得到下一个可用句柄
@@ -192,8 +408,8 @@ private:
 	/// clone a texture, with a given clone id
 	wyTexture2D* cloneTexture(wyTexture2D* t, int cloneId);
 
-	/// clone a texture, but hash is given
-	wyTexture2D* cloneTexture(wyTexture2D* t, int sourceHandle, const char* md5, int cloneId);
+	/// clone a texture, but source handle is given
+	wyTexture2D* cloneTexture(wyTexture2D* t, size_t sourceHandle, int cloneId);
 
 	/**
 	 * switch a proxy texture to a cloned proxy
@@ -213,13 +429,13 @@ private:
 	bool deleteClonedTexture(wyTexture2D* t, int cloneId);
 
 	/**
-	 * create wyGLTexture2D for a md5 hash
+	 * create wyGLTexture2D for a handle
 	 *
-	 * @param md5 md5 for this texture
+	 * @param handle handle of texture
 	 * @param t only used for create a label texture because label info is saved in wyTexture2D,
 	 * 		may refactor this
 	 */
-	wyGLTexture2D* createGLTexture(const char* md5, wyTexture2D* t);
+	wyGLTexture2D* createGLTexture(size_t handle, wyTexture2D* t);
 
 	/// clear cloned textures
 	void releaseClonedTexture(int sourceHandle, bool removeHandle = false);
@@ -231,6 +447,13 @@ protected:
 	 */
 	void invalidateAllTextures();
 
+	/**
+	 * Upload textures decoded by worker threads and invoke callbacks, it is called by
+	 * director in every frame. It stops when upload budget is used up but at least one
+	 * texture is uploaded.
+	 */
+	void processAsyncUploads();
+
 public:
 	static wyTextureManager* getInstance();
 	static wyTextureManager* getInstanceNoCreate();
@@ -298,6 +521,92 @@ public:
 	 * @return 贴图格式
 	 */
 	wyTexturePixelFormat getTexturePixelFormat() { return m_texturePixelFormat; }
+
+	/**
+	 * \if English
+	 * Load a texture asynchronously. Image file reading, decoding, scaling and pixel format
+	 * conversion are done in decode threads, only OpenGL uploading is done in OpenGL thread and
+	 * uploaded bytes in every frame is limited by upload budget. This method can be called in
+	 * any thread, the request is queued and OpenGL thread looks up texture cache when it dispatches
+	 * the request. Callback is always invoked in OpenGL thread, in next frame if texture is already cached.
+	 *
+	 * @param path image path
+	 * @param format pixel format of texture
+	 * @param callback callback, it will be copied
+	 * @param data extra data pointer which will be passed to callback
+	 * @param isFile true means \c path is an absolute path in file system, false means it is
+	 * 		a relative path in assets
+	 * @param inDensity density of image file, zero means uses system default setting
+	 * \else
+	 * 异步载入一个贴图. 图片文件的读取, 解码, 缩放和格式转换都在解码线程中进行, 只有上传到OpenGL
+	 * 是在OpenGL线程中进行, 并且每帧上传的字节数受上传预算限制. 这个方法可以在任何线程中调用, 请求会被
+	 * 放入队列, 由OpenGL线程在分派请求时查找贴图缓存. 回调总是在OpenGL线程中被调用, 如果贴图已经被缓存,
+	 * 则回调会在下一帧被调用.
+	 *
+	 * @param path 图片路径
+	 * @param format 贴图格式
+	 * @param callback 回调, 会被复制
+	 * @param data 额外数据指针, 会被传给回调
+	 * @param isFile true表示\c path是文件系统的绝对路径, false表示是assets中的相对路径
+	 * @param inDensity 图片的density, 0表示使用系统缺省设置
+	 * \endif
+	 */
+	void makeAsync(const char* path, wyTexturePixelFormat format, wyTextureLoadCallback* callback, void* data = NULL, bool isFile = false, float inDensity = 0);
+
+	/**
+	 * \if English
+	 * Set max count of decode threads, default is 2. Threads are created when they are needed,
+	 * so decreasing it doesn't stop running threads.
+	 *
+	 * @param count max decode thread count, must be larger than zero
+	 * \else
+	 * 设置最大解码线程数, 缺省是2. 线程在需要时才会被创建, 因此减小它不会停止已经运行的线程.
+	 *
+	 * @param count 最大解码线程数, 必须大于0
+	 * \endif
+	 */
+	void setMaxDecodeThreads(int count) { m_maxDecodeThreads = MAX(1, count); }
+
+	/**
+	 * \if English
+	 * Get max count of decode threads
+	 * \else
+	 * 得到最大解码线程数
+	 * \endif
+	 */
+	int getMaxDecodeThreads() { return m_maxDecodeThreads; }
+
+	/**
+	 * \if English
+	 * Set max bytes which can be uploaded in one frame, default is 2MB. At least one texture
+	 * is uploaded in one frame even if it is larger than budget.
+	 *
+	 * @param bytes upload budget in bytes
+	 * \else
+	 * 设置每帧最多上传的字节数, 缺省是2MB. 每帧至少会上传一个贴图, 即使它比预算大.
+	 *
+	 * @param bytes 上传预算, 单位是字节
+	 * \endif
+	 */
+	void setUploadBudget(size_t bytes) { m_uploadBudget = bytes; }
+
+	/**
+	 * \if English
+	 * Get max bytes which can be uploaded in one frame
+	 * \else
+	 * 得到每帧最多上传的字节数
+	 * \endif
+	 */
+	size_t getUploadBudget() { return m_uploadBudget; }
+
+	/**
+	 * \if English
+	 * Get count of asynchronous loading which are not finished
+	 * \else
+	 * 得到尚未完成的异步载入数目
+	 * \endif
+	 */
+	int getPendingAsyncCount() { return m_asyncJobCount; }
 };
 
 #endif // __wyTextureManager_h__
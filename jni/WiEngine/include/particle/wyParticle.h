@@ -203,6 +203,169 @@ typedef struct WIENGINE_API wyParticle {
  */
 WIENGINE_API wyParticle* wyParticleNew();
 
+/**
+ * @struct wyParticleBuffer
+ *
+ * \if English
+ * Particle storage in structure of arrays layout. Every field of \link wyParticle wyParticle\endlink
+ * is stored in a separated float array, all arrays are allocated in one memory block and
+ * have same capacity. Live particles are always packed in [0, count), so a dead particle
+ * is removed by moving last live particle to its slot. Such layout lets particle update
+ * loops walk contiguous memory and can be vectorized by compiler.
+ * \else
+ * 以数组结构体方式保存的粒子数据. \link wyParticle wyParticle\endlink 的每个字段都保存在单独的
+ * 浮点数组中, 所有数组在一块内存中分配并且容量相同. 活动的粒子总是紧密排列在[0, count)中, 因此
+ * 删除一个粒子只需要把最后一个粒子移动到它的位置. 这样粒子更新循环访问的是连续内存, 可以被编译器向量化.
+ * \endif
+ */
+typedef struct WIENGINE_API wyParticleBuffer {
+	/// capacity of every array
+	int capacity;
+
+	/// x of current position
+	float* posX;
+
+	/// y of current position
+	float* posY;
+
+	/// x of init position when the particle is emitted
+	float* startPosX;
+
+	/// y of init position when the particle is emitted
+	float* startPosY;
+
+	/// red component of color
+	float* r;
+
+	/// green component of color
+	float* g;
+
+	/// blue component of color
+	float* b;
+
+	/// alpha component of color
+	float* a;
+
+	/// red delta per second
+	float* deltaR;
+
+	/// green delta per second
+	float* deltaG;
+
+	/// blue delta per second
+	float* deltaB;
+
+	/// alpha delta per second
+	float* deltaA;
+
+	/// particle size
+	float* size;
+
+	/// size delta per second
+	float* deltaSize;
+
+	/// rotation in degrees
+	float* rotation;
+
+	/// rotation delta per second
+	float* deltaRotation;
+
+	/// time to live, in seconds
+	float* timeToLive;
+
+	/// x of direction, gravity mode only
+	float* dirX;
+
+	/// y of direction, gravity mode only
+	float* dirY;
+
+	/// radial acceleration, gravity mode only
+	float* radialAccel;
+
+	/// tangential acceleration, gravity mode only
+	float* tangentialAccel;
+
+	/// radian position, radius mode only
+	float* radian;
+
+	/// radian delta per second, radius mode only
+	float* radianPerSecond;
+
+	/// distance to particle system position, radius mode only
+	float* radius;
+
+	/// radius delta per second, radius mode only
+	float* deltaRadius;
+
+	/// x of position used to render particle, it is calculated in every update
+	float* drawX;
+
+	/// y of position used to render particle, it is calculated in every update
+	float* drawY;
+} wyParticleBuffer;
+
+/**
+ * \if English
+ * Create a particle buffer
+ *
+ * @param capacity max particle count in this buffer
+ * @return \link wyParticleBuffer wyParticleBuffer\endlink
+ * \else
+ * 创建一个粒子数据缓冲区
+ *
+ * @param capacity 缓冲区中可以保存的最大粒子数
+ * @return \link wyParticleBuffer wyParticleBuffer\endlink
+ * \endif
+ */
+WIENGINE_API wyParticleBuffer* wyParticleBufferNew(int capacity);
+
+/**
+ * \if English
+ * Destroy a particle buffer
+ *
+ * @param buffer \link wyParticleBuffer wyParticleBuffer\endlink
+ * \else
+ * 销毁一个粒子数据缓冲区
+ *
+ * @param buffer \link wyParticleBuffer wyParticleBuffer\endlink
+ * \endif
+ */
+WIENGINE_API void wyParticleBufferDestroy(wyParticleBuffer* buffer);
+
+/**
+ * \if English
+ * Copy all fields of a particle to another slot
+ *
+ * @param buffer \link wyParticleBuffer wyParticleBuffer\endlink
+ * @param from index of source particle
+ * @param to index of destination slot
+ * \else
+ * 把一个粒子的所有字段复制到另一个位置
+ *
+ * @param buffer \link wyParticleBuffer wyParticleBuffer\endlink
+ * @param from 源粒子的索引
+ * @param to 目标位置的索引
+ * \endif
+ */
+WIENGINE_API void wyParticleBufferMove(wyParticleBuffer* buffer, int from, int to);
+
+/**
+ * \if English
+ * Read a particle from buffer
+ *
+ * @param buffer \link wyParticleBuffer wyParticleBuffer\endlink
+ * @param index index of particle
+ * @param particle \link wyParticle wyParticle\endlink to save particle data
+ * \else
+ * 从缓冲区中读取一个粒子
+ *
+ * @param buffer \link wyParticleBuffer wyParticleBuffer\endlink
+ * @param index 粒子的索引
+ * @param particle 用来保存粒子数据的\link wyParticle wyParticle\endlink
+ * \endif
+ */
+WIENGINE_API void wyParticleBufferGet(wyParticleBuffer* buffer, int index, wyParticle* particle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -205,8 +205,8 @@ protected:
 	/// 粒子结束自转角度变化量
 	float m_endSpinVar;
 
-	/// 粒子数组指针
-	wyArray* m_particles;
+	/// 粒子数据, 以数组结构体方式保存, 活动粒子在[0, m_particleCount)中
+	wyParticleBuffer* m_particles;
 
 	/// 最大粒子数
 	int m_maxParticles;
@@ -297,8 +297,15 @@ protected:
 	/// 旋转角度变化量
 	float m_rotationDegreeVar;
 
+	/// 粒子初始化使用的随机数种子
+	unsigned int m_randSeed;
+
 private:
-	static bool releaseParticle(wyArray* arr, void* ptr, int index, void* data);
+	/// 更新所有粒子的运动, 重力模式
+	void updateGravityMode(float dt);
+
+	/// 更新所有粒子的运动, 半径模式
+	void updateRadiusMode(float dt);
 
 protected:
 	/**
@@ -307,12 +314,10 @@ protected:
 	virtual void postStep() = 0;
 
 	/**
-	 * 粒子更新函数
-	 *
-	 * @param particle 待更新的例子
-	 * @param newPosition 粒子的新坐标
+	 * 粒子更新后调用此函数更新顶点数据. 调用时活动粒子数为m_particleCount, 每个粒子的
+	 * 绘制位置已经保存在m_particles的drawX和drawY数组中
 	 */    
-	virtual void updateQuadWithParticle(wyParticle* particle, wyPoint newPosition) = 0;
+	virtual void updateParticleVertices() = 0;
 
 	/**
 	 * 判断当前粒子数是否已满
@@ -331,9 +336,20 @@ protected:
 	/**
 	 * 初始化粒子
 	 *
-	 * @param particle 待初始化的粒子
+	 * @param index 待初始化的粒子在m_particles中的索引
 	 */ 		
-	void initParticle(wyParticle* particle);
+	void initParticle(int index);
+
+	/**
+	 * 返回-1到1之间的随机数, 粒子初始化需要大量随机数, 因此使用一个简单的xorshift
+	 * 生成器代替rand()
+	 */
+	float randMinusOneToOne() {
+		m_randSeed ^= m_randSeed << 13;
+		m_randSeed ^= m_randSeed >> 17;
+		m_randSeed ^= m_randSeed << 5;
+		return (float)(m_randSeed & 0xFFFFFF) * (2.f / 0xFFFFFF) - 1.f;
+	}
 
 public:
 	/**
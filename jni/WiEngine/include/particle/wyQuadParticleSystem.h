@@ -58,8 +58,8 @@ protected:
 	/// @see wyParticleSystem::postStep
 	virtual void postStep();
 	
-	/// @see wyParticleSystem::updateQuadWithParticle
-	virtual void updateQuadWithParticle(wyParticle* particle, wyPoint newPosition);
+	/// @see wyParticleSystem::updateParticleVertices
+	virtual void updateParticleVertices();
 
 	/**
 	 * 初始化贴图坐标数组，用于opengl画图
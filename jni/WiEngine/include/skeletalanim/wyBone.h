@@ -89,10 +89,9 @@ private:
 
     /// flags
     int m_flags;
-	
-	/// state map
-	typedef map<wySkeletalSprite*, State> StateMap;
-	StateMap m_stateMap;
+
+	/// index in skeleton, -1 if not added to a skeleton
+	int m_index;
 
 protected:
 	wyBone();
@@ -100,6 +99,11 @@ protected:
 	/// set parent
 	void setParent(wyBone* parent) { m_parent = parent; }
 
+	/// set index, only called by skeleton
+	void setIndex(int index) { m_index = index; }
+
+	friend class wySkeleton;
+
 public:
 	virtual ~wyBone();
 
@@ -125,11 +129,8 @@ public:
 	/// get length
 	float getLength() { return m_length; }
 	
-	/// get bone state for an owner
-	State& getState(wySkeletalSprite* owner);
-	
-	/// remove state for an owner
-	void clearState(wySkeletalSprite* owner);
+	/// get index in skeleton, bone state of a sprite is stored at this index
+	int getIndex() { return m_index; }
 
 	/// get original x offset
 	State& getOriginalState() { return m_originalState; }
@@ -84,9 +84,27 @@ private:
 	/// key frame list of scale
 	typedef vector<ScaleKeyFrame> ScaleKeyFrameList;
 	ScaleKeyFrameList m_skfList;
+
+	/// key frame cursors used by populateFrame
+	int m_cursors[3];
 	
 protected:
 	wyBoneTransform();
+
+	/// @see wyTransform::findTarget
+	virtual int findTarget(wySkeleton* s);
+
+	/// get rotation at a time, return false if there is no rotation key frame
+	bool getRotationAt(float time, int& cursor, float& angle);
+
+	/// get translation at a time, return false if there is no translation key frame
+	bool getTranslationAt(float time, int& cursor, float& x, float& y);
+
+	/// get scale at a time, return false if there is no scale key frame
+	bool getScaleAt(float time, int& cursor, float& scaleX, float& scaleY);
+
+	/// mix frame values into bone pose of owner
+	bool applyFrame(wySkeletalSprite* owner, RotationKeyFrame& r, TranslationKeyFrame& t, ScaleKeyFrame& s, float weight, bool additive);
 	
 public:
 	virtual ~wyBoneTransform();
@@ -97,6 +115,12 @@ public:
 	
 	/// @see wyTransform::applyTo
 	virtual bool applyTo(wySkeletalSprite* owner);
+
+	/// @see wyTransform::applyTo
+	virtual bool applyTo(wySkeletalSprite* owner, float time, int* cursors, float weight, bool additive);
+
+	/// @see wyTransform::getCursorCount
+	virtual int getCursorCount() { return 3; }
 	
 	/// @see wyTransform::dump
 	virtual void dump();
@@ -34,6 +34,10 @@
 #include "wySkeletalAnimation.h"
 #include "wySpriteEx.h"
 #include "wySkeletalAnimationListener.h"
+#include "wyTextureAtlas.h"
+
+/// max count of animation layers of a skeletal sprite
+#define SKELETAL_MAX_LAYERS 4
 
 /**
  * sprite can play skeletal animation
@@ -42,6 +46,37 @@
  * by default, its content size is zero
  */
 class WIENGINE_API wySkeletalSprite : public wyNode {
+	friend class wyBoneTransform;
+	friend class wySlotTransform;
+
+private:
+	/// animation layer which is mixed over current animation
+	struct Layer {
+		/// animation, NULL means layer is empty
+		wySkeletalAnimation* animation;
+
+		/// layer time, layer animation always loops
+		float time;
+
+		/// current mix weight
+		float weight;
+
+		/// weight which current weight is fading to
+		float targetWeight;
+
+		/// weight change per second
+		float fadeSpeed;
+
+		/// true means key frames are added to pose as offsets
+		bool additive;
+
+		/// key frame cursors
+		int* cursors;
+
+		/// capacity of cursor array
+		int cursorCapacity;
+	};
+
 private:
 	/// skeleton
 	wySkeleton* m_skeleton;
@@ -66,6 +101,68 @@ private:
 	
 	/// listener
 	wySkeletalAnimationListener* m_listener;
+
+	/// bone count of skeleton
+	int m_boneCount;
+
+	/// bone pose, structure of arrays indexed by bone index. all float arrays are in one memory block
+	float* m_boneX;
+	float* m_boneY;
+	float* m_boneRotation;
+	float* m_boneScaleX;
+	float* m_boneScaleY;
+
+	/// bone transforms relative to this node, indexed by bone index. updated once per frame
+	wyAffineTransform* m_boneTransforms;
+
+	/// slot count of skeleton
+	int m_slotCount;
+
+	/// slot colors in argb format, indexed by slot index
+	int* m_slotColors;
+
+	/// active attachment name of slots, indexed by slot index. they are not copied
+	const char** m_slotAttachmentNames;
+
+	/// slot sprites, indexed by slot index. they are not in node tree, only hold texture and
+	/// color of slot and are drawn by this node
+	wySpriteEx** m_slotSprites;
+
+	/// quads of slots, used when render queue can't batch this node
+	wyTextureAtlas* m_atlas;
+
+	/// key frame cursors of current animation, every transform takes some of them
+	int* m_cursors;
+
+	/// capacity of key frame cursor array
+	int m_cursorCapacity;
+
+	/// animation which is fading out in cross fading, NULL if not cross fading
+	wySkeletalAnimation* m_fadeAnimation;
+
+	/// time of fading out animation
+	float m_fadeTime;
+
+	/// loop flag of fading out animation
+	int m_fadeLoop;
+
+	/// cross fading duration
+	float m_fadeDuration;
+
+	/// elapsed time of cross fading
+	float m_fadeElapsed;
+
+	/// key frame cursors of fading out animation
+	int* m_fadeCursors;
+
+	/// capacity of fading out cursor array
+	int m_fadeCursorCapacity;
+
+	/// animation layers, they are preallocated so mixing doesn't allocate memory
+	Layer m_layers[SKELETAL_MAX_LAYERS];
+
+	/// true means last frame is mixed, so pose should be rebuilt from original state
+	bool m_mixedLastFrame;
 	
 protected:
 	wySkeletalSprite();
@@ -81,23 +178,41 @@ protected:
 	 */
 	void setFrame(float time);
 	
-	/// create bone nodes
-	void createBoneNodes(wyBone* bone);
-	
 	/// create slot sprites
 	void createSlotSprites();
 	
-	/// clean cached bone state of this node
-	void clearBoneStates(wyBone* bone);
+	/// allocate bone and slot state arrays and fill them with original state
+	void createStates();
 	
-	/// clean cached slot state of this node
-	void cleanSlotStates();
+	/// release bone and slot state arrays
+	void releaseStates();
 	
-	/// sync original bone state to bone node
-	void syncOriginalBoneStates(wyBone* bone);
+	/// reset bone state to original state
+	void syncOriginalBoneStates();
 	
-	/// sync bone state to bone node
-	void syncBoneStates(wyBone* bone);
+	/// calculate transform of all bones from bone state, in one pass from root to leaves
+	void updateBoneTransforms();
+
+	/// start an animation without stopping current one
+	void startAnimation(wySkeletalAnimation* anim);
+
+	/// ensure cursor array is enough for an animation and reset cursors to zero
+	static void prepareCursors(wySkeletalAnimation* anim, int*& cursors, int& capacity);
+
+	/// mix an animation frame into pose
+	void applyAnimation(wySkeletalAnimation* anim, float time, int* cursors, float weight, bool additive);
+
+	/// advance cross fading and layers, return true if pose needs mixing
+	bool updateMix(float delta);
+
+	/// is cross fading or any layer active?
+	bool isMixing();
+
+	/// draw slot quads in display order, by render queue or by own atlas
+	void drawSlots();
+
+	/// draw quads in atlas which use same texture and blend function
+	void drawAtlasRun(int start, int count, wyTexture2D* tex, wyBlendFunc blendFunc);
 	
 	/// sync skin attachment state to slot sprite
 	void syncAttachmentStates();
@@ -147,6 +262,12 @@ public:
 	
 	/// get skeleton
 	wySkeleton* getSkeleton() { return m_skeleton; }
+
+	/// get sprite of a slot, by slot index
+	wySpriteEx* getSlotSprite(int index) { return (index >= 0 && index < m_slotCount) ? m_slotSprites[index] : NULL; }
+
+	/// get active attachment name of a slot, by slot index. caller should NOT release it
+	const char* getSlotAttachmentName(int index) { return (index >= 0 && index < m_slotCount) ? m_slotAttachmentNames[index] : NULL; }
 	
 	/// play an animation, that will stop current animation if any
 	void playAnimation(wySkeletalAnimation* anim);
@@ -158,6 +279,68 @@ public:
 	 *		before calling this method. otherwise nothing will happen
 	 */
 	void playAnimation(const char* animName);
+
+	/**
+	 * play an animation and cross fade from current animation. current animation keeps
+	 * playing and its weight goes down to zero in fade duration
+	 *
+	 * @param anim new animation
+	 * @param fadeDuration cross fading duration, in second. if it is zero or no animation
+	 * 		is playing, new animation is played directly
+	 */
+	void playAnimation(wySkeletalAnimation* anim, float fadeDuration);
+
+	/**
+	 * play an animation and cross fade from current animation
+	 *
+	 * @param animName animation key in skeletal animation cache
+	 * @param fadeDuration cross fading duration, in second
+	 */
+	void playAnimation(const char* animName, float fadeDuration);
+
+	/// is cross fading?
+	bool isCrossFading() { return m_fadeAnimation != NULL; }
+
+	/**
+	 * set animation of a layer. layer animation loops forever and is mixed over current
+	 * animation by weight, it is useful for motions such as aiming or breathing. layers are
+	 * mixed in index order after current animation
+	 *
+	 * @param layer layer index, from 0 to SKELETAL_MAX_LAYERS - 1
+	 * @param anim layer animation
+	 * @param weight mix weight, from 0 to 1
+	 * @param additive true means key frames are added to pose as offsets from original
+	 * 		state, false means pose is interpolated to key frames
+	 */
+	void setLayerAnimation(int layer, wySkeletalAnimation* anim, float weight = 1.f, bool additive = false);
+
+	/**
+	 * set animation of a layer
+	 *
+	 * @param layer layer index, from 0 to SKELETAL_MAX_LAYERS - 1
+	 * @param animName animation key in skeletal animation cache
+	 * @param weight mix weight, from 0 to 1
+	 * @param additive true means key frames are added to pose as offsets
+	 */
+	void setLayerAnimation(int layer, const char* animName, float weight = 1.f, bool additive = false);
+
+	/// remove animation of a layer
+	void clearLayer(int layer);
+
+	/**
+	 * change weight of a layer
+	 *
+	 * @param layer layer index
+	 * @param weight new weight, from 0 to 1
+	 * @param fadeDuration time to reach new weight, in second. zero means change immediately
+	 */
+	void setLayerWeight(int layer, float weight, float fadeDuration = 0);
+
+	/// get current weight of a layer
+	float getLayerWeight(int layer) { return (layer >= 0 && layer < SKELETAL_MAX_LAYERS) ? m_layers[layer].weight : 0; }
+
+	/// get animation of a layer
+	wySkeletalAnimation* getLayerAnimation(int layer) { return (layer >= 0 && layer < SKELETAL_MAX_LAYERS) ? m_layers[layer].animation : NULL; }
 	
 	/// get animation
 	wySkeletalAnimation* getAnimation() { return m_animation; }
@@ -50,6 +50,9 @@ public:
 	
 	/// slot list type
 	typedef vector<wySlot*> SlotPtrList;
+
+	/// bone list type
+	typedef vector<wyBone*> BonePtrList;
     
     /// default skin name
     static const char* DEFALT_SKIN_NAME;
@@ -67,8 +70,31 @@ private:
     typedef map<const char*, wySkin*, wyStrPredicate> SkinMap;
     SkinMap m_skinMap;
 
-	/// slot display list
+	/// slot display list, slot index is its position in this list
 	SlotPtrList m_slotDisplayList;
+
+	/// bone list, bone index is its position in this list
+	BonePtrList m_boneList;
+
+	/// unique id of this skeleton, used to check whether cached indices are resolved from it
+	int m_id;
+
+	/// setup data shared by all sprites of this skeleton, they are built when first requested
+	/// parent bone index of every bone, -1 for root
+	int* m_boneParents;
+
+	/// bone indices sorted so that parent is always before child
+	int* m_boneUpdateOrder;
+
+	/// bone index of every slot
+	int* m_slotBones;
+
+	/// true means setup data should be rebuilt
+	bool m_setupDirty;
+
+protected:
+	/// build setup data if bones or slots are changed
+	void buildSetupData();
 	
 	/// source to load related resource
 	Source m_source;
@@ -109,6 +135,33 @@ public:
 	
 	/// get slot display list
 	SlotPtrList& getSlotDisplayList() { return m_slotDisplayList; }
+
+	/// get bone list, bones are ordered by index
+	BonePtrList& getBoneList() { return m_boneList; }
+
+	/// get bone count
+	int getBoneCount() { return m_boneList.size(); }
+
+	/// get slot count
+	int getSlotCount() { return m_slotDisplayList.size(); }
+
+	/// get bone index by name, or -1 if not found
+	int getBoneIndex(const char* name);
+
+	/// get slot index by name, or -1 if not found
+	int getSlotIndex(const char* name);
+
+	/// get unique id of this skeleton
+	int getId() { return m_id; }
+
+	/// get parent bone index of every bone, -1 means root. it is shared by all sprites, don't modify it
+	int* getBoneParents() { buildSetupData(); return m_boneParents; }
+
+	/// get bone indices in update order, parent is always before its children. don't modify it
+	int* getBoneUpdateOrder() { buildSetupData(); return m_boneUpdateOrder; }
+
+	/// get bone index of every slot, don't modify it
+	int* getSlotBones() { buildSetupData(); return m_slotBones; }
 	
 	/// set source
 	void setSource(Source s) { m_source = s; }
@@ -81,14 +81,18 @@ private:
     
     /// flags
     int m_flags;
-	
-	/// state map for owner
-	typedef map<wySkeletalSprite*, State> StateMap;
-	StateMap m_stateMap;
+
+	/// index in skeleton, it is same as position in display list. -1 if not added to a skeleton
+	int m_index;
 
 protected:
 	wySlot(wyBone* bone);
 
+	/// set index, only called by skeleton
+	void setIndex(int index) { m_index = index; }
+
+	friend class wySkeleton;
+
 public:
 	virtual ~wySlot();
 
@@ -117,11 +121,8 @@ public:
 	/// get original state
 	State& getOriginalState() { return m_originalState; }
 	
-	/// get state for an owner
-	State& getState(wySkeletalSprite* owner);
-	
-	/// clear state of an owner
-	void clearState(wySkeletalSprite* owner);
+	/// get index in skeleton, slot state of a sprite is stored at this index
+	int getIndex() { return m_index; }
     
     /// add a flag
     void addFlag(Flag f) { m_flags |= f; }
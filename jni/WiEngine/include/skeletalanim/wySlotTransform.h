@@ -68,9 +68,24 @@ private:
 	/// key frame of slot color
 	typedef vector<ColorKeyFrame> ColorKeyFrameList;
 	ColorKeyFrameList m_ckfList;
+
+	/// key frame cursors used by populateFrame
+	int m_cursors[2];
 	
 protected:
 	wySlotTransform();
+
+	/// @see wyTransform::findTarget
+	virtual int findTarget(wySkeleton* s);
+
+	/// get skin name at a time, return false if there is no skin key frame
+	bool getSkinAt(float time, int& cursor, const char*& skinName);
+
+	/// get color at a time, return false if there is no color key frame
+	bool getColorAt(float time, int& cursor, int& color);
+
+	/// mix frame values into slot state of owner
+	bool applyFrame(wySkeletalSprite* owner, SkinKeyFrame& skin, ColorKeyFrame& color, float weight, bool additive);
 	
 public:
 	virtual ~wySlotTransform();
@@ -81,6 +96,12 @@ public:
 	
 	/// @see wyTransform::applyTo
 	virtual bool applyTo(wySkeletalSprite* owner);
+
+	/// @see wyTransform::applyTo
+	virtual bool applyTo(wySkeletalSprite* owner, float time, int* cursors, float weight, bool additive);
+
+	/// @see wyTransform::getCursorCount
+	virtual int getCursorCount() { return 2; }
 	
 	/// @see wyTransform::dump
 	virtual void dump();
@@ -33,6 +33,7 @@
 #include "wyTypes.h"
 
 class wySkeletalSprite;
+class wySkeleton;
 
 /**
  * transform base class
@@ -77,11 +78,34 @@ public:
 		bool valid;
 	};
 	
+protected:
+	/// id of skeleton which target index is resolved from, zero means not resolved
+	int m_skeletonId;
+
+	/// cached index of target bone or slot, -1 means not found
+	int m_targetIndex;
+
 protected:
 	wyTransform();
 	
 	/// get interpolation time, from 0 to 1
 	wyPoint getInterpolationTime(float startTime, float endTime, float curTime, Interpolator& interpolator);
+
+	/// find target index in a skeleton by name, subclass should implement it
+	virtual int findTarget(wySkeleton* s) = 0;
+
+	/**
+	 * find key frame which is at or before a time, by binary search
+	 *
+	 * @param times address of time of first key frame
+	 * @param stride byte distance between two key frames
+	 * @param count key frame count
+	 * @param time time to seek
+	 * @param cursor last found key frame index, it is checked first so sequential playback
+	 * 		doesn't need searching. It is updated to found index
+	 * @return index of key frame, or -1 if time is before first key frame
+	 */
+	static int seekKeyFrame(const float* times, size_t stride, int count, float time, int& cursor);
 	
 public:
 	virtual ~wyTransform();
@@ -96,6 +120,33 @@ public:
 	 * @return true if frame is applied, or false if not applied
 	 */
 	virtual bool applyTo(wySkeletalSprite* owner) = 0;
+
+	/**
+	 * calculate frame of a time and mix it into pose of a skeleton directly, current frame of
+	 * transform is not changed so a transform can be shared by many sprites
+	 *
+	 * @param owner the target to apply transform
+	 * @param time animation time
+	 * @param cursors key frame cursors of owner, count is \c getCursorCount
+	 * @param weight mix weight, 1 means frame replaces current pose, less than 1 means frame is
+	 * 		interpolated with current pose
+	 * @param additive true means frame is an offset from original state and it is added to current
+	 * 		pose, scaled by weight
+	 * @return true if frame is applied, or false if not applied
+	 */
+	virtual bool applyTo(wySkeletalSprite* owner, float time, int* cursors, float weight, bool additive) = 0;
+
+	/// get count of key frame cursors needed by this transform
+	virtual int getCursorCount() = 0;
+
+	/**
+	 * get index of target bone or slot in a skeleton. it is searched by name only when
+	 * skeleton is changed
+	 *
+	 * @param s skeleton
+	 * @return index of target, or -1 if not found
+	 */
+	int resolveTarget(wySkeleton* s);
 	
 	/// dump info, for debug purpose
 	virtual void dump() {}
@@ -38,6 +38,7 @@
 
 class wyTMXTileMap;
 struct wyTileSetAtlasInfo;
+struct wyTMXChunk;
 
 /**
  * @class wyTMXLayer
@@ -45,6 +46,14 @@ struct wyTileSetAtlasInfo;
  * 代表了TMX地图中的一个层, 提供了获取层信息的各种方法. 层是可写的, 可以通过相应方法
  * 动态的修改瓦片. 层的坐标从左上角开始，x往右增长，y往下增长, 即(0, 0)代表的是左上角
  * 的瓦片。
+ *
+ * 层被分成固定大小的区块, 每个区块为每个图片集保存一个独立的\link wyTextureAtlas wyTextureAtlas\endlink.
+ * 绘制时只有和屏幕相交的区块会被绘制, 区块在第一次可见时才创建顶点数据, 离开屏幕一段时间后被释放,
+ * 因此很大的地图每帧的开销和内存占用只和屏幕大小有关. 如果层或者它的父节点设置了摄像机, 网格效果或
+ * 顶点z值, 则无法判断可见范围, 所有区块都会被绘制.
+ *
+ * 区块的atlas使用固定位置模式, 删除的瓦片变成退化矩形, 它的位置留给之后添加的瓦片, 所以修改瓦片
+ * 不需要移动顶点数据, 也不需要更新其它瓦片的索引, 开销是O(1).
  */
 class WIENGINE_API wyTMXLayer : public wyNode {
 	friend class wyTMXTileMap;
@@ -94,10 +103,29 @@ protected:
     /// layer info
     wyLayerInfo* m_layerInfo;
 
-	/// info of atlas
-	wyTileSetAtlasInfo* m_atlasInfos;
+	/// chunks of layer, row by row
+	wyTMXChunk* m_chunks;
+
+	/// chunk count in horizontal
+	int m_chunkCountX;
+
+	/// chunk count in vertical
+	int m_chunkCountY;
+
+	/// indices of chunks whose atlases are built
+	int* m_builtChunks;
+
+	/// count of built chunks
+	int m_builtCount;
+
+	/// increased every time layer is drawn
+	int m_frame;
+
+	/// max tile image size of all tilesets, a tile image may be larger than tile
+	float m_maxTileImageWidth;
+	float m_maxTileImageHeight;
     
-    /// sprite batch node array
+    /// sprite batch node array, they only hold sprites returned by tileAt
     wySpriteBatchNode** m_batchNodes;
 
 	/// vertex Z
@@ -108,22 +136,6 @@ protected:
 	float m_alphaFuncValue;
 
 private:
-	/**
-	 * 遍历atlas索引数组, 对所有大于指定值的索引减1
-	 *
-     * @param tilesetIndex 图片集索引, 仅当相等时才执行减一操作
-	 * @param index 指定的值, 大于这个值的索引都要减1
-	 */
-	void decreaseIndexIfMoreThan(int tilesetIndex, int index);
-
-	/**
-	 * 遍历atlas索引数组, 对所有大于等于指定值的索引加1
-	 *
-     * @param tilesetIndex 图片集索引, 仅当相等时才执行加一操作
-	 * @param index 指定的值, 大于等于这个值的索引都要加1
-	 */
-	void increaseIndexIfEqualOrMoreThan(int tilesetIndex, int index);
-
 protected:
 	/**
 	 * 得到正交型瓦片的左下角位置
@@ -162,7 +174,93 @@ protected:
 	float getVertexZAt(int x, int y);
 
 	/**
-	 * 追加一个瓦片
+	 * 得到瓦片所在的区块
+	 *
+	 * @param x 瓦片列位置
+	 * @param y 瓦片行位置
+	 * @return 区块在区块数组中的索引
+	 */
+	int getChunkIndex(int x, int y);
+
+	/**
+	 * 得到瓦片在区块中的索引
+	 *
+	 * @param x 瓦片列位置
+	 * @param y 瓦片行位置
+	 * @return 瓦片在区块中的索引
+	 */
+	int getIndexInChunk(int x, int y);
+
+	/**
+	 * 计算一个瓦片的贴图坐标和顶点
+	 *
+	 * @param atlas 瓦片所在的atlas
+	 * @param tileset 瓦片所在的图片集
+	 * @param gid 瓦片id
+	 * @param x 瓦片列位置
+	 * @param y 瓦片行位置
+	 * @param texCoords 返回贴图坐标
+	 * @param vertices 返回顶点
+	 */
+	void makeQuad(wyTextureAtlas* atlas, wyTileSetInfo* tileset, int gid, int x, int y, wyQuad2D* texCoords, wyQuad3D* vertices);
+
+	/**
+	 * 得到区块中某个图片集的atlas, 如果还没有则创建
+	 *
+	 * @param chunk 区块
+	 * @param tilesetIndex 图片集索引
+	 * @return \link wyTextureAtlas wyTextureAtlas\endlink
+	 */
+	wyTextureAtlas* getChunkAtlas(wyTMXChunk* chunk, int tilesetIndex);
+
+	/**
+	 * 隐藏区块中的一个瓦片, 用于瓦片已经由精灵绘制的情况
+	 *
+	 * @param x 瓦片列位置
+	 * @param y 瓦片行位置
+	 */
+	void hideTileInChunk(int x, int y);
+
+	/**
+	 * 创建区块的顶点数据
+	 *
+	 * @param index 区块索引
+	 */
+	void buildChunk(int index);
+
+	/**
+	 * 释放区块的顶点数据
+	 *
+	 * @param index 区块索引
+	 */
+	void releaseChunk(int index);
+
+	/**
+	 * 释放一段时间内都不可见的区块
+	 */
+	void releaseExpiredChunks();
+
+	/**
+	 * 计算当前屏幕可以看到的区块范围, 如果无法计算, 则返回所有区块
+	 *
+	 * @param minX 返回最小的区块列
+	 * @param minY 返回最小的区块行
+	 * @param maxX 返回最大的区块列, 如果没有可见区块, 则小于minX
+	 * @param maxY 返回最大的区块行, 如果没有可见区块, 则小于minY
+	 */
+	void getVisibleChunks(int* minX, int* minY, int* maxX, int* maxY);
+
+	/**
+	 * 把一个相对于层的坐标转换成瓦片坐标, 不做范围检查, 结果是浮点数
+	 *
+	 * @param x x坐标, 以层的左下角为原点
+	 * @param y y坐标, 以层的左下角为原点
+	 * @return 瓦片坐标
+	 */
+	wyPoint getTileCoordinateUnclamped(float x, float y);
+
+	/**
+	 * 追加一个瓦片到区块中, 区块必须已经创建
 	 *
      * @param tilesetIndex 这个瓦片所在的图片集索引
 	 * @param gid 瓦片id
@@ -242,6 +340,9 @@ public:
 	/// 析构函数
 	virtual ~wyTMXLayer();
 
+	/// @see wyNode::draw
+	virtual void draw();
+
 	/// @see wyNode::getAlpha
 	virtual int getAlpha() { return m_color.a; }
 
@@ -401,6 +502,19 @@ public:
 	 * @return 瓦片相对于layer左下角的左下角像素坐标
 	 */
 	wyPoint getPositionAt(int x, int y);
+
+	/**
+	 * \if English
+	 * Get count of chunks whose vertices are built, they are visible recently
+	 *
+	 * @return count of built chunks
+	 * \else
+	 * 得到已经创建了顶点数据的区块个数, 这些区块是最近可见的区块
+	 *
+	 * @return 已经创建的区块个数
+	 * \endif
+	 */
+	int getBuiltChunkCount() { return m_builtCount; }
 };
 
 #endif // __wyTMXLayer_h__
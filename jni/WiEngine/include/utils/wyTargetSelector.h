@@ -198,6 +198,15 @@ private:
 	 * \endif
 	 */
 	jobject m_jTarget;
+
+	/**
+	 * \if English
+	 * identity hash code of java callback object
+	 * \else
+	 * java层回调对象的identity hash code
+	 * \endif
+	 */
+	int m_jHash;
 #endif
 
 protected:
@@ -471,6 +480,19 @@ public:
 	 */
 	bool operator==(wyTargetSelector& ts);
 
+	/**
+	 * \if English
+	 * get hash of target selector, it is same for target selectors which are equal
+	 *
+	 * @return hash of target selector
+	 * \else
+	 * 获得hash值, 相等的target selector的hash值相同
+	 *
+	 * @return hash值
+	 * \endif
+	 */
+	unsigned int hash();
+
 	/**
 	 * \if English
 	 * set time between last calling and now
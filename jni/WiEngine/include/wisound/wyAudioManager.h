@@ -369,6 +369,86 @@ public:
 	 */
 	virtual void removeEffect(const char* path) = 0;
 
+	/**
+	 * \if English
+	 * Set priority of a preloaded effect. When all effect voices are busy, a new effect
+	 * can stop a playing effect whose priority is not higher than it. Default priority
+	 * is zero. Only OpenAL backend supports it, other backends ignore it.
+	 *
+	 * @param resId resource id of effect file
+	 * @param priority priority of effect, larger value means higher priority
+	 * \else
+	 * 设置一个预加载音效的优先级. 当所有音效声道都在使用时, 新的音效可以停止一个优先级不高于它的
+	 * 音效. 缺省优先级是0. 只有OpenAL后端支持, 其它后端会忽略.
+	 *
+	 * @param resId 音效文件的资源id
+	 * @param priority 音效优先级, 值越大优先级越高
+	 * \endif
+	 */
+	virtual void setEffectPriority(int resId, int priority);
+
+	/**
+	 * \if English
+	 * Set priority of a preloaded effect by path. Only OpenAL backend supports it, other
+	 * backends ignore it.
+	 *
+	 * @param path path of effect file
+	 * @param priority priority of effect, larger value means higher priority
+	 * \else
+	 * 根据音效路径设置一个预加载音效的优先级. 只有OpenAL后端支持, 其它后端会忽略.
+	 *
+	 * @param path 音效文件路径
+	 * @param priority 音效优先级, 值越大优先级越高
+	 * \endif
+	 */
+	virtual void setEffectPriority(const char* path, int priority);
+
+	/**
+	 * \if English
+	 * Set max bytes of decoded effect data kept in memory. If exceeded, least recently
+	 * played effects will be released and decoded again when played. Only OpenAL backend
+	 * supports it, other backends ignore it.
+	 *
+	 * @param size max bytes of decoded effect data
+	 * \else
+	 * 设置内存中保存的解码后音效数据的最大字节数. 如果超过了, 最久没有播放的音效会被释放, 在播放时
+	 * 重新解码. 只有OpenAL后端支持, 其它后端会忽略.
+	 *
+	 * @param size 解码后音效数据的最大字节数
+	 * \endif
+	 */
+	virtual void setEffectCacheSize(size_t size);
+
+	/**
+	 * \if English
+	 * Set seconds of background music decoded ahead by audio thread. Larger value consumes more
+	 * memory but music can survive longer hitch of decoding. It affects music played later. Default
+	 * is 1 second. Only OpenAL backend supports it, other backends ignore it.
+	 *
+	 * @param seconds seconds of music decoded ahead
+	 * \else
+	 * 设置音频线程预先解码的背景音乐秒数. 值越大占用内存越多, 但是能承受更长的解码延迟. 只影响之后播放的
+	 * 音乐. 缺省是1秒. 只有OpenAL后端支持, 其它后端会忽略.
+	 *
+	 * @param seconds 预先解码的秒数
+	 * \endif
+	 */
+	virtual void setStreamBufferDepth(float seconds);
+
+	/**
+	 * \if English
+	 * Get times that background music runs out of decoded data and has a gap. Only OpenAL backend
+	 * supports it, other backends always return zero.
+	 *
+	 * @return underrun count
+	 * \else
+	 * 得到背景音乐因为解码数据不足而中断的次数. 只有OpenAL后端支持, 其它后端总是返回0.
+	 *
+	 * @return 中断次数
+	 * \endif
+	 */
+	virtual int getStreamUnderrunCount();
+
 	/**
 	 * \if English
 	 * set mute on or off
@@ -41,6 +41,10 @@
 #include "wyMp3Stream.h"
 #include "wyOggStream.h"
 #include "wyWavStream.h"
+#include "wyThread.h"
+
+// interval of audio thread when all ring buffers are full, in milliseconds
+#define STREAM_THREAD_INTERVAL 10
 
 // singleton
 wyAudioManager_openal* gAudioManager = NULL;
@@ -50,26 +54,58 @@ wyAudioManager_openal::wyAudioManager_openal() :
 		m_effectVolume(1.f),
 		m_audios(NULL),
 		m_pendingRemoveAudios(NULL),
-		m_preloadEffects(NULL),
+		m_effectsById(NULL),
+		m_effectsByPath(NULL),
+		m_lruHead(NULL),
+		m_lruTail(NULL),
+		m_voiceCount(0),
+		m_cacheBytes(0),
+		m_cacheSize(DEFAULT_EFFECT_CACHE_SIZE),
+		m_playStamp(0),
+		m_streams(NULL),
+		m_decodingStream(NULL),
+		m_streamQuit(false),
+		m_streamThreadRunning(false),
+		m_streamThreadFailed(false),
+		m_streamBufferDepth(DEFAULT_STREAM_BUFFER_DEPTH),
+		m_streamUnderrunCount(0),
 		m_timer(NULL),
 		m_mute(false) {
 	// init OpenAL
 	wyOpenAL::init();
 
+	// create effect voices, sources are reused by all effects
+	for(int i = 0; i < MAX_EFFECT_VOICES; i++) {
+		m_voices[i].source = 0;
+		m_voices[i].effect = NULL;
+		m_voices[i].startStamp = 0;
+	}
+	for(int i = 0; i < MAX_EFFECT_VOICES; i++) {
+		ALuint source = wyOpenAL::obtainSource();
+		if(source == 0)
+			break;
+		alSourcei(source, AL_LOOPING, AL_FALSE);
+		m_voices[m_voiceCount++].source = source;
+	}
+
 	// create mutex
 	pthread_mutexattr_t attr;
 	pthread_mutexattr_init(&attr);
 	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
 	pthread_mutex_init(&m_mutex, &attr);
 	pthread_mutexattr_destroy(&attr);
+	pthread_mutex_init(&m_streamMutex, NULL);
+	pthread_cond_init(&m_streamCond, NULL);
 			
 	// init other members
-	m_preloadEffects = new vector<Effect*>();
-	m_preloadEffects->reserve(10);
+	m_effectsById = wyHashSetNew(16, effectIdEquals, buildEffectHash);
+	m_effectsByPath = wyHashSetNew(16, effectPathEquals, buildEffectHash);
 	m_audios = new vector<wyAudioPlayer*>();
 	m_audios->reserve(10);
 	m_pendingRemoveAudios = new vector<wyAudioPlayer*>();
 	m_pendingRemoveAudios->reserve(10);
+	m_streams = new vector<wyAudioPlayer*>();
+	m_streams->reserve(4);
 			
 	// init mpg123
 	mpg123_init();
@@ -82,18 +118,38 @@ wyAudioManager_openal::wyAudioManager_openal() :
 
 wyAudioManager_openal::~wyAudioManager_openal() {
 	wyScheduler::getInstance()->unscheduleLocked(m_timer);
+
+	// stop audio thread and wait it exit, it must not touch players after that
+	pthread_mutex_lock(&m_streamMutex);
+	m_streamQuit = true;
+	pthread_cond_broadcast(&m_streamCond);
+	while(m_streamThreadRunning)
+		pthread_cond_wait(&m_streamCond, &m_streamMutex);
+	pthread_mutex_unlock(&m_streamMutex);
 	
 	for(vector<wyAudioPlayer*>::iterator iter = m_audios->begin(); iter != m_audios->end(); iter++) {
 		wyObjectRelease(*iter);
 	}
 	WYDELETE(m_audios);
 	WYDELETE(m_pendingRemoveAudios);
-	for(vector<Effect*>::iterator iter = m_preloadEffects->begin(); iter != m_preloadEffects->end(); iter++) {
-		releaseEffect(*iter);
+	WYDELETE(m_streams);
+
+	// free voices first, buffer can't be deleted when it is attached to a source
+	for(int i = 0; i < m_voiceCount; i++) {
+		wyOpenAL::freeSource(m_voices[i].source);
 	}
-	WYDELETE(m_preloadEffects);
+	for(Effect* e = m_lruHead; e != NULL;) {
+		Effect* next = e->lruNext;
+		releaseEffect(e);
+		e = next;
+	}
+	m_lruHead = m_lruTail = NULL;
+	wyHashSetDestroy(m_effectsById);
+	wyHashSetDestroy(m_effectsByPath);
 
 	pthread_mutex_destroy(&m_mutex);
+	pthread_cond_destroy(&m_streamCond);
+	pthread_mutex_destroy(&m_streamMutex);
 
 	mpg123_exit();
 	wyOpenAL::destroy();
@@ -119,6 +175,8 @@ void wyAudioManager::releaseInstance() {
 }
 
 void wyAudioManager_openal::releaseEffect(Effect* effect) {
+	if(effect->pcmBuffer)
+		alDeleteBuffers(1, &effect->pcmBuffer);
 	if(effect->buffer)
 		wyFree(effect->buffer);
 	if(effect->path)
@@ -126,6 +184,180 @@ void wyAudioManager_openal::releaseEffect(Effect* effect) {
 	wyFree((void*)effect);
 }
 
+bool wyAudioManager_openal::decodeEffect(Effect* effect) {
+	if(!effect->buffer)
+		return false;
+
+	// create stream over raw data, raw data is still owned by effect
+	wyAudioStream* audio = NULL;
+	switch(effect->type) {
+		case FORMAT_MP3:
+			audio = wyMp3Stream::make(effect->buffer, effect->length);
+			break;
+		case FORMAT_WAV:
+			audio = wyWavStream::make(effect->buffer, effect->length);
+			break;
+		case FORMAT_OGG:
+			audio = wyOggStream::make(effect->buffer, effect->length);
+			break;
+		default:
+			LOGW("decodeEffect: Unsupported audio type: %d", effect->type);
+			break;
+	}
+	if(!audio)
+		return false;
+
+	// decode all to a buffer
+	audio->setup();
+	ALuint buffer = 0;
+	alGenBuffers(1, &buffer);
+	size_t length = wyAudioPlayer::decodeToBuffer(audio, buffer);
+	if(length == 0) {
+		alDeleteBuffers(1, &buffer);
+		return false;
+	}
+
+	effect->pcmBuffer = buffer;
+	effect->pcmLength = length;
+	return true;
+}
+
+wyAudioManager_openal::Effect* wyAudioManager_openal::createEffect(char* buffer, size_t length, int type) {
+	Effect* effect = (Effect*)wyCalloc(1, sizeof(Effect));
+	effect->buffer = buffer;
+	effect->length = length;
+	effect->type = type;
+	if(!decodeEffect(effect)) {
+		releaseEffect(effect);
+		return NULL;
+	}
+	return effect;
+}
+
+void wyAudioManager_openal::evictEffect(Effect* effect) {
+	if(effect->pcmBuffer == 0)
+		return;
+
+	// detach buffer from voices
+	for(int i = 0; i < m_voiceCount; i++) {
+		if(m_voices[i].effect == effect)
+			stopVoice(m_voices + i);
+	}
+
+	// free pcm data
+	alDeleteBuffers(1, &effect->pcmBuffer);
+	effect->pcmBuffer = 0;
+	m_cacheBytes -= effect->pcmLength;
+	effect->pcmLength = 0;
+}
+
+void wyAudioManager_openal::eraseEffect(Effect* effect) {
+	if(effect->path)
+		wyHashSetRemove(m_effectsByPath, wyUtils::strHash(effect->path), (void*)effect->path);
+	else
+		wyHashSetRemove(m_effectsById, (size_t)effect->resId, (void*)(intptr_t)effect->resId);
+	unlinkEffect(effect);
+	evictEffect(effect);
+	releaseEffect(effect);
+}
+
+void wyAudioManager_openal::touchEffect(Effect* effect) {
+	if(m_lruTail == effect)
+		return;
+	unlinkEffect(effect);
+	effect->lruPrev = m_lruTail;
+	effect->lruNext = NULL;
+	if(m_lruTail)
+		m_lruTail->lruNext = effect;
+	else
+		m_lruHead = effect;
+	m_lruTail = effect;
+}
+
+void wyAudioManager_openal::unlinkEffect(Effect* effect) {
+	if(effect->lruPrev)
+		effect->lruPrev->lruNext = effect->lruNext;
+	else if(m_lruHead == effect)
+		m_lruHead = effect->lruNext;
+	if(effect->lruNext)
+		effect->lruNext->lruPrev = effect->lruPrev;
+	else if(m_lruTail == effect)
+		m_lruTail = effect->lruPrev;
+	effect->lruPrev = NULL;
+	effect->lruNext = NULL;
+}
+
+void wyAudioManager_openal::trimEffectCache(Effect* keep) {
+	// lru list starts from least recently used effect, evict decoded ones until cache fits
+	for(Effect* e = m_lruHead; e != NULL && m_cacheBytes > m_cacheSize; e = e->lruNext) {
+		if(e != keep)
+			evictEffect(e);
+	}
+}
+
+wyAudioManager_openal::Voice* wyAudioManager_openal::obtainVoice(int priority) {
+	Voice* victim = NULL;
+	for(int i = 0; i < m_voiceCount; i++) {
+		Voice* voice = m_voices + i;
+
+		// idle voice or stopped voice can be used directly
+		if(voice->effect == NULL)
+			return voice;
+		ALint state;
+		alGetSourcei(voice->source, AL_SOURCE_STATE, &state);
+		if(state != AL_PLAYING)
+			return voice;
+
+		// remember oldest voice of lowest priority
+		if(victim == NULL ||
+				voice->effect->priority < victim->effect->priority ||
+				(voice->effect->priority == victim->effect->priority && voice->startStamp < victim->startStamp)) {
+			victim = voice;
+		}
+	}
+
+	// steal victim if its priority is not higher
+	if(victim && victim->effect->priority <= priority) {
+		stopVoice(victim);
+		return victim;
+	}
+
+	return NULL;
+}
+
+void wyAudioManager_openal::stopVoice(Voice* voice) {
+	if(voice->effect) {
+		alSourceStop(voice->source);
+		alSourcei(voice->source, AL_BUFFER, 0);
+		voice->effect = NULL;
+	}
+}
+
+void wyAudioManager_openal::startEffect(Effect* effect) {
+	// decode again if it is evicted
+	if(effect->pcmBuffer == 0) {
+		if(!decodeEffect(effect)) {
+			LOGW("startEffect: Failed to decode effect");
+			return;
+		}
+		m_cacheBytes += effect->pcmLength;
+		trimEffectCache(effect);
+	}
+
+	// get a voice, if all voices are playing more important effects, drop it
+	Voice* voice = obtainVoice(effect->priority);
+	if(!voice)
+		return;
+
+	// play
+	touchEffect(effect);
+	voice->effect = effect;
+	voice->startStamp = ++m_playStamp;
+	alSourcei(voice->source, AL_BUFFER, effect->pcmBuffer);
+	alSourcef(voice->source, AL_GAIN, m_effectVolume);
+	alSourcePlay(voice->source);
+}
+
 void wyAudioManager_openal::onAudioStop(wyAudioPlayer* player) {
 	pthread_mutex_lock(&m_mutex);
 	
@@ -134,6 +366,87 @@ void wyAudioManager_openal::onAudioStop(wyAudioPlayer* player) {
 	pthread_mutex_unlock(&m_mutex);
 }
 
+void wyAudioManager_openal::registerStream(wyAudioPlayer* player) {
+	pthread_mutex_lock(&m_streamMutex);
+
+	m_streams->push_back(player);
+
+	// start audio thread if not
+	bool newThread = !m_streamThreadRunning && !m_streamThreadFailed && !m_streamQuit;
+	if(newThread)
+		m_streamThreadRunning = true;
+	pthread_cond_signal(&m_streamCond);
+	pthread_mutex_unlock(&m_streamMutex);
+
+	if(newThread) {
+		if(wyThread::runThread(wyTargetSelector::make(this, SEL(wyAudioManager_openal::streamThreadEntry))) != 0) {
+			LOGW("%s: failed to create audio thread, music will be decoded in update", __FUNCTION__);
+			pthread_mutex_lock(&m_streamMutex);
+			m_streamThreadRunning = false;
+			m_streamThreadFailed = true;
+			pthread_mutex_unlock(&m_streamMutex);
+		}
+	}
+}
+
+void wyAudioManager_openal::unregisterStream(wyAudioPlayer* player) {
+	pthread_mutex_lock(&m_streamMutex);
+
+	for(vector<wyAudioPlayer*>::iterator iter = m_streams->begin(); iter != m_streams->end(); iter++) {
+		if(*iter == player) {
+			m_streams->erase(iter);
+			break;
+		}
+	}
+
+	// if audio thread is decoding this player, wait it finish because caller may reset or release player
+	while(m_decodingStream == player)
+		pthread_cond_wait(&m_streamCond, &m_streamMutex);
+
+	pthread_mutex_unlock(&m_streamMutex);
+}
+
+void wyAudioManager_openal::streamThreadEntry(wyTargetSelector* ts) {
+	pthread_mutex_lock(&m_streamMutex);
+	while(true) {
+		// wait a stream
+		while(!m_streamQuit && m_streams->empty())
+			pthread_cond_wait(&m_streamCond, &m_streamMutex);
+		if(m_streamQuit)
+			break;
+
+		/*
+		 * decode a piece of every stream without holding the lock, so that play and stop in
+		 * OpenGL thread are not blocked by decoding. The player being decoded is marked and
+		 * unregisterStream waits for it. If list is changed while decoding, a stream may be
+		 * skipped in this pass but it will be decoded in next pass
+		 */
+		bool busy = false;
+		for(size_t i = 0; i < m_streams->size() && !m_streamQuit; i++) {
+			wyAudioPlayer* player = m_streams->at(i);
+			m_decodingStream = player;
+			pthread_mutex_unlock(&m_streamMutex);
+			if(player->decodeAhead())
+				busy = true;
+			pthread_mutex_lock(&m_streamMutex);
+			m_decodingStream = NULL;
+			pthread_cond_broadcast(&m_streamCond);
+		}
+
+		// if all ring buffers are full, sleep a while and let players consume
+		if(!busy) {
+			pthread_mutex_unlock(&m_streamMutex);
+			wyThread::sleep(STREAM_THREAD_INTERVAL);
+			pthread_mutex_lock(&m_streamMutex);
+		}
+	}
+
+	// notify manager that we are quit
+	m_streamThreadRunning = false;
+	pthread_cond_broadcast(&m_streamCond);
+	pthread_mutex_unlock(&m_streamMutex);
+}
+
 bool wyAudioManager_openal::hasAudio(int resId) {
 	for(vector<wyAudioPlayer*>::iterator iter = m_audios->begin(); iter != m_audios->end(); iter++) {
 		if((*iter)->getStream()->isSame(resId)) {
@@ -155,61 +468,31 @@ bool wyAudioManager_openal::hasAudio(const char* path) {
 }
 
 bool wyAudioManager_openal::hasPreloadedEffect(int resId) {
-	for(vector<Effect*>::iterator iter = m_preloadEffects->begin(); iter != m_preloadEffects->end(); iter++) {
-		if((*iter)->resId == resId) {
-			return true;
-		}
-	}
-	
-	return false;
+	return getPreloadedEffect(resId) != NULL;
 }
 
 bool wyAudioManager_openal::hasPreloadedEffect(const char* path) {
-	for(vector<Effect*>::iterator iter = m_preloadEffects->begin(); iter != m_preloadEffects->end(); iter++) {
-		if((*iter)->path && !strcmp(path, (*iter)->path)) {
-			return true;
-		}
-	}
-	
-	return false;
+	return getPreloadedEffect(path) != NULL;
 }
 
-wyAudioPlayer* wyAudioManager_openal::getAudio(int resId) {
-	for(vector<wyAudioPlayer*>::iterator iter = m_audios->begin(); iter != m_audios->end(); iter++) {
-		if((*iter)->getStream()->isSame(resId)) {
-			return *iter;
-		}
-	}
-	return NULL;
+wyAudioManager_openal::Effect* wyAudioManager_openal::getPreloadedEffect(int resId) {
+	return (Effect*)wyHashSetFind(m_effectsById, (size_t)resId, (void*)(intptr_t)resId);
 }
 
-wyAudioPlayer* wyAudioManager_openal::getAudio(const char* path)  {
-	for(vector<wyAudioPlayer*>::iterator iter = m_audios->begin(); iter != m_audios->end(); iter++) {
-		if((*iter)->getStream()->isSame(path)) {
-			return *iter;
-		}
-	}
-	return NULL;
+wyAudioManager_openal::Effect* wyAudioManager_openal::getPreloadedEffect(const char* path)  {
+	return (Effect*)wyHashSetFind(m_effectsByPath, wyUtils::strHash(path), (void*)path);
 }
 
-wyAudioManager_openal::Effect* wyAudioManager_openal::getPreloadedEffect(int resId) {
-	for(vector<Effect*>::iterator iter = m_preloadEffects->begin(); iter != m_preloadEffects->end(); iter++) {
-		if((*iter)->resId == resId) {
-			return *iter;
-		}
-	}
-	
-	return NULL;
+int wyAudioManager_openal::effectIdEquals(void* ptr, void* elt) {
+	return ((Effect*)elt)->resId == (int)(intptr_t)ptr;
 }
 
-wyAudioManager_openal::Effect* wyAudioManager_openal::getPreloadedEffect(const char* path)  {
-	for(vector<Effect*>::iterator iter = m_preloadEffects->begin(); iter != m_preloadEffects->end(); iter++) {
-		if((*iter)->path && !strcmp(path, (*iter)->path)) {
-			return *iter;
-		}
-	}
-	
-	return NULL;
+int wyAudioManager_openal::effectPathEquals(void* ptr, void* elt) {
+	return !strcmp(((Effect*)elt)->path, (const char*)ptr);
+}
+
+void* wyAudioManager_openal::buildEffectHash(void* ptr, void* data) {
+	return data;
 }
 
 void wyAudioManager_openal::update(wyTargetSelector* ts) {
@@ -219,6 +502,10 @@ void wyAudioManager_openal::update(wyTargetSelector* ts) {
 	for(vector<wyAudioPlayer*>::iterator iter1 = m_pendingRemoveAudios->begin(); iter1 != m_pendingRemoveAudios->end(); iter1++) {
 		for(vector<wyAudioPlayer*>::iterator iter2 = m_audios->begin(); iter2 != m_audios->end(); iter2++) {
 			if(*iter1 == *iter2) {
+				// keep underrun count of removed stream
+				if(!(*iter2)->getStream()->isSingleBuffer())
+					m_streamUnderrunCount += (*iter2)->getUnderrunCount();
+
 				// must remember, erase will let iter move forward so release should
 				// be called first
 				wyObjectRelease(*iter2);
@@ -231,6 +518,15 @@ void wyAudioManager_openal::update(wyTargetSelector* ts) {
 	// clear pending remove list
 	m_pendingRemoveAudios->clear();
 
+	// if audio thread can't be created, decode here
+	if(m_streamThreadFailed) {
+		pthread_mutex_lock(&m_streamMutex);
+		for(vector<wyAudioPlayer*>::iterator iter = m_streams->begin(); iter != m_streams->end(); iter++) {
+			(*iter)->decodeAhead();
+		}
+		pthread_mutex_unlock(&m_streamMutex);
+	}
+
 	// update every player
 	for(vector<wyAudioPlayer*>::iterator iter = m_audios->begin(); iter != m_audios->end(); iter++) {
 		(*iter)->update();
@@ -257,9 +553,8 @@ void wyAudioManager_openal::setEffectVolume(float volume) {
 
 	pthread_mutex_lock(&m_mutex);
 
-	for(vector<wyAudioPlayer*>::iterator iter = m_audios->begin(); iter != m_audios->end(); iter++) {
-		if((*iter)->getStream()->isSingleBuffer())
-			(*iter)->setVolume(volume);
+	for(int i = 0; i < m_voiceCount; i++) {
+		alSourcef(m_voices[i].source, AL_GAIN, volume);
 	}
 
 	pthread_mutex_unlock(&m_mutex);
@@ -397,41 +692,21 @@ bool wyAudioManager_openal::isBackgroundPlaying() {
 void wyAudioManager_openal::playEffect(int resId, int type) {
 	pthread_mutex_lock(&m_mutex);
 
-	// get effect info
+	// get effect info, preload it if not
 	Effect* effect = getPreloadedEffect(resId);
 	if(!effect) {
+		pthread_mutex_unlock(&m_mutex);
 		preloadEffect(resId, type);
+		pthread_mutex_lock(&m_mutex);
 		effect = getPreloadedEffect(resId);
 	}
 	
 	// if fail to load effect, return
-	// if ok, create audio stream and player
+	// if ok, play it with a voice
 	if(!effect) {
 		LOGW("Failed to load effect res id: %d", resId);
 	} else {
-		wyAudioStream* audio = NULL;
-		switch(effect->type) {
-			case FORMAT_MP3:
-				audio = wyMp3Stream::make(effect->buffer, effect->length);
-				break;
-			case FORMAT_WAV:
-				audio = wyWavStream::make(effect->buffer, effect->length);
-				break;
-			case FORMAT_OGG:
-				audio = wyOggStream::make(effect->buffer, effect->length);
-				break;
-			default:
-				LOGW("preloadEffect: Unsupported audio type: %d", effect->type);
-				break;
-		}
-		
-		if(audio) {
-			audio->setup();
-			wyAudioPlayer* player = wyAudioPlayer::make(audio);
-			player->retain();
-			player->play(m_effectVolume);
-			m_audios->push_back(player);
-		}
+		startEffect(effect);
 	}
 
 	pthread_mutex_unlock(&m_mutex);
@@ -440,102 +715,111 @@ void wyAudioManager_openal::playEffect(int resId, int type) {
 void wyAudioManager_openal::playEffect(const char* path, bool isFile) {
 	pthread_mutex_lock(&m_mutex);
 
-	// get effect
+	// get effect, preload it if not
 	Effect* effect = getPreloadedEffect(path);
 	if(!effect) {
+		pthread_mutex_unlock(&m_mutex);
 		preloadEffect(path, isFile);
+		pthread_mutex_lock(&m_mutex);
 		effect = getPreloadedEffect(path);
 	}
 	
 	// if fail to load effect, return
-	// if ok, create audio stream and player
+	// if ok, play it with a voice
 	if(!effect) {
 		LOGW("Failed to load effect path: %s", path);
 	} else {
-		wyAudioStream* audio = NULL;
-		switch(effect->type) {
-			case FORMAT_MP3:
-				audio = wyMp3Stream::make(effect->buffer, effect->length);
-				break;
-			case FORMAT_WAV:
-				audio = wyWavStream::make(effect->buffer, effect->length);
-				break;
-			case FORMAT_OGG:
-				audio = wyOggStream::make(effect->buffer, effect->length);
-				break;
-			default:
-				LOGW("preloadEffect: Unsupported audio type: %d", effect->type);
-				break;
-		}
-		
-		if(audio) {
-			audio->setup();
-            wyAudioPlayer* player = wyAudioPlayer::make(audio);
-            player->retain();
-			player->play(m_effectVolume);
-			m_audios->push_back(player);
-		}
+		startEffect(effect);
 	}
 
 	pthread_mutex_unlock(&m_mutex);
 }
 
 void wyAudioManager_openal::preloadEffect(int resId, int type) {
+	// decoding is slow so it is done out of lock
 	pthread_mutex_lock(&m_mutex);
+	bool loaded = hasPreloadedEffect(resId);
+	pthread_mutex_unlock(&m_mutex);
+	if(loaded)
+		return;
 
-	if(!hasPreloadedEffect(resId)) {
-		// load effect raw data
-		size_t length;
-		char* buf = wyUtils::loadRaw(resId, &length, NULL, true);
-		
-		// create effect
-		Effect* effect = (Effect*)wyCalloc(1, sizeof(Effect));
-		effect->buffer = buf;
-		effect->length = length;
-		effect->resId = resId;
-		effect->type = type;
-		
-		// add effect
-		m_preloadEffects->push_back(effect);
+	// load effect raw data and decode it
+	size_t length;
+	char* buf = wyUtils::loadRaw(resId, &length, NULL, true);
+	Effect* effect = createEffect(buf, length, type);
+	if(!effect) {
+		LOGW("preloadEffect: Failed to decode effect res id: %d", resId);
+		return;
 	}
+	effect->resId = resId;
 
+	// add effect, other thread may add it when we are decoding
+	pthread_mutex_lock(&m_mutex);
+	if(hasPreloadedEffect(resId)) {
+		releaseEffect(effect);
+	} else {
+		wyHashSetInsert(m_effectsById, (size_t)resId, (void*)(intptr_t)resId, effect);
+		touchEffect(effect);
+		m_cacheBytes += effect->pcmLength;
+		trimEffectCache(effect);
+	}
 	pthread_mutex_unlock(&m_mutex);
 }
 
 void wyAudioManager_openal::preloadEffect(const char* path, bool isFile) {
+	// decoding is slow so it is done out of lock
 	pthread_mutex_lock(&m_mutex);
+	bool loaded = hasPreloadedEffect(path);
+	pthread_mutex_unlock(&m_mutex);
+	if(loaded)
+		return;
+
+	// get audio type
+	int type = 0;
+	if(wyUtils::endsWith(path, ".wav") || wyUtils::endsWith(path, ".WAV")) {
+		type = FORMAT_WAV;
+	} else if(wyUtils::endsWith(path, ".mp3") || wyUtils::endsWith(path, ".MP3")) {
+		type = FORMAT_MP3;
+	} else if(wyUtils::endsWith(path, ".ogg") || wyUtils::endsWith(path, ".OGG")) {
+		type = FORMAT_OGG;
+	} else {
+		LOGW("preloadEffect: Unsupported audio type: %s", path);
+		return;
+	}
 
-	if(!hasPreloadedEffect(path)) {
-		// load effect raw data
-		size_t length;
-		char* buf = wyUtils::loadRaw(path, isFile, &length, true);
-		
-		// create effect
-		Effect* effect = (Effect*)wyCalloc(1, sizeof(Effect));
-		effect->buffer = buf;
-		effect->length = length;
-		effect->path = wyUtils::copy(path);
-		if(wyUtils::endsWith(path, ".wav") || wyUtils::endsWith(path, ".WAV")) {
-			effect->type = FORMAT_WAV;
-		} else if(wyUtils::endsWith(path, ".mp3") || wyUtils::endsWith(path, ".MP3")) {
-			effect->type = FORMAT_MP3;
-		} else if(wyUtils::endsWith(path, ".ogg") || wyUtils::endsWith(path, ".OGG")) {
-			effect->type = FORMAT_OGG;
-		}
-		
-		// add effect
-		m_preloadEffects->push_back(effect);
+	// load effect raw data and decode it
+	size_t length;
+	char* buf = wyUtils::loadRaw(path, isFile, &length, true);
+	Effect* effect = createEffect(buf, length, type);
+	if(!effect) {
+		LOGW("preloadEffect: Failed to decode effect path: %s", path);
+		return;
 	}
+	effect->path = wyUtils::copy(path);
 
+	// add effect, other thread may add it when we are decoding
+	pthread_mutex_lock(&m_mutex);
+	if(hasPreloadedEffect(path)) {
+		releaseEffect(effect);
+	} else {
+		wyHashSetInsert(m_effectsByPath, wyUtils::strHash(effect->path), (void*)effect->path, effect);
+		touchEffect(effect);
+		m_cacheBytes += effect->pcmLength;
+		trimEffectCache(effect);
+	}
 	pthread_mutex_unlock(&m_mutex);
 }
 
 void wyAudioManager_openal::stopEffect(int resId) {
 	pthread_mutex_lock(&m_mutex);
 
-	wyAudioPlayer* audio = getAudio(resId);
-	if(audio)
-		audio->stop();
+	Effect* effect = getPreloadedEffect(resId);
+	if(effect) {
+		for(int i = 0; i < m_voiceCount; i++) {
+			if(m_voices[i].effect == effect)
+				stopVoice(m_voices + i);
+		}
+	}
 
 	pthread_mutex_unlock(&m_mutex);
 }
@@ -543,9 +827,13 @@ void wyAudioManager_openal::stopEffect(int resId) {
 void wyAudioManager_openal::stopEffect(const char* path, bool isFile) {
 	pthread_mutex_lock(&m_mutex);
 
-	wyAudioPlayer* audio = getAudio(path);
-	if(audio)
-		audio->stop();
+	Effect* effect = getPreloadedEffect(path);
+	if(effect) {
+		for(int i = 0; i < m_voiceCount; i++) {
+			if(m_voices[i].effect == effect)
+				stopVoice(m_voices + i);
+		}
+	}
 
 	pthread_mutex_unlock(&m_mutex);
 }
@@ -553,10 +841,17 @@ void wyAudioManager_openal::stopEffect(const char* path, bool isFile) {
 void wyAudioManager_openal::removeAllEffects() {
 	pthread_mutex_lock(&m_mutex);
 
-	for(vector<Effect*>::iterator iter = m_preloadEffects->begin(); iter != m_preloadEffects->end(); iter++) {
-		releaseEffect(*iter);
+	for(Effect* e = m_lruHead; e != NULL;) {
+		Effect* next = e->lruNext;
+		evictEffect(e);
+		releaseEffect(e);
+		e = next;
 	}
-	m_preloadEffects->clear();
+	m_lruHead = m_lruTail = NULL;
+	wyHashSetDestroy(m_effectsById);
+	wyHashSetDestroy(m_effectsByPath);
+	m_effectsById = wyHashSetNew(16, effectIdEquals, buildEffectHash);
+	m_effectsByPath = wyHashSetNew(16, effectPathEquals, buildEffectHash);
 
 	pthread_mutex_unlock(&m_mutex);
 }
@@ -564,13 +859,9 @@ void wyAudioManager_openal::removeAllEffects() {
 void wyAudioManager_openal::removeEffect(int resId) {
 	pthread_mutex_lock(&m_mutex);
 
-	for(vector<Effect*>::iterator iter = m_preloadEffects->begin(); iter != m_preloadEffects->end(); iter++) {
-		if((*iter)->resId == resId) {
-			releaseEffect(*iter);
-			m_preloadEffects->erase(iter);
-			break;
-		}
-	}
+	Effect* effect = getPreloadedEffect(resId);
+	if(effect)
+		eraseEffect(effect);
 
 	pthread_mutex_unlock(&m_mutex);
 }
@@ -578,15 +869,62 @@ void wyAudioManager_openal::removeEffect(int resId) {
 void wyAudioManager_openal::removeEffect(const char* path) {
 	pthread_mutex_lock(&m_mutex);
 
-	for(vector<Effect*>::iterator iter = m_preloadEffects->begin(); iter != m_preloadEffects->end(); iter++) {
-		if((*iter)->path && !strcmp((*iter)->path, path)) {
-			releaseEffect(*iter);
-			m_preloadEffects->erase(iter);
-			break;
-		}
+	Effect* effect = getPreloadedEffect(path);
+	if(effect)
+		eraseEffect(effect);
+
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void wyAudioManager_openal::setEffectPriority(int resId, int priority) {
+	pthread_mutex_lock(&m_mutex);
+
+	Effect* effect = getPreloadedEffect(resId);
+	if(effect)
+		effect->priority = priority;
+	else
+		LOGW("setEffectPriority: effect res id %d is not preloaded", resId);
+
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void wyAudioManager_openal::setEffectPriority(const char* path, int priority) {
+	pthread_mutex_lock(&m_mutex);
+
+	Effect* effect = getPreloadedEffect(path);
+	if(effect)
+		effect->priority = priority;
+	else
+		LOGW("setEffectPriority: effect %s is not preloaded", path);
+
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void wyAudioManager_openal::setEffectCacheSize(size_t size) {
+	pthread_mutex_lock(&m_mutex);
+
+	m_cacheSize = size;
+	trimEffectCache(NULL);
+
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void wyAudioManager_openal::setStreamBufferDepth(float seconds) {
+	m_streamBufferDepth = MAX(0, seconds);
+}
+
+int wyAudioManager_openal::getStreamUnderrunCount() {
+	pthread_mutex_lock(&m_mutex);
+
+	int count = m_streamUnderrunCount;
+	for(vector<wyAudioPlayer*>::iterator iter = m_audios->begin(); iter != m_audios->end(); iter++) {
+		if(!(*iter)->getStream()->isSingleBuffer())
+			count += (*iter)->getUnderrunCount();
 	}
 
 	pthread_mutex_unlock(&m_mutex);
+
+	return count;
 }
 
 void wyAudioManager_openal::setMute(bool mute) {
@@ -594,6 +932,9 @@ void wyAudioManager_openal::setMute(bool mute) {
 
 	pthread_mutex_lock(&m_mutex);
 	if(m_mute) {
+		for(int i = 0; i < m_voiceCount; i++) {
+			stopVoice(m_voices + i);
+		}
 		for(vector<wyAudioPlayer*>::iterator iter = m_audios->begin(); iter != m_audios->end(); iter++) {
 			if((*iter)->getStream()->isSingleBuffer())
 				(*iter)->stop();
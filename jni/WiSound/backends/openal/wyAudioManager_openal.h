@@ -37,12 +37,29 @@
 #include "wyScheduler.h"
 #include "wyAudioManager.h"
 #include "wyAudioPlayer.h"
+#include "wyHashSet.h"
 #include <pthread.h>
 
+/// max effects can be played at same time
+#define MAX_EFFECT_VOICES 8
+
+/// default max bytes of decoded effect data
+#define DEFAULT_EFFECT_CACHE_SIZE (4 * 1024 * 1024)
+
+/// default seconds of music decoded ahead by audio thread
+#define DEFAULT_STREAM_BUFFER_DEPTH 1.f
+
 /**
  * @class wyAudioManager_openal
  *
  * OpenAL后端实现, 基于OpenAL播放音乐. 但是在Android低端机上有较严重的卡顿问题.
+ *
+ * 音效在预加载时被一次性解码到OpenAL缓冲中, 解码后的数据总量受缓存上限控制, 超过时释放最久没有
+ * 播放的音效. 音效使用固定数量的声道播放, 声道都忙时按优先级抢占, 因此播放已解码的音效不需要再解码
+ * 和分配内存.
+ *
+ * 背景音乐由一个专门的音频线程解码到每个播放器的单生产者单消费者环形缓冲中, update只从环形缓冲中
+ * 取数据填充OpenAL缓冲, 因此游戏线程不会调用解码器, 帧卡顿也不会造成音乐中断.
  */
 class wyAudioManager_openal : public wyAudioManager {
 	friend class wyAudioPlayer;
@@ -65,6 +82,33 @@ private:
 		
 		/// audio type
 		int type;
+
+		/// OpenAL buffer of decoded pcm data, 0 means not decoded or evicted
+		ALuint pcmBuffer;
+
+		/// byte length of decoded pcm data
+		size_t pcmLength;
+
+		/// priority used by voice stealing
+		int priority;
+
+		/// previous effect in lru list, which is used earlier
+		Effect* lruPrev;
+
+		/// next effect in lru list, which is used later
+		Effect* lruNext;
+	};
+
+	/// effect voice structure
+	struct Voice {
+		/// OpenAL source, created when manager is created
+		ALuint source;
+
+		/// effect playing, NULL means voice is idle
+		Effect* effect;
+
+		/// play stamp when voice starts
+		unsigned int startStamp;
 	};
 
 private:
@@ -83,8 +127,32 @@ private:
 	/// audio stream need to be removed
 	vector<wyAudioPlayer*>* m_pendingRemoveAudios;
 
-	/// effect preloaded
-	vector<Effect*>* m_preloadEffects;
+	/// effect preloaded by resource id, hashed by resource id
+	wyHashSet* m_effectsById;
+
+	/// effect preloaded by path, hashed by path string
+	wyHashSet* m_effectsByPath;
+
+	/// least recently used preloaded effect, head of lru list
+	Effect* m_lruHead;
+
+	/// most recently used preloaded effect, tail of lru list
+	Effect* m_lruTail;
+
+	/// effect voice pool
+	Voice m_voices[MAX_EFFECT_VOICES];
+
+	/// count of voices whose source is created
+	int m_voiceCount;
+
+	/// bytes of decoded effect data
+	size_t m_cacheBytes;
+
+	/// max bytes of decoded effect data
+	size_t m_cacheSize;
+
+	/// play stamp, increased every time an effect is played
+	unsigned int m_playStamp;
 
 	/// update timer
 	wyTimer* m_timer;
@@ -92,6 +160,33 @@ private:
 	/// mutex
 	pthread_mutex_t m_mutex;
 
+	/// streaming players which are decoded by audio thread
+	vector<wyAudioPlayer*>* m_streams;
+
+	/// player which audio thread is decoding, it is only changed with stream mutex held
+	wyAudioPlayer* m_decodingStream;
+
+	/// mutex of streaming player list and decoding player, audio thread doesn't hold it when decoding
+	pthread_mutex_t m_streamMutex;
+
+	/// condition to wake audio thread, wait it exit or wait it finish decoding a player
+	pthread_cond_t m_streamCond;
+
+	/// true means audio thread should exit
+	bool m_streamQuit;
+
+	/// true means audio thread is running
+	bool m_streamThreadRunning;
+
+	/// true means audio thread can't be created, streams are decoded in update
+	bool m_streamThreadFailed;
+
+	/// seconds of music decoded ahead
+	float m_streamBufferDepth;
+
+	/// underrun count of streaming players which are removed
+	int m_streamUnderrunCount;
+
 private:
 	/**
 	 * release effect
@@ -99,6 +194,81 @@ private:
 	 * @param effect effect structure pointer
 	 */
 	static void releaseEffect(Effect* effect);
+
+	/**
+	 * 解码音效, 把pcm数据保存到音效的OpenAL缓冲中, 不修改缓存统计
+	 *
+	 * @param effect effect structure pointer
+	 * @return true表示解码成功
+	 */
+	static bool decodeEffect(Effect* effect);
+
+	/**
+	 * 创建音效结构并解码, 不需要持有锁
+	 *
+	 * @param buffer 音效文件数据, 由音效结构接管
+	 * @param length 音效文件数据长度
+	 * @param type 音频格式
+	 * @return 音效结构, 失败返回NULL
+	 */
+	static Effect* createEffect(char* buffer, size_t length, int type);
+
+	/**
+	 * 释放音效的pcm缓冲, 正在播放这个音效的声道会被停止
+	 *
+	 * @param effect effect structure pointer
+	 */
+	void evictEffect(Effect* effect);
+
+	/**
+	 * 从哈希表和lru列表中删除并释放一个音效
+	 *
+	 * @param effect effect structure pointer
+	 */
+	void eraseEffect(Effect* effect);
+
+	/**
+	 * 把音效放到lru列表末尾, 表示它刚刚被使用. 音效可以不在列表中
+	 *
+	 * @param effect effect structure pointer
+	 */
+	void touchEffect(Effect* effect);
+
+	/**
+	 * 把音效从lru列表中移除
+	 *
+	 * @param effect effect structure pointer
+	 */
+	void unlinkEffect(Effect* effect);
+
+	/**
+	 * 释放最久没有播放的音效, 直到缓存大小不超过上限
+	 *
+	 * @param keep 不能被释放的音效, 可以是NULL
+	 */
+	void trimEffectCache(Effect* keep);
+
+	/**
+	 * 得到一个空闲声道, 如果没有, 则抢占优先级不高于指定优先级的最老的声道
+	 *
+	 * @param priority 新音效的优先级
+	 * @return 声道, 如果没有可用的声道返回NULL
+	 */
+	Voice* obtainVoice(int priority);
+
+	/**
+	 * 停止一个声道
+	 *
+	 * @param voice 声道
+	 */
+	static void stopVoice(Voice* voice);
+
+	/**
+	 * 用一个空闲的声道播放音效, 音效数据已经解码时不会分配内存
+	 *
+	 * @param effect effect structure pointer
+	 */
+	void startEffect(Effect* effect);
 	
 	/**
 	 * 当音频停止时被调用
@@ -107,6 +277,34 @@ private:
 	 */
 	void onAudioStop(wyAudioPlayer* player);
 
+	/**
+	 * 把一个流式播放器加入音频线程, 音频线程会把它解码到环形缓冲中
+	 *
+	 * @param player audio player object
+	 */
+	void registerStream(wyAudioPlayer* player);
+
+	/**
+	 * 把一个流式播放器从音频线程中移除, 返回后音频线程不会再访问它
+	 *
+	 * @param player audio player object
+	 */
+	void unregisterStream(wyAudioPlayer* player);
+
+	/**
+	 * 音频线程入口
+	 *
+	 * @param ts target selector
+	 */
+	void streamThreadEntry(wyTargetSelector* ts);
+
+	/**
+	 * 得到音频线程预先解码的秒数
+	 *
+	 * @return 预先解码的秒数
+	 */
+	float getStreamBufferDepth() { return m_streamBufferDepth; }
+
 	/**
 	 * 检查是否存在某个音频流了
 	 *
@@ -139,22 +337,6 @@ private:
 	 */
 	bool hasPreloadedEffect(const char* path);
 
-	/**
-	 * 获得某个正在播放的音频流
-	 *
-	 * @param resId 音频文件资源id
-	 * @return 返回找到的\link wyAudioPlayer wyAudioPlayer\endlink对象, 如果没找到返回NULL
-	 */
-	wyAudioPlayer* getAudio(int resId);
-
-	/**
-	 * 获得某个正在播放的音频流
-	 *
-	 * @param path 音频文件的路径
-	 * @return 返回找到的\link wyAudioPlayer wyAudioPlayer\endlink对象, 如果没找到返回NULL
-	 */
-	wyAudioPlayer* getAudio(const char* path);
-
 	/**
 	 * 获得某个预载入的音频流
 	 *
@@ -171,6 +353,10 @@ private:
 	 */
 	Effect* getPreloadedEffect(const char* path);
 
+	static int effectIdEquals(void* ptr, void* elt);
+	static int effectPathEquals(void* ptr, void* elt);
+	static void* buildEffectHash(void* ptr, void* data);
+
 protected:
 	wyAudioManager_openal();
 
@@ -240,6 +426,21 @@ public:
 	/// @see wyAudioManager::removeEffect
 	virtual void removeEffect(const char* path);
 
+	/// @see wyAudioManager::setEffectPriority
+	virtual void setEffectPriority(int resId, int priority);
+
+	/// @see wyAudioManager::setEffectPriority
+	virtual void setEffectPriority(const char* path, int priority);
+
+	/// @see wyAudioManager::setEffectCacheSize
+	virtual void setEffectCacheSize(size_t size);
+
+	/// @see wyAudioManager::setStreamBufferDepth
+	virtual void setStreamBufferDepth(float seconds);
+
+	/// @see wyAudioManager::getStreamUnderrunCount
+	virtual int getStreamUnderrunCount();
+
 	/// @see wyAudioManager::setMute
 	virtual void setMute(bool mute);
 
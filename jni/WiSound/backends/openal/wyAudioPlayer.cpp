@@ -32,10 +32,15 @@
 #include "wyOpenAL.h"
 #include "wyAudioManager_openal.h"
 #include "wyLog.h"
+#include "wyAtomic.h"
+#include <string.h>
 
 #define BUFFER_SIZE 40960
 #define MAX_BUFFER 3
 
+// max bytes decoded for one stream in one pass of audio thread
+#define DECODE_PASS_SIZE BUFFER_SIZE
+
 wyAudioPlayer::wyAudioPlayer(wyAudioStream* stream) :
         m_stream(NULL),
         m_buffers(NULL),
@@ -43,6 +48,16 @@ wyAudioPlayer::wyAudioPlayer(wyAudioStream* stream) :
         m_renderedSeconds(0),
         m_secondsPerBuffer(0),
         m_tempBuffer(NULL),
+        m_ring(NULL),
+        m_ringSize(0),
+        m_ringRead(0),
+        m_ringWrite(0),
+        m_decodeEnded(false),
+        m_freeBuffers(NULL),
+        m_freeCount(0),
+        m_started(false),
+        m_underrunCount(0),
+        m_ringUnderrunCount(0),
         m_loop(0),
         m_playing(false),
         m_paused(false) {
@@ -58,22 +73,7 @@ wyAudioPlayer::wyAudioPlayer(wyAudioStream* stream) :
     
     // load audio all if single buffer
     if(m_stream->isSingleBuffer()) {
-        // read until no data
-        char* buf = (char*)wyMalloc(BUFFER_SIZE * sizeof(char));
-        int bufSize = BUFFER_SIZE;
-        int total = 0;
-        int readLen = 0;
-        while((readLen = m_stream->read(buf + total, BUFFER_SIZE)) > 0) {
-            total += readLen;
-            if(total + BUFFER_SIZE > bufSize) {
-                buf = (char*)wyRealloc(buf, bufSize * 2);
-                bufSize *= 2;
-            }
-        }
-        
-        // set to buffer
-        alBufferData(m_buffers[0], getALFormat(), buf, total, m_stream->getSampleRate());
-        wyFree(buf);
+        decodeToBuffer(m_stream, m_buffers[0]);
     }
 }
 
@@ -86,6 +86,16 @@ wyAudioPlayer::~wyAudioPlayer() {
 		wyFree(m_tempBuffer);
 		m_tempBuffer = NULL;
 	}
+
+	// free ring buffer
+	if(m_ring) {
+		wyFree(m_ring);
+		m_ring = NULL;
+	}
+	if(m_freeBuffers) {
+		wyFree(m_freeBuffers);
+		m_freeBuffers = NULL;
+	}
     
 	// free source
 	if(m_stream->isSingleBuffer() && m_source != 0) {
@@ -105,12 +115,34 @@ wyAudioPlayer* wyAudioPlayer::make(wyAudioStream* stream) {
     return (wyAudioPlayer*)p->autoRelease();
 }
 
-ALenum wyAudioPlayer::getALFormat() {
-	switch(m_stream->getBitsPerSample()) {
+size_t wyAudioPlayer::decodeToBuffer(wyAudioStream* stream, ALuint buffer) {
+    // read until no data
+    char* buf = (char*)wyMalloc(BUFFER_SIZE * sizeof(char));
+    int bufSize = BUFFER_SIZE;
+    int total = 0;
+    int readLen = 0;
+    while((readLen = stream->read(buf + total, BUFFER_SIZE)) > 0) {
+        total += readLen;
+        if(total + BUFFER_SIZE > bufSize) {
+            buf = (char*)wyRealloc(buf, bufSize * 2);
+            bufSize *= 2;
+        }
+    }
+
+    // set to buffer
+    if(total > 0)
+        alBufferData(buffer, getALFormat(stream), buf, total, stream->getSampleRate());
+    wyFree(buf);
+
+    return total;
+}
+
+ALenum wyAudioPlayer::getALFormat(wyAudioStream* stream) {
+	switch(stream->getBitsPerSample()) {
 		case 8:
-			return m_stream->getChannel() == 1 ? AL_FORMAT_MONO8 : AL_FORMAT_STEREO8;
+			return stream->getChannel() == 1 ? AL_FORMAT_MONO8 : AL_FORMAT_STEREO8;
 		case 16:
-			return m_stream->getChannel() == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+			return stream->getChannel() == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
 		default:
 			return 0;
 	}
@@ -143,24 +175,30 @@ void wyAudioPlayer::play(float volume) {
             if(error != AL_NO_ERROR) {
 				LOGW("wyAudioPlayer::play: AL error occured: 0x%X", error);
 			}
-            
-			// queue buffers
-			for (int i = 0; i < MAX_BUFFER; i++) {
-				if (!fill(m_buffers[i]))
-					break;
-				alSourceQueueBuffers(m_source, 1, &m_buffers[i]);
-			}
-            
-			// check error
-			error = alGetError();
-			if(error != AL_NO_ERROR) {
-				LOGW("wyAudioPlayer::play: AL error occured: 0x%X", error);
-				stop();
-				return;
+
+			// create ring buffer, its size is decided by stream buffer depth of manager
+			wyAudioManager_openal* am = (wyAudioManager_openal*)wyAudioManager::getInstance();
+			if(!m_ring) {
+				unsigned int bytes = (unsigned int)(am->getStreamBufferDepth() * m_stream->getSampleRate() *
+						m_stream->getChannel() * m_stream->getBitsPerSample() / 8);
+				m_ringSize = BUFFER_SIZE * 2;
+				while(m_ringSize < bytes)
+					m_ringSize <<= 1;
+				m_ring = (char*)wyMalloc(m_ringSize * sizeof(char));
+				m_freeBuffers = (ALuint*)wyCalloc(MAX_BUFFER, sizeof(ALuint));
 			}
-            
-			// play
-			alSourcePlay(m_source);
+			m_ringRead = 0;
+			m_ringWrite = 0;
+			m_decodeEnded = false;
+
+			// all buffers are free, they are queued in update when audio thread decodes enough data
+			for(int i = 0; i < MAX_BUFFER; i++)
+				m_freeBuffers[i] = m_buffers[MAX_BUFFER - 1 - i];
+			m_freeCount = MAX_BUFFER;
+			m_started = false;
+
+			// let audio thread decode stream
+			am->registerStream(this);
 		}
         
 		// set flag
@@ -170,6 +208,10 @@ void wyAudioPlayer::play(float volume) {
 
 void wyAudioPlayer::stop() {
 	if(m_playing && m_source) {
+		// audio thread must not decode stream after this
+		if(!m_stream->isSingleBuffer())
+			((wyAudioManager_openal*)wyAudioManager::getInstance())->unregisterStream(this);
+
         wyOpenAL::freeSource(m_source);
         
 		m_stream->reset();
@@ -205,40 +247,38 @@ void wyAudioPlayer::update() {
 		return;
     
 	if(!m_stream->isSingleBuffer()) {
-		bool end = false;
+		// collect processed buffers
 		ALint buffers;
 		alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &buffers);
 		while(buffers-- > 0) {
-			// unqueue a buffer
 			ALuint buffer;
 			alSourceUnqueueBuffers(m_source, 1, &buffer);
-			if(buffer == AL_INVALID_VALUE)
-				break;
-            
+			m_freeBuffers[m_freeCount++] = buffer;
+
 			// adjust rendered seconds
 			m_renderedSeconds += m_secondsPerBuffer;
-            
-			// try to fill buffer, if failed, let it end
-			if(fill(buffer))
-				alSourceQueueBuffers(m_source, 1, &buffer);
-			else {
-				end = true;
-				break;
-			}
 		}
-        
-		// if no queued buffer or end flag is set
+
+		// refill them with data decoded by audio thread
+		queueFreeBuffers();
+
+		// if all data is played, stop
 		alGetSourcei(m_source, AL_BUFFERS_QUEUED, &buffers);
-		if(end && buffers == 0) {
+		if(buffers == 0 && isDrained()) {
 			stop();
 			return;
 		}
-        
-		// A buffer underflow will cause the source to stop.
+
+		// start source when first buffers are queued. A buffer underflow will
+		// cause the source to stop so restart it
 		ALint state;
 		alGetSourcei(m_source, AL_SOURCE_STATE, &state);
-		if(m_playing && !m_paused && state != AL_PLAYING)
+		if(m_playing && !m_paused && state != AL_PLAYING && buffers > 0) {
+			if(m_started)
+				m_underrunCount++;
+			m_started = true;
 			alSourcePlay(m_source);
+		}
 	} else {
 		if(m_playing) {
 			ALint state;
@@ -260,34 +300,99 @@ void wyAudioPlayer::setVolume(float volume) {
 		alSourcef(m_source, AL_GAIN, volume);
 }
 
+void wyAudioPlayer::queueFreeBuffers() {
+	while(m_freeCount > 0) {
+		ALuint buffer = m_freeBuffers[m_freeCount - 1];
+		if(!fill(buffer))
+			break;
+		alSourceQueueBuffers(m_source, 1, &buffer);
+		m_freeCount--;
+	}
+}
+
 bool wyAudioPlayer::fill(ALuint buffer) {
-	// create buffer if not
-	if(!m_tempBuffer) {
-		m_tempBuffer = (char*)wyMalloc(BUFFER_SIZE * sizeof(char));
+	// end flag must be read before write position, so that all data is seen if it is set
+	bool ended = m_decodeEnded;
+	wyMemoryBarrier();
+	unsigned int avail = m_ringWrite - m_ringRead;
+
+	// wait a full buffer unless stream is ended
+	if(avail == 0 || (avail < BUFFER_SIZE && !ended)) {
+		if(!ended && m_started)
+			m_ringUnderrunCount++;
+		return false;
 	}
-    
-	// read max buffer size
-	size_t length = m_stream->read(m_tempBuffer, BUFFER_SIZE);
-	if(length <= 0) {
-		if(isLoop()) {
-			// decrease loop count
-			if(m_loop > 0)
-				m_loop--;
-            
-			// reset to first and read again
-			m_stream->reset();
-			length = m_stream->read(m_tempBuffer, BUFFER_SIZE);
-			if(length <= 0)
-				return false;
-		} else {
-			return false;
-		}
+
+	// get data, copy it only if it wraps around ring end
+	unsigned int length = MIN(avail, BUFFER_SIZE);
+	unsigned int pos = m_ringRead & (m_ringSize - 1);
+	unsigned int first = MIN(length, m_ringSize - pos);
+	char* data = m_ring + pos;
+	if(first < length) {
+		if(!m_tempBuffer)
+			m_tempBuffer = (char*)wyMalloc(BUFFER_SIZE * sizeof(char));
+		memcpy(m_tempBuffer, m_ring + pos, first);
+		memcpy(m_tempBuffer + first, m_ring, length - first);
+		data = m_tempBuffer;
 	}
-    
+
 	// set to buffer
-	alBufferData(buffer, getALFormat(), m_tempBuffer, length, m_stream->getSampleRate());
-    
+	alBufferData(buffer, getALFormat(), data, length, m_stream->getSampleRate());
+
+	// let producer reuse the space
+	wyMemoryBarrier();
+	m_ringRead += length;
+
 	return true;
 }
 
+bool wyAudioPlayer::decodeAhead() {
+	if(m_decodeEnded)
+		return false;
+
+	unsigned int decoded = 0;
+	bool reset = false;
+	while(decoded < DECODE_PASS_SIZE) {
+		// get free space until ring end
+		unsigned int free = m_ringSize - (m_ringWrite - m_ringRead);
+		unsigned int pos = m_ringWrite & (m_ringSize - 1);
+		unsigned int length = MIN(free, m_ringSize - pos);
+		if(length == 0)
+			break;
+
+		// decode
+		int readLen = m_stream->read(m_ring + pos, length);
+		if(readLen <= 0) {
+			// if need loop, reset to first and read again
+			if(isLoop() && !reset) {
+				if(m_loop > 0)
+					m_loop--;
+				m_stream->reset();
+				reset = true;
+				continue;
+			}
+
+			// all data must be visible before end flag
+			wyMemoryBarrier();
+			m_decodeEnded = true;
+			break;
+		}
+
+		// data must be visible before write position
+		wyMemoryBarrier();
+		m_ringWrite += readLen;
+		decoded += readLen;
+		reset = false;
+	}
+
+	return decoded > 0;
+}
+
+bool wyAudioPlayer::isDrained() {
+	if(!m_decodeEnded)
+		return false;
+	wyMemoryBarrier();
+	return m_ringWrite == m_ringRead;
+}
+
 #endif // #if BACKEND_OPENAL
@@ -74,6 +74,42 @@ private:
     
 	/// temp buffer, only used for multi-buffer mode
 	char* m_tempBuffer;
+
+	/// pcm ring buffer, written by audio thread and read by update. Only used for multi-buffer mode
+	char* m_ring;
+
+	/// size of ring buffer, it is power of two
+	unsigned int m_ringSize;
+
+	/// total bytes read from ring buffer, only changed by consumer
+	volatile unsigned int m_ringRead;
+
+	/// total bytes written to ring buffer, only changed by producer
+	volatile unsigned int m_ringWrite;
+
+	/// true means stream is decoded to end and no more data will be written to ring
+	volatile bool m_decodeEnded;
+
+	/// OpenAL buffers which are not queued because ring buffer has no data
+	ALuint* m_freeBuffers;
+
+	/// count of free buffers
+	int m_freeCount;
+
+	/// true means source has been started after play
+	bool m_started;
+
+	/// times that source runs out of queued buffers when playing
+	int m_underrunCount;
+
+	/// times that ring buffer has no data when a buffer needs to be queued
+	int m_ringUnderrunCount;
+
+private:
+	/**
+	 * Queue free buffers with data in ring buffer
+	 */
+	void queueFreeBuffers();
     
 protected:
     /**
@@ -93,6 +129,24 @@ public:
      * @return audio player
      */
     static wyAudioPlayer* make(wyAudioStream* stream);
+
+    /**
+     * Decode whole stream and upload pcm data to an OpenAL buffer. The stream
+     * must be set up before calling it
+     *
+     * @param stream audio stream
+     * @param buffer OpenAL buffer id
+     * @return byte length of decoded pcm data, or 0 if nothing is decoded
+     */
+    static size_t decodeToBuffer(wyAudioStream* stream, ALuint buffer);
+
+    /**
+     * Get OpenAL format constant of an audio stream
+     *
+     * @param stream audio stream
+     * @return OpenAL format constant
+     */
+    static ALenum getALFormat(wyAudioStream* stream);
     
     /**
 	 * 开始播放这个音频流
@@ -152,19 +206,47 @@ public:
 	void setVolume(float volume);
     
     /**
-	 * 填充一个缓冲区
+	 * 用环形缓冲中的数据填充一个缓冲区, 不会调用解码器
 	 *
 	 * @param buffer 缓冲区id
-	 * @return 成功返回true, 失败返回false
+	 * @return 成功返回true, 环形缓冲中没有数据返回false
 	 */
 	bool fill(ALuint buffer);
+
+	/**
+	 * 解码音频流直到环形缓冲满了或音频流结束, 只在音频线程中调用
+	 *
+	 * @return true表示解码了新数据
+	 */
+	bool decodeAhead();
+
+	/**
+	 * 音频流是否已经解码完, 并且环形缓冲中的数据也已经读完了
+	 *
+	 * @return true表示没有更多数据了
+	 */
+	bool isDrained();
+
+	/**
+	 * Get times that source runs out of queued buffers when playing
+	 *
+	 * @return underrun count
+	 */
+	int getUnderrunCount() { return m_underrunCount; }
+
+	/**
+	 * Get times that decoded data is not ready when a buffer needs to be queued
+	 *
+	 * @return ring buffer underrun count
+	 */
+	int getRingUnderrunCount() { return m_ringUnderrunCount; }
     
     /**
 	 * 根据音频信息得到OpenAL格式常量
 	 *
 	 * @return OpenAL格式常量
 	 */
-	ALenum getALFormat();
+	ALenum getALFormat() { return getALFormat(m_stream); }
     
     /**
 	 * 设置循环次数
@@ -92,3 +92,19 @@ wyAudioManager::wyAudioManager() {
 
 wyAudioManager::~wyAudioManager() {
 }
+
+void wyAudioManager::setEffectPriority(int resId, int priority) {
+}
+
+void wyAudioManager::setEffectPriority(const char* path, int priority) {
+}
+
+void wyAudioManager::setEffectCacheSize(size_t size) {
+}
+
+void wyAudioManager::setStreamBufferDepth(float seconds) {
+}
+
+int wyAudioManager::getStreamUnderrunCount() {
+	return 0;
+}
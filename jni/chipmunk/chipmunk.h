@@ -106,6 +106,7 @@ CHIPMUNK_API void cpMessage(const char *message, const char *condition, const ch
 #include "cpArray.h"
 #include "cpHashSet.h"
 #include "cpSpaceHash.h"
+#include "cpBBTree.h"
 
 #include "cpBody.h"
 #include "cpShape.h"
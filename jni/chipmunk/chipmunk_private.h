@@ -47,3 +47,87 @@ cpSpaceUnlock(cpSpace *space)
 		waking->num = 0;
 	}
 }
+
+// Spatial index dispatch.
+// The shapes are kept in the trees if the space uses them, otherwise in the hashes.
+
+static inline void
+cpSpaceIndexInsert(cpSpace *space, cpShape *shape, cpBool isStatic)
+{
+	if(space->activeTree){
+		cpBBTreeInsert(isStatic ? space->staticTree : space->activeTree, shape, shape->hashid);
+	} else {
+		cpSpaceHashInsert(isStatic ? space->staticShapes : space->activeShapes, shape, shape->hashid, shape->bb);
+	}
+}
+
+static inline void
+cpSpaceIndexRemove(cpSpace *space, cpShape *shape, cpBool isStatic)
+{
+	if(space->activeTree){
+		cpBBTreeRemove(isStatic ? space->staticTree : space->activeTree, shape, shape->hashid);
+	} else {
+		cpSpaceHashRemove(isStatic ? space->staticShapes : space->activeShapes, shape, shape->hashid);
+	}
+}
+
+static inline cpBool
+cpSpaceIndexContains(cpSpace *space, cpShape *shape, cpBool isStatic)
+{
+	if(space->activeTree){
+		return cpBBTreeContains(isStatic ? space->staticTree : space->activeTree, shape, shape->hashid);
+	} else {
+		cpSpaceHash *hash = (isStatic ? space->staticShapes : space->activeShapes);
+		return (cpHashSetFind(hash->handleSet, shape->hashid, shape) != NULL);
+	}
+}
+
+static inline int
+cpSpaceIndexCount(cpSpace *space, cpBool isStatic)
+{
+	if(space->activeTree){
+		return cpBBTreeCount(isStatic ? space->staticTree : space->activeTree);
+	} else {
+		return (isStatic ? space->staticShapes : space->activeShapes)->handleSet->entries;
+	}
+}
+
+static inline void
+cpSpaceIndexEach(cpSpace *space, cpBool isStatic, cpSpaceHashIterator func, void *data)
+{
+	if(space->activeTree){
+		cpBBTreeEach(isStatic ? space->staticTree : space->activeTree, func, data);
+	} else {
+		cpSpaceHashEach(isStatic ? space->staticShapes : space->activeShapes, func, data);
+	}
+}
+
+static inline void
+cpSpaceIndexQuery(cpSpace *space, cpBool isStatic, void *obj, cpBB bb, cpSpaceHashQueryFunc func, void *data)
+{
+	if(space->activeTree){
+		cpBBTreeQuery(isStatic ? space->staticTree : space->activeTree, obj, bb, func, data);
+	} else {
+		cpSpaceHashQuery(isStatic ? space->staticShapes : space->activeShapes, obj, bb, func, data);
+	}
+}
+
+static inline void
+cpSpaceIndexPointQuery(cpSpace *space, cpBool isStatic, cpVect point, cpSpaceHashQueryFunc func, void *data)
+{
+	if(space->activeTree){
+		cpBBTreePointQuery(isStatic ? space->staticTree : space->activeTree, point, func, data);
+	} else {
+		cpSpaceHashPointQuery(isStatic ? space->staticShapes : space->activeShapes, point, func, data);
+	}
+}
+
+static inline void
+cpSpaceIndexSegmentQuery(cpSpace *space, cpBool isStatic, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpaceHashSegmentQueryFunc func, void *data)
+{
+	if(space->activeTree){
+		cpBBTreeSegmentQuery(isStatic ? space->staticTree : space->activeTree, obj, a, b, t_exit, func, data);
+	} else {
+		cpSpaceHashSegmentQuery(isStatic ? space->staticShapes : space->activeShapes, obj, a, b, t_exit, func, data);
+	}
+}
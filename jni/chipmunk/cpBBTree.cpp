@@ -0,0 +1,751 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "chipmunk_private.h"
+
+typedef struct cpBBTreeNode Node;
+typedef struct cpBBTreePair Pair;
+
+// A leaf has a non NULL obj. Leaves keep a linked list of the pairs they are part of,
+// branches keep their two children.
+struct cpBBTreeNode {
+	void *obj;
+	cpBB bb;
+	Node *parent;
+	
+	union {
+		// Branch
+		struct {
+			Node *a, *b;
+		} children;
+		
+		// Leaf
+		struct {
+			cpTimestamp stamp;
+			Pair *pairs;
+		} leaf;
+	} node;
+};
+
+// Can't use anonymous unions and still get good x-compiler compatability
+#define A node.children.a
+#define B node.children.b
+#define STAMP node.leaf.stamp
+#define PAIRS node.leaf.pairs
+
+// A pair is threaded into the pair lists of both of its leaves.
+typedef struct Thread {
+	Pair *prev;
+	Node *leaf;
+	Pair *next;
+} Thread;
+
+struct cpBBTreePair {
+	Thread a, b;
+};
+
+#pragma mark Misc Functions
+
+static inline cpFloat
+bbArea(cpBB bb)
+{
+	return (bb.r - bb.l)*(bb.t - bb.b);
+}
+
+static inline cpFloat
+bbMergedArea(cpBB a, cpBB b)
+{
+	return (cpfmax(a.r, b.r) - cpfmin(a.l, b.l))*(cpfmax(a.t, b.t) - cpfmin(a.b, b.b));
+}
+
+static inline cpFloat
+bbProximity(cpBB a, cpBB b)
+{
+	return cpfabs(a.l + a.r - b.l - b.r) + cpfabs(a.b + a.t - b.b - b.t);
+}
+
+// cpBBcontainsBB() is strict, an unmoved object must still fit in its leaf.
+static inline cpBool
+bbContains(cpBB bb, cpBB other)
+{
+	return (bb.l <= other.l && bb.r >= other.r && bb.b <= other.b && bb.t >= other.t);
+}
+
+// Returns the fraction along the segment where it enters the bb, or INFINITY if it misses.
+static inline cpFloat
+bbSegmentQuery(cpBB bb, cpVect a, cpVect b)
+{
+	cpFloat idx = 1.0f/(b.x - a.x);
+	cpFloat tx1 = (bb.l == a.x ? -INFINITY : (bb.l - a.x)*idx);
+	cpFloat tx2 = (bb.r == a.x ?  INFINITY : (bb.r - a.x)*idx);
+	cpFloat txmin = cpfmin(tx1, tx2);
+	cpFloat txmax = cpfmax(tx1, tx2);
+	
+	cpFloat idy = 1.0f/(b.y - a.y);
+	cpFloat ty1 = (bb.b == a.y ? -INFINITY : (bb.b - a.y)*idy);
+	cpFloat ty2 = (bb.t == a.y ?  INFINITY : (bb.t - a.y)*idy);
+	cpFloat tymin = cpfmin(ty1, ty2);
+	cpFloat tymax = cpfmax(ty1, ty2);
+	
+	if(tymin <= txmax && txmin <= tymax){
+		cpFloat tmin = cpfmax(txmin, tymin);
+		cpFloat tmax = cpfmin(txmax, tymax);
+		
+		if(0.0f <= tmax && tmin <= 1.0f) return cpfmax(tmin, 0.0f);
+	}
+	
+	return INFINITY;
+}
+
+// Fattened bounding box of an object. Padded by a tenth of its size plus
+// the distance it would travel in a tenth of a second.
+static inline cpBB
+getBB(cpBBTree *tree, void *obj)
+{
+	cpBB bb = tree->bbfunc(obj);
+	
+	cpBBTreeVelocityFunc velocityFunc = tree->velocityFunc;
+	if(velocityFunc){
+		cpFloat coef = 0.1f;
+		cpFloat x = (bb.r - bb.l)*coef;
+		cpFloat y = (bb.t - bb.b)*coef;
+		
+		cpVect v = cpvmult(velocityFunc(obj), 0.1f);
+		return cpBBNew(bb.l + cpfmin(-x, v.x), bb.b + cpfmin(-y, v.y), bb.r + cpfmax(x, v.x), bb.t + cpfmax(y, v.y));
+	} else {
+		return bb;
+	}
+}
+
+// Pairs and stamps are shared with the paired static tree and are owned by the dynamic tree.
+static inline cpBBTree *
+getMasterTree(cpBBTree *tree)
+{
+	return (tree->dynamicTree ? tree->dynamicTree : tree);
+}
+
+static inline void
+incrementStamp(cpBBTree *tree)
+{
+	getMasterTree(tree)->stamp++;
+}
+
+#pragma mark Pair/Thread Functions
+
+static void
+pairRecycle(cpBBTree *tree, Pair *pair)
+{
+	tree = getMasterTree(tree);
+	
+	pair->a.next = tree->pooledPairs;
+	tree->pooledPairs = pair;
+}
+
+static Pair *
+pairFromPool(cpBBTree *tree)
+{
+	tree = getMasterTree(tree);
+	
+	Pair *pair = tree->pooledPairs;
+	
+	if(pair){
+		tree->pooledPairs = pair->a.next;
+		return pair;
+	} else {
+		// Pool is exhausted, make more
+		int count = CP_BUFFER_BYTES/sizeof(Pair);
+		cpAssert(count, "Buffer size is too small.");
+		
+		Pair *buffer = (Pair *)cpmalloc(CP_BUFFER_BYTES);
+		cpArrayPush(tree->allocatedBuffers, buffer);
+		
+		// push all but the first one, return the first instead
+		for(int i=1; i<count; i++) pairRecycle(tree, buffer + i);
+		return buffer;
+	}
+}
+
+static inline void
+threadUnlink(Thread thread)
+{
+	Pair *next = thread.next;
+	Pair *prev = thread.prev;
+	
+	if(next){
+		if(next->a.leaf == thread.leaf) next->a.prev = prev; else next->b.prev = prev;
+	}
+	
+	if(prev){
+		if(prev->a.leaf == thread.leaf) prev->a.next = next; else prev->b.next = next;
+	} else {
+		thread.leaf->PAIRS = next;
+	}
+}
+
+// Drop all the pairs of a leaf.
+static void
+pairsClear(Node *leaf, cpBBTree *tree)
+{
+	Pair *pair = leaf->PAIRS;
+	leaf->PAIRS = NULL;
+	
+	while(pair){
+		if(pair->a.leaf == leaf){
+			Pair *next = pair->a.next;
+			threadUnlink(pair->b);
+			pairRecycle(tree, pair);
+			pair = next;
+		} else {
+			Pair *next = pair->b.next;
+			threadUnlink(pair->a);
+			pairRecycle(tree, pair);
+			pair = next;
+		}
+	}
+}
+
+// The callback for a pair is called when its 'b' leaf is marked.
+static void
+pairInsert(Node *a, Node *b, cpBBTree *tree)
+{
+	Pair *nextA = a->PAIRS, *nextB = b->PAIRS;
+	Pair *pair = pairFromPool(tree);
+	
+	pair->a.prev = NULL;
+	pair->a.leaf = a;
+	pair->a.next = nextA;
+	pair->b.prev = NULL;
+	pair->b.leaf = b;
+	pair->b.next = nextB;
+	
+	a->PAIRS = b->PAIRS = pair;
+	
+	if(nextA){
+		if(nextA->a.leaf == a) nextA->a.prev = pair; else nextA->b.prev = pair;
+	}
+	
+	if(nextB){
+		if(nextB->a.leaf == b) nextB->a.prev = pair; else nextB->b.prev = pair;
+	}
+}
+
+#pragma mark Node Functions
+
+static void
+nodeRecycle(cpBBTree *tree, Node *node)
+{
+	node->parent = tree->pooledNodes;
+	tree->pooledNodes = node;
+}
+
+static Node *
+nodeFromPool(cpBBTree *tree)
+{
+	Node *node = tree->pooledNodes;
+	
+	if(node){
+		tree->pooledNodes = node->parent;
+		return node;
+	} else {
+		// Pool is exhausted, make more
+		int count = CP_BUFFER_BYTES/sizeof(Node);
+		cpAssert(count, "Buffer size is too small.");
+		
+		Node *buffer = (Node *)cpmalloc(CP_BUFFER_BYTES);
+		cpArrayPush(tree->allocatedBuffers, buffer);
+		
+		// push all but the first one, return the first instead
+		for(int i=1; i<count; i++) nodeRecycle(tree, buffer + i);
+		return buffer;
+	}
+}
+
+static inline void
+nodeSetA(Node *node, Node *value)
+{
+	node->A = value;
+	value->parent = node;
+}
+
+static inline void
+nodeSetB(Node *node, Node *value)
+{
+	node->B = value;
+	value->parent = node;
+}
+
+static Node *
+nodeNew(cpBBTree *tree, Node *a, Node *b)
+{
+	Node *node = nodeFromPool(tree);
+	
+	node->obj = NULL;
+	node->bb = cpBBmerge(a->bb, b->bb);
+	node->parent = NULL;
+	
+	nodeSetA(node, a);
+	nodeSetB(node, b);
+	
+	return node;
+}
+
+static inline cpBool nodeIsLeaf(Node *node){return (node->obj != NULL);}
+
+static inline Node *
+nodeOther(Node *node, Node *child)
+{
+	return (node->A == child ? node->B : node->A);
+}
+
+// Replace a child of parent (which is recycled) and refit the bbs up to the root.
+static inline void
+nodeReplaceChild(Node *parent, Node *child, Node *value, cpBBTree *tree)
+{
+	cpAssert(!nodeIsLeaf(parent), "Internal Error: Cannot replace child of a leaf.");
+	cpAssert(child == parent->A || child == parent->B, "Internal Error: Node is not a child of parent.");
+	
+	if(parent->A == child){
+		nodeRecycle(tree, parent->A);
+		nodeSetA(parent, value);
+	} else {
+		nodeRecycle(tree, parent->B);
+		nodeSetB(parent, value);
+	}
+	
+	for(Node *node=parent; node; node = node->parent){
+		node->bb = cpBBmerge(node->A->bb, node->B->bb);
+	}
+}
+
+#pragma mark Subtree Functions
+
+// Insert a leaf and return the new subtree root.
+// Descends into the child whose area would grow the least.
+static Node *
+subtreeInsert(Node *subtree, Node *leaf, cpBBTree *tree)
+{
+	if(subtree == NULL){
+		return leaf;
+	} else if(nodeIsLeaf(subtree)){
+		return nodeNew(tree, leaf, subtree);
+	} else {
+		cpFloat cost_a = bbArea(subtree->B->bb) + bbMergedArea(subtree->A->bb, leaf->bb);
+		cpFloat cost_b = bbArea(subtree->A->bb) + bbMergedArea(subtree->B->bb, leaf->bb);
+		
+		if(cost_a == cost_b){
+			cost_a = bbProximity(subtree->A->bb, leaf->bb);
+			cost_b = bbProximity(subtree->B->bb, leaf->bb);
+		}
+		
+		if(cost_b < cost_a){
+			nodeSetB(subtree, subtreeInsert(subtree->B, leaf, tree));
+		} else {
+			nodeSetA(subtree, subtreeInsert(subtree->A, leaf, tree));
+		}
+		
+		subtree->bb = cpBBmerge(subtree->bb, leaf->bb);
+		return subtree;
+	}
+}
+
+// Remove a leaf and return the new subtree root. The leaf itself is not recycled.
+static inline Node *
+subtreeRemove(Node *subtree, Node *leaf, cpBBTree *tree)
+{
+	if(leaf == subtree){
+		return NULL;
+	} else {
+		Node *parent = leaf->parent;
+		if(parent == subtree){
+			Node *other = nodeOther(subtree, leaf);
+			other->parent = subtree->parent;
+			nodeRecycle(tree, subtree);
+			return other;
+		} else {
+			nodeReplaceChild(parent->parent, parent, nodeOther(parent, leaf), tree);
+			return subtree;
+		}
+	}
+}
+
+static void
+subtreeQuery(Node *subtree, void *obj, cpBB bb, cpSpaceHashQueryFunc func, void *data)
+{
+	if(cpBBintersects(subtree->bb, bb)){
+		if(nodeIsLeaf(subtree)){
+			if(subtree->obj != obj) func(obj, subtree->obj, data);
+		} else {
+			subtreeQuery(subtree->A, obj, bb, func, data);
+			subtreeQuery(subtree->B, obj, bb, func, data);
+		}
+	}
+}
+
+// Visits the nearer child first so that hits can clip the segment for the farther one.
+static cpFloat
+subtreeSegmentQuery(Node *subtree, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpaceHashSegmentQueryFunc func, void *data)
+{
+	if(nodeIsLeaf(subtree)){
+		return func(obj, subtree->obj, data);
+	} else {
+		cpFloat t_a = bbSegmentQuery(subtree->A->bb, a, b);
+		cpFloat t_b = bbSegmentQuery(subtree->B->bb, a, b);
+		
+		if(t_a < t_b){
+			if(t_a < t_exit) t_exit = cpfmin(t_exit, subtreeSegmentQuery(subtree->A, obj, a, b, t_exit, func, data));
+			if(t_b < t_exit) t_exit = cpfmin(t_exit, subtreeSegmentQuery(subtree->B, obj, a, b, t_exit, func, data));
+		} else {
+			if(t_b < t_exit) t_exit = cpfmin(t_exit, subtreeSegmentQuery(subtree->B, obj, a, b, t_exit, func, data));
+			if(t_a < t_exit) t_exit = cpfmin(t_exit, subtreeSegmentQuery(subtree->A, obj, a, b, t_exit, func, data));
+		}
+		
+		return t_exit;
+	}
+}
+
+#pragma mark Marking Functions
+
+typedef struct MarkContext {
+	cpBBTree *tree;
+	Node *staticRoot;
+	cpSpaceHashQueryFunc func;
+	void *data;
+} MarkContext;
+
+// Find the leaves of subtree overlapping leaf. Leaves on the left only record pairs,
+// the callback is called when the leaf on the right side is marked later in the traversal.
+static void
+markLeafQuery(Node *subtree, Node *leaf, cpBool left, MarkContext *context)
+{
+	if(cpBBintersects(leaf->bb, subtree->bb)){
+		if(nodeIsLeaf(subtree)){
+			if(left){
+				pairInsert(leaf, subtree, context->tree);
+			} else {
+				if(subtree->STAMP < leaf->STAMP) pairInsert(subtree, leaf, context->tree);
+				if(context->func) context->func(leaf->obj, subtree->obj, context->data);
+			}
+		} else {
+			markLeafQuery(subtree->A, leaf, left, context);
+			markLeafQuery(subtree->B, leaf, left, context);
+		}
+	}
+}
+
+// Leaves reinserted since the last reindex query the tree for new pairs,
+// all the others just replay their cached pairs.
+static void
+markLeaf(Node *leaf, MarkContext *context)
+{
+	cpBBTree *tree = context->tree;
+	if(leaf->STAMP == getMasterTree(tree)->stamp){
+		Node *staticRoot = context->staticRoot;
+		if(staticRoot) markLeafQuery(staticRoot, leaf, cpFalse, context);
+		
+		for(Node *node = leaf; node->parent; node = node->parent){
+			if(node == node->parent->A){
+				markLeafQuery(node->parent->B, leaf, cpTrue, context);
+			} else {
+				markLeafQuery(node->parent->A, leaf, cpFalse, context);
+			}
+		}
+	} else if(context->func){
+		Pair *pair = leaf->PAIRS;
+		while(pair){
+			if(leaf == pair->b.leaf){
+				context->func(pair->a.leaf->obj, leaf->obj, context->data);
+				pair = pair->b.next;
+			} else {
+				pair = pair->a.next;
+			}
+		}
+	}
+}
+
+static void
+markSubtree(Node *subtree, MarkContext *context)
+{
+	if(nodeIsLeaf(subtree)){
+		markLeaf(subtree, context);
+	} else {
+		markSubtree(subtree->A, context);
+		markSubtree(subtree->B, context);
+	}
+}
+
+#pragma mark Leaf Functions
+
+static Node *
+leafNew(cpBBTree *tree, void *obj)
+{
+	Node *node = nodeFromPool(tree);
+	node->obj = obj;
+	node->bb = getBB(tree, obj);
+	
+	node->parent = NULL;
+	node->STAMP = 0;
+	node->PAIRS = NULL;
+	
+	return node;
+}
+
+// Reinsert the leaf if the object moved out of its fattened bb. Returns true if it was reinserted.
+static cpBool
+leafUpdate(Node *leaf, cpBBTree *tree)
+{
+	cpBB bb = tree->bbfunc(leaf->obj);
+	
+	if(!bbContains(leaf->bb, bb)){
+		leaf->bb = getBB(tree, leaf->obj);
+		
+		Node *root = subtreeRemove(tree->root, leaf, tree);
+		tree->root = subtreeInsert(root, leaf, tree);
+		
+		pairsClear(leaf, tree);
+		leaf->STAMP = getMasterTree(tree)->stamp;
+		
+		return cpTrue;
+	}
+	
+	return cpFalse;
+}
+
+// Build the pairs of a newly (re)inserted leaf without calling any callbacks.
+static void
+leafAddPairs(Node *leaf, cpBBTree *tree)
+{
+	cpBBTree *dynamicTree = tree->dynamicTree;
+	if(dynamicTree){
+		// Static leaves are always the 'a' side of their pairs.
+		if(dynamicTree->root){
+			MarkContext context = {dynamicTree, NULL, NULL, NULL};
+			markLeafQuery(dynamicTree->root, leaf, cpTrue, &context);
+		}
+	} else {
+		Node *staticRoot = (tree->staticTree ? tree->staticTree->root : NULL);
+		MarkContext context = {tree, staticRoot, NULL, NULL};
+		markLeaf(leaf, &context);
+	}
+}
+
+static void leafUpdateWrap(Node *leaf, cpBBTree *tree){leafUpdate(leaf, tree);}
+
+static void
+leafUpdateAddPairsWrap(Node *leaf, cpBBTree *tree)
+{
+	if(leafUpdate(leaf, tree)) leafAddPairs(leaf, tree);
+}
+
+#pragma mark Memory Management Functions
+
+// Equality function for the leaf set.
+static int leafSetEql(void *obj, Node *node){return (obj == node->obj);}
+
+// Transformation function for the leaf set.
+static void *leafSetTrans(void *obj, cpBBTree *tree){return leafNew(tree, obj);}
+
+cpBBTree*
+cpBBTreeAlloc(void)
+{
+	return (cpBBTree *)cpcalloc(1, sizeof(cpBBTree));
+}
+
+cpBBTree*
+cpBBTreeInit(cpBBTree *tree, cpSpaceHashBBFunc bbfunc)
+{
+	tree->bbfunc = bbfunc;
+	tree->velocityFunc = NULL;
+	
+	tree->staticTree = NULL;
+	tree->dynamicTree = NULL;
+	
+	tree->leaves = cpHashSetNew(0, (cpHashSetEqlFunc)leafSetEql, (cpHashSetTransFunc)leafSetTrans);
+	tree->root = NULL;
+	
+	tree->pooledNodes = NULL;
+	tree->pooledPairs = NULL;
+	tree->allocatedBuffers = cpArrayNew(0);
+	
+	tree->stamp = 0;
+	
+	return tree;
+}
+
+cpBBTree*
+cpBBTreeNew(cpSpaceHashBBFunc bbfunc)
+{
+	return cpBBTreeInit(cpBBTreeAlloc(), bbfunc);
+}
+
+static void freeWrap(void *ptr, void *unused){cpfree(ptr);}
+
+void
+cpBBTreeDestroy(cpBBTree *tree)
+{
+	// Unpair the trees, the pairs between them are owned by the dynamic tree.
+	if(tree->staticTree) tree->staticTree->dynamicTree = NULL;
+	if(tree->dynamicTree) tree->dynamicTree->staticTree = NULL;
+	
+	cpHashSetFree(tree->leaves);
+	
+	cpArrayEach(tree->allocatedBuffers, freeWrap, NULL);
+	cpArrayFree(tree->allocatedBuffers);
+}
+
+void
+cpBBTreeFree(cpBBTree *tree)
+{
+	if(tree){
+		cpBBTreeDestroy(tree);
+		cpfree(tree);
+	}
+}
+
+void
+cpBBTreeSetVelocityFunc(cpBBTree *tree, cpBBTreeVelocityFunc func)
+{
+	tree->velocityFunc = func;
+}
+
+void
+cpBBTreeSetStaticTree(cpBBTree *tree, cpBBTree *staticTree)
+{
+	cpAssert(!tree->root && !staticTree->root, "Trees must be empty when they are paired.");
+	
+	tree->staticTree = staticTree;
+	staticTree->dynamicTree = tree;
+}
+
+#pragma mark Insert/Remove
+
+void
+cpBBTreeInsert(cpBBTree *tree, void *obj, cpHashValue hashid)
+{
+	Node *leaf = (Node *)cpHashSetInsert(tree->leaves, hashid, obj, tree);
+	
+	tree->root = subtreeInsert(tree->root, leaf, tree);
+	
+	leaf->STAMP = getMasterTree(tree)->stamp;
+	leafAddPairs(leaf, tree);
+	incrementStamp(tree);
+}
+
+void
+cpBBTreeRemove(cpBBTree *tree, void *obj, cpHashValue hashid)
+{
+	Node *leaf = (Node *)cpHashSetRemove(tree->leaves, hashid, obj);
+	
+	if(leaf){
+		tree->root = subtreeRemove(tree->root, leaf, tree);
+		pairsClear(leaf, tree);
+		nodeRecycle(tree, leaf);
+	}
+}
+
+cpBool
+cpBBTreeContains(cpBBTree *tree, void *obj, cpHashValue hashid)
+{
+	return (cpHashSetFind(tree->leaves, hashid, obj) != NULL);
+}
+
+int
+cpBBTreeCount(cpBBTree *tree)
+{
+	return tree->leaves->entries;
+}
+
+typedef struct eachPair {
+	cpSpaceHashIterator func;
+	void *data;
+} eachPair;
+
+static void eachHelper(Node *leaf, eachPair *pair){pair->func(leaf->obj, pair->data);}
+
+void
+cpBBTreeEach(cpBBTree *tree, cpSpaceHashIterator func, void *data)
+{
+	eachPair pair = {func, data};
+	cpHashSetEach(tree->leaves, (cpHashSetIterFunc)eachHelper, &pair);
+}
+
+#pragma mark Reindex
+
+void
+cpBBTreeReindexQuery(cpBBTree *tree, cpSpaceHashQueryFunc func, void *data)
+{
+	if(!tree->root) return;
+	
+	// leafUpdate() may modify tree->root. Don't cache it.
+	cpHashSetEach(tree->leaves, (cpHashSetIterFunc)leafUpdateWrap, tree);
+	
+	Node *staticRoot = (tree->staticTree ? tree->staticTree->root : NULL);
+	MarkContext context = {tree, staticRoot, func, data};
+	markSubtree(tree->root, &context);
+	
+	incrementStamp(tree);
+}
+
+void
+cpBBTreeReindex(cpBBTree *tree)
+{
+	if(tree->dynamicTree){
+		// A static tree only has pairs with the dynamic tree, add them leaf by leaf.
+		cpHashSetEach(tree->leaves, (cpHashSetIterFunc)leafUpdateAddPairsWrap, tree);
+		incrementStamp(tree);
+	} else {
+		cpBBTreeReindexQuery(tree, NULL, NULL);
+	}
+}
+
+void
+cpBBTreeReindexObject(cpBBTree *tree, void *obj, cpHashValue hashid)
+{
+	Node *leaf = (Node *)cpHashSetFind(tree->leaves, hashid, obj);
+	
+	if(leaf){
+		if(leafUpdate(leaf, tree)) leafAddPairs(leaf, tree);
+		incrementStamp(tree);
+	}
+}
+
+#pragma mark Query
+
+void
+cpBBTreePointQuery(cpBBTree *tree, cpVect point, cpSpaceHashQueryFunc func, void *data)
+{
+	if(tree->root) subtreeQuery(tree->root, &point, cpBBNew(point.x, point.y, point.x, point.y), func, data);
+}
+
+void
+cpBBTreeQuery(cpBBTree *tree, void *obj, cpBB bb, cpSpaceHashQueryFunc func, void *data)
+{
+	if(tree->root) subtreeQuery(tree->root, obj, bb, func, data);
+}
+
+void
+cpBBTreeSegmentQuery(cpBBTree *tree, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpaceHashSegmentQueryFunc func, void *data)
+{
+	Node *root = tree->root;
+	if(root && bbSegmentQuery(root->bb, a, b) < t_exit) subtreeSegmentQuery(root, obj, a, b, t_exit, func, data);
+}
@@ -0,0 +1,103 @@
+/* Copyright (c) 2007 Scott Lembcke
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Dynamic AABB tree spatial index. An alternative to cpSpaceHash that doesn't need
+// to be tuned for the shape sizes and works well with mixed sizes and open worlds.
+// Leaves store fattened bounding boxes so that objects which move only a little don't
+// have to be reinserted, and overlapping leaves are remembered in a pair cache that
+// is only rebuilt for the leaves that were reinserted.
+//
+// The query, segment query and iterator callbacks are the same as cpSpaceHash's.
+
+struct cpBBTreeNode;
+struct cpBBTreePair;
+
+// Velocity callback. If set, the fattened bounding boxes are stretched in the direction of movement.
+typedef cpVect (*cpBBTreeVelocityFunc)(void *obj);
+
+typedef struct CHIPMUNK_API cpBBTree{
+	// BBox callback.
+	CP_PRIVATE(cpSpaceHashBBFunc bbfunc);
+	// Velocity callback, may be NULL.
+	CP_PRIVATE(cpBBTreeVelocityFunc velocityFunc);
+	
+	// The static tree paired with this one, or the dynamic tree this one is paired with.
+	// Pairs between the two trees are always owned by the dynamic tree.
+	CP_PRIVATE(struct cpBBTree *staticTree);
+	CP_PRIVATE(struct cpBBTree *dynamicTree);
+	
+	// Hashset of the leaves.
+	CP_PRIVATE(cpHashSet *leaves);
+	CP_PRIVATE(struct cpBBTreeNode *root);
+	
+	// Recycled nodes and pairs.
+	CP_PRIVATE(struct cpBBTreeNode *pooledNodes);
+	CP_PRIVATE(struct cpBBTreePair *pooledPairs);
+	
+	// list of buffers to free on destruction.
+	CP_PRIVATE(cpArray *allocatedBuffers);
+	
+	// Incremented on each insert and reindex. Leaves stamped with the current value were
+	// (re)inserted since the last reindex and need their pairs to be rebuilt.
+	CP_PRIVATE(cpTimestamp stamp);
+} cpBBTree;
+
+//Basic allocation/destruction functions.
+CHIPMUNK_API cpBBTree *cpBBTreeAlloc(void);
+CHIPMUNK_API cpBBTree *cpBBTreeInit(cpBBTree *tree, cpSpaceHashBBFunc bbfunc);
+CHIPMUNK_API cpBBTree *cpBBTreeNew(cpSpaceHashBBFunc bbfunc);
+
+CHIPMUNK_API void cpBBTreeDestroy(cpBBTree *tree);
+CHIPMUNK_API void cpBBTreeFree(cpBBTree *tree);
+
+// Set the velocity callback used to fatten the bounding boxes.
+CHIPMUNK_API void cpBBTreeSetVelocityFunc(cpBBTree *tree, cpBBTreeVelocityFunc func);
+// Pair a dynamic tree with a static tree. cpBBTreeReindexQuery() on the dynamic tree
+// will then report the dynamic/static pairs too. Must be called while both trees are empty.
+CHIPMUNK_API void cpBBTreeSetStaticTree(cpBBTree *tree, cpBBTree *staticTree);
+
+// Add an object to the tree.
+CHIPMUNK_API void cpBBTreeInsert(cpBBTree *tree, void *obj, cpHashValue id);
+// Remove an object from the tree.
+CHIPMUNK_API void cpBBTreeRemove(cpBBTree *tree, void *obj, cpHashValue id);
+// Return true if the object is in the tree.
+CHIPMUNK_API cpBool cpBBTreeContains(cpBBTree *tree, void *obj, cpHashValue id);
+// Number of objects in the tree.
+CHIPMUNK_API int cpBBTreeCount(cpBBTree *tree);
+
+// Iterate over the objects in the tree.
+CHIPMUNK_API void cpBBTreeEach(cpBBTree *tree, cpSpaceHashIterator func, void *data);
+
+// Update the leaves of objects that moved out of their fattened bounding boxes.
+CHIPMUNK_API void cpBBTreeReindex(cpBBTree *tree);
+// Update only a specific object.
+CHIPMUNK_API void cpBBTreeReindexObject(cpBBTree *tree, void *obj, cpHashValue id);
+
+// Point query the tree. A reference to the query point is passed as obj1 to the query callback.
+CHIPMUNK_API void cpBBTreePointQuery(cpBBTree *tree, cpVect point, cpSpaceHashQueryFunc func, void *data);
+// Query the tree for a given BBox.
+CHIPMUNK_API void cpBBTreeQuery(cpBBTree *tree, void *obj, cpBB bb, cpSpaceHashQueryFunc func, void *data);
+// Reindex the tree, then call func for every cached pair of overlapping leaves. (Optimized case)
+// Pairs with the static tree set by cpBBTreeSetStaticTree() are included.
+CHIPMUNK_API void cpBBTreeReindexQuery(cpBBTree *tree, cpSpaceHashQueryFunc func, void *data);
+// Segment query the tree. The return value of func is used to clip the segment as the
+// tree is traversed front to back.
+CHIPMUNK_API void cpBBTreeSegmentQuery(cpBBTree *tree, void *obj, cpVect a, cpVect b, cpFloat t_exit, cpSpaceHashSegmentQueryFunc func, void *data);
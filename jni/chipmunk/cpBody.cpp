@@ -69,6 +69,10 @@ cpBodyInit(cpBody *body, cpFloat m, cpFloat i)
 	
 	cpComponentNode node = {NULL, NULL, 0, 0.0f};
 	body->node = node;
+	
+	body->p_prev = cpvzero;
+	body->a_prev = 0.0f;
+	body->prev_stamp = (cpTimestamp)-1;
 
 #if ANDROID
 	body->velocityUpdater = NULL;
@@ -104,6 +104,12 @@ typedef struct CHIPMUNK_API cpBody{
 	
 	// Used by cpSpaceStep() to store contact graph information.
 	CP_PRIVATE(cpComponentNode node);
+	
+	// Position and angle before a fixed step, and the space stamp when they were saved.
+	// Used by wyChipmunk to interpolate rendering between steps.
+	CP_PRIVATE(cpVect p_prev);
+	CP_PRIVATE(cpFloat a_prev);
+	CP_PRIVATE(cpTimestamp prev_stamp);
 } cpBody;
 
 // Basic allocation/destruction functions
@@ -129,6 +129,8 @@ cpSpaceInit(cpSpace *space)
 
 	space->staticShapes = cpSpaceHashNew(DEFAULT_DIM_SIZE, DEFAULT_COUNT, (cpSpaceHashBBFunc)shapeBBFunc);
 	space->activeShapes = cpSpaceHashNew(DEFAULT_DIM_SIZE, DEFAULT_COUNT, (cpSpaceHashBBFunc)shapeBBFunc);
+	space->staticTree = NULL;
+	space->activeTree = NULL;
 	
 	space->allocatedBuffers = cpArrayNew(0);
 	
@@ -169,6 +171,8 @@ cpSpaceDestroy(cpSpace *space)
 {
 	cpSpaceHashFree(space->staticShapes);
 	cpSpaceHashFree(space->activeShapes);
+	cpBBTreeFree(space->staticTree);
+	cpBBTreeFree(space->activeTree);
 	
 	cpArrayFree(space->bodies);
 	cpArrayFree(space->sleepingComponents);
@@ -212,8 +216,8 @@ cpSpaceFreeChildren(cpSpace *space)
 	cpArray *components = space->sleepingComponents;
 	while(components->num) cpBodyActivate((cpBody *)components->arr[0]);
 	
-	cpSpaceHashEach(space->staticShapes, (cpSpaceHashIterator)&shapeFreeWrap, NULL);
-	cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)&shapeFreeWrap, NULL);
+	cpSpaceIndexEach(space, cpTrue, (cpSpaceHashIterator)&shapeFreeWrap, NULL);
+	cpSpaceIndexEach(space, cpFalse, (cpSpaceHashIterator)&shapeFreeWrap, NULL);
 	cpArrayEach(space->bodies,           (cpArrayIter)&bodyFreeWrap,          NULL);
 	cpArrayEach(space->constraints,      (cpArrayIter)&constraintFreeWrap,    NULL);
 }
@@ -349,7 +353,7 @@ cpSpaceAddShape(cpSpace *space, cpShape *shape)
 	cpBody *body = shape->body;
 	if(!body || cpBodyIsStatic(body)) return cpSpaceAddStaticShape(space, shape);
 	
-	cpAssert(!cpHashSetFind(space->activeShapes->handleSet, shape->hashid, shape),
+	cpAssert(!cpSpaceIndexContains(space, shape, cpFalse),
 		"Cannot add the same shape more than once.");
 	cpAssertSpaceUnlocked(space);
 	
@@ -357,7 +361,7 @@ cpSpaceAddShape(cpSpace *space, cpShape *shape)
 	cpBodyAddShape(body, shape);
 	
 	cpShapeCacheBB(shape);
-	cpSpaceHashInsert(space->activeShapes, shape, shape->hashid, shape->bb);
+	cpSpaceIndexInsert(space, shape, cpFalse);
 		
 	return shape;
 }
@@ -365,7 +369,7 @@ cpSpaceAddShape(cpSpace *space, cpShape *shape)
 cpShape *
 cpSpaceAddStaticShape(cpSpace *space, cpShape *shape)
 {
-	cpAssert(!cpHashSetFind(space->staticShapes->handleSet, shape->hashid, shape),
+	cpAssert(!cpSpaceIndexContains(space, shape, cpTrue),
 		"Cannot add the same static shape more than once.");
 	cpAssertSpaceUnlocked(space);
 	
@@ -373,7 +377,7 @@ cpSpaceAddStaticShape(cpSpace *space, cpShape *shape)
 	
 	cpShapeCacheBB(shape);
 	cpSpaceActivateShapesTouchingShape(space, shape);
-	cpSpaceHashInsert(space->staticShapes, shape, shape->hashid, shape->bb);
+	cpSpaceIndexInsert(space, shape, cpTrue);
 	
 	return shape;
 }
@@ -440,26 +444,26 @@ cpSpaceRemoveShape(cpSpace *space, cpShape *shape)
 	cpBodyActivate(body);
 	
 	cpAssertSpaceUnlocked(space);
-	cpAssertWarn(cpHashSetFind(space->activeShapes->handleSet, shape->hashid, shape),
+	cpAssertWarn(cpSpaceIndexContains(space, shape, cpFalse),
 		"Cannot remove a shape that was not added to the space. (Removed twice maybe?)");
 	
 	cpBodyRemoveShape(body, shape);
 	
 	removalContext context = {space, shape};
 	cpHashSetFilter(space->contactSet, (cpHashSetFilterFunc)contactSetFilterRemovedShape, &context);
-	cpSpaceHashRemove(space->activeShapes, shape, shape->hashid);
+	cpSpaceIndexRemove(space, shape, cpFalse);
 }
 
 void
 cpSpaceRemoveStaticShape(cpSpace *space, cpShape *shape)
 {
-	cpAssertWarn(cpHashSetFind(space->staticShapes->handleSet, shape->hashid, shape),
+	cpAssertWarn(cpSpaceIndexContains(space, shape, cpTrue),
 		"Cannot remove a static or sleeping shape that was not added to the space. (Removed twice maybe?)");
 	cpAssertSpaceUnlocked(space);
 	
 	removalContext context = {space, shape};
 	cpHashSetFilter(space->contactSet, (cpHashSetFilterFunc)contactSetFilterRemovedShape, &context);
-	cpSpaceHashRemove(space->staticShapes, shape, shape->hashid);
+	cpSpaceIndexRemove(space, shape, cpTrue);
 	
 	cpSpaceActivateShapesTouchingShape(space, shape);
 }
@@ -508,8 +512,13 @@ cpSpaceResizeActiveHash(cpSpace *space, cpFloat dim, int count)
 void 
 cpSpaceRehashStatic(cpSpace *space)
 {
-	cpSpaceHashEach(space->staticShapes, (cpSpaceHashIterator)&updateBBCache, NULL);
-	cpSpaceHashRehash(space->staticShapes);
+	cpSpaceIndexEach(space, cpTrue, (cpSpaceHashIterator)&updateBBCache, NULL);
+	
+	if(space->staticTree){
+		cpBBTreeReindex(space->staticTree);
+	} else {
+		cpSpaceHashRehash(space->staticShapes);
+	}
 }
 
 void
@@ -518,8 +527,63 @@ cpSpaceRehashShape(cpSpace *space, cpShape *shape)
 	cpShapeCacheBB(shape);
 	
 	// attempt to rehash the shape in both hashes
-	cpSpaceHashRehashObject(space->activeShapes, shape, shape->hashid);
-	cpSpaceHashRehashObject(space->staticShapes, shape, shape->hashid);
+	if(space->activeTree){
+		cpBBTreeReindexObject(space->activeTree, shape, shape->hashid);
+		cpBBTreeReindexObject(space->staticTree, shape, shape->hashid);
+	} else {
+		cpSpaceHashRehashObject(space->activeShapes, shape, shape->hashid);
+		cpSpaceHashRehashObject(space->staticShapes, shape, shape->hashid);
+	}
+}
+
+static cpVect shapeVelocityFunc(cpShape *shape){return shape->body->v;}
+
+static void moveToActiveTree(cpShape *shape, cpSpace *space){cpBBTreeInsert(space->activeTree, shape, shape->hashid);}
+static void moveToStaticTree(cpShape *shape, cpSpace *space){cpBBTreeInsert(space->staticTree, shape, shape->hashid);}
+static void moveToActiveHash(cpShape *shape, cpSpace *space){cpSpaceHashInsert(space->activeShapes, shape, shape->hashid, shape->bb);}
+static void moveToStaticHash(cpShape *shape, cpSpace *space){cpSpaceHashInsert(space->staticShapes, shape, shape->hashid, shape->bb);}
+
+void
+cpSpaceSetIndexType(cpSpace *space, cpSpaceIndexType type)
+{
+	if(type == cpSpaceGetIndexType(space)) return;
+	cpAssertSpaceUnlocked(space);
+	
+	if(type == CP_SPACE_INDEX_BBTREE){
+		space->staticTree = cpBBTreeNew((cpSpaceHashBBFunc)shapeBBFunc);
+		space->activeTree = cpBBTreeNew((cpSpaceHashBBFunc)shapeBBFunc);
+		cpBBTreeSetVelocityFunc(space->activeTree, (cpBBTreeVelocityFunc)shapeVelocityFunc);
+		cpBBTreeSetStaticTree(space->activeTree, space->staticTree);
+		
+		// Fill the active tree first so the static leaves find their pairs.
+		cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)moveToActiveTree, space);
+		cpSpaceHashEach(space->staticShapes, (cpSpaceHashIterator)moveToStaticTree, space);
+		
+		// Keep empty hashes with the same dimensions in case the space switches back.
+		cpSpaceHash *staticShapes = space->staticShapes;
+		cpSpaceHash *activeShapes = space->activeShapes;
+		space->staticShapes = cpSpaceHashNew(staticShapes->celldim, staticShapes->numcells, (cpSpaceHashBBFunc)shapeBBFunc);
+		space->activeShapes = cpSpaceHashNew(activeShapes->celldim, activeShapes->numcells, (cpSpaceHashBBFunc)shapeBBFunc);
+		cpSpaceHashFree(staticShapes);
+		cpSpaceHashFree(activeShapes);
+	} else {
+		cpBBTree *staticTree = space->staticTree;
+		cpBBTree *activeTree = space->activeTree;
+		
+		cpBBTreeEach(activeTree, (cpSpaceHashIterator)moveToActiveHash, space);
+		cpBBTreeEach(staticTree, (cpSpaceHashIterator)moveToStaticHash, space);
+		
+		space->staticTree = NULL;
+		space->activeTree = NULL;
+		cpBBTreeFree(staticTree);
+		cpBBTreeFree(activeTree);
+	}
+}
+
+cpSpaceIndexType
+cpSpaceGetIndexType(cpSpace *space)
+{
+	return (space->activeTree ? CP_SPACE_INDEX_BBTREE : CP_SPACE_INDEX_HASH);
 }
 
 void
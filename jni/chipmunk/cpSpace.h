@@ -86,6 +86,11 @@ typedef struct CHIPMUNK_API cpSpace{
 	CP_PRIVATE(cpSpaceHash *staticShapes);
 	CP_PRIVATE(cpSpaceHash *activeShapes);
 	
+	// The static and active shape trees. Only created when the space uses
+	// CP_SPACE_INDEX_BBTREE, the shapes are kept in the hashes otherwise.
+	CP_PRIVATE(cpBBTree *staticTree);
+	CP_PRIVATE(cpBBTree *activeTree);
+	
 	// List of bodies in the system.
 	CP_PRIVATE(cpArray *bodies);
 	
@@ -211,7 +216,21 @@ CHIPMUNK_API void cpSpaceActivateShapesTouchingShape(cpSpace *space, cpShape *sh
 typedef void (*cpSpaceBodyIterator)(cpBody *body, void *data);
 CHIPMUNK_API void cpSpaceEachBody(cpSpace *space, cpSpaceBodyIterator func, void *data);
 
+// Spatial index types a space can keep its shapes in.
+// The spatial hash is the default. It is fast when the shapes have similar sizes and
+// the cell dimension is tuned for them. The bounding box tree needs no tuning and
+// handles mixed shape sizes and large empty areas well.
+typedef enum cpSpaceIndexType {
+	CP_SPACE_INDEX_HASH,
+	CP_SPACE_INDEX_BBTREE
+} cpSpaceIndexType;
+
+// Switch the spatial index of a space. Shapes already added are moved to the new index.
+CHIPMUNK_API void cpSpaceSetIndexType(cpSpace *space, cpSpaceIndexType type);
+CHIPMUNK_API cpSpaceIndexType cpSpaceGetIndexType(cpSpace *space);
+
 // Spatial hash management functions.
+// Resizing only affects the hashes, rehashing works with either index type.
 CHIPMUNK_API void cpSpaceResizeStaticHash(cpSpace *space, cpFloat dim, int count);
 CHIPMUNK_API void cpSpaceResizeActiveHash(cpSpace *space, cpFloat dim, int count);
 CHIPMUNK_API void cpSpaceRehashStatic(cpSpace *space);
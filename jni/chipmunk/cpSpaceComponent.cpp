@@ -64,8 +64,8 @@ cpSpaceActivateBody(cpSpace *space, cpBody *body)
 	} else {
 		cpArrayPush(space->bodies, body);
 		for(cpShape *shape=body->shapesList; shape; shape=shape->next){
-			cpSpaceHashRemove(space->staticShapes, shape, shape->hashid);
-			cpSpaceHashInsert(space->activeShapes, shape, shape->hashid, shape->bb);
+			cpSpaceIndexRemove(space, shape, cpTrue);
+			cpSpaceIndexInsert(space, shape, cpFalse);
 		}
 	}
 }
@@ -211,8 +211,8 @@ cpSpaceProcessComponents(cpSpace *space, cpFloat dt)
 				next = body->node.next;
 				
 				for(cpShape *shape = body->shapesList; shape; shape = shape->next){
-					cpSpaceHashRemove(space->activeShapes, shape, shape->hashid);
-					cpSpaceHashInsert(space->staticShapes, shape, shape->hashid, shape->bb);
+					cpSpaceIndexRemove(space, shape, cpFalse);
+					cpSpaceIndexInsert(space, shape, cpTrue);
 				}
 			} while((body = next) != root);
 			
@@ -245,8 +245,8 @@ cpBodySleepWithGroup(cpBody *body, cpBody *group){
 	
 	for(cpShape *shape = body->shapesList; shape; shape = shape->next){
 		cpShapeCacheBB(shape);
-		cpSpaceHashRemove(space->activeShapes, shape, shape->hashid);
-		cpSpaceHashInsert(space->staticShapes, shape, shape->hashid, shape->bb);
+		cpSpaceIndexRemove(space, shape, cpFalse);
+		cpSpaceIndexInsert(space, shape, cpTrue);
 	}
 	
 	if(group){
@@ -49,8 +49,8 @@ cpSpacePointQuery(cpSpace *space, cpVect point, cpLayers layers, cpGroup group,
 	pointQueryContext context = {layers, group, func, data};
 	
 	cpSpaceLock(space); {
-		cpSpaceHashPointQuery(space->activeShapes, point, (cpSpaceHashQueryFunc)pointQueryHelper, &context);
-		cpSpaceHashPointQuery(space->staticShapes, point, (cpSpaceHashQueryFunc)pointQueryHelper, &context);
+		cpSpaceIndexPointQuery(space, cpFalse, point, (cpSpaceHashQueryFunc)pointQueryHelper, &context);
+		cpSpaceIndexPointQuery(space, cpTrue, point, (cpSpaceHashQueryFunc)pointQueryHelper, &context);
 	} cpSpaceUnlock(space);
 }
 
@@ -104,8 +104,8 @@ cpSpaceSegmentQuery(cpSpace *space, cpVect start, cpVect end, cpLayers layers, c
 	};
 	
 	cpSpaceLock(space); {
-		cpSpaceHashSegmentQuery(space->staticShapes, &context, start, end, 1.0f, (cpSpaceHashSegmentQueryFunc)segQueryFunc, data);
-		cpSpaceHashSegmentQuery(space->activeShapes, &context, start, end, 1.0f, (cpSpaceHashSegmentQueryFunc)segQueryFunc, data);
+		cpSpaceIndexSegmentQuery(space, cpTrue, &context, start, end, 1.0f, (cpSpaceHashSegmentQueryFunc)segQueryFunc, data);
+		cpSpaceIndexSegmentQuery(space, cpFalse, &context, start, end, 1.0f, (cpSpaceHashSegmentQueryFunc)segQueryFunc, data);
 	} cpSpaceUnlock(space);
 }
 
@@ -148,8 +148,8 @@ cpSpaceSegmentQueryFirst(cpSpace *space, cpVect start, cpVect end, cpLayers laye
 		layers, group
 	};
 	
-	cpSpaceHashSegmentQuery(space->staticShapes, &context, start, end, 1.0f, (cpSpaceHashSegmentQueryFunc)segQueryFirst, out);
-	cpSpaceHashSegmentQuery(space->activeShapes, &context, start, end, out->t, (cpSpaceHashSegmentQueryFunc)segQueryFirst, out);
+	cpSpaceIndexSegmentQuery(space, cpTrue, &context, start, end, 1.0f, (cpSpaceHashSegmentQueryFunc)segQueryFirst, out);
+	cpSpaceIndexSegmentQuery(space, cpFalse, &context, start, end, out->t, (cpSpaceHashSegmentQueryFunc)segQueryFirst, out);
 	
 	return out->shape;
 }
@@ -180,8 +180,8 @@ cpSpaceBBQuery(cpSpace *space, cpBB bb, cpLayers layers, cpGroup group, cpSpaceB
 	bbQueryContext context = {layers, group, func, data};
 	
 	cpSpaceLock(space); {
-		cpSpaceHashQuery(space->activeShapes, &bb, bb, (cpSpaceHashQueryFunc)bbQueryHelper, &context);
-		cpSpaceHashQuery(space->staticShapes, &bb, bb, (cpSpaceHashQueryFunc)bbQueryHelper, &context);
+		cpSpaceIndexQuery(space, cpFalse, &bb, bb, (cpSpaceHashQueryFunc)bbQueryHelper, &context);
+		cpSpaceIndexQuery(space, cpTrue, &bb, bb, (cpSpaceHashQueryFunc)bbQueryHelper, &context);
 	} cpSpaceUnlock(space);
 }
 
@@ -238,8 +238,8 @@ cpSpaceShapeQuery(cpSpace *space, cpShape *shape, cpSpaceShapeQueryFunc func, vo
 	shapeQueryContext context = {func, data, cpFalse};
 	
 	cpSpaceLock(space); {
-		cpSpaceHashQuery(space->activeShapes, shape, bb, (cpSpaceHashQueryFunc)shapeQueryHelper, &context);
-		cpSpaceHashQuery(space->staticShapes, shape, bb, (cpSpaceHashQueryFunc)shapeQueryHelper, &context);
+		cpSpaceIndexQuery(space, cpFalse, shape, bb, (cpSpaceHashQueryFunc)shapeQueryHelper, &context);
+		cpSpaceIndexQuery(space, cpTrue, shape, bb, (cpSpaceHashQueryFunc)shapeQueryHelper, &context);
 	} cpSpaceUnlock(space);
 	
 	return context.anyCollision;
@@ -303,15 +303,20 @@ cpSpaceStep(cpSpace *space, cpFloat dt)
 	}
 	
 	// Pre-cache BBoxes and shape data.
-	cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)updateBBCache, NULL);
+	cpSpaceIndexEach(space, cpFalse, (cpSpaceHashIterator)updateBBCache, NULL);
 	
 	cpSpaceLock(space);
 	
 	// Collide!
 	cpSpacePushFreshContactBuffer(space);
-	if(space->staticShapes->handleSet->entries)
-		cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)active2staticIter, space);
-	cpSpaceHashQueryRehash(space->activeShapes, (cpSpaceHashQueryFunc)queryFunc, space);
+	if(space->activeTree){
+		// The tree reports the cached active/active and active/static pairs in one pass.
+		cpBBTreeReindexQuery(space->activeTree, (cpSpaceHashQueryFunc)queryFunc, space);
+	} else {
+		if(space->staticShapes->handleSet->entries)
+			cpSpaceHashEach(space->activeShapes, (cpSpaceHashIterator)active2staticIter, space);
+		cpSpaceHashQueryRehash(space->activeShapes, (cpSpaceHashQueryFunc)queryFunc, space);
+	}
 	
 	cpSpaceUnlock(space);
 	
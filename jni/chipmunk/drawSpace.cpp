@@ -31,6 +31,7 @@
 #include "wyTexture2D.h"
 #include "wyTypes.h"
 #include "wyGlobal.h"
+#include "wyRenderQueue.h"
 
 /*
  IMPORTANT - READ ME!
@@ -84,6 +85,8 @@ static const GLfloat circleVAR[] = { 0.0000f, 0.0000f,
 static const int circleVAR_count = sizeof(circleVAR) / sizeof(GLfloat) / 2;
 
 static void debugDrawCircleShape(cpBody *body, cpCircleShape *circle) {
+	wyRenderQueue::getInstance()->flush();
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 
 	glVertexPointer(2, GL_FLOAT, 0, circleVAR);
@@ -98,10 +101,12 @@ static void debugDrawCircleShape(cpBody *body, cpCircleShape *circle) {
 		if (!circle->shape.sensor) {
 			glColor_from_pointer(circle);
 			glDrawArrays(GL_TRIANGLE_FAN, 0, circleVAR_count - 1);
+			wyRenderQueue::getInstance()->countDrawCall();
 		}
 
 		glColor4f(LINE_COLOR);
 		glDrawArrays(GL_LINE_STRIP, 0, circleVAR_count);
+		wyRenderQueue::getInstance()->countDrawCall();
 	}
 	glPopMatrix();
 
@@ -109,6 +114,8 @@ static void debugDrawCircleShape(cpBody *body, cpCircleShape *circle) {
 }
 
 static void drawCircleShape(cpBody *body, cpCircleShape *circle) {
+	wyRenderQueue::getInstance()->flush();
+
 	// if no texture, return
 	cpShape* shape = (cpShape*)circle;
 	if(shape->tex == NULL)
@@ -159,6 +166,7 @@ static void drawCircleShape(cpBody *body, cpCircleShape *circle) {
 
 	// draw circle
 	glDrawArrays(GL_TRIANGLE_FAN, 0, circleVAR_count);
+	wyRenderQueue::getInstance()->countDrawCall();
 
 	// restore matrix
 	glPopMatrix();
@@ -183,6 +191,8 @@ static const GLfloat pillVAR[] = { 0.0000f, 1.0000f, 0.2588f, 0.9659f, 0.5000f,
 static const int pillVAR_count = sizeof(pillVAR) / sizeof(GLfloat) / 2;
 
 static void debugDrawSegmentShape(cpBody *body, cpSegmentShape *seg) {
+	wyRenderQueue::getInstance()->flush();
+
 	cpVect a = cpvadd(body->p, cpvrotate(seg->a, body->rot));
 	cpVect b = cpvadd(body->p, cpvrotate(seg->b, body->rot));
 
@@ -214,11 +224,13 @@ static void debugDrawSegmentShape(cpBody *body, cpSegmentShape *seg) {
 			if (!seg->shape.sensor) {
 				glColor_from_pointer(seg);
 				glDrawArrays(GL_TRIANGLE_FAN, 0, pillVAR_count);
+				wyRenderQueue::getInstance()->countDrawCall();
 			}
 
 			// GL_LINE_LOOP is very slow in Desire HD, use GL_LINE_STRIP instead
 			glColor4f(LINE_COLOR);
 			glDrawArrays(GL_LINE_STRIP, 0, pillVAR_count);
+			wyRenderQueue::getInstance()->countDrawCall();
 		}
 		glPopMatrix();
 
@@ -230,6 +242,8 @@ static void debugDrawSegmentShape(cpBody *body, cpSegmentShape *seg) {
 }
 
 static void drawSegmentShape(cpBody *body, cpSegmentShape *seg) {
+	wyRenderQueue::getInstance()->flush();
+
 	// if no thickness, return
 	if(!seg->r)
 		return;
@@ -308,6 +322,7 @@ static void drawSegmentShape(cpBody *body, cpSegmentShape *seg) {
 
 	// draw segment
 	glDrawArrays(GL_TRIANGLE_FAN, 0, pillVAR_count);
+	wyRenderQueue::getInstance()->countDrawCall();
 
 	// restore matrix
 	glPopMatrix();
@@ -321,6 +336,8 @@ static void drawSegmentShape(cpBody *body, cpSegmentShape *seg) {
 }
 
 static void debugDrawPolyShape(cpBody *body, cpPolyShape *poly) {
+	wyRenderQueue::getInstance()->flush();
+
 	int count = poly->numVerts;
 	GLfloat* VAR = (GLfloat*)malloc((count + 1) * 2 * sizeof(GLfloat));
 
@@ -342,11 +359,13 @@ static void debugDrawPolyShape(cpBody *body, cpPolyShape *poly) {
 	if (!poly->shape.sensor) {
 		glColor_from_pointer(poly);
 		glDrawArrays(GL_TRIANGLE_FAN, 0, count);
+		wyRenderQueue::getInstance()->countDrawCall();
 	}
 
 	// draw GL_LINE_STRIP
 	glColor4f(LINE_COLOR);
 	glDrawArrays(GL_LINE_STRIP, 0, count + 1);
+	wyRenderQueue::getInstance()->countDrawCall();
 
 	glDisableClientState(GL_VERTEX_ARRAY);
 
@@ -354,6 +373,8 @@ static void debugDrawPolyShape(cpBody *body, cpPolyShape *poly) {
 }
 
 static void drawPolyShape(cpBody *body, cpPolyShape *poly) {
+	wyRenderQueue::getInstance()->flush();
+
 	int count = poly->numVerts;
 	GLfloat* VAR = (GLfloat*)malloc(count * 2 * sizeof(GLfloat));
 	GLfloat* TEX = (GLfloat*)malloc(count * 2 * sizeof(GLfloat));
@@ -402,6 +423,7 @@ static void drawPolyShape(cpBody *body, cpPolyShape *poly) {
 
 	// drawing
 	glDrawArrays(GL_TRIANGLE_FAN, 0, count);
+	wyRenderQueue::getInstance()->countDrawCall();
 
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -450,6 +472,8 @@ static const GLfloat springVAR[] = { 0.00f, 0.0f, 0.20f, 0.0f, 0.25f, 3.0f,
 static const int springVAR_count = sizeof(springVAR) / sizeof(GLfloat) / 2;
 
 static void drawSpring(cpDampedSpring *spring, cpBody *body_a, cpBody *body_b) {
+	wyRenderQueue::getInstance()->flush();
+
 	cpVect a = cpvadd(body_a->p, cpvrotate(spring->anchr1, body_a->rot));
 	cpVect b = cpvadd(body_b->p, cpvrotate(spring->anchr2, body_b->rot));
 
@@ -473,6 +497,7 @@ static void drawSpring(cpDampedSpring *spring, cpBody *body_a, cpBody *body_b) {
 
 		glMultMatrixf(matrix);
 		glDrawArrays(GL_LINE_STRIP, 0, springVAR_count);
+		wyRenderQueue::getInstance()->countDrawCall();
 	}
 	glPopMatrix();
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -589,19 +614,29 @@ void drawSpace(cpSpace *space, drawSpaceOptions *options) {
 	glHint(GL_POINT_SMOOTH_HINT, GL_DONT_CARE);
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 
-	if (options->drawHash)
+	if (options->drawHash && !space->activeTree)
 		drawSpatialHash(space->activeShapes);
 
 	glLineWidth(1.0f);
 	if (options->drawBBs) {
-		cpSpaceHashEach(space->activeShapes, &drawBB, NULL);
-		cpSpaceHashEach(space->staticShapes, &drawBB, NULL);
+		if (space->activeTree) {
+			cpBBTreeEach(space->activeTree, &drawBB, NULL);
+			cpBBTreeEach(space->staticTree, &drawBB, NULL);
+		} else {
+			cpSpaceHashEach(space->activeShapes, &drawBB, NULL);
+			cpSpaceHashEach(space->staticShapes, &drawBB, NULL);
+		}
 	}
 
 	glLineWidth(options->lineThickness);
 	if (options->drawShapes) {
-		cpSpaceHashEach(space->activeShapes, &drawObject, options);
-		cpSpaceHashEach(space->staticShapes, &drawObject, options);
+		if (space->activeTree) {
+			cpBBTreeEach(space->activeTree, &drawObject, options);
+			cpBBTreeEach(space->staticTree, &drawObject, options);
+		} else {
+			cpSpaceHashEach(space->activeShapes, &drawObject, options);
+			cpSpaceHashEach(space->staticShapes, &drawObject, options);
+		}
 	}
 
 	if(options->debugDraw) {
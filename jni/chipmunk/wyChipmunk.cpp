@@ -84,6 +84,11 @@ static bool sFirstChipmunk = true;
 wyChipmunk::~wyChipmunk() {
 	cpSpaceFreeChildren(m_space);
 	cpSpaceFree(m_space);
+
+	if(m_savedStates != NULL) {
+		wyFree(m_savedStates);
+		m_savedStates = NULL;
+	}
 }
 
 void wyChipmunk::draw() {
@@ -94,7 +99,141 @@ void wyChipmunk::draw() {
 		return;
 	}
 
+	// draw bodies between last two steps, and put them back after drawing
+	bool interpolated = applyInterpolatedStates();
 	drawSpace(m_space, &m_options);
+	if(interpolated)
+		restoreStates();
+}
+
+bool wyChipmunk::hasPreviousState(cpBody* body) {
+	// state is saved before step and stamp is increased after step, so only a state saved
+	// in last step is valid. Bodies which are sleeping or not in space are drawn as is.
+	return m_space->stamp > 0 && body->prev_stamp + 1 == m_space->stamp;
+}
+
+bool wyChipmunk::applyInterpolatedStates() {
+	if(m_fixedTimeStep <= 0 || m_alpha >= 1.f)
+		return false;
+
+	// only active bodies move, others don't need interpolation
+	cpArray* bodies = m_space->bodies;
+	if(bodies->num == 0)
+		return false;
+	if(bodies->num > m_savedStateCapacity) {
+		m_savedStateCapacity = bodies->num * 2;
+		m_savedStates = (SavedBodyState*)wyRealloc(m_savedStates, m_savedStateCapacity * sizeof(SavedBodyState));
+	}
+
+	float a = m_alpha;
+	for(int i = 0; i < bodies->num; i++) {
+		cpBody* body = (cpBody*)bodies->arr[i];
+		SavedBodyState& s = m_savedStates[i];
+		s.p = body->p;
+		s.a = body->a;
+		s.rot = body->rot;
+
+		if(hasPreviousState(body)) {
+			body->p = cpvlerp(body->p_prev, body->p, a);
+			cpBodySetAngle(body, body->a_prev + (body->a - body->a_prev) * a);
+		}
+	}
+
+	return true;
+}
+
+void wyChipmunk::restoreStates() {
+	cpArray* bodies = m_space->bodies;
+	for(int i = 0; i < bodies->num; i++) {
+		cpBody* body = (cpBody*)bodies->arr[i];
+		SavedBodyState& s = m_savedStates[i];
+		body->p = s.p;
+		body->a = s.a;
+		body->rot = s.rot;
+	}
+}
+
+void wyChipmunk::setFixedTimeStep(float hz, int maxSubSteps) {
+	m_fixedTimeStep = hz > 0 ? 1.f / hz : 0;
+	m_maxSubSteps = MAX(1, maxSubSteps);
+	m_accumulator = 0;
+	m_alpha = 1;
+}
+
+void wyChipmunk::step(float delta) {
+	// variable step
+	if(m_fixedTimeStep <= 0) {
+		cpSpaceStep(m_space, delta);
+		m_alpha = 1;
+		return;
+	}
+
+	m_accumulator += delta;
+	int steps = 0;
+	while(m_accumulator >= m_fixedTimeStep && steps < m_maxSubSteps) {
+		// remember state before step, it is the start point of interpolation
+		cpArray* bodies = m_space->bodies;
+		for(int i = 0; i < bodies->num; i++) {
+			cpBody* body = (cpBody*)bodies->arr[i];
+			body->p_prev = body->p;
+			body->a_prev = body->a;
+			body->prev_stamp = m_space->stamp;
+		}
+
+		cpSpaceStep(m_space, m_fixedTimeStep);
+		m_accumulator -= m_fixedTimeStep;
+		steps++;
+	}
+
+	// can't catch up, drop the time left so that later frames don't run max steps too
+	if(m_accumulator >= m_fixedTimeStep)
+		m_accumulator = fmodf(m_accumulator, m_fixedTimeStep);
+
+	m_alpha = m_accumulator / m_fixedTimeStep;
+}
+
+void wyChipmunk::setAutoStep(bool flag) {
+	if(flag) {
+		if(m_stepTimer == NULL) {
+			wyTargetSelector* ts = wyTargetSelector::make(this, SEL(wyChipmunk::onStepTimer));
+			m_stepTimer = wyTimer::make(ts);
+			scheduleLocked(m_stepTimer);
+		}
+	} else if(m_stepTimer != NULL) {
+		// node holds the only reference of timer
+		unscheduleLocked(m_stepTimer);
+		m_stepTimer = NULL;
+	}
+}
+
+void wyChipmunk::onStepTimer(wyTargetSelector* ts) {
+	step(ts->getDelta());
+}
+
+void wyChipmunk::teleportBody(cpBody* body, wyPoint pos, float angle) {
+	body->p = cpv(pos.x, pos.y);
+	cpBodySetAngle(body, angle);
+
+	// previous state is the place before teleport, drop it so that body is not
+	// drawn sliding from there
+	body->prev_stamp = (cpTimestamp)-1;
+
+	// sleeping body won't be moved back into index otherwise
+	cpBodyActivate(body);
+}
+
+wyPoint wyChipmunk::getInterpolatedPosition(cpBody* body) {
+	cpVect p = body->p;
+	if(m_fixedTimeStep > 0 && hasPreviousState(body))
+		p = cpvlerp(body->p_prev, body->p, m_alpha);
+	return wyp(p.x, p.y);
+}
+
+float wyChipmunk::getInterpolatedAngle(cpBody* body) {
+	if(m_fixedTimeStep > 0 && hasPreviousState(body))
+		return body->a_prev + (body->a - body->a_prev) * m_alpha;
+	else
+		return body->a;
 }
 
 wyChipmunk* wyChipmunk::make() {
@@ -103,7 +242,14 @@ wyChipmunk* wyChipmunk::make() {
 }
 
 wyChipmunk::wyChipmunk() :
-	m_space(cpSpaceNew()) {
+	m_space(cpSpaceNew()),
+	m_fixedTimeStep(0),
+	m_maxSubSteps(5),
+	m_accumulator(0),
+	m_alpha(1),
+	m_stepTimer(NULL),
+	m_savedStates(NULL),
+	m_savedStateCapacity(0) {
 	// set option
 	// non-zero means use debug drawing logic
 	m_options.debugDraw = 0;
@@ -1,6 +1,8 @@
 #include "PerformanceDemos.h"
 #include "common.h"
 #include "WiEngine.h"
+#include "WiEngine-Chipmunk.h"
+#include "WiEngine-Box2D.h"
 
 namespace Performance {
 
@@ -215,10 +217,12 @@ namespace Performance {
 			// add sprite button
 			createButton("Add 1 Sprites", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
 					  wyTargetSelector::make(this, SEL(wyRunSkeletalAnimationTestLayer::onAddSprite)));
+			createButton("Add 50 Sprites", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(90),
+					  wyTargetSelector::make(this, SEL(wyRunSkeletalAnimationTestLayer::onAddManySprites)));
 
 			// count label
 			m_countLabel = wyLabel::make("0 Sprites", SP(16));
-			m_countLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(80));
+			m_countLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(130));
 			m_countLabel->setColor(wyc3bRed);
 			addChildLocked(m_countLabel);
 
@@ -238,13 +242,24 @@ namespace Performance {
 		}
 
 		void onAddSprite(wyTargetSelector* ts) {
-			for(int i = 0; i < 1; i++) {
+			addSprites(1);
+		}
+
+		void onAddManySprites(wyTargetSelector* ts) {
+			addSprites(50);
+		}
+
+		void addSprites(int count) {
+			for(int i = 0; i < count; i++) {
 				// create skeletal sprite and play animation
 				wySkeletalSprite* sprite = wySkeletalSprite::make(m_skeleton);
 				sprite->setPosition(wyMath::randMax(wyDevice::winWidth), wyMath::randMax(wyDevice::winHeight));
 				addChildLocked(sprite, -1);
 				sprite->playAnimation("walk");
 				sprite->setLoopCount(-1);
+
+				// random start time so sprites don't play in same phase
+				sprite->tick(wyMath::randMax(100) / 100.0f);
 				m_sprites.push_back(sprite);
 			}
 
@@ -256,6 +271,1484 @@ namespace Performance {
 	};
 
 	/////////////////////////////////////////////////////////////////////////////////
+
+	/**
+	 * runnable posted by producer threads, it only counts itself in gl thread
+	 */
+	class StressRunnable : public wyRunnable {
+	private:
+		int* m_counter;
+
+	protected:
+		StressRunnable(int* counter) :
+				m_counter(counter) {
+		}
+
+	public:
+		virtual ~StressRunnable() {
+		}
+
+		static StressRunnable* make(int* counter) {
+			StressRunnable* r = new StressRunnable(counter);
+			return (StressRunnable*)r->autoRelease();
+		}
+
+		virtual void run() {
+			(*m_counter)++;
+		}
+	};
+
+	#define STRESS_PRODUCERS 8
+	#define STRESS_RUNNABLES 20000
+	#define STRESS_TIMERS 500
+
+	class wyRunParticleTestLayer : public wyLayer {
+	private:
+		wyLabel* m_countLabel;
+		int m_count;
+
+	public:
+		wyRunParticleTestLayer() {
+			// add particle button
+			createButton("Add 1000 Particles", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyRunParticleTestLayer::onAddParticles)));
+
+			// count label
+			m_countLabel = wyLabel::make("0 Particles", SP(16));
+			m_countLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(80));
+			m_countLabel->setColor(wyc3bRed);
+			addChildLocked(m_countLabel);
+			m_count = 0;
+		}
+
+		virtual ~wyRunParticleTestLayer() {
+		}
+
+		void onAddParticles(wyTargetSelector* ts) {
+			// a fountain which keeps 1000 particles alive
+			wyQuadParticleSystem* emitter = new wyQuadParticleSystem(1000);
+			emitter->setDuration(PARTICLE_DURATION_INFINITY);
+			emitter->setParticleGravity(0, -DP(100));
+			emitter->setDirectionAngleVariance(90, 30);
+			emitter->setSpeedVariance(DP(120), DP(40));
+			emitter->setRadialAccelerationVariance(0, DP(10));
+			emitter->setTangentialAccelerationVariance(0, DP(10));
+			emitter->setLifeVariance(3, 0.5f);
+			emitter->setStartSizeVariance(DP(12), DP(4));
+			emitter->setEndSizeVariance(PARTICLE_START_SIZE_EQUAL_TO_END_SIZE, 0);
+			emitter->setStartSpinVariance(0, 90);
+			emitter->setEndSpinVariance(0, 90);
+			emitter->setEmissionRate(emitter->getMaxParticles() / 2.5f);
+			emitter->setStartColorVariance(0.5f, 0.5f, 0.5f, 1.0f, 0.5f, 0.5f, 0.5f, 0.0f);
+			emitter->setEndColorVariance(0.1f, 0.1f, 0.1f, 0.2f, 0.1f, 0.1f, 0.1f, 0.2f);
+			emitter->setTexture(wyTexture2D::make(RES("R.drawable.stars")));
+			emitter->setBlendAdditive(true);
+			emitter->setPosition(wyMath::randMax(wyDevice::winWidth), wyMath::randMax(wyDevice::winHeight / 2));
+			addChildLocked(emitter, -1);
+			emitter->release();
+
+			// update count label
+			m_count += 1000;
+			char buf[32];
+			sprintf(buf, "%d Particles", m_count);
+			m_countLabel->setText(buf);
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	class wyCommandQueueStressTestLayer : public wyLayer {
+	private:
+		wyLabel* m_stateLabel;
+		wyLabel* m_countLabel;
+		wyLabel* m_frameLabel;
+
+		/// runnables executed in gl thread
+		int m_executed;
+
+		/// timers fired in gl thread
+		int m_fired;
+
+		/// true if last timer of a producer is fired
+		bool m_lastFired[STRESS_PRODUCERS];
+
+		/// producers which are still running, modified by atomic operations
+		volatile int m_runningProducers;
+
+		/// set by gl thread when producers can drain their pools and exit
+		volatile bool m_canExit;
+
+		/// frames to wait before setting exit flag
+		int m_exitDelay;
+
+		bool m_busying;
+		float m_maxFrameTime;
+		int m_frames;
+
+	public:
+		wyCommandQueueStressTestLayer() :
+				m_executed(0),
+				m_fired(0),
+				m_runningProducers(0),
+				m_canExit(false),
+				m_exitDelay(0),
+				m_busying(false),
+				m_maxFrameTime(0),
+				m_frames(0) {
+			createButton("Start 8 Producers", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyCommandQueueStressTestLayer::onStart)));
+
+			m_stateLabel = wyLabel::make("Idle", SP(16));
+			m_stateLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(80));
+			m_stateLabel->setColor(wyc3bRed);
+			addChildLocked(m_stateLabel);
+
+			m_countLabel = wyLabel::make(" ", SP(16));
+			m_countLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(110));
+			addChildLocked(m_countLabel);
+
+			m_frameLabel = wyLabel::make(" ", SP(16));
+			m_frameLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(140));
+			addChildLocked(m_frameLabel);
+
+			// sprites keep moving so that a stall in gl thread can be seen
+			wyTexture2D* tex = wyTexture2D::make(RES("R.drawable.blocks"));
+			float size = DP(32.0f);
+			for(int i = 0; i < 20; i++) {
+				wySprite* s = wySprite::make(tex, wyr(wyMath::randMax(1) * size, wyMath::randMax(1) * size, size, size));
+				s->setPosition(wyMath::randMax(wyDevice::winWidth), wyMath::randMax(wyDevice::winHeight - DP(160)));
+				s->runAction(wyRepeatForever::make(wyRotateBy::make(1, 360)));
+				addChildLocked(s, -1);
+			}
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wyCommandQueueStressTestLayer::onUpdate)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wyCommandQueueStressTestLayer() {
+		}
+
+		void onStart(wyTargetSelector* ts) {
+			if(m_busying)
+				return;
+			m_busying = true;
+
+			m_executed = 0;
+			m_fired = 0;
+			m_canExit = false;
+			m_exitDelay = 2;
+			m_maxFrameTime = 0;
+			m_frames = 0;
+			memset(m_lastFired, 0, sizeof(m_lastFired));
+			m_runningProducers = STRESS_PRODUCERS;
+			m_stateLabel->setText("Running");
+
+			for(int i = 0; i < STRESS_PRODUCERS; i++) {
+				wyThread::runThread(wyTargetSelector::make(this, SEL_i(wyCommandQueueStressTestLayer::producerEntry), i));
+			}
+		}
+
+		void producerEntry(wyTargetSelector* ts, int index) {
+			wyEventDispatcher* dispatcher = wyEventDispatcher::getInstance();
+			wyScheduler* scheduler = wyScheduler::getInstance();
+			int timerInterval = STRESS_RUNNABLES / STRESS_TIMERS;
+
+			for(int i = 0; i < STRESS_RUNNABLES; i++) {
+				dispatcher->queueRunnableLocked(StressRunnable::make(&m_executed));
+
+				// schedule a one shot timer and cancel every other one at once
+				if(i % timerInterval == 0) {
+					int n = i / timerInterval;
+					bool last = n == STRESS_TIMERS - 1;
+					wyTimer* t = wyTimer::make(wyTargetSelector::make(this, SEL_i(wyCommandQueueStressTestLayer::onStressTimer), last ? (index + STRESS_PRODUCERS) : index));
+					t->setOneShot(true);
+					scheduler->scheduleLocked(t);
+					if(!last && (n % 2) == 1)
+						scheduler->unscheduleLocked(t);
+				}
+			}
+
+			// objects made here may still be referenced by gl thread, so wait
+			// until gl thread says everything is done before draining pool
+			while(!m_canExit)
+				wyThread::sleep(10);
+
+			wyAtomicAdd(&m_runningProducers, -1);
+		}
+
+		void onStressTimer(wyTargetSelector* ts, int data) {
+			m_fired++;
+			if(data >= STRESS_PRODUCERS)
+				m_lastFired[data - STRESS_PRODUCERS] = true;
+		}
+
+		void onUpdate(wyTargetSelector* ts) {
+			if(!m_busying)
+				return;
+
+			// frame time while producers are hammering queues
+			float frameTime = ts->getDelta() * 1000;
+			if(m_frames > 0 && frameTime > m_maxFrameTime)
+				m_maxFrameTime = frameTime;
+			m_frames++;
+
+			char buf[128];
+			sprintf(buf, "Runnables: %d / %d, Timers: %d", m_executed, STRESS_PRODUCERS * STRESS_RUNNABLES, m_fired);
+			m_countLabel->setText(buf);
+			sprintf(buf, "Frames: %d, Max frame time: %.1f ms", m_frames, m_maxFrameTime);
+			m_frameLabel->setText(buf);
+
+			// check whether all commands are processed
+			if(!m_canExit) {
+				bool allFired = true;
+				for(int i = 0; i < STRESS_PRODUCERS; i++) {
+					if(!m_lastFired[i]) {
+						allFired = false;
+						break;
+					}
+				}
+
+				// done timers are released after this frame, so wait a bit more
+				if(allFired && m_executed == STRESS_PRODUCERS * STRESS_RUNNABLES) {
+					if(--m_exitDelay <= 0)
+						m_canExit = true;
+				}
+			} else if(m_runningProducers == 0) {
+				m_stateLabel->setText("Done");
+				m_busying = false;
+			}
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// alloc this many blocks then free them, repeat rounds times
+	#define BENCH_BATCH 64
+	#define BENCH_ROUNDS 2000
+	#define BENCH_ACTIONS 20000
+
+	class wySlabAllocatorTestLayer : public wyLayer {
+	private:
+		wyLabel* m_resultLabels[5];
+
+		/// result text, written by benchmark thread
+		char m_results[5][128];
+
+		/// set by benchmark thread when results are ready
+		volatile bool m_done;
+
+		bool m_busying;
+
+	public:
+		wySlabAllocatorTestLayer() :
+				m_done(false),
+				m_busying(false) {
+			createButton("Run Benchmark", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wySlabAllocatorTestLayer::onRun)));
+
+			for(int i = 0; i < 5; i++) {
+				m_resultLabels[i] = wyLabel::make(" ", SP(16));
+				m_resultLabels[i]->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(80 + i * 30));
+				addChildLocked(m_resultLabels[i]);
+			}
+			m_resultLabels[0]->setColor(wyc3bRed);
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wySlabAllocatorTestLayer::onUpdate)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wySlabAllocatorTestLayer() {
+		}
+
+		void onRun(wyTargetSelector* ts) {
+#ifdef WY_CFLAG_SLAB_ALLOCATOR
+			if(m_busying)
+				return;
+			m_busying = true;
+			m_done = false;
+			m_resultLabels[0]->setText("Running");
+			for(int i = 1; i < 5; i++)
+				m_resultLabels[i]->setText(" ");
+
+			// raw block part runs in a thread to use a fresh thread cache
+			wyThread::runThread(wyTargetSelector::make(this, SEL(wySlabAllocatorTestLayer::benchmarkEntry)));
+#else
+			m_resultLabels[0]->setText("WY_CFLAG_SLAB_ALLOCATOR is disabled");
+#endif
+		}
+
+		void benchmarkEntry(wyTargetSelector* ts) {
+#ifdef WY_CFLAG_SLAB_ALLOCATOR
+			static const int sizes[] = { 32, 96, 256 };
+			void* blocks[BENCH_BATCH];
+
+			sprintf(m_results[0], "Alloc/free pairs per ms, malloc vs slab");
+
+			// raw blocks, same pattern for malloc and slab
+			for(int s = 0; s < 3; s++) {
+				int size = sizes[s];
+				int64_t start = wyUtils::currentTimeMillis();
+				for(int r = 0; r < BENCH_ROUNDS; r++) {
+					for(int i = 0; i < BENCH_BATCH; i++)
+						blocks[i] = malloc(size);
+					for(int i = BENCH_BATCH - 1; i >= 0; i--)
+						free(blocks[i]);
+				}
+				int64_t mallocTime = wyUtils::currentTimeMillis() - start;
+
+				start = wyUtils::currentTimeMillis();
+				for(int r = 0; r < BENCH_ROUNDS; r++) {
+					for(int i = 0; i < BENCH_BATCH; i++)
+						blocks[i] = wySlabAlloc(size);
+					for(int i = BENCH_BATCH - 1; i >= 0; i--)
+						wySlabFree(blocks[i], size);
+				}
+				int64_t slabTime = wyUtils::currentTimeMillis() - start;
+
+				int pairs = BENCH_ROUNDS * BENCH_BATCH;
+				sprintf(m_results[s + 1], "%d bytes: %d vs %d", size,
+						(int)(pairs / MAX(mallocTime, 1)), (int)(pairs / MAX(slabTime, 1)));
+			}
+
+			wyMemoryBarrier();
+			m_done = true;
+#endif
+		}
+
+		void onUpdate(wyTargetSelector* ts) {
+#ifdef WY_CFLAG_SLAB_ALLOCATOR
+			if(!m_busying || !m_done)
+				return;
+
+			// typical action trees, objects must be released in gl thread so run it here.
+			// a nested pool is drained often so objects are really destroyed in loop
+			int64_t start = wyUtils::currentTimeMillis();
+			for(int i = 0; i < BENCH_ACTIONS / BENCH_BATCH; i++) {
+				wyAutoReleasePool* pool = wyAutoReleasePool::make();
+				for(int j = 0; j < BENCH_BATCH; j++)
+					wySequence::make(wyMoveBy::make(1, DP(10), 0), wyScaleTo::make(1, 1, 2), NULL);
+				pool->drain();
+			}
+			int64_t actionTime = wyUtils::currentTimeMillis() - start;
+
+			// total live blocks in slab
+			int live = 0;
+			wySlabStats stats;
+			for(int i = 0; i < wySlabGetClassCount(); i++) {
+				wySlabGetStats(i, &stats);
+				live += stats.liveBlocks;
+			}
+			sprintf(m_results[4], "%d action trees: %d ms, live slab blocks: %d", BENCH_ACTIONS, (int)actionTime, live);
+
+			for(int i = 0; i < 5; i++)
+				m_resultLabels[i]->setText(m_results[i]);
+			m_busying = false;
+#endif
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// timers added by one click
+	#define TIMER_BATCH 2000
+
+	// target of one timer, every timer needs its own target otherwise they are equal
+	class wyTimerWheelTarget : public wyObject {
+	private:
+		int* m_counter;
+
+	public:
+		wyTimerWheelTarget(int* counter) : m_counter(counter) {
+		}
+
+		virtual ~wyTimerWheelTarget() {
+		}
+
+		void onFire(wyTargetSelector* ts) {
+			(*m_counter)++;
+		}
+	};
+
+	class wyTimerWheelTestLayer : public wyLayer {
+	private:
+		wyLabel* m_countLabel;
+		wyLabel* m_fireLabel;
+
+		/// all added timers
+		wyArray* m_timers;
+
+		/// fired times in current second
+		int m_fired;
+
+		/// time since last label update
+		float m_elapsed;
+
+	public:
+		wyTimerWheelTestLayer() :
+				m_timers(wyArrayNew(TIMER_BATCH)),
+				m_fired(0),
+				m_elapsed(0) {
+			createButton("Add 2000 Timers", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyTimerWheelTestLayer::onAdd)));
+			createButton("Pause/Resume All", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(100),
+					  wyTargetSelector::make(this, SEL(wyTimerWheelTestLayer::onPause)));
+
+			m_countLabel = wyLabel::make("Timers: 0", SP(16));
+			m_countLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight / 2);
+			addChildLocked(m_countLabel);
+
+			m_fireLabel = wyLabel::make("Fired per second: 0", SP(16));
+			m_fireLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight / 2 - DP(30));
+			addChildLocked(m_fireLabel);
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wyTimerWheelTestLayer::onUpdate)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wyTimerWheelTestLayer() {
+			// unschedule all timers, scheduler releases them
+			for(int i = 0; i < m_timers->num; i++) {
+				wyTimer* t = (wyTimer*)wyArrayGet(m_timers, i);
+				wyScheduler::getInstance()->unscheduleLocked(t);
+				wyObjectRelease(t);
+			}
+			wyArrayDestroy(m_timers);
+		}
+
+		void onAdd(wyTargetSelector* ts) {
+			// most timers have long intervals, they sit in higher levels of wheel and cost nothing
+			// until they are due. A few are frame timers.
+			for(int i = 0; i < TIMER_BATCH; i++) {
+				wyTimerWheelTarget* target = WYNEW wyTimerWheelTarget(&m_fired);
+				wyTargetSelector* sel = wyTargetSelector::make(target, SEL(wyTimerWheelTarget::onFire));
+				wyTimer* t;
+				if(i % 100 == 0)
+					t = wyTimer::make(sel, (i / 100) % 10 + 1);
+				else
+					t = wyTimer::make(sel, 1.f + rand() % 6000 / 100.f);
+				wyObjectRelease(target);
+
+				wyObjectRetain(t);
+				wyArrayPush(m_timers, t);
+				wyScheduler::getInstance()->scheduleLocked(t);
+			}
+
+			char buf[64];
+			sprintf(buf, "Timers: %d", m_timers->num);
+			m_countLabel->setText(buf);
+		}
+
+		void onPause(wyTargetSelector* ts) {
+			for(int i = 0; i < m_timers->num; i++) {
+				wyTimer* t = (wyTimer*)wyArrayGet(m_timers, i);
+				t->setPaused(!t->isPaused());
+			}
+		}
+
+		void onUpdate(wyTargetSelector* ts) {
+			m_elapsed += ts->getDelta();
+			if(m_elapsed >= 1.f) {
+				char buf[64];
+				sprintf(buf, "Fired per second: %d", (int)(m_fired / m_elapsed));
+				m_fireLabel->setText(buf);
+				m_fired = 0;
+				m_elapsed = 0;
+			}
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// sprites added by one click, every sprite runs three tweens
+	#define TWEEN_SPRITE_BATCH 500
+
+	// action manager is ticked this many times when measuring
+	#define TWEEN_MEASURE_ROUNDS 10
+
+	class wyTweenBatchTestLayer : public wyLayer {
+	private:
+		wyLabel* m_countLabel;
+		wyLabel* m_tickLabel;
+		int m_count;
+
+		/// time since last measure
+		float m_elapsed;
+
+	public:
+		wyTweenBatchTestLayer() :
+				m_count(0),
+				m_elapsed(0) {
+			createButton("Add 500 Sprites", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyTweenBatchTestLayer::onAddSprite)));
+			createButton("Toggle Packing", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(100),
+					  wyTargetSelector::make(this, SEL(wyTweenBatchTestLayer::onToggle)));
+
+			m_countLabel = wyLabel::make(" ", SP(16));
+			m_countLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(140));
+			m_countLabel->setColor(wyc3bRed);
+			addChildLocked(m_countLabel, 1);
+
+			m_tickLabel = wyLabel::make(" ", SP(16));
+			m_tickLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(170));
+			m_tickLabel->setColor(wyc3bRed);
+			addChildLocked(m_tickLabel, 1);
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wyTweenBatchTestLayer::onUpdate)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wyTweenBatchTestLayer() {
+			wyActionManager::getInstance()->setTweenEnabled(true);
+		}
+
+		void onAddSprite(wyTargetSelector* ts) {
+			// long actions so that they keep running while measuring
+			wyTexture2D* tex = wyTexture2D::make(RES("R.drawable.blocks"));
+			float size = DP(32.0f);
+			for(int i = 0; i < TWEEN_SPRITE_BATCH; i++) {
+				wySprite* s = wySprite::make(tex, wyr(wyMath::randMax(1) * size, wyMath::randMax(1) * size, size, size));
+				s->setPosition(wyMath::randMax(wyDevice::winWidth), wyMath::randMax(wyDevice::winHeight));
+				float duration = 20 + wyMath::randMax(20);
+				s->runAction(wyEaseSineOut::make(wyMoveTo::make(duration, s->getPositionX(), s->getPositionY(),
+						wyMath::randMax(wyDevice::winWidth), wyMath::randMax(wyDevice::winHeight))));
+				s->runAction(wyFadeTo::make(duration, 255, 64));
+				s->runAction(wyScaleTo::make(duration, 1.f, 0.5f));
+				addChildLocked(s, -1);
+			}
+			m_count += TWEEN_SPRITE_BATCH;
+		}
+
+		void onToggle(wyTargetSelector* ts) {
+			// only affects actions started later
+			wyActionManager* am = wyActionManager::getInstance();
+			am->setTweenEnabled(!am->isTweenEnabled());
+		}
+
+		void onUpdate(wyTargetSelector* ts) {
+			m_elapsed += ts->getDelta();
+			if(m_elapsed < 1.f)
+				return;
+			m_elapsed = 0;
+
+			// time action manager tick, zero delta doesn't change any action
+			wyActionManager* am = wyActionManager::getInstance();
+			int64_t start = wyUtils::currentTimeMillis();
+			for(int i = 0; i < TWEEN_MEASURE_ROUNDS; i++)
+				am->tick(0);
+			int64_t cost = wyUtils::currentTimeMillis() - start;
+
+			char buf[128];
+			sprintf(buf, "%d sprites, %d packed actions, packing %s", m_count, am->getPackedActionCount(), am->isTweenEnabled() ? "on" : "off");
+			m_countLabel->setText(buf);
+			sprintf(buf, "action tick: %.2f ms", (float)cost / TWEEN_MEASURE_ROUNDS);
+			m_tickLabel->setText(buf);
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// queries of one benchmark round
+	#define ASTAR_QUERIES 50
+
+	// side of map which both searches run on, old search is too slow for bigger map
+	#define ASTAR_COMPARE_SIZE 64
+
+	// side of map which only current search runs on
+	#define ASTAR_LARGE_SIZE 256
+
+	/*
+	 * reference copy of the list based search which wyAStar used before, it is kept
+	 * here only to compare with current implementation
+	 */
+	static wyAStarStep* legacyNodeInArray(wyArray* arr, int x, int y) {
+		for(int i = 0; i < arr->num; i++) {
+			wyAStarStep* node = (wyAStarStep*)wyArrayGet(arr, i);
+			if(node->getX() == x && node->getY() == y)
+				return node;
+		}
+		return NULL;
+	}
+
+	static wyAStarStep* legacyFindLowestCostNode(wyArray* arr) {
+		wyAStarStep* lowest = NULL;
+		for(int i = 0; i < arr->num; i++) {
+			wyAStarStep* n = (wyAStarStep*)wyArrayGet(arr, i);
+			if(lowest == NULL || n->getF() < lowest->getF())
+				lowest = n;
+		}
+		return lowest;
+	}
+
+	static bool legacyReleaseNode(wyArray* arr, void* ptr, int index, void* data) {
+		wyObjectRelease((wyObject*)ptr);
+		return true;
+	}
+
+	static int legacyFindPath(wyAStarMap* map, int startx, int starty, int endx, int endy) {
+		if((startx == endx) && (starty == endy))
+			return 0;
+		if(map->isBlockedAt(endx, endy))
+			return 0;
+
+		wyArray* openList = wyArrayNew(map->getTileCount());
+		wyArray* closedList = wyArrayNew(map->getTileCount());
+		wyArrayPush(openList, WYNEW wyAStarStep(startx, starty));
+
+		int found = 0;
+		while(openList->num) {
+			wyAStarStep* current = legacyFindLowestCostNode(openList);
+			if((current->getX() == endx) && (current->getY() == endy)) {
+				for(wyAStarStep* s = current; s->getParent() != NULL; s = s->getParent())
+					found++;
+				break;
+			}
+			wyArrayPush(closedList, current);
+			wyArrayDeleteObj(openList, current, NULL, NULL);
+
+			wyAStarTile* currTile = map->getTileAt(current->getX(), current->getY());
+			wyArray* childs = currTile->getChilds();
+			for(int i = 0; i < childs->num; i++) {
+				wyAStarTile* tile = (wyAStarTile*)wyArrayGet(childs, i);
+				if(tile->isBlocked() || legacyNodeInArray(closedList, tile->getX(), tile->getY()))
+					continue;
+
+				wyAStarStep* neighbor = WYNEW wyAStarStep(tile->getX(), tile->getY());
+				float gScore = current->getG() + map->getStepG(currTile, tile);
+				bool gScoreIsBest = false;
+				if(!legacyNodeInArray(openList, tile->getX(), tile->getY())) {
+					gScoreIsBest = true;
+					int dx = tile->getX() - endx;
+					int dy = tile->getY() - endy;
+					neighbor->setH(sqrt((float)(dx * dx + dy * dy)));
+					wyArrayPush(openList, neighbor);
+					neighbor->retain();
+				} else if(gScore < neighbor->getG()) {
+					gScoreIsBest = true;
+				}
+
+				if(gScoreIsBest) {
+					neighbor->setParent(current);
+					neighbor->setG(gScore);
+					neighbor->setF(neighbor->getG() + neighbor->getH());
+				}
+				neighbor->release();
+			}
+		}
+
+		wyArrayConcurrentEach(openList, legacyReleaseNode, NULL);
+		wyArrayDestroy(openList);
+		wyArrayConcurrentEach(closedList, legacyReleaseNode, NULL);
+		wyArrayDestroy(closedList);
+		return found;
+	}
+
+	class wyAStarBenchmarkTestLayer : public wyLayer {
+	private:
+		wyLabel* m_compareLabel;
+		wyLabel* m_largeLabel;
+
+	public:
+		wyAStarBenchmarkTestLayer() {
+			createButton("Run Benchmark", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyAStarBenchmarkTestLayer::onRun)));
+
+			m_compareLabel = wyLabel::make(" ", SP(16));
+			m_compareLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(100));
+			m_compareLabel->setColor(wyc3bRed);
+			addChildLocked(m_compareLabel, 1);
+
+			m_largeLabel = wyLabel::make(" ", SP(16));
+			m_largeLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(130));
+			m_largeLabel->setColor(wyc3bRed);
+			addChildLocked(m_largeLabel, 1);
+		}
+
+		virtual ~wyAStarBenchmarkTestLayer() {
+		}
+
+		wyAStarMap* createMap(int size) {
+			// block one fifth of tiles randomly
+			wyAStarMap* map = WYNEW wyRectAStarMap(size, size, true);
+			for(int i = 0; i < size * size / 5; i++)
+				map->blockTile(rand() % size, rand() % size);
+			return map;
+		}
+
+		void onRun(wyTargetSelector* ts) {
+			char buf[128];
+			int queries[ASTAR_QUERIES][4];
+
+			// same queries for both searches
+			wyAStarMap* map = createMap(ASTAR_COMPARE_SIZE);
+			for(int i = 0; i < ASTAR_QUERIES; i++) {
+				for(int j = 0; j < 4; j++)
+					queries[i][j] = rand() % ASTAR_COMPARE_SIZE;
+			}
+
+			wyAStar* astar = WYNEW wyAStar(map);
+			int found = 0;
+			int64_t start = wyUtils::currentTimeMillis();
+			for(int i = 0; i < ASTAR_QUERIES; i++) {
+				if(astar->findPath(queries[i][0], queries[i][1], queries[i][2], queries[i][3], false) > 0)
+					found++;
+			}
+			int64_t heapCost = wyUtils::currentTimeMillis() - start;
+			astar->release();
+
+			int legacyFound = 0;
+			start = wyUtils::currentTimeMillis();
+			for(int i = 0; i < ASTAR_QUERIES; i++) {
+				if(legacyFindPath(map, queries[i][0], queries[i][1], queries[i][2], queries[i][3]) > 0)
+					legacyFound++;
+			}
+			int64_t legacyCost = wyUtils::currentTimeMillis() - start;
+			map->release();
+
+			sprintf(buf, "%dx%d, %d paths: heap %d ms (%d found), list %d ms (%d found)",
+					ASTAR_COMPARE_SIZE, ASTAR_COMPARE_SIZE, ASTAR_QUERIES,
+					(int)heapCost, found, (int)legacyCost, legacyFound);
+			m_compareLabel->setText(buf);
+
+			// large map, current search only
+			map = createMap(ASTAR_LARGE_SIZE);
+			astar = WYNEW wyAStar(map);
+			found = 0;
+			start = wyUtils::currentTimeMillis();
+			for(int i = 0; i < ASTAR_QUERIES; i++) {
+				if(astar->findPath(rand() % ASTAR_LARGE_SIZE, rand() % ASTAR_LARGE_SIZE,
+						rand() % ASTAR_LARGE_SIZE, rand() % ASTAR_LARGE_SIZE, false) > 0)
+					found++;
+			}
+			int64_t largeCost = wyUtils::currentTimeMillis() - start;
+			astar->release();
+			map->release();
+
+			sprintf(buf, "%dx%d, %d paths: heap %d ms (%d found)",
+					ASTAR_LARGE_SIZE, ASTAR_LARGE_SIZE, ASTAR_QUERIES, (int)largeCost, found);
+			m_largeLabel->setText(buf);
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// side of the map which path service runs on
+	#define PATH_MAP_SIZE 256
+
+	// size of a room, walls are put between rooms
+	#define PATH_ROOM_SIZE 32
+
+	// queries of synchronous benchmark, for every algorithm
+	#define PATH_SYNC_QUERIES 50
+
+	// requests submitted in one asynchronous batch
+	#define PATH_ASYNC_REQUESTS 200
+
+	class wyPathServiceTestLayer : public wyLayer {
+	private:
+		wyAStarMap* m_map;
+		wyLabel* m_syncLabel;
+		wyLabel* m_asyncLabel;
+
+		/// ids of submitted requests, cancelled if layer is destroyed
+		int m_ids[PATH_ASYNC_REQUESTS];
+
+		/// requests in current batch
+		int m_requests;
+
+		/// returned results of current batch
+		int m_found;
+		int m_notFound;
+
+		/// time when current batch is submitted
+		int64_t m_batchStart;
+
+	public:
+		wyPathServiceTestLayer() :
+				m_requests(0),
+				m_found(0),
+				m_notFound(0),
+				m_batchStart(0) {
+			createButton("Sync Benchmark", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyPathServiceTestLayer::onSync)));
+			createButton("Async Batch", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(90),
+					  wyTargetSelector::make(this, SEL(wyPathServiceTestLayer::onAsync)));
+
+			m_syncLabel = wyLabel::make(" ", SP(16));
+			m_syncLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(140));
+			m_syncLabel->setColor(wyc3bRed);
+			addChildLocked(m_syncLabel, 1);
+
+			m_asyncLabel = wyLabel::make(" ", SP(16));
+			m_asyncLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(170));
+			m_asyncLabel->setColor(wyc3bRed);
+			addChildLocked(m_asyncLabel, 1);
+
+			// rooms separated by walls, every wall has two doors
+			m_map = WYNEW wyRectAStarMap(PATH_MAP_SIZE, PATH_MAP_SIZE, true);
+			for(int i = PATH_ROOM_SIZE; i < PATH_MAP_SIZE; i += PATH_ROOM_SIZE) {
+				for(int j = 0; j < PATH_MAP_SIZE; j++) {
+					if(j % PATH_ROOM_SIZE == PATH_ROOM_SIZE / 4 || j % PATH_ROOM_SIZE == PATH_ROOM_SIZE * 3 / 4)
+						continue;
+					m_map->blockTile(i, j);
+					m_map->blockTile(j, i);
+				}
+			}
+		}
+
+		virtual ~wyPathServiceTestLayer() {
+			// callbacks hold pointer of this layer
+			wyPathService* service = wyPathService::getInstanceNoCreate();
+			if(service != NULL) {
+				for(int i = 0; i < m_requests; i++)
+					service->cancel(m_ids[i]);
+			}
+			m_map->release();
+		}
+
+		static void onPathFound(wyPathResult* result, void* data) {
+			wyPathServiceTestLayer* layer = (wyPathServiceTestLayer*)data;
+			layer->m_found++;
+			layer->updateAsyncLabel();
+		}
+
+		static void onPathNotFound(int id, void* data) {
+			wyPathServiceTestLayer* layer = (wyPathServiceTestLayer*)data;
+			layer->m_notFound++;
+			layer->updateAsyncLabel();
+		}
+
+		void updateAsyncLabel() {
+			char buf[128];
+			int returned = m_found + m_notFound;
+			if(returned < m_requests) {
+				sprintf(buf, "%d/%d returned", returned, m_requests);
+			} else {
+				sprintf(buf, "%d requests in %d ms: %d found, %d not found",
+						m_requests, (int)(wyUtils::currentTimeMillis() - m_batchStart), m_found, m_notFound);
+				m_requests = 0;
+			}
+			m_asyncLabel->setText(buf);
+		}
+
+		int64_t runSync(wyPathAlgorithm algorithm, int queries[][4], int* found) {
+			wyPathService* service = wyPathService::getInstance();
+			*found = 0;
+			int64_t start = wyUtils::currentTimeMillis();
+			for(int i = 0; i < PATH_SYNC_QUERIES; i++) {
+				if(service->findPath(m_map, queries[i][0], queries[i][1], queries[i][2], queries[i][3], false, algorithm) != NULL)
+					(*found)++;
+			}
+			return wyUtils::currentTimeMillis() - start;
+		}
+
+		void onSync(wyTargetSelector* ts) {
+			char buf[128];
+			int queries[PATH_SYNC_QUERIES][4];
+			for(int i = 0; i < PATH_SYNC_QUERIES; i++) {
+				for(int j = 0; j < 4; j++)
+					queries[i][j] = rand() % PATH_MAP_SIZE;
+			}
+
+			// first hierarchical query builds abstract graph, do it before timing
+			wyPathService::getInstance()->findPath(m_map, 0, 0, 1, 1, false, WY_PATH_ALGORITHM_HIERARCHICAL);
+
+			int astarFound, jpsFound, hpaFound;
+			int64_t astarCost = runSync(WY_PATH_ALGORITHM_ASTAR, queries, &astarFound);
+			int64_t jpsCost = runSync(WY_PATH_ALGORITHM_JPS, queries, &jpsFound);
+			int64_t hpaCost = runSync(WY_PATH_ALGORITHM_HIERARCHICAL, queries, &hpaFound);
+			sprintf(buf, "%d paths: A* %d ms, JPS %d ms, HPA* %d ms (%d/%d/%d found)",
+					PATH_SYNC_QUERIES, (int)astarCost, (int)jpsCost, (int)hpaCost, astarFound, jpsFound, hpaFound);
+			m_syncLabel->setText(buf);
+		}
+
+		void onAsync(wyTargetSelector* ts) {
+			// wait until last batch is done
+			if(m_requests > 0)
+				return;
+
+			wyPathCallback callback = {
+				onPathFound,
+				onPathNotFound
+			};
+			wyPathService* service = wyPathService::getInstance();
+			m_found = 0;
+			m_notFound = 0;
+			m_batchStart = wyUtils::currentTimeMillis();
+			for(int i = 0; i < PATH_ASYNC_REQUESTS; i++) {
+				m_ids[i] = service->requestPath(m_map, rand() % PATH_MAP_SIZE, rand() % PATH_MAP_SIZE,
+						rand() % PATH_MAP_SIZE, rand() % PATH_MAP_SIZE, false, &callback, this);
+			}
+			m_requests = PATH_ASYNC_REQUESTS;
+			updateAsyncLabel();
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// tiles which are changed in every frame when mutation is on
+	#define TMX_MUTATIONS_PER_FRAME 64
+
+	class wyHugeTMXTestLayer : public wyLayer {
+	private:
+		wyTMXTileMap* m_map;
+		wyLabel* m_label;
+		float m_lastX;
+		float m_lastY;
+		bool m_mutating;
+
+	public:
+		wyHugeTMXTestLayer() :
+				m_mutating(false) {
+			// 1024x1024 tiles, only chunks on screen are built and drawn
+			wyTexture2D* tex = wyTexture2D::make(RES("R.drawable.tileset0"));
+			m_map = wyTMXTileMap::make(RES("R.raw.huge_map"), tex, NULL);
+			addChildLocked(m_map);
+
+			createButton("Toggle Mutation", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyHugeTMXTestLayer::onToggleMutation)));
+
+			m_label = wyLabel::make(" ", SP(16));
+			m_label->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(90));
+			m_label->setColor(wyc3bRed);
+			addChildLocked(m_label, 1);
+
+			setTouchEnabled(true);
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wyHugeTMXTestLayer::onUpdate)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wyHugeTMXTestLayer() {
+		}
+
+		void onToggleMutation(wyTargetSelector* ts) {
+			m_mutating = !m_mutating;
+		}
+
+		void onUpdate(wyTargetSelector* ts) {
+			// remove or change random tiles near left bottom corner, like destructible terrain
+			wyTMXLayer* layer = m_map->getLayerAt(0);
+			if(m_mutating) {
+				for(int i = 0; i < TMX_MUTATIONS_PER_FRAME; i++) {
+					int x = rand() % 64;
+					int y = layer->getLayerHeight() - 1 - rand() % 64;
+					if(rand() % 2)
+						layer->removeTileAt(x, y);
+					else
+						layer->setTileAt(1 + rand() % 128, x, y);
+				}
+			}
+
+			char buf[64];
+			sprintf(buf, "built chunks: %d, mutations per frame: %d",
+					layer->getBuiltChunkCount(), m_mutating ? TMX_MUTATIONS_PER_FRAME : 0);
+			m_label->setText(buf);
+		}
+
+		virtual bool touchesBegan(wyMotionEvent& event) {
+			m_lastX = event.x[0];
+			m_lastY = event.y[0];
+			return true;
+		}
+
+		virtual bool touchesMoved(wyMotionEvent& event) {
+			m_map->translate(event.x[0] - m_lastX, event.y[0] - m_lastY);
+			m_lastX = event.x[0];
+			m_lastY = event.y[0];
+			return true;
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	#define AFC_SPRITE_COUNT 200
+
+	class wyRunAFCAnimationTestLayer : public wyLayer {
+	private:
+		wyAuroraSprite* m_sprites[AFC_SPRITE_COUNT];
+
+	public:
+		wyRunAFCAnimationTestLayer() {
+			// all sprites play same animations so frame quads are baked once and shared
+			wyTexture2D* tex = wyTexture2D::make(RES("R.drawable.prince"), 0x00ff00ff);
+			int anims[] = { 78, 99, 66 };
+			for(int i = 0; i < AFC_SPRITE_COUNT; i++) {
+				m_sprites[i] = wyAuroraSprite::make(RES("R.raw.prince"), anims[i % 3], tex, NULL);
+				m_sprites[i]->setLoopCount(-1);
+				m_sprites[i]->setUnitInterval(0.1f);
+				m_sprites[i]->setFlipX(i % 2 == 1);
+				m_sprites[i]->setPosition(wyMath::randMax(wyDevice::winWidth), wyMath::randMax(wyDevice::winHeight));
+				addChildLocked(m_sprites[i]);
+			}
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wyRunAFCAnimationTestLayer::onUpdateSprite)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wyRunAFCAnimationTestLayer() {
+		}
+
+		void onUpdateSprite(wyTargetSelector* ts) {
+			for(int i = 0; i < AFC_SPRITE_COUNT; i++) {
+				m_sprites[i]->tick(ts->getDelta());
+			}
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// small and large dynamic shapes, one large per BROADPHASE_LARGE_EVERY
+	#define BROADPHASE_SHAPES 600
+	#define BROADPHASE_LARGE_EVERY 40
+
+	// steps averaged for one reading
+	#define BROADPHASE_SAMPLE_STEPS 30
+
+	class wyChipmunkBroadphaseTestLayer : public wyLayer {
+	private:
+		wyChipmunk* m_chipmunk;
+		wyLabel* m_label;
+		int64_t m_stepTime;
+		int m_steps;
+
+	public:
+		wyChipmunkBroadphaseTestLayer() : m_stepTime(0), m_steps(0) {
+			createButton("Switch Broadphase", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyChipmunkBroadphaseTestLayer::onSwitch)));
+
+			m_label = wyLabel::make(" ", SP(16));
+			m_label->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(80));
+			m_label->setColor(wyc3bRed);
+			addChildLocked(m_label, 1);
+
+			m_chipmunk = WYNEW wyChipmunk();
+			m_chipmunk->setDebugDraw(true);
+			addChildLocked(m_chipmunk);
+
+			cpResetShapeIdCounter();
+			cpSpace* space = m_chipmunk->getSpace();
+			space->iterations = 5;
+			space->gravity = cpv(0, -100);
+
+			// hash cells fit the small shapes, so large ones span many cells
+			cpSpaceResizeActiveHash(space, DP(8), 2000);
+
+			// long static segments, they cover most cells of the hash
+			float w = wyDevice::winWidth;
+			float h = wyDevice::winHeight;
+			cpBody* staticBody = &space->staticBody;
+			cpSpaceAddStaticShape(space, cpSegmentShapeNew(staticBody, cpv(0, 0), cpv(w, 0), 2.0f));
+			cpSpaceAddStaticShape(space, cpSegmentShapeNew(staticBody, cpv(0, 0), cpv(0, h * 2), 2.0f));
+			cpSpaceAddStaticShape(space, cpSegmentShapeNew(staticBody, cpv(w, 0), cpv(w, h * 2), 2.0f));
+			cpSpaceAddStaticShape(space, cpSegmentShapeNew(staticBody, cpv(0, h / 2), cpv(w / 2, h / 3), 2.0f));
+
+			for(int i = 0; i < BROADPHASE_SHAPES; i++) {
+				float radius = (i % BROADPHASE_LARGE_EVERY == 0) ? DP(30) : DP(3);
+				cpBody* body = cpSpaceAddBody(space, cpBodyNew(1.0f, cpMomentForCircle(1.0f, 0.0f, radius, cpvzero)));
+				body->p = cpv(wyMath::randMax(w - radius * 2) + radius, wyMath::randMax(h) + h / 2);
+				cpShape* shape = cpSpaceAddShape(space, cpCircleShapeNew(body, radius, cpvzero));
+				shape->e = 0.0f;
+				shape->u = 0.7f;
+			}
+
+			updateLabel();
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wyChipmunkBroadphaseTestLayer::onUpdateSpace)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wyChipmunkBroadphaseTestLayer() {
+			m_chipmunk->release();
+		}
+
+		void onUpdateSpace(wyTargetSelector* ts) {
+			// fixed step so both broadphases do the same work
+			int64_t start = wyUtils::currentTimeMillis();
+			cpSpaceStep(m_chipmunk->getSpace(), 1.0f / 60.0f);
+			m_stepTime += wyUtils::currentTimeMillis() - start;
+
+			if(++m_steps >= BROADPHASE_SAMPLE_STEPS)
+				updateLabel();
+		}
+
+		void onSwitch(wyTargetSelector* ts) {
+			cpSpace* space = m_chipmunk->getSpace();
+			cpSpaceSetIndexType(space, cpSpaceGetIndexType(space) == CP_SPACE_INDEX_HASH ? CP_SPACE_INDEX_BBTREE : CP_SPACE_INDEX_HASH);
+			m_stepTime = 0;
+			m_steps = 0;
+			updateLabel();
+		}
+
+		void updateLabel() {
+			char buf[128];
+			const char* name = cpSpaceGetIndexType(m_chipmunk->getSpace()) == CP_SPACE_INDEX_HASH ? "space hash" : "bb tree";
+			if(m_steps > 0)
+				sprintf(buf, "%s, %d shapes: %.2f ms/step", name, BROADPHASE_SHAPES, (float)m_stepTime / m_steps);
+			else
+				sprintf(buf, "%s, %d shapes", name, BROADPHASE_SHAPES);
+			m_label->setText(buf);
+			m_stepTime = 0;
+			m_steps = 0;
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// stacks of boxes, every stack stands on its own ledge so it is a separate island
+	#define ISLAND_COLUMNS 20
+	#define ISLAND_ROWS 10
+	#define ISLAND_STACK_HEIGHT 10
+
+	// steps averaged for one reading
+	#define ISLAND_SAMPLE_STEPS 30
+
+	class wyBox2DIslandTestLayer : public wyLayer {
+	private:
+		wyBox2D* m_box2d;
+		wyLabel* m_label;
+		int64_t m_stepTime;
+		int m_steps;
+
+	public:
+		wyBox2DIslandTestLayer() : m_stepTime(0), m_steps(0) {
+			createButton("Switch Threads", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyBox2DIslandTestLayer::onSwitch)));
+
+			m_label = wyLabel::make(" ", SP(16));
+			m_label->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(80));
+			m_label->setColor(wyc3bRed);
+			addChildLocked(m_label, 1);
+
+			m_box2d = WYNEW wyBox2D();
+			m_box2d->setDebugDraw(true);
+			addChildLocked(m_box2d);
+
+			// keep islands awake, otherwise they fall asleep and steps become free
+			b2World* world = m_box2d->getWorld();
+			world->SetAllowSleeping(false);
+
+			float cellWidth = m_box2d->pixel2Meter(wyDevice::winWidth) / ISLAND_COLUMNS;
+			float cellHeight = m_box2d->pixel2Meter(wyDevice::winHeight - DP(100)) / ISLAND_ROWS;
+			float halfBox = MIN(cellWidth / 4, cellHeight / (ISLAND_STACK_HEIGHT + 2) / 2);
+
+			b2BodyDef groundDef;
+			b2Body* ground = world->CreateBody(&groundDef);
+
+			b2PolygonShape box;
+			box.SetAsBox(halfBox, halfBox);
+			for(int row = 0; row < ISLAND_ROWS; row++) {
+				for(int col = 0; col < ISLAND_COLUMNS; col++) {
+					float x = (col + 0.5f) * cellWidth;
+					float y = row * cellHeight + halfBox;
+
+					b2PolygonShape ledge;
+					ledge.SetAsBox(cellWidth * 0.4f, halfBox / 2, b2Vec2(x, y), 0);
+					ground->CreateFixture(&ledge, 0);
+
+					for(int i = 0; i < ISLAND_STACK_HEIGHT; i++) {
+						b2BodyDef bd;
+						bd.type = b2_dynamicBody;
+						bd.position.Set(x, y + halfBox * (1.5f + i * 2.02f));
+						world->CreateBody(&bd)->CreateFixture(&box, 1.0f);
+					}
+				}
+			}
+
+			updateLabel();
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wyBox2DIslandTestLayer::onUpdateWorld)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wyBox2DIslandTestLayer() {
+			m_box2d->release();
+		}
+
+		void onUpdateWorld(wyTargetSelector* ts) {
+			// fixed step so every thread count does the same work
+			int64_t start = wyUtils::currentTimeMillis();
+			m_box2d->getWorld()->Step(1.f / 60.f, 8, 3);
+			m_stepTime += wyUtils::currentTimeMillis() - start;
+
+			if(++m_steps >= ISLAND_SAMPLE_STEPS)
+				updateLabel();
+		}
+
+		void onSwitch(wyTargetSelector* ts) {
+			// 1, 2, 4, 8 threads
+			b2World* world = m_box2d->getWorld();
+			int threads = world->GetThreadCount() * 2;
+			world->SetThreadCount(threads > 8 ? 1 : threads);
+			m_stepTime = 0;
+			m_steps = 0;
+			updateLabel();
+		}
+
+		void updateLabel() {
+			char buf[128];
+			int threads = m_box2d->getWorld()->GetThreadCount();
+			int bodies = ISLAND_COLUMNS * ISLAND_ROWS * ISLAND_STACK_HEIGHT;
+			if(m_steps > 0)
+				sprintf(buf, "%d threads, %d bodies: %.2f ms/step", threads, bodies, (float)m_stepTime / m_steps);
+			else
+				sprintf(buf, "%d threads, %d bodies", threads, bodies);
+			m_label->setText(buf);
+			m_stepTime = 0;
+			m_steps = 0;
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// low rate makes it easy to see steps when interpolation is off
+	#define FIXED_STEP_HZ 15
+
+	class wyFixedStepTestLayer : public wyLayer {
+	private:
+		wyBox2D* m_box2d;
+		wyLabel* m_label;
+		wyLabel* m_forceLabel;
+
+	public:
+		wyFixedStepTestLayer() {
+			createButton("Switch Mode", this, wyDevice::winWidth / 3, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyFixedStepTestLayer::onSwitch)));
+			createButton("Check Force", this, wyDevice::winWidth * 2 / 3, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyFixedStepTestLayer::onCheckForce)));
+
+			m_label = wyLabel::make(" ", SP(16));
+			m_label->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(80));
+			m_label->setColor(wyc3bRed);
+			addChildLocked(m_label, 1);
+
+			m_forceLabel = wyLabel::make(" ", SP(16));
+			m_forceLabel->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(100));
+			m_forceLabel->setColor(wyc3bRed);
+			addChildLocked(m_forceLabel, 1);
+
+			m_box2d = WYNEW wyBox2D();
+			m_box2d->setDebugDraw(true);
+			m_box2d->setAutoStep(true);
+			addChildLocked(m_box2d);
+
+			b2World* world = m_box2d->getWorld();
+			world->SetGravity(b2Vec2(0, -10));
+			world->SetAllowSleeping(false);
+
+			// a box around screen
+			float width = m_box2d->pixel2Meter(wyDevice::winWidth);
+			float height = m_box2d->pixel2Meter(wyDevice::winHeight - DP(100));
+			b2BodyDef groundDef;
+			b2Body* ground = world->CreateBody(&groundDef);
+			b2EdgeShape edge;
+			edge.Set(b2Vec2(0, 0), b2Vec2(width, 0));
+			ground->CreateFixture(&edge, 0);
+			edge.Set(b2Vec2(0, 0), b2Vec2(0, height));
+			ground->CreateFixture(&edge, 0);
+			edge.Set(b2Vec2(width, 0), b2Vec2(width, height));
+			ground->CreateFixture(&edge, 0);
+
+			// bouncing balls keep moving so stutter is visible
+			b2CircleShape circle;
+			circle.m_radius = width / 30;
+			b2FixtureDef fd;
+			fd.shape = &circle;
+			fd.density = 1.0f;
+			fd.restitution = 1.0f;
+			fd.friction = 0;
+			for(int i = 0; i < 10; i++) {
+				b2BodyDef bd;
+				bd.type = b2_dynamicBody;
+				bd.position.Set(width * (i + 1) / 11, height * (0.3f + 0.06f * i));
+				bd.linearVelocity.Set(i % 2 ? 3.0f : -3.0f, 0);
+				world->CreateBody(&bd)->CreateFixture(&fd);
+			}
+
+			onSwitch(NULL);
+		}
+
+		virtual ~wyFixedStepTestLayer() {
+			m_box2d->release();
+		}
+
+		void onSwitch(wyTargetSelector* ts) {
+			// toggle between frame delta step and fixed step with interpolation
+			if(m_box2d->getFixedTimeStep() > 0) {
+				m_box2d->setFixedTimeStep(0);
+				m_label->setText("variable step");
+			} else {
+				m_box2d->setFixedTimeStep(FIXED_STEP_HZ);
+				char buf[64];
+				sprintf(buf, "%d Hz fixed step, interpolated", FIXED_STEP_HZ);
+				m_label->setText(buf);
+			}
+		}
+
+		// push a body with same force in every 60fps frame for 2 seconds, return its position
+		static float pushBody(float hz) {
+			wyBox2D* box2d = WYNEW wyBox2D();
+			box2d->setFixedTimeStep(hz);
+			b2World* world = box2d->getWorld();
+			world->SetGravity(b2Vec2(0, 0));
+
+			b2BodyDef bd;
+			bd.type = b2_dynamicBody;
+			b2Body* body = world->CreateBody(&bd);
+			b2PolygonShape box;
+			box.SetAsBox(0.5f, 0.5f);
+			body->CreateFixture(&box, 1.0f);
+
+			// force equals mass, so acceleration is 1
+			for(int i = 0; i < 120; i++) {
+				body->ApplyForce(b2Vec2(body->GetMass(), 0), body->GetWorldCenter());
+				box2d->step(1.f / 60.f);
+			}
+
+			float x = body->GetPosition().x;
+			box2d->release();
+			return x;
+		}
+
+		void onCheckForce(wyTargetSelector* ts) {
+			// positions should be close to 2 at any physics rate, a force
+			// stacked in frames without step doubles it at 30Hz
+			char buf[128];
+			sprintf(buf, "60Hz: %.3f, 30Hz: %.3f, exact: 2.000", pushBody(60), pushBody(30));
+			m_forceLabel->setText(buf);
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
+
+	// image size and rounds of filter benchmark
+	#define FILTER_IMAGE_SIZE 1024
+	#define FILTER_ROUNDS 3
+
+	class wyColorFilterTestLayer : public wyLayer {
+	private:
+		wyLabel* m_resultLabels[5];
+
+		/// result text, written by benchmark thread
+		char m_results[5][128];
+
+		/// set by benchmark thread when results are ready
+		volatile bool m_done;
+
+		bool m_busying;
+
+		/// blur, emboss and color matrix filters
+		wyColorFilter* m_filters[3];
+
+	public:
+		wyColorFilterTestLayer() :
+				m_done(false),
+				m_busying(false) {
+			createButton("Run Benchmark", this, wyDevice::winWidth / 2, wyDevice::winHeight - DP(40),
+					  wyTargetSelector::make(this, SEL(wyColorFilterTestLayer::onRun)));
+
+			for(int i = 0; i < 5; i++) {
+				m_resultLabels[i] = wyLabel::make(" ", SP(16));
+				m_resultLabels[i]->setPosition(wyDevice::winWidth / 2, wyDevice::winHeight - DP(80 + i * 30));
+				addChildLocked(m_resultLabels[i]);
+			}
+			m_resultLabels[0]->setColor(wyc3bRed);
+
+			wyColorMatrix* m = wyColorMatrix::make();
+			m->setSaturation(0.3f);
+			m_filters[0] = wyBlurColorFilter::make(8);
+			m_filters[1] = wyEmbossColorFilter::make();
+			m_filters[2] = wyColorMatrixColorFilter::make(m);
+			for(int i = 0; i < 3; i++)
+				m_filters[i]->retain();
+
+			wyTimer* timer = wyTimer::make(wyTargetSelector::make(this, SEL(wyColorFilterTestLayer::onUpdate)));
+			scheduleLocked(timer);
+		}
+
+		virtual ~wyColorFilterTestLayer() {
+			for(int i = 0; i < 3; i++)
+				m_filters[i]->release();
+		}
+
+		void onRun(wyTargetSelector* ts) {
+			if(m_busying)
+				return;
+			m_busying = true;
+			m_done = false;
+			m_resultLabels[0]->setText("Running");
+			for(int i = 1; i < 5; i++)
+				m_resultLabels[i]->setText(" ");
+
+			wyThread::runThread(wyTargetSelector::make(this, SEL(wyColorFilterTestLayer::benchmarkEntry)));
+		}
+
+		// run filter on a copy of source, return average time of one run
+		int runFilter(wyColorFilter* filter, const char* src, char* dst, int size) {
+			int64_t total = 0;
+			for(int r = 0; r < FILTER_ROUNDS; r++) {
+				memcpy(dst, src, size * size * 4);
+				int64_t start = wyUtils::currentTimeMillis();
+				filter->apply(dst, size, size);
+				total += wyUtils::currentTimeMillis() - start;
+			}
+			return (int)(total / FILTER_ROUNDS);
+		}
+
+		void benchmarkEntry(wyTargetSelector* ts) {
+			int size = FILTER_IMAGE_SIZE;
+			int bytes = size * size * 4;
+			char* src = (char*)wyMalloc(bytes);
+			char* golden = (char*)wyMalloc(bytes);
+			char* dst = (char*)wyMalloc(bytes);
+
+			// noisy gradient so every kernel path has work
+			unsigned int seed = 12345;
+			for(int i = 0; i < bytes; i++) {
+				seed = seed * 1103515245 + 12345;
+				src[i] = (char)((i / 4 % size) / 4 + (seed >> 24) / 2);
+			}
+
+			const char* names[3] = { "blur 8", "emboss", "color matrix" };
+
+			int threads = wyColorFilter::getThreadCount();
+			bool simd = wyColorFilter::isSIMDEnabled();
+			sprintf(m_results[0], "%dx%d image, ms per run, reference vs fast", size, size);
+
+			for(int i = 0; i < 3; i++) {
+				// scalar and single thread is the reference
+				wyColorFilter::setSIMDEnabled(false);
+				wyColorFilter::setThreadCount(1);
+				int scalarTime = runFilter(m_filters[i], src, golden, size);
+
+				wyColorFilter::setSIMDEnabled(simd);
+				wyColorFilter::setThreadCount(threads);
+				int fastTime = runFilter(m_filters[i], src, dst, size);
+
+				sprintf(m_results[i + 1], "%s: %d vs %d, %s", names[i], scalarTime, fastTime,
+						memcmp(golden, dst, bytes) ? "MISMATCH" : "match");
+			}
+
+			wyFree(src);
+			wyFree(golden);
+			wyFree(dst);
+
+			sprintf(m_results[4], "reference: scalar 1 thread, fast: %s %d threads", simd ? "SIMD" : "scalar", threads);
+
+			wyMemoryBarrier();
+			m_done = true;
+		}
+
+		void onUpdate(wyTargetSelector* ts) {
+			if(!m_busying || !m_done)
+				return;
+
+			for(int i = 0; i < 5; i++)
+				m_resultLabels[i]->setText(m_results[i]);
+			m_busying = false;
+		}
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////
 }
 
 using namespace Performance;
@@ -280,3 +1773,16 @@ DEMO_ENTRY_IMPL(BigTMXTest);
 DEMO_ENTRY_IMPL(RenderSpriteTest);
 DEMO_ENTRY_IMPL(RunActionTest);
 DEMO_ENTRY_IMPL(RunSkeletalAnimationTest);
+DEMO_ENTRY_IMPL(CommandQueueStressTest);
+DEMO_ENTRY_IMPL(RunParticleTest);
+DEMO_ENTRY_IMPL(SlabAllocatorTest);
+DEMO_ENTRY_IMPL(TimerWheelTest);
+DEMO_ENTRY_IMPL(TweenBatchTest);
+DEMO_ENTRY_IMPL(AStarBenchmarkTest);
+DEMO_ENTRY_IMPL(PathServiceTest);
+DEMO_ENTRY_IMPL(HugeTMXTest);
+DEMO_ENTRY_IMPL(RunAFCAnimationTest);
+DEMO_ENTRY_IMPL(ChipmunkBroadphaseTest);
+DEMO_ENTRY_IMPL(Box2DIslandTest);
+DEMO_ENTRY_IMPL(FixedStepTest);
+DEMO_ENTRY_IMPL(ColorFilterTest);
@@ -15,6 +15,19 @@ DEMO_ENTRY(performance, BigTMXTest);
 DEMO_ENTRY(performance, RenderSpriteTest);
 DEMO_ENTRY(performance, RunActionTest);
 DEMO_ENTRY(performance, RunSkeletalAnimationTest);
+DEMO_ENTRY(performance, CommandQueueStressTest);
+DEMO_ENTRY(performance, RunParticleTest);
+DEMO_ENTRY(performance, SlabAllocatorTest);
+DEMO_ENTRY(performance, TimerWheelTest);
+DEMO_ENTRY(performance, TweenBatchTest);
+DEMO_ENTRY(performance, AStarBenchmarkTest);
+DEMO_ENTRY(performance, PathServiceTest);
+DEMO_ENTRY(performance, HugeTMXTest);
+DEMO_ENTRY(performance, RunAFCAnimationTest);
+DEMO_ENTRY(performance, ChipmunkBroadphaseTest);
+DEMO_ENTRY(performance, Box2DIslandTest);
+DEMO_ENTRY(performance, FixedStepTest);
+DEMO_ENTRY(performance, ColorFilterTest);
 
 #ifdef __cplusplus
 }